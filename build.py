@@ -197,10 +197,16 @@ CTX.INPUT['common'] = """
  CompactingStringStorage.cpp
  FatalException.cpp
  ThreadLocalPool.cpp
+ ThreadLocalPoolStats.cpp
  SegvException.cpp
  SerializableEEException.cpp
+ SharedBufferRing.cpp
  SQLException.cpp
  InterruptException.cpp
+ JsonField.cpp
+ LikePattern.cpp
+ SlabPool.cpp
+ StringDictionary.cpp
  StringRef.cpp
  tabletuple.cpp
  TupleSchema.cpp
@@ -221,6 +227,7 @@ CTX.INPUT['common'] = """
 CTX.INPUT['execution'] = """
  FragmentManager.cpp
  JNITopend.cpp
+ PlanCacheStats.cpp
  VoltDBEngine.cpp
 """
 
@@ -230,6 +237,7 @@ CTX.INPUT['executors'] = """
  deleteexecutor.cpp
  distinctexecutor.cpp
  executorutil.cpp
+ hashjoinexecutor.cpp
  indexscanexecutor.cpp
  indexcountexecutor.cpp
  tablecountexecutor.cpp
@@ -237,6 +245,7 @@ CTX.INPUT['executors'] = """
  limitexecutor.cpp
  materializeexecutor.cpp
  materializedscanexecutor.cpp
+ mergejoinexecutor.cpp
  nestloopexecutor.cpp
  nestloopindexexecutor.cpp
  orderbyexecutor.cpp
@@ -264,6 +273,7 @@ CTX.INPUT['plannodes'] = """
  aggregatenode.cpp
  deletenode.cpp
  distinctnode.cpp
+ hashjoinnode.cpp
  indexscannode.cpp
  indexcountnode.cpp
  tablecountnode.cpp
@@ -271,6 +281,7 @@ CTX.INPUT['plannodes'] = """
  limitnode.cpp
  materializenode.cpp
  materializedscanplannode.cpp
+ mergejoinnode.cpp
  nestloopindexnode.cpp
  nestloopnode.cpp
  orderbynode.cpp
@@ -376,8 +387,11 @@ if whichtests in ("${eetestsuite}", "common"):
      valuearray_test
      nvalue_test
      pool_test
+     thread_local_pool_test
      tabletuple_test
      elastic_hashinator_test
+     shared_buffer_ring_test
+     like_pattern_test
     """
 
 if whichtests in ("${eetestsuite}", "execution"):
@@ -387,9 +401,20 @@ if whichtests in ("${eetestsuite}", "execution"):
      FragmentManagerTest
     """
 
+if whichtests in ("${eetestsuite}", "executors"):
+    CTX.TESTS['executors'] = """
+     HashJoinExecutorTest
+     MergeJoinExecutorTest
+     NestLoopIndexExecutorTest
+     OrderByExecutorTest
+     PipelinedExecutionTest
+     UnionExecutorTest
+    """
+
 if whichtests in ("${eetestsuite}", "expressions"):
     CTX.TESTS['expressions'] = """
      expression_test
+     json_field_benchmark
     """
 
 if whichtests in ("${eetestsuite}", "indexes"):
@@ -398,6 +423,9 @@ if whichtests in ("${eetestsuite}", "indexes"):
      index_scripted_test
      index_test
      compacting_hash_index
+     tree_index_benchmark
+     index_probe_benchmark
+     index_build_benchmark
     """
 
 if whichtests in ("${eetestsuite}", "storage"):
@@ -410,6 +438,7 @@ if whichtests in ("${eetestsuite}", "storage"):
      PersistentTableMemStatsTest
      serialize_test
      StreamedTable_test
+     StringDictionaryTest
      table_and_indexes_test
      table_test
      tabletuple_export_test
@@ -421,7 +450,11 @@ if whichtests in ("${eetestsuite}", "structures"):
     CTX.TESTS['structures'] = """
      CompactingMapTest
      CompactingMapIndexCountTest
+     CompactingBTreeTest
      CompactingHashTest
+     ProbingHashTableTest
+     FlatHashMapTest
+     FlatHashMapBenchmark
      CompactingPoolTest
     """
 
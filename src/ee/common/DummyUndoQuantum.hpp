@@ -40,6 +40,11 @@ public:
         undoAction->~UndoAction();
         m_dataPool->purge();
     }
+    void registerUndoRecord(UndoRecordType type, char *tuple, UndoRecordHandler *handler,
+                            UndoQuantumReleaseInterest *interest = NULL) {
+        UndoRecord record = { tuple, 0, static_cast<uint32_t>(type) };
+        handler->releaseRecords(type, &record, 1);
+    }
     inline bool isDummy() {return true;}
 };
 }
@@ -0,0 +1,350 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/JsonField.h"
+
+using namespace voltdb;
+
+namespace {
+
+// deeper documents are left to a full parse
+const int MAX_SCAN_DEPTH = 64;
+
+/*
+ * Steps over the tokens of a JSON document, checking them as it goes.
+ * Each method returns false where the document isn't plain JSON.
+ */
+class JsonScanner {
+public:
+    JsonScanner(const char *document, int32_t length)
+        : m_cursor(document), m_end(document + length) {}
+
+    const char *cursor() const { return m_cursor; }
+
+    void skipSpaces() {
+        while (m_cursor != m_end &&
+               (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\r' || *m_cursor == '\n')) {
+            ++m_cursor;
+        }
+    }
+
+    bool consume(char c) {
+        if (m_cursor != m_end && *m_cursor == c) {
+            ++m_cursor;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) const {
+        return m_cursor != m_end && *m_cursor == c;
+    }
+
+    /*
+     * A member name and the ':' after it. Sets start and length to the
+     * characters between its quotes, which must need no decoding.
+     */
+    bool scanName(const char *&start, int32_t &length) {
+        if ( ! consume('"')) {
+            return false;
+        }
+        start = m_cursor;
+        while (m_cursor != m_end) {
+            const char c = *m_cursor;
+            if (c == '"') {
+                length = static_cast<int32_t>(m_cursor - start);
+                ++m_cursor;
+                skipSpaces();
+                return consume(':');
+            }
+            if (c == '\\' || c == '\0') {
+                return false;
+            }
+            ++m_cursor;
+        }
+        return false;
+    }
+
+    /*
+     * A whole value, containers iteratively to the depth the scanner
+     * allows.
+     */
+    bool skipValue() {
+        char closers[MAX_SCAN_DEPTH];
+        int depth = 0;
+        for (;;) {
+            // at the start of a value
+            skipSpaces();
+            if (consume('{')) {
+                skipSpaces();
+                if ( ! consume('}')) {
+                    if (depth == MAX_SCAN_DEPTH || ! skipName()) {
+                        return false;
+                    }
+                    closers[depth++] = '}';
+                    continue;
+                }
+            } else if (consume('[')) {
+                skipSpaces();
+                if ( ! consume(']')) {
+                    if (depth == MAX_SCAN_DEPTH) {
+                        return false;
+                    }
+                    closers[depth++] = ']';
+                    continue;
+                }
+            } else if ( ! skipScalar()) {
+                return false;
+            }
+
+            // after a value: close what it ends, or move on to the next one
+            for (;;) {
+                if (depth == 0) {
+                    return true;
+                }
+                skipSpaces();
+                if (consume(closers[depth - 1])) {
+                    --depth;
+                    continue;
+                }
+                if ( ! consume(',')) {
+                    return false;
+                }
+                if (closers[depth - 1] == '}') {
+                    skipSpaces();
+                    if ( ! skipName()) {
+                        return false;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+private:
+    bool skipName() {
+        const char *start;
+        int32_t length;
+        return scanName(start, length);
+    }
+
+    bool skipScalar() {
+        if (m_cursor == m_end) {
+            return false;
+        }
+        switch (*m_cursor) {
+        case '"':
+            return skipString();
+        case 't':
+            return skipLiteral("true", 4);
+        case 'f':
+            return skipLiteral("false", 5);
+        case 'n':
+            return skipLiteral("null", 4);
+        default:
+            return skipNumber();
+        }
+    }
+
+    bool skipLiteral(const char *literal, int32_t length) {
+        if (m_end - m_cursor < length || ::memcmp(m_cursor, literal, length) != 0) {
+            return false;
+        }
+        m_cursor += length;
+        return true;
+    }
+
+    /*
+     * A string, whose escapes must be ones jsoncpp can decode.
+     */
+    bool skipString() {
+        ++m_cursor;
+        while (m_cursor != m_end) {
+            const char c = *m_cursor++;
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                continue;
+            }
+            if (m_cursor == m_end) {
+                return false;
+            }
+            switch (*m_cursor++) {
+            case '"': case '/': case '\\': case 'b': case 'f': case 'n': case 'r': case 't':
+                break;
+            case 'u': {
+                uint32_t unit;
+                if ( ! scanHex(unit)) {
+                    return false;
+                }
+                // the first half of a surrogate pair must be followed by the second
+                if (unit >= 0xD800 && unit <= 0xDBFF &&
+                    ( ! consume('\\') || ! consume('u') || ! scanHex(unit))) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool scanHex(uint32_t &unit) {
+        if (m_end - m_cursor < 4) {
+            return false;
+        }
+        unit = 0;
+        for (int ii = 0; ii < 4; ++ii) {
+            const char c = *m_cursor++;
+            unit <<= 4;
+            if (c >= '0' && c <= '9') {
+                unit += c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                unit += c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                unit += c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool scanDigits() {
+        const char *start = m_cursor;
+        while (m_cursor != m_end && *m_cursor >= '0' && *m_cursor <= '9') {
+            ++m_cursor;
+        }
+        return m_cursor != start;
+    }
+
+    /*
+     * A number in strict JSON form, which jsoncpp also reads. It must not
+     * run on into characters jsoncpp would take as part of it.
+     */
+    bool skipNumber() {
+        consume('-');
+        if ( ! consume('0') && ! scanDigits()) {
+            return false;
+        }
+        if (consume('.') && ! scanDigits()) {
+            return false;
+        }
+        if (consume('e') || consume('E')) {
+            if ( ! consume('+')) {
+                consume('-');
+            }
+            if ( ! scanDigits()) {
+                return false;
+            }
+        }
+        return m_cursor == m_end ||
+            ! ((*m_cursor >= '0' && *m_cursor <= '9') || *m_cursor == '.' || *m_cursor == 'e' ||
+               *m_cursor == 'E' || *m_cursor == '+' || *m_cursor == '-');
+    }
+
+    const char *m_cursor;
+    const char *const m_end;
+};
+
+}
+
+void JsonField::compile(const char *name, int32_t length)
+{
+    m_name = name;
+    m_nameLength = length;
+    m_scannable = ::memchr(name, '\0', length) == NULL;
+}
+
+JsonField::Match JsonField::find(const char *document, int32_t length,
+                                 const char *&value, int32_t &valueLength) const
+{
+    if ( ! m_scannable) {
+        return DOCUMENT_UNSCANNED;
+    }
+    JsonScanner scanner(document, length);
+    scanner.skipSpaces();
+    if ( ! scanner.consume('{')) {
+        return DOCUMENT_UNSCANNED;
+    }
+    scanner.skipSpaces();
+    // jsoncpp ignores whatever follows the root
+    if (scanner.consume('}')) {
+        return FIELD_ABSENT;
+    }
+    // The whole root is scanned, so that a document malformed past the
+    // field is still reported, and the last of repeated members is the
+    // one found, as with a full parse.
+    Match match = FIELD_ABSENT;
+    for (;;) {
+        const char *name;
+        int32_t nameLength;
+        if ( ! scanner.scanName(name, nameLength)) {
+            return DOCUMENT_UNSCANNED;
+        }
+        scanner.skipSpaces();
+        const char *start = scanner.cursor();
+        if ( ! scanner.skipValue()) {
+            return DOCUMENT_UNSCANNED;
+        }
+        if (nameLength == m_nameLength && ::memcmp(name, m_name, nameLength) == 0) {
+            match = FIELD_FOUND;
+            value = start;
+            valueLength = static_cast<int32_t>(scanner.cursor() - start);
+        }
+        scanner.skipSpaces();
+        if (scanner.consume('}')) {
+            return match;
+        }
+        if ( ! scanner.consume(',')) {
+            return DOCUMENT_UNSCANNED;
+        }
+        scanner.skipSpaces();
+    }
+}
+
+bool JsonField::isPlainString(const char *value, int32_t length)
+{
+    if (length < 2 || value[0] != '"') {
+        return false;
+    }
+    for (int32_t ii = 1; ii < length - 1; ++ii) {
+        if (value[ii] == '\\' || value[ii] == '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JsonField::isPlainInteger(const char *value, int32_t length)
+{
+    const int32_t sign = (length > 0 && value[0] == '-') ? 1 : 0;
+    const int32_t digits = length - sign;
+    // 18 digits always fit in 64 bits
+    if (digits < 1 || digits > 18 || (value[sign] == '0' && (digits > 1 || sign == 1))) {
+        return false;
+    }
+    for (int32_t ii = sign; ii < length; ++ii) {
+        if (value[ii] < '0' || value[ii] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONFIELD_H_
+#define JSONFIELD_H_
+
+#include <cstring>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * A field name the SQL FIELD function looks up in JSON documents,
+ * compiled once so that each document is only scanned, checking its
+ * syntax without building a tree of it.
+ *
+ * The scan follows the rules of the jsoncpp reader that FIELD otherwise
+ * parses documents with, but only for plain JSON: anything it can't be
+ * sure jsoncpp reads the same way -- a malformed document, comments, a
+ * root that isn't an object, escapes in member names -- leaves the
+ * document unscanned, to be parsed in full. Like jsoncpp, it takes the
+ * last of a member's values when the member is repeated.
+ *
+ * A field refers to the bytes it was compiled from, which must outlive
+ * it.
+ */
+class JsonField {
+public:
+    enum Match {
+        FIELD_FOUND,
+        FIELD_ABSENT,
+        DOCUMENT_UNSCANNED
+    };
+
+    JsonField() { compile("", 0); }
+    JsonField(const char *name, int32_t length) { compile(name, length); }
+
+    void compile(const char *name, int32_t length);
+
+    const char *name() const { return m_name; }
+    int32_t nameLength() const { return m_nameLength; }
+
+    /**
+     * Scan a whole document for the field. If it is found, value and
+     * valueLength are set to the JSON text of its value.
+     */
+    Match find(const char *document, int32_t length,
+               const char *&value, int32_t &valueLength) const;
+
+    /**
+     * Whether JSON text is a string without escapes (or NULs), the
+     * characters between its quotes being its value.
+     */
+    static bool isPlainString(const char *value, int32_t length);
+
+    /**
+     * Whether JSON text is an integer that jsoncpp reads as one and
+     * writes back unchanged: no leading zeros, no "-0" and few enough
+     * digits to fit.
+     */
+    static bool isPlainInteger(const char *value, int32_t length);
+
+private:
+    const char *m_name;
+    int32_t m_nameLength;
+    // names with NULs are compared as jsoncpp compares them only in full parses
+    bool m_scannable;
+};
+
+}
+
+#endif /* JSONFIELD_H_ */
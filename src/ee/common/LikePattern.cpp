@@ -0,0 +1,200 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/LikePattern.h"
+#include "common/NValue.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace voltdb;
+
+void LikePattern::compile(const char *pattern, int32_t length)
+{
+    m_pattern = pattern;
+    m_patternLength = length;
+
+    int32_t start = 0;
+    while (start < length && pattern[start] == '%') {
+        ++start;
+    }
+    int32_t end = length;
+    while (end > start && pattern[end - 1] == '%') {
+        --end;
+    }
+    m_literal = pattern + start;
+    m_literalLength = end - start;
+    for (int32_t ii = start; ii < end; ++ii) {
+        if (pattern[ii] == '%' || pattern[ii] == '_') {
+            m_shape = LIKE_GENERAL;
+            return;
+        }
+    }
+    if (start == 0) {
+        m_shape = (end == length) ? LIKE_EXACT : LIKE_PREFIX;
+    } else {
+        m_shape = (end == length) ? LIKE_SUFFIX : LIKE_CONTAINS;
+    }
+}
+
+/*
+ * With SSE2, the needle's first and last bytes are compared with 16
+ * candidate positions of the haystack at once, and only the candidates
+ * where both match are compared in full.
+ */
+const char *LikePattern::find(const char *haystack, int32_t haystackLength,
+                              const char *needle, int32_t needleLength)
+{
+    if (needleLength == 0) {
+        return haystack;
+    }
+    if (needleLength > haystackLength) {
+        return NULL;
+    }
+    if (needleLength == 1) {
+        return static_cast<const char*>(::memchr(haystack, needle[0], haystackLength));
+    }
+
+    const int32_t last = needleLength - 1;
+    int32_t ii = 0;
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i final = _mm_set1_epi8(needle[last]);
+    for (; ii + last + 16 <= haystackLength; ii += 16) {
+        const __m128i firsts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + ii));
+        const __m128i finals = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + ii + last));
+        uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(firsts, first), _mm_cmpeq_epi8(finals, final))));
+        while (candidates != 0) {
+            const int32_t at = ii + __builtin_ctz(candidates);
+            if (::memcmp(haystack + at + 1, needle + 1, last - 1) == 0) {
+                return haystack + at;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; ii + last < haystackLength; ++ii) {
+        if (haystack[ii] == needle[0] && haystack[ii + last] == needle[last] &&
+            ::memcmp(haystack + ii + 1, needle + 1, last - 1) == 0) {
+            return haystack + ii;
+        }
+    }
+    return NULL;
+}
+
+namespace {
+
+/*
+ * Matches a value against a pattern with '_'s or inner '%'s a character
+ * at a time, trying each place the value could pick up again after a '%'.
+ */
+class Liker {
+
+private:
+    // Constructor used internally for temporary recursion contexts.
+    Liker( const Liker& original, const char* valueChars, const char* patternChars) :
+        m_value(original.m_value, valueChars),
+        m_pattern(original.m_pattern, patternChars)
+         {}
+
+public:
+    Liker(const char *valueChars, const char* patternChars, int32_t valueUTF8Length, int32_t patternUTF8Length) :
+        m_value(valueChars, valueChars + valueUTF8Length),
+        m_pattern(patternChars, patternChars + patternUTF8Length)
+         {}
+
+    bool like() {
+        while ( ! m_pattern.atEnd()) {
+            const uint32_t nextPatternCodePoint = m_pattern.extractCodePoint();
+            switch (nextPatternCodePoint) {
+            case '%': {
+                if (m_pattern.atEnd()) {
+                    return true;
+                }
+
+                const char *postPercentPatternIterator = m_pattern.getCursor();
+                const uint32_t nextPatternCodePointAfterPercent = m_pattern.extractCodePoint();
+                const bool nextPatternCodePointAfterPercentIsSpecial =
+                        (nextPatternCodePointAfterPercent == '_') ||
+                        (nextPatternCodePointAfterPercent == '%');
+
+                /*
+                 * This loop tries to skip as many characters as possible with the % by checking
+                 * if the next value character matches the pattern character after the %.
+                 *
+                 * If the next pattern character is special then we always have to recurse to
+                 * match that character. For stacked %s this just skips to the last one.
+                 * For stacked _ it will recurse and demand the correct number of characters.
+                 *
+                 * For a regular character it will recurse if the value character matches the pattern character.
+                 * This saves doing a function call per character and allows us to skip if there is no match.
+                 */
+                while ( ! m_value.atEnd()) {
+
+                    const char *preExtractionValueIterator = m_value.getCursor();
+                    const uint32_t nextValueCodePoint = m_value.extractCodePoint();
+
+                    const bool nextPatternCodePointIsSpecialOrItEqualsNextValueCodePoint =
+                            (nextPatternCodePointAfterPercentIsSpecial ||
+                                    (nextPatternCodePointAfterPercent == nextValueCodePoint));
+
+                    if ( nextPatternCodePointIsSpecialOrItEqualsNextValueCodePoint) {
+                        Liker recursionContext( *this, preExtractionValueIterator, postPercentPatternIterator);
+                        if (recursionContext.like()) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+            case '_': {
+                if ( m_value.atEnd()) {
+                    return false;
+                }
+                //Extract a code point to consume a character
+                m_value.extractCodePoint();
+                break;
+            }
+            default: {
+                if ( m_value.atEnd()) {
+                    return false;
+                }
+                const int nextValueCodePoint = m_value.extractCodePoint();
+                if (nextPatternCodePoint != nextValueCodePoint) {
+                    return false;
+                }
+                break;
+            }
+            }
+        }
+        //A matching value ends exactly where the pattern ends (having already accounted for '%')
+        return m_value.atEnd();
+    }
+
+    NValue::UTF8Iterator m_value;
+    NValue::UTF8Iterator m_pattern;
+};
+
+}
+
+bool LikePattern::matchGeneral(const char *value, int32_t length) const
+{
+    Liker liker(value, m_pattern, length, m_patternLength);
+    return liker.like();
+}
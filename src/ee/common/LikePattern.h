@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIKEPATTERN_H_
+#define LIKEPATTERN_H_
+
+#include <cstring>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * A LIKE pattern, classified once so that matching a value against it
+ * needn't parse it again. Patterns that are a literal with '%'s only at
+ * either end are matched against the value's bytes directly, which for
+ * UTF-8 is the same as matching its characters: an exact match, a
+ * prefix, a suffix or a substring search. Patterns with '_' or inner
+ * '%'s are matched a character at a time.
+ *
+ * A pattern refers to the bytes it was compiled from, which must outlive
+ * it.
+ */
+class LikePattern {
+public:
+    enum Shape {
+        LIKE_EXACT,     // 'abc'
+        LIKE_PREFIX,    // 'abc%'
+        LIKE_SUFFIX,    // '%abc'
+        LIKE_CONTAINS,  // '%abc%'
+        LIKE_GENERAL    // anything with '_' or an inner '%'
+    };
+
+    LikePattern() { compile("", 0); }
+    LikePattern(const char *pattern, int32_t length) { compile(pattern, length); }
+
+    void compile(const char *pattern, int32_t length);
+
+    bool matches(const char *value, int32_t length) const {
+        switch (m_shape) {
+        case LIKE_EXACT:
+            return length == m_literalLength && ::memcmp(value, m_literal, length) == 0;
+        case LIKE_PREFIX:
+            return length >= m_literalLength && ::memcmp(value, m_literal, m_literalLength) == 0;
+        case LIKE_SUFFIX:
+            return length >= m_literalLength &&
+                ::memcmp(value + length - m_literalLength, m_literal, m_literalLength) == 0;
+        case LIKE_CONTAINS:
+            return find(value, length, m_literal, m_literalLength) != NULL;
+        default:
+            return matchGeneral(value, length);
+        }
+    }
+
+    Shape shape() const { return m_shape; }
+
+    /**
+     * The literal part of a pattern of any shape but LIKE_GENERAL.
+     */
+    const char *literal() const { return m_literal; }
+    int32_t literalLength() const { return m_literalLength; }
+
+    /**
+     * The first occurrence of needle in haystack, or NULL.
+     */
+    static const char *find(const char *haystack, int32_t haystackLength,
+                            const char *needle, int32_t needleLength);
+
+private:
+    bool matchGeneral(const char *value, int32_t length) const;
+
+    Shape m_shape;
+    const char *m_pattern;
+    int32_t m_patternLength;
+    const char *m_literal;
+    int32_t m_literalLength;
+};
+
+}
+
+#endif /* LIKEPATTERN_H_ */
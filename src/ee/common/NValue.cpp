@@ -17,6 +17,7 @@
 
 #include "common/NValue.hpp"
 #include "common/StlFriendlyNValue.h"
+#include "common/ValuePeeker.hpp"
 #include "common/executorcontext.hpp"
 #include "expressions/functionexpression.h" // Really for datefunctions and its dependencies.
 #include "logging/LogManager.h"
@@ -409,10 +410,10 @@ NValue NValue::opDivideDecimals(const NValue lhs, const NValue rhs) const {
 struct NValueList {
     static int allocationSizeForLength(size_t length)
     {
-        //TODO: May want to consider extra allocation, here,
-        // such as space for a sorted copy of the array.
+        // Beyond the values themselves, leave room for a sorted copy of them
+        // and for their sorted int64 equivalents, used by inList lookups.
         // This allocation has the advantage of getting freed via NValue::free.
-        return (int)(sizeof(NValueList) + length*sizeof(StlFriendlyNValue));
+        return (int)(sizeof(NValueList) + length*(2*sizeof(StlFriendlyNValue) + sizeof(int64_t)));
     }
 
     void* operator new(size_t size, char* placement)
@@ -422,7 +423,8 @@ struct NValueList {
     void operator delete(void*, char*) {}
     void operator delete(void*) {}
 
-    NValueList(size_t length, ValueType elementType) : m_length(length), m_elementType(elementType)
+    NValueList(size_t length, ValueType elementType)
+        : m_length(length), m_elementType(elementType), m_lookup(LOOKUP_LINEAR), m_sortedCount(0)
     { }
 
     void deserializeNValues(SerializeInput &input, Pool *dataPool)
@@ -435,8 +437,90 @@ struct NValueList {
     StlFriendlyNValue const* begin() const { return m_values; }
     StlFriendlyNValue const* end() const { return m_values + m_length; }
 
+    StlFriendlyNValue* sortedValues() { return m_values + m_length; }
+    StlFriendlyNValue const* sortedValues() const { return m_values + m_length; }
+    int64_t* sortedIntegers() { return reinterpret_cast<int64_t*>(m_values + 2*m_length); }
+    int64_t const* sortedIntegers() const { return reinterpret_cast<int64_t const*>(m_values + 2*m_length); }
+
+    /**
+     * Sort a copy of the non-null values so that contains() can binary
+     * search them. When they are all integers, also keep them as sorted
+     * int64s so integer probes skip NValue comparison altogether. Lists
+     * mixing other types are left to the linear scan, which only ever
+     * compares the probe against each value.
+     * Must be called again whenever the values change.
+     */
+    void buildLookup()
+    {
+        StlFriendlyNValue* sorted = sortedValues();
+        int64_t* integers = sortedIntegers();
+        bool allIntegers = true;
+        bool sameType = true;
+        m_sortedCount = 0;
+        for (size_t ii = 0; ii < m_length; ++ii) {
+            // a null never matches, so it needs no place in the lookup
+            if (m_values[ii].isNull()) {
+                continue;
+            }
+            const ValueType type = ValuePeeker::peekValueType(m_values[ii]);
+            if (isIntegralType(type)) {
+                integers[m_sortedCount] = ValuePeeker::peekAsBigInt(m_values[ii]);
+            }
+            else {
+                allIntegers = false;
+            }
+            if (m_sortedCount > 0 && type != ValuePeeker::peekValueType(sorted[0])) {
+                sameType = false;
+            }
+            sorted[m_sortedCount++] = m_values[ii];
+        }
+        if (allIntegers) {
+            std::sort(integers, integers + m_sortedCount);
+            m_lookup = LOOKUP_INTEGERS;
+        }
+        else if (sameType) {
+            std::sort(sorted, sorted + m_sortedCount);
+            m_lookup = LOOKUP_SORTED;
+        }
+        else {
+            m_lookup = LOOKUP_LINEAR;
+        }
+    }
+
+    void invalidateLookup() { m_lookup = LOOKUP_LINEAR; }
+
+    bool contains(const StlFriendlyNValue& value) const
+    {
+        switch (m_lookup) {
+        case LOOKUP_INTEGERS:
+            if (isIntegralType(ValuePeeker::peekValueType(value))) {
+                return std::binary_search(sortedIntegers(), sortedIntegers() + m_sortedCount,
+                                          ValuePeeker::peekAsBigInt(value));
+            }
+            // a non-integer probe (e.g. a DECIMAL) compares against the values
+            for (size_t ii = 0; ii < m_sortedCount; ++ii) {
+                if (value == sortedValues()[ii]) {
+                    return true;
+                }
+            }
+            return false;
+        case LOOKUP_SORTED:
+            return std::binary_search(sortedValues(), sortedValues() + m_sortedCount, value);
+        default:
+            return std::find(begin(), end(), value) != end();
+        }
+    }
+
+    enum LookupKind {
+        LOOKUP_LINEAR,   // values not sorted, scan them
+        LOOKUP_SORTED,   // binary search the sorted copy
+        LOOKUP_INTEGERS  // binary search the sorted int64 keys
+    };
+
     const size_t m_length;
     const ValueType m_elementType;
+    LookupKind m_lookup;
+    size_t m_sortedCount;
     StlFriendlyNValue m_values[0];
 };
 
@@ -464,11 +548,8 @@ bool NValue::inList(const NValue& rhs) const
     }
     const NValueList* listOfNValues = (NValueList*)rhs.getObjectValue();
     const StlFriendlyNValue& value = *static_cast<const StlFriendlyNValue*>(this);
-    //TODO: An O(ln(length)) implementation vs. the current O(length) implementation
-    // such as binary search would likely require some kind of sorting/re-org of values
-    // post-update/pre-lookup, and would likely require some sortable inequality method
-    // (operator<()?) to be defined on StlFriendlyNValue.
-    return std::find(listOfNValues->begin(), listOfNValues->end(), value) != listOfNValues->end();
+    // O(log(length)) once prepareInListLookup has sorted the list, O(length) otherwise.
+    return listOfNValues->contains(value);
 }
 
 void NValue::deserializeIntoANewNValueList(SerializeInput &input, Pool *dataPool)
@@ -480,8 +561,9 @@ void NValue::deserializeIntoANewNValueList(SerializeInput &input, Pool *dataPool
     ::memset(storage, 0, trueSize);
     NValueList* nvset = new (storage) NValueList(length, elementType);
     nvset->deserializeNValues(input, dataPool);
-    //TODO: An O(ln(length)) implementation vs. the current O(length) implementation of NValue::inList
-    // would likely require some kind of sorting/re-org of values at this point post-update pre-lookup.
+    // A deserialized list is a parameter, probed for every row of the
+    // fragment, so it is worth sorting now.
+    nvset->buildLookup();
 }
 
 void NValue::allocateANewNValueList(size_t length, ValueType elementType)
@@ -502,8 +584,14 @@ void NValue::setArrayElements(std::vector<NValue> &args) const
     while (ii--) {
         listOfNValues->m_values[ii] = args[ii];
     }
-    //TODO: An O(ln(length)) implementation vs. the current O(length) implementation of NValue::inList
-    // would likely require some kind of sorting/re-org of values at this point post-update pre-lookup.
+    listOfNValues->invalidateLookup();
+}
+
+void NValue::prepareInListLookup() const
+{
+    assert(m_valueType == VALUE_TYPE_ARRAY);
+    NValueList* listOfNValues = (NValueList*)getObjectValue();
+    listOfNValues->buildLookup();
 }
 
 int NValue::arrayLength() const
@@ -36,6 +36,8 @@
 
 #include "common/ExportSerializeIo.h"
 #include "common/FatalException.hpp"
+#include "common/JsonField.h"
+#include "common/LikePattern.h"
 #include "common/Pool.hpp"
 #include "common/SQLException.h"
 #include "common/StringRef.h"
@@ -292,6 +294,9 @@ class NValue {
     // See comment with inlined body, below.
     void allocateObjectFromInlinedValue(Pool* stringPool = NULL);
 
+    /* Check if an object value is read in place from the tuple that held it */
+    bool getSourceInlined() const { return m_sourceInlined; }
+
     /* Check if the value represents SQL NULL */
     bool isNull() const;
 
@@ -342,6 +347,15 @@ class NValue {
      * This NValue is the value and the rhs is the pattern
      */
     NValue like(const NValue rhs) const;
+    /*
+     * This NValue must be VARCHAR and is matched against a compiled pattern.
+     */
+    NValue like(const LikePattern &pattern) const;
+    /*
+     * This NValue must be VARCHAR, a JSON document, and the result is the
+     * SQL FIELD function of it for a compiled field. See jsonfunctions.h.
+     */
+    NValue jsonField(const JsonField &field) const;
 
     //TODO: passing NValue arguments by const reference SHOULD be standard practice
     // for the dozens of NValue "operator" functions. It saves on needless NValue copies.
@@ -530,6 +544,11 @@ class NValue {
     // The array size is predetermined in allocateANewNValueList.
     void setArrayElements(std::vector<NValue> &args) const;
 
+    // Sort the array elements so that inList can binary search them instead
+    // of scanning. Worth it only when the same list is probed many times;
+    // any later setArrayElements undoes it.
+    void prepareInListLookup() const;
+
     static ValueType promoteForOp(ValueType vta, ValueType vtb) {
         ValueType rt;
         switch (vta) {
@@ -582,6 +601,8 @@ class NValue {
     NValue opDivideDecimals(const NValue lhs, const NValue rhs) const;
     NValue opMultiplyDecimals(const NValue &lhs, const NValue &rhs) const;
 
+    bool matchesLike(const LikePattern &pattern) const;
+
     // Helpers for inList.
     // These are purposely not inlines to avoid exposure of NValueList details.
     void deserializeIntoANewNValueList(SerializeInput &input, Pool *dataPool);
@@ -735,6 +756,18 @@ class NValue {
         }
     }
 
+    /*
+     * Store a value short enough to take the place of the StringRef
+     * pointer in the slot of a non-inlined column (see StringRef::isShortString).
+     */
+    static void setShortStringToLocation(int32_t length, const void *value, char *location) {
+        assert(length <= StringRef::SHORT_STRING_MAX_LENGTH);
+        ::memset(location, 0, sizeof(StringRef*));
+        location[0] = StringRef::SHORT_STRING_TAG;
+        location[1] = static_cast<char>(length);
+        ::memcpy(location + 2, value, length);
+    }
+
     /*
      * Not truly symmetrical with getObjectValue which returns the actual object past
      * the length preceding value
@@ -2110,7 +2143,10 @@ inline void NValue::free() const {
     case VALUE_TYPE_VARBINARY:
     case VALUE_TYPE_ARRAY:
         {
-            assert(!m_sourceInlined);
+            // A value read from an inlined column or a short string slot owns no storage.
+            if (m_sourceInlined) {
+                return;
+            }
             StringRef* sref = *reinterpret_cast<StringRef* const*>(m_data);
             if (sref != NULL)
             {
@@ -2128,7 +2164,7 @@ inline void NValue::freeObjectsFromTupleStorage(std::vector<char*> const &oldObj
 
     for (std::vector<char*>::const_iterator it = oldObjects.begin(); it != oldObjects.end(); ++it) {
         StringRef* sref = reinterpret_cast<StringRef*>(*it);
-        if (sref != NULL) {
+        if (sref != NULL && !StringRef::isShortString(sref)) {
             StringRef::destroy(sref);
         }
     }
@@ -2337,6 +2373,15 @@ inline NValue NValue::initFromTupleStorage(const void *storage, ValueType type,
             break;
         }
 
+        // A short string is read in place, like an inlined one.
+        if (StringRef::isShortString(sref)) {
+            char* inline_data = reinterpret_cast<char*>(const_cast<void*>(storage)) + 1;
+            *reinterpret_cast<char**>(retval.m_data) = inline_data;
+            retval.setSourceInlined(true);
+            retval.setObjectLength(inline_data[0]); // this unsets the null tag.
+            break;
+        }
+
         // Cache the object length in the NValue.
 
         /* The format for a length preceding value is a 1-byte short representation
@@ -2437,6 +2482,10 @@ inline void NValue::serializeToTupleStorageAllocateForObjects(void *storage, con
                         msg);
 
                 }
+                if (length <= StringRef::SHORT_STRING_MAX_LENGTH) {
+                    setShortStringToLocation(length, getObjectValue(), static_cast<char*>(storage));
+                    break;
+                }
                 StringRef* sref = StringRef::create(minlength, dataPool);
                 char *copy = sref->get();
                 setObjectLengthToLocation(length, copy);
@@ -2495,6 +2544,12 @@ inline void NValue::serializeToTupleStorage(void *storage, const bool isInlined,
             if (isNull() || getObjectLength() <= maxLength) {
                 if (m_sourceInlined && !isInlined)
                 {
+                    // A value short enough to have come from a short string slot goes into one.
+                    if (!isNull() && getObjectLength() <= StringRef::SHORT_STRING_MAX_LENGTH) {
+                        setShortStringToLocation(getObjectLength(), getObjectValue(),
+                                                 static_cast<char*>(storage));
+                        break;
+                    }
                     throwDynamicSQLException(
                             "Cannot serialize an inlined string to non-inlined tuple storage in serializeToTupleStorage()");
                 }
@@ -2572,6 +2627,10 @@ inline void NValue::deserializeFrom(SerializeInput &input, const ValueType type,
                   return;
               }
               const char *data = reinterpret_cast<const char*>(input.getRawPointer(length));
+              if (length <= StringRef::SHORT_STRING_MAX_LENGTH) {
+                  setShortStringToLocation(length, data, storage);
+                  break;
+              }
               const int32_t minlength = lengthLength + length;
               StringRef* sref = StringRef::create(minlength, dataPool);
               char* copy = sref->get();
@@ -3259,115 +3318,31 @@ inline NValue NValue::like(const NValue rhs) const {
                 getTypeName(VALUE_TYPE_VARCHAR).c_str());
     }
 
-    const int32_t valueUTF8Length = getObjectLength();
-    const int32_t patternUTF8Length = rhs.getObjectLength();
+    const char *patternChars = reinterpret_cast<const char*>(rhs.getObjectValue());
+    const LikePattern pattern(patternChars, rhs.getObjectLength());
+    return matchesLike(pattern) ? getTrue() : getFalse();
+}
 
-    if (0 == patternUTF8Length) {
-        if (0 == valueUTF8Length) {
-            return getTrue();
-        } else {
-            return getFalse();
-        }
+/*
+ * The same, matching against a pattern already compiled from a constant
+ * or parameter, as a LIKE expression's right side is for each fragment.
+ */
+inline NValue NValue::like(const LikePattern &pattern) const {
+    if (isNull()) {
+        return getFalse();
     }
+    if (getValueType() != VALUE_TYPE_VARCHAR) {
+        throwDynamicSQLException(
+                "lhs of LIKE expression is %s not %s",
+                getValueTypeString().c_str(),
+                getTypeName(VALUE_TYPE_VARCHAR).c_str());
+    }
+    return matchesLike(pattern) ? getTrue() : getFalse();
+}
 
-    char *valueChars = reinterpret_cast<char*>(getObjectValue());
-    char *patternChars = reinterpret_cast<char*>(rhs.getObjectValue());
-    assert(valueChars);
-    assert(patternChars);
-
-    /*
-     * Because lambdas are for poseurs.
-     */
-    class Liker {
-
-    private:
-        // Constructor used internally for temporary recursion contexts.
-        Liker( const Liker& original, const char* valueChars, const char* patternChars) :
-            m_value(original.m_value, valueChars),
-            m_pattern(original.m_pattern, patternChars)
-             {}
-
-    public:
-        Liker(char *valueChars, char* patternChars, int32_t valueUTF8Length, int32_t patternUTF8Length) :
-            m_value(valueChars, valueChars + valueUTF8Length),
-            m_pattern(patternChars, patternChars + patternUTF8Length)
-             {}
-
-        bool like() {
-            while ( ! m_pattern.atEnd()) {
-                const uint32_t nextPatternCodePoint = m_pattern.extractCodePoint();
-                switch (nextPatternCodePoint) {
-                case '%': {
-                    if (m_pattern.atEnd()) {
-                        return true;
-                    }
-
-                    const char *postPercentPatternIterator = m_pattern.getCursor();
-                    const uint32_t nextPatternCodePointAfterPercent = m_pattern.extractCodePoint();
-                    const bool nextPatternCodePointAfterPercentIsSpecial =
-                            (nextPatternCodePointAfterPercent == '_') ||
-                            (nextPatternCodePointAfterPercent == '%');
-
-                    /*
-                     * This loop tries to skip as many characters as possible with the % by checking
-                     * if the next value character matches the pattern character after the %.
-                     *
-                     * If the next pattern character is special then we always have to recurse to
-                     * match that character. For stacked %s this just skips to the last one.
-                     * For stacked _ it will recurse and demand the correct number of characters.
-                     *
-                     * For a regular character it will recurse if the value character matches the pattern character.
-                     * This saves doing a function call per character and allows us to skip if there is no match.
-                     */
-                    while ( ! m_value.atEnd()) {
-
-                        const char *preExtractionValueIterator = m_value.getCursor();
-                        const uint32_t nextValueCodePoint = m_value.extractCodePoint();
-
-                        const bool nextPatternCodePointIsSpecialOrItEqualsNextValueCodePoint =
-                                (nextPatternCodePointAfterPercentIsSpecial ||
-                                        (nextPatternCodePointAfterPercent == nextValueCodePoint));
-
-                        if ( nextPatternCodePointIsSpecialOrItEqualsNextValueCodePoint) {
-                            Liker recursionContext( *this, preExtractionValueIterator, postPercentPatternIterator);
-                            if (recursionContext.like()) {
-                                return true;
-                            }
-                        }
-                    }
-                    return false;
-                }
-                case '_': {
-                    if ( m_value.atEnd()) {
-                        return false;
-                    }
-                    //Extract a code point to consume a character
-                    m_value.extractCodePoint();
-                    break;
-                }
-                default: {
-                    if ( m_value.atEnd()) {
-                        return false;
-                    }
-                    const int nextValueCodePoint = m_value.extractCodePoint();
-                    if (nextPatternCodePoint != nextValueCodePoint) {
-                        return false;
-                    }
-                    break;
-                }
-                }
-            }
-            //A matching value ends exactly where the pattern ends (having already accounted for '%')
-            return m_value.atEnd();
-        }
-
-        UTF8Iterator m_value;
-        UTF8Iterator m_pattern;
-    };
-
-    Liker liker(valueChars, patternChars, valueUTF8Length, patternUTF8Length);
-
-    return liker.like() ? getTrue() : getFalse();
+inline bool NValue::matchesLike(const LikePattern &pattern) const {
+    const char *valueChars = reinterpret_cast<const char*>(getObjectValue());
+    return pattern.matches(valueChars, getObjectLength());
 }
 
 } // namespace voltdb
@@ -0,0 +1,168 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLELSORT_H_
+#define PARALLELSORT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace voltdb {
+
+/**
+ * Sorts large vectors on a few short-lived threads, for building an index
+ * over a whole table at once. The vector is cut into one run per thread
+ * and each thread sorts its run; the sorted runs are then merged pairwise,
+ * the merges of each round again running on their own threads, so only
+ * the last merge is done by a single thread. The calling thread takes a
+ * share of the work and returns once every thread is done.
+ *
+ * The comparator is called from several threads at once, so it must only
+ * read the values it compares. In particular it must not allocate from
+ * the ThreadLocalPool or use the ExecutorContext, which belong to the
+ * site thread.
+ */
+class ParallelSort {
+public:
+    // fewer values than this are not worth starting threads for
+    static const size_t MIN_PARALLEL_SIZE = 1 << 16;
+    // every site of the host may be updating its catalog at the same
+    // time, so each one only takes a few cores
+    static const int MAX_THREADS = 4;
+
+    /** The number of threads, the caller's included, to sort count values on. */
+    static int threadsFor(size_t count) {
+        if (count < MIN_PARALLEL_SIZE) {
+            return 1;
+        }
+        const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cores <= 1) {
+            return 1;
+        }
+        return cores < MAX_THREADS ? static_cast<int>(cores) : MAX_THREADS;
+    }
+
+    /**
+     * Sort values on the given number of threads. The order of values
+     * that compare equal is unspecified, as with std::sort.
+     */
+    template <typename T, typename Compare>
+    static void sort(std::vector<T> &values, Compare comp, int threads) {
+        const size_t count = values.size();
+        if (threads <= 1 || count < static_cast<size_t>(threads) * 2) {
+            std::sort(values.begin(), values.end(), comp);
+            return;
+        }
+
+        // runs[ii] to runs[ii + 1] is the ii-th run
+        std::vector<size_t> runs;
+        for (int ii = 0; ii <= threads; ++ii) {
+            runs.push_back(count * ii / threads);
+        }
+        T *from = &values[0];
+        std::vector<Task<T, Compare> > tasks;
+        for (int ii = 0; ii < threads; ++ii) {
+            tasks.push_back(Task<T, Compare>(from + runs[ii], NULL, from + runs[ii + 1],
+                                             NULL, comp));
+        }
+        runAll(tasks);
+
+        // each round merges pairs of runs into the other buffer
+        std::vector<T> scratch(count);
+        T *to = &scratch[0];
+        while (runs.size() > 2) {
+            tasks.clear();
+            std::vector<size_t> merged;
+            for (size_t ii = 0; ii + 1 < runs.size(); ii += 2) {
+                merged.push_back(runs[ii]);
+                // a run left without a partner is merged with nothing, a copy
+                const size_t last = ii + 2 < runs.size() ? runs[ii + 2] : runs[ii + 1];
+                tasks.push_back(Task<T, Compare>(from + runs[ii], from + runs[ii + 1], from + last,
+                                                 to + runs[ii], comp));
+            }
+            merged.push_back(count);
+            runAll(tasks);
+            runs.swap(merged);
+            std::swap(from, to);
+        }
+        if (from != &values[0]) {
+            values.swap(scratch);
+        }
+    }
+
+private:
+    /*
+     * Sorts first to last in place when out is NULL, or else merges the
+     * sorted first to middle and middle to last into out.
+     */
+    template <typename T, typename Compare>
+    struct Task {
+        Task(T *first, T *middle, T *last, T *out, Compare comp)
+            : m_first(first), m_middle(middle), m_last(last), m_out(out), m_comp(comp) {}
+
+        void run() {
+            if (m_out == NULL) {
+                std::sort(m_first, m_last, m_comp);
+            } else {
+                std::merge(m_first, m_middle, m_middle, m_last, m_out, m_comp);
+            }
+        }
+
+        static void *start(void *task) {
+            static_cast<Task*>(task)->run();
+            return NULL;
+        }
+
+        T *m_first;
+        T *m_middle;
+        T *m_last;
+        T *m_out;
+        Compare m_comp;
+    };
+
+    /*
+     * Run every task, each but the last on a thread of its own, and wait
+     * for them all. A task whose thread can't be started runs on the
+     * calling thread instead.
+     */
+    template <typename TaskType>
+    static void runAll(std::vector<TaskType> &tasks) {
+        const size_t count = tasks.size();
+        std::vector<pthread_t> threads(count);
+        std::vector<bool> started(count, false);
+        for (size_t ii = 0; ii + 1 < count; ++ii) {
+            started[ii] = pthread_create(&threads[ii], NULL, &TaskType::start, &tasks[ii]) == 0;
+        }
+        for (size_t ii = 0; ii < count; ++ii) {
+            if ( ! started[ii]) {
+                tasks[ii].run();
+            }
+        }
+        for (size_t ii = 0; ii < count; ++ii) {
+            if (started[ii]) {
+                pthread_join(threads[ii], NULL);
+            }
+        }
+    }
+};
+
+} // namespace voltdb
+
+#endif // PARALLELSORT_H_
@@ -0,0 +1,137 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/SharedBufferRing.h"
+#include "common/FatalException.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace voltdb;
+
+static const std::size_t PAGE_SIZE_BYTES = 4096;
+
+static std::size_t roundToPages(std::size_t size) {
+    return (size + PAGE_SIZE_BYTES - 1) & ~(PAGE_SIZE_BYTES - 1);
+}
+
+SharedBufferRing::SharedBufferRing(int count, std::size_t capacity, const std::string &path)
+    : m_capacity(capacity), m_stride(roundToPages(capacity)), m_path(path),
+      m_fileMapping(NULL), m_buffers(count, static_cast<char*>(NULL)), m_written(count, 0),
+      m_current(-1)
+{
+    assert(count > 0);
+    if (m_path.empty()) {
+        for (int ii = 0; ii < count; ii++) {
+            m_buffers[ii] = mapAnonymous();
+        }
+        return;
+    }
+
+    // The file is sparse, so its size costs nothing until it is written.
+    const std::size_t fileSize = m_stride * count;
+    int fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(fileSize)) != 0) {
+        const int error = errno;
+        if (fd >= 0) {
+            ::close(fd);
+            ::unlink(m_path.c_str());
+        }
+        throwFatalException("Failed to create result buffer file %s: %s",
+                            m_path.c_str(), strerror(error));
+    }
+    void *mapped = ::mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int error = errno;
+    // the mapping keeps the file open
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        ::unlink(m_path.c_str());
+        throwFatalException("Failed to map %d bytes of result buffer file %s: %s",
+                            static_cast<int32_t>(fileSize), m_path.c_str(), strerror(error));
+    }
+    m_fileMapping = static_cast<char*>(mapped);
+    for (int ii = 0; ii < count; ii++) {
+        m_buffers[ii] = m_fileMapping + m_stride * ii;
+    }
+}
+
+SharedBufferRing::~SharedBufferRing()
+{
+    if (m_fileMapping != NULL) {
+        ::munmap(m_fileMapping, m_stride * m_buffers.size());
+        // The reader may already have unlinked it once it mapped it.
+        ::unlink(m_path.c_str());
+        return;
+    }
+    for (std::size_t ii = 0; ii < m_buffers.size(); ii++) {
+        unmap(m_buffers[ii], m_capacity);
+    }
+}
+
+char *SharedBufferRing::mapAnonymous()
+{
+    // Reserve address space only; pages are committed as they are written.
+    void *mapped = ::mmap(NULL, m_stride, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (mapped == MAP_FAILED) {
+        throwFatalException("Failed to map a %d byte result buffer",
+                            static_cast<int32_t>(m_stride));
+    }
+    return static_cast<char*>(mapped);
+}
+
+char *SharedBufferRing::advance(std::size_t written)
+{
+    if (m_current >= 0 && written > m_written[m_current]) {
+        m_written[m_current] = written;
+    }
+    m_current = (m_current + 1) % count();
+    trim(m_current);
+    return m_buffers[m_current];
+}
+
+void SharedBufferRing::trim(int index)
+{
+    if (m_written[index] <= RETAINED_BYTES) {
+        return;
+    }
+    char *start = m_buffers[index] + RETAINED_BYTES;
+    const std::size_t length = roundToPages(m_written[index]) - RETAINED_BYTES;
+    // Anonymous pages come back as zeros; holes are punched in the file.
+    ::madvise(start, length, m_fileMapping != NULL ? MADV_REMOVE : MADV_DONTNEED);
+    m_written[index] = 0;
+}
+
+char *SharedBufferRing::detach(int index)
+{
+    assert(m_fileMapping == NULL);
+    char *detached = m_buffers[index];
+    m_buffers[index] = mapAnonymous();
+    m_written[index] = 0;
+    return detached;
+}
+
+void SharedBufferRing::unmap(char *buffer, std::size_t capacity)
+{
+    ::munmap(buffer, roundToPages(capacity));
+}
@@ -0,0 +1,98 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDBUFFERRING_H_
+#define SHAREDBUFFERRING_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace voltdb {
+
+/**
+ * A ring of result buffers the EE writes into and its caller reads
+ * from in place, taken in turn by each call that produces results.
+ *
+ * Each buffer reserves its full capacity of address space up front but
+ * is only backed by memory as it is written, so a buffer grows in place
+ * up to the result size limit without ever being copied. When the ring
+ * comes back around to a buffer that was written past RETAINED_BYTES,
+ * the pages beyond that are handed back to the system.
+ *
+ * Without a path the buffers are private anonymous memory, which a JVM
+ * in the same process wraps in direct ByteBuffers. With a path they are
+ * consecutive regions of a file created there (best put on a tmpfs such
+ * as /dev/shm) and mapped shared, so another process can map the file
+ * and read them. A ring is not thread safe.
+ */
+class SharedBufferRing {
+public:
+    /** Written bytes of a buffer kept backed when the ring returns to it. */
+    static const std::size_t RETAINED_BYTES = 1024 * 1024 * 10;
+
+    SharedBufferRing(int count, std::size_t capacity, const std::string &path = std::string());
+    ~SharedBufferRing();
+
+    int count() const { return static_cast<int>(m_buffers.size()); }
+    std::size_t capacity() const { return m_capacity; }
+    /** Distance between the starts of consecutive buffers of the file. */
+    std::size_t stride() const { return m_stride; }
+    const std::string &path() const { return m_path; }
+
+    char *buffer(int index) const { return m_buffers[index]; }
+    /** The buffer most recently advanced to, or -1 before the first. */
+    int current() const { return m_current; }
+
+    /**
+     * Move on to the next buffer, recording how many bytes were written
+     * to the current one, and return it.
+     */
+    char *advance(std::size_t written);
+
+    /**
+     * Give up a buffer of an anonymous ring whose contents are still in
+     * use, mapping a fresh one in its place. The caller owns the old
+     * buffer, and frees it with unmap() once it is done with it.
+     */
+    char *detach(int index);
+
+    /** Free a buffer of the given capacity given up by detach(). */
+    static void unmap(char *buffer, std::size_t capacity);
+
+private:
+    // not copyable
+    SharedBufferRing(const SharedBufferRing&);
+    SharedBufferRing &operator=(const SharedBufferRing&);
+
+    char *mapAnonymous();
+    void trim(int index);
+
+    const std::size_t m_capacity;
+    const std::size_t m_stride;
+    const std::string m_path;
+    // the single mapping of the whole file, if there is one
+    char *m_fileMapping;
+    std::vector<char*> m_buffers;
+    // bytes written to each buffer since it was last trimmed
+    std::vector<std::size_t> m_written;
+    int m_current;
+};
+
+}
+
+#endif /* SHAREDBUFFERRING_H_ */
@@ -0,0 +1,121 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/SlabPool.h"
+#include "common/FatalException.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <sys/mman.h>
+
+using namespace voltdb;
+
+static const std::size_t PAGE_SIZE_BYTES = 4096;
+
+static pthread_once_t s_hugePagesOnce = PTHREAD_ONCE_INIT;
+static bool s_adviseHugePages = false;
+
+/*
+ * Advising huge pages only pays when faulting one in doesn't stall. With
+ * the kernel's transparent huge page defrag setting at always, madvise or
+ * defer+madvise, a fault in an advised region compacts memory until it
+ * finds a free huge page, which can take far longer than the allocation
+ * saves. Otherwise the fault takes a huge page if one is free, and the
+ * kernel collapses the slab into one later if not.
+ */
+static void checkHugePages() {
+#ifdef MADV_HUGEPAGE
+    FILE *defrag = fopen("/sys/kernel/mm/transparent_hugepage/defrag", "r");
+    if (defrag == NULL) {
+        return;
+    }
+    char setting[128];
+    if (fgets(setting, sizeof(setting), defrag) != NULL) {
+        s_adviseHugePages = strstr(setting, "[defer]") != NULL || strstr(setting, "[never]") != NULL;
+    }
+    fclose(defrag);
+#endif
+}
+
+SlabPool::SlabPool(std::size_t size)
+    : m_freeList(NULL), m_next(NULL), m_end(NULL)
+{
+    // every chunk must be able to hold the free list link, and be aligned for it
+    std::size_t chunkSize = size < sizeof(void*) ? sizeof(void*) : size;
+    chunkSize = (chunkSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    m_stats.requestedSize = size;
+    m_stats.chunkSize = chunkSize;
+    if (chunkSize * 2 <= SLAB_SIZE) {
+        m_slabSize = SLAB_SIZE;
+    } else {
+        m_slabSize = (chunkSize * 2 + PAGE_SIZE_BYTES - 1) & ~(PAGE_SIZE_BYTES - 1);
+    }
+}
+
+SlabPool::~SlabPool()
+{
+    for (std::size_t ii = 0; ii < m_slabs.size(); ii++) {
+        ::munmap(m_slabs[ii], m_slabSize);
+    }
+}
+
+void SlabPool::newSlab()
+{
+    char *slab = NULL;
+    if (m_slabSize == SLAB_SIZE) {
+        // Map a huge page more than needed and trim it down to a slab on a
+        // huge page boundary, so that the whole slab can be one huge page.
+        char *mapped = static_cast<char*>(::mmap(NULL, m_slabSize + SLAB_SIZE,
+                                                 PROT_READ | PROT_WRITE,
+                                                 MAP_PRIVATE | MAP_ANON, -1, 0));
+        if (mapped != MAP_FAILED) {
+            slab = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(mapped) + SLAB_SIZE - 1) & ~(uintptr_t)(SLAB_SIZE - 1));
+            if (slab != mapped) {
+                ::munmap(mapped, slab - mapped);
+            }
+            const std::size_t tail = (mapped + m_slabSize + SLAB_SIZE) - (slab + m_slabSize);
+            if (tail != 0) {
+                ::munmap(slab + m_slabSize, tail);
+            }
+#ifdef MADV_HUGEPAGE
+            (void)pthread_once(&s_hugePagesOnce, checkHugePages);
+            if (s_adviseHugePages) {
+                // only advice; without transparent huge pages this does nothing
+                ::madvise(slab, m_slabSize, MADV_HUGEPAGE);
+            }
+#endif
+        }
+    } else {
+        void *mapped = ::mmap(NULL, m_slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (mapped != MAP_FAILED) {
+            slab = static_cast<char*>(mapped);
+        }
+    }
+    if (slab == NULL) {
+        throwFatalException("Failed to map a %d byte slab for %d byte allocations",
+                            static_cast<int32_t>(m_slabSize),
+                            static_cast<int32_t>(m_stats.chunkSize));
+    }
+    m_slabs.push_back(slab);
+    m_next = slab;
+    // the tail too small for a whole chunk goes unused
+    m_end = slab + (m_slabSize / m_stats.chunkSize) * m_stats.chunkSize;
+    ++m_stats.slabs;
+    m_stats.bytesAllocated += m_slabSize;
+}
@@ -0,0 +1,112 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLABPOOL_H_
+#define SLABPOOL_H_
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * Allocation counts of one SlabPool.
+ */
+struct SlabPoolStats {
+    SlabPoolStats()
+        : requestedSize(0), chunkSize(0), slabs(0), bytesAllocated(0),
+          chunksInUse(0), allocations(0) {}
+
+    // the size the pool was created for, and the size of the chunks it hands out
+    std::size_t requestedSize;
+    std::size_t chunkSize;
+    std::size_t slabs;
+    // bytes of slabs mapped, whether or not they have been handed out
+    std::size_t bytesAllocated;
+    std::size_t chunksInUse;
+    // every malloc since the pool was created
+    int64_t allocations;
+};
+
+/**
+ * A pool of fixed size chunks carved out of large slabs, for the
+ * ThreadLocalPool. Freed chunks go on the head of an unordered free list
+ * that is threaded through the chunks themselves, so malloc and free are
+ * each a couple of pointer moves. New slabs are handed out in address
+ * order as they are needed rather than all threaded on the free list at
+ * once, so only the part of a slab in use is ever touched.
+ *
+ * Slabs of small chunks are 2 megabytes, mapped on a 2 megabyte boundary
+ * so that each can be backed by one transparent huge page, and advised to
+ * be when that won't stall page faults; slabs of chunks too big for that
+ * hold just two of them. Slabs are only returned to the system when
+ * the pool is destroyed. A pool is not thread safe.
+ */
+class SlabPool {
+public:
+    static const std::size_t SLAB_SIZE = 2 * 1024 * 1024;
+
+    explicit SlabPool(std::size_t size);
+    ~SlabPool();
+
+    void *malloc() {
+        void *chunk;
+        if (m_freeList != NULL) {
+            chunk = m_freeList;
+            m_freeList = *static_cast<void**>(chunk);
+        } else {
+            if (m_next == m_end) {
+                newSlab();
+            }
+            chunk = m_next;
+            m_next += m_stats.chunkSize;
+        }
+        ++m_stats.allocations;
+        ++m_stats.chunksInUse;
+        return chunk;
+    }
+
+    void free(void *chunk) {
+        --m_stats.chunksInUse;
+        *static_cast<void**>(chunk) = m_freeList;
+        m_freeList = chunk;
+    }
+
+    std::size_t getRequestedSize() const { return m_stats.requestedSize; }
+    std::size_t getBytesAllocated() const { return m_stats.bytesAllocated; }
+    const SlabPoolStats &getStats() const { return m_stats; }
+
+private:
+    // not copyable
+    SlabPool(const SlabPool&);
+    SlabPool &operator=(const SlabPool&);
+
+    void newSlab();
+
+    void *m_freeList;
+    // the part of the newest slab not handed out yet
+    char *m_next;
+    char *m_end;
+    std::size_t m_slabSize;
+    std::vector<char*> m_slabs;
+    SlabPoolStats m_stats;
+};
+
+}
+
+#endif /* SLABPOOL_H_ */
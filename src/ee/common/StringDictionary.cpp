@@ -0,0 +1,167 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/StringDictionary.h"
+#include "common/ThreadLocalPool.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include "boost/unordered_set.hpp"
+#include "murmur3/MurmurHash3.h"
+
+using namespace voltdb;
+
+namespace {
+
+/*
+ * Entries are hashed by their bytes, which compaction may move, so the set
+ * holds the entries and looks their bytes up as it goes. A key with no
+ * entry probes for the given bytes.
+ */
+template <typename Entry>
+struct Key {
+    Key(const Entry *entry) : m_entry(entry), m_data(NULL), m_length(0) {}
+    Key(const char *data, int32_t length) : m_entry(NULL), m_data(data), m_length(length) {}
+
+    const char *data() const { return m_entry != NULL ? m_entry->data() : m_data; }
+    int32_t length() const { return m_entry != NULL ? m_entry->m_length : m_length; }
+
+    const Entry *m_entry;
+    const char *m_data;
+    int32_t m_length;
+};
+
+struct KeyHasher {
+    template <typename K>
+    std::size_t operator()(const K &key) const {
+        return static_cast<std::size_t>(MurmurHash3_x64_128(key.data(), key.length(), 0));
+    }
+};
+
+struct KeyEqualityChecker {
+    template <typename K>
+    bool operator()(const K &lhs, const K &rhs) const {
+        return lhs.length() == rhs.length() &&
+            ::memcmp(lhs.data(), rhs.data(), lhs.length()) == 0;
+    }
+};
+
+}
+
+class StringDictionary::EntrySet
+    : public boost::unordered_set<Key<Entry>, KeyHasher, KeyEqualityChecker> {
+};
+
+StringDictionary::StringDictionary()
+    : m_entries(new EntrySet()), m_references(0), m_referencedBytes(0), m_entryBytes(0)
+{
+}
+
+StringDictionary::~StringDictionary()
+{
+    // Entries still referenced (from undo actions not yet released) are
+    // freed by their last release.
+    for (EntrySet::iterator iter = m_entries->begin(); iter != m_entries->end(); ++iter) {
+        const_cast<Entry*>(iter->m_entry)->m_dictionary = NULL;
+    }
+    delete m_entries;
+}
+
+std::size_t StringDictionary::entryCount() const
+{
+    return m_entries->size();
+}
+
+std::size_t StringDictionary::entryMemoryUsed(int32_t length)
+{
+    return StringRef::computeStringMemoryUsed(length) - sizeof(StringRef) + sizeof(Entry);
+}
+
+StringRef *StringDictionary::intern(StringRef *copy, const char *data, int32_t length)
+{
+    assert( ! copy->m_dictionaryEntry);
+    ++m_references;
+    m_referencedBytes += StringRef::computeStringMemoryUsed(length);
+
+    EntrySet::iterator iter = m_entries->find(Key<Entry>(data, length));
+    if (iter != m_entries->end()) {
+        Entry *entry = const_cast<Entry*>(iter->m_entry);
+        ++entry->m_refCount;
+        StringRef::destroy(copy);
+        return &entry->m_ref;
+    }
+
+    // Copy the string, length prefix and all, into a new entry.
+    const std::size_t size = copy->m_size - sizeof(StringRef*);
+#ifdef MEMCHECK
+    Entry *entry = static_cast<Entry*>(::operator new(sizeof(Entry)));
+#else
+    Entry *entry = static_cast<Entry*>(ThreadLocalPool::getExact(sizeof(Entry))->malloc());
+#endif
+    new (&entry->m_ref) StringRef(size);
+    ::memcpy(entry->m_ref.get(), copy->get(), size);
+    entry->m_ref.m_dictionaryEntry = true;
+    entry->m_dictionary = this;
+    entry->m_refCount = 1;
+    entry->m_length = length;
+    StringRef::destroy(copy);
+
+    m_entries->insert(Key<Entry>(entry));
+    m_entryBytes += entryMemoryUsed(length);
+    return &entry->m_ref;
+}
+
+const StringRef *StringDictionary::find(const char *data, int32_t length) const
+{
+    EntrySet::const_iterator iter = m_entries->find(Key<Entry>(data, length));
+    if (iter == m_entries->end()) {
+        return NULL;
+    }
+    return &iter->m_entry->m_ref;
+}
+
+void StringDictionary::release(StringRef *sref)
+{
+    assert(sref->m_dictionaryEntry);
+    Entry *entry = reinterpret_cast<Entry*>(sref);
+    assert(entry->m_refCount > 0);
+    StringDictionary *dictionary = entry->m_dictionary;
+    if (dictionary != NULL) {
+        --dictionary->m_references;
+        dictionary->m_referencedBytes -= StringRef::computeStringMemoryUsed(entry->m_length);
+    }
+    if (--entry->m_refCount != 0) {
+        return;
+    }
+    if (dictionary != NULL) {
+        dictionary->m_entries->erase(Key<Entry>(entry));
+        dictionary->m_entryBytes -= entryMemoryUsed(entry->m_length);
+    }
+    freeEntry(entry);
+}
+
+void StringDictionary::freeEntry(Entry *entry)
+{
+    // frees the string
+    entry->m_ref.~StringRef();
+#ifdef MEMCHECK
+    ::operator delete(entry);
+#else
+    ThreadLocalPool::getExact(sizeof(Entry))->free(entry);
+#endif
+}
@@ -0,0 +1,121 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STRINGDICTIONARY_H_
+#define STRINGDICTIONARY_H_
+
+#include "common/StringRef.h"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * The distinct values of one dictionary encoded string column of a
+ * persistent table. Each distinct value is stored once, as a reference
+ * counted StringRef entry, and every tuple holding that value stores a
+ * pointer to the shared entry where it would otherwise own a copy. The
+ * entry pointer is the value's code: two values in the same dictionary
+ * are equal if and only if their codes are. Values short enough to be
+ * kept in the tuple slot itself (see StringRef::isShortString) stay there.
+ *
+ * Tuples keep reading their values through the StringRef as before. A
+ * reference is dropped wherever a tuple's own string would have been
+ * destroyed (StringRef::destroy hands entries back here), so deletes,
+ * updates and truncates release their references only when their undo
+ * actions are released, and undone inserts and updates release theirs
+ * as soon as they are undone.
+ */
+class StringDictionary {
+public:
+    StringDictionary();
+    ~StringDictionary();
+
+    /**
+     * Trade a string just allocated for a tuple of the column, holding
+     * the given bytes, for the column's shared entry with those bytes,
+     * which gains a reference. The copy is destroyed, or becomes the
+     * entry if the value is new.
+     */
+    StringRef *intern(StringRef *copy, const char *data, int32_t length);
+
+    /**
+     * The entry with the given bytes, if any, without taking a reference.
+     */
+    const StringRef *find(const char *data, int32_t length) const;
+
+    /**
+     * The dictionary a string is an entry of, or NULL if it is a string
+     * of its own.
+     */
+    static const StringDictionary *dictionaryOf(const StringRef *sref) {
+        return sref->m_dictionaryEntry ? reinterpret_cast<const Entry*>(sref)->m_dictionary : NULL;
+    }
+
+    /**
+     * Drop a reference to an entry, freeing it with the last one.
+     */
+    static void release(StringRef *sref);
+
+    std::size_t entryCount() const;
+    int64_t referenceCount() const { return m_references; }
+
+    /**
+     * Bytes the column's values would take as separate copies (as
+     * counted by StringRef::computeStringMemoryUsed) less the bytes its
+     * entries take. Negative while most values are referenced once.
+     */
+    int64_t bytesSaved() const { return m_referencedBytes - m_entryBytes; }
+
+private:
+    // not copyable
+    StringDictionary(const StringDictionary&);
+    StringDictionary &operator=(const StringDictionary&);
+
+    /*
+     * A shared string. The StringRef comes first, so a pointer to it is
+     * a pointer to the entry.
+     */
+    struct Entry {
+        StringRef m_ref;
+        // NULL once the dictionary is destroyed ahead of the last reference
+        StringDictionary *m_dictionary;
+        int32_t m_refCount;
+        // length of the value, which follows its length prefix in the string
+        int32_t m_length;
+
+        const char *data() const {
+            return m_ref.get() + (m_ref.m_size - sizeof(StringRef*) - m_length);
+        }
+    };
+
+    // the set of entries, hashed by their bytes
+    class EntrySet;
+
+    static std::size_t entryMemoryUsed(int32_t length);
+    static void freeEntry(Entry *entry);
+
+    EntrySet *m_entries;
+    int64_t m_references;
+    int64_t m_referencedBytes;
+    int64_t m_entryBytes;
+};
+
+}
+
+#endif /* STRINGDICTIONARY_H_ */
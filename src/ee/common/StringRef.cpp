@@ -20,6 +20,7 @@
 #include "Pool.hpp"
 #include "ThreadLocalPool.h"
 #include "CompactingStringStorage.h"
+#include "StringDictionary.h"
 
 using namespace voltdb;
 using namespace std;
@@ -67,6 +68,11 @@ StringRef::create(size_t size, Pool* dataPool)
 void
 StringRef::destroy(StringRef* sref)
 {
+    if (sref->m_dictionaryEntry)
+    {
+        StringDictionary::release(sref);
+        return;
+    }
 #ifdef MEMCHECK
     delete sref;
 #else
@@ -83,6 +89,7 @@ StringRef::StringRef(size_t size)
 {
     m_size = size + sizeof(StringRef*);
     m_tempPool = false;
+    m_dictionaryEntry = false;
 #ifdef MEMCHECK
     m_stringPtr = new char[m_size];
 #else
@@ -95,6 +102,7 @@ StringRef::StringRef(size_t size)
 StringRef::StringRef(std::size_t size, Pool* dataPool)
 {
     m_tempPool = true;
+    m_dictionaryEntry = false;
     m_stringPtr =
         reinterpret_cast<char*>(dataPool->allocate(size + sizeof(StringRef*)));
     setBackPtr();
@@ -39,7 +39,25 @@ namespace voltdb
         /// string pool.
         static std::size_t computeStringMemoryUsed(std::size_t length);
 
+        /// Values of up to SHORT_STRING_MAX_LENGTH bytes are stored in
+        /// the tuple slot of a non-inlined column in place of a
+        /// StringRef pointer, and use no memory of their own.  The
+        /// slot's first byte (the low byte of a pointer, which is
+        /// always even) is SHORT_STRING_TAG, and the value follows in
+        /// the form an inlined column stores it: a one byte length and
+        /// the bytes, zero padded.
+        static const int SHORT_STRING_MAX_LENGTH = 6;
+        static const char SHORT_STRING_TAG = 1;
+
+        /// Whether the contents of a non-inlined column's slot are a
+        /// short string rather than a pointer to a StringRef.
+        static bool isShortString(const StringRef* slot)
+        {
+            return (reinterpret_cast<std::size_t>(slot) & SHORT_STRING_TAG) != 0;
+        }
+
         friend class CompactingStringPool;
+        friend class StringDictionary;
         /// Create and return a new StringRef object which points to an
         /// allocated memory block of the requested size.  The caller
         /// may provide an optional Pool from which the memory (and
@@ -53,7 +71,8 @@ namespace voltdb
         /// any, allocated from pools to store the object.
         /// sref must have been allocated and returned by a call to
         /// StringRef::create() and must not have been created in a
-        /// temporary Pool
+        /// temporary Pool.  A StringDictionary entry only loses the
+        /// reference the caller held.
         static void destroy(StringRef* sref);
 
         char* get();
@@ -72,6 +91,8 @@ namespace voltdb
 
         std::size_t m_size;
         bool m_tempPool;
+        // shared by the tuples of a dictionary encoded column
+        bool m_dictionaryEntry;
         char* m_stringPtr;
     };
 }
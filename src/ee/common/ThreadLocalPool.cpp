@@ -18,6 +18,7 @@
 #include <pthread.h>
 #include <boost/unordered_map.hpp>
 #include "common/FatalException.hpp"
+#include <algorithm>
 #include <iostream>
 #include "common/SQLException.h"
 
@@ -32,30 +33,56 @@ namespace voltdb {
  */
 static pthread_key_t m_key;
 static pthread_key_t m_stringKey;
+static pthread_once_t m_keyOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * One more than the largest index returned by sizeClassIndex, which is
+ * that of the largest allocation size, 1 megabyte and a bit.
+ */
+static const int SIZE_CLASS_COUNT = 42;
+static const std::size_t LARGEST_SIZE_CLASS_BELOW_MAX = 512 * 1024 + 256 * 1024;
+
 /**
- * Thread local key for storing integer value of amount of memory allocated
+ * A thread's pools, by the exact size they allocate. The pools of the
+ * approximate sizes handed out by get are also indexed by size class so
+ * they can be found without a hash lookup.
  */
-static pthread_key_t m_keyAllocated;
-static pthread_once_t m_keyOnce = PTHREAD_ONCE_INIT;
+struct ThreadPools {
+    ThreadPools() {
+        std::fill(m_bySizeClass, m_bySizeClass + SIZE_CLASS_COUNT, static_cast<SlabPool*>(NULL));
+    }
+
+    ~ThreadPools() {
+        for (MapType::iterator iter = m_byExactSize.begin(); iter != m_byExactSize.end(); ++iter) {
+            delete iter->second;
+        }
+    }
 
-typedef boost::unordered_map< std::size_t, boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > > MapType;
-typedef MapType* MapTypePtr;
-typedef std::pair<int, MapTypePtr > PairType;
+    typedef boost::unordered_map<std::size_t, SlabPool*> MapType;
+    MapType m_byExactSize;
+    SlabPool *m_bySizeClass[SIZE_CLASS_COUNT];
+};
+
+typedef ThreadPools* ThreadPoolsPtr;
+typedef std::pair<int, ThreadPoolsPtr > PairType;
 typedef PairType* PairTypePtr;
 
 static void createThreadLocalKey() {
     (void)pthread_key_create( &m_key, NULL);
     (void)pthread_key_create( &m_stringKey, NULL);
-    (void)pthread_key_create( &m_keyAllocated, NULL);
 }
 
+static inline ThreadPoolsPtr getThreadPools() {
+    return static_cast< PairTypePtr >(pthread_getspecific(m_key))->second;
+}
+
+
 ThreadLocalPool::ThreadLocalPool() {
     (void)pthread_once(&m_keyOnce, createThreadLocalKey);
     if (pthread_getspecific(m_key) == NULL) {
-        pthread_setspecific( m_keyAllocated, static_cast<const void *>(new std::size_t(0)));
         pthread_setspecific( m_key, static_cast<const void *>(
                 new PairType(
-                        1, new MapType())));
+                        1, new ThreadPools())));
         pthread_setspecific(m_stringKey, static_cast<const void*>(new CompactingStringStorage()));
     } else {
         PairTypePtr p =
@@ -75,8 +102,6 @@ ThreadLocalPool::~ThreadLocalPool() {
             pthread_setspecific( m_key, NULL);
             delete static_cast<CompactingStringStorage*>(pthread_getspecific(m_stringKey));
             pthread_setspecific(m_stringKey, NULL);
-            delete static_cast<std::size_t*>(pthread_getspecific(m_keyAllocated));
-            pthread_setspecific( m_keyAllocated, NULL);
         } else {
             pthread_setspecific( m_key, new PairType( p->first - 1, p->second));
         }
@@ -84,91 +109,41 @@ ThreadLocalPool::~ThreadLocalPool() {
     }
 }
 
-std::size_t
-ThreadLocalPool::getAllocationSizeForObject(std::size_t length) {
-    if (length <= 2) {
-        return 2;
-    } else if (length <= 4) {
-        return 4;
-    } else if (length <= 4 + 2) {
-        return 4 + 2;
-    } else if (length <= 8) {
-        return 8;
-    } else if (length <= 8 + 4) {
-        return 8 + 4;
-    } else if (length <= 16) {
-        return 16;
-    } else if (length <= 16 + 8) {
-        return 16 + 8;
-    } else if (length <= 32) {
-        return 32;
-    } else if (length <= 32 + 16) {
-        return 32 + 16;
-    } else if (length <= 64) {
-        return 64;
-    } else if (length <= 64 + 32) {
-        return 64 + 32;
-    } else if (length <= 128) {
-        return 128;
-    } else if (length < 128 + 64) {
-        return 128 + 64;
-    } else if (length <= 256) {
-        return 256;
-    } else if (length <= 256 + 128) {
-        return 256 + 128;
-    } else if (length <= 512) {
-        return 512;
-    } else if (length <= 512 + 256) {
-        return 512 + 256;
-    } else if (length <= 1024) {
-        return 1024;
-    } else if (length <= 1024 + 512) {
-        return 1024 + 512;
-    } else if (length <= 2048) {
-        return 2048;
-    } else if (length <= 2048 + 1024) {
-        return 2048 + 1024;
-    } else if (length <= 4096) {
-        return 4096;
-    } else if (length < 4096 + 2048) {
-        return 4096 + 2048;
-    } else if (length <= 8192) {
-        return 8192;
-    } else if (length < 8192 + 4096) {
-        return 8192 + 4096;
-    } else if (length <= 16384) {
-        return 16384;
-    } else if (length <= 16384 + 8192) {
-        return 16384 + 8192;
-    } else if (length <= 32768) {
-        return 32768;
-    } else if (length <= 32768 + 16384) {
-        return 32768 + 16384;
-    } else if (length <= 65536) {
-        return 65536;
-    } else if (length <= 65536 + 32768) {
-        return 65536 + 32768;
-    } else if (length <= 131072) {
-        return 131072;
-    } else if (length <= 131072 + 65536) {
-        return 131072 + 65536;
-    } else if (length <= 262144) {
-        return 262144;
-    } else if (length <= 262144 + 131072) {
-        return 262144 + 131072;
-    } else if (length <= 524288) {
-        return 524288;
-    } else if (length <= 524288 + 262144) {
-        return 524288 + 262144;
+/*
+ * The allocation sizes are powers of two from 2 up, and halfway between
+ * each power of two from 4 up and the next, up to 768 kilobytes, then one
+ * size big enough for the largest value with its length prefix and
+ * backpointer. This is the index of the smallest of them that holds
+ * length bytes, -1 if none does: twice the log base two of the size, plus
+ * one for the sizes halfway between.
+ */
+static inline int sizeClassIndex(std::size_t length) {
+    if (length <= 4) {
+        return length <= 2 ? 2 : 4;
+    }
+    if (length > LARGEST_SIZE_CLASS_BELOW_MAX) {
         //Need space for a length prefix and a backpointer
-    } else if (length <= POOLED_MAX_VALUE_LENGTH + sizeof(int32_t) + sizeof(void*)) {
+        return length <= POOLED_MAX_VALUE_LENGTH + sizeof(int32_t) + sizeof(void*) ? SIZE_CLASS_COUNT - 1 : -1;
+    }
+    // 2^log2 < length <= 2^(log2 + 1)
+    const int log2 = 63 - __builtin_clzll(static_cast<unsigned long long>(length - 1));
+    return length <= (std::size_t(3) << (log2 - 1)) ? log2 * 2 + 1 : log2 * 2 + 2;
+}
+
+static inline std::size_t sizeClassSize(int index) {
+    if (index == SIZE_CLASS_COUNT - 1) {
         return POOLED_MAX_VALUE_LENGTH + sizeof(int32_t) + sizeof(void*);
-    } else {
-        // Do this so that we can use this method to compute allocation sizes.
-        // Expect callers to check for 0 and throw a FatalException for
-        // illegal size.
-        return 0;
     }
+    return (index % 2 == 0) ? std::size_t(1) << (index / 2) : std::size_t(3) << (index / 2 - 1);
+}
+
+std::size_t
+ThreadLocalPool::getAllocationSizeForObject(std::size_t length) {
+    const int index = sizeClassIndex(length);
+    // Return 0 so that we can use this method to compute allocation sizes.
+    // Expect callers to check for 0 and throw a FatalException for
+    // illegal size.
+    return index < 0 ? 0 : sizeClassSize(index);
 }
 
 CompactingStringStorage*
@@ -177,68 +152,59 @@ ThreadLocalPool::getStringPool()
     return static_cast<CompactingStringStorage*>(pthread_getspecific(m_stringKey));
 }
 
-boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > ThreadLocalPool::get(std::size_t size) {
-    size_t alloc_size = getAllocationSizeForObject(size);
-    if (alloc_size == 0)
+SlabPool* ThreadLocalPool::get(std::size_t size) {
+    const int index = sizeClassIndex(size);
+    if (index < 0)
     {
         throwDynamicSQLException("Attempted to allocate an object > than the 1 meg limit. Requested size was %du",
             static_cast<int32_t>(size));
     }
-    return getExact(alloc_size);
+    SlabPool *&pool = getThreadPools()->m_bySizeClass[index];
+    if (pool == NULL) {
+        pool = getExact(sizeClassSize(index));
+    }
+    return pool;
 }
 
-boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > ThreadLocalPool::getExact(std::size_t size) {
-    MapTypePtr pools =
-            static_cast< PairTypePtr >(pthread_getspecific(m_key))->second;
-    boost::unordered_map< std::size_t, boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > >::iterator
-        iter = pools->find(size);
-    if (iter == pools->end()) {
-        boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > pool =
-                boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> >(
-                        new boost::pool<voltdb_pool_allocator_new_delete>(size));
-        pools->insert( std::pair<std::size_t, boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > >(size, pool));
+SlabPool* ThreadLocalPool::getExact(std::size_t size) {
+    ThreadPools::MapType &pools = getThreadPools()->m_byExactSize;
+    ThreadPools::MapType::iterator iter = pools.find(size);
+    if (iter == pools.end()) {
+        SlabPool *pool = new SlabPool(size);
+        pools.insert(std::pair<std::size_t, SlabPool*>(size, pool));
         return pool;
     }
-    boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > pool = iter->second;
-
-    /**
-     * The goal of this code is to bypass the pool sizing algorithm used by boost
-     * and replace it with something that bounds allocations to a series of 2 meg blocks
-     * for small allocations. For large allocations fall back to a strategy of allocating two of
-     * these huge things at a time. The goal of this bounding is make the amount of untouched but allocated
-     * memory relatively small so that the counting done by the volt allocator accurately represents the effect
-     * on RSS.
-     */
-    if (pool->get_next_size() * pool->get_requested_size() > (1024 * 1024 * 2)) {
-        //If the size of objects served by this pool is less than 256 kilobytes
-        //go ahead an allocated a 2 meg block of them
-        if (pool->get_requested_size() < (1024 * 256)) {
-            pool->set_next_size((1024 * 1024 * 2) /  pool->get_requested_size());
-        } else {
-            //For large objects allocated just two of them
-            pool->set_next_size(2);
-        }
-    }
     return iter->second;
 }
 
 std::size_t ThreadLocalPool::getPoolAllocationSize() {
-    size_t bytes_allocated =
-        *static_cast< std::size_t* >(pthread_getspecific(m_keyAllocated));
+    size_t bytes_allocated = 0;
+    ThreadPools::MapType &pools = getThreadPools()->m_byExactSize;
+    for (ThreadPools::MapType::iterator iter = pools.begin(); iter != pools.end(); ++iter) {
+        bytes_allocated += iter->second->getBytesAllocated();
+    }
     bytes_allocated += (static_cast<CompactingStringStorage*>(pthread_getspecific(m_stringKey)))->getPoolAllocationSize();
     return bytes_allocated;
 }
 
-char * voltdb_pool_allocator_new_delete::malloc(const size_type bytes) {
-    (*static_cast< std::size_t* >(pthread_getspecific(m_keyAllocated))) += bytes + sizeof(std::size_t);
-    //std::cout << "Pooled memory is " << ((*static_cast< std::size_t* >(pthread_getspecific(m_keyAllocated))) / (1024 * 1024)) << " after requested allocation " << (bytes / (1024 * 1024)) <<  std::endl;
-    char *retval = new (std::nothrow) char[bytes + sizeof(std::size_t)];
-    *reinterpret_cast<std::size_t*>(retval) = bytes + sizeof(std::size_t);
-    return &retval[sizeof(std::size_t)];
+static bool lessRequestedSize(const SlabPool *a, const SlabPool *b) {
+    return a->getRequestedSize() < b->getRequestedSize();
 }
 
-void voltdb_pool_allocator_new_delete::free(char * const block) {
-    (*static_cast< std::size_t* >(pthread_getspecific(m_keyAllocated))) -= *reinterpret_cast<std::size_t*>(block - sizeof(std::size_t));
-    delete [](block - sizeof(std::size_t));
+void ThreadLocalPool::getPoolStats(std::vector<SlabPoolStats> &stats) {
+    std::vector<const SlabPool*> pools;
+    getPools(pools);
+    for (std::size_t ii = 0; ii < pools.size(); ii++) {
+        stats.push_back(pools[ii]->getStats());
+    }
+}
+
+void ThreadLocalPool::getPools(std::vector<const SlabPool*> &pools) {
+    const std::size_t first = pools.size();
+    ThreadPools::MapType &byExactSize = getThreadPools()->m_byExactSize;
+    for (ThreadPools::MapType::iterator iter = byExactSize.begin(); iter != byExactSize.end(); ++iter) {
+        pools.push_back(iter->second);
+    }
+    std::sort(pools.begin() + first, pools.end(), lessRequestedSize);
 }
 }
@@ -19,21 +19,12 @@
 #define THREADLOCALPOOL_H_
 
 #include "CompactingStringStorage.h"
+#include "SlabPool.h"
 
-#include "boost/pool/pool.hpp"
-#include "boost/shared_ptr.hpp"
+#include <vector>
 
 namespace voltdb {
 
-struct voltdb_pool_allocator_new_delete
-{
-  typedef std::size_t size_type;
-  typedef std::ptrdiff_t difference_type;
-
-  static char * malloc(const size_type bytes);
-  static void free(char * const block);
-};
-
 /**
  * A wrapper around a set of pools that are local to the current thread.
  * An instance of the thread local pool must be maintained somewhere in the thread to ensure initialization
@@ -55,16 +46,28 @@ public:
      * Retrieve a pool that allocates approximately sized chunks of memory. Provides pools that
      * are powers of two and powers of two + the previous power of two.
      */
-    static boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > get(std::size_t size);
+    static SlabPool* get(std::size_t size);
 
     /**
      * Retrieve a pool that allocate chunks that are exactly the requested size. Only creates
      * pools up to 1 megabyte + 4 bytes.
      */
-    static boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > getExact(std::size_t size);
+    static SlabPool* getExact(std::size_t size);
 
     static std::size_t getPoolAllocationSize();
 
+    /**
+     * Append the allocation counts of each of this thread's pools to stats,
+     * in order of the size they allocate. The string pools are not included.
+     */
+    static void getPoolStats(std::vector<SlabPoolStats> &stats);
+
+    /**
+     * Append each of this thread's pools to pools, in order of the size
+     * they allocate. The string pools are not included.
+     */
+    static void getPools(std::vector<const SlabPool*> &pools);
+
     static CompactingStringStorage* getStringPool();
 };
 }
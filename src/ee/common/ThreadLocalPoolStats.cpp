@@ -0,0 +1,123 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "common/ThreadLocalPoolStats.h"
+#include "stats/StatsSource.h"
+#include "common/TupleSchema.h"
+#include "common/ids.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "storage/table.h"
+#include "storage/tablefactory.h"
+#include <vector>
+#include <string>
+
+using namespace voltdb;
+using namespace std;
+
+vector<string> ThreadLocalPoolStats::generatePoolStatsColumnNames() {
+    vector<string> columnNames = StatsSource::generateBaseStatsColumnNames();
+    columnNames.push_back("REQUESTED_SIZE");
+    columnNames.push_back("CHUNK_SIZE");
+    columnNames.push_back("SLABS");
+    columnNames.push_back("BYTES_ALLOCATED");
+    columnNames.push_back("CHUNKS_IN_USE");
+    columnNames.push_back("ALLOCATIONS");
+    return columnNames;
+}
+
+void ThreadLocalPoolStats::populatePoolStatsSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull) {
+    StatsSource::populateBaseSchema(types, columnLengths, allowNull);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+}
+
+Table*
+ThreadLocalPoolStats::generateEmptyPoolStatsTable()
+{
+    string name = "Pool stats temp table";
+    // See TableStats::generateEmptyTableStatsTable
+    CatalogId databaseId = 1;
+    vector<string> columnNames = ThreadLocalPoolStats::generatePoolStatsColumnNames();
+    vector<ValueType> columnTypes;
+    vector<int32_t> columnLengths;
+    vector<bool> columnAllowNull;
+    ThreadLocalPoolStats::populatePoolStatsSchema(columnTypes, columnLengths,
+                                                  columnAllowNull);
+    TupleSchema *schema =
+        TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                       columnAllowNull, true);
+
+    return
+        reinterpret_cast<Table*>(TableFactory::getTempTable(databaseId,
+                                                            name,
+                                                            schema,
+                                                            columnNames,
+                                                            NULL));
+}
+
+ThreadLocalPoolStats::ThreadLocalPoolStats(const SlabPoolStats &counters)
+    : StatsSource(), m_counters(counters), m_lastAllocations(0)
+{
+}
+
+vector<string> ThreadLocalPoolStats::generateStatsColumnNames() {
+    return ThreadLocalPoolStats::generatePoolStatsColumnNames();
+}
+
+/**
+ * Update the stats tuple with the latest statistics available to this StatsSource.
+ */
+void ThreadLocalPoolStats::updateStatsTuple(TableTuple *tuple) {
+    int64_t allocations = m_counters.allocations;
+
+    if (interval()) {
+        allocations = allocations - m_lastAllocations;
+        m_lastAllocations = m_counters.allocations;
+    }
+
+    tuple->setNValue(StatsSource::m_columnName2Index["REQUESTED_SIZE"],
+                     ValueFactory::getIntegerValue(static_cast<int32_t>(m_counters.requestedSize)));
+    tuple->setNValue(StatsSource::m_columnName2Index["CHUNK_SIZE"],
+                     ValueFactory::getIntegerValue(static_cast<int32_t>(m_counters.chunkSize)));
+    tuple->setNValue(StatsSource::m_columnName2Index["SLABS"],
+                     ValueFactory::getIntegerValue(static_cast<int32_t>(m_counters.slabs)));
+    tuple->setNValue(StatsSource::m_columnName2Index["BYTES_ALLOCATED"],
+                     ValueFactory::getBigIntValue(static_cast<int64_t>(m_counters.bytesAllocated)));
+    tuple->setNValue(StatsSource::m_columnName2Index["CHUNKS_IN_USE"],
+                     ValueFactory::getBigIntValue(static_cast<int64_t>(m_counters.chunksInUse)));
+    tuple->setNValue(StatsSource::m_columnName2Index["ALLOCATIONS"],
+                     ValueFactory::getBigIntValue(allocations));
+}
+
+/**
+ * Same pattern as generateStatsColumnNames except the return value is used as an offset into the tuple schema instead of appending to
+ * end of a list.
+ */
+void ThreadLocalPoolStats::populateSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull) {
+    ThreadLocalPoolStats::populatePoolStatsSchema(types, columnLengths, allowNull);
+}
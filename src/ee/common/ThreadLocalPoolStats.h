@@ -0,0 +1,89 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADLOCALPOOLSTATS_H_
+#define THREADLOCALPOOLSTATS_H_
+
+#include "stats/StatsSource.h"
+#include "common/SlabPool.h"
+#include <vector>
+#include <string>
+
+namespace voltdb {
+
+/**
+ * StatsSource extension for one of a thread's SlabPools, reporting the
+ * size of its chunks, the slabs and bytes it has mapped and the chunks
+ * in use now. Allocations are counted since the beginning or, for
+ * interval stats, since they were last collected. The pool must outlive
+ * the source.
+ */
+class ThreadLocalPoolStats : public voltdb::StatsSource {
+public:
+    /**
+     * Static method to generate the column names for the tables which
+     * contain pool stats.
+     */
+    static std::vector<std::string> generatePoolStatsColumnNames();
+
+    /**
+     * Static method to generate the remaining schema information for
+     * the tables which contain pool stats.
+     */
+    static void populatePoolStatsSchema(std::vector<voltdb::ValueType>& types,
+                                        std::vector<int32_t>& columnLengths,
+                                        std::vector<bool>& allowNull);
+
+    /**
+     * Return an empty ThreadLocalPoolStats table
+     */
+    static Table* generateEmptyPoolStatsTable();
+
+    /*
+     * Constructor caches reference to the counters the pool updates
+     */
+    ThreadLocalPoolStats(const voltdb::SlabPoolStats &counters);
+
+protected:
+
+    /**
+     * Update the stats tuple with the latest statistics available to this StatsSource.
+     */
+    virtual void updateStatsTuple(voltdb::TableTuple *tuple);
+
+    /**
+     * Generates the list of column names that will be in the statTable_. Derived classes must override this method and call
+     * the parent class's version to obtain the list of columns contributed by ancestors and then append the columns they will be
+     * contributing to the end of the list.
+     */
+    virtual std::vector<std::string> generateStatsColumnNames();
+
+    /**
+     * Same pattern as generateStatsColumnNames except the return value is used as an offset into the tuple schema instead of appending to
+     * end of a list.
+     */
+    virtual void populateSchema(std::vector<voltdb::ValueType> &types, std::vector<int32_t> &columnLengths, std::vector<bool> &allowNull);
+
+private:
+    const voltdb::SlabPoolStats &m_counters;
+
+    int64_t m_lastAllocations;
+};
+
+}
+
+#endif /* THREADLOCALPOOLSTATS_H_ */
@@ -19,6 +19,8 @@
 #include "TupleOutputStreamProcessor.h"
 #include "TupleSerializer.h"
 #include "tabletuple.h"
+#include "expressions/hashrangeexpression.h"
+#include <algorithm>
 #include <limits>
 
 namespace voltdb {
@@ -51,6 +53,11 @@ void TupleOutputStreamProcessor::clearState()
     m_maxTupleLength = 0;
     m_predicates = NULL;
     m_table = NULL;
+    m_hashRouted = false;
+    m_hashColumn = -1;
+    m_spanStarts.clear();
+    m_spanStreams.clear();
+    m_unfilteredStreams = 0;
 }
 
 /** Convenience method to create and add a new TupleOutputStream. */
@@ -77,11 +84,90 @@ void TupleOutputStreamProcessor::open(PersistentTable &table,
     }
     m_predicates = &predicates;
     m_predicateDeletes = &predicateDeletes;
+    buildHashRoutes();
     for (TupleOutputStreamProcessor::iterator iter = begin(); iter != end(); ++iter) {
         iter->startRows(partitionId);
     }
 }
 
+/**
+ * Set up hash routing if every predicate is either absent or a hash range
+ * on one and the same column, and there are few enough streams for a bit
+ * mask. Otherwise writeRow() evaluates the predicates one by one.
+ */
+void TupleOutputStreamProcessor::buildHashRoutes()
+{
+    m_hashRouted = false;
+    m_hashColumn = -1;
+    m_spanStarts.clear();
+    m_spanStreams.clear();
+    m_unfilteredStreams = 0;
+    if (m_predicates->empty() || size() > 64) {
+        return;
+    }
+
+    std::vector<const HashRangeExpression*> ranges;
+    for (std::size_t ii = 0; ii < m_predicates->size(); ii++) {
+        if (m_predicates->is_null(ii)) {
+            m_unfilteredStreams |= (uint64_t)1 << ii;
+            ranges.push_back(NULL);
+            continue;
+        }
+        const HashRangeExpression *range = dynamic_cast<const HashRangeExpression*>(&(*m_predicates)[ii]);
+        if (range == NULL || (m_hashColumn != -1 && range->getColumnId() != m_hashColumn)) {
+            return;
+        }
+        m_hashColumn = range->getColumnId();
+        ranges.push_back(range);
+    }
+    if (m_hashColumn == -1) {
+        return;
+    }
+
+    // Every range starts a span and ends one just after its last hash.
+    std::vector<int64_t> cuts;
+    cuts.push_back(std::numeric_limits<int32_t>::min());
+    for (std::size_t ii = 0; ii < ranges.size(); ii++) {
+        for (int jj = 0; ranges[ii] != NULL && jj < ranges[ii]->getRangeCount(); jj++) {
+            cuts.push_back(ranges[ii]->getRange(jj).first);
+            cuts.push_back((int64_t)ranges[ii]->getRange(jj).second + 1);
+        }
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+    if (cuts.back() > std::numeric_limits<int32_t>::max()) {
+        cuts.pop_back();
+    }
+
+    // Each span lies wholly inside or outside every range.
+    for (std::size_t ss = 0; ss < cuts.size(); ss++) {
+        uint64_t streams = 0;
+        for (std::size_t ii = 0; ii < ranges.size(); ii++) {
+            for (int jj = 0; ranges[ii] != NULL && jj < ranges[ii]->getRangeCount(); jj++) {
+                const srange_type &range = ranges[ii]->getRange(jj);
+                if (cuts[ss] >= range.first && cuts[ss] <= range.second) {
+                    streams |= (uint64_t)1 << ii;
+                    break;
+                }
+            }
+        }
+        // adjacent spans going to the same streams are merged
+        if (m_spanStreams.empty() || m_spanStreams.back() != streams) {
+            m_spanStarts.push_back(cuts[ss]);
+            m_spanStreams.push_back(streams);
+        }
+    }
+    m_hashRouted = true;
+}
+
+inline uint64_t TupleOutputStreamProcessor::routeByHash(const TableTuple &tuple) const
+{
+    const int32_t hash = tuple.getNValue(m_hashColumn).murmurHash3();
+    const std::size_t span =
+        std::upper_bound(m_spanStarts.begin(), m_spanStarts.end(), (int64_t)hash) - m_spanStarts.begin() - 1;
+    return m_spanStreams[span] | m_unfilteredStreams;
+}
+
 /** Stop serializing. */
 void TupleOutputStreamProcessor::close()
 {
@@ -114,12 +200,19 @@ bool TupleOutputStreamProcessor::writeRow(TupleSerializer &tupleSerializer,
         iDeleteFlag = m_predicateDeletes->begin();
     }
 
+    // With hash routing, all the streams' approvals are found at once.
+    const uint64_t routedStreams = m_hashRouted ? routeByHash(tuple) : 0;
+
     bool yield = false;
-    for (TupleOutputStreamProcessor::iterator iter = begin(); iter != end(); ++iter) {
+    std::size_t stream = 0;
+    for (TupleOutputStreamProcessor::iterator iter = begin(); iter != end(); ++iter, ++stream) {
         // Get approval from corresponding output stream predicate, if provided.
         bool accepted = true;
         if (!m_predicates->empty()) {
-            if (!boost::is_null(ipredicate)) {
+            if (m_hashRouted) {
+                accepted = (routedStreams >> stream) & 1;
+            }
+            else if (!boost::is_null(ipredicate)) {
                 accepted = ipredicate->eval(&tuple).isTrue();
             }
             // Keep walking through predicates in lock-step with the streams.
@@ -19,9 +19,13 @@
 #define TUPLEOUTPUTSTREAMPROCESSOR_H_
 
 #include <cstddef>
+#include <vector>
+#include <stdint.h>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include "StreamPredicateList.h"
 
+class CopyOnWriteTest;
+
 namespace voltdb {
 
 class TupleSerializer;
@@ -34,6 +38,8 @@ class StreamPredicateList;
 /** TupleOutputStream processor. Manages and outputs to multiple TupleOutputStream's. */
 class TupleOutputStreamProcessor : public boost::ptr_vector<TupleOutputStream> {
 
+    friend class ::CopyOnWriteTest;
+
 public:
 
     /** Default constructor. */
@@ -87,6 +93,28 @@ private:
 
     /** Private method used by constructors, etc. to clear state. */
     void clearState();
+
+    /** Set up hash routing when every predicate is a hash range on one column. */
+    void buildHashRoutes();
+
+    /** Bit mask of the streams accepting a tuple under hash routing. */
+    uint64_t routeByHash(const TableTuple &tuple) const;
+
+    /**
+     * Hash routing. When every predicate is a hash range on the same
+     * column, the hash space is cut at each range boundary into spans
+     * that each go to a fixed set of streams. A tuple is then hashed once
+     * and its streams found with one search of the spans, instead of
+     * each predicate hashing it and searching its own ranges.
+     */
+    bool m_hashRouted;
+    int m_hashColumn;
+    /** First hash of each span, in order, starting at INT32_MIN. */
+    std::vector<int64_t> m_spanStarts;
+    /** Streams accepting each span, one bit per stream. */
+    std::vector<uint64_t> m_spanStreams;
+    /** Streams without a predicate, which accept every tuple. */
+    uint64_t m_unfilteredStreams;
 };
 
 } // namespace voltdb
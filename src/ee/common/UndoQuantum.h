@@ -26,6 +26,7 @@
 #include "common/Pool.hpp"
 #include "common/UndoAction.h"
 #include "common/UndoQuantumReleaseInterest.h"
+#include "common/UndoRecord.h"
 #include "boost/unordered_set.hpp"
 
 class StreamedTableTest;
@@ -47,14 +48,40 @@ protected:
     void operator delete(void*) { /* every-day deallocator does nothing -- lets the pool cope */ }
 
     inline UndoQuantum(int64_t undoToken, Pool *dataPool)
-        : m_undoToken(undoToken), m_numInterests(0), m_interestsCapacity(0), m_interests(NULL), m_dataPool(dataPool) {}
+        : m_undoToken(undoToken), m_lastHandler(0), m_numInterests(0), m_interestsCapacity(0), m_interests(NULL), m_dataPool(dataPool) {}
     inline virtual ~UndoQuantum() {}
 
 public:
     virtual inline void registerUndoAction(UndoAction *undoAction, UndoQuantumReleaseInterest *interest = NULL) {
         assert(undoAction);
-        m_undoActions.push_back(undoAction);
+        UndoRecord record = { reinterpret_cast<char*>(undoAction), 0, UNDO_RECORD_ACTION };
+        m_undoRecords.push_back(record);
+        registerInterest(interest);
+    }
+
+    /*
+     * Log a change to a tuple that the handler knows how to undo and
+     * release, without allocating an UndoAction for it.
+     */
+    virtual inline void registerUndoRecord(UndoRecordType type, char *tuple, UndoRecordHandler *handler,
+                                           UndoQuantumReleaseInterest *interest = NULL) {
+        assert(type != UNDO_RECORD_ACTION);
+        if (m_undoHandlers.empty() || m_undoHandlers[m_lastHandler] != handler) {
+            m_lastHandler = 0;
+            while (m_lastHandler < m_undoHandlers.size() && m_undoHandlers[m_lastHandler] != handler) {
+                m_lastHandler++;
+            }
+            if (m_lastHandler == m_undoHandlers.size()) {
+                m_undoHandlers.push_back(handler);
+            }
+        }
+        UndoRecord record = { tuple, m_lastHandler, static_cast<uint32_t>(type) };
+        m_undoRecords.push_back(record);
+        registerInterest(interest);
+    }
 
+private:
+    inline void registerInterest(UndoQuantumReleaseInterest *interest) {
         if (interest != NULL) {
             if (m_interests == NULL) {
                 m_interests = reinterpret_cast<UndoQuantumReleaseInterest**>(m_dataPool->allocate(sizeof(void*) * 16));
@@ -79,20 +106,50 @@ public:
         }
     }
 
+    /*
+     * Process the log from the last record back to the first, a run of
+     * consecutive records of the same type and handler at a time. Runs of
+     * UndoActions are undone or released one by one, then destroyed.
+     * "Destroying" here only really calls their virtual destructors (important!)
+     * but leaves them to be purged in one go with the data pool.
+     */
+    template <bool UNDO>
+    inline void processRecords() {
+        std::size_t end = m_undoRecords.size();
+        while (end > 0) {
+            const UndoRecord &last = m_undoRecords[end - 1];
+            std::size_t begin = end - 1;
+            while (begin > 0 && m_undoRecords[begin - 1].m_type == last.m_type &&
+                   m_undoRecords[begin - 1].m_handler == last.m_handler) {
+                begin--;
+            }
+            const UndoRecordType type = static_cast<UndoRecordType>(last.m_type);
+            if (type == UNDO_RECORD_ACTION) {
+                for (std::size_t ii = end; ii > begin; ii--) {
+                    UndoAction* goner = reinterpret_cast<UndoAction*>(m_undoRecords[ii - 1].m_data);
+                    if (UNDO) {
+                        goner->undo();
+                    } else {
+                        goner->release();
+                    }
+                    delete goner;
+                }
+            } else if (UNDO) {
+                m_undoHandlers[last.m_handler]->undoRecords(type, &m_undoRecords[begin], end - begin);
+            } else {
+                m_undoHandlers[last.m_handler]->releaseRecords(type, &m_undoRecords[begin], end - begin);
+            }
+            end = begin;
+        }
+    }
+
 protected:
     /*
-     * Invoke all the undo actions for this UndoQuantum. UndoActions
+     * Undo all the changes logged by this UndoQuantum. UndoActions
      * must have released all memory after undo() is called.
-     * "delete" here only really calls their virtual destructors (important!)
-     * but their no-op delete operator leaves them to be purged in one go with the data pool.
      */
     inline Pool* undo() {
-        for (std::vector<UndoAction*>::reverse_iterator i = m_undoActions.rbegin();
-             i != m_undoActions.rend(); ++i) {
-            UndoAction* goner = *i;
-            goner->undo();
-            delete goner;
-        }
+        processRecords<true>();
         Pool * result = m_dataPool;
         delete this;
         // return the pool for recycling.
@@ -100,19 +157,12 @@ protected:
     }
 
     /*
-     * Call "release" and the destructors on all the UndoActions for this
-     * UndoQuantum so they will release any resources they still hold.
-     * "delete" here only really calls their virtual destructors (important!)
-     * but their no-op delete operator leaves them to be purged in one go with the data pool.
-     * Also call own destructor to ensure that the vector is released.
+     * Release all the changes logged by this UndoQuantum so that their
+     * UndoActions and handlers release any resources they still hold.
+     * Also call own destructor to ensure that the vectors are released.
      */
     inline Pool* release() {
-        for (std::vector<UndoAction*>::reverse_iterator i = m_undoActions.rbegin();
-             i != m_undoActions.rend(); ++i) {
-            UndoAction* goner = *i;
-            goner->release();
-            delete goner;
-        }
+        processRecords<false>();
         if (m_interests != NULL) {
             for (int ii = 0; ii < m_numInterests; ii++) {
                 m_interests[ii]->notifyQuantumRelease();
@@ -133,7 +183,7 @@ public:
 
     inline int64_t getAllocatedMemory() const
     {
-        return m_dataPool->getAllocatedMemory();
+        return m_dataPool->getAllocatedMemory() + m_undoRecords.capacity() * sizeof(UndoRecord);
     }
 
     template <typename T> T allocatePooledCopy(T original, std::size_t sz)
@@ -145,7 +195,10 @@ public:
 
 private:
     const int64_t m_undoToken;
-    std::vector<UndoAction*> m_undoActions;
+    // the log of changes, in the order they were made
+    std::vector<UndoRecord> m_undoRecords;
+    std::vector<UndoRecordHandler*> m_undoHandlers;
+    uint32_t m_lastHandler;
     uint32_t m_numInterests;
     uint32_t m_interestsCapacity;
     UndoQuantumReleaseInterest **m_interests;
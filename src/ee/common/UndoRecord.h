@@ -0,0 +1,62 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UNDORECORD_H_
+#define UNDORECORD_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+class UndoAction;
+
+/*
+ * The kinds of change an UndoQuantum logs as a bare record rather than as
+ * an UndoAction. Anything else is logged as an UNDO_RECORD_ACTION whose
+ * record points at its UndoAction.
+ */
+enum UndoRecordType {
+    UNDO_RECORD_INSERT,  // the record holds a pooled copy of the inserted tuple
+    UNDO_RECORD_DELETE,  // the record holds the address of the deleted tuple
+    UNDO_RECORD_ACTION
+};
+
+/*
+ * One entry of an UndoQuantum's log: the tuple (or UndoAction) a change
+ * was made to, its type, and the handler that undoes or releases it, as
+ * an index into the quantum's handlers.
+ */
+struct UndoRecord {
+    char *m_data;
+    uint32_t m_handler;
+    uint32_t m_type;
+};
+
+/*
+ * Something, like a table, that undoes and releases its own records. A
+ * quantum hands it each run of consecutive records of one type at once,
+ * in the order they were logged, to be processed last record first.
+ */
+class UndoRecordHandler {
+public:
+    virtual void undoRecords(UndoRecordType type, const UndoRecord *records, std::size_t count) = 0;
+    virtual void releaseRecords(UndoRecordType type, const UndoRecord *records, std::size_t count) = 0;
+    virtual ~UndoRecordHandler() {}
+};
+}
+
+#endif /* UNDORECORD_H_ */
@@ -60,6 +60,12 @@ public:
         return NValue::getAllocatedValue(VALUE_TYPE_VARCHAR, value.c_str(), value.length(), NULL);
     }
 
+    /// Constructs a value copied into the temp string pool, which is
+    /// purged after each plan fragment.
+    static inline NValue getTempStringValue(const char *value, size_t size) {
+        return NValue::getTempStringValue(value, size);
+    }
+
     static inline NValue getNullStringValue() {
         return NValue::getNullStringValue();
     }
@@ -20,10 +20,7 @@
 using namespace voltdb;
 
 void FallbackSerializeOutput::expand(size_t minimum_desired) {
-    /*
-     * Leave some space for message headers and such, almost 50 megabytes
-     */
-    size_t maxAllocationSize = ((1024 * 1024 *50) - (1024 * 32));
+    const size_t maxAllocationSize = MAX_ALLOCATION_SIZE;
     if (fallbackBuffer_ != NULL || minimum_desired > maxAllocationSize) {
         if (fallbackBuffer_ != NULL) {
             char *temp = fallbackBuffer_;
@@ -489,6 +489,12 @@ protected:
  */
 class FallbackSerializeOutput : public ReferenceSerializeOutput {
 public:
+    /*
+     * Leave some space for message headers and such, almost 50 megabytes.
+     * Output given a buffer this big never falls back.
+     */
+    static const size_t MAX_ALLOCATION_SIZE = (1024 * 1024 * 50) - (1024 * 32);
+
     FallbackSerializeOutput() :
         ReferenceSerializeOutput(), fallbackBuffer_(NULL) {
     }
@@ -197,7 +197,9 @@ public:
                 if (((getType(i) == VALUE_TYPE_VARCHAR) || (getType(i) == VALUE_TYPE_VARBINARY)) &&
                     !m_schema->columnIsInlined(i))
                 {
-                    if (!getNValue(i).isNull())
+                    // short strings are kept in the tuple itself
+                    const StringRef* sref = *reinterpret_cast<StringRef* const*>(getDataPtr(i));
+                    if (sref != NULL && !StringRef::isShortString(sref))
                     {
                         bytes +=
                             StringRef::
@@ -380,8 +382,17 @@ private:
  */
 class PoolBackedTupleStorage {
 public:
+    PoolBackedTupleStorage() : m_tuple(), m_pool(NULL) { }
+
     PoolBackedTupleStorage(const TupleSchema* schema, Pool* pool) : m_tuple(schema), m_pool(pool) { }
 
+    /** Late initialization for storage that is a member of a longer lived object. */
+    void init(const TupleSchema* schema, Pool* pool)
+    {
+        m_tuple = TableTuple(schema);
+        m_pool = pool;
+    }
+
     void allocateActiveTuple()
     {
         char* storage = reinterpret_cast<char*>(m_pool->allocateZeroes(m_tuple.getSchema()->tupleLength() + TUPLE_HEADER_SIZE));
@@ -343,6 +343,12 @@ string planNodeToString(PlanNodeType type)
     case PLAN_NODE_TYPE_NESTLOOPINDEX: {
         return "NESTLOOPINDEX";
     }
+    case PLAN_NODE_TYPE_HASHJOIN: {
+        return "HASHJOIN";
+    }
+    case PLAN_NODE_TYPE_MERGEJOIN: {
+        return "MERGEJOIN";
+    }
     case PLAN_NODE_TYPE_UPDATE: {
         return "UPDATE";
     }
@@ -405,6 +411,10 @@ PlanNodeType stringToPlanNode(string str )
         return PLAN_NODE_TYPE_NESTLOOP;
     } else if (str == "NESTLOOPINDEX") {
         return PLAN_NODE_TYPE_NESTLOOPINDEX;
+    } else if (str == "HASHJOIN") {
+        return PLAN_NODE_TYPE_HASHJOIN;
+    } else if (str == "MERGEJOIN") {
+        return PLAN_NODE_TYPE_MERGEJOIN;
     } else if (str == "UPDATE") {
         return PLAN_NODE_TYPE_UPDATE;
     } else if (str == "INSERT") {
@@ -187,6 +187,8 @@ enum PlanNodeType {
     //
     PLAN_NODE_TYPE_NESTLOOP         = 20,
     PLAN_NODE_TYPE_NESTLOOPINDEX    = 21,
+    PLAN_NODE_TYPE_HASHJOIN         = 22,
+    PLAN_NODE_TYPE_MERGEJOIN        = 23,
 
     //
     // Operator Nodes
@@ -324,6 +326,7 @@ enum ExpressionType {
 enum TableIndexType {
     BALANCED_TREE_INDEX     = 1,
     HASH_TABLE_INDEX        = 2,
+    BTREE_INDEX             = 3,
 };
 
 // ------------------------------------------------------------------
@@ -414,7 +417,11 @@ inline bool tableStreamTypeIsValid(TableStreamType streamType) {
 // ------------------------------------------------------------------
 enum StatisticsSelectorType {
     STATISTICS_SELECTOR_TYPE_TABLE,
-    STATISTICS_SELECTOR_TYPE_INDEX
+    STATISTICS_SELECTOR_TYPE_INDEX,
+    // the position of MEMORY in the Java StatsSelector
+    STATISTICS_SELECTOR_TYPE_MEMORY = 8,
+    // the position of PLANNER in the Java StatsSelector
+    STATISTICS_SELECTOR_TYPE_PLAN_CACHE = 10
 };
 
 // ------------------------------------------------------------------
@@ -0,0 +1,126 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "execution/PlanCacheStats.h"
+#include "stats/StatsSource.h"
+#include "common/TupleSchema.h"
+#include "common/ids.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "storage/table.h"
+#include "storage/tablefactory.h"
+#include <vector>
+#include <string>
+
+using namespace voltdb;
+using namespace std;
+
+vector<string> PlanCacheStats::generatePlanCacheStatsColumnNames() {
+    vector<string> columnNames = StatsSource::generateBaseStatsColumnNames();
+    columnNames.push_back("CACHE_ENTRIES");
+    columnNames.push_back("CACHE_BYTES");
+    columnNames.push_back("CACHE_HITS");
+    columnNames.push_back("CACHE_MISSES");
+    columnNames.push_back("CACHE_EVICTIONS");
+    return columnNames;
+}
+
+void PlanCacheStats::populatePlanCacheStatsSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull) {
+    StatsSource::populateBaseSchema(types, columnLengths, allowNull);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+}
+
+Table*
+PlanCacheStats::generateEmptyPlanCacheStatsTable()
+{
+    string name = "Plan cache stats temp table";
+    // See TableStats::generateEmptyTableStatsTable
+    CatalogId databaseId = 1;
+    vector<string> columnNames = PlanCacheStats::generatePlanCacheStatsColumnNames();
+    vector<ValueType> columnTypes;
+    vector<int32_t> columnLengths;
+    vector<bool> columnAllowNull;
+    PlanCacheStats::populatePlanCacheStatsSchema(columnTypes, columnLengths,
+                                                 columnAllowNull);
+    TupleSchema *schema =
+        TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                       columnAllowNull, true);
+
+    return
+        reinterpret_cast<Table*>(TableFactory::getTempTable(databaseId,
+                                                            name,
+                                                            schema,
+                                                            columnNames,
+                                                            NULL));
+}
+
+PlanCacheStats::PlanCacheStats(const PlanCacheCounters &counters)
+    : StatsSource(), m_counters(counters), m_lastHits(0), m_lastMisses(0),
+      m_lastEvictions(0)
+{
+}
+
+vector<string> PlanCacheStats::generateStatsColumnNames() {
+    return PlanCacheStats::generatePlanCacheStatsColumnNames();
+}
+
+/**
+ * Update the stats tuple with the latest statistics available to this StatsSource.
+ */
+void PlanCacheStats::updateStatsTuple(TableTuple *tuple) {
+    int64_t hits = m_counters.hits;
+    int64_t misses = m_counters.misses;
+    int64_t evictions = m_counters.evictions;
+
+    if (interval()) {
+        hits = hits - m_lastHits;
+        m_lastHits = m_counters.hits;
+        misses = misses - m_lastMisses;
+        m_lastMisses = m_counters.misses;
+        evictions = evictions - m_lastEvictions;
+        m_lastEvictions = m_counters.evictions;
+    }
+
+    tuple->setNValue(StatsSource::m_columnName2Index["CACHE_ENTRIES"],
+                     ValueFactory::getIntegerValue(static_cast<int32_t>(m_counters.entries)));
+    tuple->setNValue(StatsSource::m_columnName2Index["CACHE_BYTES"],
+                     ValueFactory::getBigIntValue(m_counters.bytes));
+    tuple->setNValue(StatsSource::m_columnName2Index["CACHE_HITS"],
+                     ValueFactory::getBigIntValue(hits));
+    tuple->setNValue(StatsSource::m_columnName2Index["CACHE_MISSES"],
+                     ValueFactory::getBigIntValue(misses));
+    tuple->setNValue(StatsSource::m_columnName2Index["CACHE_EVICTIONS"],
+                     ValueFactory::getBigIntValue(evictions));
+}
+
+/**
+ * Same pattern as generateStatsColumnNames except the return value is used as an offset into the tuple schema instead of appending to
+ * end of a list.
+ */
+void PlanCacheStats::populateSchema(
+        vector<ValueType> &types,
+        vector<int32_t> &columnLengths,
+        vector<bool> &allowNull) {
+    PlanCacheStats::populatePlanCacheStatsSchema(types, columnLengths, allowNull);
+}
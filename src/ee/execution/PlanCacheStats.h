@@ -0,0 +1,105 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANCACHESTATS_H_
+#define PLANCACHESTATS_H_
+
+#include "stats/StatsSource.h"
+#include "common/TupleSchema.h"
+#include "common/ids.h"
+#include <vector>
+#include <string>
+
+namespace voltdb {
+
+/**
+ * Counters kept by a cache of plan graphs and reported by PlanCacheStats.
+ * Bytes cover the plan text and the graph built from it.
+ */
+struct PlanCacheCounters {
+    PlanCacheCounters() : entries(0), bytes(0), hits(0), misses(0), evictions(0) {}
+
+    int64_t entries;
+    int64_t bytes;
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+};
+
+/**
+ * StatsSource extension for a cache of plan graphs, reporting the
+ * counters the cache keeps. Entries and bytes are what the cache holds
+ * now; hits, misses and evictions are counted since the beginning or,
+ * for interval stats, since they were last collected.
+ */
+class PlanCacheStats : public voltdb::StatsSource {
+public:
+    /**
+     * Static method to generate the column names for the tables which
+     * contain plan cache stats.
+     */
+    static std::vector<std::string> generatePlanCacheStatsColumnNames();
+
+    /**
+     * Static method to generate the remaining schema information for
+     * the tables which contain plan cache stats.
+     */
+    static void populatePlanCacheStatsSchema(std::vector<voltdb::ValueType>& types,
+                                             std::vector<int32_t>& columnLengths,
+                                             std::vector<bool>& allowNull);
+
+    /**
+     * Return an empty PlanCacheStats table
+     */
+    static Table* generateEmptyPlanCacheStatsTable();
+
+    /*
+     * Constructor caches reference to the counters the cache updates
+     */
+    PlanCacheStats(const voltdb::PlanCacheCounters &counters);
+
+protected:
+
+    /**
+     * Update the stats tuple with the latest statistics available to this StatsSource.
+     */
+    virtual void updateStatsTuple(voltdb::TableTuple *tuple);
+
+    /**
+     * Generates the list of column names that will be in the statTable_. Derived classes must override this method and call
+     * the parent class's version to obtain the list of columns contributed by ancestors and then append the columns they will be
+     * contributing to the end of the list.
+     */
+    virtual std::vector<std::string> generateStatsColumnNames();
+
+    /**
+     * Same pattern as generateStatsColumnNames except the return value is used as an offset into the tuple schema instead of appending to
+     * end of a list.
+     */
+    virtual void populateSchema(std::vector<voltdb::ValueType> &types, std::vector<int32_t> &columnLengths, std::vector<bool> &allowNull);
+
+private:
+    const voltdb::PlanCacheCounters &m_counters;
+
+    int64_t m_lastHits;
+    int64_t m_lastMisses;
+    int64_t m_lastEvictions;
+};
+
+}
+
+#endif /* PLANCACHESTATS_H_ */
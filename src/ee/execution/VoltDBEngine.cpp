@@ -83,6 +83,7 @@
 #include "executors/executorutil.h"
 #include "storage/table.h"
 #include "storage/tablefactory.h"
+#include "storage/temptable.h"
 #include "indexes/tableindex.h"
 #include "storage/constraintutil.h"
 #include "storage/persistenttable.h"
@@ -120,7 +121,8 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy)
       m_numResultDependencies(0),
       m_logManager(logProxy),
       m_templateSingleLongTable(NULL),
-      m_topend(topend)
+      m_topend(topend),
+      m_planCacheStats(m_planCacheCounters)
 {
     // init the number of planfragments executed
     m_pfCount = 0;
@@ -210,6 +212,10 @@ VoltDBEngine::initialize(int32_t clusterIndex,
                                             hostname,
                                             hostId);
 
+    m_planCacheStats.configure("Plan cache stats", 0);
+    getStatsManager().registerStatsSource(STATISTICS_SELECTOR_TYPE_PLAN_CACHE, 0,
+                                          &m_planCacheStats);
+
     return true;
 }
 
@@ -902,7 +908,7 @@ bool
 VoltDBEngine::updateCatalog(const int64_t timestamp, const string &catalogPayload)
 {
     // clean up execution plans when the tables underneath might change
-    m_plans.clear();
+    clearPlanCache();
 
     assert(m_catalog != NULL); // the engine must be initialized
 
@@ -1020,11 +1026,13 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
         // move it to the front of the list
         PlanSet::iterator iter2 = m_plans.project<0>(iter);
         m_plans.get<0>().relocate(m_plans.begin(), iter2);
+        ++m_planCacheCounters.hits;
         VoltDBEngine::ExecutorVector *retval = (*iter).get();
         assert(retval);
         return retval;
     }
     else {
+        ++m_planCacheCounters.misses;
         std::string plan = m_topend->planForFragmentId(fragId);
 
         if (plan.length() == 0) {
@@ -1086,17 +1094,41 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
         }
 
         // Initialize the vector of executors for this planfragment, used at runtime.
+        // An executor that can consume its only child's output one tuple at a
+        // time is chained to that child, which then drives it, so it does not
+        // get a place of its own in the list and the child's output is never
+        // materialized. Blocking executors (e.g. ORDER BY) do not take
+        // pipelined input and still read a fully materialized input table.
         for (int ctr = 0, cnt = (int)pnf->getExecuteList().size(); ctr < cnt; ctr++) {
-            ev->list.push_back(pnf->getExecuteList()[ctr]->getExecutor());
+            AbstractPlanNode* node = pnf->getExecuteList()[ctr];
+            AbstractExecutor* executor = node->getExecutor();
+            if (node->getChildren().size() == 1 && executor->supportsPipelinedInput()) {
+                AbstractExecutor* childExecutor = node->getChildren()[0]->getExecutor();
+                if (childExecutor->supportsPipelinedOutput()) {
+                    VOLT_TRACE("Pipelining PlanNode '%s' into its child",
+                               node->debug().c_str());
+                    childExecutor->setPipelineConsumer(executor);
+                    continue;
+                }
+            }
+            ev->list.push_back(executor);
         }
 
-        // add the plan to the back
-        m_plans.get<0>().push_back(ev);
-
-        // remove a plan from the front if the cache is full
-        if (m_plans.size() > PLAN_CACHE_SIZE) {
-            PlanSet::iterator iter = m_plans.get<0>().begin();
-            m_plans.erase(iter);
+        // add the plan to the front, as the most recently used
+        ev->bytes = estimateExecutorVectorBytes(*ev, plan.length());
+        m_plans.get<0>().push_front(ev);
+        ++m_planCacheCounters.entries;
+        m_planCacheCounters.bytes += ev->bytes;
+
+        // remove the least recently used plans from the back while the
+        // cache is too full, but never the one just loaded
+        while (m_plans.size() > 1 &&
+               (m_plans.size() > PLAN_CACHE_SIZE ||
+                m_planCacheCounters.bytes > PLAN_CACHE_BYTES)) {
+            --m_planCacheCounters.entries;
+            m_planCacheCounters.bytes -= m_plans.back()->bytes;
+            ++m_planCacheCounters.evictions;
+            m_plans.pop_back();
         }
 
         VoltDBEngine::ExecutorVector *retval = ev.get();
@@ -1107,6 +1139,27 @@ VoltDBEngine::ExecutorVector *VoltDBEngine::getExecutorVectorForFragmentId(const
     return NULL;
 }
 
+int64_t VoltDBEngine::estimateExecutorVectorBytes(const ExecutorVector &ev, size_t planLength) {
+    int64_t bytes = static_cast<int64_t>(planLength + sizeof(ExecutorVector) +
+                                         ev.list.capacity() * sizeof(AbstractExecutor*));
+    const std::vector<AbstractPlanNode*> &nodes = ev.planFragment->getExecuteList();
+    for (size_t ii = 0; ii < nodes.size(); ii++) {
+        bytes += sizeof(AbstractPlanNode) + sizeof(AbstractExecutor);
+        // other nodes' output tables are persistent tables they write to
+        TempTable *output = dynamic_cast<TempTable*>(nodes[ii]->getOutputTable());
+        if (output != NULL) {
+            bytes += output->getTableAllocationSize();
+        }
+    }
+    return bytes;
+}
+
+void VoltDBEngine::clearPlanCache() {
+    m_plans.clear();
+    m_planCacheCounters.entries = 0;
+    m_planCacheCounters.bytes = 0;
+}
+
 // -------------------------------------------------
 // Initialization Functions
 // -------------------------------------------------
@@ -1245,6 +1298,22 @@ void VoltDBEngine::tick(int64_t timeInMillis, int64_t lastCommittedSpHandle) {
     BOOST_FOREACH (TablePair table, m_exportingTables) {
         table.second->flushOldTuples(timeInMillis);
     }
+
+    int64_t compactionTuples = TICK_COMPACTION_TUPLES;
+    int64_t compactionMicros = TICK_COMPACTION_MICROS;
+    typedef pair<CatalogId, Table*> CatalogTablePair;
+    BOOST_FOREACH (CatalogTablePair table, m_tables) {
+        if (compactionTuples <= 0 || compactionMicros <= 0) {
+            break;
+        }
+        PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(table.second);
+        if (persistentTable != NULL) {
+            const int64_t microsBefore = persistentTable->compactionMicros();
+            compactionTuples -= persistentTable->doIncrementalCompaction(compactionTuples,
+                                                                         compactionMicros);
+            compactionMicros -= persistentTable->compactionMicros() - microsBefore;
+        }
+    }
 }
 
 /** For now, bring the Export system to a steady state with no buffers with content */
@@ -1343,6 +1412,21 @@ int VoltDBEngine::getStats(int selector, int locators[], int numLocators,
                 }
             }
 
+            resultTable = m_statsManager.getStats(
+                (StatisticsSelectorType) selector,
+                locatorIds, interval, now);
+            break;
+        case STATISTICS_SELECTOR_TYPE_MEMORY:
+            // a row for each of the thread's pools, whatever was asked for
+            locatorIds.clear();
+            registerPoolStats(locatorIds);
+            resultTable = m_statsManager.getStats(
+                (StatisticsSelectorType) selector,
+                locatorIds, interval, now);
+            break;
+        case STATISTICS_SELECTOR_TYPE_PLAN_CACHE:
+            // the engine's one plan cache is registered as locator 0
+            locatorIds.assign(1, 0);
             resultTable = m_statsManager.getStats(
                 (StatisticsSelectorType) selector,
                 locatorIds, interval, now);
@@ -1371,6 +1455,32 @@ int VoltDBEngine::getStats(int selector, int locators[], int numLocators,
     }
 }
 
+void VoltDBEngine::registerPoolStats(vector<CatalogId> &locatorIds) {
+    vector<const SlabPool*> pools;
+    // configuring a source can take memory from a pool not seen yet
+    bool registered = true;
+    while (registered) {
+        registered = false;
+        pools.clear();
+        ThreadLocalPool::getPools(pools);
+        for (size_t ii = 0; ii < pools.size(); ii++) {
+            if (m_poolsWithStats.insert(pools[ii]).second) {
+                ThreadLocalPoolStats *stats = new ThreadLocalPoolStats(pools[ii]->getStats());
+                m_poolStats.push_back(stats);
+                stats->configure("Pool stats", 0);
+                // each pool allocates a different size, which locates its stats
+                getStatsManager().registerStatsSource(STATISTICS_SELECTOR_TYPE_MEMORY,
+                                                      static_cast<CatalogId>(pools[ii]->getRequestedSize()),
+                                                      stats);
+                registered = true;
+            }
+        }
+    }
+    for (size_t ii = 0; ii < pools.size(); ii++) {
+        locatorIds.push_back(static_cast<CatalogId>(pools[ii]->getRequestedSize()));
+    }
+}
+
 
 void VoltDBEngine::setCurrentUndoQuantum(voltdb::UndoQuantum* undoQuantum)
 {
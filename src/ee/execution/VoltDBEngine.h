@@ -64,6 +64,7 @@
 #include "catalog/database.h"
 #include "common/ids.h"
 #include "common/serializeio.h"
+#include "common/SharedBufferRing.h"
 #include "common/types.h"
 #include "common/valuevector.h"
 #include "common/Pool.hpp"
@@ -74,6 +75,7 @@
 #include "common/TupleOutputStream.h"
 #include "common/TheHashinator.h"
 #include "execution/FragmentManager.h"
+#include "execution/PlanCacheStats.h"
 #include "logging/LogManager.h"
 #include "logging/LogProxy.h"
 #include "logging/StdoutLogProxy.h"
@@ -81,6 +83,7 @@
 #include "stats/StatsAgent.h"
 #include "storage/TempTableLimits.h"
 #include "common/ThreadLocalPool.h"
+#include "common/ThreadLocalPoolStats.h"
 
 // shorthand for ExecutionEngine versions generated by javah
 #define ENGINE_ERRORCODE_SUCCESS 0
@@ -114,8 +117,13 @@ class RecoveryProtoMsg;
 
 const int64_t DEFAULT_TEMP_TABLE_MEMORY = 1024 * 1024 * 100;
 const size_t PLAN_CACHE_SIZE = 1024 * 10;
+// bytes of plan text and loaded executors the plan cache may hold
+const int64_t PLAN_CACHE_BYTES = 1024 * 1024 * 256;
 // how many tuples to scan before calling into java
 const int64_t LONG_OP_THRESHOLD = 10000;
+// how much compaction one tick may do across all tables
+const int64_t TICK_COMPACTION_TUPLES = 50000;
+const int64_t TICK_COMPACTION_MICROS = 20000;
 
 /**
  * Represents an Execution Engine which holds catalog objects (i.e. table) and executes
@@ -136,7 +144,8 @@ class __attribute__((visibility("default"))) VoltDBEngine {
           m_currentInputDepId(-1),
           m_isELEnabled(false),
           m_numResultDependencies(0),
-          m_logManager(new StdoutLogProxy()), m_templateSingleLongTable(NULL), m_topend(NULL)
+          m_logManager(new StdoutLogProxy()), m_templateSingleLongTable(NULL), m_topend(NULL),
+          m_planCacheStats(m_planCacheCounters)
         {
         }
 
@@ -242,6 +251,16 @@ class __attribute__((visibility("default"))) VoltDBEngine {
                        bool returnUniqueViolations);
 
         void resetReusedResultOutputBuffer(const size_t headerSize = 0);
+        /**
+         * Like resetReusedResultOutputBuffer, but results go to the next
+         * buffer of the result buffer ring if one has been set, where the
+         * caller reads them in place and they can grow to the full result
+         * size limit without falling back to an EE allocated copy.
+         */
+        void resetRingResultOutputBuffer(const size_t headerSize = 0);
+        /** Takes ownership of the ring. */
+        void setResultBufferRing(SharedBufferRing *ring) { m_resultBufferRing.reset(ring); }
+        SharedBufferRing* getResultBufferRing() const { return m_resultBufferRing.get(); }
         inline ReferenceSerializeOutput* getExceptionOutputSerializer() { return &m_exceptionOutput; }
         void setBuffers(char *parameter_buffer, int m_parameterBuffercapacity,
                 char *resultBuffer, int resultBufferCapacity,
@@ -274,7 +293,10 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         // Non-transactional work methods
         // -------------------------------------------------
 
-        /** Perform once per second, non-transactional work. */
+        /**
+         * Perform once per second, non-transactional work, including a
+         * bounded slice of compaction of the tables that need it.
+         */
         void tick(int64_t timeInMillis, int64_t lastCommittedSpHandle);
 
         /** flush active work (like EL buffers) */
@@ -459,6 +481,12 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         void printReport();
 
+        /**
+         * Register a stats source for each of the thread's pools that
+         * doesn't have one yet, and list the locators of all of them.
+         */
+        void registerPoolStats(std::vector<CatalogId> &locatorIds);
+
         /**
          * Call into the topend with information about how executing a plan fragment is going.
          */
@@ -471,7 +499,7 @@ class __attribute__((visibility("default"))) VoltDBEngine {
             ExecutorVector(int64_t fragmentId,
                            int64_t logThreshold,
                            int64_t memoryLimit,
-                           PlanNodeFragment *fragment) : fragId(fragmentId), planFragment(fragment)
+                           PlanNodeFragment *fragment) : fragId(fragmentId), planFragment(fragment), bytes(0)
             {
                 limits.setLogThreshold(logThreshold);
                 limits.setMemoryLimit(memoryLimit);
@@ -483,6 +511,8 @@ class __attribute__((visibility("default"))) VoltDBEngine {
             boost::shared_ptr<PlanNodeFragment> planFragment;
             std::vector<AbstractExecutor*> list;
             TempTableLimits limits;
+            // estimated bytes this and its plan's text hold in the plan cache
+            int64_t bytes;
         };
 
         /**
@@ -508,6 +538,15 @@ class __attribute__((visibility("default"))) VoltDBEngine {
          */
         ExecutorVector *getExecutorVectorForFragmentId(const int64_t fragId);
 
+        /**
+         * Estimate the bytes a loaded plan holds: its text, the plan nodes
+         * and executors, and the block each output temp table keeps once
+         * it has been used.
+         */
+        static int64_t estimateExecutorVectorBytes(const ExecutorVector &ev, size_t planLength);
+
+        void clearPlanCache();
+
         voltdb::UndoLog m_undoLog;
         voltdb::UndoQuantum *m_currentUndoQuantum;
 
@@ -580,6 +619,8 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         char* m_reusedResultBuffer;
         /** size of reused_result_buffer. */
         int m_reusedResultCapacity;
+        /** buffers for executePlanFragments results, if the caller set them up. */
+        boost::scoped_ptr<SharedBufferRing> m_resultBufferRing;
 
         // arrays to hold fragment ids and dep ids from java
         // n.b. these are 8k each, should be boost shared arrays?
@@ -635,6 +676,13 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         DefaultTupleSerializer m_tupleSerializer;
 
         ThreadLocalPool m_tlPool;
+
+        // after the pool, so the stats (whose strings it holds) go first
+        PlanCacheCounters m_planCacheCounters;
+        PlanCacheStats m_planCacheStats;
+        // one for each of the pools, which live as long as m_tlPool
+        boost::ptr_vector<ThreadLocalPoolStats> m_poolStats;
+        std::set<const SlabPool*> m_poolsWithStats;
 };
 
 inline void VoltDBEngine::resetReusedResultOutputBuffer(const size_t headerSize) {
@@ -643,14 +691,30 @@ inline void VoltDBEngine::resetReusedResultOutputBuffer(const size_t headerSize)
     *reinterpret_cast<int32_t*>(m_exceptionBuffer) = voltdb::VOLT_EE_EXCEPTION_TYPE_NONE;
 }
 
+inline void VoltDBEngine::resetRingResultOutputBuffer(const size_t headerSize) {
+    if (m_resultBufferRing.get() == NULL) {
+        resetReusedResultOutputBuffer(headerSize);
+        return;
+    }
+    const int current = m_resultBufferRing->current();
+    const bool wroteToRing = current >= 0 && m_resultOutput.data() == m_resultBufferRing->buffer(current);
+    char *buffer = m_resultBufferRing->advance(wroteToRing ? m_resultOutput.size() : 0);
+    m_resultOutput.initializeWithPosition(buffer, m_resultBufferRing->capacity(), headerSize);
+    m_exceptionOutput.initializeWithPosition(m_exceptionBuffer, m_exceptionBufferCapacity, headerSize);
+    *reinterpret_cast<int32_t*>(m_exceptionBuffer) = voltdb::VOLT_EE_EXCEPTION_TYPE_NONE;
+}
+
 /**
  * Track total tuples accessed for this query.
  * Set up statistics for long running operations thru m_engine if total tuples accessed passes the threshold.
  */
 inline void VoltDBEngine::noteTuplesProcessedForProgressMonitoring(int tuplesProcessed) {
 #ifndef ENABLE_POST_4_0
+    // batched scans report many tuples at once, so check whether the
+    // count crossed a threshold rather than landed exactly on one
+    int64_t previous = m_tuplesProcessedInFragment;
     m_tuplesProcessedInFragment += tuplesProcessed;
-    if((m_tuplesProcessedInFragment % LONG_OP_THRESHOLD) == 0) {
+    if((previous / LONG_OP_THRESHOLD) != (m_tuplesProcessedInFragment / LONG_OP_THRESHOLD)) {
         reportProgessToTopend();
     }
 #endif
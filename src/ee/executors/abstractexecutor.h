@@ -84,10 +84,46 @@ class AbstractExecutor {
      */
     inline AbstractPlanNode* getPlanNode() { return m_abstractNode; }
 
+    /**
+     * Pipelined execution: an executor that can produce its output one
+     * tuple at a time may hand each tuple straight to its parent instead
+     * of inserting it into its output table. The parent is then driven by
+     * the producer through pipelineStart(), pipelineTuple() and
+     * pipelineFinish() and is not executed on its own.
+     */
+    virtual bool supportsPipelinedOutput() { return false; }
+    virtual bool supportsPipelinedInput() { return false; }
+
+    /** Route this executor's output tuples to the given consumer */
+    void setPipelineConsumer(AbstractExecutor* consumer) { m_pipelineConsumer = consumer; }
+
+    /** Prepare a pipelined consumer (and its own consumer) for a new execution */
+    bool pipelineStart(const NValueArray& params);
+
+    /**
+     * Consume one tuple from the producer. Returns false once no further
+     * tuples are wanted, e.g. when a limit has been reached.
+     */
+    bool pipelineTuple(TableTuple& tuple) { return p_pipelineTuple(tuple); }
+
+    /** Complete a pipelined execution after the producer's last tuple */
+    bool pipelineFinish();
+
+    /**
+     * Returns true if this consumer may stop taking tuples before the
+     * producer runs out, as a limit does. The producer must then not
+     * evaluate anything on tuples past the one it hands over. By default
+     * a consumer stops when its own consumer does.
+     */
+    virtual bool mayStopPipelineEarly() const {
+        return m_pipelineConsumer != NULL && m_pipelineConsumer->mayStopPipelineEarly();
+    }
+
   protected:
     AbstractExecutor(VoltDBEngine* engine, AbstractPlanNode* abstractNode) {
         m_abstractNode = abstractNode;
         m_tmpOutputTable = NULL;
+        m_pipelineConsumer = NULL;
         m_engine = engine;
     }
 
@@ -98,6 +134,20 @@ class AbstractExecutor {
     /** Concrete executor classes impelmenet execution in p_execute() */
     virtual bool p_execute(const NValueArray& params) = 0;
 
+    /**
+     * Executor classes that support pipelined input implement these in
+     * place of p_execute() when they are driven by their child.
+     */
+    virtual bool p_pipelineStart(const NValueArray& params) { return true; }
+    virtual bool p_pipelineTuple(TableTuple& tuple) { return true; }
+    virtual bool p_pipelineFinish() { return true; }
+
+    /**
+     * Emit one output tuple, either to the pipeline consumer or into the
+     * output table. Returns false once the consumer wants no more tuples.
+     */
+    inline bool outputTuple(TableTuple& tuple);
+
     /**
      * Returns true if the output table for the plannode must be
      * cleared before p_execute().  <b>Default is true (clear each
@@ -123,6 +173,9 @@ class AbstractExecutor {
     AbstractPlanNode* m_abstractNode;
     TempTable* m_tmpOutputTable;
 
+    // parent executor that consumes our output tuples, if pipelined
+    AbstractExecutor* m_pipelineConsumer;
+
     // cache to avoid runtime virtual function call
     bool needs_outputtable_clear_cached;
 
@@ -153,8 +206,53 @@ inline bool AbstractExecutor::execute(const NValueArray& params)
         m_abstractNode->getOutputSchema()[i]->getExpression()->substitute(params);
     }
 
-    // run the executor
-    return p_execute(params);
+    if (m_pipelineConsumer == NULL) {
+        // run the executor
+        return p_execute(params);
+    }
+
+    // run the executor along with the consumers it drives
+    return m_pipelineConsumer->pipelineStart(params) &&
+        p_execute(params) &&
+        m_pipelineConsumer->pipelineFinish();
+}
+
+inline bool AbstractExecutor::pipelineStart(const NValueArray& params)
+{
+    assert(m_abstractNode);
+    VOLT_TRACE("Starting pipelined execution of plannode(id=%d)...",
+               m_abstractNode->getPlanNodeId());
+
+    if (m_tmpOutputTable)
+    {
+        m_tmpOutputTable->deleteAllTuplesNonVirtual(false);
+    }
+    for (int i = 0; i < m_abstractNode->getOutputSchema().size(); i++) {
+        m_abstractNode->getOutputSchema()[i]->getExpression()->substitute(params);
+    }
+
+    if (!p_pipelineStart(params)) {
+        return false;
+    }
+    return m_pipelineConsumer == NULL || m_pipelineConsumer->pipelineStart(params);
+}
+
+inline bool AbstractExecutor::pipelineFinish()
+{
+    if (!p_pipelineFinish()) {
+        return false;
+    }
+    return m_pipelineConsumer == NULL || m_pipelineConsumer->pipelineFinish();
+}
+
+inline bool AbstractExecutor::outputTuple(TableTuple& tuple)
+{
+    if (m_pipelineConsumer != NULL) {
+        return m_pipelineConsumer->pipelineTuple(tuple);
+    }
+    assert(m_tmpOutputTable);
+    m_tmpOutputTable->insertTempTuple(tuple);
+    return true;
 }
 
 }
@@ -46,6 +46,7 @@
 #include "executors/aggregateexecutor.h"
 
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 #include "common/common.h"
 #include "common/debuglog.h"
 #include "common/SerializableEEException.h"
@@ -64,6 +65,20 @@
 #include <utility>
 
 namespace voltdb {
+/*
+ * A value an aggregate keeps past the input tuple it was read from.
+ * A pipelined child may reuse that tuple's storage for its next row, so a
+ * string read in place from it is copied into the executor's pool.
+ */
+static inline NValue retainedValue(const NValue& val, Pool* memoryPool)
+{
+    NValue retained = val;
+    if (retained.getSourceInlined()) {
+        retained.allocateObjectFromInlinedValue(memoryPool);
+    }
+    return retained;
+}
+
 /*
  * Type of the hash set used to check for column aggregate distinctness
  */
@@ -77,6 +92,8 @@ typedef boost::unordered_set<NValue,
  * It is specified as a parameter class that determines the type of the ifDistinct data member.
  */
 struct Distinct : public AggregateNValueSetType {
+    Distinct(Pool* memoryPool) : m_memoryPool(memoryPool) {}
+
     bool excludeValue(const NValue& val)
     {
         // find this value in the set.  If it doesn't exist, add
@@ -85,11 +102,14 @@ struct Distinct : public AggregateNValueSetType {
         iterator setval = find(val);
         if (setval == end())
         {
-            insert(val);
+            insert(retainedValue(val, m_memoryPool));
             return false; // Include value just this once.
         }
         return true; // Never again this value;
     }
+
+private:
+    Pool* m_memoryPool;
 };
 
 /**
@@ -98,6 +118,7 @@ struct Distinct : public AggregateNValueSetType {
  * It is specified as a parameter class that determines the type of the ifDistinct data member.
  */
 struct NotDistinct {
+    NotDistinct(Pool* memoryPool) {}
     void clear() { }
     bool excludeValue(const NValue& val)
     {
@@ -141,7 +162,7 @@ template<class D>
 class SumAgg : public Agg
 {
   public:
-    SumAgg() {}
+    SumAgg(Pool* memoryPool) : ifDistinct(memoryPool) {}
 
     virtual void advance(const NValue& val)
     {
@@ -173,7 +194,7 @@ template<class D>
 class AvgAgg : public Agg
 {
 public:
-    AvgAgg() : m_count(0) {}
+    AvgAgg(Pool* memoryPool) : ifDistinct(memoryPool), m_count(0) {}
 
     virtual void advance(const NValue& val)
     {
@@ -217,7 +238,7 @@ template<class D>
 class CountAgg : public Agg
 {
 public:
-    CountAgg() : m_count(0) {}
+    CountAgg(Pool* memoryPool) : ifDistinct(memoryPool), m_count(0) {}
 
     virtual void advance(const NValue& val)
     {
@@ -272,7 +293,7 @@ private:
 class MaxAgg : public Agg
 {
 public:
-    MaxAgg() {}
+    MaxAgg(Pool* memoryPool) : m_memoryPool(memoryPool) {}
 
     virtual void advance(const NValue& val)
     {
@@ -282,20 +303,23 @@ public:
         }
         if (!m_haveAdvanced)
         {
-            m_value = val;
+            m_value = retainedValue(val, m_memoryPool);
             m_haveAdvanced = true;
         }
-        else
+        else if (val.compare(m_value) > 0)
         {
-            m_value = m_value.op_max(val);
+            m_value = retainedValue(val, m_memoryPool);
         }
     }
+
+private:
+    Pool* m_memoryPool;
 };
 
 class MinAgg : public Agg
 {
 public:
-    MinAgg() { }
+    MinAgg(Pool* memoryPool) : m_memoryPool(memoryPool) {}
 
     virtual void advance(const NValue& val)
     {
@@ -305,14 +329,17 @@ public:
         }
         if (!m_haveAdvanced)
         {
-            m_value = val;
+            m_value = retainedValue(val, m_memoryPool);
             m_haveAdvanced = true;
         }
-        else
+        else if (val.compare(m_value) < 0)
         {
-            m_value = m_value.op_min(val);
+            m_value = retainedValue(val, m_memoryPool);
         }
     }
+
+private:
+    Pool* m_memoryPool;
 };
 
 /*
@@ -325,24 +352,24 @@ inline Agg* getAggInstance(Pool& memoryPool, ExpressionType agg_type, bool isDis
     case EXPRESSION_TYPE_AGGREGATE_COUNT_STAR:
         return new (memoryPool) CountStarAgg();
     case EXPRESSION_TYPE_AGGREGATE_MIN:
-        return new (memoryPool) MinAgg();
+        return new (memoryPool) MinAgg(&memoryPool);
     case EXPRESSION_TYPE_AGGREGATE_MAX  :
-        return new (memoryPool) MaxAgg();
+        return new (memoryPool) MaxAgg(&memoryPool);
     case EXPRESSION_TYPE_AGGREGATE_COUNT:
         if (isDistinct) {
-            return new (memoryPool) CountAgg<Distinct>();
+            return new (memoryPool) CountAgg<Distinct>(&memoryPool);
         }
-        return new (memoryPool) CountAgg<NotDistinct>();
+        return new (memoryPool) CountAgg<NotDistinct>(&memoryPool);
     case EXPRESSION_TYPE_AGGREGATE_SUM:
         if (isDistinct) {
-            return new (memoryPool) SumAgg<Distinct>();
+            return new (memoryPool) SumAgg<Distinct>(&memoryPool);
         }
-        return new (memoryPool) SumAgg<NotDistinct>();
+        return new (memoryPool) SumAgg<NotDistinct>(&memoryPool);
     case EXPRESSION_TYPE_AGGREGATE_AVG:
         if (isDistinct) {
-            return new (memoryPool) AvgAgg<Distinct>();
+            return new (memoryPool) AvgAgg<Distinct>(&memoryPool);
         }
-        return new (memoryPool) AvgAgg<NotDistinct>();
+        return new (memoryPool) AvgAgg<NotDistinct>(&memoryPool);
     default:
     {
         char message[128];
@@ -459,12 +486,57 @@ bool AggregateExecutorBase::p_init(AbstractPlanNode*, TempTableLimits* limits)
                                                         groupByColumnSizes,
                                                         groupByColumnAllowNull,
                                                         true);
+    m_nextGroupByKeyStorage.init(m_groupByKeySchema, &m_memoryPool);
+    return true;
+}
+
+bool AggregateExecutorBase::p_execute(const NValueArray& params)
+{
+    executeAggBase(params);
+    m_pipelinedInput = false;
+    startAggregation();
+
+    VOLT_TRACE("looping..");
+    Table* input_table = m_abstractNode->getInputTables()[0];
+    assert(input_table);
+    VOLT_TRACE("input table\n%s", input_table->debug().c_str());
+    // ENG-1565: the pre-predicate is only planned over a single input row
+    assert(m_prePredicate == NULL || input_table->activeTupleCount() <= 1);
+    TableIterator it = input_table->iterator();
+    TableTuple nxtTuple(input_table->schema());
+    while (it.next(nxtTuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        aggregateTuple(nxtTuple);
+    }
+
+    VOLT_TRACE("finalizing..");
+    finishAggregation();
+    return true;
+}
+
+bool AggregateExecutorBase::p_pipelineStart(const NValueArray& params)
+{
+    executeAggBase(params);
+    m_pipelinedInput = true;
+    startAggregation();
+    return true;
+}
+
+bool AggregateExecutorBase::p_pipelineTuple(TableTuple& tuple)
+{
+    aggregateTuple(tuple);
+    return true;
+}
+
+bool AggregateExecutorBase::p_pipelineFinish()
+{
+    VOLT_TRACE("finalizing..");
+    finishAggregation();
     return true;
 }
 
 inline void AggregateExecutorBase::executeAggBase(const NValueArray& params)
 {
-    m_memoryPool.purge();
     VOLT_DEBUG("started AGGREGATE");
     assert(dynamic_cast<AggregatePlanNode*>(m_abstractNode));
     assert(m_tmpOutputTable);
@@ -529,12 +601,26 @@ inline void AggregateExecutorBase::insertOutputTuple(AggregateRow* aggregateRow)
         VOLT_TRACE("Passthrough columns: %d", output_col_index);
     }
     if (m_postPredicate == NULL || m_postPredicate->eval(&tmptup, NULL).isTrue()) {
-        output_table->insertTupleNonVirtual(tmptup);
+        outputTuple(tmptup);
     }
 
     VOLT_TRACE("output_table:\n%s", output_table->debug().c_str());
 }
 
+inline void AggregateExecutorBase::setPassThroughTuple(AggregateRow* aggregateRow, const TableTuple& nxtTuple)
+{
+    if (!m_pipelinedInput) {
+        aggregateRow->m_passThroughTuple = nxtTuple;
+        return;
+    }
+    TableTuple& passThroughTuple = aggregateRow->m_passThroughTuple;
+    if (passThroughTuple.isNullTuple()) {
+        char* storage = reinterpret_cast<char*>(m_memoryPool.allocate(nxtTuple.tupleLength()));
+        passThroughTuple = TableTuple(storage, nxtTuple.getSchema());
+    }
+    passThroughTuple.copy(nxtTuple);
+}
+
 inline void AggregateExecutorBase::advanceAggs(AggregateRow* aggregateRow)
 {
     Agg** aggs = aggregateRow->m_aggregates;
@@ -557,93 +643,211 @@ inline void AggregateExecutorBase::initAggInstances(AggregateRow* aggregateRow)
     }
 }
 
-typedef boost::unordered_map<TableTuple,
-                             AggregateRow*,
-                             TableTupleHasher,
-                             TableTupleEqualityChecker> HashAggregateMapType;
+const uint64_t AggregateHashExecutor::MAX_KEPT_SLOTS;
 
-bool AggregateHashExecutor::p_execute(const NValueArray& params)
+static bool isIntegerGroupByType(ValueType type)
 {
-    executeAggBase(params);
+    switch (type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+        return true;
+    default:
+        return false;
+    }
+}
 
-    HashAggregateMapType hash;
+bool AggregateHashExecutor::p_init(AbstractPlanNode* abstract_node, TempTableLimits* limits)
+{
+    if (!AggregateExecutorBase::p_init(abstract_node, limits)) {
+        return false;
+    }
+    m_intGroupByColumns = 0;
+    if (m_groupByExpressions.size() == 1 || m_groupByExpressions.size() == 2) {
+        bool allIntegers = true;
+        BOOST_FOREACH(AbstractExpression* groupByExpression, m_groupByExpressions) {
+            allIntegers = allIntegers && isIntegerGroupByType(groupByExpression->getValueType());
+        }
+        if (allIntegers) {
+            m_intGroupByColumns = static_cast<int>(m_groupByExpressions.size());
+        }
+    }
+    return true;
+}
 
-    VOLT_TRACE("looping..");
-    Table* input_table = m_abstractNode->getInputTables()[0];
-    assert(input_table);
-    VOLT_TRACE("input table\n%s", input_table->debug().c_str());
-    TableIterator it = input_table->iterator();
-    TableTuple nxtTuple(input_table->schema());
-    PoolBackedTupleStorage nextGroupByKeyStorage(m_groupByKeySchema, &m_memoryPool);
-    TableTuple& nextGroupByKeyTuple = nextGroupByKeyStorage;
-    while (it.next(nxtTuple)) {
-        m_engine->noteTuplesProcessedForProgressMonitoring(1);
-        initGroupByKeyTuple(nextGroupByKeyStorage, nxtTuple);
-        AggregateRow *aggregateRow;
-        // Search for the matching group.
-        HashAggregateMapType::const_iterator keyIter = hash.find(nextGroupByKeyTuple);
-
-        // Group not found. Make a new entry in the hash for this new group.
-        if (keyIter == hash.end()) {
-            aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
-            hash.insert(HashAggregateMapType::value_type(nextGroupByKeyTuple, aggregateRow));
-            initAggInstances(aggregateRow);
-            aggregateRow->m_passThroughTuple = nxtTuple;
+AggregateHashExecutor::~AggregateHashExecutor()
+{
+    deleteAggregateRows();
+}
+
+template<typename MapType>
+void AggregateHashExecutor::deleteAggregateRows(MapType& map)
+{
+    for (typename MapType::iterator iter = map.begin(); !iter.isEnd(); iter.moveNext()) {
+        delete iter.value();
+    }
+    // The next execution likely needs about as many groups.
+    map.reset(MAX_KEPT_SLOTS);
+}
+
+void AggregateHashExecutor::deleteAggregateRows()
+{
+    deleteAggregateRows(m_hash);
+    deleteAggregateRows(m_intHash);
+    deleteAggregateRows(m_intPairHash);
+}
+
+void AggregateHashExecutor::startAggregation()
+{
+    // Rows may be left over from an execution that was interrupted by an exception.
+    deleteAggregateRows();
+    m_memoryPool.purge();
+    TableTuple& nextGroupByKeyTuple = m_nextGroupByKeyStorage;
+    nextGroupByKeyTuple.move(NULL);
+}
+
+inline AggregateRow* AggregateHashExecutor::newAggregateRow()
+{
+    AggregateRow* aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
+    initAggInstances(aggregateRow);
+    return aggregateRow;
+}
+
+void AggregateHashExecutor::aggregateTuple(TableTuple& nxtTuple)
+{
+    AggregateRow* aggregateRow;
+    bool inserted;
+    // Search for the matching group, making a new entry in the hash if it is not found.
+    if (m_intGroupByColumns == 1) {
+        const int64_t key = ValuePeeker::peekAsBigInt(m_groupByExpressions[0]->eval(&nxtTuple));
+        AggregateRow*& entry = m_intHash.findOrInsert(key, NULL, inserted);
+        if (inserted) {
+            entry = newAggregateRow();
+        }
+        aggregateRow = entry;
+    } else if (m_intGroupByColumns == 2) {
+        const IntPairGroupByKey key(ValuePeeker::peekAsBigInt(m_groupByExpressions[0]->eval(&nxtTuple)),
+                                    ValuePeeker::peekAsBigInt(m_groupByExpressions[1]->eval(&nxtTuple)));
+        AggregateRow*& entry = m_intPairHash.findOrInsert(key, NULL, inserted);
+        if (inserted) {
+            entry = newAggregateRow();
+        }
+        aggregateRow = entry;
+    } else {
+        TableTuple& nextGroupByKeyTuple = m_nextGroupByKeyStorage;
+        initGroupByKeyTuple(m_nextGroupByKeyStorage, nxtTuple);
+        AggregateRow*& entry = m_hash.findOrInsert(nextGroupByKeyTuple, NULL, inserted);
+        if (inserted) {
+            entry = newAggregateRow();
             // The map is referencing the current key tuple for use by the new group,
             // so force a new tuple allocation to hold the next candidate key.
             nextGroupByKeyTuple.move(NULL);
-        } else {
-            // otherwise, the agg row is the second item of the pair...
-            aggregateRow = keyIter->second;
         }
-        // update the aggregation calculation.
-        aggregateRow->m_passThroughTuple = nxtTuple;
-        advanceAggs(aggregateRow);
+        aggregateRow = entry;
     }
+    // update the aggregation calculation.
+    setPassThroughTuple(aggregateRow, nxtTuple);
+    advanceAggs(aggregateRow);
+}
 
-    VOLT_TRACE("finalizing..");
-    for (HashAggregateMapType::const_iterator iter = hash.begin(); iter != hash.end(); iter++) {
-        AggregateRow *aggregateRow = iter->second;
-        insertOutputTuple(aggregateRow);
-        delete aggregateRow;
+template<typename MapType>
+void AggregateHashExecutor::insertOutputTuples(MapType& map)
+{
+    for (typename MapType::iterator iter = map.begin(); !iter.isEnd(); iter.moveNext()) {
+        insertOutputTuple(iter.value());
     }
+}
 
-    return true;
+void AggregateHashExecutor::finishAggregation()
+{
+    insertOutputTuples(m_hash);
+    insertOutputTuples(m_intHash);
+    insertOutputTuples(m_intPairHash);
+    deleteAggregateRows();
 }
 
 
-bool AggregateSerialExecutor::p_execute(const NValueArray& params)
+AggregateSerialExecutor::~AggregateSerialExecutor()
 {
-    executeAggBase(params);
+    delete m_aggregateRow;
+}
+
+void AggregateSerialExecutor::startAggregation()
+{
+    // A row may be left over from an execution that was interrupted by an exception.
+    delete m_aggregateRow;
+    m_memoryPool.purge();
 
-    // Serial aggregates need only one row of Aggs, the "previous" input tuple for pass-through columns,
-    // and the "previous" group key tuple that defines their associated group keys
-    // -- so group transitions can be detected.
     // In the case of table aggregates that have no grouping keys,
     // the previous input and group key tuples have no effect and are tracked here for nothing.
     // TODO: A separate concrete class (AggregateTableExecutor) could make that case much simpler/faster.
+    m_aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
+    TableTuple& nextGroupByKeyTuple = m_nextGroupByKeyStorage;
+    nextGroupByKeyTuple.move(NULL);
+    m_inProgressGroupByKeyTuple = TableTuple(m_groupByKeySchema);
+    m_primed = false;
+}
 
-    AggregateRow* aggregateRow = new (m_memoryPool, m_aggTypes.size()) AggregateRow();
-    boost::scoped_ptr<AggregateRow> will_finally_delete_aggregate_row(aggregateRow);
-    Table* input_table = m_abstractNode->getInputTables()[0];
-    assert(input_table);
-    VOLT_TRACE("input table\n%s", input_table->debug().c_str());
-    if (m_prePredicate != NULL) {
-        assert(input_table->activeTupleCount() <= 1);
-    }
-    TableIterator it = input_table->iterator();
-    TableTuple nxtTuple(input_table->schema());
-    PoolBackedTupleStorage nextGroupByKeyStorage(m_groupByKeySchema, &m_memoryPool);
-    TableTuple& nextGroupByKeyTuple = nextGroupByKeyStorage;
-    VOLT_TRACE("looping..");
+void AggregateSerialExecutor::aggregateTuple(TableTuple& nxtTuple)
+{
+    AggregateRow* aggregateRow = m_aggregateRow;
     // Use the first input tuple to "prime" the system.
-    // ENG-1565: for this special case, can have only one input row, apply the predicate here
-    if (it.next(nxtTuple) && (m_prePredicate == NULL || m_prePredicate->eval(&nxtTuple, NULL).isTrue())) {
-        initGroupByKeyTuple(nextGroupByKeyStorage, nxtTuple);
+    if (!m_primed) {
+        // ENG-1565: for this special case, can have only one input row, apply the predicate here
+        if (m_prePredicate != NULL && !m_prePredicate->eval(&nxtTuple, NULL).isTrue()) {
+            return;
+        }
+        initGroupByKeyTuple(m_nextGroupByKeyStorage, nxtTuple);
         // Start the aggregation calculation.
         initAggInstances(aggregateRow);
-        aggregateRow->m_passThroughTuple = nxtTuple;
+        setPassThroughTuple(aggregateRow, nxtTuple);
         advanceAggs(aggregateRow);
+        m_primed = true;
+        return;
+    }
+
+    // The nextGroupByKeyTuple now stores the key(s) of the current group in progress.
+    // Swap its storage with that of the inProgressGroupByKeyTuple.
+    // The inProgressGroupByKeyTuple will be null initially, until the first call to initGroupByKeyTuple below
+    // (as opposed to the initial call, above).
+    // But in the steady state, there will be exactly two allocations, one for the "in progress" group key
+    // and the other for the "next" candidate group key. These get "bank switched" with each iteration.
+    // The previous candidate group key ALWAYS becomes the new "in progress" group key.
+    // The previous "in progress" group key ALWAYS gets recycled for use by the "next" candidate group key.
+    // "ALWAYS" means regardless of whether any key values matched.
+    TableTuple& nextGroupByKeyTuple = m_nextGroupByKeyStorage;
+    void* recycledStorage = m_inProgressGroupByKeyTuple.address();
+    void* inProgressStorage = nextGroupByKeyTuple.address();
+    m_inProgressGroupByKeyTuple.move(inProgressStorage);
+    nextGroupByKeyTuple.move(recycledStorage);
+    initGroupByKeyTuple(m_nextGroupByKeyStorage, nxtTuple);
+
+    // Test for repetition of equal GROUP BY keys.
+    // Testing keys from last to first will typically be faster --
+    // if the GROUP BY keys are listed in major-to-minor sort order,
+    // the last one will be the most likely to have changed.
+    for (int ii = m_groupByKeySchema->columnCount() - 1; ii >= 0; --ii) {
+        if (nextGroupByKeyTuple.getNValue(ii).compare(m_inProgressGroupByKeyTuple.getNValue(ii)) != 0) {
+            VOLT_TRACE("new group!");
+            // Output old row.
+            insertOutputTuple(aggregateRow);
+            // Recycle the aggs to start a new row.
+            aggregateRow->resetAggs();
+            break;
+        }
+    }
+    // update the aggregation calculation.
+    setPassThroughTuple(aggregateRow, nxtTuple);
+    advanceAggs(aggregateRow);
+}
+
+void AggregateSerialExecutor::finishAggregation()
+{
+    if (m_primed) {
+        // There's one last group (or table) row in progress that needs to be output.
+        insertOutputTuple(m_aggregateRow);
     } else {
         VOLT_TRACE("finalizing after no input rows..");
         // No input rows means either no group rows (when grouping) or an empty table row (otherwise).
@@ -652,52 +856,12 @@ bool AggregateSerialExecutor::p_execute(const NValueArray& params)
         //   SELECT SUM(A) FROM BBB GROUP BY C, when BBB has no tuple, produces no output row.
         if (m_groupByKeySchema->columnCount() == 0) {
             VOLT_TRACE("no input row, but output an empty result row for the whole table.");
-            initAggInstances(aggregateRow);
-            insertOutputTuple(aggregateRow);
+            initAggInstances(m_aggregateRow);
+            insertOutputTuple(m_aggregateRow);
         }
-        return true;
     }
-
-    TableTuple inProgressGroupByKeyTuple(m_groupByKeySchema);
-    while (it.next(nxtTuple)) {
-        m_engine->noteTuplesProcessedForProgressMonitoring(1);
-        // The nextGroupByKeyTuple now stores the key(s) of the current group in progress.
-        // Swap its storage with that of the inProgressGroupByKeyTuple.
-        // The inProgressGroupByKeyTuple will be null initially, until the first call to initGroupByKeyTuple below
-        // (as opposed to the initial call, above).
-        // But in the steady state, there will be exactly two allocations, one for the "in progress" group key
-        // and the other for the "next" candidate group key. These get "bank switched" with each iteration.
-        // The previous candidate group key ALWAYS becomes the new "in progress" group key.
-        // The previous "in progress" group key ALWAYS gets recycled for use by the "next" candidate group key.
-        // "ALWAYS" means regardless of whether any key values matched.
-        void* recycledStorage = inProgressGroupByKeyTuple.address();
-        void* inProgressStorage = nextGroupByKeyTuple.address();
-        inProgressGroupByKeyTuple.move(inProgressStorage);
-        nextGroupByKeyTuple.move(recycledStorage);
-        initGroupByKeyTuple(nextGroupByKeyStorage, nxtTuple);
-
-        // Test for repetition of equal GROUP BY keys.
-        // Testing keys from last to first will typically be faster --
-        // if the GROUP BY keys are listed in major-to-minor sort order,
-        // the last one will be the most likely to have changed.
-        for (int ii = m_groupByKeySchema->columnCount() - 1; ii >= 0; --ii) {
-            if (nextGroupByKeyTuple.getNValue(ii).compare(inProgressGroupByKeyTuple.getNValue(ii)) != 0) {
-                VOLT_TRACE("new group!");
-                // Output old row.
-                insertOutputTuple(aggregateRow);
-                // Recycle the aggs to start a new row.
-                aggregateRow->resetAggs();
-                break;
-            }
-        }
-        // update the aggregation calculation.
-        aggregateRow->m_passThroughTuple = nxtTuple;
-        advanceAggs(aggregateRow);
-    }
-    VOLT_TRACE("finalizing..");
-    // There's one last group (or table) row in progress that needs to be output.
-    insertOutputTuple(aggregateRow);
-    return true;
+    delete m_aggregateRow;
+    m_aggregateRow = NULL;
 }
 
 }
@@ -53,6 +53,10 @@
 #include "common/debuglog.h"
 #include "common/tabletuple.h"
 #include "expressions/abstractexpression.h"
+#include "structures/FlatHashMap.h"
+
+#include <functional>
+#include <utility>
 
 namespace voltdb {
 struct AggregateRow;
@@ -65,7 +69,7 @@ class AggregateExecutorBase : public AbstractExecutor
 public:
     AggregateExecutorBase(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
         AbstractExecutor(engine, abstract_node), m_groupByKeySchema(NULL),
-        m_prePredicate(NULL), m_postPredicate(NULL)
+        m_prePredicate(NULL), m_postPredicate(NULL), m_pipelinedInput(false)
     { }
     ~AggregateExecutorBase()
     {
@@ -74,13 +78,39 @@ public:
         }
     }
 
+    bool supportsPipelinedInput() { return true; }
+    bool supportsPipelinedOutput() { return true; }
+    // every input tuple is aggregated before any group is output
+    bool mayStopPipelineEarly() const { return false; }
+
 protected:
     virtual bool p_init(AbstractPlanNode*, TempTableLimits*);
+    virtual bool p_execute(const NValueArray& params);
+
+    virtual bool p_pipelineStart(const NValueArray& params);
+    virtual bool p_pipelineTuple(TableTuple& tuple);
+    virtual bool p_pipelineFinish();
+
+    /*
+     * The concrete executors aggregate one input tuple at a time, whether
+     * the tuples are read back from the input table or pushed by a
+     * pipelined child.
+     */
+    virtual void startAggregation() = 0;
+    virtual void aggregateTuple(TableTuple& nxtTuple) = 0;
+    virtual void finishAggregation() = 0;
 
     void executeAggBase(const NValueArray& params);
 
     void initGroupByKeyTuple(PoolBackedTupleStorage &groupByKeyTuple, const TableTuple& nxtTuple);
 
+    /*
+     * Remember the input tuple that supplies the pass through columns.
+     * A pipelined child may reuse its tuple storage for the next tuple,
+     * so in that case the tuple is copied into storage from the pool.
+     */
+    void setPassThroughTuple(AggregateRow* aggregateRow, const TableTuple& nxtTuple);
+
     /// Helper method responsible for inserting the results of the
     /// aggregation into a new tuple in the output table as well as passing
     /// through any additional columns from the input table.
@@ -111,8 +141,27 @@ protected:
     std::vector<int> m_aggregateOutputColumns;
     AbstractExpression* m_prePredicate;    // ENG-1565: for enabling max() using index purpose only
     AbstractExpression* m_postPredicate;
+    PoolBackedTupleStorage m_nextGroupByKeyStorage;
+    bool m_pipelinedInput;
 };
 
+typedef FlatHashMap<TableTuple,
+                    AggregateRow*,
+                    TableTupleHasher,
+                    TableTupleEqualityChecker> HashAggregateMapType;
+
+// Group by one or two integer columns, keyed by the BIGINT value of each
+// column (INT64_NULL for NULL) instead of a pool-backed group key tuple.
+typedef FlatHashMap<int64_t,
+                    AggregateRow*,
+                    Int64Hasher,
+                    std::equal_to<int64_t> > IntHashAggregateMapType;
+typedef std::pair<int64_t, int64_t> IntPairGroupByKey;
+typedef FlatHashMap<IntPairGroupByKey,
+                    AggregateRow*,
+                    Int64PairHasher,
+                    std::equal_to<IntPairGroupByKey> > IntPairHashAggregateMapType;
+
 
 /**
  * The concrete executor class for PLAN_NODE_TYPE_HASHAGGREGATE
@@ -122,11 +171,32 @@ class AggregateHashExecutor : public AggregateExecutorBase
 {
 public:
     AggregateHashExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
-        AggregateExecutorBase(engine, abstract_node) { }
-    ~AggregateHashExecutor() { }
+        AggregateExecutorBase(engine, abstract_node), m_intGroupByColumns(0) { }
+    ~AggregateHashExecutor();
+
+    // The most slots a group table keeps for the next execution.
+    static const uint64_t MAX_KEPT_SLOTS = 32768;
+
+protected:
+    virtual bool p_init(AbstractPlanNode*, TempTableLimits*);
 
 private:
-    virtual bool p_execute(const NValueArray& params);
+    virtual void startAggregation();
+    virtual void aggregateTuple(TableTuple& nxtTuple);
+    virtual void finishAggregation();
+
+    AggregateRow* newAggregateRow();
+    void deleteAggregateRows();
+
+    template<typename MapType> void insertOutputTuples(MapType& map);
+    template<typename MapType> void deleteAggregateRows(MapType& map);
+
+    // 1 or 2 when every group by column is an integer and the groups are
+    // kept in m_intHash or m_intPairHash, otherwise 0.
+    int m_intGroupByColumns;
+    HashAggregateMapType m_hash;
+    IntHashAggregateMapType m_intHash;
+    IntPairHashAggregateMapType m_intPairHash;
 };
 
 /**
@@ -138,11 +208,20 @@ class AggregateSerialExecutor : public AggregateExecutorBase
 {
 public:
     AggregateSerialExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node) :
-        AggregateExecutorBase(engine, abstract_node) { }
-    ~AggregateSerialExecutor() { }
+        AggregateExecutorBase(engine, abstract_node), m_aggregateRow(NULL), m_primed(false) { }
+    ~AggregateSerialExecutor();
 
 private:
-    virtual bool p_execute(const NValueArray& params);
+    virtual void startAggregation();
+    virtual void aggregateTuple(TableTuple& nxtTuple);
+    virtual void finishAggregation();
+
+    // Serial aggregates need only one row of Aggs, the "previous" input tuple for pass-through columns,
+    // and the "previous" group key tuple that defines their associated group keys.
+    AggregateRow* m_aggregateRow;
+    TableTuple m_inProgressGroupByKeyTuple;
+    // Whether the first input tuple has started the aggregation.
+    bool m_primed;
 };
 
 }
@@ -51,6 +51,7 @@
 #include "executors/aggregateexecutor.h"
 #include "executors/deleteexecutor.h"
 #include "executors/distinctexecutor.h"
+#include "executors/hashjoinexecutor.h"
 #include "executors/indexscanexecutor.h"
 #include "executors/indexcountexecutor.h"
 #include "executors/tablecountexecutor.h"
@@ -58,6 +59,7 @@
 #include "executors/limitexecutor.h"
 #include "executors/materializeexecutor.h"
 #include "executors/materializedscanexecutor.h"
+#include "executors/mergejoinexecutor.h"
 #include "executors/nestloopexecutor.h"
 #include "executors/nestloopindexexecutor.h"
 #include "executors/orderbyexecutor.h"
@@ -80,6 +82,7 @@ AbstractExecutor* getNewExecutor(VoltDBEngine *engine,
     case PLAN_NODE_TYPE_DELETE: return new DeleteExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_DISTINCT: return new DistinctExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_HASHAGGREGATE: return new AggregateHashExecutor(engine, abstract_node);
+    case PLAN_NODE_TYPE_HASHJOIN: return new HashJoinExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_INDEXSCAN: return new IndexScanExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_INDEXCOUNT: return new IndexCountExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_INSERT: return new InsertExecutor(engine, abstract_node);
@@ -89,6 +92,7 @@ AbstractExecutor* getNewExecutor(VoltDBEngine *engine,
     case PLAN_NODE_TYPE_LIMIT: return new LimitExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_MATERIALIZE: return new MaterializeExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_MATERIALIZEDSCAN: return new MaterializedScanExecutor(engine, abstract_node);
+    case PLAN_NODE_TYPE_MERGEJOIN: return new MergeJoinExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_NESTLOOP: return new NestLoopExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_NESTLOOPINDEX: return new NestLoopIndexExecutor(engine, abstract_node);
     case PLAN_NODE_TYPE_ORDERBY: return new OrderByExecutor(engine, abstract_node);
@@ -0,0 +1,380 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <algorithm>
+#include "hashjoinexecutor.h"
+#include "common/debuglog.h"
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "common/TupleSchema.h"
+#include "expressions/abstractexpression.h"
+#include "storage/table.h"
+#include "storage/temptable.h"
+#include "storage/TempTableLimits.h"
+#include "storage/tableiterator.h"
+#include "plannodes/hashjoinnode.h"
+#include "plannodes/limitnode.h"
+
+using namespace std;
+using namespace voltdb;
+
+HashJoinExecutor::~HashJoinExecutor()
+{
+    if (m_keySchema != NULL) {
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+}
+
+bool HashJoinExecutor::p_init(AbstractPlanNode* abstract_node,
+                              TempTableLimits* limits)
+{
+    VOLT_TRACE("init HashJoin Executor");
+
+    m_node = dynamic_cast<HashJoinPlanNode*>(abstract_node);
+    assert(m_node);
+
+    // Create output table based on output schema from the plan
+    setTempOutputTable(limits);
+    m_limits = limits;
+
+    // NULL tuple for outer join
+    if (m_node->getJoinType() == JOIN_TYPE_LEFT) {
+        Table* inner_table = m_node->getInputTables()[1];
+        assert(inner_table);
+        m_null_tuple.init(inner_table->schema());
+    }
+
+    // Both sides' keys are cast to a common type so that equal values
+    // hash alike, e.g. an INTEGER column joined to a BIGINT column.
+    const vector<AbstractExpression*>& outerExpressions = m_node->getOuterHashExpressions();
+    const vector<AbstractExpression*>& innerExpressions = m_node->getInnerHashExpressions();
+    assert(outerExpressions.size() == innerExpressions.size());
+    std::vector<ValueType> keyColumnTypes;
+    std::vector<int32_t> keyColumnSizes;
+    std::vector<bool> keyColumnAllowNull;
+    for (int ii = 0; ii < outerExpressions.size(); ii++) {
+        ValueType outerType = outerExpressions[ii]->getValueType();
+        ValueType innerType = innerExpressions[ii]->getValueType();
+        if (isIntegralType(outerType) && isIntegralType(innerType)) {
+            keyColumnTypes.push_back(VALUE_TYPE_BIGINT);
+            keyColumnSizes.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        }
+        else if (outerType == innerType) {
+            keyColumnTypes.push_back(outerType);
+            keyColumnSizes.push_back(std::max(outerExpressions[ii]->getValueSize(),
+                                              innerExpressions[ii]->getValueSize()));
+        }
+        else {
+            VOLT_ERROR("Hash join key %d has incompatible types %s and %s", ii,
+                       getTypeName(outerType).c_str(), getTypeName(innerType).c_str());
+            return false;
+        }
+        keyColumnAllowNull.push_back(true);
+    }
+    m_keySchema = TupleSchema::createTupleSchema(keyColumnTypes,
+                                                 keyColumnSizes,
+                                                 keyColumnAllowNull,
+                                                 true);
+    m_buildKeyStorage.init(m_keySchema, &m_memoryPool);
+    m_probeKeyStorage.init(m_keySchema);
+    return true;
+}
+
+/*
+ * Evaluate the join keys of a build or probe tuple into key. Returns
+ * false if any of them is NULL: such a tuple can not satisfy the
+ * equality conditions of the join.
+ */
+bool HashJoinExecutor::initKeyTuple(TableTuple &key, const vector<AbstractExpression*> &expressions,
+                                    const TableTuple *outer, const TableTuple *inner, Pool *pool)
+{
+    for (int ii = 0; ii < expressions.size(); ii++) {
+        NValue value = expressions[ii]->eval(outer, inner);
+        if (value.isNull()) {
+            return false;
+        }
+        key.setNValueAllocateForObjectCopies(ii, value, pool);
+    }
+    return true;
+}
+
+void HashJoinExecutor::buildHashTable(Table *buildTable, bool buildOuter,
+                                      AbstractExpression *preJoinPredicate)
+{
+    const vector<AbstractExpression*>& keyExpressions =
+        buildOuter ? m_node->getOuterHashExpressions() : m_node->getInnerHashExpressions();
+    const int64_t buildCount = buildTable->activeTupleCount();
+    m_buildTuples.reserve(buildCount);
+    m_nextInChain.reserve(buildCount);
+    m_hashTable.reserve(buildCount);
+    chargeHashTable();
+
+    TableTuple build_tuple(buildTable->schema());
+    TableIterator iterator = buildTable->iterator();
+    while (iterator.next(build_tuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        // A LEFT join needs every outer tuple at hand to pad the
+        // unmatched ones, including those that can never match.
+        const int32_t index = static_cast<int32_t>(m_buildTuples.size());
+        if (buildOuter) {
+            m_buildTuples.push_back(build_tuple);
+            m_nextInChain.push_back(-1);
+            if (preJoinPredicate != NULL && !preJoinPredicate->eval(&build_tuple, NULL).isTrue()) {
+                continue;
+            }
+        }
+
+        TableTuple& key = m_buildKeyStorage;
+        if (key.isNullTuple()) {
+            m_buildKeyStorage.allocateActiveTuple();
+        }
+        if (!initKeyTuple(key, keyExpressions,
+                          buildOuter ? &build_tuple : NULL, buildOuter ? NULL : &build_tuple,
+                          &m_memoryPool)) {
+            continue;
+        }
+        if (!buildOuter) {
+            m_buildTuples.push_back(build_tuple);
+            m_nextInChain.push_back(-1);
+        }
+
+        bool inserted;
+        int32_t& head = m_hashTable.findOrInsert(key, index, inserted);
+        if (inserted) {
+            // the hash table owns this key now
+            key.move(NULL);
+            chargeHashTable();
+        }
+        else {
+            m_nextInChain[index] = head;
+            head = index;
+        }
+    }
+    VOLT_TRACE("hash join built %d keys for %d tuples",
+               (int)m_hashTable.size(), (int)m_buildTuples.size());
+}
+
+/*
+ * Apply the offset and add the joined tuple to the output table. Returns
+ * false once the limit has been reached.
+ */
+bool HashJoinExecutor::outputJoinedTuple(TempTable *output_table, const TableTuple &outer_tuple,
+                                         const TableTuple &inner_tuple)
+{
+    if (m_tupleSkipped < m_offset) {
+        m_tupleSkipped++;
+        return true;
+    }
+    ++m_tupleCtr;
+    TableTuple &joined = output_table->tempTuple();
+    const int outer_cols = outer_tuple.sizeInValues();
+    joined.setNValues(0, outer_tuple, 0, outer_cols);
+    joined.setNValues(outer_cols, inner_tuple, 0, inner_tuple.sizeInValues());
+    output_table->insertTupleNonVirtual(joined);
+    return m_limit == -1 || m_tupleCtr < m_limit;
+}
+
+int64_t HashJoinExecutor::hashTableBytes()
+{
+    return static_cast<int64_t>(m_hashTable.allocatedBytes() +
+                                m_buildTuples.capacity() * sizeof(TableTuple) +
+                                m_nextInChain.capacity() * sizeof(int32_t) +
+                                m_buildMatched.capacity() / 8) +
+        m_memoryPool.getAllocatedMemory();
+}
+
+/*
+ * Charge what the hash table and its keys have grown to since the last
+ * call to the temp table limits, which throw once the fragment uses more
+ * memory than it may.
+ */
+void HashJoinExecutor::chargeHashTable()
+{
+    const int64_t bytes = hashTableBytes();
+    if (m_limits == NULL || bytes <= m_chargedBytes) {
+        return;
+    }
+    const int64_t growth = bytes - m_chargedBytes;
+    // the limits count the bytes even when they throw
+    m_chargedBytes = bytes;
+    m_limits->increaseAllocated(static_cast<int>(growth));
+}
+
+void HashJoinExecutor::clearHashTable()
+{
+    // the keys point into the pool, so the hash table goes first
+    m_hashTable.clear();
+    m_buildTuples.clear();
+    m_nextInChain.clear();
+    m_buildMatched.clear();
+    m_buildKeyStorage.init(m_keySchema, &m_memoryPool);
+    m_memoryPool.purge();
+    m_probeKeyPool.purge();
+    if (m_limits != NULL && m_chargedBytes != 0) {
+        m_limits->reduceAllocated(static_cast<int>(m_chargedBytes));
+    }
+    m_chargedBytes = 0;
+}
+
+bool HashJoinExecutor::p_execute(const NValueArray &params) {
+    VOLT_DEBUG("executing HashJoin...");
+
+    assert(m_node == dynamic_cast<HashJoinPlanNode*>(m_abstractNode));
+    assert(m_node->getInputTables().size() == 2);
+
+    // output table must be a temp table
+    TempTable* output_table = dynamic_cast<TempTable*>(m_node->getOutputTable());
+    assert(output_table);
+
+    Table* outer_table = m_node->getInputTables()[0];
+    assert(outer_table);
+
+    Table* inner_table = m_node->getInputTables()[1];
+    assert(inner_table);
+
+    VOLT_TRACE ("input table left:\n %s", outer_table->debug().c_str());
+    VOLT_TRACE ("input table right:\n %s", inner_table->debug().c_str());
+
+    AbstractExpression *preJoinPredicate = m_node->getPreJoinPredicate();
+    if (preJoinPredicate) {
+        preJoinPredicate->substitute(params);
+    }
+    AbstractExpression *joinPredicate = m_node->getJoinPredicate();
+    if (joinPredicate) {
+        joinPredicate->substitute(params);
+    }
+    AbstractExpression *wherePredicate = m_node->getWherePredicate();
+    if (wherePredicate) {
+        wherePredicate->substitute(params);
+    }
+    const vector<AbstractExpression*>& outerExpressions = m_node->getOuterHashExpressions();
+    const vector<AbstractExpression*>& innerExpressions = m_node->getInnerHashExpressions();
+    for (int ii = 0; ii < outerExpressions.size(); ii++) {
+        outerExpressions[ii]->substitute(params);
+        innerExpressions[ii]->substitute(params);
+    }
+
+    // Join type
+    JoinType join_type = m_node->getJoinType();
+    assert(join_type == JOIN_TYPE_INNER || join_type == JOIN_TYPE_LEFT);
+
+    LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(m_node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+    m_limit = -1;
+    m_offset = -1;
+    if (limit_node) {
+        limit_node->getLimitAndOffsetByReference(params, m_limit, m_offset);
+    }
+    m_tupleCtr = 0;
+    m_tupleSkipped = 0;
+    bool more = (m_limit == -1 || m_limit > 0);
+
+    clearHashTable();
+    TableTuple probeKey = m_probeKeyStorage;
+    const bool purgeProbeKeys = m_keySchema->getUninlinedObjectColumnCount() != 0;
+    TableTuple null_tuple = m_null_tuple;
+    m_engine->setLastAccessedTable(inner_table);
+
+    if (outer_table->activeTupleCount() >= inner_table->activeTupleCount()) {
+        //
+        // Build on the inner table, probe with each outer tuple
+        //
+        buildHashTable(inner_table, false, NULL);
+
+        TableTuple outer_tuple(outer_table->schema());
+        TableIterator iterator0 = outer_table->iterator();
+        while (more && iterator0.next(outer_tuple)) {
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            // did the probe find at least one match for this tuple?
+            bool match = false;
+            if (purgeProbeKeys) {
+                m_probeKeyPool.purge();
+            }
+            if ((preJoinPredicate == NULL || preJoinPredicate->eval(&outer_tuple, NULL).isTrue()) &&
+                initKeyTuple(probeKey, outerExpressions, &outer_tuple, NULL, &m_probeKeyPool)) {
+                const int32_t *head = m_hashTable.find(probeKey);
+                for (int32_t ii = head ? *head : -1; more && ii != -1; ii = m_nextInChain[ii]) {
+                    const TableTuple &inner_tuple = m_buildTuples[ii];
+                    if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                        match = true;
+                        if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                            more = outputJoinedTuple(output_table, outer_tuple, inner_tuple);
+                        }
+                    }
+                }
+            }
+            //
+            // Left Outer Join
+            //
+            if (more && join_type == JOIN_TYPE_LEFT && !match) {
+                if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &null_tuple).isTrue()) {
+                    more = outputJoinedTuple(output_table, outer_tuple, null_tuple);
+                }
+            }
+        }
+    }
+    else {
+        //
+        // Build on the (smaller) outer table, probe with each inner tuple
+        //
+        buildHashTable(outer_table, true, preJoinPredicate);
+        if (join_type == JOIN_TYPE_LEFT) {
+            m_buildMatched.assign(m_buildTuples.size(), false);
+            chargeHashTable();
+        }
+
+        TableTuple inner_tuple(inner_table->schema());
+        TableIterator iterator1 = inner_table->iterator();
+        while (more && iterator1.next(inner_tuple)) {
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            if (purgeProbeKeys) {
+                m_probeKeyPool.purge();
+            }
+            if (!initKeyTuple(probeKey, innerExpressions, NULL, &inner_tuple, &m_probeKeyPool)) {
+                continue;
+            }
+            const int32_t *head = m_hashTable.find(probeKey);
+            for (int32_t ii = head ? *head : -1; more && ii != -1; ii = m_nextInChain[ii]) {
+                const TableTuple &outer_tuple = m_buildTuples[ii];
+                if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                    if (join_type == JOIN_TYPE_LEFT) {
+                        m_buildMatched[ii] = true;
+                    }
+                    if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                        more = outputJoinedTuple(output_table, outer_tuple, inner_tuple);
+                    }
+                }
+            }
+        }
+        //
+        // Left Outer Join: pad the outer tuples that never matched
+        //
+        if (join_type == JOIN_TYPE_LEFT) {
+            for (int ii = 0; more && ii < m_buildTuples.size(); ii++) {
+                if (m_buildMatched[ii]) {
+                    continue;
+                }
+                const TableTuple &outer_tuple = m_buildTuples[ii];
+                if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &null_tuple).isTrue()) {
+                    more = outputJoinedTuple(output_table, outer_tuple, null_tuple);
+                }
+            }
+        }
+    }
+
+    clearHashTable();
+    return (true);
+}
@@ -0,0 +1,103 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREHASHJOINEXECUTOR_H
+#define HSTOREHASHJOINEXECUTOR_H
+
+#include <vector>
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "common/Pool.hpp"
+#include "executors/abstractexecutor.h"
+#include "structures/FlatHashMap.h"
+
+namespace voltdb {
+
+class HashJoinPlanNode;
+class TempTable;
+class TempTableLimits;
+
+/**
+ * Equi-join of two input tables. The smaller input is read into a hash
+ * table keyed on its join keys and the larger one probes it, so each
+ * input is scanned once instead of once per outer tuple.
+ *
+ * For a LEFT join built on the outer table, build tuples are flagged as
+ * they match and the unmatched ones are padded with nulls after the
+ * inner table has been scanned.
+ *
+ * The hash table and the build keys count against the fragment's temp
+ * table memory limit while the join runs.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+    public:
+        HashJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) :
+            AbstractExecutor(engine, abstract_node), m_keySchema(NULL),
+            m_limits(NULL), m_chargedBytes(0) { }
+        ~HashJoinExecutor();
+    protected:
+        bool p_init(AbstractPlanNode*,
+                    TempTableLimits* limits);
+        bool p_execute(const NValueArray &params);
+
+    private:
+        // maps a join key to the first build tuple in its chain
+        typedef FlatHashMap<TableTuple, int32_t,
+                            TableTupleHasher, TableTupleEqualityChecker> JoinHashMapType;
+
+        bool initKeyTuple(TableTuple &key, const std::vector<AbstractExpression*> &expressions,
+                          const TableTuple *outer, const TableTuple *inner, Pool *pool);
+        void buildHashTable(Table *buildTable, bool buildOuter,
+                            AbstractExpression *preJoinPredicate);
+        bool outputJoinedTuple(TempTable *output_table, const TableTuple &outer_tuple,
+                               const TableTuple &inner_tuple);
+        int64_t hashTableBytes();
+        void chargeHashTable();
+        void clearHashTable();
+
+        StandAloneTupleStorage m_null_tuple;
+
+        HashJoinPlanNode *m_node;
+        TupleSchema *m_keySchema;
+        // build keys and their out-of-line strings live here until the join is done
+        Pool m_memoryPool;
+        PoolBackedTupleStorage m_buildKeyStorage;
+        // the probe key is rebuilt for every probe tuple
+        Pool m_probeKeyPool;
+        StandAloneTupleStorage m_probeKeyStorage;
+        JoinHashMapType m_hashTable;
+
+        // every build tuple, chained by key through m_nextInChain (-1 ends a chain)
+        std::vector<TableTuple> m_buildTuples;
+        std::vector<int32_t> m_nextInChain;
+        // for a LEFT join built on the outer table, which build tuples found a match
+        std::vector<bool> m_buildMatched;
+
+        TempTableLimits *m_limits;
+        // bytes of the above charged to m_limits
+        int64_t m_chargedBytes;
+
+        int m_limit;
+        int m_offset;
+        int m_tupleCtr;
+        int m_tupleSkipped;
+};
+
+}
+
+#endif
@@ -285,6 +285,7 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
     // An index count has two cases: unique and non-unique
     int64_t rkStart = 0, rkEnd = 0, rkRes = 0;
     int leftIncluded = 0, rightIncluded = 0;
+    IndexCursor indexCursor(m_index->getTupleSchema());
 
     if (m_numOfSearchkeys != 0) {
         // Deal with multi-map
@@ -300,7 +301,7 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
                     rkStart = m_index->getCounterLET(&m_searchKey, false);
 
                     if (reverseScanNullEdgeCase) {
-                        m_index->moveToKeyOrGreater(&m_searchKey);
+                        m_index->moveToKeyOrGreater(&m_searchKey, indexCursor);
                         reverseScanMovedIndexToScan = true;
                     }
                 } else {
@@ -309,9 +310,9 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
             }
         } else {
             // Do not count null row or columns
-            m_index->moveToKeyOrGreater(&m_searchKey);
+            m_index->moveToKeyOrGreater(&m_searchKey, indexCursor);
             assert(countNULLExpr);
-            long numNULLs = countNulls(countNULLExpr);
+            long numNULLs = countNulls(indexCursor, countNULLExpr);
             rkStart += numNULLs;
             VOLT_DEBUG("Index count[underflow case]: find out %ld null rows or columns are not counted in.", numNULLs);
 
@@ -320,10 +321,10 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
     if (reverseScanNullEdgeCase) {
         // reverse scan case
         if (!reverseScanMovedIndexToScan && localLookupType != INDEX_LOOKUP_TYPE_GT) {
-            m_index->moveToEnd(true);
+            m_index->moveToEnd(true, indexCursor);
         }
         assert(countNULLExpr);
-        long numNULLs = countNulls(countNULLExpr);
+        long numNULLs = countNulls(indexCursor, countNULLExpr);
         rkStart += numNULLs;
         VOLT_DEBUG("Index count[reverse case]: find out %ld null rows or columns are not counted in.", numNULLs);
     }
@@ -358,13 +359,13 @@ bool IndexCountExecutor::p_execute(const NValueArray &params)
 }
 
 
-long IndexCountExecutor::countNulls(AbstractExpression * countNULLExpr) {
+long IndexCountExecutor::countNulls(IndexCursor& indexCursor, AbstractExpression * countNULLExpr) {
     if (countNULLExpr == NULL) {
         return 0;
     }
     long numNULLs = 0;
     TableTuple tuple;
-    while ( ! (tuple = m_index->nextValue()).isNullTuple()) {
+    while ( ! (tuple = m_index->nextValue(indexCursor)).isNullTuple()) {
          if ( ! countNULLExpr->eval(&tuple, NULL).isTrue()) {
              break;
          }
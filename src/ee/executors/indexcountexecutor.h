@@ -35,6 +35,7 @@ namespace voltdb {
 class TempTable;
 class PersistentTable;
 class AbstractExpression;
+class IndexCursor;
 class IndexCountPlanNode;
 
 class IndexCountExecutor : public AbstractExecutor
@@ -50,7 +51,7 @@ private:
     bool p_init(AbstractPlanNode*, TempTableLimits* limits);
     bool p_execute(const NValueArray &params);
 
-    long countNulls(AbstractExpression * countNullExpr);
+    long countNulls(IndexCursor& indexCursor, AbstractExpression * countNullExpr);
 
     // Data in this class is arranged roughly in the order it is read for
     // p_execute(). Please don't reshuffle it only in the name of beauty.
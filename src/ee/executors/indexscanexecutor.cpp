@@ -49,7 +49,9 @@
 #include "common/common.h"
 #include "common/tabletuple.h"
 #include "common/FatalException.hpp"
+#include "common/ValueFactory.hpp"
 #include "expressions/abstractexpression.h"
+#include "expressions/comparisonexpression.h"
 #include "expressions/expressionutil.h"
 #include "indexes/tableindex.h"
 
@@ -107,6 +109,12 @@ bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
             m_projectionExpressions[ctr] =
               m_projectionNode->getOutputColumnExpressions()[ctr];
         }
+
+        // Scratch space for projecting a batch of scanned tuples
+        if (m_projectionAllTupleArray == NULL) {
+            m_projectionValues.resize(m_node->getOutputTable()->columnCount() *
+                                      AbstractExpression::BATCH_SIZE);
+        }
     }
 
     //
@@ -178,9 +186,46 @@ bool IndexScanExecutor::p_init(AbstractPlanNode *abstractNode,
     // Index_lookup_type_gte is necessary.
     assert(m_lookupType != INDEX_LOOKUP_TYPE_EQ ||
            m_searchKey.getSchema()->columnCount() == m_numOfSearchkeys);
+
+    // A full scan of the index that is filtered by a LIKE on its first key
+    // column can be narrowed to the keys sharing the pattern's prefix.
+    m_prefixLike = NULL;
+    if (m_numOfSearchkeys == 0 && m_node->getEndExpression() == NULL &&
+        m_sortDirection != SORT_DIRECTION_TYPE_DESC &&
+        m_index->getIndexedExpressions().empty() &&
+        m_index->getKeySchema()->columnType(0) == VALUE_TYPE_VARCHAR) {
+        m_prefixLike = findPrefixLike(m_node->getPredicate());
+    }
     return true;
 }
 
+/*
+ * A top-level conjunct of the predicate of the form "key LIKE pattern",
+ * where key is the index's first key column, or NULL if there is none.
+ */
+const ComparisonExpression<CmpLike> *
+IndexScanExecutor::findPrefixLike(const AbstractExpression *predicate) const
+{
+    if (predicate == NULL) {
+        return NULL;
+    }
+    if (predicate->getExpressionType() == EXPRESSION_TYPE_CONJUNCTION_AND) {
+        const ComparisonExpression<CmpLike> *found = findPrefixLike(predicate->getLeft());
+        return found != NULL ? found : findPrefixLike(predicate->getRight());
+    }
+    if (predicate->getExpressionType() != EXPRESSION_TYPE_COMPARE_LIKE) {
+        return NULL;
+    }
+    const TupleValueExpression *column =
+        dynamic_cast<const TupleValueExpression*>(predicate->getLeft());
+    if (column == NULL || column->getTupleId() != 0 ||
+        column->getColumnId() != m_index->getColumnIndices()[0] ||
+        !predicate->getRight()->isTupleInvariant()) {
+        return NULL;
+    }
+    return dynamic_cast<const ComparisonExpression<CmpLike>*>(predicate);
+}
+
 bool IndexScanExecutor::p_execute(const NValueArray &params)
 {
     assert(m_node);
@@ -309,6 +354,34 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
     assert (m_index);
     assert (m_index == m_targetTable->index(m_node->getTargetIndexName()));
 
+    //
+    // OPTIMIZATION: PREFIX LIKE RANGE
+    //
+    // The keys that start with a LIKE pattern's literal prefix are
+    // contiguous in the index, so the scan can start at the prefix and
+    // stop at the first key that fails the LIKE. A prefix containing NUL
+    // is left alone, as keys compare as C strings.
+    //
+    const ComparisonExpression<CmpLike> *prefixLike = NULL;
+    if (m_prefixLike != NULL && m_prefixLike->comparator().pattern() != NULL) {
+        const LikePattern &pattern = *m_prefixLike->comparator().pattern();
+        if ((pattern.shape() == LikePattern::LIKE_PREFIX ||
+             pattern.shape() == LikePattern::LIKE_EXACT) &&
+            ::memchr(pattern.literal(), '\0', pattern.literalLength()) == NULL) {
+            try {
+                m_searchKey.setNValue(0, ValueFactory::getTempStringValue(pattern.literal(),
+                                                                          pattern.literalLength()));
+                prefixLike = m_prefixLike;
+                activeNumOfSearchKeys = 1;
+                localLookupType = INDEX_LOOKUP_TYPE_GTE;
+            }
+            catch (const SQLException &) {
+                // A prefix too long for the key column; scan it all and
+                // let the predicate find that nothing matches.
+            }
+        }
+    }
+
     // INITIAL EXPRESSION
     AbstractExpression* initial_expression = m_node->getInitialExpression();
     if (initial_expression != NULL) {
@@ -342,38 +415,39 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
     //
 
     TableTuple tuple;
+    IndexCursor indexCursor(m_index->getTupleSchema());
     if (activeNumOfSearchKeys > 0) {
         VOLT_TRACE("INDEX_LOOKUP_TYPE(%d) m_numSearchkeys(%d) key:%s",
                    localLookupType, activeNumOfSearchKeys, m_searchKey.debugNoHeader().c_str());
 
         if (localLookupType == INDEX_LOOKUP_TYPE_EQ) {
-            m_index->moveToKey(&m_searchKey);
+            m_index->moveToKey(&m_searchKey, indexCursor);
         }
         else if (localLookupType == INDEX_LOOKUP_TYPE_GT) {
-            m_index->moveToGreaterThanKey(&m_searchKey);
+            m_index->moveToGreaterThanKey(&m_searchKey, indexCursor);
         }
         else if (localLookupType == INDEX_LOOKUP_TYPE_GTE) {
-            m_index->moveToKeyOrGreater(&m_searchKey);
+            m_index->moveToKeyOrGreater(&m_searchKey, indexCursor);
         } else if (localLookupType == INDEX_LOOKUP_TYPE_LT) {
-            m_index->moveToLessThanKey(&m_searchKey);
+            m_index->moveToLessThanKey(&m_searchKey, indexCursor);
         } else if (localLookupType == INDEX_LOOKUP_TYPE_LTE) {
             // find the entry whose key is greater than search key,
             // do a forward scan using initialExpr to find the correct
             // start point to do reverse scan
-            bool isEnd = m_index->moveToGreaterThanKey(&m_searchKey);
+            bool isEnd = m_index->moveToGreaterThanKey(&m_searchKey, indexCursor);
             if (isEnd) {
-                m_index->moveToEnd(false);
+                m_index->moveToEnd(false, indexCursor);
             } else {
-                while (!(tuple = m_index->nextValue()).isNullTuple()) {
+                while (!(tuple = m_index->nextValue(indexCursor)).isNullTuple()) {
                     m_engine->noteTuplesProcessedForProgressMonitoring(1);
                     if (initial_expression != NULL && !initial_expression->eval(&tuple, NULL).isTrue()) {
                         // just passed the first failed entry, so move 2 backward
-                        m_index->moveToBeforePriorEntry();
+                        m_index->moveToBeforePriorEntry(indexCursor);
                         break;
                     }
                 }
                 if (tuple.isNullTuple()) {
-                    m_index->moveToEnd(false);
+                    m_index->moveToEnd(false, indexCursor);
                 }
             }
         }
@@ -382,25 +456,39 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
         }
     } else {
         bool toStartActually = (localSortDirection != SORT_DIRECTION_TYPE_DESC);
-        m_index->moveToEnd(toStartActually);
+        m_index->moveToEnd(toStartActually, indexCursor);
     }
 
     int tuple_ctr = 0;
     int tuples_skipped = 0;     // for offset
+    bool wantsMore = true;      // false once a pipelined parent is satisfied
     int limit = -1;
     int offset = -1;
     if (limit_node != NULL) {
         limit_node->getLimitAndOffsetByReference(params, limit, offset);
     }
 
+    //
+    // OPTIMIZATION: BATCHED POST EXPRESSION
+    //
+    // Without an inline or pipelined limit, the tuples that pass the end
+    // expression are gathered a batch at a time and the post expression
+    // filters each whole batch at once.
+    //
+    const bool batchPostExpression = (post_expression != NULL && limit_node == NULL &&
+        (m_pipelineConsumer == NULL || !m_pipelineConsumer->mayStopPipelineEarly()));
+    TableTuple batch[AbstractExpression::BATCH_SIZE];
+    int selection[AbstractExpression::BATCH_SIZE];
+    int batchCount = 0;
+
     //
     // We have to different nextValue() methods for different lookup types
     //
-    while ((limit == -1 || tuple_ctr < limit) &&
+    while (wantsMore && (limit == -1 || tuple_ctr < limit) &&
            ((localLookupType == INDEX_LOOKUP_TYPE_EQ &&
-             !(tuple = m_index->nextValueAtKey()).isNullTuple()) ||
+             !(tuple = m_index->nextValueAtKey(indexCursor)).isNullTuple()) ||
            ((localLookupType != INDEX_LOOKUP_TYPE_EQ || activeNumOfSearchKeys == 0) &&
-            !(tuple = m_index->nextValue()).isNullTuple()))) {
+            !(tuple = m_index->nextValue(indexCursor)).isNullTuple()))) {
         VOLT_TRACE("LOOPING in indexscan: tuple: '%s'\n", tuple.debug("tablename").c_str());
 
         m_engine->noteTuplesProcessedForProgressMonitoring(1);
@@ -422,9 +510,23 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
             VOLT_TRACE("End Expression evaluated to false, stopping scan");
             break;
         }
+        if (prefixLike != NULL && !prefixLike->eval(&tuple, NULL).isTrue()) {
+            VOLT_TRACE("Passed the keys with the LIKE prefix, stopping scan");
+            break;
+        }
         //
         // Then apply our post-predicate to do further filtering
         //
+        if (batchPostExpression) {
+            selection[batchCount] = batchCount;
+            batch[batchCount++] = tuple;
+            if (batchCount == AbstractExpression::BATCH_SIZE) {
+                int selected = post_expression->evalPredicateBatch(batch, selection, batchCount);
+                wantsMore = outputScannedBatch(batch, selection, selected);
+                batchCount = 0;
+            }
+            continue;
+        }
         if (post_expression == NULL || post_expression->eval(&tuple, NULL).isTrue()) {
             //
             // INLINE OFFSET
@@ -435,40 +537,74 @@ bool IndexScanExecutor::p_execute(const NValueArray &params)
                 continue;
             }
             tuple_ctr++;
+            wantsMore = outputScannedTuple(tuple);
+        }
+    }
+    if (wantsMore && batchCount > 0) {
+        int selected = post_expression->evalPredicateBatch(batch, selection, batchCount);
+        outputScannedBatch(batch, selection, selected);
+    }
 
-            if (m_projectionNode != NULL)
-            {
-                TableTuple &temp_tuple = m_outputTable->tempTuple();
-                if (m_projectionAllTupleArray != NULL)
-                {
-                    VOLT_TRACE("sweet, all tuples");
-                    for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
-                        temp_tuple.setNValue(ctr, tuple.getNValue(m_projectionAllTupleArray[ctr]));
-                    }
-                }
-                else
-                {
-                    for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
-                        temp_tuple.setNValue(ctr, m_projectionExpressions[ctr]->eval(&tuple, NULL));
-                    }
-                }
-                m_outputTable->insertTupleNonVirtual(temp_tuple);
+    VOLT_DEBUG ("Index Scanned :\n %s", m_outputTable->debug().c_str());
+    return true;
+}
+
+inline bool IndexScanExecutor::outputScannedTuple(TableTuple &tuple)
+{
+    if (m_projectionNode != NULL)
+    {
+        TableTuple &temp_tuple = m_outputTable->tempTuple();
+        if (m_projectionAllTupleArray != NULL)
+        {
+            VOLT_TRACE("sweet, all tuples");
+            for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
+                temp_tuple.setNValue(ctr, tuple.getNValue(m_projectionAllTupleArray[ctr]));
             }
-            else
-                //
-                // Straight Insert
-                //
-            {
-                //
-                // Try to put the tuple into our output table
-                //
-                m_outputTable->insertTupleNonVirtual(tuple);
+        }
+        else
+        {
+            for (int ctr = m_numOfColumns - 1; ctr >= 0; --ctr) {
+                temp_tuple.setNValue(ctr, m_projectionExpressions[ctr]->eval(&tuple, NULL));
             }
         }
+        return outputTuple(temp_tuple);
     }
+    //
+    // Straight Insert
+    //
+    return outputTuple(tuple);
+}
 
-    VOLT_DEBUG ("Index Scanned :\n %s", m_outputTable->debug().c_str());
-    return true;
+bool IndexScanExecutor::outputScannedBatch(TableTuple *batch, const int *selection, int count)
+{
+    bool wantsMore = true;
+    if (m_projectionNode == NULL || m_projectionAllTupleArray != NULL)
+    {
+        for (int ii = 0; wantsMore && ii < count; ii++) {
+            wantsMore = outputScannedTuple(batch[selection[ii]]);
+        }
+        return wantsMore;
+    }
+
+    //
+    // Evaluate the projection a column at a time into the scratch
+    // values, then assemble the output tuples from them
+    //
+    for (int ctr = 0; ctr < m_numOfColumns; ctr++) {
+        m_projectionExpressions[ctr]->evalBatch(batch, selection, count,
+            &m_projectionValues[ctr * AbstractExpression::BATCH_SIZE]);
+    }
+    TableTuple &temp_tuple = m_outputTable->tempTuple();
+    for (int ii = 0; wantsMore && ii < count; ii++)
+    {
+        const int index = selection[ii];
+        for (int ctr = 0; ctr < m_numOfColumns; ctr++) {
+            temp_tuple.setNValue(ctr,
+                m_projectionValues[ctr * AbstractExpression::BATCH_SIZE + index]);
+        }
+        wantsMore = outputTuple(temp_tuple);
+    }
+    return wantsMore;
 }
 
 IndexScanExecutor::~IndexScanExecutor() {
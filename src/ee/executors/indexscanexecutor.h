@@ -51,12 +51,16 @@
 
 #include "boost/shared_array.hpp"
 
+#include <vector>
+
 namespace voltdb {
 
 class TempTable;
 class PersistentTable;
 
 class AbstractExpression;
+class CmpLike;
+template <typename C> class ComparisonExpression;
 
 //
 // Inline PlanNodes
@@ -71,16 +75,22 @@ public:
     IndexScanExecutor(VoltDBEngine* engine, AbstractPlanNode* abstractNode)
         : AbstractExecutor(engine, abstractNode)
         , m_projectionExpressions(NULL)
+        , m_prefixLike(NULL)
         , m_searchKeyBackingStore(NULL)
     {}
     ~IndexScanExecutor();
 
+    bool supportsPipelinedOutput() { return true; }
+
 private:
     bool p_init(AbstractPlanNode*,
                 TempTableLimits* limits);
     bool p_execute(const NValueArray &params);
 
     void skipNulls(AbstractExpression * skipNULLExpr);
+    const ComparisonExpression<CmpLike> *findPrefixLike(const AbstractExpression *predicate) const;
+    bool outputScannedTuple(TableTuple &tuple);
+    bool outputScannedBatch(TableTuple *batch, const int *selection, int count);
 
     // Data in this class is arranged roughly in the order it is read for
     // p_execute(). Please don't reshuffle it only in the name of beauty.
@@ -107,6 +117,13 @@ private:
 
     TableIndex *m_index;
 
+    // A "key LIKE pattern" conjunct of the predicate on an otherwise
+    // unbounded scan, which bounds the scan when the pattern is a prefix
+    const ComparisonExpression<CmpLike> *m_prefixLike;
+
+    // column-major projection results for one batch of tuples
+    std::vector<NValue> m_projectionValues;
+
     // arrange the memory mgmt aids at the bottom to try to maximize
     // cache hits (by keeping them out of the way of useful runtime data)
     boost::shared_array<int> m_projectionAllTupleArrayPtr;
@@ -88,8 +88,7 @@ LimitExecutor::p_execute(const NValueArray &params)
 {
     LimitPlanNode* node = dynamic_cast<LimitPlanNode*>(m_abstractNode);
     assert(node);
-    Table* output_table = node->getOutputTable();
-    assert(output_table);
+    assert(node->getOutputTable());
     Table* input_table = node->getInputTables()[0];
     assert(input_table);
 
@@ -116,15 +115,43 @@ LimitExecutor::p_execute(const NValueArray &params)
         }
         tuple_ctr++;
 
-        if (!output_table->insertTuple(tuple))
+        if (!outputTuple(tuple))
         {
-            VOLT_ERROR("Failed to insert tuple from input table '%s' into"
-                       " output table '%s'",
-                       input_table->name().c_str(),
-                       output_table->name().c_str());
-            return false;
+            break;
         }
     }
 
     return true;
 }
+
+bool
+LimitExecutor::p_pipelineStart(const NValueArray &params)
+{
+    LimitPlanNode* node = dynamic_cast<LimitPlanNode*>(m_abstractNode);
+    assert(node);
+
+    m_tupleCtr = 0;
+    m_tuplesSkipped = 0;
+    m_limit = -1;
+    m_offset = -1;
+    node->getLimitAndOffsetByReference(params, m_limit, m_offset);
+    return true;
+}
+
+bool
+LimitExecutor::p_pipelineTuple(TableTuple &tuple)
+{
+    if (m_limit != -1 && m_tupleCtr >= m_limit)
+    {
+        return false;
+    }
+    if (m_tuplesSkipped < m_offset)
+    {
+        m_tuplesSkipped++;
+        return true;
+    }
+    m_tupleCtr++;
+
+    // Tell the producer to stop as soon as the limit is reached
+    return outputTuple(tuple) && (m_limit == -1 || m_tupleCtr < m_limit);
+}
@@ -57,17 +57,31 @@ namespace voltdb
     {
     public:
         LimitExecutor(VoltDBEngine* engine, AbstractPlanNode* abstract_node)
-            : AbstractExecutor(engine, abstract_node)
+            : AbstractExecutor(engine, abstract_node),
+              m_limit(-1), m_offset(-1), m_tupleCtr(0), m_tuplesSkipped(0)
         {
         }
 
         ~LimitExecutor() {
         }
 
+        bool supportsPipelinedInput() { return true; }
+        bool supportsPipelinedOutput() { return true; }
+        bool mayStopPipelineEarly() const { return true; }
+
     private:
         bool p_init(AbstractPlanNode*,
                     TempTableLimits* limits);
         bool p_execute(const NValueArray &params);
+
+        bool p_pipelineStart(const NValueArray &params);
+        bool p_pipelineTuple(TableTuple &tuple);
+
+        // limit/offset state of a pipelined execution
+        int m_limit;
+        int m_offset;
+        int m_tupleCtr;
+        int m_tuplesSkipped;
     };
 
 }
@@ -0,0 +1,258 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "mergejoinexecutor.h"
+#include "common/debuglog.h"
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "expressions/abstractexpression.h"
+#include "storage/table.h"
+#include "storage/temptable.h"
+#include "storage/tableiterator.h"
+#include "plannodes/mergejoinnode.h"
+#include "plannodes/limitnode.h"
+
+using namespace std;
+using namespace voltdb;
+
+bool MergeJoinExecutor::p_init(AbstractPlanNode* abstract_node,
+                               TempTableLimits* limits)
+{
+    VOLT_TRACE("init MergeJoin Executor");
+
+    m_node = dynamic_cast<MergeJoinPlanNode*>(abstract_node);
+    assert(m_node);
+
+    // Create output table based on output schema from the plan
+    setTempOutputTable(limits);
+
+    // NULL tuple for outer join
+    if (m_node->getJoinType() == JOIN_TYPE_LEFT) {
+        Table* inner_table = m_node->getInputTables()[1];
+        assert(inner_table);
+        m_null_tuple.init(inner_table->schema());
+    }
+
+    assert(m_node->getOuterMergeExpressions().size() == m_node->getInnerMergeExpressions().size());
+    m_outerKeys.resize(m_node->getOuterMergeExpressions().size());
+    return true;
+}
+
+/*
+ * Evaluate the merge keys of an outer tuple. Returns false if any of them
+ * is NULL: such a tuple can not satisfy the equality conditions of the join.
+ */
+bool MergeJoinExecutor::initOuterKeys(const TableTuple &outer_tuple)
+{
+    const vector<AbstractExpression*>& outerExpressions = m_node->getOuterMergeExpressions();
+    for (int ii = 0; ii < outerExpressions.size(); ii++) {
+        m_outerKeys[ii] = outerExpressions[ii]->eval(&outer_tuple, NULL);
+        if (m_outerKeys[ii].isNull()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Compare the current outer keys with the keys of an inner tuple, in the
+ * order the inputs are sorted in. NULLs sort first, so an inner tuple with
+ * a NULL key sorts before any outer key and never matches one.
+ */
+int MergeJoinExecutor::compareToInnerKeys(const TableTuple &inner_tuple) const
+{
+    const vector<AbstractExpression*>& innerExpressions = m_node->getInnerMergeExpressions();
+    for (int ii = 0; ii < innerExpressions.size(); ii++) {
+        NValue innerKey = innerExpressions[ii]->eval(NULL, &inner_tuple);
+        if (innerKey.isNull()) {
+            return VALUE_COMPARE_GREATERTHAN;
+        }
+        int diff = m_outerKeys[ii].compare(innerKey);
+        if (diff != VALUE_COMPARE_EQUAL) {
+            return diff;
+        }
+    }
+    return VALUE_COMPARE_EQUAL;
+}
+
+#ifndef NDEBUG
+/*
+ * Check that a table's tuples come in ascending order of their merge keys,
+ * with NULLs first, as an ascending index scan returns them.
+ */
+bool MergeJoinExecutor::isSortedOn(Table *table, const vector<AbstractExpression*> &expressions,
+                                   bool inner) const
+{
+    TableTuple tuple(table->schema());
+    TableIterator iterator = table->iterator();
+    vector<NValue> keys(expressions.size());
+    vector<NValue> previous(expressions.size());
+    bool first = true;
+    while (iterator.next(tuple)) {
+        int diff = VALUE_COMPARE_EQUAL;
+        for (int ii = 0; ii < expressions.size(); ii++) {
+            keys[ii] = inner ? expressions[ii]->eval(NULL, &tuple) : expressions[ii]->eval(&tuple, NULL);
+            if (first || diff != VALUE_COMPARE_EQUAL) {
+                continue;
+            }
+            if (keys[ii].isNull() || previous[ii].isNull()) {
+                if ( ! previous[ii].isNull()) {
+                    diff = VALUE_COMPARE_LESSTHAN;
+                } else if ( ! keys[ii].isNull()) {
+                    diff = VALUE_COMPARE_GREATERTHAN;
+                }
+            } else {
+                diff = keys[ii].compare(previous[ii]);
+            }
+        }
+        if (diff == VALUE_COMPARE_LESSTHAN) {
+            return false;
+        }
+        keys.swap(previous);
+        first = false;
+    }
+    return true;
+}
+#endif
+
+/*
+ * Apply the offset and add the joined tuple to the output table. Returns
+ * false once the limit has been reached.
+ */
+bool MergeJoinExecutor::outputJoinedTuple(TempTable *output_table, const TableTuple &outer_tuple,
+                                          const TableTuple &inner_tuple)
+{
+    if (m_tupleSkipped < m_offset) {
+        m_tupleSkipped++;
+        return true;
+    }
+    ++m_tupleCtr;
+    TableTuple &joined = output_table->tempTuple();
+    const int outer_cols = outer_tuple.sizeInValues();
+    joined.setNValues(0, outer_tuple, 0, outer_cols);
+    joined.setNValues(outer_cols, inner_tuple, 0, inner_tuple.sizeInValues());
+    output_table->insertTupleNonVirtual(joined);
+    return m_limit == -1 || m_tupleCtr < m_limit;
+}
+
+bool MergeJoinExecutor::p_execute(const NValueArray &params) {
+    VOLT_DEBUG("executing MergeJoin...");
+
+    assert(m_node == dynamic_cast<MergeJoinPlanNode*>(m_abstractNode));
+    assert(m_node->getInputTables().size() == 2);
+
+    // output table must be a temp table
+    TempTable* output_table = dynamic_cast<TempTable*>(m_node->getOutputTable());
+    assert(output_table);
+
+    Table* outer_table = m_node->getInputTables()[0];
+    assert(outer_table);
+
+    Table* inner_table = m_node->getInputTables()[1];
+    assert(inner_table);
+
+    VOLT_TRACE ("input table left:\n %s", outer_table->debug().c_str());
+    VOLT_TRACE ("input table right:\n %s", inner_table->debug().c_str());
+
+    AbstractExpression *preJoinPredicate = m_node->getPreJoinPredicate();
+    if (preJoinPredicate) {
+        preJoinPredicate->substitute(params);
+    }
+    AbstractExpression *joinPredicate = m_node->getJoinPredicate();
+    if (joinPredicate) {
+        joinPredicate->substitute(params);
+    }
+    AbstractExpression *wherePredicate = m_node->getWherePredicate();
+    if (wherePredicate) {
+        wherePredicate->substitute(params);
+    }
+    const vector<AbstractExpression*>& outerExpressions = m_node->getOuterMergeExpressions();
+    const vector<AbstractExpression*>& innerExpressions = m_node->getInnerMergeExpressions();
+    for (int ii = 0; ii < outerExpressions.size(); ii++) {
+        outerExpressions[ii]->substitute(params);
+        innerExpressions[ii]->substitute(params);
+    }
+
+    // Join type
+    JoinType join_type = m_node->getJoinType();
+    assert(join_type == JOIN_TYPE_INNER || join_type == JOIN_TYPE_LEFT);
+
+    LimitPlanNode* limit_node = dynamic_cast<LimitPlanNode*>(m_node->getInlinePlanNode(PLAN_NODE_TYPE_LIMIT));
+    m_limit = -1;
+    m_offset = -1;
+    if (limit_node) {
+        limit_node->getLimitAndOffsetByReference(params, m_limit, m_offset);
+    }
+    m_tupleCtr = 0;
+    m_tupleSkipped = 0;
+    bool more = (m_limit == -1 || m_limit > 0);
+
+    TableTuple outer_tuple(outer_table->schema());
+    TableTuple inner_tuple(inner_table->schema());
+    TableTuple null_tuple = m_null_tuple;
+
+    // The planner only merges index scans that return their tuples in key
+    // order. Checking that takes a pass over each input, so only debug
+    // builds do it.
+    assert(isSortedOn(outer_table, outerExpressions, false));
+    assert(isSortedOn(inner_table, innerExpressions, true));
+
+    TableIterator iterator0 = outer_table->iterator();
+    TableIterator iterator1 = inner_table->iterator();
+    bool inner_valid = iterator1.next(inner_tuple);
+    m_engine->setLastAccessedTable(inner_table);
+    while (more && iterator0.next(outer_tuple)) {
+        m_engine->noteTuplesProcessedForProgressMonitoring(1);
+        // did the run of inner tuples hold at least one match for this tuple?
+        bool match = false;
+        if ((preJoinPredicate == NULL || preJoinPredicate->eval(&outer_tuple, NULL).isTrue()) &&
+            initOuterKeys(outer_tuple)) {
+            // Inner tuples that sort before this key can not match it or any
+            // later outer tuple.
+            while (inner_valid && compareToInnerKeys(inner_tuple) == VALUE_COMPARE_GREATERTHAN) {
+                m_engine->noteTuplesProcessedForProgressMonitoring(1);
+                inner_valid = iterator1.next(inner_tuple);
+            }
+
+            // Join with the run of inner tuples that have this key, reading
+            // it through a copy of the iterator so that the next outer tuple
+            // can read it again.
+            TableIterator run_iterator = iterator1;
+            TableTuple run_tuple = inner_tuple;
+            bool run_valid = inner_valid;
+            while (more && run_valid && compareToInnerKeys(run_tuple) == VALUE_COMPARE_EQUAL) {
+                if (joinPredicate == NULL || joinPredicate->eval(&outer_tuple, &run_tuple).isTrue()) {
+                    match = true;
+                    if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &run_tuple).isTrue()) {
+                        more = outputJoinedTuple(output_table, outer_tuple, run_tuple);
+                    }
+                }
+                run_valid = run_iterator.next(run_tuple);
+            }
+        }
+        //
+        // Left Outer Join
+        //
+        if (more && join_type == JOIN_TYPE_LEFT && !match) {
+            if (wherePredicate == NULL || wherePredicate->eval(&outer_tuple, &null_tuple).isTrue()) {
+                more = outputJoinedTuple(output_table, outer_tuple, null_tuple);
+            }
+        }
+    }
+
+    return (true);
+}
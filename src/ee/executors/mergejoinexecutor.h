@@ -0,0 +1,76 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREMERGEJOINEXECUTOR_H
+#define HSTOREMERGEJOINEXECUTOR_H
+
+#include <vector>
+#include "common/common.h"
+#include "common/tabletuple.h"
+#include "common/valuevector.h"
+#include "executors/abstractexecutor.h"
+
+namespace voltdb {
+
+class AbstractExpression;
+class MergeJoinPlanNode;
+class Table;
+class TempTable;
+
+/**
+ * Equi-join of two input tables that are sorted, ascending, on their
+ * join keys. Both inputs are read once, in step: each outer tuple is
+ * joined with the run of inner tuples that has its key, and the run is
+ * only read again if the next outer tuple has the same key. Apart from
+ * the outer tuple's key values no state is kept, and the output is in
+ * the order of the outer table. The inputs' order is the planner's to
+ * guarantee; debug builds check it.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+    public:
+        MergeJoinExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) :
+            AbstractExecutor(engine, abstract_node) { }
+    protected:
+        bool p_init(AbstractPlanNode*,
+                    TempTableLimits* limits);
+        bool p_execute(const NValueArray &params);
+
+    private:
+        bool initOuterKeys(const TableTuple &outer_tuple);
+        int compareToInnerKeys(const TableTuple &inner_tuple) const;
+#ifndef NDEBUG
+        bool isSortedOn(Table *table, const std::vector<AbstractExpression*> &expressions,
+                        bool inner) const;
+#endif
+        bool outputJoinedTuple(TempTable *output_table, const TableTuple &outer_tuple,
+                               const TableTuple &inner_tuple);
+
+        StandAloneTupleStorage m_null_tuple;
+
+        MergeJoinPlanNode *m_node;
+        // key values of the current outer tuple
+        std::vector<NValue> m_outerKeys;
+
+        int m_limit;
+        int m_offset;
+        int m_tupleCtr;
+        int m_tupleSkipped;
+};
+
+}
+
+#endif
@@ -43,6 +43,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <stack>
@@ -65,6 +66,35 @@
 using namespace std;
 using namespace voltdb;
 
+// outer tuples probed per batch
+static const int PROBE_BATCH_SIZE = 1024;
+// how many probes ahead of itself a probe prefetches
+static const int PROBE_PREFETCH_DISTANCE = 8;
+
+namespace {
+
+/**
+ * Orders the positions of a batch's search keys by the keys.
+ */
+class ProbeKeyLess {
+public:
+    ProbeKeyLess(char *keys, const TupleSchema *keySchema, size_t keyLength)
+        : m_keys(keys), m_keySchema(keySchema), m_keyLength(keyLength) {}
+
+    bool operator()(int lhs, int rhs) const {
+        const TableTuple lhsKey(m_keys + lhs * m_keyLength, m_keySchema);
+        const TableTuple rhsKey(m_keys + rhs * m_keyLength, m_keySchema);
+        return lhsKey.compare(rhsKey) < 0;
+    }
+
+private:
+    char *m_keys;
+    const TupleSchema *m_keySchema;
+    size_t m_keyLength;
+};
+
+}
+
 bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstractNode,
                                    TempTableLimits* limits)
 {
@@ -154,6 +184,8 @@ bool NestLoopIndexExecutor::p_init(AbstractPlanNode* abstractNode,
     index_values.move( index_values_backing_store - TUPLE_HEADER_SIZE);
     index_values.setAllNulls();
 
+    m_batchKeyStorage.resize(PROBE_BATCH_SIZE * index_values.tupleLength());
+
     return true;
 }
 
@@ -244,6 +276,13 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
     if (limit_node) {
         limit_node->getLimitAndOffsetByReference(params, limit, offset);
     }
+    else if (m_lookupType == INDEX_LOOKUP_TYPE_EQ && num_of_searchkeys > 0) {
+        executeBatchedProbes(num_of_searchkeys, prejoin_expression, skipNullExpr,
+                             end_expression, post_expression, where_expression);
+        VOLT_TRACE ("result table:\n %s", output_table->debug().c_str());
+        VOLT_TRACE("Finished NestLoopIndex");
+        return (true);
+    }
 
 
     //
@@ -251,6 +290,7 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
     //
     TableTuple outer_tuple(outer_table->schema());
     TableTuple inner_tuple(inner_table->schema());
+    IndexCursor indexCursor(index->getTupleSchema());
     TableIterator outer_iterator = outer_table->iterator();
     int num_of_outer_cols = outer_table->columnCount();
     assert (outer_tuple.sizeInValues() == outer_table->columnCount());
@@ -385,34 +425,34 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                 if (num_of_searchkeys > 0)
                 {
                     if (localLookupType == INDEX_LOOKUP_TYPE_EQ) {
-                        index->moveToKey(&index_values);
+                        index->moveToKey(&index_values, indexCursor);
                     }
                     else if (localLookupType == INDEX_LOOKUP_TYPE_GT) {
-                        index->moveToGreaterThanKey(&index_values);
+                        index->moveToGreaterThanKey(&index_values, indexCursor);
                     }
                     else if (localLookupType == INDEX_LOOKUP_TYPE_GTE) {
-                        index->moveToKeyOrGreater(&index_values);
+                        index->moveToKeyOrGreater(&index_values, indexCursor);
                     }
                     else if (localLookupType == INDEX_LOOKUP_TYPE_LT) {
-                        index->moveToLessThanKey(&index_values);
+                        index->moveToLessThanKey(&index_values, indexCursor);
                     } else if (localLookupType == INDEX_LOOKUP_TYPE_LTE) {
                         // find the entry whose key is greater than search key,
                         // do a forward scan using initialExpr to find the correct
                         // start point to do reverse scan
-                        bool isEnd = index->moveToGreaterThanKey(&index_values);
+                        bool isEnd = index->moveToGreaterThanKey(&index_values, indexCursor);
                         if (isEnd) {
-                            index->moveToEnd(false);
+                            index->moveToEnd(false, indexCursor);
                         } else {
-                            while (!(inner_tuple = index->nextValue()).isNullTuple()) {
+                            while (!(inner_tuple = index->nextValue(indexCursor)).isNullTuple()) {
                                 m_engine->noteTuplesProcessedForProgressMonitoring(1);
                                 if (initial_expression != NULL && !initial_expression->eval(&outer_tuple, &inner_tuple).isTrue()) {
                                     // just passed the first failed entry, so move 2 backward
-                                    index->moveToBeforePriorEntry();
+                                    index->moveToBeforePriorEntry(indexCursor);
                                     break;
                                 }
                             }
                             if (inner_tuple.isNullTuple()) {
-                                index->moveToEnd(false);
+                                index->moveToEnd(false, indexCursor);
                             }
                         }
                     }
@@ -421,16 +461,16 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
                     }
                 } else {
                     bool toStartActually = (localSortDirection != SORT_DIRECTION_TYPE_DESC);
-                    index->moveToEnd(toStartActually);
+                    index->moveToEnd(toStartActually, indexCursor);
                 }
 
                 AbstractExpression* skipNullExprIteration = skipNullExpr;
 
                 while ((limit == -1 || tuple_ctr < limit) &&
                        ((localLookupType == INDEX_LOOKUP_TYPE_EQ &&
-                        !(inner_tuple = index->nextValueAtKey()).isNullTuple()) ||
+                        !(inner_tuple = index->nextValueAtKey(indexCursor)).isNullTuple()) ||
                        ((localLookupType != INDEX_LOOKUP_TYPE_EQ || num_of_searchkeys == 0) &&
-                        !(inner_tuple = index->nextValue()).isNullTuple())))
+                        !(inner_tuple = index->nextValue(indexCursor)).isNullTuple())))
                 {
                     VOLT_TRACE("inner_tuple:%s",
                                inner_tuple.debug(inner_table->name()).c_str());
@@ -519,6 +559,178 @@ bool NestLoopIndexExecutor::p_execute(const NValueArray &params)
     return (true);
 }
 
+void NestLoopIndexExecutor::executeBatchedProbes(int num_of_searchkeys,
+                                                 AbstractExpression* prejoin_expression,
+                                                 AbstractExpression* skipNullExpr,
+                                                 AbstractExpression* end_expression,
+                                                 AbstractExpression* post_expression,
+                                                 AbstractExpression* where_expression)
+{
+    TableTuple outer_tuple(outer_table->schema());
+    TableTuple inner_tuple(inner_table->schema());
+    IndexCursor indexCursor(index->getTupleSchema());
+    TableIterator outer_iterator = outer_table->iterator();
+    int num_of_outer_cols = outer_table->columnCount();
+    TableTuple &join_tuple = output_table->tempTuple();
+    TableTuple null_tuple = m_null_tuple;
+    int num_of_inner_cols = (join_type == JOIN_TYPE_LEFT)? null_tuple.sizeInValues() : 0;
+
+    const TupleSchema *keySchema = index->getKeySchema();
+    const size_t keyLength = index_values.tupleLength();
+    char *keys = &m_batchKeyStorage[0];
+    const bool sortProbes = index->prefersOrderedProbes();
+
+    m_engine->setLastAccessedTable(inner_table);
+    bool moreOuterTuples = true;
+    while (moreOuterTuples) {
+        //
+        // Build the search keys of a batch of outer tuples. Those failing
+        // the pre-join predicate, or whose key is out of range of the
+        // index key, match nothing and are not probed.
+        //
+        m_batchOuterTuples.clear();
+        m_batchProbeOrder.clear();
+        while (m_batchOuterTuples.size() < PROBE_BATCH_SIZE) {
+            if ( ! outer_iterator.next(outer_tuple)) {
+                moreOuterTuples = false;
+                break;
+            }
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            const int position = static_cast<int>(m_batchOuterTuples.size());
+            m_batchOuterTuples.push_back(outer_tuple.address());
+            if (prejoin_expression != NULL && !prejoin_expression->eval(&outer_tuple, NULL).isTrue()) {
+                continue;
+            }
+
+            TableTuple searchKey(keys + position * keyLength, keySchema);
+            searchKey.setAllNulls();
+            bool keyException = false;
+            for (int ctr = 0; ctr < num_of_searchkeys; ctr++) {
+                NValue candidateValue = inline_node->getSearchKeyExpressions()[ctr]->eval(&outer_tuple, NULL);
+                try {
+                    searchKey.setNValue(ctr, candidateValue);
+                }
+                catch (const SQLException &e) {
+                    // an equality key that overflows or underflows the
+                    // index key matches nothing (except left-outer)
+                    if ((e.getInternalFlags() & (SQLException::TYPE_OVERFLOW | SQLException::TYPE_UNDERFLOW)) == 0) {
+                        throw e;
+                    }
+                    keyException = true;
+                    break;
+                }
+            }
+            if ( ! keyException) {
+                m_batchProbeOrder.push_back(position);
+            }
+        }
+
+        const int batchSize = static_cast<int>(m_batchOuterTuples.size());
+        if (batchSize == 0) {
+            break;
+        }
+        if (sortProbes) {
+            std::sort(m_batchProbeOrder.begin(), m_batchProbeOrder.end(),
+                      ProbeKeyLess(keys, keySchema, keyLength));
+        }
+
+        //
+        // Probe the index and remember every inner tuple found per outer
+        // tuple. The post and where predicates are applied afterwards, in
+        // outer order, exactly as the unbatched loop applies them.
+        //
+        m_batchMatches.clear();
+        m_batchMatchBegin.assign(batchSize, 0);
+        m_batchMatchEnd.assign(batchSize, 0);
+        const int probeCount = static_cast<int>(m_batchProbeOrder.size());
+        for (int ii = 0; ii < probeCount && ii < PROBE_PREFETCH_DISTANCE; ii++) {
+            TableTuple searchKey(keys + m_batchProbeOrder[ii] * keyLength, keySchema);
+            index->prefetchKey(&searchKey);
+        }
+        for (int ii = 0; ii < probeCount; ii++) {
+            if (ii + PROBE_PREFETCH_DISTANCE < probeCount) {
+                TableTuple aheadKey(keys + m_batchProbeOrder[ii + PROBE_PREFETCH_DISTANCE] * keyLength,
+                                    keySchema);
+                index->prefetchKey(&aheadKey);
+            }
+            const int position = m_batchProbeOrder[ii];
+            TableTuple searchKey(keys + position * keyLength, keySchema);
+            VOLT_TRACE("Searching %s", searchKey.debug("").c_str());
+            m_batchMatchBegin[position] = m_batchMatches.size();
+            index->moveToKey(&searchKey, indexCursor);
+            while ( ! (inner_tuple = index->nextValueAtKey(indexCursor)).isNullTuple()) {
+                m_engine->noteTuplesProcessedForProgressMonitoring(1);
+                m_batchMatches.push_back(inner_tuple.address());
+            }
+            m_batchMatchEnd[position] = m_batchMatches.size();
+        }
+
+        //
+        // Join each outer tuple with its matches
+        //
+        for (int position = 0; position < batchSize; position++) {
+            outer_tuple.move(m_batchOuterTuples[position]);
+            VOLT_TRACE("outer_tuple:%s",
+                       outer_tuple.debug(outer_table->name()).c_str());
+            join_tuple.setNValues(0, outer_tuple, 0, num_of_outer_cols);
+
+            bool match = false;
+            AbstractExpression* skipNullExprIteration = skipNullExpr;
+            for (size_t jj = m_batchMatchBegin[position]; jj < m_batchMatchEnd[position]; jj++) {
+                inner_tuple.move(m_batchMatches[jj]);
+                VOLT_TRACE("inner_tuple:%s",
+                           inner_tuple.debug(inner_table->name()).c_str());
+
+                if (skipNullExprIteration != NULL) {
+                    if (skipNullExprIteration->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                        VOLT_DEBUG("Index scan: find out null rows or columns.");
+                        continue;
+                    } else {
+                        skipNullExprIteration = NULL;
+                    }
+                }
+
+                if (end_expression != NULL &&
+                    !end_expression->eval(&outer_tuple, &inner_tuple).isTrue())
+                {
+                    VOLT_TRACE("End Expression evaluated to false, stopping scan\n");
+                    break;
+                }
+
+                if (post_expression == NULL ||
+                    post_expression->eval(&outer_tuple, &inner_tuple).isTrue())
+                {
+                    match = true;
+                    if (where_expression == NULL || where_expression->eval(&outer_tuple, &inner_tuple).isTrue()) {
+                        for (int col_ctr = num_of_outer_cols;
+                             col_ctr < join_tuple.sizeInValues();
+                             ++col_ctr)
+                        {
+                            join_tuple.
+                            setNValue(col_ctr,
+                                      m_outputExpressions[col_ctr]->
+                                      eval(&outer_tuple, &inner_tuple));
+                        }
+                        VOLT_TRACE("MATCH: %s",
+                                   join_tuple.debug(output_table->name()).c_str());
+                        output_table->insertTupleNonVirtual(join_tuple);
+                    }
+                }
+            }
+
+            //
+            // Left Outer Join
+            //
+            if (join_type == JOIN_TYPE_LEFT && !match) {
+                if (where_expression == NULL || where_expression->eval(&outer_tuple, &null_tuple).isTrue()) {
+                    join_tuple.setNValues(num_of_outer_cols, m_null_tuple, 0, num_of_inner_cols);
+                    output_table->insertTupleNonVirtual(join_tuple);
+                }
+            }
+        }
+    }
+}
+
 NestLoopIndexExecutor::~NestLoopIndexExecutor() {
     delete [] index_values_backing_store;
 }
@@ -93,6 +93,20 @@ protected:
                 TempTableLimits* limits);
     bool p_execute(const NValueArray &params);
 
+    /**
+     * Equality lookups without a LIMIT are probed a batch of outer tuples
+     * at a time: the batch's search keys are built first, then probed in
+     * key order if the index prefers it, with each probe prefetching the
+     * key a few probes ahead. The joined rows are still emitted in outer
+     * order.
+     */
+    void executeBatchedProbes(int num_of_searchkeys,
+                              AbstractExpression* prejoin_expression,
+                              AbstractExpression* skipNullExpr,
+                              AbstractExpression* end_expression,
+                              AbstractExpression* post_expression,
+                              AbstractExpression* where_expression);
+
     NestLoopIndexPlanNode* node;
     IndexScanPlanNode* inline_node;
     IndexLookupType m_lookupType;
@@ -108,6 +122,16 @@ protected:
 
     //So valgrind doesn't report the data as lost.
     char *index_values_backing_store;
+
+    // outer tuples and search keys of one batch of probes
+    std::vector<void*> m_batchOuterTuples;
+    std::vector<char> m_batchKeyStorage;
+    std::vector<int> m_batchProbeOrder;
+    // the inner tuples matching each outer tuple of the batch are
+    // m_batchMatches[m_batchMatchBegin[i]] to m_batchMatches[m_batchMatchEnd[i]]
+    std::vector<void*> m_batchMatches;
+    std::vector<size_t> m_batchMatchBegin;
+    std::vector<size_t> m_batchMatchEnd;
 };
 
 }
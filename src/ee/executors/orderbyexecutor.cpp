@@ -90,49 +90,56 @@ OrderByExecutor::p_init(AbstractPlanNode* abstract_node,
     return true;
 }
 
-class TupleComparer
+/*
+ * A tuple waiting to be sorted, with the position of its sort key values
+ * in a side array. The keys are evaluated once per tuple, not on both
+ * sides of every comparison.
+ */
+struct SortEntry
+{
+    TableTuple tuple;
+    size_t keyOffset;
+};
+
+class SortEntryComparer
 {
 public:
-    TupleComparer(const vector<AbstractExpression*>& keys,
-                  const vector<SortDirectionType>& dirs)
-        : m_keys(keys), m_dirs(dirs), m_keyCount(keys.size())
+    SortEntryComparer(const vector<NValue>& keyValues,
+                      const vector<SortDirectionType>& dirs)
+        : m_keyValues(keyValues), m_dirs(dirs), m_keyCount(dirs.size())
     {
-        assert(keys.size() == dirs.size());
     }
 
-    bool operator()(TableTuple ta, TableTuple tb)
+    bool operator()(const SortEntry& ea, const SortEntry& eb) const
     {
+        const NValue* ka = &m_keyValues[ea.keyOffset];
+        const NValue* kb = &m_keyValues[eb.keyOffset];
         for (size_t i = 0; i < m_keyCount; ++i)
         {
-            AbstractExpression* k = m_keys[i];
-            SortDirectionType dir = m_dirs[i];
-            int cmp = k->eval(&ta, NULL).compare(k->eval(&tb, NULL));
-            if (dir == SORT_DIRECTION_TYPE_ASC)
-            {
-                if (cmp < 0) return true;
-                if (cmp > 0) return false;
-            }
-            else if (dir == SORT_DIRECTION_TYPE_DESC)
-            {
-                if (cmp < 0) return false;
-                if (cmp > 0) return true;
-            }
-            else
+            int cmp = ka[i].compare(kb[i]);
+            if (cmp != 0)
             {
-                throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
-                                              "Attempted to sort using"
-                                              " SORT_DIRECTION_TYPE_INVALID");
+                return (m_dirs[i] == SORT_DIRECTION_TYPE_ASC) ? (cmp < 0) : (cmp > 0);
             }
         }
         return false; // ta == tb on these keys
     }
 
 private:
-    const vector<AbstractExpression*>& m_keys;
+    const vector<NValue>& m_keyValues;
     const vector<SortDirectionType>& m_dirs;
     size_t m_keyCount;
 };
 
+static inline void evaluateSortKeys(const vector<AbstractExpression*>& keys,
+                                    TableTuple& tuple, NValue* out)
+{
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        out[i] = keys[i]->eval(&tuple, NULL);
+    }
+}
+
 bool
 OrderByExecutor::p_execute(const NValueArray &params)
 {
@@ -155,29 +162,90 @@ OrderByExecutor::p_execute(const NValueArray &params)
     }
 
     // substitute parameters in the order by expressions
-    for (int i = 0; i < node->getSortExpressions().size(); i++) {
-        node->getSortExpressions()[i]->substitute(params);
+    const vector<AbstractExpression*>& keys = node->getSortExpressions();
+    const vector<SortDirectionType>& dirs = node->getSortDirections();
+    assert(keys.size() == dirs.size());
+    for (int i = 0; i < keys.size(); i++) {
+        keys[i]->substitute(params);
+        if (dirs[i] != SORT_DIRECTION_TYPE_ASC && dirs[i] != SORT_DIRECTION_TYPE_DESC) {
+            throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                          "Attempted to sort using"
+                                          " SORT_DIRECTION_TYPE_INVALID");
+        }
     }
+    const size_t keyCount = keys.size();
 
     VOLT_TRACE("Running OrderBy '%s'", m_abstractNode->debug().c_str());
     VOLT_TRACE("Input Table:\n '%s'", input_table->debug().c_str());
     TableIterator iterator = input_table->iterator();
     TableTuple tuple(input_table->schema());
-    vector<TableTuple> xs;
-    while (iterator.next(tuple))
+    vector<SortEntry> xs;
+    vector<NValue> keyValues;
+    SortEntryComparer comparer(keyValues, dirs);
+    const int64_t heapLimit = (limit < 0) ? -1 :
+        static_cast<int64_t>(limit) + (offset > 0 ? offset : 0);
+    if (heapLimit >= 0 && heapLimit < input_table->activeTupleCount())
     {
-        m_engine->noteTuplesProcessedForProgressMonitoring(1);
-        assert(tuple.isActive());
-        xs.push_back(tuple);
+        //
+        // OPTIMIZATION: TOP-N
+        // Only the first limit + offset tuples in sort order can be
+        // output, so keep just those in a max-heap whose top is the worst
+        // candidate, and replace the top whenever a better tuple turns up.
+        // The key slot past the heap is scratch space for the tuple being
+        // looked at.
+        //
+        xs.reserve(heapLimit);
+        keyValues.resize((heapLimit + 1) * keyCount);
+        while (iterator.next(tuple))
+        {
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            assert(tuple.isActive());
+            if (heapLimit == 0) {
+                continue;
+            }
+            SortEntry entry;
+            entry.tuple = tuple;
+            entry.keyOffset = xs.size() * keyCount;
+            evaluateSortKeys(keys, tuple, &keyValues[entry.keyOffset]);
+            if (static_cast<int64_t>(xs.size()) < heapLimit) {
+                xs.push_back(entry);
+                push_heap(xs.begin(), xs.end(), comparer);
+            }
+            else if (comparer(entry, xs.front())) {
+                // the new tuple takes over the evicted tuple's key slot
+                pop_heap(xs.begin(), xs.end(), comparer);
+                size_t freed = xs.back().keyOffset;
+                copy(keyValues.begin() + entry.keyOffset,
+                     keyValues.begin() + entry.keyOffset + keyCount,
+                     keyValues.begin() + freed);
+                xs.back().tuple = tuple;
+                xs.back().keyOffset = freed;
+                push_heap(xs.begin(), xs.end(), comparer);
+            }
+        }
+        sort_heap(xs.begin(), xs.end(), comparer);
+    }
+    else
+    {
+        while (iterator.next(tuple))
+        {
+            m_engine->noteTuplesProcessedForProgressMonitoring(1);
+            assert(tuple.isActive());
+            SortEntry entry;
+            entry.tuple = tuple;
+            entry.keyOffset = keyValues.size();
+            keyValues.resize(keyValues.size() + keyCount);
+            evaluateSortKeys(keys, tuple, &keyValues[entry.keyOffset]);
+            xs.push_back(entry);
+        }
+        VOLT_TRACE("\n***** Input Table PreSort:\n '%s'",
+                   input_table->debug().c_str());
+        sort(xs.begin(), xs.end(), comparer);
     }
-    VOLT_TRACE("\n***** Input Table PreSort:\n '%s'",
-               input_table->debug().c_str());
-    sort(xs.begin(), xs.end(), TupleComparer(node->getSortExpressions(),
-                                             node->getSortDirections()));
 
     int tuple_ctr = 0;
     int tuple_skipped = 0;
-    for (vector<TableTuple>::iterator it = xs.begin(); it != xs.end(); it++)
+    for (vector<SortEntry>::iterator it = xs.begin(); it != xs.end(); it++)
     {
         //
         // Check if has gone past the offset
@@ -187,9 +255,16 @@ OrderByExecutor::p_execute(const NValueArray &params)
             continue;
         }
 
+        //
+        // Check whether we have gone past our limit
+        //
+        if (limit >= 0 && tuple_ctr >= limit) {
+            break;
+        }
+
         VOLT_TRACE("\n***** Input Table PostSort:\n '%s'",
                    input_table->debug().c_str());
-        if (!output_table->insertTuple(*it))
+        if (!output_table->insertTuple(it->tuple))
         {
             VOLT_ERROR("Failed to insert order-by tuple from input table '%s'"
                        " into output table '%s'",
@@ -197,12 +272,7 @@ OrderByExecutor::p_execute(const NValueArray &params)
                        output_table->name().c_str());
             return false;
         }
-        //
-        // Check whether we have gone past our limit
-        //
-        if (limit >= 0 && ++tuple_ctr >= limit) {
-            break;
-        }
+        ++tuple_ctr;
     }
     VOLT_TRACE("Result of OrderBy:\n '%s'", output_table->debug().c_str());
 
@@ -116,12 +116,33 @@ bool ProjectionExecutor::p_execute(const NValueArray &params) {
 
     VOLT_TRACE("INPUT TABLE: %s\n", input_table->debug().c_str());
 
+    p_pipelineStart(params);
+
+    //
+    // Now loop through all the tuples and push them through our output
+    // expression This will generate new tuple values that we will insert into
+    // our output table
+    //
+    TableIterator iterator = input_table->iterator();
+    assert (tuple.sizeInValues() == input_table->columnCount());
+    while (iterator.next(tuple)) {
+        if (!projectTuple(tuple)) {
+            break;
+        }
+    }
+
+    //VOLT_TRACE("PROJECTED TABLE: %s\n", output_table->debug().c_str());
+
+    return (true);
+}
+
+bool ProjectionExecutor::p_pipelineStart(const NValueArray &params) {
     //
     // Since we have the input params, we need to call substitute to change any
     // nodes in our expression tree to be ready for the projection operations in
     // execute
     //
-    assert (m_columnCount == (int)node->getOutputColumnNames().size());
+    assert (m_columnCount == (int)dynamic_cast<ProjectionPlanNode*>(m_abstractNode)->getOutputColumnNames().size());
     if (all_tuple_array == NULL && all_param_array == NULL) {
         for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
             assert(expression_array[ctr]);
@@ -130,48 +151,36 @@ bool ProjectionExecutor::p_execute(const NValueArray &params) {
                        expression_array[ctr]->debug(true).c_str());
         }
     }
+    m_params = &params;
+    return true;
+}
 
+bool ProjectionExecutor::p_pipelineTuple(TableTuple &input_tuple) {
+    return projectTuple(input_tuple);
+}
+
+inline bool ProjectionExecutor::projectTuple(const TableTuple &input_tuple) {
     //
-    // Now loop through all the tuples and push them through our output
-    // expression This will generate new tuple values that we will insert into
-    // our output table
+    // Project (or replace) values from input tuple
     //
-    TableIterator iterator = input_table->iterator();
-    assert (tuple.sizeInValues() == input_table->columnCount());
-    while (iterator.next(tuple)) {
-        //
-        // Project (or replace) values from input tuple
-        //
-        TableTuple &temp_tuple = output_table->tempTuple();
-        if (all_tuple_array != NULL) {
-            VOLT_TRACE("sweet, all tuples");
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, tuple.getNValue(all_tuple_array[ctr]));
-            }
-        } else if (all_param_array != NULL) {
-            VOLT_TRACE("sweet, all params");
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, params[all_param_array[ctr]]);
-            }
-        } else {
-            for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
-                temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&tuple, NULL));
-            }
+    TableTuple &temp_tuple = output_table->tempTuple();
+    if (all_tuple_array != NULL) {
+        VOLT_TRACE("sweet, all tuples");
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, input_tuple.getNValue(all_tuple_array[ctr]));
+        }
+    } else if (all_param_array != NULL) {
+        VOLT_TRACE("sweet, all params");
+        const NValueArray &params = *m_params;
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, params[all_param_array[ctr]]);
+        }
+    } else {
+        for (int ctr = m_columnCount - 1; ctr >= 0; --ctr) {
+            temp_tuple.setNValue(ctr, expression_array[ctr]->eval(&input_tuple, NULL));
         }
-        output_table->insertTupleNonVirtual(temp_tuple);
-
-        VOLT_TRACE("OUTPUT TABLE: %s\n", output_table->debug().c_str());
-
-        /*if (!output_table->insertTupleNonVirtual(temp_tuple)) {
-            // TODO: DEBUG
-            VOLT_ERROR("Failed to insert projection tuple from input table '%s' into output table '%s'", input_table->name().c_str(), output_table->name().c_str());
-            return (false);
-        }*/
     }
-
-    //VOLT_TRACE("PROJECTED TABLE: %s\n", output_table->debug().c_str());
-
-    return (true);
+    return outputTuple(temp_tuple);
 }
 
 ProjectionExecutor::~ProjectionExecutor() {
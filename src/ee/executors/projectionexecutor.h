@@ -66,15 +66,26 @@ class ProjectionExecutor : public AbstractExecutor {
     public:
         ProjectionExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node) : AbstractExecutor(engine, abstract_node) {
             output_table = NULL;
+            m_params = NULL;
         }
         ~ProjectionExecutor();
+
+        bool supportsPipelinedInput() { return true; }
+        bool supportsPipelinedOutput() { return true; }
     protected:
         bool p_init(AbstractPlanNode*,
                     TempTableLimits* limits);
         bool p_execute(const NValueArray &params);
 
+        bool p_pipelineStart(const NValueArray &params);
+        bool p_pipelineTuple(TableTuple &input_tuple);
+
     private:
+        /** Project one input tuple and emit the result. */
+        inline bool projectTuple(const TableTuple &input_tuple);
+
         TempTable* output_table;
+        const NValueArray* m_params;
         Table* input_table;
         int m_columnCount;
         boost::shared_array<int> all_tuple_array_ptr;
@@ -57,6 +57,8 @@
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
+#include "storage/persistenttable.h"
+#include "storage/ColumnPageIterator.h"
 
 using namespace voltdb;
 
@@ -90,6 +92,12 @@ bool SeqScanExecutor::p_init(AbstractPlanNode* abstract_node,
     {
         // Create output table based on output schema from the plan
         setTempOutputTable(limits, node->getTargetTable()->name());
+
+        // Scratch space for projecting a batch of scanned tuples
+        if (node->getInlinePlanNode(PLAN_NODE_TYPE_PROJECTION) != NULL) {
+            m_projectionValues.resize(node->getOutputTable()->columnCount() *
+                                      AbstractExpression::BATCH_SIZE);
+        }
     }
     return true;
 }
@@ -103,6 +111,71 @@ bool SeqScanExecutor::needsOutputTableClear() {
     return node->needsOutputTableClear();
 }
 
+inline bool SeqScanExecutor::outputScannedTuple(TableTuple &tuple, Table *output_table,
+                                                ProjectionPlanNode *projection_node,
+                                                int num_of_columns)
+{
+    //
+    // Nested Projection
+    // Project (or replace) values from input tuple
+    //
+    if (projection_node != NULL)
+    {
+        TableTuple &temp_tuple = output_table->tempTuple();
+        for (int ctr = 0; ctr < num_of_columns; ctr++)
+        {
+            NValue value =
+                projection_node->
+              getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
+            temp_tuple.setNValue(ctr, value);
+        }
+        return outputTuple(temp_tuple);
+    }
+    //
+    // Insert the tuple into our output table
+    //
+    return outputTuple(tuple);
+}
+
+bool SeqScanExecutor::outputScannedBatch(TableTuple *batch, const int *selection, int count,
+                                         Table *output_table,
+                                         ProjectionPlanNode *projection_node,
+                                         int num_of_columns)
+{
+    bool wantsMore = true;
+    if (projection_node == NULL)
+    {
+        for (int ii = 0; wantsMore && ii < count; ii++) {
+            wantsMore = outputTuple(batch[selection[ii]]);
+        }
+        return wantsMore;
+    }
+
+    //
+    // Evaluate the projection a column at a time into the scratch
+    // values, then assemble the output tuples from them
+    //
+    assert(m_projectionValues.size() ==
+           (size_t)num_of_columns * AbstractExpression::BATCH_SIZE);
+    for (int ctr = 0; ctr < num_of_columns; ctr++)
+    {
+        projection_node->getOutputColumnExpressions()[ctr]->
+            evalBatch(batch, selection, count,
+                      &m_projectionValues[ctr * AbstractExpression::BATCH_SIZE]);
+    }
+    TableTuple &temp_tuple = output_table->tempTuple();
+    for (int ii = 0; wantsMore && ii < count; ii++)
+    {
+        const int index = selection[ii];
+        for (int ctr = 0; ctr < num_of_columns; ctr++) {
+            temp_tuple.setNValue(ctr,
+                m_projectionValues[ctr * AbstractExpression::BATCH_SIZE + index]);
+        }
+        wantsMore = outputTuple(temp_tuple);
+    }
+    return wantsMore;
+}
+
 bool SeqScanExecutor::p_execute(const NValueArray &params) {
     SeqScanPlanNode* node = dynamic_cast<SeqScanPlanNode*>(m_abstractNode);
     assert(node);
@@ -147,15 +220,16 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
     // If there is no predicate and no Projection for this SeqScan,
     // then we have already set the node's OutputTable to just point
     // at the TargetTable. Therefore, there is nothing we more we need
-    // to do here
+    // to do here, unless a pipelined parent is waiting for the tuples
     //
     if (node->getPredicate() != NULL || projection_node != NULL ||
-        limit_node != NULL)
+        limit_node != NULL || m_pipelineConsumer != NULL)
     {
         //
         // Just walk through the table using our iterator and apply
         // the predicate to each tuple. For each tuple that satisfies
-        // our expression, we'll insert them into the output table.
+        // our expression, we'll insert them into the output table
+        // or hand them to the pipelined parent.
         //
         TableTuple tuple(target_table->schema());
         TableIterator iterator = target_table->iterator();
@@ -178,60 +252,89 @@ bool SeqScanExecutor::p_execute(const NValueArray &params) {
 
         int tuple_ctr = 0;
         int tuple_skipped = 0;
+        bool wantsMore = true;
         m_engine->setLastAccessedTable(target_table);
-        while ((limit == -1 || tuple_ctr < limit) && iterator.next(tuple))
+
+        //
+        // OPTIMIZATION: BATCHED PREDICATE
+        //
+        // Without a nested limit or a pipelined limit to cut the scan
+        // short, gather the tuples a batch at a time and let the
+        // predicate filter the whole batch, which lets simple
+        // comparisons run as typed loops over the column instead of one
+        // eval() per tuple. A limit must stop the predicate at the last
+        // tuple it takes, or a tuple past it could raise an error.
+        //
+        // Over a table with column pages, the batches are runs of tuple
+        // slots whose visibility and paged column values come from the
+        // pages, so only the tuples that pass are read.
+        //
+        const bool batchPredicate = predicate != NULL && limit_node == NULL &&
+            (m_pipelineConsumer == NULL || !m_pipelineConsumer->mayStopPipelineEarly());
+        PersistentTable *paged_table = dynamic_cast<PersistentTable*>(target_table);
+        if (batchPredicate && paged_table != NULL && paged_table->hasColumnPages())
         {
-            VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
-                       tuple.debug(target_table->name()).c_str(), tuple_ctr,
-                       (int)target_table->activeTupleCount());
-            m_engine->noteTuplesProcessedForProgressMonitoring(1);
-            //
-            // For each tuple we need to evaluate it against our predicate
-            //
-            if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue())
+            TableTuple batch[AbstractExpression::BATCH_SIZE];
+            int selection[AbstractExpression::BATCH_SIZE];
+            std::vector<const char*> columns(paged_table->columnCount());
+            ColumnPageIterator pages(paged_table);
+            int count = 0;
+            while (wantsMore &&
+                   pages.next(batch, selection, count, &columns[0], AbstractExpression::BATCH_SIZE))
             {
-                // Check if we have to skip this tuple because of offset
-                if (tuple_skipped < offset) {
-                    tuple_skipped++;
+                if (count == 0) {
                     continue;
                 }
-                ++tuple_ctr;
-
-                //
-                // Nested Projection
-                // Project (or replace) values from input tuple
-                //
-                if (projection_node != NULL)
+                m_engine->noteTuplesProcessedForProgressMonitoring(count);
+                int selected = predicate->evalPredicateBatch(batch, selection, count, &columns[0]);
+                wantsMore = outputScannedBatch(batch, selection, selected, output_table,
+                                               projection_node, num_of_columns);
+            }
+        }
+        else if (batchPredicate)
+        {
+            TableTuple batch[AbstractExpression::BATCH_SIZE];
+            int selection[AbstractExpression::BATCH_SIZE];
+            bool hasNext = true;
+            while (wantsMore && hasNext)
+            {
+                int count = 0;
+                while (count < AbstractExpression::BATCH_SIZE &&
+                       (hasNext = iterator.next(tuple)))
                 {
-                    TableTuple &temp_tuple = output_table->tempTuple();
-                    for (int ctr = 0; ctr < num_of_columns; ctr++)
-                    {
-                        NValue value =
-                            projection_node->
-                          getOutputColumnExpressions()[ctr]->eval(&tuple, NULL);
-                        temp_tuple.setNValue(ctr, value);
-                    }
-                    if (!output_table->insertTuple(temp_tuple))
-                    {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
-                    }
+                    selection[count] = count;
+                    batch[count++] = tuple;
+                }
+                if (count == 0) {
+                    break;
                 }
-                else
+                m_engine->noteTuplesProcessedForProgressMonitoring(count);
+                int selected = predicate->evalPredicateBatch(batch, selection, count);
+                wantsMore = outputScannedBatch(batch, selection, selected, output_table,
+                                               projection_node, num_of_columns);
+            }
+        }
+        else
+        {
+            while (wantsMore && (limit == -1 || tuple_ctr < limit) && iterator.next(tuple))
+            {
+                VOLT_TRACE("INPUT TUPLE: %s, %d/%d\n",
+                           tuple.debug(target_table->name()).c_str(), tuple_ctr,
+                           (int)target_table->activeTupleCount());
+                m_engine->noteTuplesProcessedForProgressMonitoring(1);
+                //
+                // For each tuple we need to evaluate it against our predicate
+                //
+                if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue())
                 {
-                    //
-                    // Insert the tuple into our output table
-                    //
-                    if (!output_table->insertTuple(tuple)) {
-                        VOLT_ERROR("Failed to insert tuple from table '%s' into"
-                                   " output table '%s'",
-                                   target_table->name().c_str(),
-                                   output_table->name().c_str());
-                        return false;
+                    // Check if we have to skip this tuple because of offset
+                    if (tuple_skipped < offset) {
+                        tuple_skipped++;
+                        continue;
                     }
+                    ++tuple_ctr;
+                    wantsMore = outputScannedTuple(tuple, output_table,
+                                                   projection_node, num_of_columns);
                 }
             }
         }
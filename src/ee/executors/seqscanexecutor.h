@@ -47,25 +47,41 @@
 #define HSTORESEQSCANEXECUTOR_H
 
 #include "common/common.h"
+#include "common/NValue.hpp"
 #include "common/valuevector.h"
 #include "executors/abstractexecutor.h"
 #include "execution/VoltDBEngine.h"
 
+#include <vector>
+
 namespace voltdb
 {
     class UndoLog;
     class ReadWriteSet;
+    class ProjectionPlanNode;
 
     class SeqScanExecutor : public AbstractExecutor {
     public:
         SeqScanExecutor(VoltDBEngine *engine, AbstractPlanNode* abstract_node)
             : AbstractExecutor(engine, abstract_node)
         {}
+        bool supportsPipelinedOutput() { return true; }
     protected:
         bool p_init(AbstractPlanNode* abstract_node,
                     TempTableLimits* limits);
         bool p_execute(const NValueArray& params);
         bool needsOutputTableClear();
+    private:
+        bool outputScannedTuple(TableTuple &tuple, Table *output_table,
+                                ProjectionPlanNode *projection_node,
+                                int num_of_columns);
+        bool outputScannedBatch(TableTuple *batch, const int *selection, int count,
+                                Table *output_table,
+                                ProjectionPlanNode *projection_node,
+                                int num_of_columns);
+
+        // column-major projection results for one batch of tuples
+        std::vector<NValue> m_projectionValues;
     };
 }
 
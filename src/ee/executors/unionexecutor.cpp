@@ -78,6 +78,7 @@ struct SetOperator {
     }
 
     static boost::shared_ptr<SetOperator> getSetOperator(UnionPlanNode* node);
+    static boost::shared_ptr<SetOperator> getHashedSetOperator(UnionPlanNode* node);
 
     std::vector<Table*>& m_input_tables;
 
@@ -284,7 +285,137 @@ void ExceptIntersectSetOperator::intersectTupleMaps(TupleMap& map_a, TupleMap& m
     }
 }
 
+/**
+ * Set operations over inputs that are each sorted on all of their columns,
+ * in TableTuple::compare order. The inputs are read in lockstep, one run
+ * of equal tuples from each at a time, and each run is written out as
+ * many times as the operation calls for, so no tuple is hashed or held
+ * and the output stays sorted.
+ *
+ * The order of the inputs is checked as they are read. If one turns out
+ * not to be sorted, the partial output is discarded and the hashing
+ * operator redoes the operation.
+ */
+struct MergeSetOperator : public SetOperator {
+    MergeSetOperator(std::vector<Table*>& input_tables, Table* output_table,
+                     UnionType union_type, boost::shared_ptr<SetOperator> fallback) :
+        SetOperator(input_tables, output_table, union_type == UNION_TYPE_UNION_ALL ||
+                                                union_type == UNION_TYPE_INTERSECT_ALL ||
+                                                union_type == UNION_TYPE_EXCEPT_ALL),
+        m_union_type(union_type), m_fallback(fallback)
+        {}
+
+    protected:
+        bool processTuplesDo();
+
+    private:
+        size_t outputCount(const std::vector<size_t>& counts) const;
+
+        UnionType m_union_type;
+        boost::shared_ptr<SetOperator> m_fallback;
+};
+
+bool MergeSetOperator::processTuplesDo() {
+    const size_t cnt = m_input_tables.size();
+    std::vector<TableIterator> iterators;
+    std::vector<TableTuple> current;
+    std::vector<bool> valid;
+    iterators.reserve(cnt);
+    current.reserve(cnt);
+    for (size_t ctr = 0; ctr < cnt; ctr++) {
+        Table* input_table = m_input_tables[ctr];
+        assert(input_table);
+        iterators.push_back(input_table->iterator());
+        current.push_back(TableTuple(input_table->schema()));
+        valid.push_back(iterators[ctr].next(current[ctr]));
+    }
+
+    std::vector<size_t> counts(cnt);
+    while (true) {
+        // The next run is made of the smallest tuples not yet read
+        int min_ctr = -1;
+        for (size_t ctr = 0; ctr < cnt; ctr++) {
+            if (valid[ctr] && (min_ctr == -1 || current[ctr].compare(current[min_ctr]) < 0)) {
+                min_ctr = static_cast<int>(ctr);
+            }
+        }
+        if (min_ctr == -1) {
+            break;
+        }
+        TableTuple run = current[min_ctr];
+
+        // Count the run's tuples in each input
+        for (size_t ctr = 0; ctr < cnt; ctr++) {
+            counts[ctr] = 0;
+            while (valid[ctr] && current[ctr].compare(run) == 0) {
+                ++counts[ctr];
+                TableTuple previous = current[ctr];
+                valid[ctr] = iterators[ctr].next(current[ctr]);
+                if (valid[ctr] && current[ctr].compare(previous) < 0) {
+                    VOLT_DEBUG("Input table '%s' is not sorted, falling back to a hashed set operation",
+                               m_input_tables[ctr]->name().c_str());
+                    m_output_table->deleteAllTuples(false);
+                    return m_fallback->processTuples();
+                }
+            }
+        }
+
+        for (size_t i = outputCount(counts); i > 0; --i) {
+            if (!m_output_table->insertTuple(run)) {
+                VOLT_ERROR("Failed to insert tuple from input table '%s' into"
+                           " output table '%s'",
+                           m_input_tables[min_ctr]->name().c_str(),
+                           m_output_table->name().c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// How many copies of a run to output, given its count in each input
+size_t MergeSetOperator::outputCount(const std::vector<size_t>& counts) const {
+    size_t total = 0;
+    size_t least = counts[0];
+    for (size_t ctr = 0; ctr < counts.size(); ctr++) {
+        total += counts[ctr];
+        least = std::min(least, counts[ctr]);
+    }
+    const size_t others = total - counts[0];
+    switch (m_union_type) {
+        case UNION_TYPE_UNION_ALL:
+            return total;
+        case UNION_TYPE_UNION:
+            return 1;
+        case UNION_TYPE_INTERSECT_ALL:
+            return least;
+        case UNION_TYPE_INTERSECT:
+            return least > 0 ? 1 : 0;
+        case UNION_TYPE_EXCEPT_ALL:
+            return counts[0] > others ? counts[0] - others : 0;
+        case UNION_TYPE_EXCEPT:
+            return (counts[0] > 0 && others == 0) ? 1 : 0;
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
 boost::shared_ptr<SetOperator> SetOperator::getSetOperator(UnionPlanNode* node) {
+    UnionType unionType = node->getUnionType();
+    // UNION ALL just appends its inputs, which is no more work than merging them
+    if (node->hasSortedInputs() && unionType != UNION_TYPE_UNION_ALL) {
+        boost::shared_ptr<SetOperator> fallback = getHashedSetOperator(node);
+        if (!fallback) {
+            return fallback;
+        }
+        return boost::shared_ptr<SetOperator>(
+            new MergeSetOperator(node->getInputTables(), node->getOutputTable(), unionType, fallback));
+    }
+    return getHashedSetOperator(node);
+}
+
+boost::shared_ptr<SetOperator> SetOperator::getHashedSetOperator(UnionPlanNode* node) {
     UnionType unionType = node->getUnionType();
     switch (unionType) {
         case UNION_TYPE_UNION_ALL:
@@ -47,6 +47,7 @@
 
 #include "common/debuglog.h"
 #include "common/serializeio.h"
+#include "common/tabletuple.h"
 #include "common/types.h"
 #include "expressions/expressionutil.h"
 
@@ -59,6 +60,8 @@ namespace voltdb {
 // ------------------------------------------------------------------
 // AbstractExpression
 // ------------------------------------------------------------------
+const int AbstractExpression::BATCH_SIZE;
+
 AbstractExpression::AbstractExpression()
     : m_left(NULL), m_right(NULL),
       m_type(EXPRESSION_TYPE_INVALID),
@@ -106,6 +109,30 @@ AbstractExpression::substitute(const NValueArray &params)
     }
 }
 
+int
+AbstractExpression::evalPredicateBatch(const TableTuple *tuples, int *selection, int count,
+                                       const char *const *columns) const
+{
+    int selected = 0;
+    for (int ii = 0; ii < count; ii++) {
+        const int index = selection[ii];
+        if (eval(&tuples[index], NULL).isTrue()) {
+            selection[selected++] = index;
+        }
+    }
+    return selected;
+}
+
+void
+AbstractExpression::evalBatch(const TableTuple *tuples, const int *selection, int count,
+                              NValue *results) const
+{
+    for (int ii = 0; ii < count; ii++) {
+        const int index = selection[ii];
+        results[index] = eval(&tuples[index], NULL);
+    }
+}
+
 bool
 AbstractExpression::hasParameter() const
 {
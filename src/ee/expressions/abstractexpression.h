@@ -76,12 +76,42 @@ class AbstractExpression {
 
     virtual NValue eval(const TableTuple *tuple1 = NULL, const TableTuple *tuple2 = NULL) const = 0;
 
+    /** the most tuples a scan hands to the batch evaluation methods at once */
+    static const int BATCH_SIZE = 256;
+
+    /**
+     * Evaluate this expression as a predicate over a batch of tuples.
+     * selection holds count ascending indexes into tuples. On return its
+     * first n entries, where n is the return value, hold the indexes of the
+     * tuples for which the predicate is true, still in ascending order.
+     * The default evaluates the tuples one at a time; comparisons and
+     * conjunctions override it with typed kernels that avoid a virtual
+     * call and an NValue per node per tuple.
+     * A scan over a table with column pages passes columns, holding for
+     * each column the address of the value for tuples[0] in its column
+     * page (tuples[i]'s value is the i-th after it), or NULL for columns
+     * without a page; the kernels then read the pages instead of the tuples.
+     */
+    virtual int evalPredicateBatch(const TableTuple *tuples, int *selection, int count,
+                                   const char *const *columns = NULL) const;
+
+    /**
+     * Evaluate this expression for each selected tuple of a batch, storing
+     * the value for tuples[selection[i]] in results[selection[i]].
+     */
+    virtual void evalBatch(const TableTuple *tuples, const int *selection, int count,
+                           NValue *results) const;
+
     /** set parameter values for this node and its descendents */
     virtual void substitute(const NValueArray &params);
 
     /** return true if self or descendent should be substitute()'d */
     virtual bool hasParameter() const;
 
+    /** return true if self only reads constants and parameters, so that it
+        has the same value for every tuple and can be evaluated without one */
+    virtual bool isTupleInvariant() const { return false; }
+
     /* debugging methods - some various ways to create a sring
        describing the expression tree */
     std::string debug() const;
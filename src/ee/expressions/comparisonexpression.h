@@ -49,6 +49,8 @@
 #include "common/common.h"
 #include "common/serializeio.h"
 #include "common/valuevector.h"
+#include "common/ValuePeeker.hpp"
+#include "common/StringDictionary.h"
 
 #include "expressions/abstractexpression.h"
 #include "expressions/parametervalueexpression.h"
@@ -56,37 +58,78 @@
 #include "expressions/tuplevalueexpression.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <cmath>
 
 namespace voltdb {
 
 class CmpEq {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_equals(r);}
+    static inline bool holds(int c) { return c == VALUE_COMPARE_EQUAL; }
 };
 class CmpNe {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_notEquals(r);}
+    static inline bool holds(int c) { return c != VALUE_COMPARE_EQUAL; }
 };
 class CmpLt {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_lessThan(r);}
+    static inline bool holds(int c) { return c == VALUE_COMPARE_LESSTHAN; }
 };
 class CmpGt {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_greaterThan(r);}
+    static inline bool holds(int c) { return c == VALUE_COMPARE_GREATERTHAN; }
 };
 class CmpLte {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_lessThanOrEqual(r);}
+    static inline bool holds(int c) { return c != VALUE_COMPARE_GREATERTHAN; }
 };
 class CmpGte {
 public:
     inline NValue cmp(NValue l, NValue r) const { return l.op_greaterThanOrEqual(r);}
+    static inline bool holds(int c) { return c != VALUE_COMPARE_LESSTHAN; }
 };
 class CmpLike {
 public:
-    inline NValue cmp(NValue l, NValue r) const { return l.like(r);}
+    CmpLike() : m_compiled(false) {}
+    inline NValue cmp(NValue l, NValue r) const {
+        return m_compiled ? l.like(m_pattern) : l.like(r);
+    }
+
+    /**
+     * Compile a pattern that is the same for every row -- a constant, or
+     * a parameter once it is substituted -- so cmp() needn't parse it
+     * for each one.
+     */
+    void prepare(const AbstractExpression *right) {
+        m_compiled = false;
+        if (!right->isTupleInvariant()) {
+            return;
+        }
+        m_patternValue = right->eval(NULL, NULL);
+        if (m_patternValue.isNull() || ValuePeeker::peekValueType(m_patternValue) != VALUE_TYPE_VARCHAR) {
+            return;
+        }
+        m_pattern.compile(reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(m_patternValue)),
+                          ValuePeeker::peekObjectLength(m_patternValue));
+        m_compiled = true;
+    }
+
+    /** The compiled pattern, or NULL if it varies by row. */
+    const LikePattern *pattern() const { return m_compiled ? &m_pattern : NULL; }
+
+private:
+    bool m_compiled;
+    // the value the pattern refers to
+    NValue m_patternValue;
+    LikePattern m_pattern;
 };
 class CmpIn {
 public:
@@ -94,6 +137,238 @@ public:
     { return l.inList(r) ? NValue::getTrue() : NValue::getFalse(); }
 };
 
+/*
+ * Lets a comparator prepare for a right side that has just been built or
+ * had its parameters substituted. Only LIKE makes use of it.
+ */
+template <typename C>
+inline void prepareComparison(C &compare, const AbstractExpression *right) {}
+
+inline void prepareComparison(CmpLike &compare, const AbstractExpression *right) {
+    compare.prepare(right);
+}
+
+/*
+ * Typed kernels for batch evaluation of "column <op> constant" predicates.
+ * Each reads the fixed-width column straight from tuple storage, or from
+ * the table's column page when the scan provides one, compares it with
+ * the constant exactly as NValue::compare would, and keeps the selected
+ * tuples for which the comparison holds. NULL column values never
+ * qualify, as the comparison would evaluate to NULL.
+ */
+template <typename T>
+class TupleColumnReader {
+public:
+    TupleColumnReader(const TableTuple *tuples, uint32_t offset) : m_tuples(tuples), m_offset(offset) {}
+    inline T operator()(int index) const {
+        return *reinterpret_cast<const T*>(m_tuples[index].address() + m_offset);
+    }
+private:
+    const TableTuple *m_tuples;
+    const uint32_t m_offset;
+};
+
+template <typename T>
+class ColumnPageReader {
+public:
+    ColumnPageReader(const char *page) : m_values(reinterpret_cast<const T*>(page)) {}
+    inline T operator()(int index) const {
+        return m_values[index];
+    }
+private:
+    const T *m_values;
+};
+
+template <typename C, typename T, typename Reader>
+inline int filterIntegerColumn(const Reader &read, int *selection, int count,
+                               T nullValue, int64_t value, bool reversed)
+{
+    int selected = 0;
+    for (int ii = 0; ii < count; ii++) {
+        const int index = selection[ii];
+        const T raw = read(index);
+        if (raw == nullValue) {
+            continue;
+        }
+        const int64_t columnValue = raw;
+        int cmp = (columnValue == value) ? VALUE_COMPARE_EQUAL :
+            ((columnValue < value) ? VALUE_COMPARE_LESSTHAN : VALUE_COMPARE_GREATERTHAN);
+        if (reversed) {
+            cmp = -cmp;
+        }
+        if (C::holds(cmp)) {
+            selection[selected++] = index;
+        }
+    }
+    return selected;
+}
+
+template <typename C, typename Reader>
+inline int filterDoubleColumn(const Reader &read, int *selection, int count,
+                              double value, bool reversed)
+{
+    const bool valueIsNaN = std::isnan(value);
+    int selected = 0;
+    for (int ii = 0; ii < count; ii++) {
+        const int index = selection[ii];
+        const double columnValue = read(index);
+        if (columnValue <= DOUBLE_NULL) {
+            continue;
+        }
+        // NaN sorts equal to NaN and below everything else, as in NValue::compareDoubleValue
+        int cmp;
+        if (std::isnan(columnValue)) {
+            cmp = valueIsNaN ? VALUE_COMPARE_EQUAL : VALUE_COMPARE_LESSTHAN;
+        } else if (valueIsNaN || columnValue > value) {
+            cmp = VALUE_COMPARE_GREATERTHAN;
+        } else if (columnValue < value) {
+            cmp = VALUE_COMPARE_LESSTHAN;
+        } else {
+            cmp = VALUE_COMPARE_EQUAL;
+        }
+        if (reversed) {
+            cmp = -cmp;
+        }
+        if (C::holds(cmp)) {
+            selection[selected++] = index;
+        }
+    }
+    return selected;
+}
+
+template <typename C, typename T>
+inline int filterIntegerColumn(const TableTuple *tuples, const char *page, int *selection, int count,
+                               uint32_t offset, T nullValue, int64_t value, bool reversed)
+{
+    if (page != NULL) {
+        return filterIntegerColumn<C, T>(ColumnPageReader<T>(page), selection, count,
+                                         nullValue, value, reversed);
+    }
+    return filterIntegerColumn<C, T>(TupleColumnReader<T>(tuples, offset), selection, count,
+                                     nullValue, value, reversed);
+}
+
+template <typename C>
+inline int filterDoubleColumn(const TableTuple *tuples, const char *page, int *selection, int count,
+                              uint32_t offset, double value, bool reversed)
+{
+    if (page != NULL) {
+        return filterDoubleColumn<C>(ColumnPageReader<double>(page), selection, count,
+                                     value, reversed);
+    }
+    return filterDoubleColumn<C>(TupleColumnReader<double>(tuples, offset), selection, count,
+                                 value, reversed);
+}
+
+template <typename C>
+inline int filterColumn(const TableTuple *tuples, const char *page, int *selection, int count,
+                        int columnIndex, const NValue &value, bool reversed)
+{
+    const TupleSchema *schema = tuples[selection[0]].getSchema();
+    const uint32_t offset = schema->columnOffset(columnIndex) + TUPLE_HEADER_SIZE;
+    switch (schema->columnType(columnIndex)) {
+    case VALUE_TYPE_TINYINT:
+        return filterIntegerColumn<C, int8_t>(tuples, page, selection, count, offset, INT8_NULL,
+                                              ValuePeeker::peekAsBigInt(value), reversed);
+    case VALUE_TYPE_SMALLINT:
+        return filterIntegerColumn<C, int16_t>(tuples, page, selection, count, offset, INT16_NULL,
+                                               ValuePeeker::peekAsBigInt(value), reversed);
+    case VALUE_TYPE_INTEGER:
+        return filterIntegerColumn<C, int32_t>(tuples, page, selection, count, offset, INT32_NULL,
+                                               ValuePeeker::peekAsBigInt(value), reversed);
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+        return filterIntegerColumn<C, int64_t>(tuples, page, selection, count, offset, INT64_NULL,
+                                               ValuePeeker::peekAsBigInt(value), reversed);
+    case VALUE_TYPE_DOUBLE:
+        return filterDoubleColumn<C>(tuples, page, selection, count, offset,
+                                     ValuePeeker::peekDouble(value.castAs(VALUE_TYPE_DOUBLE)), reversed);
+    default:
+        assert(false);
+        return 0;
+    }
+}
+
+/*
+ * Kernel for "column = value", "column <> value" and "column IN list" on a
+ * dictionary encoded string column (see StringDictionary). The values are
+ * looked up in the column's dictionary once per batch. After that a string
+ * that is one of their entries matches and any other entry of the same
+ * dictionary doesn't, without either string being read. Strings from
+ * anywhere else, and short strings, which are never entries, are compared
+ * as usual. Returns -1, having selected nothing, if the first non-null
+ * string held out of line is not an entry or a value can't be compared by
+ * its bytes alone.
+ */
+template <typename C>
+inline int filterDictionaryColumn(const TableTuple *tuples, int *selection, int count,
+                                  int columnIndex, const NValue &value, bool selectMatches,
+                                  const C &compare)
+{
+    const TupleSchema *schema = tuples[selection[0]].getSchema();
+    const ValueType columnType = schema->columnType(columnIndex);
+    const TupleColumnReader<const StringRef*> read(tuples,
+                                                   schema->columnOffset(columnIndex) + TUPLE_HEADER_SIZE);
+    const StringDictionary *dictionary = NULL;
+    for (int ii = 0; ii < count; ii++) {
+        const StringRef *sref = read(selection[ii]);
+        if (sref != NULL && !StringRef::isShortString(sref)) {
+            dictionary = StringDictionary::dictionaryOf(sref);
+            break;
+        }
+    }
+    if (dictionary == NULL) {
+        return -1;
+    }
+
+    const bool isList = ValuePeeker::peekValueType(value) == VALUE_TYPE_ARRAY;
+    const int length = isList ? value.arrayLength() : 1;
+    std::vector<const StringRef*> codes;
+    codes.reserve(length);
+    for (int ii = 0; ii < length; ii++) {
+        const NValue item = isList ? value.itemAtIndex(ii) : value;
+        if (item.isNull()) {
+            continue;
+        }
+        if (ValuePeeker::peekValueType(item) != columnType) {
+            return -1;
+        }
+        const char *data = static_cast<const char*>(ValuePeeker::peekObjectValue(item));
+        const int32_t dataLength = ValuePeeker::peekObjectLength(item);
+        // VARCHARs compare equal up to an embedded NUL, so different bytes aren't always unequal
+        if (columnType == VALUE_TYPE_VARCHAR && ::memchr(data, '\0', dataLength) != NULL) {
+            return -1;
+        }
+        const StringRef *code = dictionary->find(data, dataLength);
+        if (code != NULL) {
+            codes.push_back(code);
+        }
+    }
+    std::sort(codes.begin(), codes.end());
+
+    int selected = 0;
+    for (int ii = 0; ii < count; ii++) {
+        const int index = selection[ii];
+        const StringRef *sref = read(index);
+        if (sref == NULL) {
+            continue;
+        }
+        bool qualifies;
+        if (codes.size() == 1 ? sref == codes[0] : std::binary_search(codes.begin(), codes.end(), sref)) {
+            qualifies = selectMatches;
+        } else if (!StringRef::isShortString(sref) &&
+                   StringDictionary::dictionaryOf(sref) == dictionary) {
+            qualifies = !selectMatches;
+        } else {
+            qualifies = compare.cmp(tuples[index].getNValue(columnIndex), value).isTrue();
+        }
+        if (qualifies) {
+            selection[selected++] = index;
+        }
+    }
+    return selected;
+}
+
 template <typename C>
 class ComparisonExpression : public AbstractExpression {
 public:
@@ -104,8 +379,36 @@ public:
     {
         m_left = left;
         m_right = right;
+
+        // Spot the "column <op> constant-or-parameter" shape (either way
+        // around, and with IN lists of those) that evalPredicateBatch can
+        // hand to a typed kernel.
+        m_kernelColumn = NULL;
+        m_kernelValue = NULL;
+        m_kernelReversed = false;
+        if (isKernelColumn(left) && isKernelValue(right)) {
+            m_kernelColumn = static_cast<const TupleValueExpression*>(left);
+            m_kernelValue = right;
+        } else if (isKernelColumn(right) && isKernelValue(left)) {
+            m_kernelColumn = static_cast<const TupleValueExpression*>(right);
+            m_kernelValue = left;
+            m_kernelReversed = true;
+        }
+        if (!right->hasParameter()) {
+            prepareComparison(compare, right);
+        }
     };
 
+    void substitute(const NValueArray &params) {
+        if (!m_hasParameter) {
+            return;
+        }
+        AbstractExpression::substitute(params);
+        prepareComparison(compare, m_right);
+    }
+
+    const C &comparator() const { return compare; }
+
     inline NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const {
         VOLT_TRACE("eval %s. left %s, right %s. ret=%s",
                    typeid(compare).name(), typeid(*(m_left)).name(),
@@ -138,14 +441,134 @@ public:
         return compare.cmp(lnv, rnv);
     }
 
+    int evalPredicateBatch(const TableTuple *tuples, int *selection, int count,
+                           const char *const *columns) const {
+        if (count == 0) {
+            return 0;
+        }
+        if (m_kernelColumn != NULL) {
+            const NValue value = m_kernelValue->eval(NULL, NULL);
+            if (value.isNull()) {
+                return 0;
+            }
+            const int columnIndex = m_kernelColumn->getColumnId();
+            const ValueType columnType = tuples[selection[0]].getSchema()->columnType(columnIndex);
+            if (isKernelComparable(columnType, ValuePeeker::peekValueType(value))) {
+                const char *page = columns == NULL ? NULL : columns[columnIndex];
+                switch (this->getExpressionType()) {
+                case EXPRESSION_TYPE_COMPARE_EQUAL:
+                    return filterColumn<CmpEq>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+                    return filterColumn<CmpNe>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+                    return filterColumn<CmpLt>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+                    return filterColumn<CmpGt>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+                    return filterColumn<CmpLte>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+                    return filterColumn<CmpGte>(tuples, page, selection, count, columnIndex, value, m_kernelReversed);
+                default:
+                    break;
+                }
+            } else if (isDictionaryComparable(tuples[selection[0]].getSchema(), columnIndex)) {
+                int selected = -1;
+                switch (this->getExpressionType()) {
+                case EXPRESSION_TYPE_COMPARE_EQUAL:
+                    selected = filterDictionaryColumn(tuples, selection, count, columnIndex, value, true, compare);
+                    break;
+                case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+                    selected = filterDictionaryColumn(tuples, selection, count, columnIndex, value, false, compare);
+                    break;
+                case EXPRESSION_TYPE_COMPARE_IN:
+                    if (!m_kernelReversed) {
+                        selected = filterDictionaryColumn(tuples, selection, count, columnIndex, value, true, compare);
+                    }
+                    break;
+                default:
+                    break;
+                }
+                if (selected >= 0) {
+                    return selected;
+                }
+            }
+        }
+
+        // Evaluate each side a batch at a time. As in eval(), the right
+        // side is only evaluated for tuples with a non-null left value.
+        NValue leftValues[BATCH_SIZE];
+        NValue rightValues[BATCH_SIZE];
+        m_left->evalBatch(tuples, selection, count, leftValues);
+        int nonNull = 0;
+        for (int ii = 0; ii < count; ii++) {
+            const int index = selection[ii];
+            if (!leftValues[index].isNull()) {
+                selection[nonNull++] = index;
+            }
+        }
+        m_right->evalBatch(tuples, selection, nonNull, rightValues);
+        int selected = 0;
+        for (int ii = 0; ii < nonNull; ii++) {
+            const int index = selection[ii];
+            if (!rightValues[index].isNull() &&
+                compare.cmp(leftValues[index], rightValues[index]).isTrue()) {
+                selection[selected++] = index;
+            }
+        }
+        return selected;
+    }
+
     std::string debugInfo(const std::string &spacer) const {
         return (spacer + "ComparisonExpression\n");
     }
 
 private:
+    static bool isKernelColumn(const AbstractExpression *expr) {
+        const TupleValueExpression *column = dynamic_cast<const TupleValueExpression*>(expr);
+        return column != NULL && column->getTupleId() == 0;
+    }
+
+    // constants, parameters, and IN lists of them
+    static bool isKernelValue(const AbstractExpression *expr) {
+        return expr->isTupleInvariant();
+    }
+
+    static bool isIntegerType(ValueType type) {
+        return type == VALUE_TYPE_TINYINT || type == VALUE_TYPE_SMALLINT ||
+            type == VALUE_TYPE_INTEGER || type == VALUE_TYPE_BIGINT ||
+            type == VALUE_TYPE_TIMESTAMP;
+    }
+
+    /**
+     * String columns stored out of line are handed to the dictionary
+     * kernel, which passes on those that turn out not to be encoded.
+     */
+    static bool isDictionaryComparable(const TupleSchema *schema, int columnIndex) {
+        const ValueType columnType = schema->columnType(columnIndex);
+        return (columnType == VALUE_TYPE_VARCHAR || columnType == VALUE_TYPE_VARBINARY) &&
+            !schema->columnIsInlined(columnIndex);
+    }
+
+    /**
+     * The kernels cover integer columns against integer values, where
+     * NValue::compare compares as BIGINT, and DOUBLE columns against
+     * integer or DOUBLE values, where it compares as DOUBLE.
+     */
+    static bool isKernelComparable(ValueType columnType, ValueType valueType) {
+        if (isIntegerType(columnType)) {
+            return isIntegerType(valueType);
+        }
+        return columnType == VALUE_TYPE_DOUBLE &&
+            (valueType == VALUE_TYPE_DOUBLE || isIntegerType(valueType));
+    }
+
     AbstractExpression *m_left;
     AbstractExpression *m_right;
     C compare;
+
+    const TupleValueExpression *m_kernelColumn;
+    const AbstractExpression *m_kernelValue;
+    bool m_kernelReversed;
 };
 
 template <typename C, typename L, typename R>
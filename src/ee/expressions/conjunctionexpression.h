@@ -52,6 +52,7 @@
 
 #include "expressions/abstractexpression.h"
 
+#include <algorithm>
 #include <string>
 
 namespace voltdb {
@@ -74,6 +75,9 @@ class ConjunctionExpression : public AbstractExpression
 
     NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const;
 
+    int evalPredicateBatch(const TableTuple *tuples, int *selection, int count,
+                           const char *const *columns) const;
+
     std::string debugInfo(const std::string &spacer) const {
         return (spacer + "ConjunctionExpression\n");
     }
@@ -130,5 +134,49 @@ ConjunctionExpression<ConjunctionOr>::eval(const TableTuple *tuple1,
     return NValue::getNullValue(VALUE_TYPE_BOOLEAN);
 }
 
+template<> inline int
+ConjunctionExpression<ConjunctionAnd>::evalPredicateBatch(const TableTuple *tuples,
+                                                          int *selection, int count,
+                                                          const char *const *columns) const
+{
+    // Only the tuples that pass the left side are handed to the right side.
+    count = m_left->evalPredicateBatch(tuples, selection, count, columns);
+    if (count == 0) {
+        return 0;
+    }
+    return m_right->evalPredicateBatch(tuples, selection, count, columns);
+}
+
+template<> inline int
+ConjunctionExpression<ConjunctionOr>::evalPredicateBatch(const TableTuple *tuples,
+                                                         int *selection, int count,
+                                                         const char *const *columns) const
+{
+    int leftSelection[BATCH_SIZE];
+    std::copy(selection, selection + count, leftSelection);
+    const int leftCount = m_left->evalPredicateBatch(tuples, leftSelection, count, columns);
+    if (leftCount == count) {
+        return count;
+    }
+
+    // Give the tuples the left side rejected a chance on the right side.
+    int rightSelection[BATCH_SIZE];
+    int rightCount = 0;
+    int ll = 0;
+    for (int ii = 0; ii < count; ii++) {
+        if (ll < leftCount && leftSelection[ll] == selection[ii]) {
+            ll++;
+        } else {
+            rightSelection[rightCount++] = selection[ii];
+        }
+    }
+    rightCount = m_right->evalPredicateBatch(tuples, rightSelection, rightCount, columns);
+
+    // Merge the two ascending selections back into one.
+    std::merge(leftSelection, leftSelection + leftCount,
+               rightSelection, rightSelection + rightCount, selection);
+    return leftCount + rightCount;
+}
+
 }
 #endif
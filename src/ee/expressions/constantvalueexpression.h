@@ -76,6 +76,17 @@ class ConstantValueExpression : public AbstractExpression {
         return this->value;
     }
 
+    void evalBatch(const TableTuple *tuples, const int *selection, int count,
+                   NValue *results) const {
+        for (int ii = 0; ii < count; ii++) {
+            results[selection[ii]] = this->value;
+        }
+    }
+
+    bool isTupleInvariant() const {
+        return true;
+    }
+
     std::string debugInfo(const std::string &spacer) const {
         return spacer + "OptimizedConstantValueExpression:" +
           value.debug() + "\n";
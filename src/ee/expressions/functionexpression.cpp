@@ -17,6 +17,7 @@
 
 #include "expressions/functionexpression.h"
 #include "expressions/expressionutil.h"
+#include "common/ValuePeeker.hpp"
 
 namespace voltdb {
 
@@ -202,10 +203,62 @@ public:
         return (buffer.str());
     }
 
-private:
+protected:
     const std::vector<AbstractExpression *>& m_args;
 };
 
+/*
+ * The FIELD function, with its field name compiled when it is the same
+ * for every row -- a constant, or a parameter once it is substituted --
+ * so each document is scanned for it without looking at the name again.
+ */
+class JsonFieldFunctionExpression : public GeneralFunctionExpression<FUNC_VOLT_FIELD> {
+public:
+    JsonFieldFunctionExpression(const std::vector<AbstractExpression *>& args)
+        : GeneralFunctionExpression<FUNC_VOLT_FIELD>(args), m_compiled(false) {
+        assert(args.size() == 2);
+        if (!args[1]->hasParameter()) {
+            prepare();
+        }
+    }
+
+    virtual void substitute(const NValueArray &params) {
+        if (!m_hasParameter) {
+            return;
+        }
+        GeneralFunctionExpression<FUNC_VOLT_FIELD>::substitute(params);
+        prepare();
+    }
+
+    NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const {
+        if (!m_compiled) {
+            return GeneralFunctionExpression<FUNC_VOLT_FIELD>::eval(tuple1, tuple2);
+        }
+        return m_args[0]->eval(tuple1, tuple2).jsonField(m_field);
+    }
+
+private:
+    void prepare() {
+        m_compiled = false;
+        if (!m_args[1]->isTupleInvariant()) {
+            return;
+        }
+        // a null or mistyped name is left to the general evaluation
+        m_fieldValue = m_args[1]->eval(NULL, NULL);
+        if (m_fieldValue.isNull() || ValuePeeker::peekValueType(m_fieldValue) != VALUE_TYPE_VARCHAR) {
+            return;
+        }
+        m_field.compile(reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(m_fieldValue)),
+                        ValuePeeker::peekObjectLength(m_fieldValue));
+        m_compiled = true;
+    }
+
+    bool m_compiled;
+    // the value the field refers to
+    NValue m_fieldValue;
+    JsonField m_field;
+};
+
 }
 
 using namespace functionexpression;
@@ -372,7 +425,7 @@ ExpressionUtil::functionFactory(int functionId, const std::vector<AbstractExpres
             ret = new GeneralFunctionExpression<FUNC_VOLT_ARRAY_ELEMENT>(*arguments);
             break;
         case FUNC_VOLT_FIELD:
-            ret = new GeneralFunctionExpression<FUNC_VOLT_FIELD>(*arguments);
+            ret = new JsonFieldFunctionExpression(*arguments);
             break;
         case FUNC_VOLT_SQL_ERROR:
             ret = new GeneralFunctionExpression<FUNC_VOLT_SQL_ERROR>(*arguments);
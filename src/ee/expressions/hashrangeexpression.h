@@ -103,6 +103,8 @@ public:
     }
 
     int getColumnId() const {return this->value_idx;}
+    int getRangeCount() const {return this->num_ranges;}
+    const srange_type &getRange(int index) const {return this->ranges[index];}
 
 private:
     const int value_idx;           // which (offset) column of the tuple
@@ -27,8 +27,46 @@
 #include <jsoncpp/jsoncpp.h>
 #include <jsoncpp/jsoncpp-forwards.h>
 
+#include "common/JsonField.h"
+#include "common/ValueFactory.hpp"
+
 namespace voltdb {
 
+/** parse a whole document for the JSON functions, throwing if it's invalid */
+inline void parseJsonDocument(const char *docChars, int32_t lenDoc, Json::Value &root) {
+    Json::Reader reader;
+
+    if( ! reader.parse(docChars, docChars + lenDoc, root)) {
+        char msg[1024];
+        // getFormatedErrorMessages returns concise message about location
+        // of the error rather than the malformed document itself
+        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
+        throw SQLException(SQLException::
+                           data_exception_invalid_parameter,
+                           msg);
+    }
+}
+
+/**
+ * The result of FIELD or ARRAY_ELEMENT for a value of a parsed document:
+ * a scalar as a string, an object or array serialized.
+ */
+inline NValue jsonElementValue(const Json::Value &fieldValue) {
+    if (fieldValue.isNull()) {
+        return ValueFactory::getNullStringValue();
+    }
+
+    if (fieldValue.isConvertibleTo(Json::stringValue)) {
+        std::string stringValue(fieldValue.asString());
+        return ValueFactory::getTempStringValue(stringValue.c_str(), stringValue.length());
+    }
+
+    Json::FastWriter writer;
+    std::string serializedValue(writer.write(fieldValue));
+    // writer always appends a trailing new line \n
+    return ValueFactory::getTempStringValue(serializedValue.c_str(), serializedValue.length() -1);
+}
+
 /** implement the 2-argument SQL FIELD function */
 template<> inline NValue NValue::call<FUNC_VOLT_FIELD>(const std::vector<NValue>& arguments) {
     assert(arguments.size() == 2);
@@ -40,7 +78,6 @@ template<> inline NValue NValue::call<FUNC_VOLT_FIELD>(const std::vector<NValue>
     if (docNVal.getValueType() != VALUE_TYPE_VARCHAR) {
         throwCastSQLException (docNVal.getValueType(), VALUE_TYPE_VARCHAR);
     }
-    int32_t lenDoc = docNVal.getObjectLength();
 
     const NValue& fieldNVal = arguments[1];
     if (fieldNVal.isNull()) {
@@ -50,51 +87,73 @@ template<> inline NValue NValue::call<FUNC_VOLT_FIELD>(const std::vector<NValue>
         throwCastSQLException (fieldNVal.getValueType(), VALUE_TYPE_VARCHAR);
     }
     int32_t lenField = fieldNVal.getObjectLength();
-
-    char *docChars = reinterpret_cast<char*>(docNVal.getObjectValue());
     char *fieldChars = reinterpret_cast<char*>(fieldNVal.getObjectValue());
 
-    const std::string doc(docChars, lenDoc);
-    const std::string field(fieldChars,lenField);
-
-    Json::Value root;
-    Json::Reader reader;
-
-    if( ! reader.parse(doc, root)) {
-        char msg[1024];
-        // getFormatedErrorMessages returns concise message about location
-        // of the error rather than the malformed document itself
-        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
-    }
+    return docNVal.jsonField(JsonField(fieldChars, lenField));
+}
 
-    // only object type contain fields. primitives, arrays do not
-    if( ! root.isObject()) {
+/*
+ * FIELD of this document for a field compiled from a FIELD expression's
+ * constant or parameter name, or for each row from its value. The
+ * document is scanned rather than parsed into a tree. Plain string, integer and
+ * literal values are returned as they are written; other values are
+ * parsed on their own, and documents the scan can't account for are
+ * parsed in full, as before.
+ */
+inline NValue NValue::jsonField(const JsonField &field) const {
+    if (isNull()) {
         return getNullStringValue();
     }
+    if (getValueType() != VALUE_TYPE_VARCHAR) {
+        throwCastSQLException (getValueType(), VALUE_TYPE_VARCHAR);
+    }
+    int32_t lenDoc = getObjectLength();
+    const char *docChars = reinterpret_cast<const char*>(getObjectValue());
 
-    // field is not present in the document
-    if( ! root.isMember(field)) {
+    const char *valueChars = NULL;
+    int32_t lenValue = 0;
+    switch (field.find(docChars, lenDoc, valueChars, lenValue)) {
+    case JsonField::FIELD_ABSENT:
         return getNullStringValue();
+    case JsonField::FIELD_FOUND: {
+        if (JsonField::isPlainString(valueChars, lenValue)) {
+            return getTempStringValue(valueChars + 1, lenValue - 2);
+        }
+        if (JsonField::isPlainInteger(valueChars, lenValue) ||
+            (lenValue == 4 && ::memcmp(valueChars, "true", 4) == 0) ||
+            (lenValue == 5 && ::memcmp(valueChars, "false", 5) == 0)) {
+            return getTempStringValue(valueChars, lenValue);
+        }
+        if (lenValue == 4 && ::memcmp(valueChars, "null", 4) == 0) {
+            return getNullStringValue();
+        }
+        // numbers jsoncpp rewrites, escaped strings, objects and arrays
+        Json::Value fieldValue;
+        Json::Reader reader;
+        if (reader.parse(valueChars, valueChars + lenValue, fieldValue)) {
+            return jsonElementValue(fieldValue);
+        }
+        break;
+    }
+    default:
+        break;
     }
 
-    Json::Value fieldValue = root[field];
+    Json::Value root;
+    parseJsonDocument(docChars, lenDoc, root);
 
-    if (fieldValue.isNull()) {
+    // only object type contain fields. primitives, arrays do not
+    if( ! root.isObject()) {
         return getNullStringValue();
     }
 
-    if (fieldValue.isConvertibleTo(Json::stringValue)) {
-        std::string stringValue(fieldValue.asString());
-        return getTempStringValue(stringValue.c_str(), stringValue.length());
+    const std::string fieldName(field.name(), field.nameLength());
+    // field is not present in the document
+    if( ! root.isMember(fieldName)) {
+        return getNullStringValue();
     }
 
-    Json::FastWriter writer;
-    std::string serializedValue(writer.write(fieldValue));
-    // writer always appends a trailing new line \n
-    return getTempStringValue(serializedValue.c_str(), serializedValue.length() -1);
+    return jsonElementValue(root[fieldName]);
 }
 
 /** implement the 2-argument SQL ARRAY_ELEMENT function */
@@ -115,22 +174,11 @@ template<> inline NValue NValue::call<FUNC_VOLT_ARRAY_ELEMENT>(const std::vector
     }
     int32_t lenDoc = docNVal.getObjectLength();
     char *docChars = reinterpret_cast<char*>(docNVal.getObjectValue());
-    const std::string doc(docChars, lenDoc);
 
     int32_t index = indexNVal.castAsIntegerAndGetValue();
 
     Json::Value root;
-    Json::Reader reader;
-
-    if( ! reader.parse(doc, root)) {
-        char msg[1024];
-        // getFormatedErrorMessages returns concise message about location
-        // of the error rather than the malformed document itself
-        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
-    }
+    parseJsonDocument(docChars, lenDoc, root);
 
     // only array type contains elements. objects, primitives do not
     if( ! root.isArray()) {
@@ -146,21 +194,7 @@ template<> inline NValue NValue::call<FUNC_VOLT_ARRAY_ELEMENT>(const std::vector
         return getNullStringValue();
     }
 
-    Json::Value fieldValue = root[index];
-
-    if (fieldValue.isNull()) {
-        return getNullStringValue();
-    }
-
-    if (fieldValue.isConvertibleTo(Json::stringValue)) {
-        std::string stringValue(fieldValue.asString());
-        return getTempStringValue(stringValue.c_str(), stringValue.length());
-    }
-
-    Json::FastWriter writer;
-    std::string serializedValue(writer.write(fieldValue));
-    // writer always appends a trailing new line \n
-    return getTempStringValue(serializedValue.c_str(), serializedValue.length() -1);
+    return jsonElementValue(root[index]);
 }
 
 /** implement the 1-argument SQL ARRAY_LENGTH function */
@@ -175,20 +209,9 @@ template<> inline NValue NValue::callUnary<FUNC_VOLT_ARRAY_LENGTH>() const {
 
     int32_t lenDoc = getObjectLength();
     char *docChars = reinterpret_cast<char*>(getObjectValue());
-    const std::string doc(docChars, lenDoc);
 
     Json::Value root;
-    Json::Reader reader;
-
-    if( ! reader.parse(doc, root)) {
-        char msg[1024];
-        // getFormatedErrorMessages returns concise message about location
-        // of the error rather than the malformed document itself
-        snprintf(msg, sizeof(msg), "Invalid JSON %s", reader.getFormatedErrorMessages().c_str());
-        throw SQLException(SQLException::
-                           data_exception_invalid_parameter,
-                           msg);
-    }
+    parseJsonDocument(docChars, lenDoc, root);
 
     // only array type contains indexed elements. objects, primitives do not
     if( ! root.isArray()) {
@@ -230,6 +230,20 @@ class OperatorExpression : public AbstractExpression {
                        m_right->eval(tuple1, tuple2));
     }
 
+    void evalBatch(const TableTuple *tuples, const int *selection, int count,
+                   NValue *results) const
+    {
+        assert(m_left);
+        assert(m_right);
+        NValue rightValues[BATCH_SIZE];
+        m_left->evalBatch(tuples, selection, count, results);
+        m_right->evalBatch(tuples, selection, count, rightValues);
+        for (int ii = 0; ii < count; ii++) {
+            const int index = selection[ii];
+            results[index] = oper.op(results[index], rightValues[index]);
+        }
+    }
+
     std::string debugInfo(const std::string &spacer) const {
         return (spacer + "OptimizedOperatorExpression");
     }
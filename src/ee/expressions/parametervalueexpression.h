@@ -72,11 +72,22 @@ public:
         return this->m_paramValue;
     }
 
+    void evalBatch(const TableTuple *tuples, const int *selection, int count,
+                   NValue *results) const {
+        for (int ii = 0; ii < count; ii++) {
+            results[selection[ii]] = this->m_paramValue;
+        }
+    }
+
     bool hasParameter() const {
         // this class represents a parameter.
         return true;
     }
 
+    bool isTupleInvariant() const {
+        return true;
+    }
+
     void substitute(const NValueArray &params) {
         assert (this->m_valueIdx < params.size());
         m_paramValue = params[this->m_valueIdx];
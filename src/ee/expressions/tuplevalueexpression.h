@@ -88,6 +88,15 @@ class TupleValueExpression : public AbstractExpression {
         }
     }
 
+    void evalBatch(const TableTuple *tuples, const int *selection, int count,
+                   NValue *results) const {
+        assert(tuple_idx == 0);
+        for (int ii = 0; ii < count; ii++) {
+            const int index = selection[ii];
+            results[index] = tuples[index].getNValue(value_idx);
+        }
+    }
+
     std::string debugInfo(const std::string &spacer) const {
         std::ostringstream buffer;
         buffer << spacer << "Optimized Column Reference[" << tuple_idx << ", " << value_idx << "]\n";
@@ -96,6 +105,8 @@ class TupleValueExpression : public AbstractExpression {
 
     int getColumnId() const {return this->value_idx;}
 
+    int getTupleId() const {return this->tuple_idx;}
+
   protected:
 
     const int tuple_idx;           // which tuple. defaults to tuple1
@@ -30,9 +30,19 @@ namespace voltdb {
 class VectorExpression : public AbstractExpression {
 public:
     VectorExpression(ValueType elementType, const std::vector<AbstractExpression *>& arguments)
-        : AbstractExpression(EXPRESSION_TYPE_VALUE_VECTOR), m_args(arguments)
+        : AbstractExpression(EXPRESSION_TYPE_VALUE_VECTOR), m_args(arguments),
+          m_argsAreInvariant(true), m_inListIsCurrent(false)
     {
         m_inList = ValueFactory::getArrayValueFromSizeAndType(arguments.size(), elementType);
+        // A list of constants and parameters has the same elements for every
+        // row, so it only needs building (and sorting) once per substitution.
+        for (size_t i = 0; i < arguments.size(); i++) {
+            ExpressionType argType = arguments[i]->getExpressionType();
+            if (argType != EXPRESSION_TYPE_VALUE_CONSTANT &&
+                argType != EXPRESSION_TYPE_VALUE_PARAMETER) {
+                m_argsAreInvariant = false;
+            }
+        }
     }
 
     virtual ~VectorExpression()
@@ -56,11 +66,17 @@ public:
         return false;
     }
 
+    virtual bool isTupleInvariant() const
+    {
+        return m_argsAreInvariant;
+    }
+
     virtual void substitute(const NValueArray &params)
     {
         if (!m_hasParameter)
             return;
 
+        m_inListIsCurrent = false;
         VOLT_TRACE("Substituting parameters for expression \n%s ...", debug(true).c_str());
         for (size_t i = 0; i < m_args.size(); i++) {
             assert(m_args[i]);
@@ -71,6 +87,9 @@ public:
 
     NValue eval(const TableTuple *tuple1, const TableTuple *tuple2) const
     {
+        if (m_inListIsCurrent) {
+            return m_inList;
+        }
         //TODO: Could make this vector a member, if the memory management implications
         // (of the NValue internal state) were clear -- is there a penalty for longer-lived
         // NValues that outweighs the current per-eval allocation penalty?
@@ -79,6 +98,10 @@ public:
             nValues[i] = m_args[i]->eval(tuple1, tuple2);
         }
         m_inList.setArrayElements(nValues);
+        if (m_argsAreInvariant) {
+            m_inList.prepareInListLookup();
+            m_inListIsCurrent = true;
+        }
         return m_inList;
     }
 
@@ -90,6 +113,9 @@ public:
 private:
     const std::vector<AbstractExpression *>& m_args;
     NValue m_inList;
+    bool m_argsAreInvariant;
+    // set once m_inList holds the sorted elements of an invariant list
+    mutable bool m_inListIsCurrent;
 };
 
 AbstractExpression*
@@ -48,6 +48,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <boost/static_assert.hpp>
 #include "indexes/tableindex.h"
 #include "common/tabletuple.h"
 #include "structures/CompactingHashTable.h"
@@ -66,6 +67,16 @@ class CompactingHashMultiMapIndex : public TableIndex
     typedef CompactingHashTable<KeyType, const void*, KeyHasher, KeyEqualityChecker> MapType;
     typedef typename MapType::iterator MapIterator;
 
+    // the entries of a truncated table, kept until the truncate is undone or released
+    struct DetachedMap : public DetachedIndexEntries {
+        DetachedMap(const TupleSchema *keySchema) : entries(false, KeyHasher(keySchema), KeyEqualityChecker(keySchema)) {}
+        MapType entries;
+    };
+
+    static MapIterator &castToIter(IndexCursor& cursor) {
+        return cursor.m_keyIter.get<MapIterator>();
+    }
+
     ~CompactingHashMultiMapIndex() {};
 
     bool addEntry(const TableTuple *tuple)
@@ -84,6 +95,28 @@ class CompactingHashMultiMapIndex : public TableIndex
         return m_entries.erase(iter);
     }
 
+    void removeAllEntries()
+    {
+        ++m_deletes;
+        m_entries.clear();
+    }
+
+    DetachedIndexEntries *detachAllEntries()
+    {
+        ++m_deletes;
+        DetachedMap *detached = new DetachedMap(m_keySchema);
+        m_entries.swap(detached->entries);
+        return detached;
+    }
+
+    void reattachAllEntries(DetachedIndexEntries *entries)
+    {
+        assert(m_entries.size() == 0);
+        DetachedMap *detached = static_cast<DetachedMap*>(entries);
+        m_entries.swap(detached->entries);
+        delete detached;
+    }
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -119,27 +152,33 @@ class CompactingHashMultiMapIndex : public TableIndex
         return ! findTuple(*persistentTuple).isEnd();
     }
 
-    bool moveToKey(const TableTuple *searchKey) {
+    bool moveToKey(const TableTuple *searchKey, IndexCursor& cursor) {
         ++m_lookups;
-        m_keyIter = findKey(searchKey);
-        if (m_keyIter.isEnd()) {
-            m_match.move(NULL);
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter = findKey(searchKey);
+        if (mapIter.isEnd()) {
+            cursor.m_match.move(NULL);
             return false;
         }
-        m_match.move(const_cast<void*>(m_keyIter.value()));
+        cursor.m_match.move(const_cast<void*>(mapIter.value()));
         return true;
     }
 
-    TableTuple nextValueAtKey() {
-        if (m_match.isNullTuple()) {
-            return m_match;
+    void prefetchKey(const TableTuple *searchKey) {
+        m_entries.prefetch(KeyType(searchKey));
+    }
+
+    TableTuple nextValueAtKey(IndexCursor& cursor) {
+        if (cursor.m_match.isNullTuple()) {
+            return cursor.m_match;
         }
-        TableTuple retval = m_match;
-        m_keyIter.moveNext();
-        if (m_keyIter.isEnd()) {
-            m_match.move(NULL);
+        TableTuple retval = cursor.m_match;
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter.moveNext();
+        if (mapIter.isEnd()) {
+            cursor.m_match.move(NULL);
         } else {
-            m_match.move(const_cast<void*>(m_keyIter.value()));
+            cursor.m_match.move(const_cast<void*>(mapIter.value()));
         }
         return retval;
     }
@@ -176,10 +215,6 @@ class CompactingHashMultiMapIndex : public TableIndex
 
     MapType m_entries;
 
-    // iteration stuff
-    MapIterator m_keyIter;
-    TableTuple m_match;
-
     // comparison stuff
    KeyEqualityChecker m_eq;
 
@@ -187,7 +222,6 @@ public:
     CompactingHashMultiMapIndex(const TupleSchema *keySchema, const TableIndexScheme &scheme) :
         TableIndex(keySchema, scheme),
         m_entries(false, KeyHasher(keySchema), KeyEqualityChecker(keySchema)),
-        m_match(getTupleSchema()),
         m_eq(keySchema)
     {}
 
@@ -48,14 +48,17 @@
 
 #include <iostream>
 #include <cassert>
+#include <boost/static_assert.hpp>
 
 #include "indexes/tableindex.h"
-#include "structures/CompactingHashTable.h"
+#include "structures/ProbingHashTable.h"
 
 namespace voltdb {
 
 /**
- * Index implemented as a Hash Table Unique Map.
+ * Index implemented as a Hash Table Unique Map. The map is a
+ * ProbingHashTable, which resizes a little at a time rather than
+ * rehashing every entry in one insert or delete.
  * @see TableIndex
  */
 template<typename KeyType>
@@ -63,9 +66,19 @@ class CompactingHashUniqueIndex : public TableIndex
 {
     typedef typename KeyType::KeyEqualityChecker KeyEqualityChecker;
     typedef typename KeyType::KeyHasher KeyHasher;
-    typedef CompactingHashTable<KeyType, const void*, KeyHasher, KeyEqualityChecker> MapType;
+    typedef ProbingHashTable<KeyType, const void*, KeyHasher, KeyEqualityChecker> MapType;
     typedef typename MapType::iterator MapIterator;
 
+    // the entries of a truncated table, kept until the truncate is undone or released
+    struct DetachedMap : public DetachedIndexEntries {
+        DetachedMap(const TupleSchema *keySchema) : entries(KeyHasher(keySchema), KeyEqualityChecker(keySchema)) {}
+        MapType entries;
+    };
+
+    static MapIterator &castToIter(IndexCursor& cursor) {
+        return cursor.m_keyIter.get<MapIterator>();
+    }
+
     ~CompactingHashUniqueIndex() {};
 
     bool addEntry(const TableTuple *tuple) {
@@ -78,6 +91,25 @@ class CompactingHashUniqueIndex : public TableIndex
         return m_entries.erase(setKeyFromTuple(tuple));
     }
 
+    void removeAllEntries() {
+        ++m_deletes;
+        m_entries.clear();
+    }
+
+    DetachedIndexEntries *detachAllEntries() {
+        ++m_deletes;
+        DetachedMap *detached = new DetachedMap(m_keySchema);
+        m_entries.swap(detached->entries);
+        return detached;
+    }
+
+    void reattachAllEntries(DetachedIndexEntries *entries) {
+        assert(m_entries.size() == 0);
+        DetachedMap *detached = static_cast<DetachedMap*>(entries);
+        m_entries.swap(detached->entries);
+        delete detached;
+    }
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -114,20 +146,25 @@ class CompactingHashUniqueIndex : public TableIndex
         return ! findTuple(*persistentTuple).isEnd();
     }
 
-    bool moveToKey(const TableTuple *searchKey) {
+    bool moveToKey(const TableTuple *searchKey, IndexCursor& cursor) {
         ++m_lookups;
-        m_keyIter = findKey(searchKey);
-        if (m_keyIter.isEnd()) {
-            m_match.move(NULL);
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter = findKey(searchKey);
+        if (mapIter.isEnd()) {
+            cursor.m_match.move(NULL);
             return false;
         }
-        m_match.move(const_cast<void*>(m_keyIter.value()));
+        cursor.m_match.move(const_cast<void*>(mapIter.value()));
         return true;
     }
 
-    TableTuple nextValueAtKey() {
-        TableTuple retval = m_match;
-        m_match.move(NULL);
+    void prefetchKey(const TableTuple *searchKey) {
+        m_entries.prefetch(KeyType(searchKey));
+    }
+
+    TableTuple nextValueAtKey(IndexCursor& cursor) {
+        TableTuple retval = cursor.m_match;
+        cursor.m_match.move(NULL);
         return retval;
     }
 
@@ -148,6 +185,8 @@ class CompactingHashUniqueIndex : public TableIndex
 
     size_t getSize() const { return m_entries.size(); }
 
+    void ensureCapacity(uint32_t capacity) { m_entries.reserve(capacity); }
+
     int64_t getMemoryEstimate() const
     {
         return m_entries.bytesAllocated();
@@ -179,18 +218,13 @@ class CompactingHashUniqueIndex : public TableIndex
 
     MapType m_entries;
 
-    // iteration stuff
-    MapIterator m_keyIter;
-    TableTuple m_match;
-
     // comparison stuff
    KeyEqualityChecker m_eq;
 
 public:
     CompactingHashUniqueIndex(const TupleSchema *keySchema, const TableIndexScheme &scheme) :
         TableIndex(keySchema, scheme),
-        m_entries(true, KeyHasher(keySchema), KeyEqualityChecker(keySchema)),
-        m_match(getTupleSchema()),
+        m_entries(KeyHasher(keySchema), KeyEqualityChecker(keySchema)),
         m_eq(keySchema)
     {}
 };
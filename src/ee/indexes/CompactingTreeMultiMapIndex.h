@@ -46,37 +46,100 @@
 #ifndef COMPACTINGTREEMULTIMAPINDEX_H_
 #define COMPACTINGTREEMULTIMAPINDEX_H_
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include <cassert>
+#include <boost/static_assert.hpp>
 #include "indexes/tableindex.h"
 #include "common/tabletuple.h"
+#include "common/ParallelSort.h"
 #include "structures/CompactingMap.h"
+#include "structures/CompactingBTree.h"
 
 namespace voltdb {
 
 /**
  * Index implemented as a Binary Tree Multimap.
+ * Map is the ordered container holding the entries: the red-black
+ * CompactingMap or the B+tree CompactingBTree.
  * @see TableIndex
  */
-template<typename KeyType, bool hasRank>
+template<typename KeyType, bool hasRank,
+         template<typename, typename, typename, bool> class Map = CompactingMap>
 class CompactingTreeMultiMapIndex : public TableIndex
 {
     typedef typename KeyType::KeyComparator KeyComparator;
-    typedef CompactingMap<KeyType, const void*, KeyComparator, hasRank> MapType;
+    typedef Map<KeyType, const void*, KeyComparator, hasRank> MapType;
     typedef typename MapType::iterator MapIterator;
     typedef std::pair<MapIterator, MapIterator> MapRange;
 
+    // the entries of a truncated table, kept until the truncate is undone or released
+    struct DetachedMap : public DetachedIndexEntries {
+        DetachedMap(const TupleSchema *keySchema) : entries(false, KeyComparator(keySchema)) {}
+        MapType entries;
+    };
+
     ~CompactingTreeMultiMapIndex() {};
 
+    static MapIterator &castToIter(IndexCursor& cursor) {
+        return cursor.m_keyIter.get<MapIterator>();
+    }
+
+    static MapIterator &castToEndIter(IndexCursor& cursor) {
+        return cursor.m_keyEndIter.get<MapIterator>();
+    }
+
+    static MapIterator &castToHint(IndexCursor& cursor) {
+        return cursor.m_probeHint.get<MapIterator>();
+    }
+
     bool addEntry(const TableTuple *tuple)
     {
         ++m_inserts;
+        ++m_version;
         return m_entries.insert(setKeyFromTuple(tuple), tuple->address());
     }
 
+    bool addEntriesInBulk(const std::vector<TableTuple> &tuples)
+    {
+        const int32_t count = static_cast<int32_t>(tuples.size());
+        std::vector<KeyType> keys;
+        keys.reserve(count);
+        std::vector<int32_t> order(count);
+        for (int32_t ii = 0; ii < count; ++ii) {
+            keys.push_back(setKeyFromTuple(&tuples[ii]));
+            order[ii] = ii;
+        }
+        // Sort positions rather than the keys themselves (see KeyPositionComparator),
+        // on several threads for a large table; equal keys stay in the order of the
+        // tuples, as one at a time inserts leave them. TupleKeys are compared by reading
+        // (or evaluating expressions on) their tuples, which only the site thread may do.
+        const int threads = KeyType::keyDependsOnTupleAddress() ? 1 : ParallelSort::threadsFor(count);
+        ParallelSort::sort(order, KeyPositionComparator<KeyType>(keys, m_cmp), threads);
+
+        m_inserts += count;
+        ++m_version;
+        if (m_entries.size() != 0) {
+            for (int32_t ii = 0; ii < count; ++ii) {
+                m_entries.insert(keys[order[ii]], tuples[order[ii]].address());
+            }
+            return true;
+        }
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(count);
+        for (int32_t ii = 0; ii < count; ++ii) {
+            entries.push_back(std::pair<KeyType, const void*>(keys[order[ii]],
+                                                               tuples[order[ii]].address()));
+        }
+        m_entries.bulkLoad(count == 0 ? NULL : &entries[0], count);
+        return true;
+    }
+
     bool deleteEntry(const TableTuple *tuple)
     {
         ++m_deletes;
+        ++m_version;
         MapIterator iter = findTuple(*tuple);
         if (iter.isEnd()) {
             return false;
@@ -84,6 +147,31 @@ class CompactingTreeMultiMapIndex : public TableIndex
         return m_entries.erase(iter);
     }
 
+    void removeAllEntries()
+    {
+        ++m_deletes;
+        ++m_version;
+        m_entries.clear();
+    }
+
+    DetachedIndexEntries *detachAllEntries()
+    {
+        ++m_deletes;
+        ++m_version;
+        DetachedMap *detached = new DetachedMap(m_keySchema);
+        m_entries.swap(detached->entries);
+        return detached;
+    }
+
+    void reattachAllEntries(DetachedIndexEntries *entries)
+    {
+        assert(m_entries.size() == 0);
+        ++m_version;
+        DetachedMap *detached = static_cast<DetachedMap*>(entries);
+        m_entries.swap(detached->entries);
+        delete detached;
+    }
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -121,123 +209,141 @@ class CompactingTreeMultiMapIndex : public TableIndex
         return ! findTuple(*persistentTuple).isEnd();
     }
 
-    bool moveToKey(const TableTuple *searchKey)
+    bool moveToKey(const TableTuple *searchKey, IndexCursor& cursor)
     {
         ++m_lookups;
-        m_forward = true;
-        MapRange iter_pair = m_entries.equalRange(KeyType(searchKey));
-        m_keyIter = iter_pair.first;
-        m_keyEndIter = iter_pair.second;
-        if (m_keyIter.equals(m_keyEndIter)) {
-            m_match.move(NULL);
+        cursor.m_forward = true;
+        MapIterator &mapIter = castToIter(cursor);
+        MapIterator &mapEndIter = castToEndIter(cursor);
+        MapIterator &hint = castToHint(cursor);
+        if (cursor.m_probeHintVersion != m_version) {
+            hint = MapIterator();
+            cursor.m_probeHintVersion = m_version;
+        }
+        MapRange iter_pair = m_entries.equalRange(KeyType(searchKey), hint);
+        mapIter = iter_pair.first;
+        mapEndIter = iter_pair.second;
+        hint = mapIter.isEnd() ? mapEndIter : mapIter;
+        if (mapIter.equals(mapEndIter)) {
+            cursor.m_match.move(NULL);
             return false;
         }
-        m_match.move(const_cast<void*>(m_keyIter.value()));
+        cursor.m_match.move(const_cast<void*>(mapIter.value()));
         return true;
     }
 
-    void moveToKeyOrGreater(const TableTuple *searchKey)
+    bool prefersOrderedProbes() const { return true; }
+
+    void moveToKeyOrGreater(const TableTuple *searchKey, IndexCursor& cursor)
     {
         ++m_lookups;
-        m_forward = true;
-        m_keyIter = m_entries.lowerBound(KeyType(searchKey));
+        cursor.m_forward = true;
+        castToIter(cursor) = m_entries.lowerBound(KeyType(searchKey));
     }
 
-    bool moveToGreaterThanKey(const TableTuple *searchKey)
+    bool moveToGreaterThanKey(const TableTuple *searchKey, IndexCursor& cursor)
     {
         ++m_lookups;
-        m_forward = true;
-        m_keyIter = m_entries.upperBound(KeyType(searchKey));
-        return m_keyIter.isEnd();
+        cursor.m_forward = true;
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter = m_entries.upperBound(KeyType(searchKey));
+        return mapIter.isEnd();
     }
 
-    void moveToLessThanKey(const TableTuple *searchKey)
+    void moveToLessThanKey(const TableTuple *searchKey, IndexCursor& cursor)
     {
         // do moveToKeyOrGreater()
         ++m_lookups;
-        m_keyIter = m_entries.lowerBound(KeyType(searchKey));
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter = m_entries.lowerBound(KeyType(searchKey));
         // find prev entry
-        if (m_keyIter.isEnd()) {
-            moveToEnd(false);
+        if (mapIter.isEnd()) {
+            moveToEnd(false, cursor);
         } else {
-            m_forward = false;
-            m_keyIter.movePrev();
+            cursor.m_forward = false;
+            mapIter.movePrev();
         }
     }
 
     // only be called after moveToGreaterThanKey() for LTE case
-    void moveToBeforePriorEntry()
+    void moveToBeforePriorEntry(IndexCursor& cursor)
     {
-        assert(m_forward);
-        m_forward = false;
-        if (m_keyIter.isEnd()) {
-            m_keyIter = m_entries.rbegin();
+        assert(cursor.m_forward);
+        cursor.m_forward = false;
+        MapIterator &mapIter = castToIter(cursor);
+        if (mapIter.isEnd()) {
+            mapIter = m_entries.rbegin();
         } else {
             // go back 2 entries
-            // entries: [..., A, B, C, ...], currently m_keyIter = C (not NULL if reach here)
+            // entries: [..., A, B, C, ...], currently mapIter = C (not NULL if reach here)
             // B is the entry we just evaluated and didn't pass initial_expression test (can not be NULL)
             // so A is the correct starting point (can be NULL)
-            m_keyIter.movePrev();
+            mapIter.movePrev();
         }
-        m_keyIter.movePrev();
+        mapIter.movePrev();
     }
 
-    void moveToEnd(bool begin)
+    void moveToEnd(bool begin, IndexCursor& cursor)
     {
         ++m_lookups;
-        m_forward = begin;
+        cursor.m_forward = begin;
+        MapIterator &mapIter = castToIter(cursor);
         if (begin)
-            m_keyIter = m_entries.begin();
+            mapIter = m_entries.begin();
         else
-            m_keyIter = m_entries.rbegin();
+            mapIter = m_entries.rbegin();
     }
 
-    TableTuple nextValue()
+    TableTuple nextValue(IndexCursor& cursor)
     {
         TableTuple retval(getTupleSchema());
+        MapIterator &mapIter = castToIter(cursor);
 
-        if (! m_keyIter.isEnd()) {
-            retval.move(const_cast<void*>(m_keyIter.value()));
-            if (m_forward) {
-                m_keyIter.moveNext();
+        if (! mapIter.isEnd()) {
+            retval.move(const_cast<void*>(mapIter.value()));
+            if (cursor.m_forward) {
+                mapIter.moveNext();
             } else {
-                m_keyIter.movePrev();
+                mapIter.movePrev();
             }
         }
 
         return retval;
     }
 
-    TableTuple nextValueAtKey()
+    TableTuple nextValueAtKey(IndexCursor& cursor)
     {
-        if (m_match.isNullTuple()) {
-            return m_match;
+        if (cursor.m_match.isNullTuple()) {
+            return cursor.m_match;
         }
-        TableTuple retval = m_match;
-        m_keyIter.moveNext();
-        if (m_keyIter.equals(m_keyEndIter)) {
-            m_match.move(NULL);
+        TableTuple retval = cursor.m_match;
+        MapIterator &mapIter = castToIter(cursor);
+        mapIter.moveNext();
+        if (mapIter.equals(castToEndIter(cursor))) {
+            cursor.m_match.move(NULL);
         } else {
-            m_match.move(const_cast<void*>(m_keyIter.value()));
+            cursor.m_match.move(const_cast<void*>(mapIter.value()));
         }
         return retval;
     }
 
-    bool advanceToNextKey()
+    bool advanceToNextKey(IndexCursor& cursor)
     {
-        if (m_keyEndIter.isEnd()) {
+        MapIterator &mapIter = castToIter(cursor);
+        MapIterator &mapEndIter = castToEndIter(cursor);
+        if (mapEndIter.isEnd()) {
             return false;
         }
         ++m_lookups;
-        m_forward = true;
-        MapRange iter_pair = m_entries.equalRange(m_keyEndIter.key());
-        m_keyEndIter = iter_pair.second;
-        m_keyIter = iter_pair.first;
-        if (m_keyIter.isEnd()) {
-            m_match.move(NULL);
+        cursor.m_forward = true;
+        MapRange iter_pair = m_entries.equalRange(mapEndIter.key());
+        mapEndIter = iter_pair.second;
+        mapIter = iter_pair.first;
+        if (mapIter.isEnd()) {
+            cursor.m_match.move(NULL);
             return false;
         }
-        m_match.move(const_cast<void*>(m_keyIter.value()));
+        cursor.m_match.move(const_cast<void*>(mapIter.value()));
         return true;
     }
 
@@ -253,14 +359,15 @@ class CompactingTreeMultiMapIndex : public TableIndex
         if (!hasRank) {
             return -1;
         }
-        CompactingTreeMultiMapIndex::moveToKeyOrGreater(searchKey);
-        if (m_keyIter.isEnd()) {
+        ++m_lookups;
+        MapIterator mapIter = m_entries.lowerBound(KeyType(searchKey));
+        if (mapIter.isEnd()) {
             return m_entries.size() + 1;
         }
         if (isUpper) {
-            return m_entries.rankUpper(m_keyIter.key());
+            return m_entries.rankUpper(mapIter.key());
         } else {
-            return m_entries.rankAsc(m_keyIter.key());
+            return m_entries.rankAsc(mapIter.key());
         }
     }
 
@@ -314,10 +421,9 @@ class CompactingTreeMultiMapIndex : public TableIndex
         return (ret);
     }
 
-    std::string getTypeName() const { return "CompactingTreeMultiMapIndex"; };
+    std::string getTypeName() const { return std::string(MapType::typeName()) + "MultiMapIndex"; };
 
     MapIterator findKey(const TableTuple *searchKey) {
-        m_keyEndIter = MapIterator();
         return m_entries.find(KeyType(searchKey));
     }
 
@@ -340,12 +446,9 @@ class CompactingTreeMultiMapIndex : public TableIndex
     }
 
     MapType m_entries;
-
-    // iteration stuff
-    bool m_forward;
-    MapIterator m_keyIter;
-    MapIterator m_keyEndIter;
-    TableTuple m_match;
+    // bumped by every change to the entries, so a cursor's probe hint
+    // from before the change is not used
+    int64_t m_version;
 
     // comparison stuff
     KeyComparator m_cmp;
@@ -354,8 +457,7 @@ public:
     CompactingTreeMultiMapIndex(const TupleSchema *keySchema, const TableIndexScheme &scheme) :
         TableIndex(keySchema, scheme),
         m_entries(false, KeyComparator(keySchema)),
-        m_forward(true),
-        m_match(getTupleSchema()),
+        m_version(0),
         m_cmp(keySchema)
     {}
 };
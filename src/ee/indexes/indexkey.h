@@ -761,5 +761,27 @@ private:
     const TupleSchema *m_keySchema;
 };
 
+/**
+ * Orders positions in an array of keys by their keys, and equal keys by
+ * position. Used to sort keys without copying them around, which would
+ * hand the storage of a GenericPersistentKey over from key to key.
+ */
+template <typename KeyType>
+struct KeyPositionComparator
+{
+    typedef typename KeyType::KeyComparator KeyComparator;
+
+    KeyPositionComparator(const std::vector<KeyType> &keys, const KeyComparator &cmp)
+        : m_keys(keys), m_cmp(cmp) {}
+
+    inline bool operator()(int32_t lhs, int32_t rhs) const {
+        int comparison = m_cmp(m_keys[lhs], m_keys[rhs]);
+        return comparison < 0 || (comparison == 0 && lhs < rhs);
+    }
+private:
+    const std::vector<KeyType> &m_keys;
+    const KeyComparator &m_cmp;
+};
+
 }
 #endif // INDEXKEY_H
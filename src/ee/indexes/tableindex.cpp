@@ -73,6 +73,22 @@ TableIndex::~TableIndex()
     }
 }
 
+bool TableIndex::addEntriesInBulk(const std::vector<TableTuple> &tuples)
+{
+    ensureCapacity(static_cast<uint32_t>(getSize() + tuples.size()));
+    for (size_t ii = 0; ii < tuples.size(); ++ii) {
+        if ( ! addEntry(&tuples[ii])) {
+            // take back the entries added so far
+            while (ii > 0) {
+                --ii;
+                deleteEntry(&tuples[ii]);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 std::string TableIndex::debug() const
 {
     std::ostringstream buffer;
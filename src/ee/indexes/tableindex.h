@@ -46,9 +46,14 @@
 #ifndef HSTORETABLEINDEX_H
 #define HSTORETABLEINDEX_H
 
+#include <cassert>
+#include <new>
 #include <vector>
 #include <string>
+#include "boost/aligned_storage.hpp"
 #include "boost/shared_ptr.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/type_traits/alignment_of.hpp"
 #include "boost/tuple/tuple.hpp"
 #include "common/ids.h"
 #include "common/types.h"
@@ -62,6 +67,109 @@ namespace voltdb {
 
 class AbstractExpression;
 
+/**
+ * Room for one container iterator, whose type depends on the index that
+ * uses it. The first get() default constructs the iterator in place, as an
+ * end iterator, and records how to copy and destroy it; an index must
+ * always ask a slot for the same iterator type.
+ */
+class IndexIteratorSlot {
+public:
+    static const size_t SIZE = 16;
+
+    IndexIteratorSlot() : m_copy(NULL), m_destroy(NULL) {}
+
+    IndexIteratorSlot(const IndexIteratorSlot &other) : m_copy(NULL), m_destroy(NULL) {
+        copyFrom(other);
+    }
+
+    IndexIteratorSlot &operator=(const IndexIteratorSlot &other) {
+        if (this != &other) {
+            destroy();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ~IndexIteratorSlot() {
+        destroy();
+    }
+
+    template <typename Iterator>
+    Iterator &get() {
+        BOOST_STATIC_ASSERT(sizeof(Iterator) <= SIZE);
+        BOOST_STATIC_ASSERT(boost::alignment_of<Iterator>::value <= ALIGNMENT);
+        if (m_destroy == NULL) {
+            new (m_storage.address()) Iterator();
+            m_copy = &copyAs<Iterator>;
+            m_destroy = &destroyAs<Iterator>;
+        }
+        assert(m_destroy == &destroyAs<Iterator>);
+        return *static_cast<Iterator*>(m_storage.address());
+    }
+
+private:
+    static const size_t ALIGNMENT = boost::alignment_of<void*>::value;
+
+    template <typename Iterator>
+    static void copyAs(void *to, const void *from) {
+        new (to) Iterator(*static_cast<const Iterator*>(from));
+    }
+
+    template <typename Iterator>
+    static void destroyAs(void *iterator) {
+        static_cast<Iterator*>(iterator)->~Iterator();
+    }
+
+    void copyFrom(const IndexIteratorSlot &other) {
+        if (other.m_copy != NULL) {
+            other.m_copy(m_storage.address(), other.m_storage.address());
+            m_copy = other.m_copy;
+            m_destroy = other.m_destroy;
+        }
+    }
+
+    void destroy() {
+        if (m_destroy != NULL) {
+            m_destroy(m_storage.address());
+            m_copy = NULL;
+            m_destroy = NULL;
+        }
+    }
+
+    boost::aligned_storage<SIZE, ALIGNMENT>::type m_storage;
+    void (*m_copy)(void *to, const void *from);
+    void (*m_destroy)(void *iterator);
+};
+
+/**
+ * The state of one scan of a TableIndex. The moveTo... methods position a
+ * cursor and the next... methods advance it, so any number of scans can be
+ * live on the same index at once, whether from different executors or
+ * from both sides of a self-join. A cursor belongs to the index that
+ * positioned it and, like any iterator, is invalidated by a change to the
+ * index; it must be positioned again before it is advanced.
+ */
+class IndexCursor {
+public:
+    IndexCursor(const TupleSchema *tupleSchema)
+        : m_forward(true),
+          m_match(tupleSchema),
+          m_probeHintVersion(0)
+    {
+    }
+
+    bool m_forward;
+    TableTuple m_match;
+    IndexIteratorSlot m_keyIter;
+    IndexIteratorSlot m_keyEndIter;
+    // where the last moveToKey() landed, for an index that can start the
+    // next lookup from there; only used while the index has not changed
+    // since, as told by its version
+    IndexIteratorSlot m_probeHint;
+    int64_t m_probeHintVersion;
+};
+
 /**
  * Parameter for constructing TableIndex. TupleSchema, then key schema
  */
@@ -153,6 +261,15 @@ struct TableIndexScheme {
     const TupleSchema *tupleSchema;
 };
 
+/**
+ * The entries of an index, set aside by TableIndex::detachAllEntries.
+ * Deleting it frees them.
+ */
+class DetachedIndexEntries {
+public:
+    virtual ~DetachedIndexEntries() {}
+};
+
 /**
  * voltdb::TableIndex class represents a secondary index on a table which
  * is currently implemented as a binary tree (std::map) mapping from key value
@@ -192,12 +309,36 @@ public:
      */
     virtual bool addEntry(const TableTuple *tuple) = 0;
 
+    /**
+     * adds an index entry for each of the tuples, as addEntry would one
+     * tuple at a time. A unique index returns false, left as it was, if
+     * any of the keys is already in the index or shared by two of the
+     * tuples. The default just calls addEntry for each tuple in turn.
+     */
+    virtual bool addEntriesInBulk(const std::vector<TableTuple> &tuples);
+
     /**
      * removes the index entry linked to given value (and tuple
      * pointer, if it's non-unique index).
      */
     virtual bool deleteEntry(const TableTuple *tuple) = 0;
 
+    /**
+     * removes every index entry at once, as when the table is truncated.
+     */
+    virtual void removeAllEntries() = 0;
+
+    /**
+     * moves every index entry out at once, leaving the index empty, as
+     * when the table is truncated.
+     */
+    virtual DetachedIndexEntries *detachAllEntries() = 0;
+
+    /**
+     * puts detached entries back into the empty index and frees the holder.
+     */
+    virtual void reattachAllEntries(DetachedIndexEntries *entries) = 0;
+
     /**
      * Update in place an index entry with a new tuple address
      */
@@ -217,10 +358,10 @@ public:
     virtual bool exists(const TableTuple* values) = 0;
 
     /**
-     * This method moves to the first tuple equal to given key.  To
-     * iterate through all entries with the key (if non-unique index)
-     * or all entries that follow the entry, use nextValueAtKey() and
-     * advanceToNextKey().
+     * This method moves the cursor to the first tuple equal to given
+     * key.  To iterate through all entries with the key (if non-unique
+     * index) or all entries that follow the entry, use nextValueAtKey()
+     * and advanceToNextKey().
      *
      * This method can be used <b>only for perfect matching</b> in
      * which the whole search key matches with at least one entry in
@@ -235,14 +376,29 @@ public:
      * data, but chosen values for this index. So, searchKey has to
      * contain values in this index's entry order.
      *
-     * @see moveToKeyOrGreater(const TableTuple *)
+     * @see moveToKeyOrGreater(const TableTuple *, IndexCursor&)
      * @return true if the value is found. false if not.
      */
-    virtual bool moveToKey(const TableTuple *searchKey) = 0;
+    virtual bool moveToKey(const TableTuple *searchKey, IndexCursor& cursor) = 0;
+
+    /**
+     * Hint that moveToKey() will soon be called with searchKey, so the
+     * index can start loading the memory that lookup reads. A caller
+     * probing many keys issues this a few keys ahead of each probe.
+     * The default does nothing.
+     */
+    virtual void prefetchKey(const TableTuple *searchKey) {}
+
+    /**
+     * @return true if a run of moveToKey() calls is cheaper when the
+     * search keys come in key order, so a caller with a batch of keys to
+     * probe should sort them first.
+     */
+    virtual bool prefersOrderedProbes() const { return false; }
 
     /**
-     * This method moves to the first tuple equal or greater than
-     * given key.  Use this with nextValue(). This method works for
+     * This method moves the cursor to the first tuple equal or greater
+     * than given key.  Use this with nextValue(). This method works for
      * partial index search where following value might not match with
      * any entry in this index.
      *
@@ -250,41 +406,43 @@ public:
      *      data, but chosen values for this index.  So, searchKey has
      *      to contain values in this index's entry order.
      */
-    virtual void moveToKeyOrGreater(const TableTuple *searchKey)
+    virtual void moveToKeyOrGreater(const TableTuple *searchKey, IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method moveToKeyOrGreater which has no implementation");
     };
 
     /**
-     * This method moves to the first tuple greater than given key.
+     * This method moves the cursor to the first tuple greater than given
+     * key.
      * Use this with nextValue().
      *
      * @see searchKey the value to be searched. this is NOT tuple
      *      data, but chosen values for this index.  So, searchKey has
      *      to contain values in this index's entry order.
      */
-    virtual bool moveToGreaterThanKey(const TableTuple *searchKey)
+    virtual bool moveToGreaterThanKey(const TableTuple *searchKey, IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method moveToGreaterThanKey which has no implementation");
     };
 
-    virtual void moveToLessThanKey(const TableTuple *searchKey)
+    virtual void moveToLessThanKey(const TableTuple *searchKey, IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method moveToLessThanKey which has no implementation");
     };
 
-    virtual void moveToBeforePriorEntry()
+    virtual void moveToBeforePriorEntry(IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method moveToBeforePriorEntry which has no implementation");
     }
 
     /**
-     * This method moves to the beginning or the end of the indexes.
+     * This method moves the cursor to the beginning or the end of the
+     * indexes.
      * Use this with nextValue().
      *
      * @see begin true to move to the beginning, false to the end.
      */
-    virtual void moveToEnd(bool begin)
+    virtual void moveToEnd(bool begin, IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method moveToEnd which has no implementation");
     }
@@ -297,7 +455,7 @@ public:
      * @return true if any entry to return, false if reached the end
      * of this index.
      */
-    virtual TableTuple nextValue()
+    virtual TableTuple nextValue(IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method nextValue which has no implementation");
     };
@@ -309,7 +467,7 @@ public:
      *
      * @return true if any entry to return, false if not.
      */
-    virtual TableTuple nextValueAtKey() = 0;
+    virtual TableTuple nextValueAtKey(IndexCursor& cursor) = 0;
 
     /**
      * sets the tuple to point the entry next to the one found by
@@ -325,7 +483,7 @@ public:
      *
      * @return true if any entry to return, false if not.
      */
-    virtual bool advanceToNextKey()
+    virtual bool advanceToNextKey(IndexCursor& cursor)
     {
         throwFatalException("Invoked TableIndex virtual method advanceToNextKey which has no implementation");
     };
@@ -455,12 +613,13 @@ public:
 
     virtual voltdb::IndexStats* getIndexStats();
 
-protected:
     const TupleSchema *getTupleSchema() const
     {
         return m_scheme.tupleSchema;
     }
 
+protected:
+
     TableIndex(const TupleSchema *keySchema, const TableIndexScheme &scheme);
 
     TableIndexScheme m_scheme;
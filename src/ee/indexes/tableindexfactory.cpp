@@ -64,17 +64,27 @@ class TableIndexPicker
     template <class TKeyType>
     TableIndex *getInstanceForKeyType() const
     {
-           if (m_scheme.unique) {
-            if (m_type != BALANCED_TREE_INDEX) {
+        if (m_scheme.unique) {
+            if (m_type == HASH_TABLE_INDEX) {
                 return new CompactingHashUniqueIndex<TKeyType >(m_keySchema, m_scheme);
+            } else if (m_type == BTREE_INDEX) {
+                if (m_scheme.countable) {
+                    return new CompactingTreeUniqueIndex<TKeyType, true, CompactingBTree>(m_keySchema, m_scheme);
+                }
+                return new CompactingTreeUniqueIndex<TKeyType, false, CompactingBTree>(m_keySchema, m_scheme);
             } else if (m_scheme.countable) {
                 return new CompactingTreeUniqueIndex<TKeyType, true>(m_keySchema, m_scheme);
             } else {
                 return new CompactingTreeUniqueIndex<TKeyType, false>(m_keySchema, m_scheme);
             }
         } else {
-            if (m_type != BALANCED_TREE_INDEX) {
+            if (m_type == HASH_TABLE_INDEX) {
                 return new CompactingHashMultiMapIndex<TKeyType >(m_keySchema, m_scheme);
+            } else if (m_type == BTREE_INDEX) {
+                if (m_scheme.countable) {
+                    return new CompactingTreeMultiMapIndex<TKeyType, true, CompactingBTree>(m_keySchema, m_scheme);
+                }
+                return new CompactingTreeMultiMapIndex<TKeyType, false, CompactingBTree>(m_keySchema, m_scheme);
             } else if (m_scheme.countable) {
                 return new CompactingTreeMultiMapIndex<TKeyType, true>(m_keySchema, m_scheme);
             } else {
@@ -109,6 +119,14 @@ class TableIndexPicker
         if (m_inlinesOrColumnsOnly) {
             return getInstanceForKeyType<GenericKey<KeySize> >();
         }
+        // B+tree separators are copies of keys, which GenericPersistentKey
+        // can not provide without transferring ownership of its storage.
+        if (m_type == BTREE_INDEX) {
+            VOLT_INFO("Producing a red-black tree index for %s: "
+                      "B+tree index not currently supported for this index key.\n",
+                      m_scheme.name.c_str());
+            m_type = BALANCED_TREE_INDEX;
+        }
         return getInstanceForKeyType<GenericPersistentKey<KeySize> >();
     }
 
@@ -181,6 +199,20 @@ public:
             return result;
         }
 
+        if (m_type == BTREE_INDEX) {
+            if (m_scheme.unique) {
+                if (m_scheme.countable) {
+                    return new CompactingTreeUniqueIndex<TupleKey, true, CompactingBTree>(m_keySchema, m_scheme);
+                } else {
+                    return new CompactingTreeUniqueIndex<TupleKey, false, CompactingBTree>(m_keySchema, m_scheme);
+                }
+            }
+            if (m_scheme.countable) {
+                return new CompactingTreeMultiMapIndex<TupleKey, true, CompactingBTree>(m_keySchema, m_scheme);
+            } else {
+                return new CompactingTreeMultiMapIndex<TupleKey, false, CompactingBTree>(m_keySchema, m_scheme);
+            }
+        }
         if (m_scheme.unique) {
             if (m_scheme.countable) {
                 return new CompactingTreeUniqueIndex<TupleKey, true >(m_keySchema, m_scheme);
@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hashjoinnode.h"
+
+#include "common/SerializableEEException.h"
+#include "expressions/abstractexpression.h"
+#include "storage/table.h"
+
+#include <sstream>
+
+using namespace std;
+using namespace voltdb;
+
+HashJoinPlanNode::HashJoinPlanNode(CatalogId id)
+  : AbstractJoinPlanNode(id)
+{
+    // Do nothing
+}
+
+HashJoinPlanNode::HashJoinPlanNode()
+  : AbstractJoinPlanNode()
+{
+    // Do nothing
+}
+
+HashJoinPlanNode::~HashJoinPlanNode()
+{
+    for (int ii = 0; ii < m_outerHashExpressions.size(); ii++) {
+        delete m_outerHashExpressions[ii];
+    }
+    for (int ii = 0; ii < m_innerHashExpressions.size(); ii++) {
+        delete m_innerHashExpressions[ii];
+    }
+    // must delete the output table that was created in the
+    // executor (and stored here in the plannode).
+    delete getOutputTable();
+}
+
+PlanNodeType
+HashJoinPlanNode::getPlanNodeType() const
+{
+    return PLAN_NODE_TYPE_HASHJOIN;
+}
+
+string HashJoinPlanNode::debugInfo(const string& spacer) const
+{
+    ostringstream buffer;
+    buffer << AbstractJoinPlanNode::debugInfo(spacer);
+    for (int ii = 0; ii < m_outerHashExpressions.size(); ii++) {
+        buffer << spacer << "Hash Key " << ii << " Outer\n";
+        buffer << m_outerHashExpressions[ii]->debug(spacer);
+        buffer << spacer << "Hash Key " << ii << " Inner\n";
+        buffer << m_innerHashExpressions[ii]->debug(spacer);
+    }
+    return (buffer.str());
+}
+
+void
+HashJoinPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AbstractJoinPlanNode::loadFromJSONObject(obj);
+
+    PlannerDomValue outerExprArray = obj.valueForKey("OUTER_HASH_EXPRESSIONS");
+    for (int i = 0; i < outerExprArray.arrayLen(); i++) {
+        AbstractExpression *expr = AbstractExpression::buildExpressionTree(outerExprArray.valueAtIndex(i));
+        m_outerHashExpressions.push_back(expr);
+    }
+    PlannerDomValue innerExprArray = obj.valueForKey("INNER_HASH_EXPRESSIONS");
+    for (int i = 0; i < innerExprArray.arrayLen(); i++) {
+        AbstractExpression *expr = AbstractExpression::buildExpressionTree(innerExprArray.valueAtIndex(i));
+        m_innerHashExpressions.push_back(expr);
+    }
+    if (m_outerHashExpressions.size() != m_innerHashExpressions.size() ||
+        m_outerHashExpressions.empty()) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "HashJoinPlanNode::loadFromJSONObject:"
+                                      " Does not have matching outer and inner hash expressions.");
+    }
+}
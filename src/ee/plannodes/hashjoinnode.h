@@ -0,0 +1,64 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREHASHJOINNODE_H
+#define HSTOREHASHJOINNODE_H
+
+#include "abstractjoinnode.h"
+
+#include <vector>
+
+namespace voltdb
+{
+
+/**
+ * An equi-join of two input tables. The executor builds a hash table
+ * on the join keys of one input and probes it with the other.
+ *
+ * The i-th outer hash expression is joined by equality with the i-th
+ * inner hash expression. The join predicate still holds all of the
+ * inner-outer join conditions, including those equalities, and is
+ * applied to every pair of tuples whose keys hash together.
+ */
+class HashJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    HashJoinPlanNode(CatalogId id);
+    HashJoinPlanNode();
+    ~HashJoinPlanNode();
+
+    virtual PlanNodeType getPlanNodeType() const;
+
+    const std::vector<AbstractExpression*>& getOuterHashExpressions() const
+    { return m_outerHashExpressions; }
+
+    const std::vector<AbstractExpression*>& getInnerHashExpressions() const
+    { return m_innerHashExpressions; }
+
+    std::string debugInfo(const std::string& spacer) const;
+
+protected:
+    virtual void loadFromJSONObject(PlannerDomValue obj);
+
+    // join keys evaluated over the outer and inner tuples, pairwise equal
+    std::vector<AbstractExpression*> m_outerHashExpressions;
+    std::vector<AbstractExpression*> m_innerHashExpressions;
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mergejoinnode.h"
+
+#include "common/SerializableEEException.h"
+#include "expressions/abstractexpression.h"
+#include "storage/table.h"
+
+#include <sstream>
+
+using namespace std;
+using namespace voltdb;
+
+MergeJoinPlanNode::MergeJoinPlanNode(CatalogId id)
+  : AbstractJoinPlanNode(id)
+{
+    // Do nothing
+}
+
+MergeJoinPlanNode::MergeJoinPlanNode()
+  : AbstractJoinPlanNode()
+{
+    // Do nothing
+}
+
+MergeJoinPlanNode::~MergeJoinPlanNode()
+{
+    for (int ii = 0; ii < m_outerMergeExpressions.size(); ii++) {
+        delete m_outerMergeExpressions[ii];
+    }
+    for (int ii = 0; ii < m_innerMergeExpressions.size(); ii++) {
+        delete m_innerMergeExpressions[ii];
+    }
+    // must delete the output table that was created in the
+    // executor (and stored here in the plannode).
+    delete getOutputTable();
+}
+
+PlanNodeType
+MergeJoinPlanNode::getPlanNodeType() const
+{
+    return PLAN_NODE_TYPE_MERGEJOIN;
+}
+
+string MergeJoinPlanNode::debugInfo(const string& spacer) const
+{
+    ostringstream buffer;
+    buffer << AbstractJoinPlanNode::debugInfo(spacer);
+    for (int ii = 0; ii < m_outerMergeExpressions.size(); ii++) {
+        buffer << spacer << "Merge Key " << ii << " Outer\n";
+        buffer << m_outerMergeExpressions[ii]->debug(spacer);
+        buffer << spacer << "Merge Key " << ii << " Inner\n";
+        buffer << m_innerMergeExpressions[ii]->debug(spacer);
+    }
+    return (buffer.str());
+}
+
+void
+MergeJoinPlanNode::loadFromJSONObject(PlannerDomValue obj)
+{
+    AbstractJoinPlanNode::loadFromJSONObject(obj);
+
+    PlannerDomValue outerExprArray = obj.valueForKey("OUTER_MERGE_EXPRESSIONS");
+    for (int i = 0; i < outerExprArray.arrayLen(); i++) {
+        AbstractExpression *expr = AbstractExpression::buildExpressionTree(outerExprArray.valueAtIndex(i));
+        m_outerMergeExpressions.push_back(expr);
+    }
+    PlannerDomValue innerExprArray = obj.valueForKey("INNER_MERGE_EXPRESSIONS");
+    for (int i = 0; i < innerExprArray.arrayLen(); i++) {
+        AbstractExpression *expr = AbstractExpression::buildExpressionTree(innerExprArray.valueAtIndex(i));
+        m_innerMergeExpressions.push_back(expr);
+    }
+    if (m_outerMergeExpressions.size() != m_innerMergeExpressions.size() ||
+        m_outerMergeExpressions.empty()) {
+        throw SerializableEEException(VOLT_EE_EXCEPTION_TYPE_EEEXCEPTION,
+                                      "MergeJoinPlanNode::loadFromJSONObject:"
+                                      " Does not have matching outer and inner merge expressions.");
+    }
+}
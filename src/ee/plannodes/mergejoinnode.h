@@ -0,0 +1,65 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSTOREMERGEJOINNODE_H
+#define HSTOREMERGEJOINNODE_H
+
+#include "abstractjoinnode.h"
+
+#include <vector>
+
+namespace voltdb
+{
+
+/**
+ * An equi-join of two input tables that both arrive sorted, ascending,
+ * on their merge keys. The executor reads them in step and only rescans
+ * the inner tuples of one key at a time.
+ *
+ * The i-th outer merge expression is joined by equality with the i-th
+ * inner merge expression, and the inputs are sorted on the keys in that
+ * order. The join predicate still holds all of the inner-outer join
+ * conditions, including those equalities.
+ */
+class MergeJoinPlanNode : public AbstractJoinPlanNode
+{
+public:
+    MergeJoinPlanNode(CatalogId id);
+    MergeJoinPlanNode();
+    ~MergeJoinPlanNode();
+
+    virtual PlanNodeType getPlanNodeType() const;
+
+    const std::vector<AbstractExpression*>& getOuterMergeExpressions() const
+    { return m_outerMergeExpressions; }
+
+    const std::vector<AbstractExpression*>& getInnerMergeExpressions() const
+    { return m_innerMergeExpressions; }
+
+    std::string debugInfo(const std::string& spacer) const;
+
+protected:
+    virtual void loadFromJSONObject(PlannerDomValue obj);
+
+    // sort keys of the outer and inner tuples, pairwise equal
+    std::vector<AbstractExpression*> m_outerMergeExpressions;
+    std::vector<AbstractExpression*> m_innerMergeExpressions;
+};
+
+}
+
+#endif
@@ -50,6 +50,7 @@
 #include "plannodes/aggregatenode.h"
 #include "plannodes/deletenode.h"
 #include "plannodes/distinctnode.h"
+#include "plannodes/hashjoinnode.h"
 #include "plannodes/indexscannode.h"
 #include "plannodes/indexcountnode.h"
 #include "plannodes/tablecountnode.h"
@@ -57,6 +58,7 @@
 #include "plannodes/limitnode.h"
 #include "plannodes/materializenode.h"
 #include "plannodes/materializedscanplannode.h"
+#include "plannodes/mergejoinnode.h"
 #include "plannodes/nestloopnode.h"
 #include "plannodes/nestloopindexnode.h"
 #include "plannodes/projectionnode.h"
@@ -122,6 +124,18 @@ voltdb::AbstractPlanNode* getEmptyPlanNode(voltdb::PlanNodeType type) {
             ret = new voltdb::NestLoopIndexPlanNode();
             break;
         // ------------------------------------------------------------------
+        // HashJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_HASHJOIN):
+            ret = new voltdb::HashJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
+        // MergeJoin
+        // ------------------------------------------------------------------
+        case (voltdb::PLAN_NODE_TYPE_MERGEJOIN):
+            ret = new voltdb::MergeJoinPlanNode();
+            break;
+        // ------------------------------------------------------------------
         // Update
         // ------------------------------------------------------------------
         case (voltdb::PLAN_NODE_TYPE_UPDATE):
@@ -62,6 +62,7 @@ UnionPlanNode::~UnionPlanNode() {
 std::string UnionPlanNode::debugInfo(const std::string &spacer) const {
     ostringstream buffer;
     buffer << spacer << "UnionType[" << m_unionType << "]\n";
+    buffer << spacer << "SortedInputs[" << m_sortedInputs << "]\n";
     return string(buffer.str());
 }
 
@@ -88,6 +89,7 @@ void UnionPlanNode::loadFromJSONObject(PlannerDomValue obj)
                                       " Unsupported UNION_TYPE value " +
                                       unionTypeStr);
     }
+    m_sortedInputs = obj.hasNonNullKey("SORTED_INPUTS") && obj.valueForKey("SORTED_INPUTS").asBool();
 }
 
 }
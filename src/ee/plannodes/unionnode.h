@@ -55,10 +55,11 @@ namespace voltdb {
  */
 class UnionPlanNode : public AbstractPlanNode {
     public:
-        UnionPlanNode(CatalogId id) : AbstractPlanNode(id), m_unionType(UNION_TYPE_NOUNION) {
+        UnionPlanNode(CatalogId id) : AbstractPlanNode(id), m_unionType(UNION_TYPE_NOUNION),
+            m_sortedInputs(false) {
             // Do nothing
         }
-        UnionPlanNode() : AbstractPlanNode(), m_unionType(UNION_TYPE_NOUNION) {
+        UnionPlanNode() : AbstractPlanNode(), m_unionType(UNION_TYPE_NOUNION), m_sortedInputs(false) {
             // Do nothing
         }
         ~UnionPlanNode();
@@ -67,6 +68,12 @@ class UnionPlanNode : public AbstractPlanNode {
 
         UnionType getUnionType() const { return m_unionType; }
 
+        /**
+         * Whether the planner expects every input to arrive sorted on all
+         * of its columns, so that the set operation can merge the inputs.
+         */
+        bool hasSortedInputs() const { return m_sortedInputs; }
+
         std::string debugInfo(const std::string &spacer) const;
 
     protected:
@@ -74,6 +81,7 @@ class UnionPlanNode : public AbstractPlanNode {
 
     private:
        UnionType m_unionType;
+       bool m_sortedInputs;
 };
 
 }
@@ -19,6 +19,8 @@
 #include "common/ids.h"
 #include "common/tabletuple.h"
 #include "common/TupleSchema.h"
+#include "common/ThreadLocalPoolStats.h"
+#include "execution/PlanCacheStats.h"
 #include "storage/PersistentTableStats.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
@@ -49,6 +51,14 @@ namespace
             {
                 return IndexStats::generateEmptyIndexStatsTable();
             }
+        case STATISTICS_SELECTOR_TYPE_MEMORY:
+            {
+                return ThreadLocalPoolStats::generateEmptyPoolStatsTable();
+            }
+        case STATISTICS_SELECTOR_TYPE_PLAN_CACHE:
+            {
+                return PlanCacheStats::generateEmptyPlanCacheStatsTable();
+            }
         default:
             {
                 throwFatalException("Attempted to get unsupported stats type");
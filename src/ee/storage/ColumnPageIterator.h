@@ -0,0 +1,106 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLUMNPAGEITERATOR_H_
+#define COLUMNPAGEITERATOR_H_
+
+#include <cassert>
+#include <stdint.h>
+#include "common/tabletuple.h"
+#include "storage/persistenttable.h"
+#include "storage/TupleBlock.h"
+
+namespace voltdb {
+
+/**
+ * Iterates a table with column pages (see PersistentTable::enableColumnPages)
+ * a run of tuple slots at a time. Which tuples are visible comes from the
+ * pages' bitmap, and the tuples handed out are only pointed at their
+ * storage, so a scan whose predicate can be evaluated from the column
+ * pages reads no tuple until one qualifies.
+ *
+ * The table must not change while it is iterated.
+ */
+class ColumnPageIterator {
+public:
+    ColumnPageIterator(PersistentTable *table)
+        : m_table(table),
+          m_schema(table->schema()),
+          m_blockIterator(table->m_data.begin()),
+          m_pages(NULL),
+          m_slot(0)
+    {
+        assert(table->hasColumnPages());
+    }
+
+    /**
+     * Move to the next run of at most maxCount slots of one block. For the
+     * i-th visible slot of the run, tuples[i] is pointed at its tuple and i
+     * is added to selection, in ascending order; count is set to the number
+     * of visible slots, which may be 0. For each column with a page,
+     * columns[c] is set to the address of the run's first value in the
+     * page, and to NULL for the other columns.
+     * @return false once every block has been iterated.
+     */
+    bool next(TableTuple *tuples, int *selection, int &count,
+              const char **columns, int maxCount) {
+        while (m_block.get() == NULL || m_slot >= m_block->unusedTupleBoundry()) {
+            if (m_blockIterator == m_table->m_data.end()) {
+                return false;
+            }
+            m_block = m_blockIterator.data();
+            ++m_blockIterator;
+            m_pages = m_table->refreshColumnPages(m_block);
+            m_slot = 0;
+        }
+
+        const uint32_t tupleLength = m_table->m_tupleLength;
+        uint32_t end = m_slot + maxCount;
+        if (end > m_block->unusedTupleBoundry()) {
+            end = m_block->unusedTupleBoundry();
+        }
+        const uint64_t *visible = reinterpret_cast<const uint64_t*>(m_pages);
+        char *address = m_block->address() + m_slot * tupleLength;
+        count = 0;
+        for (uint32_t slot = m_slot; slot < end; ++slot, address += tupleLength) {
+            if (visible[slot >> 6] & (static_cast<uint64_t>(1) << (slot & 63))) {
+                const int index = static_cast<int>(slot - m_slot);
+                tuples[index] = TableTuple(address, m_schema);
+                selection[count++] = index;
+            }
+        }
+
+        for (int i = 0; i < m_schema->columnCount(); ++i) {
+            const int32_t offset = m_table->columnPageOffset(i);
+            columns[i] = offset < 0 ? NULL :
+                m_pages + offset + m_slot * NValue::getTupleStorageSize(m_schema->columnType(i));
+        }
+        m_slot = end;
+        return true;
+    }
+
+private:
+    PersistentTable *m_table;
+    const TupleSchema *m_schema;
+    TBMapI m_blockIterator;
+    TBPtr m_block;
+    const char *m_pages;
+    uint32_t m_slot;
+};
+
+}
+
+#endif /* COLUMNPAGEITERATOR_H_ */
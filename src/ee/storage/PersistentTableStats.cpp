@@ -16,13 +16,17 @@
  */
 #include "storage/PersistentTableStats.h"
 #include "storage/persistenttable.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
 #include <vector>
 #include <string>
 
 namespace voltdb {
 
 PersistentTableStats::PersistentTableStats(voltdb::PersistentTable* table)
-  : voltdb::TableStats(table)
+  : voltdb::TableStats(table), m_persistentTable(table),
+    m_lastCompactionBlocksMerged(0), m_lastCompactionTuplesMoved(0),
+    m_lastCompactionMicros(0), m_lastStringDictionarySavings(0)
 {
 }
 
@@ -30,4 +34,40 @@ std::vector<std::string> PersistentTableStats::generateStatsColumnNames() {
     std::vector<std::string> columnNames = TableStats::generateStatsColumnNames();
     return columnNames;
 }
+
+void PersistentTableStats::updateStatsTuple(TableTuple *tuple) {
+    TableStats::updateStatsTuple(tuple);
+    int64_t blocksMerged = m_persistentTable->compactionBlocksMerged();
+    int64_t tuplesMoved = m_persistentTable->compactionTuplesMoved();
+    int64_t micros = m_persistentTable->compactionMicros();
+    const int64_t dictionarySavings = m_persistentTable->stringDictionaryBytesSaved();
+    int64_t dictionary_savings_kb = dictionarySavings / 1024;
+
+    if (interval()) {
+        blocksMerged -= m_lastCompactionBlocksMerged;
+        m_lastCompactionBlocksMerged = m_persistentTable->compactionBlocksMerged();
+        tuplesMoved -= m_lastCompactionTuplesMoved;
+        m_lastCompactionTuplesMoved = m_persistentTable->compactionTuplesMoved();
+        micros -= m_lastCompactionMicros;
+        m_lastCompactionMicros = m_persistentTable->compactionMicros();
+        dictionary_savings_kb -= m_lastStringDictionarySavings / 1024;
+        m_lastStringDictionarySavings = dictionarySavings;
+    }
+
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_BLOCKS_MERGED"],
+                     ValueFactory::getBigIntValue(blocksMerged));
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_TUPLES_MOVED"],
+                     ValueFactory::getBigIntValue(tuplesMoved));
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_MICROS"],
+                     ValueFactory::getBigIntValue(micros));
+    tuple->setNValue(StatsSource::m_columnName2Index["STRING_DICTIONARY_SAVINGS"],
+                     ValueFactory::getIntegerValue(static_cast<int32_t>(dictionary_savings_kb)));
+}
+
+/*
+ * The strings the table's dictionaries share are only counted once.
+ */
+int64_t PersistentTableStats::stringDataMemory() const {
+    return m_persistentTable->nonInlinedMemorySize() - m_persistentTable->stringDictionaryBytesSaved();
+}
 }
@@ -26,13 +26,26 @@ namespace voltdb {
 class PersistentTable;
 
 /**
- * Further specialization of TableStats that currently adds no extra functionality.
+ * Further specialization of TableStats that fills in the work done
+ * compacting the table and the memory its string dictionaries save.
  */
 class PersistentTableStats : public voltdb::TableStats {
   public:
     PersistentTableStats(voltdb::PersistentTable* table);
   protected:
     virtual std::vector<std::string> generateStatsColumnNames();
+
+    virtual void updateStatsTuple(voltdb::TableTuple *tuple);
+
+    virtual int64_t stringDataMemory() const;
+
+  private:
+    voltdb::PersistentTable *m_persistentTable;
+
+    int64_t m_lastCompactionBlocksMerged;
+    int64_t m_lastCompactionTuplesMoved;
+    int64_t m_lastCompactionMicros;
+    int64_t m_lastStringDictionarySavings;
 };
 
 }
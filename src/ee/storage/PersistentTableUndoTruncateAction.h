@@ -0,0 +1,69 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PERSISTENTTABLEUNDOTRUNCATEACTION_H_
+#define PERSISTENTTABLEUNDOTRUNCATEACTION_H_
+
+#include "common/UndoAction.h"
+#include "storage/persistenttable.h"
+
+namespace voltdb {
+
+
+class PersistentTableUndoTruncateAction: public UndoAction {
+public:
+    inline PersistentTableUndoTruncateAction(PersistentTableSurgeon *table)
+        : m_table(table), m_tupleCount(0), m_nonInlinedMemorySize(0)
+    {}
+
+    /*
+     * Take over every block of the table along with its tuple accounting,
+     * and the entries of its indexes.
+     */
+    void detachBlocksAndIndexEntries() {
+        m_table->detachAllIndexEntries(m_indexEntries);
+        m_table->detachAllBlocks(m_blocks, m_tupleCount, m_nonInlinedMemorySize);
+    }
+
+private:
+    virtual ~PersistentTableUndoTruncateAction() { }
+
+    /*
+     * Undo whatever this undo action was created to undo. In this case hand
+     * the blocks and index entries back to the table.
+     */
+    virtual void undo() {
+        m_table->truncateTableForUndo(m_blocks, m_indexEntries, m_tupleCount, m_nonInlinedMemorySize);
+    }
+
+    /*
+     * Release any resources held by the undo action. It will not need to be undone in the future.
+     * In this case free the index entries, the strings of the truncated tuples
+     * and the blocks holding them.
+     */
+    virtual void release() { m_table->truncateTableRelease(m_blocks, m_indexEntries); }
+
+private:
+    PersistentTableSurgeon *m_table;
+    TBMap m_blocks;
+    std::vector<DetachedIndexEntries*> m_indexEntries;
+    uint32_t m_tupleCount;
+    int64_t m_nonInlinedMemorySize;
+};
+
+}
+
+#endif /* PERSISTENTTABLEUNDOTRUNCATEACTION_H_ */
@@ -158,6 +158,9 @@ getIndexIdFromMap(TableIndexType type, bool countable, bool isUnique,
         case HASH_TABLE_INDEX:
             retval += "H";
             break;
+        case BTREE_INDEX:
+            retval += "T";
+            break;
         default:
             // this would need to change if we added index types
             assert(false);
@@ -360,7 +363,20 @@ Table *TableCatalogDelegate::constructTableFromCatalog(catalog::Database const &
     Table *table = TableFactory::getPersistentTable(databaseId, tableName,
                                                     schema, columnNames,
                                                     partitionColumnIndex, exportEnabled,
-                                                    tableIsExportOnly);
+                                                    tableIsExportOnly, 0,
+                                                    catalogTable.columnpages());
+
+    // dictionary encode the columns declared so while the table is empty
+    if (!tableIsExportOnly) {
+        for (col_iterator = catalogTable.columns().begin();
+             col_iterator != catalogTable.columns().end();
+             col_iterator++)
+        {
+            if (col_iterator->second->dictionaryencoded()) {
+                static_cast<PersistentTable*>(table)->enableStringDictionary(col_iterator->second->index());
+            }
+        }
+    }
 
     // add a pkey index if one exists
     if (pkey_index_id.size() != 0) {
@@ -587,8 +603,8 @@ TableCatalogDelegate::migrateChangedTuples(catalog::Table const &catalogTable,
                 }
             }
 
-            // insert into the new table
-            newTable->insertPersistentTuple(tupleToInsert, false);
+            // insert into the new table, leaving its indexes for later
+            newTable->insertMigratedTuple(tupleToInsert);
 
             // delete from the old table
             existingTable->deleteTupleForSchemaChange(scannedTuple);
@@ -606,6 +622,9 @@ TableCatalogDelegate::migrateChangedTuples(catalog::Table const &catalogTable,
         }
     }
 
+    // build the new table's indexes from all of its tuples at once
+    newTable->indexMigratedTuples();
+
     // release any memory held by the default values --
     // normally you'd want this in a finally block, but since this code failing
     // implies serious problems, we'll not worry our pretty little heads
@@ -36,6 +36,10 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("TUPLE_ALLOCATED_MEMORY");
     columnNames.push_back("TUPLE_DATA_MEMORY");
     columnNames.push_back("STRING_DATA_MEMORY");
+    columnNames.push_back("COMPACTION_BLOCKS_MERGED");
+    columnNames.push_back("COMPACTION_TUPLES_MOVED");
+    columnNames.push_back("COMPACTION_MICROS");
+    columnNames.push_back("STRING_DICTIONARY_SAVINGS");
     return columnNames;
 }
 
@@ -50,6 +54,10 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
 }
 
 Table*
@@ -128,7 +136,8 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     if (!m_table->isExport()) {
         occupied_tuple_mem_kb = m_table->occupiedTupleMemory() / 1024;
     }
-    int64_t string_data_mem_kb = m_table->nonInlinedMemorySize() / 1024;
+    const int64_t stringDataMem = stringDataMemory();
+    int64_t string_data_mem_kb = stringDataMem / 1024;
 
     if (interval()) {
         tupleCount = tupleCount - m_lastTupleCount;
@@ -141,7 +150,7 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         m_lastOccupiedTupleMemory = m_table->occupiedTupleMemory();
         string_data_mem_kb =
             string_data_mem_kb - (m_lastStringDataMemory / 1024);
-        m_lastStringDataMemory = m_table->nonInlinedMemorySize();
+        m_lastStringDataMemory = stringDataMem;
     }
 
     if (string_data_mem_kb > INT32_MAX)
@@ -169,6 +178,20 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["STRING_DATA_MEMORY"],
                       ValueFactory::
                       getIntegerValue(static_cast<int32_t>(string_data_mem_kb)));
+    // only persistent tables are compacted; see PersistentTableStats
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_BLOCKS_MERGED"],
+                     ValueFactory::getBigIntValue(0));
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_TUPLES_MOVED"],
+                     ValueFactory::getBigIntValue(0));
+    tuple->setNValue(StatsSource::m_columnName2Index["COMPACTION_MICROS"],
+                     ValueFactory::getBigIntValue(0));
+    // or dictionary encoded
+    tuple->setNValue(StatsSource::m_columnName2Index["STRING_DICTIONARY_SAVINGS"],
+                     ValueFactory::getIntegerValue(0));
+}
+
+int64_t TableStats::stringDataMemory() const {
+    return m_table->nonInlinedMemorySize();
 }
 
 /**
@@ -90,6 +90,11 @@ protected:
      */
     virtual void populateSchema(std::vector<voltdb::ValueType> &types, std::vector<int32_t> &columnLengths, std::vector<bool> &allowNull);
 
+    /**
+     * Bytes of memory the table's uninlined strings take.
+     */
+    virtual int64_t stringDataMemory() const;
+
     ~TableStats();
 
 private:
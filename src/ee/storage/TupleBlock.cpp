@@ -37,7 +37,8 @@ TupleBlock::TupleBlock(Table *table, TBBucketPtr bucket) :
         m_lastCompactionOffset(0),
         m_tuplesPerBlockDivNumBuckets(m_tuplesPerBlock / static_cast<double>(TUPLE_BLOCK_NUM_BUCKETS)),
         m_bucket(bucket),
-        m_bucketIndex(0)
+        m_bucketIndex(0),
+        m_columnPagesStale(true)
 {
 #ifdef MEMCHECK
     m_storage = new char[table->m_tableAllocationSize];
@@ -76,7 +77,8 @@ TupleBlock::~TupleBlock() {
 #endif
 }
 
-std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementListener *listener) {
+std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementListener *listener,
+                                      uint32_t maxTuples) {
     assert(source != this);
     /*
       std::cout << "Attempting to merge " << static_cast<void*> (this)
@@ -88,7 +90,8 @@ std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementL
 
     uint32_t m_nextTupleInSourceOffset = source->lastCompactionOffset();
     int sourceTuplesPendingDeleteOnUndoRelease = 0;
-    while (hasFreeTuples() && !source->isEmpty()) {
+    uint32_t tuplesMoved = 0;
+    while (hasFreeTuples() && !source->isEmpty() && tuplesMoved < maxTuples) {
         TableTuple sourceTupleWithNewValues(table->schema());
         TableTuple destinationTuple(table->schema());
 
@@ -132,6 +135,7 @@ std::pair<int, int> TupleBlock::merge(Table *table, TBPtr source, TupleMovementL
         }
 
         source->freeTuple(sourceTupleWithNewValues.address());
+        tuplesMoved++;
     }
     source->lastCompactionOffset(m_nextTupleInSourceOffset);
 
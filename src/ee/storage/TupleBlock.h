@@ -142,7 +142,14 @@ public:
         return m_bucketIndex;
     }
 
-    std::pair<int, int> merge(Table *table, TBPtr source, TupleMovementListener *listener = NULL);
+    /*
+     * Move tuples from source into this block's free slots, at most
+     * maxTuples of them, resuming from where the last merge from source
+     * left off. Returns the new bucket indexes of this block (-1 if
+     * unchanged) and of source.
+     */
+    std::pair<int, int> merge(Table *table, TBPtr source, TupleMovementListener *listener = NULL,
+                              uint32_t maxTuples = UINT32_MAX);
 
     inline std::pair<char*, int> nextFreeTuple() {
         char *retval = NULL;
@@ -157,6 +164,7 @@ public:
             m_nextFreeTuple++;
         }
         m_activeTuples++;
+        m_columnPagesStale = true;
         int newBucketIndex = calculateBucketIndex();
         if (newBucketIndex != m_bucketIndex) {
             m_bucketIndex = newBucketIndex;
@@ -179,6 +187,7 @@ public:
     inline int freeTuple(char *tupleStorage) {
         m_lastCompactionOffset = 0;
         m_activeTuples--;
+        m_columnPagesStale = true;
         //Find the offset
         uint32_t offset = static_cast<uint32_t>(tupleStorage - m_storage);
         m_freeList.push_back(offset);
@@ -199,6 +208,7 @@ public:
         m_activeTuples = 0;
         m_nextFreeTuple = 0;
         m_freeList.clear();
+        m_columnPagesStale = true;
     }
 
     inline uint32_t unusedTupleBoundry() {
@@ -222,6 +232,36 @@ public:
     inline TBBucketPtr currentBucket() {
         return m_bucket;
     }
+
+    /*
+     * Column pages are an optional column-major copy of some of the
+     * block's columns, laid out by the owning table (see
+     * PersistentTable::refreshColumnPages). The tuples stay authoritative:
+     * allocating or freeing a tuple here, or changing one through the
+     * table, only marks the pages stale, and they are rebuilt from the
+     * tuples before the next scan that reads them. Their memory is
+     * counted in the table's allocatedTupleMemory().
+     */
+    inline char *columnPages() {
+        return m_columnPages.get();
+    }
+
+    inline void allocateColumnPages(size_t size) {
+        m_columnPages.reset(new char[size]);
+        m_columnPagesStale = true;
+    }
+
+    inline bool columnPagesStale() {
+        return m_columnPagesStale;
+    }
+
+    inline void markColumnPagesStale() {
+        m_columnPagesStale = true;
+    }
+
+    inline void markColumnPagesFresh() {
+        m_columnPagesStale = false;
+    }
 private:
 #ifdef MEMCHECK
     Table* m_table;
@@ -247,6 +287,8 @@ private:
     TBBucketPtr m_bucket;
     int m_bucketIndex;
 
+    boost::scoped_array<char> m_columnPages;
+    bool m_columnPagesStale;
 };
 
 /**
@@ -46,6 +46,7 @@
 #include <sstream>
 #include <cassert>
 #include <cstdio>
+#include <sys/time.h>
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
 #include "storage/persistenttable.h"
@@ -58,6 +59,8 @@
 #include "common/FatalException.hpp"
 #include "common/types.h"
 #include "common/RecoveryProtoMessage.h"
+#include "common/StringDictionary.h"
+#include "common/ValuePeeker.hpp"
 #include "common/StreamPredicateList.h"
 #include "indexes/tableindex.h"
 #include "indexes/tableindexfactory.h"
@@ -67,9 +70,8 @@
 #include "storage/TupleStreamWrapper.h"
 #include "storage/TableStats.h"
 #include "storage/PersistentTableStats.h"
-#include "storage/PersistentTableUndoInsertAction.h"
-#include "storage/PersistentTableUndoDeleteAction.h"
 #include "storage/PersistentTableUndoUpdateAction.h"
+#include "storage/PersistentTableUndoTruncateAction.h"
 #include "storage/ConstraintFailureException.h"
 #include "storage/MaterializedViewMetadata.h"
 #include "storage/CopyOnWriteContext.h"
@@ -91,8 +93,12 @@ PersistentTable::PersistentTable(int partitionColumn, int tableAllocationTargetS
     m_partitionColumn(partitionColumn),
     stats_(this),
     m_failedCompactionCount(0),
+    m_compactionBlocksMerged(0),
+    m_compactionTuplesMoved(0),
+    m_compactionMicros(0),
     m_invisibleTuplesPendingDeleteCount(0),
-    m_surgeon(*this)
+    m_surgeon(*this),
+    m_columnPagesSize(0)
 {
     for (int ii = 0; ii < TUPLE_BLOCK_NUM_BUCKETS; ii++) {
         m_blocksNotPendingSnapshotLoad.push_back(TBBucketPtr(new TBBucket()));
@@ -114,6 +120,10 @@ PersistentTable::~PersistentTable()
         tuple.freeObjectColumns();
         tuple.setActiveFalse();
     }
+    // which leaves the dictionaries with the references of unreleased undo actions, if any
+    BOOST_FOREACH(int column, m_dictionaryColumns) {
+        delete m_stringDictionaries[column];
+    }
 
     // note this class has ownership of the views, even if they
     // were allocated by VoltDBEngine
@@ -203,6 +213,157 @@ void PersistentTable::deleteAllTuples(bool freeAllocatedStrings) {
     }
 }
 
+void PersistentTable::truncateTable(bool fallible) {
+    if (m_tupleCount == 0) {
+        return;
+    }
+    if ( ! canDetachAllBlocks()) {
+        deleteAllTuples(true);
+        return;
+    }
+
+    // A view is fed only by this table, so it empties along with it.
+    for (int i = 0; i < m_views.size(); i++) {
+        m_views[i]->targetTable()->truncateTable(fallible);
+    }
+
+    UndoQuantum *uq = fallible ? ExecutorContext::currentUndoQuantum() : NULL;
+    if (uq) {
+        PersistentTableUndoTruncateAction *undoAction =
+            new (*uq) PersistentTableUndoTruncateAction(&m_surgeon);
+        undoAction->detachBlocksAndIndexEntries();
+        uq->registerUndoAction(undoAction, this);
+        return;
+    }
+
+    // Here, for reasons of infallibility or no active UndoLog, there is no undo, there is only DO.
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        index->removeAllEntries();
+    }
+    TBMap detachedBlocks;
+    std::vector<DetachedIndexEntries*> detachedEntries;
+    uint32_t tupleCount;
+    int64_t nonInlinedMemorySize;
+    detachAllBlocks(detachedBlocks, tupleCount, nonInlinedMemorySize);
+    truncateTableRelease(detachedBlocks, detachedEntries);
+}
+
+/**
+ * Blocks can only change hands wholesale when nothing is tracking
+ * individual tuples in them: no snapshot, recovery or elastic stream,
+ * and no delete earlier in the transaction whose undo action still
+ * points at a tuple.
+ */
+bool PersistentTable::canDetachAllBlocks() const {
+    if (m_tuplesPinnedByUndo != 0 || m_invisibleTuplesPendingDeleteCount != 0) {
+        return false;
+    }
+    if (m_surgeon.hasIndex()) {
+        return false;
+    }
+    if (m_tableStreamer != NULL &&
+        (m_tableStreamer->hasStreamType(TABLE_STREAM_SNAPSHOT) ||
+         m_tableStreamer->hasStreamType(TABLE_STREAM_RECOVERY) ||
+         m_tableStreamer->hasStreamType(TABLE_STREAM_ELASTIC_INDEX))) {
+        return false;
+    }
+    assert(m_blocksPendingSnapshot.empty());
+    return true;
+}
+
+/**
+ * Move every block out of the table, leaving it empty. The indexes must
+ * be emptied along with it.
+ */
+void PersistentTable::detachAllBlocks(TBMap &detachedBlocks, uint32_t &tupleCount,
+                                      int64_t &nonInlinedMemorySize) {
+    for (TBMapI i = m_data.begin(); i != m_data.end(); ++i) {
+        //Eliminates circular reference
+        i.data()->swapToBucket(TBBucketPtr());
+    }
+    assert(detachedBlocks.empty());
+    m_data.swap(detachedBlocks);
+    m_blocksNotPendingSnapshot.clear();
+    m_blocksWithSpace.clear();
+
+    tupleCount = m_tupleCount;
+    nonInlinedMemorySize = m_nonInlinedMemorySize;
+    m_tupleCount = 0;
+    m_nonInlinedMemorySize = 0;
+}
+
+/**
+ * Move the entries of every index out of the table, in index order,
+ * leaving the indexes empty.
+ */
+void PersistentTable::detachAllIndexEntries(std::vector<DetachedIndexEntries*> &detachedEntries) {
+    assert(detachedEntries.empty());
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        detachedEntries.push_back(index->detachAllEntries());
+    }
+}
+
+/**
+ * This entry point is triggered by the undo of a truncate. Everything done
+ * to the table since the truncate has already been undone, so it and its
+ * indexes are empty again and the detached blocks and index entries can
+ * simply be put back.
+ */
+void PersistentTable::truncateTableForUndo(TBMap &detachedBlocks,
+                                           std::vector<DetachedIndexEntries*> &detachedEntries,
+                                           uint32_t tupleCount, int64_t nonInlinedMemorySize) {
+    assert(m_tupleCount == 0);
+    TBMap emptyBlocks;
+    detachAllBlocks(emptyBlocks, m_tupleCount, m_nonInlinedMemorySize);
+
+    m_data.swap(detachedBlocks);
+    for (TBMapI i = m_data.begin(); i != m_data.end(); ++i) {
+        TBPtr block = i.data();
+        m_blocksNotPendingSnapshot.insert(block);
+        int bucketIndex = block->calculateBucketIndex();
+        if (bucketIndex != -1) {
+            block->swapToBucket(m_blocksNotPendingSnapshotLoad[bucketIndex]);
+        }
+        if (block->hasFreeTuples()) {
+            m_blocksWithSpace.insert(block);
+        }
+    }
+    m_tupleCount = tupleCount;
+    m_nonInlinedMemorySize = nonInlinedMemorySize;
+
+    assert(detachedEntries.size() == m_indexes.size());
+    for (int i = 0; i < m_indexes.size(); ++i) {
+        m_indexes[i]->reattachAllEntries(detachedEntries[i]);
+    }
+    detachedEntries.clear();
+}
+
+/**
+ * This entry point is triggered by the successful release of a truncate,
+ * or directly by an infallible truncate. Free the detached index entries
+ * and the strings of the detached tuples; dropping the blocks frees the rest.
+ */
+void PersistentTable::truncateTableRelease(TBMap &detachedBlocks,
+                                           std::vector<DetachedIndexEntries*> &detachedEntries) {
+    BOOST_FOREACH(DetachedIndexEntries *entries, detachedEntries) {
+        delete entries;
+    }
+    detachedEntries.clear();
+    if (m_schema->getUninlinedObjectColumnCount() != 0) {
+        TableTuple tuple(m_schema);
+        for (TBMapI i = detachedBlocks.begin(); i != detachedBlocks.end(); ++i) {
+            TBPtr block = i.data();
+            for (uint32_t ii = 0; ii < block->unusedTupleBoundry(); ++ii) {
+                tuple.move(block->address() + ii * m_tupleLength);
+                if (tuple.isActive()) {
+                    tuple.freeObjectColumns();
+                }
+            }
+        }
+    }
+    detachedBlocks.clear();
+}
+
 void setSearchKeyFromTuple(TableTuple &source) {
     keyTuple.setNValue(0, source.getNValue(1));
     keyTuple.setNValue(1, source.getNValue(2));
@@ -232,6 +393,7 @@ void PersistentTable::insertPersistentTuple(TableTuple &source, bool fallible)
     // Then copy the source into the target
     //
     target.copyForPersistentInsert(source); // tuple in freelist must be already cleared
+    internStrings(target);
 
     try {
         insertTupleCommon(source, target, fallible);
@@ -283,7 +445,7 @@ void PersistentTable::insertTupleCommon(TableTuple &source, TableTuple &target,
         UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
         if (uq) {
             char* tupleData = uq->allocatePooledCopy(target.address(), target.tupleLength());
-            uq->registerUndoAction(new (*uq) PersistentTableUndoInsertAction(tupleData, &m_surgeon));
+            uq->registerUndoRecord(UNDO_RECORD_INSERT, tupleData, this);
         }
     }
 
@@ -293,6 +455,49 @@ void PersistentTable::insertTupleCommon(TableTuple &source, TableTuple &target,
     }
 }
 
+void PersistentTable::insertMigratedTuple(TableTuple &source)
+{
+    // nothing streams or views a table that is still being migrated into
+    assert(m_tableStreamer == NULL);
+    assert(m_views.size() == 0);
+
+    TableTuple target(m_schema);
+    PersistentTable::nextFreeTuple(&target);
+    target.copyForPersistentInsert(source); // tuple in freelist must be already cleared
+    internStrings(target);
+
+    if (m_schema->getUninlinedObjectColumnCount() != 0) {
+        increaseStringMemCount(target.getNonInlinedMemorySize());
+    }
+
+    target.setActiveTrue();
+    target.setDirtyFalse();
+    target.setPendingDeleteFalse();
+    target.setPendingDeleteOnUndoReleaseFalse();
+}
+
+void PersistentTable::indexMigratedTuples()
+{
+    std::vector<TableTuple> tuples;
+    tuples.reserve(activeTupleCount());
+    TableTuple tuple(m_schema);
+    TableIterator iter(this, m_data.begin());
+    while (iter.next(tuple)) {
+        tuples.push_back(tuple);
+    }
+
+    if (tryBulkInsertOnAllIndexes(tuples)) {
+        return;
+    }
+    // Find the first tuple whose insert would have failed.
+    BOOST_FOREACH(TableTuple &migrated, tuples) {
+        if (!tryInsertOnAllIndexes(&migrated)) {
+            throw ConstraintFailureException(this, migrated, TableTuple(),
+                                             CONSTRAINT_TYPE_UNIQUE);
+        }
+    }
+}
+
 /*
  * Insert a tuple but don't allocate a new copy of the uninlineable
  * strings or create an UndoAction or update a materialized view.
@@ -304,6 +509,7 @@ void PersistentTable::insertTupleForUndo(char *tuple)
     target.setPendingDeleteOnUndoReleaseFalse();
     m_tuplesPinnedByUndo--;
     --m_invisibleTuplesPendingDeleteCount;
+    columnPagesChanged(target);
 
     /*
      * The only thing to do is reinsert the tuple into the indexes. It was never moved,
@@ -399,9 +605,9 @@ bool PersistentTable::updateTupleWithSpecificIndexes(TableTuple &targetTupleToUp
         m_views[i]->processTupleDelete(targetTupleToUpdate, fallible);
     }
 
-    if (m_schema->getUninlinedObjectColumnCount() != 0) {
+    const bool hasUninlinedObjects = m_schema->getUninlinedObjectColumnCount() != 0;
+    if (hasUninlinedObjects) {
         decreaseStringMemCount(targetTupleToUpdate.getNonInlinedMemorySize());
-        increaseStringMemCount(sourceTupleWithNewValues.getNonInlinedMemorySize());
     }
 
     // TODO: This is a little messed up.
@@ -428,6 +634,12 @@ bool PersistentTable::updateTupleWithSpecificIndexes(TableTuple &targetTupleToUp
 
     // this is the actual write of the new values
     targetTupleToUpdate.copyForPersistentUpdate(sourceTupleWithNewValues, oldObjects, newObjects);
+    internStrings(targetTupleToUpdate, &newObjects);
+    columnPagesChanged(targetTupleToUpdate);
+    // counted after the copy, which keeps short strings in the tuple
+    if (hasUninlinedObjects) {
+        increaseStringMemCount(targetTupleToUpdate.getNonInlinedMemorySize());
+    }
 
     if (uq) {
         /*
@@ -511,6 +723,7 @@ void PersistentTable::updateTupleForUndo(char* tupleWithUnwantedValues,
     bool dirty = targetTupleToUpdate.isDirty();
     // this is the actual in-place revert to the old version
     targetTupleToUpdate.copy(sourceTupleWithNewValues);
+    columnPagesChanged(targetTupleToUpdate);
     if (dirty) {
         targetTupleToUpdate.setDirtyTrue();
     } else {
@@ -547,10 +760,11 @@ bool PersistentTable::deleteTuple(TableTuple &target, bool fallible) {
         UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
         if (uq) {
             target.setPendingDeleteOnUndoReleaseTrue();
+            columnPagesChanged(target);
             m_tuplesPinnedByUndo++;
             ++m_invisibleTuplesPendingDeleteCount;
-            // Create and register an undo action.
-            uq->registerUndoAction(new (*uq) PersistentTableUndoDeleteAction(target.address(), &m_surgeon), this);
+            // Log the delete to be undone or finished off later.
+            uq->registerUndoRecord(UNDO_RECORD_DELETE, target.address(), this, this);
             return true;
         }
     }
@@ -561,8 +775,42 @@ bool PersistentTable::deleteTuple(TableTuple &target, bool fallible) {
 }
 
 
+/*
+ * Undo a run of logged inserts or deletes, latest first. Undoing an
+ * insert deletes the tuple again, looking it up by the pooled copy taken
+ * when it was inserted. Undoing a delete puts the tuple, still in place
+ * and only marked as pending delete, back into the indexes.
+ */
+void PersistentTable::undoRecords(UndoRecordType type, const UndoRecord *records, std::size_t count)
+{
+    if (type == UNDO_RECORD_INSERT) {
+        for (std::size_t ii = count; ii > 0; ii--) {
+            deleteTupleForUndo(records[ii - 1].m_data);
+        }
+    }
+    else {
+        assert(type == UNDO_RECORD_DELETE);
+        for (std::size_t ii = count; ii > 0; ii--) {
+            insertTupleForUndo(records[ii - 1].m_data);
+        }
+    }
+}
+
+/*
+ * Release a run of logged inserts or deletes. Inserts hold nothing that
+ * needs releasing; deleted tuples are finally deleted.
+ */
+void PersistentTable::releaseRecords(UndoRecordType type, const UndoRecord *records, std::size_t count)
+{
+    if (type == UNDO_RECORD_DELETE) {
+        for (std::size_t ii = count; ii > 0; ii--) {
+            deleteTupleRelease(records[ii - 1].m_data);
+        }
+    }
+}
+
 /**
- * This entry point is triggered by the successful release of an UndoDeleteAction.
+ * This entry point is triggered by the release of a logged delete.
  */
 void PersistentTable::deleteTupleRelease(char* tupleData)
 {
@@ -575,7 +823,7 @@ void PersistentTable::deleteTupleRelease(char* tupleData)
 }
 
 /**
- * Actually follow through with a "delete" -- this is common code between UndoDeleteAction release and the
+ * Actually follow through with a "delete" -- this is common code between the release of a logged delete and the
  * all-at-once infallible deletes that bypass Undo processing.
  */
 void PersistentTable::deleteTupleFinalize(TableTuple &target)
@@ -603,6 +851,7 @@ void PersistentTable::deleteTupleFinalize(TableTuple &target)
 
         ++m_invisibleTuplesPendingDeleteCount;
         target.setPendingDeleteTrue();
+        columnPagesChanged(target);
         return;
     }
 
@@ -635,7 +884,7 @@ void PersistentTable::deleteTupleForSchemaChange(TableTuple &target) {
 void PersistentTable::deleteTupleForUndo(char* tupleData, bool skipLookup) {
     TableTuple target(tupleData, m_schema);
     if (!skipLookup) {
-        // The UndoInsertAction got a pooled copy of the tupleData.
+        // The logged insert holds a pooled copy of the tupleData.
         // Relocate the original tuple actually in the table.
         target = lookupTuple(target);
     }
@@ -876,6 +1125,135 @@ void PersistentTable::onSetColumns() {
     m_data.clear();
 }
 
+void PersistentTable::enableColumnPages() {
+    assert(m_schema != NULL);
+    assert(m_columnPagesSize == 0);
+
+    // The visibility bitmap comes first, one bit per tuple slot...
+    size_t size = ((m_tuplesPerBlock + 63) / 64) * sizeof(uint64_t);
+    m_columnPageOffsets.assign(m_columnCount, -1);
+    m_pagedColumns.clear();
+
+    // ...followed by one page for each column a batch predicate kernel can read.
+    for (int i = 0; i < m_columnCount; ++i) {
+        switch (m_schema->columnType(i)) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+        case VALUE_TYPE_DOUBLE:
+            m_columnPageOffsets[i] = static_cast<int32_t>(size);
+            m_pagedColumns.push_back(i);
+            size += m_tuplesPerBlock * NValue::getTupleStorageSize(m_schema->columnType(i));
+            size = (size + 7) & ~static_cast<size_t>(7);
+            break;
+        default:
+            break;
+        }
+    }
+    m_columnPagesSize = size;
+    VOLT_DEBUG("Table %s keeps %d column pages in %d bytes per block",
+               m_name.c_str(), (int)m_pagedColumns.size(), (int)m_columnPagesSize);
+}
+
+char *PersistentTable::refreshColumnPages(TBPtr block) {
+    assert(m_columnPagesSize != 0);
+    if (block->columnPages() == NULL) {
+        block->allocateColumnPages(m_columnPagesSize);
+    }
+    char *pages = block->columnPages();
+    if (!block->columnPagesStale()) {
+        return pages;
+    }
+
+    uint64_t *visible = reinterpret_cast<uint64_t*>(pages);
+    ::memset(visible, 0, ((m_tuplesPerBlock + 63) / 64) * sizeof(uint64_t));
+
+    // Only the values of visible tuples are copied; scans never read the others.
+    TableTuple tuple(m_schema);
+    const uint32_t boundary = block->unusedTupleBoundry();
+    char *address = block->address();
+    for (uint32_t slot = 0; slot < boundary; ++slot, address += m_tupleLength) {
+        tuple.move(address);
+        if (!tuple.isActive() || tuple.isPendingDelete() || tuple.isPendingDeleteOnUndoRelease()) {
+            continue;
+        }
+        visible[slot >> 6] |= static_cast<uint64_t>(1) << (slot & 63);
+        for (size_t i = 0; i < m_pagedColumns.size(); ++i) {
+            const int column = m_pagedColumns[i];
+            const uint16_t width = NValue::getTupleStorageSize(m_schema->columnType(column));
+            ::memcpy(pages + m_columnPageOffsets[column] + slot * width,
+                     address + TUPLE_HEADER_SIZE + m_schema->columnOffset(column), width);
+        }
+    }
+    block->markColumnPagesFresh();
+    return pages;
+}
+
+int64_t PersistentTable::allocatedTupleMemory() const {
+    int64_t bytes = Table::allocatedTupleMemory();
+    if (m_columnPagesSize == 0) {
+        return bytes;
+    }
+    // A block's pages are allocated by its first scan and freed with it.
+    for (TBMap::const_iterator i = m_data.begin(); i != m_data.end(); ++i) {
+        if (i.data()->columnPages() != NULL) {
+            bytes += m_columnPagesSize;
+        }
+    }
+    return bytes;
+}
+
+void PersistentTable::enableStringDictionary(int columnIndex) {
+    assert(m_schema != NULL);
+    assert(m_tupleCount == 0);
+    const ValueType type = m_schema->columnType(columnIndex);
+    if ((type != VALUE_TYPE_VARCHAR && type != VALUE_TYPE_VARBINARY) ||
+        m_schema->columnIsInlined(columnIndex)) {
+        VOLT_DEBUG("Column %d of table %s is stored in its tuples, so it is not dictionary encoded",
+                   columnIndex, m_name.c_str());
+        return;
+    }
+    if (m_stringDictionaries.empty()) {
+        m_stringDictionaries.assign(m_columnCount, NULL);
+    }
+    if (m_stringDictionaries[columnIndex] == NULL) {
+        m_stringDictionaries[columnIndex] = new StringDictionary();
+        m_dictionaryColumns.push_back(columnIndex);
+    }
+}
+
+int64_t PersistentTable::stringDictionaryBytesSaved() const {
+    int64_t saved = 0;
+    BOOST_FOREACH(int column, m_dictionaryColumns) {
+        saved += m_stringDictionaries[column]->bytesSaved();
+    }
+    return saved;
+}
+
+void PersistentTable::internDictionaryColumns(TableTuple &tuple, std::vector<char*> *newObjects) {
+    BOOST_FOREACH(int column, m_dictionaryColumns) {
+        StringRef **slot = reinterpret_cast<StringRef**>(tuple.getDataPtr(column));
+        StringRef *copy = *slot;
+        // NULL, a short string kept in the slot, or a value an update left alone
+        if (copy == NULL || StringRef::isShortString(copy) ||
+            StringDictionary::dictionaryOf(copy) != NULL) {
+            continue;
+        }
+        const NValue value = tuple.getNValue(column);
+        StringRef *entry = m_stringDictionaries[column]->intern(
+            copy,
+            static_cast<const char*>(ValuePeeker::peekObjectValue(value)),
+            ValuePeeker::peekObjectLength(value));
+        *slot = entry;
+        if (newObjects != NULL) {
+            std::replace(newObjects->begin(), newObjects->end(),
+                         reinterpret_cast<char*>(copy), reinterpret_cast<char*>(entry));
+        }
+    }
+}
+
 /*
  * Implemented by persistent table and called by Table::loadTuplesFrom
  * to do additional processing for views and Export and non-inline
@@ -886,6 +1264,7 @@ void PersistentTable::processLoadedTuple(TableTuple &tuple,
                                          int32_t &serializedTupleCount,
                                          size_t &tupleCountPosition) {
     try {
+        internStrings(tuple);
         insertTupleCommon(tuple, tuple, true);
     } catch (ConstraintFailureException &e) {
         if (uniqueViolationOutput) {
@@ -903,6 +1282,192 @@ void PersistentTable::processLoadedTuple(TableTuple &tuple,
     }
 }
 
+void PersistentTable::loadTuplesFromNoHeader(SerializeInput &serialize_io,
+                                             Pool *stringPool,
+                                             ReferenceSerializeOutput *uniqueViolationOutput) {
+    if (m_tableStreamer != NULL) {
+        Table::loadTuplesFromNoHeader(serialize_io, stringPool, uniqueViolationOutput);
+        return;
+    }
+
+    int tupleCount = serialize_io.readInt();
+    assert(tupleCount >= 0);
+
+    //Reserve space for a length prefix for rows that violate constraints
+    //If there is no output supplied the first violation throws
+    size_t lengthPosition = 0;
+    if (uniqueViolationOutput != NULL) {
+        lengthPosition = uniqueViolationOutput->reserveBytes(4);
+    }
+
+    // Append every tuple to the blocks before touching any index
+    std::vector<TableTuple> loaded;
+    loaded.reserve(tupleCount);
+    TableTuple target(m_schema);
+    const uint16_t uninlinedCount = m_schema->getUninlinedObjectColumnCount();
+    // whether the last loaded tuple was read whole and its strings counted
+    bool lastComplete = true;
+    try {
+        for (int i = 0; i < tupleCount; ++i) {
+            nextFreeTuple(&target);
+            target.setActiveTrue();
+            target.setDirtyFalse();
+            target.setPendingDeleteFalse();
+            target.setPendingDeleteOnUndoReleaseFalse();
+            // A tuple that fails part way is freed with the others, so its
+            // object columns must hold either what was read or NULL.
+            for (uint16_t j = 0; j < uninlinedCount; ++j) {
+                *reinterpret_cast<char**>(target.getDataPtr(m_schema->getUninlinedObjectColumnInfoIndex(j))) = NULL;
+            }
+            loaded.push_back(target);
+            lastComplete = false;
+
+            target.deserializeFrom(serialize_io, stringPool);
+            internStrings(target);
+            if (uninlinedCount != 0) {
+                increaseStringMemCount(target.getNonInlinedMemorySize());
+            }
+            lastComplete = true;
+        }
+    } catch (...) {
+        if (!lastComplete && uninlinedCount != 0) {
+            // deleteTupleStorage takes back what it frees
+            increaseStringMemCount(loaded.back().getNonInlinedMemorySize());
+        }
+        BOOST_FOREACH(TableTuple &tuple, loaded) {
+            deleteTupleStorage(tuple);
+        }
+        throw;
+    }
+
+    // Tuples rejected by a constraint are only reported if there is an
+    // output for them, else the first one (at failedAt) fails the load.
+    std::vector<bool> rejected(tupleCount, false);
+    int failedAt = tupleCount;
+    ConstraintType failure = CONSTRAINT_TYPE_NOT_NULL;
+    std::vector<TableTuple> accepted;
+    accepted.reserve(tupleCount);
+    for (int i = 0; i < tupleCount; ++i) {
+        if (checkNulls(loaded[i])) {
+            accepted.push_back(loaded[i]);
+        } else if (uniqueViolationOutput != NULL) {
+            rejected[i] = true;
+        } else {
+            failedAt = i;
+            break;
+        }
+    }
+
+    if (!tryBulkInsertOnAllIndexes(accepted)) {
+        // Some unique keys collide, amongst the loaded tuples or with the
+        // table's. Settle which tuples win the way one at a time inserts
+        // in load order would have.
+        accepted.clear();
+        for (int i = 0; i < failedAt; ++i) {
+            if (rejected[i]) {
+                continue;
+            }
+            if (tryInsertOnAllIndexes(&loaded[i])) {
+                accepted.push_back(loaded[i]);
+            } else if (uniqueViolationOutput != NULL) {
+                rejected[i] = true;
+            } else {
+                failedAt = i;
+                failure = CONSTRAINT_TYPE_UNIQUE;
+                break;
+            }
+        }
+    }
+
+    UndoQuantum *uq = ExecutorContext::currentUndoQuantum();
+    BOOST_FOREACH(TableTuple &tuple, accepted) {
+        if (uq) {
+            char* tupleData = uq->allocatePooledCopy(tuple.address(), tuple.tupleLength());
+            uq->registerUndoRecord(UNDO_RECORD_INSERT, tupleData, this);
+        }
+        for (int i = 0; i < m_views.size(); i++) {
+            m_views[i]->processTupleInsert(tuple, true);
+        }
+    }
+
+    if (uniqueViolationOutput != NULL) {
+        int32_t serializedTupleCount = 0;
+        size_t tupleCountPosition = 0;
+        for (int i = 0; i < tupleCount; ++i) {
+            if (!rejected[i]) {
+                continue;
+            }
+            if (serializedTupleCount == 0) {
+                serializeColumnHeaderTo(*uniqueViolationOutput);
+                tupleCountPosition = uniqueViolationOutput->reserveBytes(sizeof(int32_t));
+            }
+            serializedTupleCount++;
+            loaded[i].serializeTo(*uniqueViolationOutput);
+            deleteTupleStorage(loaded[i]);
+        }
+        if (serializedTupleCount == 0) {
+            uniqueViolationOutput->writeIntAt(lengthPosition, 0);
+        } else {
+            uniqueViolationOutput->writeIntAt(lengthPosition,
+                                              static_cast<int32_t>(uniqueViolationOutput->position() - lengthPosition - sizeof(int32_t)));
+            uniqueViolationOutput->writeIntAt(tupleCountPosition,
+                                              serializedTupleCount);
+        }
+    }
+
+    if (failedAt < tupleCount) {
+        // The one at a time load never reads the tuples after the failed
+        // one. The failed tuple itself stays, as it does there, for the
+        // exception to report.
+        for (int i = failedAt + 1; i < tupleCount; ++i) {
+            deleteTupleStorage(loaded[i]); // also frees object columns
+        }
+        throw ConstraintFailureException(this, loaded[failedAt], TableTuple(), failure);
+    }
+}
+
+/*
+ * Add the tuples to every index, unique indexes first as only they can
+ * turn the tuples down. Returns false, leaving all indexes as they were,
+ * if a unique key of one of the tuples is taken.
+ */
+bool PersistentTable::tryBulkInsertOnAllIndexes(const std::vector<TableTuple> &tuples) {
+    std::vector<TableIndex*> ordered;
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        if (index->isUniqueIndex()) {
+            ordered.push_back(index);
+        }
+    }
+    const size_t uniqueCount = ordered.size();
+    BOOST_FOREACH(TableIndex *index, m_indexes) {
+        if (!index->isUniqueIndex()) {
+            ordered.push_back(index);
+        }
+    }
+
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        if (ordered[i]->addEntriesInBulk(tuples)) {
+            continue;
+        }
+        assert(i < uniqueCount);
+        VOLT_DEBUG("Failed to bulk insert into index %s,%s",
+                   ordered[i]->getTypeName().c_str(),
+                   ordered[i]->getName().c_str());
+        for (size_t j = 0; j < i; ++j) {
+            if (ordered[j]->getSize() == tuples.size()) {
+                // the index was empty before
+                ordered[j]->removeAllEntries();
+                continue;
+            }
+            BOOST_FOREACH(const TableTuple &tuple, tuples) {
+                ordered[j]->deleteEntry(&tuple);
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
 TableStats* PersistentTable::getTableStats() {
     return &stats_;
 }
@@ -1011,11 +1576,12 @@ size_t PersistentTable::hashCode() {
         pkeyIndex->addEntry(&tuple);
     }
 
-    pkeyIndex->moveToEnd(true);
+    IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+    pkeyIndex->moveToEnd(true, indexCursor);
 
     size_t hashCode = 0;
     while (true) {
-         tuple = pkeyIndex->nextValue();
+         tuple = pkeyIndex->nextValue(indexCursor);
          if (tuple.isNullTuple()) {
              break;
          }
@@ -1075,7 +1641,7 @@ void PersistentTable::swapTuples(TableTuple &originalTuple,
     }
 }
 
-bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap) {
+bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap, int64_t maxTuples) {
     /**
      * First find the two best candidate blocks
      */
@@ -1096,7 +1662,8 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap) {
     }
 
     int fullestBucketChange = -1;
-    while (fullest->hasFreeTuples()) {
+    int64_t tuplesMoved = 0;
+    while (fullest->hasFreeTuples() && tuplesMoved < maxTuples) {
         TBPtr lightest;
         TBBucketI lightestIterator;
         bool foundLightest = false;
@@ -1144,13 +1711,18 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap) {
             return false;
         }
 
-        std::pair<int, int> bucketChanges = fullest->merge(this, lightest, this);
+        const uint32_t activeBefore = fullest->activeTuples();
+        const int64_t mergeLimit = std::min(maxTuples - tuplesMoved, static_cast<int64_t>(UINT32_MAX));
+        std::pair<int, int> bucketChanges =
+            fullest->merge(this, lightest, this, static_cast<uint32_t>(mergeLimit));
+        tuplesMoved += fullest->activeTuples() - activeBefore;
         int tempFullestBucketChange = bucketChanges.first;
         if (tempFullestBucketChange != -1) {
             fullestBucketChange = tempFullestBucketChange;
         }
 
         if (lightest->isEmpty()) {
+            m_compactionBlocksMerged++;
             notifyBlockWasCompactedAway(lightest);
             m_data.erase(lightest->address());
             m_blocksWithSpace.erase(lightest);
@@ -1171,6 +1743,7 @@ bool PersistentTable::doCompactionWithinSubset(TBBucketMap *bucketMap) {
     if (!fullest->hasFreeTuples()) {
         m_blocksWithSpace.erase(fullest);
     }
+    m_compactionTuplesMoved += tuplesMoved;
     return true;
 }
 
@@ -1183,6 +1756,43 @@ void PersistentTable::doIdleCompaction() {
     }
 }
 
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+int64_t PersistentTable::doIncrementalCompaction(int64_t maxTuples, int64_t maxMicros) {
+    if (m_tableStreamer.get() != NULL && m_tableStreamer->hasStreamType(TABLE_STREAM_RECOVERY)) {
+        return 0;
+    }
+    const int64_t start = nowMicros();
+    const int64_t tuplesMovedBefore = m_compactionTuplesMoved;
+    int64_t elapsed = 0;
+    while (compactionPredicate()) {
+        const int64_t tuplesMoved = m_compactionTuplesMoved - tuplesMovedBefore;
+        if (tuplesMoved >= maxTuples || elapsed >= maxMicros) {
+            break;
+        }
+        // stop if neither set of blocks had anything left to merge
+        const int64_t blocksMergedBefore = m_compactionBlocksMerged;
+        if (!m_blocksNotPendingSnapshot.empty()) {
+            doCompactionWithinSubset(&m_blocksNotPendingSnapshotLoad, maxTuples - tuplesMoved);
+        }
+        if (!m_blocksPendingSnapshot.empty() && m_compactionTuplesMoved - tuplesMovedBefore < maxTuples) {
+            doCompactionWithinSubset(&m_blocksPendingSnapshotLoad,
+                                     maxTuples - (m_compactionTuplesMoved - tuplesMovedBefore));
+        }
+        elapsed = nowMicros() - start;
+        if (m_compactionTuplesMoved - tuplesMovedBefore == tuplesMoved &&
+            m_compactionBlocksMerged == blocksMergedBefore) {
+            break;
+        }
+    }
+    m_compactionMicros += elapsed;
+    return m_compactionTuplesMoved - tuplesMovedBefore;
+}
+
 void PersistentTable::doForcedCompaction() {
     if (m_tableStreamer.get() != NULL && m_tableStreamer->hasStreamType(TABLE_STREAM_RECOVERY)) {
         LogManager::getThreadLogger(LOGGERID_SQL)->log(LOGLEVEL_INFO,
@@ -1191,6 +1801,7 @@ void PersistentTable::doForcedCompaction() {
     }
     bool hadWork1 = true;
     bool hadWork2 = true;
+    const int64_t start = nowMicros();
 
     char msg[512];
     snprintf(msg, sizeof(msg), "Doing forced compaction with allocated tuple count %zd",
@@ -1248,6 +1859,7 @@ void PersistentTable::doForcedCompaction() {
         m_failedCompactionCount = 0;
     }
 
+    m_compactionMicros += nowMicros() - start;
     assert(!compactionPredicate());
     snprintf(msg, sizeof(msg), "Finished forced compaction with allocated tuple count %zd",
              ((intmax_t)allocatedTupleCount()));
@@ -65,10 +65,13 @@
 #include "storage/ElasticIndex.h"
 #include "storage/CopyOnWriteIterator.h"
 #include "common/UndoQuantumReleaseInterest.h"
+#include "common/UndoRecord.h"
 #include "common/ThreadLocalPool.h"
 
 class CompactionTest_BasicCompaction;
 class CompactionTest_CompactionWithCopyOnWrite;
+class CompactionTest_IncrementalCompaction;
+class CompactionTest_CompactionUnderOpenUndoQuantum;
 class CopyOnWriteTest;
 
 namespace catalog {
@@ -78,6 +81,7 @@ class MaterializedViewInfo;
 namespace voltdb {
 
 class TableColumn;
+class DetachedIndexEntries;
 class TableIndex;
 class TableIterator;
 class TableFactory;
@@ -89,6 +93,13 @@ class RecoveryProtoMsg;
 class TupleOutputStreamProcessor;
 class ReferenceSerializeInput;
 class PersistentTable;
+class StringDictionary;
+
+// Bounds on the slice of incremental compaction done after each released
+// undo quantum that leaves the table compactable. The engine's tick picks
+// up whatever those slices leave behind.
+const int64_t COMPACTION_SLICE_TUPLES = 5000;
+const int64_t COMPACTION_SLICE_MICROS = 2000;
 
 /**
  * Interface used by contexts, scanners, iterators, and undo actions to access
@@ -110,6 +121,11 @@ public:
     void deleteTupleForUndo(char* tupleData, bool skipLookup = false);
     void deleteTupleRelease(char* tuple);
     void deleteTupleStorage(TableTuple &tuple, TBPtr block = TBPtr(NULL));
+    void detachAllBlocks(TBMap &detachedBlocks, uint32_t &tupleCount, int64_t &nonInlinedMemorySize);
+    void detachAllIndexEntries(std::vector<DetachedIndexEntries*> &detachedEntries);
+    void truncateTableForUndo(TBMap &detachedBlocks, std::vector<DetachedIndexEntries*> &detachedEntries,
+                              uint32_t tupleCount, int64_t nonInlinedMemorySize);
+    void truncateTableRelease(TBMap &detachedBlocks, std::vector<DetachedIndexEntries*> &detachedEntries);
     void snapshotFinishedScanningBlock(TBPtr finishedBlock, TBPtr nextBlock);
     uint32_t getTupleCount() const;
 
@@ -192,12 +208,15 @@ private:
  */
 
 class PersistentTable : public Table, public UndoQuantumReleaseInterest,
-                        public TupleMovementListener {
+                        public UndoRecordHandler, public TupleMovementListener {
     friend class PersistentTableSurgeon;
     friend class TableFactory;
+    friend class ColumnPageIterator;
     friend class ::CopyOnWriteTest;
     friend class ::CompactionTest_BasicCompaction;
     friend class ::CompactionTest_CompactionWithCopyOnWrite;
+    friend class ::CompactionTest_IncrementalCompaction;
+    friend class ::CompactionTest_CompactionUnderOpenUndoQuantum;
 
   private:
     // no default ctor, no copy, no assignment
@@ -213,10 +232,14 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
 
     void notifyQuantumRelease() {
         if (compactionPredicate()) {
-            doForcedCompaction();
+            doIncrementalCompaction(COMPACTION_SLICE_TUPLES, COMPACTION_SLICE_MICROS);
         }
     }
 
+    // Inserts and deletes are logged as bare undo records of the table.
+    void undoRecords(UndoRecordType type, const UndoRecord *records, std::size_t count);
+    void releaseRecords(UndoRecordType type, const UndoRecord *records, std::size_t count);
+
     // Return a table iterator by reference
     TableIterator& iterator() {
         m_iter.reset(m_data.begin());
@@ -231,6 +254,11 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // GENERIC TABLE OPERATIONS
     // ------------------------------------------------------------------
     virtual void deleteAllTuples(bool freeAllocatedStrings);
+    // Delete every tuple at once by handing all of the table's blocks to a
+    // single undo action instead of deleting (and logging) row by row.
+    // Falls back to deleteAllTuples when a snapshot, recovery or elastic
+    // stream, or an earlier delete in this transaction, needs per-row deletes.
+    void truncateTable(bool fallible=true);
     // The fallible flag is used to denote a change to a persistent table
     // which is part of a long transaction that has been vetted and can
     // never fail (e.g. violate a constraint).
@@ -266,6 +294,23 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
 
     void insertPersistentTuple(TableTuple &source, bool fallible);
 
+    // Schema change migration into a new, still empty table: each migrated
+    // tuple is only added to the blocks, and indexMigratedTuples then
+    // builds every index from all of them at once. A tuple whose unique
+    // key is taken fails the migration as its insert would have.
+    void insertMigratedTuple(TableTuple &source);
+    void indexMigratedTuples();
+
+    // Loads the tuples into the blocks first and only then indexes them,
+    // a whole index at a time, so that a tree index is built bottom up
+    // from its sorted keys rather than rebalanced at every insert.
+    // Tuples violating a constraint are dealt with as if they had been
+    // inserted one at a time, in order. Falls back to Table's one at a
+    // time load while a stream needs to see each insert.
+    void loadTuplesFromNoHeader(SerializeInput &serialize_in,
+                                Pool *stringPool = NULL,
+                                ReferenceSerializeOutput *uniqueViolationOutput = NULL);
+
     /// This is not used in any production code path -- it is a convenient wrapper used by tests.
     bool updateTuple(TableTuple &targetTupleToUpdate, TableTuple &sourceTupleWithNewValues)
     {
@@ -290,6 +335,54 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
      */
     static TBPtr findBlock(char *tuple, TBMap &blocks, int blockSize);
 
+    // ------------------------------------------------------------------
+    // COLUMN PAGES
+    // ------------------------------------------------------------------
+    /*
+     * Keep column pages (see TupleBlock) in every block of this table:
+     * a bitmap of the tuples a scan can see, followed by a column-major
+     * copy of each fixed-width numeric column. Scans with a predicate
+     * then evaluate simple comparisons on those columns without reading
+     * the tuples. Call once the columns are set and before any scan.
+     */
+    void enableColumnPages();
+
+    bool hasColumnPages() const {
+        return m_columnPagesSize != 0;
+    }
+
+    // Byte offset of a column's page within a block's column pages, or -1
+    // if the column is only kept in the tuples.
+    int32_t columnPageOffset(int columnIndex) const {
+        return m_columnPageOffsets[columnIndex];
+    }
+
+    /*
+     * Return the column pages of one of this table's blocks, rebuilding
+     * them from the tuples first if they are stale.
+     */
+    char *refreshColumnPages(TBPtr block);
+
+    // ------------------------------------------------------------------
+    // STRING DICTIONARIES
+    // ------------------------------------------------------------------
+    /*
+     * Dictionary encode a VARCHAR or VARBINARY column that is stored
+     * outside the tuples: every distinct value is kept once, in a
+     * StringDictionary, and the tuples share it. Meant for columns with
+     * few distinct values. Inlined columns are left alone. Call once the
+     * columns are set and while the table is still empty.
+     */
+    void enableStringDictionary(int columnIndex);
+
+    // The dictionary of a column, or NULL if it is not dictionary encoded.
+    const StringDictionary *stringDictionary(int columnIndex) const {
+        return m_stringDictionaries.empty() ? NULL : m_stringDictionaries[columnIndex];
+    }
+
+    // Bytes of string data the table's dictionaries save, over all columns.
+    int64_t stringDictionaryBytesSaved() const;
+
     int partitionColumn() const { return m_partitionColumn; }
     /** inlined here because it can't be inlined in base Table, as it
      *  uses Tuple.copy.
@@ -342,6 +435,21 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     }
 
     void doIdleCompaction();
+
+    /**
+     * Compact the table's blocks until it no longer needs compacting or
+     * maxTuples tuples have been moved or maxMicros microseconds have
+     * passed, whichever comes first. Where a slice stopped is kept in the
+     * blocks themselves, so the next call carries on from there.
+     * Returns the number of tuples moved.
+     */
+    int64_t doIncrementalCompaction(int64_t maxTuples, int64_t maxMicros);
+
+    // Running totals of the work compaction has done, for the table stats
+    int64_t compactionBlocksMerged() const { return m_compactionBlocksMerged; }
+    int64_t compactionTuplesMoved() const { return m_compactionTuplesMoved; }
+    int64_t compactionMicros() const { return m_compactionMicros; }
+
     void printBucketInfo();
 
     void increaseStringMemCount(size_t bytes)
@@ -357,6 +465,9 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
         return m_data.size();
     }
 
+    // The tuple blocks and the column pages allocated for them
+    int64_t allocatedTupleMemory() const;
+
     // This is a testability feature not intended for use in product logic.
     int visibleTupleCount() const { return m_tupleCount - m_invisibleTuplesPendingDeleteCount; }
 
@@ -403,18 +514,40 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     }
 
     void nextFreeTuple(TableTuple *tuple);
-    bool doCompactionWithinSubset(TBBucketMap *bucketMap);
+    bool doCompactionWithinSubset(TBBucketMap *bucketMap, int64_t maxTuples = INT64_MAX);
     void doForcedCompaction();
 
     void insertIntoAllIndexes(TableTuple *tuple);
     void deleteFromAllIndexes(TableTuple *tuple);
     bool tryInsertOnAllIndexes(TableTuple *tuple);
+    bool tryBulkInsertOnAllIndexes(const std::vector<TableTuple> &tuples);
     bool checkUpdateOnUniqueIndexes(TableTuple &targetTupleToUpdate,
                                     const TableTuple &sourceTupleWithNewValues,
                                     std::vector<TableIndex*> const &indexesToUpdate);
 
     bool checkNulls(TableTuple &tuple) const;
 
+    // Trade the strings just copied into the dictionary encoded columns of
+    // a tuple for their dictionaries' entries, swapping the entries in for
+    // the copies among newObjects too if given.
+    void internStrings(TableTuple &tuple, std::vector<char*> *newObjects = NULL) {
+        if ( ! m_dictionaryColumns.empty()) {
+            internDictionaryColumns(tuple, newObjects);
+        }
+    }
+    void internDictionaryColumns(TableTuple &tuple, std::vector<char*> *newObjects);
+
+    // Mark the column pages of a tuple's block stale after changing the
+    // tuple in place.
+    void columnPagesChanged(TableTuple &tuple) {
+        if (m_columnPagesSize != 0) {
+            TBPtr block = findBlock(tuple.address(), m_data, m_tableAllocationSize);
+            if (block.get() != NULL) {
+                block->markColumnPagesStale();
+            }
+        }
+    }
+
     // Zero allocation size uses defaults.
     PersistentTable(int partitionColumn, int tableAllocationTargetSize = 0);
     void onSetColumns();
@@ -439,6 +572,12 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     void deleteTupleForUndo(char* tupleData, bool skipLookup = false);
     void deleteTupleRelease(char* tuple);
     void deleteTupleFinalize(TableTuple &tuple);
+    bool canDetachAllBlocks() const;
+    void detachAllBlocks(TBMap &detachedBlocks, uint32_t &tupleCount, int64_t &nonInlinedMemorySize);
+    void detachAllIndexEntries(std::vector<DetachedIndexEntries*> &detachedEntries);
+    void truncateTableForUndo(TBMap &detachedBlocks, std::vector<DetachedIndexEntries*> &detachedEntries,
+                              uint32_t tupleCount, int64_t nonInlinedMemorySize);
+    void truncateTableRelease(TBMap &detachedBlocks, std::vector<DetachedIndexEntries*> &detachedEntries);
     /**
      * Normally this will return the tuple storage to the free list.
      * In the memcheck build it will return the storage to the heap.
@@ -496,12 +635,26 @@ class PersistentTable : public Table, public UndoQuantumReleaseInterest,
     // pointers to chunks of data. Specific to table impl. Don't leak this type.
     TBMap m_data;
     int m_failedCompactionCount;
+    int64_t m_compactionBlocksMerged;
+    int64_t m_compactionTuplesMoved;
+    int64_t m_compactionMicros;
 
     // This is a testability feature not intended for use in product logic.
     int m_invisibleTuplesPendingDeleteCount;
 
     // Surgeon passed to classes requiring "deep" access to avoid excessive friendship.
     PersistentTableSurgeon m_surgeon;
+
+    // Layout of each block's column pages; a size of 0 means the table
+    // keeps none. The pages start with a bitmap of the visible tuples.
+    size_t m_columnPagesSize;
+    std::vector<int32_t> m_columnPageOffsets;
+    std::vector<int> m_pagedColumns;
+
+    // Dictionaries of the dictionary encoded columns, by column index, and
+    // the indexes of those columns. Both are empty if there are none.
+    std::vector<StringDictionary*> m_stringDictionaries;
+    std::vector<int> m_dictionaryColumns;
 };
 
 inline PersistentTableSurgeon::PersistentTableSurgeon(PersistentTable &table) :
@@ -542,6 +695,26 @@ inline void PersistentTableSurgeon::deleteTupleStorage(TableTuple &tuple, TBPtr
     m_table.deleteTupleStorage(tuple, block);
 }
 
+inline void PersistentTableSurgeon::detachAllBlocks(TBMap &detachedBlocks, uint32_t &tupleCount,
+                                                    int64_t &nonInlinedMemorySize) {
+    m_table.detachAllBlocks(detachedBlocks, tupleCount, nonInlinedMemorySize);
+}
+
+inline void PersistentTableSurgeon::detachAllIndexEntries(std::vector<DetachedIndexEntries*> &detachedEntries) {
+    m_table.detachAllIndexEntries(detachedEntries);
+}
+
+inline void PersistentTableSurgeon::truncateTableForUndo(TBMap &detachedBlocks,
+                                                         std::vector<DetachedIndexEntries*> &detachedEntries,
+                                                         uint32_t tupleCount, int64_t nonInlinedMemorySize) {
+    m_table.truncateTableForUndo(detachedBlocks, detachedEntries, tupleCount, nonInlinedMemorySize);
+}
+
+inline void PersistentTableSurgeon::truncateTableRelease(TBMap &detachedBlocks,
+                                                         std::vector<DetachedIndexEntries*> &detachedEntries) {
+    m_table.truncateTableRelease(detachedBlocks, detachedEntries);
+}
+
 inline void PersistentTableSurgeon::snapshotFinishedScanningBlock(TBPtr finishedBlock, TBPtr nextBlock) {
     m_table.snapshotFinishedScanningBlock(finishedBlock, nextBlock);
 }
@@ -521,11 +521,21 @@ void Table::addIndex(TableIndex *index) {
 
     assert(!isExistingTableIndex(m_indexes, index));
 
-    // fill the index with tuples... potentially the slow bit
+    // fill the index with tuples... potentially the slow bit, so they go in
+    // all at once, which lets a tree index sort them (on several threads)
+    // and build itself bottom up
+    std::vector<TableTuple> tuples;
+    tuples.reserve(activeTupleCount());
     TableTuple tuple(m_schema);
     TableIterator iter = iterator();
     while (iter.next(tuple)) {
-        index->addEntry(&tuple);
+        tuples.push_back(tuple);
+    }
+    if ( ! index->addEntriesInBulk(tuples)) {
+        // a unique key is taken twice; keep the first of each as before
+        for (size_t i = 0; i < tuples.size(); ++i) {
+            index->addEntry(&tuples[i]);
+        }
     }
 
     // add the index to the table
@@ -82,7 +82,6 @@ class StatsSource;
 class StreamBlock;
 class Topend;
 class TupleBlock;
-class PersistentTableUndoDeleteAction;
 
 const size_t COLUMN_DESCRIPTOR_SIZE = 1 + 4 + 4; // type, name offset, name length
 
@@ -102,7 +101,6 @@ class Table {
     friend class TableStats;
     friend class StatsSource;
     friend class TupleBlock;
-    friend class PersistentTableUndoDeleteAction;
 
   private:
     Table();
@@ -269,9 +267,9 @@ class Table {
      * Loads only tuple data and assumes there is no schema present.
      * Used for recovery where the schema is not sent.
      */
-    void loadTuplesFromNoHeader(SerializeInput &serialize_in,
-                                Pool *stringPool = NULL,
-                                ReferenceSerializeOutput *uniqueViolationOutput = NULL);
+    virtual void loadTuplesFromNoHeader(SerializeInput &serialize_in,
+                                        Pool *stringPool = NULL,
+                                        ReferenceSerializeOutput *uniqueViolationOutput = NULL);
 
     /**
      * Loads only tuple data, not schema, from the serialized table.
@@ -65,7 +65,8 @@ Table* TableFactory::getPersistentTable(
             int partitionColumn,
             bool exportEnabled,
             bool exportOnly,
-            int tableAllocationTargetSize)
+            int tableAllocationTargetSize,
+            bool columnPages)
 {
     Table *table = NULL;
 
@@ -78,6 +79,11 @@ Table* TableFactory::getPersistentTable(
 
     initCommon(databaseId, table, name, schema, columnNames, true);
 
+    // column pages are laid out from the columns, so they come after them
+    if (columnPages && !exportOnly) {
+        static_cast<PersistentTable*>(table)->enableColumnPages();
+    }
+
     // initialize stats for the table
     configureStats(databaseId, name, table);
 
@@ -83,7 +83,8 @@ public:
         int partitionColumn = -1, // defaults provided for ease of testing.
         bool exportEnabled = false,
         bool exportOnly = false,
-        int tableAllocationTargetSize = 0);
+        int tableAllocationTargetSize = 0,
+        bool columnPages = false);
 
     /**
     * Creates an empty temp table with given name and columns.
@@ -0,0 +1,1261 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPACTINGBTREE_H_
+#define COMPACTINGBTREE_H_
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include <new>
+#include <cassert>
+#include <boost/type_traits/has_trivial_destructor.hpp>
+#include "ContiguousAllocator.h"
+
+namespace voltdb {
+
+/**
+ * B+tree with the same loose, stl::map-like interface as CompactingMap,
+ * so the two can be swapped under the tree indexes.
+ *
+ * Each node is sized to span a handful of cache lines and holds many
+ * keys, so a lookup touches a few wide nodes instead of one node per
+ * level of a binary tree, and a range scan walks runs of adjacent keys
+ * through the doubly linked leaf chain.
+ *
+ * Like CompactingMap, leaf and inner nodes are tightly packed into two
+ * ContiguousAllocators. When a node is freed by a merge, the last node of
+ * the same kind is moved into the hole so that memory stays contiguous
+ * and can be returned to the operating system.
+ *
+ * Inner node separators are always exact copies of the smallest key of
+ * the subtree to their right. Keeping them exact means a separator never
+ * refers to non-inlined data that has been freed along with a deleted
+ * tuple. It also means that key types whose assignment operator transfers
+ * ownership of out-of-line storage (GenericPersistentKey) must NOT be used
+ * with this container.
+ *
+ * When hasRank is true, every inner node tracks the number of entries
+ * under each of its children, which supports rankAsc/rankUpper/findRank
+ * in O(log n) like the counting CompactingMap.
+ *
+ * The same caveats as CompactingMap apply:
+ * 1. Entries are moved in memory by assignment on every insert/delete.
+ * 2. Iterators are invalidated by any mutation of the tree.
+ * 3. Iterators are compared with equals(), not ==.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank=false>
+class CompactingBTree {
+protected:
+    // Target footprint of a node. A leaf of 8-byte keys holds ~30 entries.
+    static const int NODE_BYTES = 512;
+    static const int LEAF_HEADER_BYTES = static_cast<int>(3 * sizeof(void*) + sizeof(int64_t));
+    static const int INNER_HEADER_BYTES = static_cast<int>(sizeof(void*) + sizeof(int64_t));
+    static const int LEAF_FIT =
+        (NODE_BYTES - LEAF_HEADER_BYTES) / static_cast<int>(sizeof(Key) + sizeof(Data));
+    static const int INNER_FIT =
+        (NODE_BYTES - INNER_HEADER_BYTES) /
+        static_cast<int>(sizeof(Key) + sizeof(void*) + (hasRank ? sizeof(int64_t) : 0));
+
+    // maximum number of entries in a leaf and of children of an inner node
+    static const int LEAF_CAPACITY = LEAF_FIT > 4 ? LEAF_FIT : 4;
+    static const int INNER_CAPACITY = INNER_FIT > 4 ? INNER_FIT : 4;
+    // non-root nodes never drop below half full
+    static const int LEAF_MIN = LEAF_CAPACITY / 2;
+    static const int INNER_MIN = INNER_CAPACITY / 2;
+
+    // number of nodes per ContiguousAllocator buffer
+    static const int LEAF_CHUNK = 1000;
+    static const int INNER_CHUNK = 100;
+
+    struct InnerNode;
+
+    struct LeafNode {
+        InnerNode *parent;
+        LeafNode *prev;
+        LeafNode *next;
+        int32_t count;
+        Key keys[LEAF_CAPACITY];
+        Data values[LEAF_CAPACITY];
+    };
+
+    struct InnerNode {
+        InnerNode *parent;
+        int32_t count;          // number of children
+        bool leafChildren;      // children are LeafNodes rather than InnerNodes
+        // keys[i] is the smallest key under children[i + 1]
+        Key keys[INNER_CAPACITY - 1];
+        void *children[INNER_CAPACITY];
+        // entries under each child, only allocated if hasRank (must stay last)
+        int64_t subcts[INNER_CAPACITY];
+    };
+
+    int64_t m_count;
+    // a LeafNode when m_height is 0, otherwise an InnerNode; NULL when empty
+    void *m_root;
+    int32_t m_height;
+    LeafNode *m_first;
+    LeafNode *m_last;
+    ContiguousAllocator m_leafAllocator;
+    ContiguousAllocator m_innerAllocator;
+    bool m_unique;
+
+    // templated comparison function object
+    // follows STL conventions
+    Compare m_comper;
+
+public:
+
+    class iterator {
+        friend class CompactingBTree<Key, Data, Compare, hasRank>;
+    protected:
+        LeafNode *m_leaf;
+        int32_t m_pos;
+        iterator(LeafNode *leaf, int32_t pos) : m_leaf(leaf), m_pos(pos) {}
+    public:
+        iterator() : m_leaf(NULL), m_pos(0) {}
+        iterator(const iterator &iter) : m_leaf(iter.m_leaf), m_pos(iter.m_pos) {}
+        Key &key() const { return m_leaf->keys[m_pos]; }
+        Data &value() const { return m_leaf->values[m_pos]; }
+        void setValue(const Data &value) { m_leaf->values[m_pos] = value; }
+        void moveNext() {
+            if (!m_leaf) return;
+            if (++m_pos >= m_leaf->count) {
+                m_leaf = m_leaf->next;
+                m_pos = 0;
+            }
+        }
+        void movePrev() {
+            if (!m_leaf) return;
+            if (--m_pos < 0) {
+                m_leaf = m_leaf->prev;
+                m_pos = m_leaf ? m_leaf->count - 1 : 0;
+            }
+        }
+        bool isEnd() const { return m_leaf == NULL; }
+        bool equals(const iterator &iter) const {
+            if (isEnd()) return iter.isEnd();
+            return m_leaf == iter.m_leaf && m_pos == iter.m_pos;
+        }
+    };
+
+    CompactingBTree(bool unique, Compare comper);
+    ~CompactingBTree();
+
+    bool insert(std::pair<Key, Data> value);
+    // A syntactically convenient analog to CompactingHashTable's insert function
+    bool insert(const Key &key, const Data &data) { return insert(std::pair<Key, Data>(key, data)); }
+    bool erase(const Key &key);
+    bool erase(iterator &iter);
+    iterator find(const Key &key);
+    iterator findRank(int64_t ith) { return lookupRank(ith); }
+    int64_t size() const { return m_count; }
+    iterator begin() const { return iterator(m_first, 0); }
+    iterator rbegin() const {
+        if (!m_last) return iterator();
+        return iterator(m_last, m_last->count - 1);
+    }
+
+    iterator lowerBound(const Key &key);
+    iterator upperBound(const Key &key);
+
+    std::pair<iterator, iterator> equalRange(const Key &key);
+
+    /**
+     * Lookups starting from hint, an iterator returned by an earlier
+     * lookup. When the answer must lie in hint's leaf or the one after it,
+     * that leaf is searched directly instead of descending from the root,
+     * so lookups made in key order mostly skip the descent. The hint must
+     * still be valid, that is, the tree must not have changed since it was
+     * returned; an end iterator is always a valid (useless) hint.
+     */
+    iterator lowerBound(const Key &key, const iterator &hint);
+    iterator upperBound(const Key &key, const iterator &hint);
+    std::pair<iterator, iterator> equalRange(const Key &key, const iterator &hint);
+
+    /** Remove every entry, giving all node memory back at once. */
+    void clear();
+
+    /** Trade all entries with another tree, without touching them. */
+    void swap(CompactingBTree &other);
+
+    /**
+     * Fill the empty tree with count entries sorted by key (with no two
+     * keys equal if the tree is unique), packing them into full leaves
+     * and building the inner levels bottom up instead of inserting and
+     * splitting one entry at a time.
+     */
+    void bulkLoad(const std::pair<Key, Data> *entries, int64_t count);
+
+    size_t bytesAllocated() const {
+        return m_leafAllocator.bytesAllocated() + m_innerAllocator.bytesAllocated();
+    }
+
+    // Must pass a key that already in map, or else return -1
+    int64_t rankAsc(const Key& key);
+    int64_t rankUpper(const Key& key);
+
+    static const char *typeName() { return "CompactingBTree"; }
+
+    /**
+     * For debugging: verify the B+tree constraints are met. SLOW.
+     */
+    bool verify() const;
+    bool verifyRank();
+
+protected:
+    // descend to the leaf that would hold the lower/upper bound of key
+    LeafNode *findLeaf(const Key &key, bool upper) const;
+    LeafNode *findLeafNear(const LeafNode *hint, const Key &key, bool upper) const;
+    int32_t searchLeaf(const LeafNode *leaf, const Key &key, bool upper) const;
+    int32_t searchInner(const InnerNode *node, const Key &key, bool upper) const;
+    iterator lookupRank(int64_t ith) const;
+    int64_t rankOf(const iterator &iter) const;
+
+    static int32_t childIndex(const InnerNode *parent, const void *child);
+    static void setParent(void *child, bool isLeaf, InnerNode *parent);
+    static int64_t subtreeCount(const InnerNode *node);
+    void adjustSubcts(LeafNode *leaf, int64_t delta);
+
+    LeafNode *allocLeaf();
+    InnerNode *allocInner(bool leafChildren);
+    void freeLeaf(LeafNode *leaf);
+    void freeInner(InnerNode *node, InnerNode *&watched);
+    static void resetKey(Key &key);
+    static void resetEntry(LeafNode *leaf, int32_t pos);
+
+    // sub functions to make the magic happen
+    void insertIntoLeaf(LeafNode *leaf, int32_t pos, const Key &key, const Data &data);
+    void insertChild(LeafNode *left, void *right, bool rightIsLeaf, const Key &separator);
+    void insertIntoInner(InnerNode *node, int32_t index, const Key &separator,
+                         void *right, int64_t rightCount);
+    void refreshSeparator(LeafNode *leaf);
+    void removeChild(InnerNode *node, int32_t index);
+    void rebalanceLeaf(LeafNode *leaf);
+    void rebalanceInner(InnerNode *node);
+
+    // debugging and testing methods
+    int verify(const void *node, bool isLeaf, const InnerNode *parent,
+               const Key *low, const Key *high, int64_t *entries) const;
+};
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+CompactingBTree<Key, Data, Compare, hasRank>::CompactingBTree(bool unique, Compare comper)
+    : m_count(0),
+      m_root(NULL),
+      m_height(0),
+      m_first(NULL),
+      m_last(NULL),
+      m_leafAllocator(static_cast<int32_t>(sizeof(LeafNode)), LEAF_CHUNK),
+      m_innerAllocator(static_cast<int32_t>(sizeof(InnerNode) -
+                                            (hasRank ? 0 : sizeof(int64_t) * INNER_CAPACITY)),
+                       INNER_CHUNK),
+      m_unique(unique),
+      m_comper(comper)
+{}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+CompactingBTree<Key, Data, Compare, hasRank>::~CompactingBTree() {
+    clear();
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::swap(CompactingBTree &other) {
+    std::swap(m_count, other.m_count);
+    std::swap(m_root, other.m_root);
+    std::swap(m_height, other.m_height);
+    std::swap(m_first, other.m_first);
+    std::swap(m_last, other.m_last);
+    m_leafAllocator.swap(other.m_leafAllocator);
+    m_innerAllocator.swap(other.m_innerAllocator);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::clear() {
+    // nodes need visiting only if keys or values have destructors to run
+    if (!boost::has_trivial_destructor<Key>::value || !boost::has_trivial_destructor<Data>::value) {
+        while (m_leafAllocator.count()) {
+            static_cast<LeafNode*>(m_leafAllocator.last())->~LeafNode();
+            m_leafAllocator.trim();
+        }
+        while (m_innerAllocator.count()) {
+            static_cast<InnerNode*>(m_innerAllocator.last())->~InnerNode();
+            m_innerAllocator.trim();
+        }
+    }
+    m_leafAllocator.clear();
+    m_innerAllocator.clear();
+    m_count = 0;
+    m_root = NULL;
+    m_height = 0;
+    m_first = NULL;
+    m_last = NULL;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::bulkLoad(const std::pair<Key, Data> *entries,
+                                                            int64_t count) {
+    assert(m_count == 0);
+    if (count == 0) return;
+
+    // Each level spreads its nodes evenly over as few parents as will hold
+    // them, so that no node but the root is less than half full. For every
+    // node of the level being built, remember its entry count and the
+    // smallest key under it, which becomes its separator in the parent.
+    std::vector<void*> level;
+    std::vector<int64_t> counts;
+    std::vector<const Key*> lows;
+
+    const int64_t leaves = (count + LEAF_CAPACITY - 1) / LEAF_CAPACITY;
+    level.reserve(leaves);
+    counts.reserve(leaves);
+    lows.reserve(leaves);
+    int64_t next = 0;
+    LeafNode *prev = NULL;
+    for (int64_t i = 0; i < leaves; i++) {
+        const int32_t size = static_cast<int32_t>(count / leaves + (i < count % leaves ? 1 : 0));
+        LeafNode *leaf = allocLeaf();
+        for (int32_t j = 0; j < size; j++, next++) {
+            leaf->keys[j] = entries[next].first;
+            leaf->values[j] = entries[next].second;
+        }
+        leaf->count = size;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else m_first = leaf;
+        prev = leaf;
+        level.push_back(leaf);
+        counts.push_back(size);
+        lows.push_back(&leaf->keys[0]);
+    }
+    m_last = prev;
+
+    bool leafChildren = true;
+    m_height = 0;
+    while (level.size() > 1) {
+        const int64_t children = static_cast<int64_t>(level.size());
+        const int64_t parents = (children + INNER_CAPACITY - 1) / INNER_CAPACITY;
+        std::vector<void*> upperLevel;
+        std::vector<int64_t> upperCounts;
+        std::vector<const Key*> upperLows;
+        upperLevel.reserve(parents);
+        upperCounts.reserve(parents);
+        upperLows.reserve(parents);
+        int64_t child = 0;
+        for (int64_t i = 0; i < parents; i++) {
+            const int32_t size = static_cast<int32_t>(children / parents +
+                                                      (i < children % parents ? 1 : 0));
+            InnerNode *node = allocInner(leafChildren);
+            int64_t entriesUnder = 0;
+            upperLows.push_back(lows[child]);
+            for (int32_t j = 0; j < size; j++, child++) {
+                node->children[j] = level[child];
+                setParent(level[child], leafChildren, node);
+                if (j > 0) node->keys[j - 1] = *lows[child];
+                if (hasRank) node->subcts[j] = counts[child];
+                entriesUnder += counts[child];
+            }
+            node->count = size;
+            upperLevel.push_back(node);
+            upperCounts.push_back(entriesUnder);
+        }
+        level.swap(upperLevel);
+        counts.swap(upperCounts);
+        lows.swap(upperLows);
+        leafChildren = false;
+        m_height++;
+    }
+    m_root = level[0];
+    m_count = count;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingBTree<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> value) {
+    if (m_root == NULL) {
+        LeafNode *leaf = allocLeaf();
+        leaf->parent = NULL;
+        m_root = m_first = m_last = leaf;
+        m_height = 0;
+    }
+
+    LeafNode *leaf;
+    int32_t pos;
+    if (m_unique) {
+        leaf = findLeaf(value.first, false);
+        pos = searchLeaf(leaf, value.first, false);
+        // an equal key is either at pos or, at a leaf boundary, first in the next leaf
+        if (pos < leaf->count) {
+            if (m_comper(leaf->keys[pos], value.first) == 0) return false;
+        }
+        else if (leaf->next && m_comper(leaf->next->keys[0], value.first) == 0) {
+            return false;
+        }
+    }
+    else {
+        // duplicates go after all existing equal keys
+        leaf = findLeaf(value.first, true);
+        pos = searchLeaf(leaf, value.first, true);
+    }
+
+    insertIntoLeaf(leaf, pos, value.first, value.second);
+    m_count++;
+    assert(m_count > 0);
+    return true;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingBTree<Key, Data, Compare, hasRank>::erase(const Key &key) {
+    iterator iter = find(key);
+    if (iter.isEnd()) return false;
+    return erase(iter);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingBTree<Key, Data, Compare, hasRank>::erase(iterator &iter) {
+    assert(!iter.isEnd());
+    LeafNode *leaf = iter.m_leaf;
+    const int32_t pos = iter.m_pos;
+    assert(pos >= 0 && pos < leaf->count);
+
+    for (int32_t i = pos; i < leaf->count - 1; i++) {
+        leaf->keys[i] = leaf->keys[i + 1];
+        leaf->values[i] = leaf->values[i + 1];
+    }
+    leaf->count--;
+    resetEntry(leaf, leaf->count);
+    m_count--;
+    if (hasRank) adjustSubcts(leaf, -1);
+
+    if (leaf->parent == NULL) {
+        // the root leaf only goes away with the last entry
+        if (leaf->count == 0) {
+            freeLeaf(leaf);
+            m_root = m_first = m_last = NULL;
+        }
+        return true;
+    }
+
+    if (pos == 0) {
+        refreshSeparator(leaf);
+    }
+    if (leaf->count < LEAF_MIN) {
+        rebalanceLeaf(leaf);
+    }
+    return true;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::find(const Key &key) {
+    iterator iter = lowerBound(key);
+    if (iter.isEnd() || m_comper(iter.key(), key) != 0) {
+        return iterator();
+    }
+    return iter;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::lowerBound(const Key &key) {
+    if (m_root == NULL) return iterator();
+    LeafNode *leaf = findLeaf(key, false);
+    int32_t pos = searchLeaf(leaf, key, false);
+    if (pos == leaf->count) return iterator(leaf->next, 0);
+    return iterator(leaf, pos);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::upperBound(const Key &key) {
+    if (m_root == NULL) return iterator();
+    LeafNode *leaf = findLeaf(key, true);
+    int32_t pos = searchLeaf(leaf, key, true);
+    if (pos == leaf->count) return iterator(leaf->next, 0);
+    return iterator(leaf, pos);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename std::pair<typename CompactingBTree<Key, Data, Compare, hasRank>::iterator,
+                   typename CompactingBTree<Key, Data, Compare, hasRank>::iterator>
+CompactingBTree<Key, Data, Compare, hasRank>::equalRange(const Key &key) {
+    return std::pair<iterator, iterator>(lowerBound(key), upperBound(key));
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::lowerBound(const Key &key, const iterator &hint) {
+    if (m_root == NULL) return iterator();
+    LeafNode *leaf = findLeafNear(hint.m_leaf, key, false);
+    if (leaf == NULL) return lowerBound(key);
+    return iterator(leaf, searchLeaf(leaf, key, false));
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::upperBound(const Key &key, const iterator &hint) {
+    if (m_root == NULL) return iterator();
+    LeafNode *leaf = findLeafNear(hint.m_leaf, key, true);
+    if (leaf == NULL) return upperBound(key);
+    return iterator(leaf, searchLeaf(leaf, key, true));
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename std::pair<typename CompactingBTree<Key, Data, Compare, hasRank>::iterator,
+                   typename CompactingBTree<Key, Data, Compare, hasRank>::iterator>
+CompactingBTree<Key, Data, Compare, hasRank>::equalRange(const Key &key, const iterator &hint) {
+    iterator lower = lowerBound(key, hint);
+    return std::pair<iterator, iterator>(lower, upperBound(key, lower.isEnd() ? hint : lower));
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+int64_t CompactingBTree<Key, Data, Compare, hasRank>::rankAsc(const Key& key) {
+    if (!hasRank) return -1;
+    iterator iter = find(key);
+    // return -1 if the key passed in is not in the map
+    if (iter.isEnd()) return -1;
+    return rankOf(iter);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+int64_t CompactingBTree<Key, Data, Compare, hasRank>::rankUpper(const Key& key) {
+    if (!hasRank) return -1;
+    if (m_unique) return rankAsc(key);
+    if (find(key).isEnd()) return -1;
+    iterator iter = upperBound(key);
+    if (iter.isEnd()) return m_count;
+    return rankOf(iter) - 1;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::LeafNode *
+CompactingBTree<Key, Data, Compare, hasRank>::findLeaf(const Key &key, bool upper) const {
+    assert(m_root);
+    if (m_height == 0) return static_cast<LeafNode*>(m_root);
+    const InnerNode *node = static_cast<const InnerNode*>(m_root);
+    while (true) {
+        void *child = node->children[searchInner(node, key, upper)];
+        if (node->leafChildren) return static_cast<LeafNode*>(child);
+        node = static_cast<const InnerNode*>(child);
+    }
+}
+
+/*
+ * The leaf, of hint and the leaf after it, that holds the lower (or upper)
+ * bound of key at a position short of its count, or NULL if neither is
+ * certain to. Every key before a leaf is <= its first key, so the bound is
+ * in a leaf whose first key is < key (<= for upper) and whose last key is
+ * >= key (> for upper); for the following leaf, hint's last key stands in
+ * for its first.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::LeafNode *
+CompactingBTree<Key, Data, Compare, hasRank>::findLeafNear(const LeafNode *hint,
+                                                          const Key &key,
+                                                          bool upper) const {
+    if (hint == NULL) return NULL;
+    int cmp = m_comper(hint->keys[0], key);
+    if (cmp > 0 || (cmp == 0 && !upper)) return NULL;
+    cmp = m_comper(hint->keys[hint->count - 1], key);
+    if (cmp > 0 || (cmp == 0 && !upper)) return const_cast<LeafNode*>(hint);
+    const LeafNode *next = hint->next;
+    if (next == NULL) return NULL;
+    cmp = m_comper(next->keys[next->count - 1], key);
+    if (cmp > 0 || (cmp == 0 && !upper)) return const_cast<LeafNode*>(next);
+    return NULL;
+}
+
+/*
+ * Position of the first key >= key (or > key for upper) in a leaf.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline int32_t CompactingBTree<Key, Data, Compare, hasRank>::searchLeaf(const LeafNode *leaf,
+                                                                      const Key &key,
+                                                                      bool upper) const {
+    int32_t lo = 0;
+    int32_t hi = leaf->count;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) >> 1;
+        int cmp = m_comper(leaf->keys[mid], key);
+        if (cmp < 0 || (upper && cmp == 0)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * Index of the child to descend into: the number of separators < key
+ * (or <= key for upper).
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline int32_t CompactingBTree<Key, Data, Compare, hasRank>::searchInner(const InnerNode *node,
+                                                                       const Key &key,
+                                                                       bool upper) const {
+    int32_t lo = 0;
+    int32_t hi = node->count - 1;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) >> 1;
+        int cmp = m_comper(node->keys[mid], key);
+        if (cmp < 0 || (upper && cmp == 0)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::iterator
+CompactingBTree<Key, Data, Compare, hasRank>::lookupRank(int64_t ith) const {
+    if (!hasRank || ith <= 0 || ith > m_count) return iterator();
+    void *node = m_root;
+    for (int32_t level = m_height; level > 0; level--) {
+        const InnerNode *inner = static_cast<const InnerNode*>(node);
+        int32_t i = 0;
+        while (ith > inner->subcts[i]) {
+            ith -= inner->subcts[i];
+            i++;
+            assert(i < inner->count);
+        }
+        node = inner->children[i];
+    }
+    return iterator(static_cast<LeafNode*>(node), static_cast<int32_t>(ith - 1));
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+int64_t CompactingBTree<Key, Data, Compare, hasRank>::rankOf(const iterator &iter) const {
+    int64_t rank = iter.m_pos + 1;
+    const void *node = iter.m_leaf;
+    const InnerNode *parent = iter.m_leaf->parent;
+    while (parent) {
+        int32_t index = childIndex(parent, node);
+        for (int32_t i = 0; i < index; i++) {
+            rank += parent->subcts[i];
+        }
+        node = parent;
+        parent = parent->parent;
+    }
+    return rank;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline int32_t CompactingBTree<Key, Data, Compare, hasRank>::childIndex(const InnerNode *parent,
+                                                                      const void *child) {
+    int32_t i = 0;
+    while (parent->children[i] != child) {
+        i++;
+        assert(i < parent->count);
+    }
+    return i;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline void CompactingBTree<Key, Data, Compare, hasRank>::setParent(void *child, bool isLeaf,
+                                                                  InnerNode *parent) {
+    if (isLeaf) static_cast<LeafNode*>(child)->parent = parent;
+    else static_cast<InnerNode*>(child)->parent = parent;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline int64_t CompactingBTree<Key, Data, Compare, hasRank>::subtreeCount(const InnerNode *node) {
+    int64_t sum = 0;
+    for (int32_t i = 0; i < node->count; i++) {
+        sum += node->subcts[i];
+    }
+    return sum;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline void CompactingBTree<Key, Data, Compare, hasRank>::adjustSubcts(LeafNode *leaf, int64_t delta) {
+    const void *node = leaf;
+    InnerNode *parent = leaf->parent;
+    while (parent) {
+        parent->subcts[childIndex(parent, node)] += delta;
+        node = parent;
+        parent = parent->parent;
+    }
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::LeafNode *
+CompactingBTree<Key, Data, Compare, hasRank>::allocLeaf() {
+    void *memory = m_leafAllocator.alloc();
+    assert(memory);
+    // placement new, default-initialized so only the keys and values are constructed
+    LeafNode *leaf = new(memory) LeafNode;
+    leaf->parent = NULL;
+    leaf->prev = leaf->next = NULL;
+    leaf->count = 0;
+    return leaf;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingBTree<Key, Data, Compare, hasRank>::InnerNode *
+CompactingBTree<Key, Data, Compare, hasRank>::allocInner(bool leafChildren) {
+    void *memory = m_innerAllocator.alloc();
+    assert(memory);
+    // default-initialized: value-initializing would zero the subcts array
+    // that is not allocated when !hasRank
+    InnerNode *node = new(memory) InnerNode;
+    node->parent = NULL;
+    node->count = 0;
+    node->leafChildren = leafChildren;
+    return node;
+}
+
+/*
+ * Release a detached leaf, moving the last allocated leaf into its place.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::freeLeaf(LeafNode *hole) {
+    LeafNode *last = static_cast<LeafNode*>(m_leafAllocator.last());
+    if (last != hole) {
+        for (int32_t i = 0; i < last->count; i++) {
+            hole->keys[i] = last->keys[i];
+            hole->values[i] = last->values[i];
+        }
+        hole->count = last->count;
+        hole->parent = last->parent;
+        hole->prev = last->prev;
+        hole->next = last->next;
+
+        if (last->prev) last->prev->next = hole;
+        else m_first = hole;
+        if (last->next) last->next->prev = hole;
+        else m_last = hole;
+        if (last->parent) last->parent->children[childIndex(last->parent, last)] = hole;
+        else m_root = hole;
+    }
+    last->~LeafNode();
+    m_leafAllocator.trim();
+}
+
+/*
+ * Release a detached inner node, moving the last allocated inner node
+ * into its place. If that moves the node pointed to by watched, watched
+ * is updated to its new address.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::freeInner(InnerNode *hole, InnerNode *&watched) {
+    InnerNode *last = static_cast<InnerNode*>(m_innerAllocator.last());
+    if (last != hole) {
+        for (int32_t i = 0; i < last->count - 1; i++) {
+            hole->keys[i] = last->keys[i];
+        }
+        for (int32_t i = 0; i < last->count; i++) {
+            hole->children[i] = last->children[i];
+            setParent(hole->children[i], last->leafChildren, hole);
+            if (hasRank) hole->subcts[i] = last->subcts[i];
+        }
+        hole->count = last->count;
+        hole->leafChildren = last->leafChildren;
+        hole->parent = last->parent;
+
+        if (last->parent) last->parent->children[childIndex(last->parent, last)] = hole;
+        else m_root = hole;
+        if (watched == last) watched = hole;
+    }
+    last->~InnerNode();
+    m_innerAllocator.trim();
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline void CompactingBTree<Key, Data, Compare, hasRank>::resetKey(Key &key) {
+    key.~Key();
+    new(&key) Key();
+}
+
+/*
+ * Return a vacated slot to its default state so it does not hold on to
+ * anything the moved-out entry referenced.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+inline void CompactingBTree<Key, Data, Compare, hasRank>::resetEntry(LeafNode *leaf, int32_t pos) {
+    resetKey(leaf->keys[pos]);
+    leaf->values[pos].~Data();
+    new(&leaf->values[pos]) Data();
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::insertIntoLeaf(LeafNode *leaf, int32_t pos,
+                                                                const Key &key, const Data &data) {
+    // count the new entry on the way up before any split redistributes it
+    if (hasRank) adjustSubcts(leaf, 1);
+
+    if (leaf->count < LEAF_CAPACITY) {
+        for (int32_t i = leaf->count; i > pos; i--) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->values[i] = leaf->values[i - 1];
+        }
+        leaf->keys[pos] = key;
+        leaf->values[pos] = data;
+        leaf->count++;
+        return;
+    }
+
+    // split the full leaf, the upper half moves to a new right sibling
+    const int32_t split = (LEAF_CAPACITY + 1) / 2;
+    LeafNode *right = allocLeaf();
+    for (int32_t i = split; i < LEAF_CAPACITY; i++) {
+        right->keys[i - split] = leaf->keys[i];
+        right->values[i - split] = leaf->values[i];
+        resetEntry(leaf, i);
+    }
+    right->count = LEAF_CAPACITY - split;
+    leaf->count = split;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next) leaf->next->prev = right;
+    else m_last = right;
+    leaf->next = right;
+
+    LeafNode *target = leaf;
+    if (pos >= split) {
+        target = right;
+        pos -= split;
+    }
+    for (int32_t i = target->count; i > pos; i--) {
+        target->keys[i] = target->keys[i - 1];
+        target->values[i] = target->values[i - 1];
+    }
+    target->keys[pos] = key;
+    target->values[pos] = data;
+    target->count++;
+
+    insertChild(leaf, right, true, right->keys[0]);
+}
+
+/*
+ * Hook a freshly split off right sibling into the tree next to left.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::insertChild(LeafNode *left, void *right,
+                                                             bool rightIsLeaf, const Key &separator) {
+    assert(rightIsLeaf);
+    const int64_t rightCount = static_cast<LeafNode*>(right)->count;
+    if (left->parent == NULL) {
+        // grow a new root above the old root leaf
+        InnerNode *root = allocInner(true);
+        root->count = 2;
+        root->children[0] = left;
+        root->children[1] = right;
+        root->keys[0] = separator;
+        if (hasRank) {
+            root->subcts[0] = left->count;
+            root->subcts[1] = rightCount;
+        }
+        left->parent = root;
+        static_cast<LeafNode*>(right)->parent = root;
+        m_root = root;
+        m_height = 1;
+        return;
+    }
+    InnerNode *parent = left->parent;
+    int32_t index = childIndex(parent, left);
+    if (hasRank) parent->subcts[index] = left->count;
+    insertIntoInner(parent, index, separator, right, rightCount);
+}
+
+/*
+ * Insert right (holding rightCount entries) as the child after
+ * node->children[index], splitting node and its ancestors as needed.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::insertIntoInner(InnerNode *node, int32_t index,
+                                                                 const Key &separator,
+                                                                 void *right, int64_t rightCount) {
+    if (node->count == INNER_CAPACITY) {
+        // split first so that the target half has room
+        const int32_t split = (INNER_CAPACITY + 1) / 2;
+        InnerNode *sibling = allocInner(node->leafChildren);
+        const Key promoted = node->keys[split - 1];
+        resetKey(node->keys[split - 1]);
+        for (int32_t i = split; i < INNER_CAPACITY; i++) {
+            sibling->children[i - split] = node->children[i];
+            setParent(node->children[i], node->leafChildren, sibling);
+            if (hasRank) sibling->subcts[i - split] = node->subcts[i];
+            if (i < INNER_CAPACITY - 1) {
+                sibling->keys[i - split] = node->keys[i];
+                resetKey(node->keys[i]);
+            }
+        }
+        sibling->count = INNER_CAPACITY - split;
+        node->count = split;
+
+        InnerNode *target = node;
+        if (index >= split) {
+            target = sibling;
+            index -= split;
+        }
+        sibling->parent = node->parent;
+        insertIntoInner(target, index, separator, right, rightCount);
+
+        if (node->parent == NULL) {
+            InnerNode *root = allocInner(false);
+            root->count = 2;
+            root->children[0] = node;
+            root->children[1] = sibling;
+            root->keys[0] = promoted;
+            if (hasRank) {
+                root->subcts[0] = subtreeCount(node);
+                root->subcts[1] = subtreeCount(sibling);
+            }
+            node->parent = sibling->parent = root;
+            m_root = root;
+            m_height++;
+            return;
+        }
+        InnerNode *parent = node->parent;
+        int32_t parentIndex = childIndex(parent, node);
+        if (hasRank) parent->subcts[parentIndex] = subtreeCount(node);
+        insertIntoInner(parent, parentIndex, promoted, sibling, hasRank ? subtreeCount(sibling) : 0);
+        return;
+    }
+
+    for (int32_t i = node->count; i > index + 1; i--) {
+        node->children[i] = node->children[i - 1];
+        if (hasRank) node->subcts[i] = node->subcts[i - 1];
+        node->keys[i - 1] = node->keys[i - 2];
+    }
+    node->children[index + 1] = right;
+    if (hasRank) node->subcts[index + 1] = rightCount;
+    node->keys[index] = separator;
+    node->count++;
+    setParent(right, node->leafChildren, node);
+}
+
+/*
+ * The first key of leaf changed, update the separator that bounds it.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::refreshSeparator(LeafNode *leaf) {
+    if (leaf->count == 0) return;
+    const void *node = leaf;
+    InnerNode *parent = leaf->parent;
+    while (parent) {
+        int32_t index = childIndex(parent, node);
+        if (index > 0) {
+            parent->keys[index - 1] = leaf->keys[0];
+            return;
+        }
+        node = parent;
+        parent = parent->parent;
+    }
+}
+
+/*
+ * Drop node->children[index] (never the first child) and the separator
+ * in front of it.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::removeChild(InnerNode *node, int32_t index) {
+    assert(index > 0);
+    for (int32_t i = index; i < node->count - 1; i++) {
+        node->children[i] = node->children[i + 1];
+        if (hasRank) node->subcts[i] = node->subcts[i + 1];
+        node->keys[i - 1] = node->keys[i];
+    }
+    node->count--;
+    resetKey(node->keys[node->count - 1]);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::rebalanceLeaf(LeafNode *leaf) {
+    InnerNode *parent = leaf->parent;
+    const int32_t index = childIndex(parent, leaf);
+    LeafNode *left = index > 0 ? static_cast<LeafNode*>(parent->children[index - 1]) : NULL;
+    LeafNode *right = index < parent->count - 1 ? static_cast<LeafNode*>(parent->children[index + 1]) : NULL;
+
+    if (left && left->count > LEAF_MIN) {
+        // borrow the largest entry of the left sibling
+        for (int32_t i = leaf->count; i > 0; i--) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->values[i] = leaf->values[i - 1];
+        }
+        leaf->keys[0] = left->keys[left->count - 1];
+        leaf->values[0] = left->values[left->count - 1];
+        leaf->count++;
+        left->count--;
+        resetEntry(left, left->count);
+        if (hasRank) {
+            parent->subcts[index - 1]--;
+            parent->subcts[index]++;
+        }
+        parent->keys[index - 1] = leaf->keys[0];
+        return;
+    }
+
+    if (right && right->count > LEAF_MIN) {
+        // borrow the smallest entry of the right sibling
+        leaf->keys[leaf->count] = right->keys[0];
+        leaf->values[leaf->count] = right->values[0];
+        leaf->count++;
+        for (int32_t i = 0; i < right->count - 1; i++) {
+            right->keys[i] = right->keys[i + 1];
+            right->values[i] = right->values[i + 1];
+        }
+        right->count--;
+        resetEntry(right, right->count);
+        if (hasRank) {
+            parent->subcts[index]++;
+            parent->subcts[index + 1]--;
+        }
+        parent->keys[index] = right->keys[0];
+        if (leaf->count == 1) refreshSeparator(leaf);
+        return;
+    }
+
+    // merge with a sibling, always folding the right node into the left one
+    int32_t rightIndex = index;
+    if (left) {
+        right = leaf;
+    }
+    else {
+        left = leaf;
+        rightIndex = index + 1;
+    }
+    assert(right);
+    assert(left->count + right->count <= LEAF_CAPACITY);
+    for (int32_t i = 0; i < right->count; i++) {
+        left->keys[left->count + i] = right->keys[i];
+        left->values[left->count + i] = right->values[i];
+        resetEntry(right, i);
+    }
+    left->count += right->count;
+    right->count = 0;
+
+    left->next = right->next;
+    if (right->next) right->next->prev = left;
+    else m_last = left;
+
+    if (hasRank) parent->subcts[rightIndex - 1] += parent->subcts[rightIndex];
+    removeChild(parent, rightIndex);
+    freeLeaf(right);
+    rebalanceInner(parent);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingBTree<Key, Data, Compare, hasRank>::rebalanceInner(InnerNode *node) {
+    if (node->parent == NULL) {
+        // collapse a root with a single child
+        if (node->count == 1) {
+            m_root = node->children[0];
+            setParent(m_root, node->leafChildren, NULL);
+            m_height--;
+            node->count = 0;
+            InnerNode *unused = NULL;
+            freeInner(node, unused);
+        }
+        return;
+    }
+    if (node->count >= INNER_MIN) return;
+
+    InnerNode *parent = node->parent;
+    const int32_t index = childIndex(parent, node);
+    InnerNode *left = index > 0 ? static_cast<InnerNode*>(parent->children[index - 1]) : NULL;
+    InnerNode *right = index < parent->count - 1 ? static_cast<InnerNode*>(parent->children[index + 1]) : NULL;
+    const bool leafChildren = node->leafChildren;
+
+    if (left && left->count > INNER_MIN) {
+        // rotate the last child of the left sibling through the parent
+        for (int32_t i = node->count; i > 0; i--) {
+            node->children[i] = node->children[i - 1];
+            if (hasRank) node->subcts[i] = node->subcts[i - 1];
+            if (i > 1) node->keys[i - 1] = node->keys[i - 2];
+        }
+        node->keys[0] = parent->keys[index - 1];
+        node->children[0] = left->children[left->count - 1];
+        setParent(node->children[0], leafChildren, node);
+        if (hasRank) {
+            const int64_t moved = left->subcts[left->count - 1];
+            node->subcts[0] = moved;
+            parent->subcts[index - 1] -= moved;
+            parent->subcts[index] += moved;
+        }
+        node->count++;
+        parent->keys[index - 1] = left->keys[left->count - 2];
+        left->count--;
+        resetKey(left->keys[left->count - 1]);
+        return;
+    }
+
+    if (right && right->count > INNER_MIN) {
+        // rotate the first child of the right sibling through the parent
+        node->keys[node->count - 1] = parent->keys[index];
+        node->children[node->count] = right->children[0];
+        setParent(node->children[node->count], leafChildren, node);
+        if (hasRank) {
+            const int64_t moved = right->subcts[0];
+            node->subcts[node->count] = moved;
+            parent->subcts[index] += moved;
+            parent->subcts[index + 1] -= moved;
+        }
+        node->count++;
+        parent->keys[index] = right->keys[0];
+        for (int32_t i = 0; i < right->count - 1; i++) {
+            right->children[i] = right->children[i + 1];
+            if (hasRank) right->subcts[i] = right->subcts[i + 1];
+            if (i < right->count - 2) right->keys[i] = right->keys[i + 1];
+        }
+        right->count--;
+        resetKey(right->keys[right->count - 1]);
+        return;
+    }
+
+    // merge with a sibling, always folding the right node into the left one
+    int32_t rightIndex = index;
+    if (left) {
+        right = node;
+    }
+    else {
+        left = node;
+        rightIndex = index + 1;
+    }
+    assert(right);
+    assert(left->count + right->count <= INNER_CAPACITY);
+    left->keys[left->count - 1] = parent->keys[rightIndex - 1];
+    for (int32_t i = 0; i < right->count; i++) {
+        left->children[left->count + i] = right->children[i];
+        setParent(right->children[i], leafChildren, left);
+        if (hasRank) left->subcts[left->count + i] = right->subcts[i];
+        if (i < right->count - 1) {
+            left->keys[left->count + i] = right->keys[i];
+            resetKey(right->keys[i]);
+        }
+    }
+    left->count += right->count;
+    right->count = 0;
+
+    if (hasRank) parent->subcts[rightIndex - 1] += parent->subcts[rightIndex];
+    removeChild(parent, rightIndex);
+    freeInner(right, parent);
+    rebalanceInner(parent);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingBTree<Key, Data, Compare, hasRank>::verifyRank() {
+    if (!hasRank)
+        return true;
+
+    int64_t rank = 0;
+    int64_t equalRun = 0;
+    iterator prev;
+    for (iterator it = begin(); !it.isEnd(); it.moveNext()) {
+        rank++;
+        iterator byRank = findRank(rank);
+        if (!byRank.equals(it)) {
+            printf("false: findRank(%ld) does not match the iteration order\n", (long)rank);
+            return false;
+        }
+        if (!prev.isEnd() && m_comper(prev.key(), it.key()) == 0) equalRun++;
+        else equalRun = 0;
+        int64_t rkasc = rankAsc(it.key());
+        if (rkasc != rank - equalRun) {
+            printf("false: rankAsc expected %ld, but got %ld\n", (long)(rank - equalRun), (long)rkasc);
+            return false;
+        }
+        iterator next = it;
+        next.moveNext();
+        if (next.isEnd() || m_comper(next.key(), it.key()) != 0) {
+            int64_t rkupper = rankUpper(it.key());
+            if (rkupper != rank) {
+                printf("false: rankUpper expected %ld, but got %ld\n", (long)rank, (long)rkupper);
+                return false;
+            }
+        }
+        prev = it;
+    }
+    return rank == m_count;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+bool CompactingBTree<Key, Data, Compare, hasRank>::verify() const {
+    if (m_root == NULL) {
+        return m_count == 0 && m_first == NULL && m_last == NULL &&
+            m_leafAllocator.count() == 0 && m_innerAllocator.count() == 0;
+    }
+    int64_t entries = 0;
+    if (verify(m_root, m_height == 0, NULL, NULL, NULL, &entries) != m_height) return false;
+    if (entries != m_count) return false;
+
+    // the leaf chain visits every entry in order
+    int64_t chained = 0;
+    int64_t leaves = 0;
+    const LeafNode *prev = NULL;
+    for (const LeafNode *leaf = m_first; leaf; leaf = leaf->next) {
+        if (leaf->prev != prev) return false;
+        if (prev && m_comper(prev->keys[prev->count - 1], leaf->keys[0]) > 0) return false;
+        chained += leaf->count;
+        leaves++;
+        prev = leaf;
+    }
+    if (prev != m_last) return false;
+    if (chained != m_count) return false;
+    if (leaves != m_leafAllocator.count()) return false;
+    return true;
+}
+
+/*
+ * Returns the height of the subtree (0 for a leaf) or -1 on a violation.
+ * low and high (when not NULL) bound the keys allowed in the subtree.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+int CompactingBTree<Key, Data, Compare, hasRank>::verify(const void *node, bool isLeaf,
+                                                       const InnerNode *parent,
+                                                       const Key *low, const Key *high,
+                                                       int64_t *entries) const {
+    if (isLeaf) {
+        const LeafNode *leaf = static_cast<const LeafNode*>(node);
+        if (leaf->parent != parent) return -1;
+        if (leaf->count <= 0 || leaf->count > LEAF_CAPACITY) return -1;
+        if (parent && leaf->count < LEAF_MIN) return -1;
+        for (int32_t i = 1; i < leaf->count; i++) {
+            int cmp = m_comper(leaf->keys[i - 1], leaf->keys[i]);
+            if (cmp > 0 || (m_unique && cmp == 0)) return -1;
+        }
+        // separators are exact
+        if (low && m_comper(*low, leaf->keys[0]) != 0) return -1;
+        if (high && m_comper(leaf->keys[leaf->count - 1], *high) > 0) return -1;
+        *entries += leaf->count;
+        return 0;
+    }
+
+    const InnerNode *inner = static_cast<const InnerNode*>(node);
+    if (inner->parent != parent) return -1;
+    if (inner->count > INNER_CAPACITY) return -1;
+    if (parent ? inner->count < INNER_MIN : inner->count < 2) return -1;
+    int height = -1;
+    for (int32_t i = 0; i < inner->count; i++) {
+        if (i > 0 && i < inner->count - 1 && m_comper(inner->keys[i - 1], inner->keys[i]) > 0) return -1;
+        const Key *childLow = i > 0 ? &inner->keys[i - 1] : low;
+        const Key *childHigh = i < inner->count - 1 ? &inner->keys[i] : high;
+        int64_t childEntries = 0;
+        int childHeight = verify(inner->children[i], inner->leafChildren, inner,
+                                 childLow, childHigh, &childEntries);
+        if (childHeight < 0) return -1;
+        if (height >= 0 && childHeight != height) return -1;
+        height = childHeight;
+        if (hasRank && inner->subcts[i] != childEntries) return -1;
+        *entries += childEntries;
+    }
+    return height + 1;
+}
+
+} // namespace voltdb
+
+#endif // COMPACTINGBTREE_H_
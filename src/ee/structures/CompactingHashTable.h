@@ -18,14 +18,17 @@
 #ifndef COMPACTINGHASHTABLE_H_
 #define COMPACTINGHASHTABLE_H_
 
+#include <algorithm>
 #include <cstdlib>
 #include <utility>
 #include <cassert>
 #include <climits>
 #include <iostream>
 #include <cstring>
+#include <stdint.h>
 #include <sys/mman.h>
 #include <boost/functional/hash.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 #include "ContiguousAllocator.h"
 
 namespace voltdb {
@@ -159,6 +162,10 @@ namespace voltdb {
         iterator find(const Key &key) const;
         /** find an exact key/value match (optionaly searching by value first) */
         iterator find(const Key &key, const Data &value) const;
+        /** start loading the bucket a find for key will read, ahead of the find */
+        void prefetch(const Key &key) const {
+            __builtin_prefetch(&m_buckets[m_hasher(key) % TABLE_SIZES[m_sizeIndex]]);
+        }
         /** simple insert */
         bool insert(const Key &key, const Data &value);
         /** delete by key (unique only) */
@@ -169,6 +176,12 @@ namespace voltdb {
         bool erase(iterator &iter);
         /** STL-ish size() method */
         size_t size() const { return m_count; }
+        /** remove everything, shrinking back to the initial table size */
+        void clear();
+        /** trade all items with another table, without touching them */
+        void swap(CompactingHashTable &other);
+        /** make room for count distinct keys without growing */
+        void reserve(uint64_t count);
 
         /** Return bytes used for this index */
         size_t bytesAllocated() const { return m_allocator.bytesAllocated() + TABLE_SIZES[m_sizeIndex] * sizeof(HashNode*); }
@@ -190,6 +203,9 @@ namespace voltdb {
         /** after remove, ensure memory for hashnodes is contiguous */
         void deleteAndFixup(HashNode *node);
 
+        /** unlink and destruct every node */
+        void destroyAllNodes();
+
         /** see if the hash needs to grow or shrink */
         void checkLoadFactor();
         /** grow/shrink the hash table */
@@ -259,6 +275,46 @@ namespace voltdb {
 
     template<class K, class T, class H, class EK, class ET>
     CompactingHashTable<K, T, H, EK, ET>::~CompactingHashTable() {
+        destroyAllNodes();
+
+        // delete the hashtable
+        munmap(m_buckets, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
+
+        // when the allocator gets cleaned up, it will
+        // free the memory used for nodes
+    }
+
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::clear() {
+        // nodes need visiting only if keys or values have destructors to run
+        if (!boost::has_trivial_destructor<Key>::value || !boost::has_trivial_destructor<Data>::value) {
+            destroyAllNodes();
+        }
+        m_allocator.clear();
+        m_count = 0;
+        m_uniqueCount = 0;
+
+        // go back to the initial table size
+        munmap(m_buckets, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
+        m_sizeIndex = BUCKET_INITIAL_INDEX;
+        void *memory = mmap(NULL, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex], PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        assert(memory);
+        m_buckets = reinterpret_cast<HashNode**>(memory);
+        memset(m_buckets, 0, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
+    }
+
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::swap(CompactingHashTable &other) {
+        assert(m_unique == other.m_unique);
+        std::swap(m_buckets, other.m_buckets);
+        std::swap(m_count, other.m_count);
+        std::swap(m_uniqueCount, other.m_uniqueCount);
+        std::swap(m_sizeIndex, other.m_sizeIndex);
+        m_allocator.swap(other.m_allocator);
+    }
+
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::destroyAllNodes() {
         // unlink all of the nodes, which will call destructors correctly
         for (size_t i = 0; i < TABLE_SIZES[m_sizeIndex]; ++i) {
             while (m_buckets[i]) {
@@ -272,12 +328,6 @@ namespace voltdb {
                 (reinterpret_cast<HashNodeSmall*>(node))->~HashNodeSmall();
             }
         }
-
-        // delete the hashtable
-        munmap(m_buckets, sizeof(HashNode*) * TABLE_SIZES[m_sizeIndex]);
-
-        // when the allocator gets cleaned up, it will
-        // free the memory used for nodes
     }
 
     template<class K, class T, class H, class EK, class ET>
@@ -421,7 +471,11 @@ namespace voltdb {
             m_uniqueCount++;
         }
 
-        checkLoadFactor();
+        // an insert can only call for growing, never shrinking, and must
+        // not undo a reserve() before the reserved keys arrive
+        if ((m_uniqueCount * 100) / TABLE_SIZES[m_sizeIndex] > MAX_LOAD_FACTOR) {
+            resize(m_sizeIndex + 1);
+        }
         return true;
     }
 
@@ -587,6 +641,19 @@ namespace voltdb {
         assert(false);
     }
 
+    template<class K, class T, class H, class EK, class ET>
+    void CompactingHashTable<K, T, H, EK, ET>::reserve(uint64_t count) {
+        const int lastSizeIndex = static_cast<int>(sizeof(TABLE_SIZES) / sizeof(TABLE_SIZES[0])) - 1;
+        int newSizeIndex = m_sizeIndex;
+        while ((count * 100) / TABLE_SIZES[newSizeIndex] > MAX_LOAD_FACTOR &&
+               newSizeIndex < lastSizeIndex) {
+            newSizeIndex++;
+        }
+        if (newSizeIndex != m_sizeIndex) {
+            resize(newSizeIndex);
+        }
+    }
+
     template<class K, class T, class H, class EK, class ET>
     void CompactingHashTable<K, T, H, EK, ET>::checkLoadFactor() {
         uint64_t lf = (m_uniqueCount * 100) / TABLE_SIZES[m_sizeIndex];
@@ -18,11 +18,13 @@
 #ifndef COMPACTINGMAP_H_
 #define COMPACTINGMAP_H_
 
+#include <algorithm>
 #include <cstdlib>
 #include <stdint.h>
 #include <utility>
 #include <limits>
 #include <cassert>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 #include "ContiguousAllocator.h"
 
 typedef u_int32_t NodeCount;
@@ -90,8 +92,9 @@ protected:
 
     // rather than NULL, most tree pointers that don't point
     // to nodes point to NIL. This is taken from Cormen and
-    // makes some aspects easier to deal with.
-    TreeNode NIL;
+    // makes some aspects easier to deal with. It lives apart
+    // from the map so that swap() hands it over with the nodes.
+    TreeNode *NIL;
 
     // templated comparison function object
     // follows STL conventions
@@ -113,7 +116,7 @@ public:
         void setValue(const Data &value) { m_node->value = value; }
         void moveNext() { m_node = m_map->successor(m_node); }
         void movePrev() { m_node = m_map->predecessor(m_node); }
-        bool isEnd() const { return ((!m_map) || (m_node == &(m_map->NIL))); }
+        bool isEnd() const { return ((!m_map) || (m_node == m_map->NIL)); }
         bool equals(const iterator &iter) const {
             if (isEnd()) return iter.isEnd();
             return m_node == iter.m_node;
@@ -145,6 +148,25 @@ public:
 
     std::pair<iterator, iterator> equalRange(const Key &key);
 
+    // Hinted lookups, as CompactingBTree has; a binary tree gains nothing
+    // from the hint, so it is ignored.
+    iterator lowerBound(const Key &key, const iterator &hint) { return lowerBound(key); }
+    iterator upperBound(const Key &key, const iterator &hint) { return upperBound(key); }
+    std::pair<iterator, iterator> equalRange(const Key &key, const iterator &hint) { return equalRange(key); }
+
+    /** Remove every entry, giving all node memory back at once. */
+    void clear();
+
+    /** Trade all entries with another map, without touching them. */
+    void swap(CompactingMap &other);
+
+    /**
+     * Fill the empty map with count entries sorted by key (with no two
+     * keys equal if the map is unique), building the tree bottom up
+     * instead of inserting and rebalancing one entry at a time.
+     */
+    void bulkLoad(const std::pair<Key, Data> *entries, int64_t count);
+
     size_t bytesAllocated() const { return m_allocator.bytesAllocated(); }
 
     // TODO(xin): later rename it to rankLower
@@ -152,6 +174,8 @@ public:
     int64_t rankAsc(const Key& key);
     int64_t rankUpper(const Key& key);
 
+    static const char *typeName() { return "CompactingTree"; }
+
     /**
      * For debugging: verify the RB-tree constraints are met. SLOW.
      */
@@ -161,6 +185,8 @@ public:
 protected:
     // main internal functions
     void erase(TreeNode *z);
+    TreeNode *buildSubtree(const std::pair<Key, Data> *entries, int64_t begin, int64_t end,
+                           int depth, int redDepth);
     TreeNode *lookup(const Key &key);
     TreeNode *lookupRank(int64_t ith);
 
@@ -193,15 +219,16 @@ protected:
 template<typename Key, typename Data, typename Compare, bool hasRank>
 CompactingMap<Key, Data, Compare, hasRank>::CompactingMap(bool unique, Compare comper)
     : m_count(0),
-      m_root(&NIL),
       m_allocator(sizeof(TreeNode) - (hasRank ? 0 : sizeof(NodeCount)), 10000),
       m_unique(unique),
+      NIL(new TreeNode()),
       m_comper(comper)
   {
-    NIL.left = NIL.right = NIL.parent = &NIL;
-    NIL.color = BLACK;
+    m_root = NIL;
+    NIL->left = NIL->right = NIL->parent = NIL;
+    NIL->color = BLACK;
     if (hasRank)
-        NIL.subct = INVALIDCT;
+        NIL->subct = INVALIDCT;
   }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
@@ -212,30 +239,106 @@ CompactingMap<Key, Data, Compare, hasRank>::~CompactingMap() {
         iter.value().~Data();
         iter.moveNext();
     }
+    delete NIL;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::swap(CompactingMap &other) {
+    std::swap(m_count, other.m_count);
+    std::swap(m_root, other.m_root);
+    std::swap(NIL, other.NIL);
+    m_allocator.swap(other.m_allocator);
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::clear() {
+    // nodes need visiting only if keys or values have destructors to run
+    if (!boost::has_trivial_destructor<Key>::value || !boost::has_trivial_destructor<Data>::value) {
+        iterator iter = begin();
+        while (!iter.isEnd()) {
+            iter.key().~Key();
+            iter.value().~Data();
+            iter.moveNext();
+        }
+    }
+    m_allocator.clear();
+    m_root = NIL;
+    m_count = 0;
+    NIL->left = NIL->right = NIL->parent = NIL;
+}
+
+template<typename Key, typename Data, typename Compare, bool hasRank>
+void CompactingMap<Key, Data, Compare, hasRank>::bulkLoad(const std::pair<Key, Data> *entries,
+                                                          int64_t count) {
+    assert(m_count == 0);
+    if (count == 0) return;
+
+    // Rooting every subtree at its middle entry leaves all the leaves on
+    // the deepest level or the one above it. Only the nodes on the deepest
+    // level are red, so every path from the root has the same number of
+    // black nodes.
+    int deepest = 0;
+    while ((static_cast<int64_t>(2) << deepest) <= count) {
+        deepest++;
+    }
+    m_root = buildSubtree(entries, 0, count, 0, deepest);
+    m_count = count;
+    assert(m_allocator.count() == m_count);
+}
+
+/*
+ * Build the subtree holding entries begin to end - 1, allocating its nodes
+ * in key order. The caller sets the parent of the returned node.
+ */
+template<typename Key, typename Data, typename Compare, bool hasRank>
+typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *
+CompactingMap<Key, Data, Compare, hasRank>::buildSubtree(const std::pair<Key, Data> *entries,
+                                                         int64_t begin, int64_t end,
+                                                         int depth, int redDepth) {
+    if (begin == end) return NIL;
+    int64_t middle = begin + (end - begin - 1) / 2;
+    TreeNode *left = buildSubtree(entries, begin, middle, depth + 1, redDepth);
+
+    void *memory = m_allocator.alloc();
+    assert(memory);
+    // placement new without value-initialization: when !hasRank the
+    // allocator slot is too short for subct and must not be written
+    TreeNode *z = new(memory) TreeNode;
+    z->key = entries[middle].first;
+    z->value = entries[middle].second;
+    z->left = left;
+    z->right = buildSubtree(entries, middle + 1, end, depth + 1, redDepth);
+    z->parent = NIL;
+    z->color = (depth == redDepth && depth > 0) ? RED : BLACK;
+    if (z->left != NIL) z->left->parent = z;
+    if (z->right != NIL) z->right->parent = z;
+    if (hasRank)
+        updateSubct(z);
+    return z;
 }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 bool CompactingMap<Key, Data, Compare, hasRank>::erase(const Key &key) {
     TreeNode *node = lookup(key);
-    if (node == &NIL) return false;
+    if (node == NIL) return false;
     erase(node);
     return true;
 }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 bool CompactingMap<Key, Data, Compare, hasRank>::erase(iterator &iter) {
-    assert(iter.m_node != &NIL);
+    assert(iter.m_node != NIL);
     erase(iter.m_node);
     return true;
 }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> value) {
-    if (m_root != &NIL) {
+    if (m_root != NIL) {
         // find a place to put the new node
-        TreeNode *y = &NIL;
+        TreeNode *y = NIL;
         TreeNode *x = m_root;
-        while (x != &NIL) {
+        while (x != NIL) {
             y = x;
             int cmp = m_comper(value.first, x->key);
             if (cmp < 0)
@@ -243,7 +346,7 @@ bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> val
             else if (m_unique) {
                 if (cmp == 0) {
                     if (hasRank) {
-                        while (x != &NIL) {
+                        while (x != NIL) {
                             x = x->parent;
                             decSubct(x);
                         }
@@ -261,18 +364,19 @@ bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> val
         // create a new node
         void *memory = m_allocator.alloc();
         assert(memory);
-        // placement new
-        TreeNode *z = new(memory) TreeNode();
+        // placement new without value-initialization: when !hasRank the
+        // allocator slot is too short for subct and must not be written
+        TreeNode *z = new(memory) TreeNode;
         z->key = value.first;
         z->value = value.second;
-        z->left = z->right = &NIL;
+        z->left = z->right = NIL;
         z->parent = y;
         z->color = RED;
         if (hasRank)
             z->subct = 1;
 
         // stitch it in
-        if (y == &NIL) m_root = z;
+        if (y == NIL) m_root = z;
         else if (m_comper(z->key, y->key) < 0) y->left = z;
         else y->right = z;
 
@@ -283,12 +387,13 @@ bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> val
         // create a new node as root
         void *memory = m_allocator.alloc();
         assert(memory);
-        // placement new
-        TreeNode *z = new(memory) TreeNode();
+        // placement new without value-initialization: when !hasRank the
+        // allocator slot is too short for subct and must not be written
+        TreeNode *z = new(memory) TreeNode;
         z->key = value.first;
         z->value = value.second;
-        z->left = z->right = &NIL;
-        z->parent = &NIL;
+        z->left = z->right = NIL;
+        z->parent = NIL;
         z->color = BLACK;
         if (hasRank)
             z->subct = 1;
@@ -304,8 +409,8 @@ bool CompactingMap<Key, Data, Compare, hasRank>::insert(std::pair<Key, Data> val
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::iterator CompactingMap<Key, Data, Compare, hasRank>::lowerBound(const Key &key) {
     TreeNode *x = m_root;
-    TreeNode *y = &NIL;
-    while (x != &NIL) {
+    TreeNode *y = NIL;
+    while (x != NIL) {
         int cmp = m_comper(x->key, key);
         if (cmp < 0) {
             x = x->right;
@@ -321,8 +426,8 @@ typename CompactingMap<Key, Data, Compare, hasRank>::iterator CompactingMap<Key,
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::iterator CompactingMap<Key, Data, Compare, hasRank>::upperBound(const Key &key) {
     TreeNode *x = m_root;
-    TreeNode *y = &NIL;
-    while (x != &NIL) {
+    TreeNode *y = NIL;
+    while (x != NIL) {
         int cmp = m_comper(x->key, key);
         if (cmp <= 0) {
             x = x->right;
@@ -346,14 +451,14 @@ void CompactingMap<Key, Data, Compare, hasRank>::erase(TreeNode *z) {
     TreeNode *y, *x, *delnode = z;
 
     // find a replacement node to swap with
-    if ((z->left == &NIL) || (z->right == &NIL)) {
+    if ((z->left == NIL) || (z->right == NIL)) {
         y = z;
     }
     else {
         y = successor(z);
     }
 
-    if (y->left != &NIL) {
+    if (y->left != NIL) {
         x = y->left;
     }
     else {
@@ -362,7 +467,7 @@ void CompactingMap<Key, Data, Compare, hasRank>::erase(TreeNode *z) {
 
     x->parent = y->parent;
 
-    if (y->parent == &NIL) {
+    if (y->parent == NIL) {
         m_root = x;
     }
     else if (y == y->parent->left) {
@@ -379,7 +484,7 @@ void CompactingMap<Key, Data, Compare, hasRank>::erase(TreeNode *z) {
     }
     if (hasRank) {
         TreeNode *ct = delnode;
-        while (ct != &NIL) {
+        while (ct != NIL) {
             ct = ct->parent;
             decSubct(ct);
         }
@@ -396,8 +501,8 @@ void CompactingMap<Key, Data, Compare, hasRank>::erase(TreeNode *z) {
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::lookup(const Key &key) {
     TreeNode *x = m_root;
-    TreeNode *retval = &NIL;
-    while (x != &NIL) {
+    TreeNode *retval = NIL;
+    while (x != NIL) {
         int cmp = m_comper(x->key, key);
         if (cmp < 0) {
             x = x->right;
@@ -418,11 +523,11 @@ void CompactingMap<Key, Data, Compare, hasRank>::leftRotate(TreeNode *x) {
     TreeNode *y = x->right;
 
     x->right = y->left;
-    if (y->left != &NIL) {
+    if (y->left != NIL) {
         y->left->parent = x;
     }
     y->parent = x->parent;
-    if (x->parent == &NIL)
+    if (x->parent == NIL)
         m_root = y;
     else if (x == x->parent->left)
         x->parent->left = y;
@@ -442,11 +547,11 @@ void CompactingMap<Key, Data, Compare, hasRank>::rightRotate(TreeNode *x) {
     TreeNode *y = x->left;
 
     x->left = y->right;
-    if (y->right != &NIL) {
+    if (y->right != NIL) {
         y->right->parent = x;
     }
     y->parent = x->parent;
-    if (x->parent == &NIL)
+    if (x->parent == NIL)
         m_root = y;
     else if (x == x->parent->right)
         x->parent->right = y;
@@ -598,7 +703,7 @@ void CompactingMap<Key, Data, Compare, hasRank>::fragmentFixup(TreeNode *X) {
     //assert(isReachableNode(m_root, last));
 
     // if there's a parent node, make it point to the hole
-    if (last->parent != &NIL) {
+    if (last->parent != NIL) {
         //assert(isReachableNode(m_root, last->parent));
 
         if (last->parent->left == last) {
@@ -611,13 +716,13 @@ void CompactingMap<Key, Data, Compare, hasRank>::fragmentFixup(TreeNode *X) {
     }
 
     // if there's children, make their parents point to hole
-    if (last->left != &NIL)
+    if (last->left != NIL)
         last->left->parent = X;
-    if (last->right != &NIL)
+    if (last->right != NIL)
         last->right->parent = X;
 
     // copy the last node over the deleted node
-    assert(X != &NIL);
+    assert(X != NIL);
     X->parent = last->parent;
     X->left = last->left;
     X->right = last->right;
@@ -639,21 +744,21 @@ void CompactingMap<Key, Data, Compare, hasRank>::fragmentFixup(TreeNode *X) {
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::minimum(const TreeNode *subRoot) const {
-    while (subRoot->left != &NIL) subRoot = subRoot->left;
+    while (subRoot->left != NIL) subRoot = subRoot->left;
     return const_cast<TreeNode*>(subRoot);
 }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::maximum(const TreeNode *subRoot) const {
-    while (subRoot->right != &NIL) subRoot = subRoot->right;
+    while (subRoot->right != NIL) subRoot = subRoot->right;
     return const_cast<TreeNode*>(subRoot);
 }
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::successor(const TreeNode *x) const {
-    if (x->right != &NIL) return minimum(x->right);
+    if (x->right != NIL) return minimum(x->right);
     TreeNode *y = x->parent;
-    while ((y != &NIL) && (x == y->right)) {
+    while ((y != NIL) && (x == y->right)) {
         x = y;
         y = y->parent;
     }
@@ -662,9 +767,9 @@ typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::predecessor(const TreeNode *x) const {
-    if (x->left != &NIL) return maximum(x->left);
+    if (x->left != NIL) return maximum(x->left);
     TreeNode *y = x->parent;
-    while ((y != &NIL) && (x == y->left)) {
+    while ((y != NIL) && (x == y->left)) {
         x = y;
         y = y->parent;
     }
@@ -684,7 +789,7 @@ bool CompactingMap<Key, Data, Compare, hasRank>::isReachableNode(const TreeNode*
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 inline int64_t CompactingMap<Key, Data, Compare, hasRank>::getSubct(const TreeNode* x) const {
-    if (x == &NIL) return 0;
+    if (x == NIL) return 0;
 
     if (x->subct == INVALIDCT)
         return getSubct(x->left) + getSubct(x->right) + 1;
@@ -695,7 +800,7 @@ inline int64_t CompactingMap<Key, Data, Compare, hasRank>::getSubct(const TreeNo
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 inline void CompactingMap<Key, Data, Compare, hasRank>::incSubct(TreeNode* x) {
-    if (x == &NIL)
+    if (x == NIL)
         return;
     if (x->subct == INVALIDCT)
         return;
@@ -707,7 +812,7 @@ inline void CompactingMap<Key, Data, Compare, hasRank>::incSubct(TreeNode* x) {
 }
 template<typename Key, typename Data, typename Compare, bool hasRank>
 inline void CompactingMap<Key, Data, Compare, hasRank>::decSubct(TreeNode* x) {
-    if (x == &NIL) return;
+    if (x == NIL) return;
     if (x->subct == INVALIDCT) {
         updateSubct(x);
     } else
@@ -715,7 +820,7 @@ inline void CompactingMap<Key, Data, Compare, hasRank>::decSubct(TreeNode* x) {
 }
 template<typename Key, typename Data, typename Compare, bool hasRank>
 inline void CompactingMap<Key, Data, Compare, hasRank>::updateSubct(TreeNode* x) {
-    if (x == &NIL) return;
+    if (x == NIL) return;
 
     int64_t sumct = getSubct(x->left) + getSubct(x->right) + 1;
     if (sumct <= SUBCTMAX)
@@ -730,37 +835,37 @@ int64_t CompactingMap<Key, Data, Compare, hasRank>::rankAsc(const Key& key) {
     if (!hasRank) return -1;
     TreeNode *n = lookup(key);
     // return -1 if the key passed in is not in the map
-    if (n == &NIL) return -1;
+    if (n == NIL) return -1;
     TreeNode *p = n;
     int64_t ct = 0,ctr = 0, ctl = 0;
     int m = m_comper(key, m_root->key);
     if (m == 0) {
-        if (m_root->right != &NIL)
+        if (m_root->right != NIL)
             ctr = getSubct(m_root->right);
         ct = getSubct(m_root) - ctr;
-        while(p->parent != &NIL) {
+        while(p->parent != NIL) {
             if (m_comper(key, p->key) == 0) {
-                if (p->right != &NIL && m_comper(key, p->right->key) == 0)
+                if (p->right != NIL && m_comper(key, p->right->key) == 0)
                     ct-= getSubct(p->right);
                 ct--;
             }
             p = p->parent;
         }
     } else if (m > 0) {
-        if (p->right != &NIL)
+        if (p->right != NIL)
             ctr = getSubct(p->right);
         ct = getSubct(p) - ctr;
-        while (p->parent != &NIL) {
+        while (p->parent != NIL) {
             if (p->parent->right == p) {
                 ct += getSubct(p->parent) - getSubct(p);
             }
             p = p->parent;
         }
     } else {
-        if (p->left != &NIL)
+        if (p->left != NIL)
             ctl = getSubct(p->left);
         ct = getSubct(p) - ctl - 1;
-        while (p->parent != &NIL) {
+        while (p->parent != NIL) {
             if (p->parent->left == p) {
                 ct += getSubct(p->parent) - getSubct(p);
             }
@@ -777,7 +882,7 @@ int64_t CompactingMap<Key, Data, Compare, hasRank>::rankUpper(const Key& key) {
     if (m_unique) return rankAsc(key);
     TreeNode *n = lookup(key);
     // return -1 if the key passed in is not in the map
-    if (n == &NIL) return -1;
+    if (n == NIL) return -1;
 
     iterator it;
     it = upperBound(key);
@@ -788,17 +893,17 @@ int64_t CompactingMap<Key, Data, Compare, hasRank>::rankUpper(const Key& key) {
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 typename CompactingMap<Key, Data, Compare, hasRank>::TreeNode *CompactingMap<Key, Data, Compare, hasRank>::lookupRank(int64_t ith) {
-    if (!hasRank) return &NIL;
+    if (!hasRank) return NIL;
 
     TreeNode *x = m_root;
-    TreeNode *retval = &NIL;
-    if (x == &NIL || ith > getSubct(x) || ith <= 0)
+    TreeNode *retval = NIL;
+    if (x == NIL || ith > getSubct(x) || ith <= 0)
         return retval;
 
     int64_t rk = ith;
     int64_t xl = 0;
-    while (x != &NIL && rk > 0) {
-        if (x->left != &NIL)
+    while (x != NIL && rk > 0) {
+        if (x->left != NIL)
             xl = getSubct(x->left);
         if (rk == xl + 1) {
             retval = x;
@@ -821,11 +926,11 @@ bool CompactingMap<Key, Data, Compare, hasRank>::verifyRank() {
 
     iterator it;
     int64_t rkasc;
-    TreeNode * n = &NIL;
+    TreeNode * n = NIL;
     // iterate rank start from 1 to m_count
     for (int64_t i = 1; i <= m_count; i++) {
         it = findRank(i);
-        if ((n = lookup(it.key())) == &NIL) {
+        if ((n = lookup(it.key())) == NIL) {
             printf("Can not find rank %ld node with key\n", (long)i);
             return false;
         }
@@ -862,7 +967,7 @@ bool CompactingMap<Key, Data, Compare, hasRank>::verifyRank() {
             rkasc = rankAsc(k);
             int64_t nc = 0;
             it.movePrev();
-            while (k == it.key()) {
+            while (!it.isEnd() && k == it.key()) {
                 nc++;
                 it.movePrev();
             }
@@ -878,23 +983,23 @@ bool CompactingMap<Key, Data, Compare, hasRank>::verifyRank() {
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 bool CompactingMap<Key, Data, Compare, hasRank>::verify() const {
-    if (NIL.color != BLACK) {
+    if (NIL->color != BLACK) {
         printf("NIL is red\n");
         return false;
     }
-    if (NIL.left != &NIL) {
+    if (NIL->left != NIL) {
         printf("NIL left is not NIL\n");
         return false;
     }
-    if (NIL.right != &NIL) {
+    if (NIL->right != NIL) {
         printf("NIL right is not NIL\n");
         return false;
     }
 
     if (!m_root) return false;
-    if ((m_root == &NIL) && (m_count)) return false;
+    if ((m_root == NIL) && (m_count)) return false;
     if (m_root->color == RED) return false;
-    if (m_root->parent != &NIL) return false;
+    if (m_root->parent != NIL) return false;
     if (verify(m_root) < 0) return false;
     if (m_count != fullCount(m_root)) return false;
 
@@ -910,12 +1015,12 @@ template<typename Key, typename Data, typename Compare, bool hasRank>
 int CompactingMap<Key, Data, Compare, hasRank>::inOrderCounterChecking(const TreeNode *n) const {
 
     int res = 0;
-    if (n != &NIL) {
+    if (n != NIL) {
         if ((res = inOrderCounterChecking(n->left)) < 0) return res;
         // check counter for sub tree nodes
         int64_t ct = 1;
-        if (n->left != &NIL) ct += getSubct(n->left);
-        if (n->right != &NIL) ct += getSubct(n->right);
+        if (n->left != NIL) ct += getSubct(n->left);
+        if (n->right != NIL) ct += getSubct(n->right);
         if (ct != getSubct(n)) {
             printf("node counter is not correct, expected %ld but get %ld\n", (long)ct, (long)getSubct(n));
             return -1;
@@ -930,25 +1035,25 @@ template<typename Key, typename Data, typename Compare, bool hasRank>
 int CompactingMap<Key, Data, Compare, hasRank>::verify(const TreeNode *n) const {
     // recursive stopping case
     if (n == NULL) return false;
-    if (n == &NIL)
+    if (n == NIL)
         return 0;
 
     //printf("verify -> node %d\n", N->value);
     //fflush(stdout);
 
     // check children have a valid parent pointer
-    if ((n->left != &NIL) && (n->left->parent != n)) return -1;
-    if ((n->right != &NIL) && (n->right->parent != n)) return -1;
+    if ((n->left != NIL) && (n->left->parent != n)) return -1;
+    if ((n->right != NIL) && (n->right->parent != n)) return -1;
 
     // check for no two consecutive red nodes
     if (n->color == RED) {
-        if ((n->left != &NIL) && (n->left->color == RED)) return -1;
-        if ((n->right != &NIL) && (n->right->color == RED)) return -1;
+        if ((n->left != NIL) && (n->left->color == RED)) return -1;
+        if ((n->right != NIL) && (n->right->color == RED)) return -1;
     }
 
     // check for strict ordering
-    if ((n->left != &NIL) && (m_comper(n->key, n->left->key) < 0)) return -1;
-    if ((n->right != &NIL) && (m_comper(n->key, n->right->key) > 0)) return -1;
+    if ((n->left != NIL) && (m_comper(n->key, n->left->key) < 0)) return -1;
+    if ((n->right != NIL) && (m_comper(n->key, n->right->key) > 0)) return -1;
 
     // recursive step (compare black height)
     int leftBH = verify(n->left);
@@ -962,7 +1067,7 @@ int CompactingMap<Key, Data, Compare, hasRank>::verify(const TreeNode *n) const
 
 template<typename Key, typename Data, typename Compare, bool hasRank>
 int CompactingMap<Key, Data, Compare, hasRank>::fullCount(const TreeNode *n) const {
-    if (n == &NIL) return 0;
+    if (n == NIL) return 0;
     else return fullCount(n->left) + fullCount(n->right) + 1;
 }
 
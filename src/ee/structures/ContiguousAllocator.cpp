@@ -17,6 +17,7 @@
 
 #include "ContiguousAllocator.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace voltdb;
@@ -25,11 +26,25 @@ ContiguousAllocator::ContiguousAllocator(int32_t allocSize, int32_t chunkSize)
 : m_count(0), m_allocSize(allocSize), m_chunkSize(chunkSize), m_tail(NULL), m_blockCount(0) {}
 
 ContiguousAllocator::~ContiguousAllocator() {
+    clear();
+}
+
+void ContiguousAllocator::clear() {
     while (m_tail) {
         Buffer *buf = m_tail->prev;
         free(m_tail);
         m_tail = buf;
     }
+    m_count = 0;
+    m_blockCount = 0;
+}
+
+void ContiguousAllocator::swap(ContiguousAllocator &other) {
+    assert(m_allocSize == other.m_allocSize);
+    assert(m_chunkSize == other.m_chunkSize);
+    std::swap(m_count, other.m_count);
+    std::swap(m_tail, other.m_tail);
+    std::swap(m_blockCount, other.m_blockCount);
 }
 
 void *ContiguousAllocator::alloc() {
@@ -52,6 +52,10 @@ public:
     void *alloc();
     void *last() const;
     void trim();
+    /** Free every buffer, forgetting all allocations at once. */
+    void clear();
+    /** Trade buffers and allocations with another allocator of the same sizes. */
+    void swap(ContiguousAllocator &other);
     int64_t count() const { return m_count; }
 
     size_t bytesAllocated() const;
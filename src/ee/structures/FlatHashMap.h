@@ -0,0 +1,291 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLATHASHMAP_H_
+#define FLATHASHMAP_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include <utility>
+#include <cassert>
+
+namespace voltdb {
+
+/**
+ * FlatHashMap is an open-addressing hash map for short-lived tables that
+ * mostly grow until they are cleared, such as the groups of a hash
+ * aggregation. Entries live inline in one power-of-two array of slots,
+ * each holding the key, the value and the key's full hash, so:
+ * 1. An insert never allocates a node; the array doubles when it is
+ *    MAX_LOAD_FACTOR full, and growing re-uses the stored hashes
+ *    instead of hashing the keys again.
+ * 2. A probe compares the stored hash before calling the (possibly
+ *    expensive) key equality checker.
+ * 3. Collisions are resolved by linear probing, which keeps the slots
+ *    a probe visits adjacent in memory.
+ *
+ * It supports fewer operations than boost::unordered_map, and iterators
+ * are invalidated by any insert or erase. An erase shifts the entries
+ * that follow in the probe sequence back instead of leaving a marker,
+ * so probes stay short.
+ */
+template<typename Key, typename Data, typename Hasher, typename KeyEqChecker>
+class FlatHashMap {
+public:
+    // grow when the table is 70% full
+    static const uint64_t MAX_LOAD_FACTOR = 70; // %
+    static const uint64_t MIN_CAPACITY = 16;
+
+protected:
+    struct Slot {
+        // the key's hash, or EMPTY_HASH for an unused slot
+        uint64_t hash;
+        Key key;
+        Data value;
+    };
+
+    // computed hashes of 0 are stored as 1, so 0 can mark a free slot
+    static const uint64_t EMPTY_HASH = 0;
+
+    Slot *m_slots;
+    uint64_t m_capacity;     // always 0 or a power of two
+    uint64_t m_count;
+    uint64_t m_growAt;       // grow when m_count reaches this
+    Hasher m_hasher;
+    KeyEqChecker m_keyEq;
+
+public:
+    class iterator {
+        friend class FlatHashMap<Key, Data, Hasher, KeyEqChecker>;
+    public:
+        iterator() : m_slot(NULL), m_end(NULL) {}
+        const Key &key() const { return m_slot->key; }
+        Data &value() const { return m_slot->value; }
+        bool isEnd() const { return m_slot == m_end; }
+        void moveNext() {
+            ++m_slot;
+            skipEmpty();
+        }
+    private:
+        iterator(Slot *slot, Slot *end) : m_slot(slot), m_end(end) { skipEmpty(); }
+        void skipEmpty() {
+            while (m_slot != m_end && m_slot->hash == EMPTY_HASH) {
+                ++m_slot;
+            }
+        }
+        Slot *m_slot;
+        Slot *m_end;
+    };
+
+    FlatHashMap() : m_slots(NULL), m_capacity(0), m_count(0), m_growAt(0) {}
+    ~FlatHashMap() { delete [] m_slots; }
+
+    uint64_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    uint64_t capacity() const { return m_capacity; }
+    /** Bytes taken by the slots */
+    uint64_t allocatedBytes() const { return m_capacity * sizeof(Slot); }
+
+    iterator begin() { return iterator(m_slots, m_slots + m_capacity); }
+
+    /**
+     * Make room for count entries without growing. Entries already in
+     * the table are kept.
+     */
+    void reserve(uint64_t count) {
+        uint64_t capacity = m_capacity > MIN_CAPACITY ? m_capacity : MIN_CAPACITY;
+        while (count * 100 >= capacity * MAX_LOAD_FACTOR) {
+            capacity *= 2;
+        }
+        if (capacity != m_capacity) {
+            resize(capacity);
+        }
+    }
+
+    /** Remove all entries and release the slots. */
+    void clear() {
+        delete [] m_slots;
+        m_slots = NULL;
+        m_capacity = 0;
+        m_count = 0;
+        m_growAt = 0;
+    }
+
+    /**
+     * Remove all entries, keeping the slots for the next use unless there
+     * are more than maxCapacity of them.
+     */
+    void reset(uint64_t maxCapacity) {
+        if (m_capacity > maxCapacity) {
+            clear();
+            return;
+        }
+        for (uint64_t ii = 0; ii < m_capacity; ++ii) {
+            m_slots[ii].hash = EMPTY_HASH;
+        }
+        m_count = 0;
+    }
+
+    /** Return a pointer to the value for the key, or NULL if it is absent. */
+    Data *find(const Key &key) const {
+        if (m_count == 0) {
+            return NULL;
+        }
+        const uint64_t hash = hashOf(key);
+        const uint64_t mask = m_capacity - 1;
+        for (uint64_t ii = hash & mask; ; ii = (ii + 1) & mask) {
+            Slot &slot = m_slots[ii];
+            if (slot.hash == EMPTY_HASH) {
+                return NULL;
+            }
+            if (slot.hash == hash && m_keyEq(slot.key, key)) {
+                return &slot.value;
+            }
+        }
+    }
+
+    /**
+     * Find the value for the key, inserting the key with a copy of
+     * initial if it is absent. inserted reports which happened. The
+     * returned reference is valid until the next insert.
+     */
+    Data &findOrInsert(const Key &key, const Data &initial, bool &inserted) {
+        if (m_count >= m_growAt) {
+            reserve(m_count + 1);
+        }
+        const uint64_t hash = hashOf(key);
+        const uint64_t mask = m_capacity - 1;
+        for (uint64_t ii = hash & mask; ; ii = (ii + 1) & mask) {
+            Slot &slot = m_slots[ii];
+            if (slot.hash == EMPTY_HASH) {
+                slot.hash = hash;
+                slot.key = key;
+                slot.value = initial;
+                ++m_count;
+                inserted = true;
+                return slot.value;
+            }
+            if (slot.hash == hash && m_keyEq(slot.key, key)) {
+                inserted = false;
+                return slot.value;
+            }
+        }
+    }
+
+    /** Remove the key. Return false if it is absent. */
+    bool erase(const Key &key) {
+        if (m_count == 0) {
+            return false;
+        }
+        const uint64_t hash = hashOf(key);
+        const uint64_t mask = m_capacity - 1;
+        uint64_t hole = hash & mask;
+        for (; ; hole = (hole + 1) & mask) {
+            const Slot &slot = m_slots[hole];
+            if (slot.hash == EMPTY_HASH) {
+                return false;
+            }
+            if (slot.hash == hash && m_keyEq(slot.key, key)) {
+                break;
+            }
+        }
+        // Move back every later entry of the run whose probe would
+        // otherwise stop at the hole: one whose home slot is not between
+        // the hole and where it sits.
+        for (uint64_t ii = (hole + 1) & mask; m_slots[ii].hash != EMPTY_HASH; ii = (ii + 1) & mask) {
+            const uint64_t home = m_slots[ii].hash & mask;
+            if (((ii - home) & mask) >= ((ii - hole) & mask)) {
+                m_slots[hole] = m_slots[ii];
+                hole = ii;
+            }
+        }
+        m_slots[hole].hash = EMPTY_HASH;
+        --m_count;
+        return true;
+    }
+
+protected:
+    uint64_t hashOf(const Key &key) const {
+        const uint64_t hash = static_cast<uint64_t>(m_hasher(key));
+        return hash == EMPTY_HASH ? 1 : hash;
+    }
+
+    void resize(uint64_t capacity) {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        Slot *oldSlots = m_slots;
+        const uint64_t oldCapacity = m_capacity;
+
+        m_slots = new Slot[capacity];
+        for (uint64_t ii = 0; ii < capacity; ++ii) {
+            m_slots[ii].hash = EMPTY_HASH;
+        }
+        m_capacity = capacity;
+        m_growAt = capacity * MAX_LOAD_FACTOR / 100;
+
+        const uint64_t mask = capacity - 1;
+        for (uint64_t ii = 0; ii < oldCapacity; ++ii) {
+            const Slot &oldSlot = oldSlots[ii];
+            if (oldSlot.hash == EMPTY_HASH) {
+                continue;
+            }
+            uint64_t jj = oldSlot.hash & mask;
+            while (m_slots[jj].hash != EMPTY_HASH) {
+                jj = (jj + 1) & mask;
+            }
+            m_slots[jj] = oldSlot;
+        }
+        delete [] oldSlots;
+    }
+};
+
+template<typename Key, typename Data, typename Hasher, typename KeyEqChecker>
+const uint64_t FlatHashMap<Key, Data, Hasher, KeyEqChecker>::MAX_LOAD_FACTOR;
+template<typename Key, typename Data, typename Hasher, typename KeyEqChecker>
+const uint64_t FlatHashMap<Key, Data, Hasher, KeyEqChecker>::MIN_CAPACITY;
+template<typename Key, typename Data, typename Hasher, typename KeyEqChecker>
+const uint64_t FlatHashMap<Key, Data, Hasher, KeyEqChecker>::EMPTY_HASH;
+
+/**
+ * Hashers for integer keys. Linear probing uses the low bits of the hash
+ * directly, so the key bits are mixed with the MurmurHash3 finalizer
+ * rather than used as they are.
+ */
+inline uint64_t mixInt64Hash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+struct Int64Hasher {
+    uint64_t operator()(int64_t key) const {
+        return mixInt64Hash(static_cast<uint64_t>(key));
+    }
+};
+
+struct Int64PairHasher {
+    uint64_t operator()(const std::pair<int64_t, int64_t> &key) const {
+        return mixInt64Hash(static_cast<uint64_t>(key.first) * 0x9e3779b97f4a7c15ULL ^
+                            static_cast<uint64_t>(key.second));
+    }
+};
+
+} // namespace voltdb
+
+#endif // FLATHASHMAP_H_
@@ -0,0 +1,512 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROBINGHASHTABLE_H_
+#define PROBINGHASHTABLE_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <new>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <boost/functional/hash.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "common/FatalException.hpp"
+#include "structures/FlatHashMap.h"
+
+namespace voltdb {
+
+    /**
+     * ProbingHashTable is a unique-key map for hash indexes, an alternative to
+     * CompactingHashTable that never stalls an insert or delete on a rehash of
+     * the whole table.
+     *
+     * 1. Entries live inline in a power-of-two array of slots found by linear
+     *    probing, GROUP_SIZE slots at a time. Each slot has a control byte
+     *    holding 7 bits of its key's hash (or marking it empty or deleted), so
+     *    a probe matches a whole group of slots against the hash with a couple
+     *    of SSE2 instructions and only compares the keys of the slots that
+     *    match. Each slot also keeps its key's full hash, so moving the entry
+     *    to another table doesn't hash the key again.
+     * 2. Resizing is incremental: a new table is allocated and each following
+     *    insert or delete moves MIGRATE_GROUPS_PER_OP groups of the old table
+     *    into it. Until the old table is empty both tables are searched.
+     * 3. Like CompactingHashTable it shrinks as entries are deleted, so memory
+     *    is given back as the index empties.
+     *
+     * Iterators, and the keys and values they refer to, are invalidated by any
+     * insert or erase, since either may move entries between tables.
+     */
+    template<class K, class T, class H = boost::hash<K>, class EK = std::equal_to<K> >
+    class ProbingHashTable {
+    public:
+        // typefefs just reduce the endless templating boilerplate
+        typedef K Key;            // key type
+        typedef T Data;           // value type
+        typedef H Hasher;         // hash a value to a uint64_t
+        typedef EK KeyEqChecker;  // compare two keys
+
+        // slots probed together, matching one SSE2 register of control bytes
+        static const uint64_t GROUP_SIZE = 16;
+        // resize when 7/8 of the slots are full or deleted
+        static const uint64_t MAX_LOAD_FACTOR = 87; // %
+        // shrink to a quarter when under 1/8 of the slots are full
+        static const uint64_t MIN_LOAD_FACTOR = 12; // %
+        static const uint64_t MIN_CAPACITY = 64;
+        // with 2 groups moved per operation a resize is over well before
+        // the new table, which starts at most half full, needs to resize
+        static const uint64_t MIGRATE_GROUPS_PER_OP = 2;
+
+    protected:
+        struct Slot {
+            Key key;
+            Data value;
+            uint64_t hash;
+        };
+
+        // A full slot's control byte is the high bit and the low 7 bits of
+        // its hash. Empty is 0 so that a freshly mapped table needs no
+        // initializing, and allocating one costs the same at any size.
+        static const int8_t CTRL_EMPTY = 0;
+        static const int8_t CTRL_DELETED = 1;
+
+        struct Table {
+            Table() : ctrl(NULL), slots(NULL), capacity(0), used(0), bytes(0) {}
+            int8_t *ctrl;       // one control byte per slot, followed by the slots
+            Slot *slots;
+            uint64_t capacity;  // 0 or a power of two, at least MIN_CAPACITY
+            uint64_t used;      // full or deleted slots
+            size_t bytes;
+        };
+
+        Table m_table;            // the table inserts go to
+        Table m_old;              // while resizing, the table being moved to m_table
+        uint64_t m_migrated;      // groups of m_old moved so far
+        uint64_t m_count;         // number of items in both tables
+        Hasher m_hasher;          // instance of the hashing function
+        KeyEqChecker m_keyEq;     // instance of the key eq checker
+
+    public:
+        class iterator {
+            friend class ProbingHashTable;
+        protected:
+            Slot *m_slot;
+            iterator(Slot *slot) : m_slot(slot) {}
+        public:
+            iterator() : m_slot(NULL) {}
+
+            Key &key() const { return m_slot->key; }
+            Data &value() const { return m_slot->value; }
+            void setValue(const Data &value) { m_slot->value = value; }
+
+            // keys are unique, so there is no next value for the key
+            void moveNext() { m_slot = NULL; }
+            bool isEnd() const { return m_slot == NULL; }
+            bool equals(iterator &iter) const { return m_slot == iter.m_slot; }
+        };
+
+        ProbingHashTable(Hasher hasher = Hasher(), KeyEqChecker keyEq = KeyEqChecker())
+            : m_migrated(0), m_count(0), m_hasher(hasher), m_keyEq(keyEq) {}
+        ~ProbingHashTable() {
+            release(m_table);
+            release(m_old);
+        }
+
+        iterator find(const Key &key) const {
+            const uint64_t hash = hashOf(key);
+            Slot *slot = findIn(m_table, key, hash);
+            if (slot == NULL) {
+                slot = findIn(m_old, key, hash);
+            }
+            return iterator(slot);
+        }
+
+        /** start loading the first group a find for key will read, ahead of the find */
+        void prefetch(const Key &key) const {
+            if (m_table.capacity != 0) {
+                __builtin_prefetch(m_table.ctrl + firstGroup(m_table, hashOf(key)) * GROUP_SIZE);
+            }
+        }
+
+        /** insert unless the key is already there */
+        bool insert(const Key &key, const Data &value);
+        /** delete by key */
+        bool erase(const Key &key);
+        bool erase(iterator &iter) { return erase(iter.key()); }
+
+        size_t size() const { return m_count; }
+        /** remove everything and release the tables */
+        void clear();
+        /** trade all items with another table, without touching them */
+        void swap(ProbingHashTable &other) {
+            std::swap(m_table, other.m_table);
+            std::swap(m_old, other.m_old);
+            std::swap(m_migrated, other.m_migrated);
+            std::swap(m_count, other.m_count);
+        }
+        /** make room for count keys without resizing */
+        void reserve(uint64_t count);
+        bool isResizing() const { return m_old.capacity != 0; }
+
+        size_t bytesAllocated() const { return m_table.bytes + m_old.bytes; }
+
+        /** verification for debugging and testing */
+        bool verify() const;
+
+    protected:
+        uint64_t hashOf(const Key &key) const {
+            // the low bits pick the control byte and the high bits the group
+            return mixInt64Hash(static_cast<uint64_t>(m_hasher(key)));
+        }
+
+        static int8_t tagOf(uint64_t hash) { return static_cast<int8_t>(0x80 | (hash & 0x7F)); }
+
+        static uint64_t firstGroup(const Table &table, uint64_t hash) {
+            return (hash >> 7) & (table.capacity / GROUP_SIZE - 1);
+        }
+
+        // bit i is set for each slot i of the group whose control byte is ctrl
+        static uint32_t match(const int8_t *group, int8_t ctrl) {
+#ifdef __SSE2__
+            const __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(ctrl))));
+#else
+            uint32_t bits = 0;
+            for (uint32_t ii = 0; ii < GROUP_SIZE; ++ii) {
+                if (group[ii] == ctrl) {
+                    bits |= 1u << ii;
+                }
+            }
+            return bits;
+#endif
+        }
+
+        // bit i is set for each full slot i of the group
+        static uint32_t matchFull(const int8_t *group) {
+#ifdef __SSE2__
+            // only the full slots' control bytes have their high bit set
+            return static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_load_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+            uint32_t bits = 0;
+            for (uint32_t ii = 0; ii < GROUP_SIZE; ++ii) {
+                if (group[ii] < 0) {
+                    bits |= 1u << ii;
+                }
+            }
+            return bits;
+#endif
+        }
+
+        // bit i is set for each empty or deleted slot i of the group
+        static uint32_t matchFree(const int8_t *group) {
+            return ~matchFull(group) & ((1u << GROUP_SIZE) - 1);
+        }
+
+        Slot *findIn(const Table &table, const Key &key, uint64_t hash) const;
+        void placeIn(Table &table, const Slot &entry);
+        void removeFrom(Table &table, Slot *slot);
+
+        static uint64_t capacityFor(uint64_t count);
+        void startResize(uint64_t capacity);
+        void migrate(uint64_t groups);
+
+        static void allocate(Table &table, uint64_t capacity);
+        void release(Table &table);
+    };
+
+    template<class K, class T, class H, class EK>
+    const uint64_t ProbingHashTable<K, T, H, EK>::GROUP_SIZE;
+    template<class K, class T, class H, class EK>
+    const uint64_t ProbingHashTable<K, T, H, EK>::MAX_LOAD_FACTOR;
+    template<class K, class T, class H, class EK>
+    const uint64_t ProbingHashTable<K, T, H, EK>::MIN_LOAD_FACTOR;
+    template<class K, class T, class H, class EK>
+    const uint64_t ProbingHashTable<K, T, H, EK>::MIN_CAPACITY;
+    template<class K, class T, class H, class EK>
+    const uint64_t ProbingHashTable<K, T, H, EK>::MIGRATE_GROUPS_PER_OP;
+    template<class K, class T, class H, class EK>
+    const int8_t ProbingHashTable<K, T, H, EK>::CTRL_EMPTY;
+    template<class K, class T, class H, class EK>
+    const int8_t ProbingHashTable<K, T, H, EK>::CTRL_DELETED;
+
+    ///////////////////////////////////////////
+    //
+    // PROBING HASH TABLE CODE
+    //
+    ///////////////////////////////////////////
+
+    template<class K, class T, class H, class EK>
+    bool ProbingHashTable<K, T, H, EK>::insert(const Key &key, const Data &value) {
+        const uint64_t hash = hashOf(key);
+        if (findIn(m_table, key, hash) != NULL || findIn(m_old, key, hash) != NULL) {
+            return false;
+        }
+
+        if (m_table.used >= m_table.capacity * MAX_LOAD_FACTOR / 100) {
+            // a resize in progress should always be over by now
+            migrate(m_old.capacity / GROUP_SIZE);
+            startResize(capacityFor(m_count + 1));
+        }
+
+        Slot entry;
+        entry.key = key;
+        entry.value = value;
+        entry.hash = hash;
+        placeIn(m_table, entry);
+        ++m_count;
+
+        migrate(MIGRATE_GROUPS_PER_OP);
+        return true;
+    }
+
+    template<class K, class T, class H, class EK>
+    bool ProbingHashTable<K, T, H, EK>::erase(const Key &key) {
+        const uint64_t hash = hashOf(key);
+        Slot *slot = findIn(m_table, key, hash);
+        if (slot != NULL) {
+            removeFrom(m_table, slot);
+        } else if ((slot = findIn(m_old, key, hash)) != NULL) {
+            removeFrom(m_old, slot);
+        } else {
+            return false;
+        }
+        --m_count;
+
+        if ( ! isResizing() && m_table.capacity > MIN_CAPACITY &&
+             m_count * 100 < m_table.capacity * MIN_LOAD_FACTOR) {
+            startResize(m_table.capacity / 4 > MIN_CAPACITY ? m_table.capacity / 4 : MIN_CAPACITY);
+        }
+        migrate(MIGRATE_GROUPS_PER_OP);
+        return true;
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::clear() {
+        release(m_table);
+        release(m_old);
+        m_migrated = 0;
+        m_count = 0;
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::reserve(uint64_t count) {
+        uint64_t capacity = m_table.capacity > MIN_CAPACITY ? m_table.capacity : MIN_CAPACITY;
+        while (count * 100 >= capacity * MAX_LOAD_FACTOR) {
+            capacity *= 2;
+        }
+        if (capacity <= m_table.capacity) {
+            return;
+        }
+        // asked for up front, so moving every entry right away is fine
+        migrate(m_old.capacity / GROUP_SIZE);
+        startResize(capacity);
+        migrate(m_old.capacity / GROUP_SIZE);
+    }
+
+    template<class K, class T, class H, class EK>
+    typename ProbingHashTable<K, T, H, EK>::Slot *
+    ProbingHashTable<K, T, H, EK>::findIn(const Table &table, const Key &key, uint64_t hash) const {
+        if (table.capacity == 0) {
+            return NULL;
+        }
+        const int8_t tag = tagOf(hash);
+        const uint64_t mask = table.capacity / GROUP_SIZE - 1;
+        uint64_t group = firstGroup(table, hash);
+        for (uint64_t probes = 0; probes <= mask; ++probes, group = (group + 1) & mask) {
+            const int8_t *ctrl = table.ctrl + group * GROUP_SIZE;
+            for (uint32_t bits = match(ctrl, tag); bits != 0; bits &= bits - 1) {
+                Slot *slot = table.slots + group * GROUP_SIZE + __builtin_ctz(bits);
+                if (slot->hash == hash && m_keyEq(slot->key, key)) {
+                    return slot;
+                }
+            }
+            // a group with an empty slot was never full, so no probe went past it
+            if (match(ctrl, CTRL_EMPTY) != 0) {
+                return NULL;
+            }
+        }
+        return NULL;
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::placeIn(Table &table, const Slot &entry) {
+        const uint64_t mask = table.capacity / GROUP_SIZE - 1;
+        uint64_t group = firstGroup(table, entry.hash);
+        for (uint64_t probes = 0; probes <= mask; ++probes, group = (group + 1) & mask) {
+            const uint32_t bits = matchFree(table.ctrl + group * GROUP_SIZE);
+            if (bits == 0) {
+                continue;
+            }
+            const uint64_t index = group * GROUP_SIZE + __builtin_ctz(bits);
+            if (table.ctrl[index] == CTRL_EMPTY) {
+                ++table.used;
+            }
+            table.ctrl[index] = tagOf(entry.hash);
+            new (table.slots + index) Slot(entry);
+            return;
+        }
+        // the load factor always leaves free slots
+        assert(false);
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::removeFrom(Table &table, Slot *slot) {
+        const uint64_t index = slot - table.slots;
+        const int8_t *ctrl = table.ctrl + (index / GROUP_SIZE) * GROUP_SIZE;
+        // slots of a group that has been full must stay deleted, so probes
+        // for keys placed past the group go on looking
+        if (match(ctrl, CTRL_EMPTY) != 0) {
+            table.ctrl[index] = CTRL_EMPTY;
+            --table.used;
+        } else {
+            table.ctrl[index] = CTRL_DELETED;
+        }
+        slot->~Slot();
+    }
+
+    template<class K, class T, class H, class EK>
+    uint64_t ProbingHashTable<K, T, H, EK>::capacityFor(uint64_t count) {
+        // no more than half the new table's threshold, leaving room for the
+        // inserts made while the old table is moved over
+        uint64_t capacity = MIN_CAPACITY;
+        while (count * 200 > capacity * MAX_LOAD_FACTOR) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::startResize(uint64_t capacity) {
+        assert( ! isResizing());
+        m_old = m_table;
+        m_migrated = 0;
+        m_table = Table();
+        allocate(m_table, capacity);
+        if (m_old.capacity != 0 && m_count == 0) {
+            release(m_old);
+        }
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::migrate(uint64_t groups) {
+        if ( ! isResizing()) {
+            return;
+        }
+        const uint64_t oldGroups = m_old.capacity / GROUP_SIZE;
+        for (; groups > 0 && m_migrated < oldGroups; --groups, ++m_migrated) {
+            int8_t *ctrl = m_old.ctrl + m_migrated * GROUP_SIZE;
+            for (uint32_t bits = matchFull(ctrl); bits != 0; bits &= bits - 1) {
+                const uint64_t index = m_migrated * GROUP_SIZE + __builtin_ctz(bits);
+                placeIn(m_table, m_old.slots[index]);
+                m_old.slots[index].~Slot();
+                // deleted rather than empty, to keep the old table's probes going
+                m_old.ctrl[index] = CTRL_DELETED;
+            }
+        }
+        if (m_migrated == oldGroups) {
+            release(m_old);
+            m_migrated = 0;
+        }
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::allocate(Table &table, uint64_t capacity) {
+        assert(capacity >= MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+        // mapped pages read as zeros, so every control byte starts out empty
+        // and the pages are only touched as slots are used
+        table.bytes = capacity + capacity * sizeof(Slot);
+        void *memory = mmap(NULL, table.bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (memory == MAP_FAILED) {
+            const int error = errno;
+            throwFatalException("Failed to map %ld bytes for a %ld slot hash table: %s",
+                                (long)table.bytes, (long)capacity, strerror(error));
+        }
+        table.ctrl = reinterpret_cast<int8_t*>(memory);
+        table.slots = reinterpret_cast<Slot*>(table.ctrl + capacity);
+        table.capacity = capacity;
+        table.used = 0;
+    }
+
+    template<class K, class T, class H, class EK>
+    void ProbingHashTable<K, T, H, EK>::release(Table &table) {
+        if (table.capacity == 0) {
+            return;
+        }
+        // slots need visiting only if keys or values have destructors to run
+        if ( ! boost::has_trivial_destructor<Key>::value || ! boost::has_trivial_destructor<Data>::value) {
+            for (uint64_t ii = 0; ii < table.capacity; ++ii) {
+                if (table.ctrl[ii] < 0) {
+                    table.slots[ii].~Slot();
+                }
+            }
+        }
+        munmap(table.ctrl, table.bytes);
+        table = Table();
+    }
+
+    template<class K, class T, class H, class EK>
+    bool ProbingHashTable<K, T, H, EK>::verify() const {
+        const Table *tables[] = { &m_table, &m_old };
+        uint64_t manualCount = 0;
+        for (int tt = 0; tt < 2; ++tt) {
+            const Table &table = *tables[tt];
+            uint64_t used = 0;
+            for (uint64_t ii = 0; ii < table.capacity; ++ii) {
+                if (table.ctrl[ii] == CTRL_EMPTY) {
+                    continue;
+                }
+                ++used;
+                if (table.ctrl[ii] == CTRL_DELETED) {
+                    continue;
+                }
+                const Slot &slot = table.slots[ii];
+                if (hashOf(slot.key) != slot.hash || tagOf(slot.hash) != table.ctrl[ii]) {
+                    printf("Slot hash doesn't match its key.\n");
+                    return false;
+                }
+                if (tt == 1 && ii < m_migrated * GROUP_SIZE) {
+                    printf("Slot of a moved group is still full.\n");
+                    return false;
+                }
+                if (findIn(table, slot.key, slot.hash) != &slot) {
+                    printf("Slot can't be found by its key.\n");
+                    return false;
+                }
+                ++manualCount;
+            }
+            if (used != table.used) {
+                printf("Found %d used slots, but expected %d.\n", (int) used, (int) table.used);
+                return false;
+            }
+        }
+        if (manualCount != m_count) {
+            printf("Found %d entries in the tables, but expected %d.\n",
+                   (int) manualCount, (int) m_count);
+            return false;
+        }
+        return true;
+    }
+}
+
+#endif // PROBINGHASHTABLE_H_
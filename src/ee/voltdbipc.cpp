@@ -30,6 +30,7 @@
 #include "common/Pool.hpp"
 #include "common/FatalException.hpp"
 #include "common/SegvException.hpp"
+#include "common/SharedBufferRing.h"
 #include "common/RecoveryProtoMessage.h"
 #include "common/TheHashinator.h"
 #include "common/LegacyHashinator.h"
@@ -122,6 +123,16 @@ typedef struct {
     char data[0];
 }__attribute__((packed)) save_table_to_disk_cmd;
 
+/*
+ * Header for a setResultBufferRing request, followed by the path of the
+ * file to create for the buffers.
+ */
+typedef struct {
+    struct ipc_command cmd;
+    int32_t count;
+    char path[0];
+}__attribute__((packed)) result_buffer_ring_cmd;
+
 struct undo_token {
     struct ipc_command cmd;
     int64_t token;
@@ -344,6 +355,9 @@ bool VoltDBIPC::execute(struct ipc_command *cmd) {
           executeTask(cmd);
           result = kErrorCode_None;
           break;
+      case 29:
+          result = setResultBufferRing(cmd);
+          break;
       default:
         result = stub(cmd);
     }
@@ -592,7 +606,12 @@ void VoltDBIPC::executePlanFragments(struct ipc_command *cmd) {
     ReferenceSerializeInput serialize_in(offset, sz);
 
     // and reset to space for the results output
-    m_engine->resetReusedResultOutputBuffer(1);//1 byte to add status code
+    SharedBufferRing *ring = m_engine->getResultBufferRing();
+    if (ring != NULL) {
+        m_engine->resetRingResultOutputBuffer();
+    } else {
+        m_engine->resetReusedResultOutputBuffer(1);//1 byte to add status code
+    }
 
     try {
         errors = m_engine->executePlanFragments(numFrags,
@@ -609,7 +628,13 @@ void VoltDBIPC::executePlanFragments(struct ipc_command *cmd) {
     }
 
     // write the results array back across the wire
-    if (errors == 0) {
+    if (errors == 0 && ring != NULL) {
+        // the client reads the results from the ring; tell it where
+        char response[5];
+        response[0] = kErrorCode_Success;
+        *reinterpret_cast<int32_t*>(&response[1]) = htonl(ring->current());
+        writeOrDie(m_fd, (unsigned char*)response, sizeof(response));
+    } else if (errors == 0) {
         // write the results array back across the wire
         const int32_t size = m_engine->getResultsSize();
         char *resultBuffer = m_engine->getReusedResultBuffer();
@@ -676,6 +701,27 @@ int8_t VoltDBIPC::setLogLevels(struct ipc_command *cmd) {
     return kErrorCode_Success;
 }
 
+/*
+ * Have executePlanFragments results written to a ring of buffers in a file
+ * the client maps, so only the index of the buffer holding them goes over
+ * the socket. If the file can't be set up, results keep going over the
+ * socket.
+ */
+int8_t VoltDBIPC::setResultBufferRing(struct ipc_command *cmd) {
+    result_buffer_ring_cmd *ringCommand = (result_buffer_ring_cmd*) cmd;
+    const int32_t count = ntohl(ringCommand->count);
+    const std::string path(ringCommand->path, ntohl(cmd->msgsize) - sizeof(result_buffer_ring_cmd));
+    try {
+        m_engine->setResultBufferRing(
+            new SharedBufferRing(count, FallbackSerializeOutput::MAX_ALLOCATION_SIZE, path));
+    } catch (const FatalException &e) {
+        printf("Sending results over the socket: %s\n", e.m_reason.c_str());
+        fflush(stdout);
+        return kErrorCode_Error;
+    }
+    return kErrorCode_Success;
+}
+
 void VoltDBIPC::terminate() {
     m_terminate = true;
 }
@@ -128,6 +128,8 @@ private:
 
     int8_t setLogLevels(struct ipc_command *cmd);
 
+    int8_t setResultBufferRing(struct ipc_command *cmd);
+
     void executePlanFragments(struct ipc_command *cmd);
 
     void getStats(struct ipc_command *cmd);
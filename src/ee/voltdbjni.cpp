@@ -100,6 +100,7 @@
 #include "boost/ptr_container/ptr_vector.hpp"
 #include "common/debuglog.h"
 #include "common/serializeio.h"
+#include "common/SharedBufferRing.h"
 #include "common/TheHashinator.h"
 #include "common/Pool.hpp"
 #include "common/FatalException.hpp"
@@ -526,6 +527,89 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeSetBu
     return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
 }
 
+/**
+ * Sets up a ring of result buffers for executePlanFragments, each of which
+ * can hold the largest allowed result, and returns direct byte buffers over
+ * them. Calls take the buffers in turn, starting with the first.
+ * @param engine_ptr the VoltDBEngine pointer
+ * @param count number of buffers in the ring
+ * @return the buffers, or null on failure
+ */
+SHAREDLIB_JNIEXPORT jobjectArray JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeSetResultBufferRing
+  (JNIEnv *env, jobject obj, jlong engine_ptr, jint count)
+{
+    VOLT_DEBUG("nativeSetResultBufferRing() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL) {
+        return NULL;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        updateJNILogProxy(engine); //JNIEnv pointer can change between calls, must be updated
+        SharedBufferRing *ring = new SharedBufferRing(count, FallbackSerializeOutput::MAX_ALLOCATION_SIZE);
+        engine->setResultBufferRing(ring);
+
+        jclass byteBufferClass = env->FindClass("java/nio/ByteBuffer");
+        if (byteBufferClass == NULL) {
+            return NULL;
+        }
+        jobjectArray buffers = env->NewObjectArray(count, byteBufferClass, NULL);
+        if (buffers == NULL) {
+            return NULL;
+        }
+        for (int ii = 0; ii < count; ii++) {
+            jobject buffer = env->NewDirectByteBuffer(ring->buffer(ii), ring->capacity());
+            if (buffer == NULL) {
+                return NULL;
+            }
+            env->SetObjectArrayElement(buffers, ii, buffer);
+            env->DeleteLocalRef(buffer);
+        }
+        return buffers;
+    } catch (const FatalException &e) {
+        topend->crashVoltDB(e);
+    }
+    return NULL;
+}
+
+/**
+ * Gives up a buffer of the result buffer ring whose results are still in
+ * use on the Java side, replacing it with a fresh one. The old buffer
+ * stays mapped until it is passed to nativeUnmapResultBuffer.
+ * @param engine_ptr the VoltDBEngine pointer
+ * @param index the buffer to give up
+ * @return a direct byte buffer over the replacement, or null on failure
+ */
+SHAREDLIB_JNIEXPORT jobject JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeDetachResultBuffer
+  (JNIEnv *env, jobject obj, jlong engine_ptr, jint index)
+{
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL || engine->getResultBufferRing() == NULL) {
+        return NULL;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        SharedBufferRing *ring = engine->getResultBufferRing();
+        ring->detach(index);
+        return env->NewDirectByteBuffer(ring->buffer(index), ring->capacity());
+    } catch (const FatalException &e) {
+        topend->crashVoltDB(e);
+    }
+    return NULL;
+}
+
+/**
+ * Frees a result buffer given up by nativeDetachResultBuffer once nothing
+ * on the Java side refers to it. Needs no engine, which may be gone.
+ * @param address the address of the buffer
+ * @param capacity the capacity of the buffer
+ */
+SHAREDLIB_JNIEXPORT void JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeUnmapResultBuffer
+  (JNIEnv *env, jclass clazz, jlong address, jint capacity)
+{
+    SharedBufferRing::unmap(reinterpret_cast<char*>(address), capacity);
+}
+
 /**
  * Executes multiple plan fragments with the given parameter sets and gets the results.
  * @param pointer the VoltDBEngine pointer
@@ -554,7 +638,7 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeExecu
     Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
     try {
         updateJNILogProxy(engine); //JNIEnv pointer can change between calls, must be updated
-        engine->resetReusedResultOutputBuffer();
+        engine->resetRingResultOutputBuffer();
         static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
 
         // fragment info
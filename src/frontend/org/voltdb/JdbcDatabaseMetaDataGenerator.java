@@ -436,7 +436,8 @@ public class JdbcDatabaseMetaDataGenerator
     private String getSortOrder(Index index)
     {
         String sort_order = null;
-        if (index.getType() == IndexType.BALANCED_TREE.getValue())
+        if (index.getType() == IndexType.BALANCED_TREE.getValue() ||
+            index.getType() == IndexType.BTREE.getValue())
         {
             sort_order = "A";
         }
@@ -77,6 +77,18 @@ public class PlannerStatsCollector extends StatsSource {
     long m_cache2Level = 0;
     long m_lastCache2Level = 0;
 
+    /**
+     * Cache 1 bytes, as reported by the EE
+     */
+    long m_cache1Bytes = 0;
+    long m_lastCache1Bytes = 0;
+
+    /**
+     * Cache 1 evictions, as reported by the EE
+     */
+    long m_cache1Evictions = 0;
+    long m_lastCache1Evictions = 0;
+
     /**
      * Cache 1 hits
      */
@@ -168,6 +180,16 @@ public class PlannerStatsCollector extends StatsSource {
         m_partitionId = partitionId;
     }
 
+    /**
+     * Used to take the size of the EE cache from the EE's own plan cache
+     * stats, where the hits and misses counted here can only estimate it
+     */
+    public void updateEECacheLevel(long eeCacheSize, long eeCacheBytes, long evictions) {
+        m_cache1Level = eeCacheSize;
+        m_cache1Bytes = eeCacheBytes;
+        m_cache1Evictions = evictions;
+    }
+
     /**
      * Called before doing planning. Starts timer.
      */
@@ -241,6 +263,8 @@ public class PlannerStatsCollector extends StatsSource {
         long maxExecutionTime = m_maxPlanningTime;
         long cache1Level = m_cache1Level;
         long cache2Level = m_cache2Level;
+        long cache1Bytes = m_cache1Bytes;
+        long cache1Evictions = m_cache1Evictions;
         long cache1Hits  = m_cache1Hits;
         long cache2Hits  = m_cache2Hits;
         long cacheMisses = m_cacheMisses;
@@ -261,6 +285,12 @@ public class PlannerStatsCollector extends StatsSource {
             cache2Level = m_cache2Level - m_lastCache2Level;
             m_lastCache2Level = m_cache2Level;
 
+            cache1Bytes = m_cache1Bytes - m_lastCache1Bytes;
+            m_lastCache1Bytes = m_cache1Bytes;
+
+            cache1Evictions = m_cache1Evictions - m_lastCache1Evictions;
+            m_lastCache1Evictions = m_cache1Evictions;
+
             cache1Hits = m_cache1Hits - m_lastCache1Hits;
             m_lastCache1Hits = m_cache1Hits;
 
@@ -290,6 +320,8 @@ public class PlannerStatsCollector extends StatsSource {
             rowValues[columnNameToIndex.get("PLAN_TIME_AVG")] = 0L;
         }
         rowValues[columnNameToIndex.get("FAILURES")] = failureCount;
+        rowValues[columnNameToIndex.get("CACHE1_BYTES")] = cache1Bytes;
+        rowValues[columnNameToIndex.get("CACHE1_EVICTIONS")] = cache1Evictions;
     }
 
     /**
@@ -310,6 +342,8 @@ public class PlannerStatsCollector extends StatsSource {
         columns.add(new ColumnInfo("PLAN_TIME_MAX", VoltType.BIGINT));
         columns.add(new ColumnInfo("PLAN_TIME_AVG", VoltType.BIGINT));
         columns.add(new ColumnInfo("FAILURES",      VoltType.BIGINT));
+        columns.add(new ColumnInfo("CACHE1_BYTES",  VoltType.BIGINT));
+        columns.add(new ColumnInfo("CACHE1_EVICTIONS", VoltType.BIGINT));
     }
 
     @Override
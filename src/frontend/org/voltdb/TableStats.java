@@ -46,5 +46,9 @@ public class TableStats extends SiteStatsSource {
         columns.add(new ColumnInfo("TUPLE_ALLOCATED_MEMORY", VoltType.INTEGER));
         columns.add(new ColumnInfo("TUPLE_DATA_MEMORY", VoltType.INTEGER));
         columns.add(new ColumnInfo("STRING_DATA_MEMORY", VoltType.INTEGER));
+        columns.add(new ColumnInfo("COMPACTION_BLOCKS_MERGED", VoltType.BIGINT));
+        columns.add(new ColumnInfo("COMPACTION_TUPLES_MOVED", VoltType.BIGINT));
+        columns.add(new ColumnInfo("COMPACTION_MICROS", VoltType.BIGINT));
+        columns.add(new ColumnInfo("STRING_DICTIONARY_SAVINGS", VoltType.INTEGER));
     }
 }
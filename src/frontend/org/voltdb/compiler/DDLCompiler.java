@@ -351,6 +351,34 @@ public class DDLCompiler {
             "([\\w.$]+)" +                      // (1) <table name>
             "\\s*;\\z"                          // (end statement)
             );
+
+    /**
+     * PAX TABLE statement regex
+     * NB supports only unquoted table names
+     * Capture groups are tagged as (1) in comments below.
+     */
+    static final Pattern paxPattern = Pattern.compile(
+            "(?i)" +                            // (ignore case)
+            "\\A"  +                            // start statement
+            "PAX\\s+TABLE\\s+"  +               // PAX TABLE
+            "([\\w.$]+)" +                      // (1) <table name>
+            "\\s*;\\z"                          // (end statement)
+            );
+
+    /**
+     * DICTIONARY TABLE statement regex
+     * NB supports only unquoted table and column names
+     * Capture groups are tagged as (1) and (2) in comments below.
+     */
+    static final Pattern dictionaryPattern = Pattern.compile(
+            "(?i)" +                            // (ignore case)
+            "\\A"  +                            // start statement
+            "DICTIONARY\\s+TABLE\\s+"  +        // DICTIONARY TABLE
+            "([\\w$]+)" +                       // (1) <table name>
+            "\\s+ON\\s+COLUMN\\s+" +            // ON COLUMN
+            "([\\w$]+)" +                       // (2) <column name>
+            "\\s*;\\z"                          // (end statement)
+            );
     /**
      * Regex Description:
      *
@@ -376,12 +404,18 @@ public class DDLCompiler {
      *      | -- or
      *      \\A -- beginning of statement
      *      EXPORT -- token
+     *      | -- or
+     *      \\A -- beginning of statement
+     *      PAX -- token
+     *      | -- or
+     *      \\A -- beginning of statement
+     *      DICTIONARY -- token
      * \\s -- one space
      * </pre>
      */
     static final Pattern voltdbStatementPrefixPattern = Pattern.compile(
             "(?i)((?<=\\ACREATE\\s{0,1024})" +
-            "(?:PROCEDURE|ROLE)|\\APARTITION|\\AREPLICATE|\\AEXPORT|\\AIMPORT)\\s"
+            "(?:PROCEDURE|ROLE)|\\APARTITION|\\AREPLICATE|\\AEXPORT|\\AIMPORT|\\APAX|\\ADICTIONARY)\\s"
             );
 
     static final String TABLE = "TABLE";
@@ -389,6 +423,8 @@ public class DDLCompiler {
     static final String PARTITION = "PARTITION";
     static final String REPLICATE = "REPLICATE";
     static final String EXPORT = "EXPORT";
+    static final String PAX = "PAX";
+    static final String DICTIONARY = "DICTIONARY";
     static final String ROLE = "ROLE";
 
     enum Permission {
@@ -567,7 +603,7 @@ public class DDLCompiler {
             return false;
         }
 
-        // either PROCEDURE, REPLICATE, PARTITION, ROLE, or EXPORT
+        // either PROCEDURE, REPLICATE, PARTITION, ROLE, EXPORT, PAX or DICTIONARY
         String commandPrefix = statementMatcher.group(1).toUpperCase();
 
         // matches if it is CREATE PROCEDURE [ALLOW <role> ...] FROM CLASS <class-name>;
@@ -811,6 +847,28 @@ public class DDLCompiler {
             return true;
         }
 
+        statementMatcher = paxPattern.matcher(statement);
+        if( statementMatcher.matches()) {
+
+            // check the table portion
+            String tableName = checkIdentifierStart(statementMatcher.group(1), statement);
+            m_tracker.addPaxTable(tableName);
+
+            return true;
+        }
+
+        statementMatcher = dictionaryPattern.matcher(statement);
+        if( statementMatcher.matches()) {
+
+            // group(1) -> table, group(2) -> column
+            m_tracker.addDictionaryColumn(
+                    checkIdentifierStart(statementMatcher.group(1), statement),
+                    checkIdentifierStart(statementMatcher.group(2), statement)
+                    );
+
+            return true;
+        }
+
         /*
          * if no correct syntax regex matched above then at this juncture
          * the statement is syntax incorrect
@@ -855,6 +913,20 @@ public class DDLCompiler {
                     statement.substring(0,statement.length()-1))); // remove trailing semicolon
         }
 
+        if( PAX.equals(commandPrefix)) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Invalid PAX TABLE statement: \"%s\", " +
+                    "expected syntax: PAX TABLE <table>",
+                    statement.substring(0,statement.length()-1))); // remove trailing semicolon
+        }
+
+        if( DICTIONARY.equals(commandPrefix)) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Invalid DICTIONARY TABLE statement: \"%s\", " +
+                    "expected syntax: DICTIONARY TABLE <table> ON COLUMN <column>",
+                    statement.substring(0,statement.length()-1))); // remove trailing semicolon
+        }
+
         // Not a VoltDB-specific DDL statement.
         return false;
     }
@@ -1543,7 +1615,12 @@ public class DDLCompiler {
         // set the type of the index based on the index name and column types
         // Currently, only int types can use hash or array indexes
         String indexNameNoCase = name.toLowerCase();
-        if (indexNameNoCase.contains("tree"))
+        if (indexNameNoCase.endsWith("_btree"))
+        {
+            index.setType(IndexType.BTREE.getValue());
+            index.setCountable(true);
+        }
+        else if (indexNameNoCase.contains("tree"))
         {
             index.setType(IndexType.BALANCED_TREE.getValue());
             index.setCountable(true);
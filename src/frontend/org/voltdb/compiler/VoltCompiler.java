@@ -42,6 +42,7 @@ import java.util.LinkedList;
 import java.util.List;
 import java.util.Map;
 import java.util.Map.Entry;
+import java.util.Set;
 import java.util.jar.JarEntry;
 import java.util.jar.JarFile;
 import java.util.jar.JarInputStream;
@@ -862,6 +863,39 @@ public class VoltCompiler {
             addExportTableToConnector(exportedTableName, db);
         }
 
+        // Process DDL tables that keep column pages
+        for( String paxTableName: voltDdlTracker.getPaxTables()) {
+            org.voltdb.catalog.Table tableref = db.getTables().getIgnoreCase(paxTableName);
+            if (tableref == null) {
+                throw new VoltCompilerException("While configuring PAX layout, table " + paxTableName +
+                        " was not present in the catalog.");
+            }
+            tableref.setColumnpages(true);
+        }
+
+        // Process DDL dictionary encoded columns
+        for( Entry<String, Set<String>> dictionaryColumns: voltDdlTracker.getDictionaryColumns().entrySet()) {
+            String tableName = dictionaryColumns.getKey();
+            org.voltdb.catalog.Table tableref = db.getTables().getIgnoreCase(tableName);
+            if (tableref == null) {
+                throw new VoltCompilerException("While configuring dictionary encoding, table " + tableName +
+                        " was not present in the catalog.");
+            }
+            for( String columnName: dictionaryColumns.getValue()) {
+                Column columnref = tableref.getColumns().getIgnoreCase(columnName);
+                if (columnref == null) {
+                    throw new VoltCompilerException("While configuring dictionary encoding, column " + columnName +
+                            " was not present in table " + tableName + ".");
+                }
+                VoltType type = VoltType.get((byte) columnref.getType());
+                if (type != VoltType.STRING && type != VoltType.VARBINARY) {
+                    throw new VoltCompilerException("Column " + columnName + " of table " + tableName +
+                            " is not VARCHAR or VARBINARY, so it cannot be dictionary encoded.");
+                }
+                columnref.setDictionaryencoded(true);
+            }
+        }
+
         // Process and add exports and connectors to the catalog
         // Must do this before compiling procedures to deny updates
         // on append-only tables.
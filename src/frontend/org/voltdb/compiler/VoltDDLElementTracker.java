@@ -40,6 +40,8 @@ public class VoltDDLElementTracker {
     final Map<String, ProcedureDescriptor> m_procedureMap =
             new HashMap<String, ProcedureDescriptor>();
     final Set<String> m_exports = new HashSet<String>();
+    final Set<String> m_paxTables = new HashSet<String>();
+    final Map<String, Set<String>> m_dictionaryColumns = new HashMap<String, Set<String>>();
     // additional non-procedure classes for the jar
     String[] m_extraClassses = new String[0];
 
@@ -181,4 +183,65 @@ public class VoltDDLElementTracker {
         return m_exports;
     }
 
+    /**
+     * Track a table that keeps column pages (a PAX layout) for scans
+     * @param tableName a table name
+     * @throws VoltCompilerException when the given table is already tracked
+     */
+    void addPaxTable( String tableName)
+        throws VoltCompilerException
+    {
+        assert tableName != null && ! tableName.trim().isEmpty();
+
+        if( m_paxTables.contains(tableName)) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Table \"%s\" is already declared PAX", tableName
+                    ));
+        }
+
+        m_paxTables.add(tableName);
+    }
+
+    /**
+     * Get a collection with tracked PAX tables
+     * @return a collection with tracked PAX tables
+     */
+    Collection<String> getPaxTables() {
+        return m_paxTables;
+    }
+
+    /**
+     * Track a dictionary encoded column
+     * @param tableName a table name
+     * @param colName a column name
+     * @throws VoltCompilerException when the given column is already tracked
+     */
+    void addDictionaryColumn( String tableName, String colName)
+        throws VoltCompilerException
+    {
+        assert tableName != null && ! tableName.trim().isEmpty();
+        assert colName != null && ! colName.trim().isEmpty();
+
+        Set<String> columns = m_dictionaryColumns.get(tableName);
+        if( columns == null) {
+            columns = new HashSet<String>();
+            m_dictionaryColumns.put(tableName, columns);
+        }
+        if( columns.contains(colName)) {
+            throw m_compiler.new VoltCompilerException(String.format(
+                    "Column \"%s\" of table \"%s\" is already declared DICTIONARY", colName, tableName
+                    ));
+        }
+
+        columns.add(colName);
+    }
+
+    /**
+     * Get the tracked dictionary encoded columns
+     * @return a map from table names to their dictionary encoded column names
+     */
+    Map<String, Set<String>> getDictionaryColumns() {
+        return m_dictionaryColumns;
+    }
+
 }
\ No newline at end of file
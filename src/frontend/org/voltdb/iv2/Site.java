@@ -945,6 +945,9 @@ public class Site implements Runnable, SiteProcedureConnection, SiteSnapshotConn
                                             m_ee.getThreadLocalPoolAllocations());
             }
         }
+
+        // take the size of the ee's plan cache into the planner statistics
+        m_ee.updatePlanCacheStats(time);
     }
 
     @Override
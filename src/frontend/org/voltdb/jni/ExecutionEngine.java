@@ -436,6 +436,36 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
         }
     }
 
+    /**
+     * Take the size of the EE's plan cache, the bytes it holds and the
+     * plans it has evicted from the EE's own PLANNER stats.
+     */
+    public void updatePlanCacheStats(Long now) {
+        if (m_plannerStats == null) {
+            return;
+        }
+        final VoltTable[] stats = getStats(StatsSelector.PLANNER, new int[0], false, now);
+        if ((stats != null) && (stats.length > 0) && stats[0].advanceRow()) {
+            m_eeCacheSize = (int) stats[0].getLong("CACHE_ENTRIES");
+            m_plannerStats.updateEECacheLevel(m_eeCacheSize,
+                                              stats[0].getLong("CACHE_BYTES"),
+                                              stats[0].getLong("CACHE_EVICTIONS"));
+        }
+    }
+
+    /**
+     * Get the allocation counts of the EE's thread local pools, a row
+     * for each size of chunk they hand out, from the EE's MEMORY stats.
+     * getThreadLocalPoolAllocations adds the string pools to their bytes.
+     */
+    public VoltTable getThreadLocalPoolStats(Long now) {
+        final VoltTable[] stats = getStats(StatsSelector.MEMORY, new int[0], false, now);
+        if ((stats != null) && (stats.length > 0)) {
+            return stats[0];
+        }
+        return null;
+    }
+
     protected abstract VoltTable[] coreExecutePlanFragments(int numFragmentIds,
                                                             long[] planFragmentIds,
                                                             long[] inputDepIds,
@@ -613,6 +643,31 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
                                           ByteBuffer resultBuffer, int result_buffer_size,
                                           ByteBuffer exceptionBuffer, int exception_buffer_size);
 
+    /**
+     * Sets up a ring of result buffers that executePlanFragments calls write
+     * their results to in turn, starting with the first.
+     * @param pointer the VoltDBEngine pointer
+     * @param count number of buffers in the ring
+     * @return direct byte buffers over the buffers of the ring
+     */
+    protected native ByteBuffer[] nativeSetResultBufferRing(long pointer, int count);
+
+    /**
+     * Gives up a buffer of the result buffer ring whose contents are still in
+     * use, which stays mapped until it is passed to nativeUnmapResultBuffer.
+     * @param pointer the VoltDBEngine pointer
+     * @param index the buffer to give up
+     * @return a direct byte buffer over the buffer that replaces it
+     */
+    protected native ByteBuffer nativeDetachResultBuffer(long pointer, int index);
+
+    /**
+     * Frees a result buffer given up by nativeDetachResultBuffer.
+     * @param address the address of the buffer
+     * @param capacity the capacity of the buffer
+     */
+    protected static native void nativeUnmapResultBuffer(long address, int capacity);
+
     /**
      * Load the system catalog for this engine.
      * @param pointer the VoltDBEngine pointer
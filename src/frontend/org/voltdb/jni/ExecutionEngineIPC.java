@@ -18,11 +18,15 @@
 package org.voltdb.jni;
 
 import java.io.EOFException;
+import java.io.File;
 import java.io.IOException;
+import java.io.RandomAccessFile;
 import java.io.UnsupportedEncodingException;
 import java.net.InetSocketAddress;
 import java.net.Socket;
 import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel.MapMode;
 import java.nio.channels.SocketChannel;
 import java.util.List;
 import java.util.logging.Level;
@@ -122,7 +126,8 @@ public class ExecutionEngineIPC extends ExecutionEngine {
         GetPoolAllocations(24),
         GetUSOs(25),
         updateHashinator(27),
-        executeTask(28);
+        executeTask(28),
+        SetResultBufferRing(29);
         Commands(final int id) {
             m_id = id;
         }
@@ -439,7 +444,10 @@ public class ExecutionEngineIPC extends ExecutionEngine {
                 }
             }
             resultTablesBuffer.flip();
+            readResultTables(resultTablesBuffer, tables);
+        }
 
+        private void readResultTables(final ByteBuffer resultTablesBuffer, final VoltTable tables[]) {
             // check if anything was changed
             final boolean dirty = resultTablesBuffer.get() > 0;
             if (dirty)
@@ -453,6 +461,23 @@ public class ExecutionEngineIPC extends ExecutionEngine {
             }
         }
 
+        /**
+         * Read the results of a batch from the buffer of the shared result
+         * ring whose index follows on the wire. The tables get a copy, as
+         * the EE reuses the buffer for a later batch.
+         */
+        public void readResultTables(final MappedByteBuffer resultBuffers, final VoltTable tables[]) throws IOException {
+            final int index = readInt();
+            final ByteBuffer results = resultBuffers.duplicate();
+            results.position(index * RESULT_BUFFER_CAPACITY);
+            final int resultTablesLength = results.getInt();
+            results.limit(results.position() + resultTablesLength);
+            final ByteBuffer resultTablesBuffer = ByteBuffer.allocate(resultTablesLength);
+            resultTablesBuffer.put(results);
+            resultTablesBuffer.flip();
+            readResultTables(resultTablesBuffer, tables);
+        }
+
         /**
          * Read and deserialize a long from the wire.
          */
@@ -607,6 +632,51 @@ public class ExecutionEngineIPC extends ExecutionEngine {
                 m_hostname,
                 1024 * 1024 * tempTableMemory,
                 hashinatorConfig);
+        setupResultBufferRing(port);
+    }
+
+    /*
+     * Results of executePlanFragments come back through a ring of buffers in a
+     * shared memory file both processes map, rather than over the socket. The
+     * file is unlinked as soon as both have mapped it. Without /dev/shm, or if
+     * the EE can't set the file up, results keep coming over the socket.
+     */
+    private static final int RESULT_BUFFER_COUNT = 2;
+    // FallbackSerializeOutput::MAX_ALLOCATION_SIZE in the EE, a whole number of pages
+    private static final int RESULT_BUFFER_CAPACITY = 1024 * 1024 * 50 - 1024 * 32;
+    private MappedByteBuffer m_resultBuffers = null;
+
+    private void setupResultBufferRing(final int port) {
+        final File shm = new File("/dev/shm");
+        if (!shm.isDirectory()) {
+            return;
+        }
+        final File file = new File(shm, "voltdbipc-results-" + port + "-" + m_siteId);
+        m_data.clear();
+        m_data.putInt(Commands.SetResultBufferRing.m_id);
+        m_data.putInt(RESULT_BUFFER_COUNT);
+        m_data.put(file.getPath().getBytes(Charsets.UTF_8));
+        try {
+            m_data.flip();
+            m_connection.write();
+            if (m_connection.readStatusByte() != ExecutionEngine.ERRORCODE_SUCCESS) {
+                // ignore the (empty) exception
+                m_connection.readInt();
+                return;
+            }
+            final RandomAccessFile mapped = new RandomAccessFile(file, "r");
+            try {
+                m_resultBuffers = mapped.getChannel().map(MapMode.READ_ONLY, 0,
+                        (long) RESULT_BUFFER_COUNT * RESULT_BUFFER_CAPACITY);
+            } finally {
+                mapped.close();
+            }
+        } catch (final IOException e) {
+            System.out.println("Exception: " + e.getMessage());
+            throw new RuntimeException(e);
+        } finally {
+            file.delete();
+        }
     }
 
     /** Utility method to generate an EEXception that can be overriden by derived classes**/
@@ -876,7 +946,12 @@ public class ExecutionEngineIPC extends ExecutionEngine {
                         resultTables[ii] = PrivateVoltTableFactory.createUninitializedVoltTable();
                     }
                     try {
-                        m_connection.readResultTables(resultTables);
+                        if (m_resultBuffers != null) {
+                            m_connection.readResultTables(m_resultBuffers, resultTables);
+                        }
+                        else {
+                            m_connection.readResultTables(resultTables);
+                        }
                     } catch (final IOException e) {
                         throw new EEException(
                                 ExecutionEngine.ERRORCODE_WRONG_SERIALIZED_BYTES);
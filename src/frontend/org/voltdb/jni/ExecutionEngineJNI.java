@@ -19,8 +19,12 @@ package org.voltdb.jni;
 
 import java.io.IOException;
 import java.io.UnsupportedEncodingException;
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
 import java.nio.ByteBuffer;
+import java.util.HashSet;
 import java.util.List;
+import java.util.Set;
 
 import org.voltcore.logging.VoltLogger;
 import org.voltcore.utils.DBBPool;
@@ -86,6 +90,36 @@ public class ExecutionEngineJNI extends ExecutionEngine {
     private final BBContainer exceptionBufferOrigin = org.voltcore.utils.DBBPool.allocateDirect(1024 * 1024 * 5);
     private ByteBuffer exceptionBuffer = exceptionBufferOrigin.b;
 
+    /*
+     * Buffers the EE writes the results of executePlanFragments to in turn,
+     * which grow in place up to the result size limit. Results smaller than
+     * RESULT_COPY_THRESHOLD are copied out, as before. Larger ones are left
+     * where the EE wrote them: the buffer is detached from the ring, which
+     * maps a fresh one in its place, and is unmapped once the last table
+     * over it has been collected. Only MAX_DETACHED_RESULT_BUFFERS can be
+     * waiting on the collector at once; past that, results are copied out
+     * whatever their size.
+     */
+    private static final int RESULT_BUFFER_COUNT = 2;
+    private static final int RESULT_COPY_THRESHOLD = 1024 * 1024;
+    private static final int MAX_DETACHED_RESULT_BUFFERS = 4;
+    private ByteBuffer[] resultBuffers;
+    private int resultBufferIndex = -1;
+
+    private static class DetachedResultBuffer extends PhantomReference<ByteBuffer> {
+        private final long address;
+        private final int capacity;
+
+        DetachedResultBuffer(ByteBuffer buffer, ReferenceQueue<ByteBuffer> queue) {
+            super(buffer, queue);
+            address = DBBPool.getBufferAddress(buffer);
+            capacity = buffer.capacity();
+        }
+    }
+    private final ReferenceQueue<ByteBuffer> collectedResultBuffers = new ReferenceQueue<ByteBuffer>();
+    // keeps the references themselves reachable until they are enqueued
+    private final Set<DetachedResultBuffer> detachedResultBuffers = new HashSet<DetachedResultBuffer>();
+
     /**
      * initialize the native Engine object.
      */
@@ -125,6 +159,11 @@ public class ExecutionEngineJNI extends ExecutionEngine {
 
         setupPsetBuffer(256 * 1024); // 256k seems like a reasonable per-ee number (but is totally pulled from my a**)
 
+        resultBuffers = nativeSetResultBufferRing(pointer, RESULT_BUFFER_COUNT);
+        if (resultBuffers == null) {
+            throw new EEException(ERRORCODE_ERROR);
+        }
+
         updateHashinator(hashinatorConfig);
         //LOG.info("Initialized Execution Engine");
     }
@@ -186,6 +225,10 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         deserializerBufferOrigin.discard();
         exceptionBuffer = null;
         exceptionBufferOrigin.discard();
+        // The ring went with the engine. Buffers detached from it are still
+        // unmapped as they are collected.
+        resultBuffers = null;
+        unmapCollectedResultBuffers();
         LOG.trace("Released Execution Engine.");
     }
 
@@ -277,9 +320,10 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         }
         // checkMaxFsSize();
 
-        // Execute the plan, passing a raw pointer to the byte buffers for input and output
-        //Clear is destructive, do it before the native call
-        deserializer.clear();
+        unmapCollectedResultBuffers();
+        // Execute the plan, passing a raw pointer to the byte buffers for input.
+        // Results go to the next buffer of the ring.
+        resultBufferIndex = (resultBufferIndex + 1) % resultBuffers.length;
         final int errorCode =
             nativeExecutePlanFragments(
                     pointer,
@@ -291,43 +335,61 @@ public class ExecutionEngineJNI extends ExecutionEngine {
                     uniqueId,
                     undoToken);
 
-        try {
-            checkErrorCode(errorCode);
-            FastDeserializer fds = fallbackBuffer == null ? deserializer : new FastDeserializer(fallbackBuffer);
-            // get a copy of the result buffers and make the tables
-            // use the copy
-            try {
-                // read the complete size of the buffer used
-                final int totalSize = fds.readInt();
-                // check if anything was changed
-                final boolean dirty = fds.readBoolean();
-                if (dirty)
-                    m_dirty = true;
-                // get a copy of the buffer
-                final ByteBuffer fullBacking = fds.readBuffer(totalSize);
-                final VoltTable[] results = new VoltTable[batchSize];
-                for (int i = 0; i < batchSize; ++i) {
-                    final int numdeps = fullBacking.getInt(); // number of dependencies for this frag
-                    assert(numdeps == 1);
-                    @SuppressWarnings("unused")
-                    final
-                    int depid = fullBacking.getInt(); // ignore the dependency id
-                    final int tableSize = fullBacking.getInt();
-                    // reasonableness check
-                    assert(tableSize < 50000000);
-                    final ByteBuffer tableBacking = fullBacking.slice();
-                    fullBacking.position(fullBacking.position() + tableSize);
-                    tableBacking.limit(tableSize);
-
-                    results[i] = PrivateVoltTableFactory.createVoltTableFromBuffer(tableBacking, true);
-                }
-                return results;
-            } catch (final IOException ex) {
-                LOG.error("Failed to deserialze result table" + ex);
-                throw new EEException(ERRORCODE_WRONG_SERIALIZED_BYTES);
-            }
-        } finally {
-            fallbackBuffer = null;
+        checkErrorCode(errorCode);
+        final ByteBuffer resultBuffer = resultBuffers[resultBufferIndex].duplicate();
+        // read the complete size of the buffer used
+        final int totalSize = resultBuffer.getInt();
+        // check if anything was changed
+        final boolean dirty = resultBuffer.get() > 0;
+        if (dirty)
+            m_dirty = true;
+        final ByteBuffer fullBacking;
+        if (totalSize < RESULT_COPY_THRESHOLD ||
+                detachedResultBuffers.size() >= MAX_DETACHED_RESULT_BUFFERS) {
+            // get a copy of the result buffers and make the tables use the copy
+            final byte[] data = new byte[totalSize];
+            resultBuffer.get(data);
+            fullBacking = ByteBuffer.wrap(data);
+        }
+        else {
+            // make the tables use the results in place, and give up the buffer
+            fullBacking = resultBuffer.slice();
+            fullBacking.limit(totalSize);
+            detachResultBuffer(resultBufferIndex);
+        }
+        final VoltTable[] results = new VoltTable[batchSize];
+        for (int i = 0; i < batchSize; ++i) {
+            final int numdeps = fullBacking.getInt(); // number of dependencies for this frag
+            assert(numdeps == 1);
+            @SuppressWarnings("unused")
+            final
+            int depid = fullBacking.getInt(); // ignore the dependency id
+            final int tableSize = fullBacking.getInt();
+            // reasonableness check
+            assert(tableSize < 50000000);
+            final ByteBuffer tableBacking = fullBacking.slice();
+            fullBacking.position(fullBacking.position() + tableSize);
+            tableBacking.limit(tableSize);
+
+            results[i] = PrivateVoltTableFactory.createVoltTableFromBuffer(tableBacking, true);
+        }
+        return results;
+    }
+
+    private void detachResultBuffer(int index) {
+        detachedResultBuffers.add(new DetachedResultBuffer(resultBuffers[index], collectedResultBuffers));
+        final ByteBuffer replacement = nativeDetachResultBuffer(pointer, index);
+        if (replacement == null) {
+            throw new EEException(ERRORCODE_ERROR);
+        }
+        resultBuffers[index] = replacement;
+    }
+
+    private void unmapCollectedResultBuffers() {
+        DetachedResultBuffer collected;
+        while ((collected = (DetachedResultBuffer) collectedResultBuffers.poll()) != null) {
+            detachedResultBuffers.remove(collected);
+            nativeUnmapResultBuffer(collected.address, collected.capacity);
         }
     }
 
@@ -382,13 +382,15 @@ public class PlanAssembler {
         }
         m_bestAndOnlyPlanWasGenerated = true;
         // Simply return an union plan node with a corresponding union type set
-        AbstractPlanNode subUnionRoot = new UnionPlanNode(m_parsedUnion.m_unionType);
+        UnionPlanNode subUnionRoot = new UnionPlanNode(m_parsedUnion.m_unionType);
         m_recentErrorMsg = null;
 
         ArrayList<CompiledPlan> childrenPlans = new ArrayList<CompiledPlan>();
         boolean orderIsDeterministic = true;
         boolean contentIsDeterministic = true;
 
+        boolean sortedInputs = true;
+
         PartitioningForStatement commonPartitioning = null;
 
         // Build best plans for the children first
@@ -410,6 +412,7 @@ public class PlanAssembler {
             childrenPlans.add(bestChildPlan);
             orderIsDeterministic = orderIsDeterministic && bestChildPlan.isOrderDeterministic();
             contentIsDeterministic = contentIsDeterministic && bestChildPlan.isContentDeterministic();
+            sortedInputs = sortedInputs && isOrderedByAllDisplayColumns(parsedChildStmt);
 
             // Make sure that next child's plans won't override current ones.
             planId = processor.m_planId;
@@ -471,6 +474,7 @@ public class PlanAssembler {
         for (CompiledPlan selectPlan : childrenPlans) {
             subUnionRoot.addAndLinkChild(selectPlan.rootPlanGraph);
         }
+        subUnionRoot.setSortedInputs(sortedInputs);
 
         CompiledPlan retval = new CompiledPlan();
             retval.rootPlanGraph = subUnionRoot;
@@ -486,6 +490,33 @@ public class PlanAssembler {
         return retval;
     }
 
+    /**
+     * Whether the rows of a set operation's child statement come out sorted
+     * ascending on each of its display columns in turn, so that the union
+     * executor can merge the children instead of hashing them. The executor
+     * checks the order as it merges and falls back to hashing, so this only
+     * has to be a good guess.
+     */
+    private static boolean isOrderedByAllDisplayColumns(AbstractParsedStmt parsedStmt) {
+        if ( ! (parsedStmt instanceof ParsedSelectStmt)) {
+            return false;
+        }
+        ParsedSelectStmt selectStmt = (ParsedSelectStmt) parsedStmt;
+        List<ParsedColInfo> displayColumns = selectStmt.displayColumns();
+        List<ParsedColInfo> orderByColumns = selectStmt.orderByColumns();
+        if (orderByColumns.size() < displayColumns.size()) {
+            return false;
+        }
+        for (int i = 0; i < displayColumns.size(); i++) {
+            ParsedColInfo orderByColumn = orderByColumns.get(i);
+            if ( ! orderByColumn.ascending || orderByColumn.expression == null ||
+                 ! orderByColumn.expression.equals(displayColumns.get(i).expression)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     private AbstractPlanNode getNextSelectPlan() {
         assert (subAssembler != null);
 
@@ -536,10 +567,12 @@ public class PlanAssembler {
                         }
                         List<AbstractPlanNode> nljs = receiveNode.findAllNodesOfType(PlanNodeType.NESTLOOP);
                         List<AbstractPlanNode> nlijs = receiveNode.findAllNodesOfType(PlanNodeType.NESTLOOPINDEX);
+                        List<AbstractPlanNode> hjs = receiveNode.findAllNodesOfType(PlanNodeType.HASHJOIN);
+                        List<AbstractPlanNode> mjs = receiveNode.findAllNodesOfType(PlanNodeType.MERGEJOIN);
 
                         // outer join edge case does not have any join plan node under receive node.
                         // This is like a single table case.
-                        if (nljs.size() + nlijs.size() == 0) {
+                        if (nljs.size() + nlijs.size() + hjs.size() + mjs.size() == 0) {
                             mvFixInfoEdgeCaseOuterJoin = true;
                         }
                         root = handleMVBasedMultiPartQuery(root, mvFixInfoEdgeCaseOuterJoin);
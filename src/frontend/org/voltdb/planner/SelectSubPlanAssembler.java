@@ -26,18 +26,26 @@ import java.util.List;
 import java.util.Map;
 import java.util.Set;
 
+import org.voltdb.VoltType;
+import org.voltdb.catalog.ColumnRef;
 import org.voltdb.catalog.Database;
+import org.voltdb.catalog.Index;
 import org.voltdb.catalog.Table;
 import org.voltdb.expressions.AbstractExpression;
 import org.voltdb.expressions.ExpressionUtil;
 import org.voltdb.expressions.TupleValueExpression;
 import org.voltdb.plannodes.AbstractJoinPlanNode;
 import org.voltdb.plannodes.AbstractPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.IndexScanPlanNode;
+import org.voltdb.plannodes.MergeJoinPlanNode;
 import org.voltdb.plannodes.NestLoopIndexPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
+import org.voltdb.types.ExpressionType;
+import org.voltdb.types.IndexType;
 import org.voltdb.types.JoinType;
 import org.voltdb.types.PlanNodeType;
+import org.voltdb.utils.CatalogUtil;
 import org.voltdb.utils.PermutationGenerator;
 
 /**
@@ -57,6 +65,9 @@ public class SelectSubPlanAssembler extends SubPlanAssembler {
     /** The list of all possible join orders, assembled by queueAllJoinOrders */
     ArrayDeque<JoinNode> m_joinOrders = new ArrayDeque<JoinNode>();
 
+    /** Whether equi-joins may be planned as hash joins. */
+    private boolean m_hashJoinsAllowed = true;
+
     /**
      *
      * @param db The catalog's Database object.
@@ -661,6 +672,15 @@ public class SelectSubPlanAssembler extends SubPlanAssembler {
                     continue;
                 }
                 m_plans.add(plan);
+                // Let the cost model choose between hashing and nest looping.
+                if (plan.hasAnyNodeOfType(PlanNodeType.HASHJOIN)) {
+                    m_hashJoinsAllowed = false;
+                    plan = getSelectSubPlanForJoinNode(rootNode);
+                    m_hashJoinsAllowed = true;
+                    if (plan != null) {
+                        m_plans.add(plan);
+                    }
+                }
             }
             return;
         }
@@ -802,9 +822,9 @@ public class SelectSubPlanAssembler extends SubPlanAssembler {
 
         AbstractJoinPlanNode ajNode = null;
         if (canHaveNLJ) {
-            NestLoopPlanNode nljNode = new NestLoopPlanNode();
             // get all the clauses that join the applicable two tables
-            ArrayList<AbstractExpression> joinClauses = innerAccessPath.joinExprs;
+            ArrayList<AbstractExpression> joinClauses =
+                    new ArrayList<AbstractExpression>(innerAccessPath.joinExprs);
             if (innerPlan instanceof IndexScanPlanNode) {
                 // InnerPlan is an IndexScan. In this case the inner and inner-outer
                 // non-index join expressions (if any) are in the otherExpr. The former should stay as
@@ -814,6 +834,21 @@ public class SelectSubPlanAssembler extends SubPlanAssembler {
                 AbstractExpression indexScanPredicate = ExpressionUtil.combine(innerExpr);
                 ((IndexScanPlanNode)innerPlan).setPredicate(indexScanPredicate);
             }
+
+            // An equality between the outer and inner rows lets the join merge
+            // two children that are already sorted on it, or else hash one child,
+            // instead of rescanning the inner child for every outer row.
+            // The special case send/receive plan is left to the NLJ.
+            AbstractJoinPlanNode nljNode = null;
+            if ( ! needInnerSendReceive) {
+                nljNode = getMergeJoinNodeForClauses(outerPlan, innerPlan, joinClauses);
+                if (nljNode == null && m_hashJoinsAllowed) {
+                    nljNode = getHashJoinNodeForClauses(joinNode.m_rightNode, joinClauses);
+                }
+            }
+            if (nljNode == null) {
+                nljNode = new NestLoopPlanNode();
+            }
             nljNode.setJoinPredicate(ExpressionUtil.combine(joinClauses));
 
             // combine the tails plan graph with the new head node
@@ -874,6 +909,151 @@ public class SelectSubPlanAssembler extends SubPlanAssembler {
         return true;
     }
 
+    /**
+     * Build a hash join node keyed on the equality join clauses that compare
+     * an expression of the outer tables with an expression of the inner tables.
+     * The clauses are left in place to be evaluated as the join predicate.
+     * Keys of different integer types are compared as BIGINTs; other keys must
+     * be of the same type and not FLOAT, whose equal values may hash apart.
+     *
+     * @param innerNode - the inner table or sub-join of the join.
+     * @param joinClauses - the inner-outer join clauses.
+     * @return a HashJoinPlanNode, or null if none of the clauses can key one.
+     */
+    private HashJoinPlanNode getHashJoinNodeForClauses(JoinNode innerNode,
+                                                       List<AbstractExpression> joinClauses)
+    {
+        Set<String> innerTableAliases = new HashSet<String>();
+        for (int tableAliasIndex : innerNode.generateTableJoinOrder()) {
+            innerTableAliases.add(m_parsedStmt.stmtCache.get(tableAliasIndex).m_tableAlias);
+        }
+        HashJoinPlanNode hashJoinNode = null;
+        for (AbstractExpression clause : joinClauses) {
+            if (clause.getExpressionType() != ExpressionType.COMPARE_EQUAL) {
+                continue;
+            }
+            AbstractExpression outerExpr = clause.getLeft();
+            AbstractExpression innerExpr = clause.getRight();
+            if (countTupleValuesOf(outerExpr, innerTableAliases) > 0) {
+                outerExpr = clause.getRight();
+                innerExpr = clause.getLeft();
+            }
+            List<TupleValueExpression> outerTVEs = ExpressionUtil.getTupleValueExpressions(outerExpr);
+            List<TupleValueExpression> innerTVEs = ExpressionUtil.getTupleValueExpressions(innerExpr);
+            if (outerTVEs.isEmpty() || countTupleValuesOf(outerExpr, innerTableAliases) > 0 ||
+                innerTVEs.isEmpty() || countTupleValuesOf(innerExpr, innerTableAliases) < innerTVEs.size()) {
+                continue;
+            }
+            VoltType outerType = outerExpr.getValueType();
+            VoltType innerType = innerExpr.getValueType();
+            if (outerType == null || innerType == null) {
+                continue;
+            }
+            boolean bothIntegral = outerType.isPartitionableNumber() && innerType.isPartitionableNumber();
+            if ( ! bothIntegral && (outerType != innerType || outerType == VoltType.FLOAT)) {
+                continue;
+            }
+            if (hashJoinNode == null) {
+                hashJoinNode = new HashJoinPlanNode();
+            }
+            hashJoinNode.addHashExpressions(outerExpr, innerExpr);
+        }
+        return hashJoinNode;
+    }
+
+    /**
+     * @return how many of the tuple value expressions of an expression
+     * are of one of the given tables.
+     */
+    private static int countTupleValuesOf(AbstractExpression expr, Set<String> tableAliases) {
+        int count = 0;
+        for (TupleValueExpression tve : ExpressionUtil.getTupleValueExpressions(expr)) {
+            if (tableAliases.contains(tve.getTableAlias())) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Build a merge join node when both children are index scans that return
+     * their rows in ascending order of a column and a join clause equates the
+     * two columns. Only the leading column of each index is considered, since
+     * it is the only one the whole scan is sorted on. The clauses are left in
+     * place to be evaluated as the join predicate.
+     *
+     * @param outerPlan - the outer child of the join.
+     * @param innerPlan - the inner child of the join.
+     * @param joinClauses - the inner-outer join clauses.
+     * @return a MergeJoinPlanNode, or null if the children can not be merged.
+     */
+    private MergeJoinPlanNode getMergeJoinNodeForClauses(AbstractPlanNode outerPlan,
+                                                         AbstractPlanNode innerPlan,
+                                                         List<AbstractExpression> joinClauses)
+    {
+        String outerColumn = getAscendingScanColumn(outerPlan);
+        String innerColumn = getAscendingScanColumn(innerPlan);
+        if (outerColumn == null || innerColumn == null) {
+            return null;
+        }
+        String outerTableAlias = ((IndexScanPlanNode) outerPlan).getTargetTableAlias();
+        String innerTableAlias = ((IndexScanPlanNode) innerPlan).getTargetTableAlias();
+        for (AbstractExpression clause : joinClauses) {
+            if (clause.getExpressionType() != ExpressionType.COMPARE_EQUAL ||
+                ! (clause.getLeft() instanceof TupleValueExpression) ||
+                ! (clause.getRight() instanceof TupleValueExpression)) {
+                continue;
+            }
+            TupleValueExpression outerTVE = (TupleValueExpression) clause.getLeft();
+            TupleValueExpression innerTVE = (TupleValueExpression) clause.getRight();
+            if (innerTableAlias.equals(outerTVE.getTableAlias())) {
+                outerTVE = (TupleValueExpression) clause.getRight();
+                innerTVE = (TupleValueExpression) clause.getLeft();
+            }
+            if ( ! outerTableAlias.equals(outerTVE.getTableAlias()) ||
+                 ! outerColumn.equals(outerTVE.getColumnName()) ||
+                 ! innerTableAlias.equals(innerTVE.getTableAlias()) ||
+                 ! innerColumn.equals(innerTVE.getColumnName())) {
+                continue;
+            }
+            VoltType outerType = outerTVE.getValueType();
+            VoltType innerType = innerTVE.getValueType();
+            if (outerType == null || innerType == null) {
+                continue;
+            }
+            boolean bothIntegral = outerType.isPartitionableNumber() && innerType.isPartitionableNumber();
+            if ( ! bothIntegral && outerType != innerType) {
+                continue;
+            }
+            MergeJoinPlanNode mergeJoinNode = new MergeJoinPlanNode();
+            mergeJoinNode.addMergeExpressions(outerTVE, innerTVE);
+            return mergeJoinNode;
+        }
+        return null;
+    }
+
+    /**
+     * @return the name of the column that an index scan returns its rows in
+     * ascending order of, or null if the plan is not such a scan.
+     */
+    private static String getAscendingScanColumn(AbstractPlanNode plan) {
+        if ( ! (plan instanceof IndexScanPlanNode)) {
+            return null;
+        }
+        IndexScanPlanNode scan = (IndexScanPlanNode) plan;
+        Index index = scan.getCatalogIndex();
+        if (index == null || scan.isReverseScan() ||
+            ! IndexType.isScannable(index.getType()) ||
+            ! index.getExpressionsjson().isEmpty()) {
+            return null;
+        }
+        List<ColumnRef> indexedColRefs = CatalogUtil.getSortedCatalogItems(index.getColumns(), "index");
+        if (indexedColRefs.isEmpty()) {
+            return null;
+        }
+        return indexedColRefs.get(0).getColumn().getName();
+    }
+
     /**
      * A method to filter out single TVE expressions.
      *
@@ -119,7 +119,8 @@ public class SeqScansToUniqueTreeScans extends MicroOptimization {
                 continue;
             }
             // skip hash indexes
-            else if (index.getType() != IndexType.BALANCED_TREE.getValue()) {
+            else if (index.getType() != IndexType.BALANCED_TREE.getValue() &&
+                     index.getType() != IndexType.BTREE.getValue()) {
                 continue;
             }
             else {
@@ -0,0 +1,162 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package org.voltdb.plannodes;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json_voltpatches.JSONException;
+import org.json_voltpatches.JSONObject;
+import org.json_voltpatches.JSONStringer;
+import org.voltdb.catalog.Cluster;
+import org.voltdb.catalog.Database;
+import org.voltdb.compiler.DatabaseEstimates;
+import org.voltdb.compiler.ScalarValueHints;
+import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.types.PlanNodeType;
+
+/**
+ * An equi-join that hashes one of its children on the join keys and
+ * probes the hash table with the other. The i-th outer hash expression
+ * is equal to the i-th inner hash expression in every joined row; the
+ * join predicate still holds all of the join conditions, equalities
+ * included. The join does not preserve the order of either child.
+ */
+public class HashJoinPlanNode extends AbstractJoinPlanNode {
+
+    public enum Members {
+        OUTER_HASH_EXPRESSIONS,
+        INNER_HASH_EXPRESSIONS;
+    }
+
+    protected final List<AbstractExpression> m_outerHashExpressions = new ArrayList<AbstractExpression>();
+    protected final List<AbstractExpression> m_innerHashExpressions = new ArrayList<AbstractExpression>();
+
+    public HashJoinPlanNode() {
+        super();
+    }
+
+    @Override
+    public PlanNodeType getPlanNodeType() {
+        return PlanNodeType.HASHJOIN;
+    }
+
+    @Override
+    public void validate() throws Exception {
+        super.validate();
+
+        if (m_outerHashExpressions.isEmpty() ||
+            m_outerHashExpressions.size() != m_innerHashExpressions.size()) {
+            throw new Exception("ERROR: Hash join needs one inner hash expression per outer hash expression");
+        }
+        for (AbstractExpression expr : m_outerHashExpressions) {
+            expr.validate();
+        }
+        for (AbstractExpression expr : m_innerHashExpressions) {
+            expr.validate();
+        }
+    }
+
+    /**
+     * Add a pair of join keys.
+     * @param outerExpr expression over the outer child's columns
+     * @param innerExpr expression over the inner child's columns
+     */
+    public void addHashExpressions(AbstractExpression outerExpr, AbstractExpression innerExpr) {
+        m_outerHashExpressions.add((AbstractExpression) outerExpr.clone());
+        m_innerHashExpressions.add((AbstractExpression) innerExpr.clone());
+    }
+
+    public List<AbstractExpression> getOuterHashExpressions() {
+        return m_outerHashExpressions;
+    }
+
+    public List<AbstractExpression> getInnerHashExpressions() {
+        return m_innerHashExpressions;
+    }
+
+    @Override
+    public void resolveColumnIndexes()
+    {
+        super.resolveColumnIndexes();
+        NodeSchema outer_schema = m_children.get(0).getOutputSchema();
+        NodeSchema inner_schema = m_children.get(1).getOutputSchema();
+        for (AbstractExpression expr : m_outerHashExpressions) {
+            resolvePredicate(expr, outer_schema, inner_schema);
+        }
+        for (AbstractExpression expr : m_innerHashExpressions) {
+            resolvePredicate(expr, outer_schema, inner_schema);
+        }
+    }
+
+    // The probe side is read in its own order, but the matches for a probe
+    // row come out in hash table order, so no sort order survives the join.
+    @Override
+    public void resolveSortDirection() {
+    }
+
+    @Override
+    public void computeCostEstimates(long childOutputTupleCountEstimate,
+                                     Cluster cluster,
+                                     Database db,
+                                     DatabaseEstimates estimates,
+                                     ScalarValueHints[] paramHints)
+    {
+        // Each child is read once, and the smaller one is read again
+        // as it is hashed into the table.
+        long outerTupleCount = m_children.get(0).getEstimatedOutputTupleCount();
+        long innerTupleCount = m_children.get(1).getEstimatedOutputTupleCount();
+
+        m_estimatedOutputTupleCount = childOutputTupleCountEstimate;
+        m_estimatedProcessedTupleCount = childOutputTupleCountEstimate +
+                Math.min(outerTupleCount, innerTupleCount);
+    }
+
+    @Override
+    public void toJSONString(JSONStringer stringer) throws JSONException
+    {
+        super.toJSONString(stringer);
+        stringer.key(Members.OUTER_HASH_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_outerHashExpressions) {
+            stringer.value(ae);
+        }
+        stringer.endArray();
+        stringer.key(Members.INNER_HASH_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_innerHashExpressions) {
+            stringer.value(ae);
+        }
+        stringer.endArray();
+    }
+
+    @Override
+    public void loadFromJSONObject( JSONObject jobj, Database db ) throws JSONException
+    {
+        super.loadFromJSONObject(jobj, db);
+        AbstractExpression.loadFromJSONArrayChild(m_outerHashExpressions, jobj,
+                Members.OUTER_HASH_EXPRESSIONS.name(), null);
+        AbstractExpression.loadFromJSONArrayChild(m_innerHashExpressions, jobj,
+                Members.INNER_HASH_EXPRESSIONS.name(), null);
+    }
+
+    @Override
+    protected String explainPlanForNode(String indent) {
+        return "HASH " + this.m_joinType.toString() + " JOIN" +
+                explainFilters(indent);
+    }
+
+}
@@ -0,0 +1,156 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package org.voltdb.plannodes;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.json_voltpatches.JSONException;
+import org.json_voltpatches.JSONObject;
+import org.json_voltpatches.JSONStringer;
+import org.voltdb.catalog.Cluster;
+import org.voltdb.catalog.Database;
+import org.voltdb.compiler.DatabaseEstimates;
+import org.voltdb.compiler.ScalarValueHints;
+import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.types.PlanNodeType;
+import org.voltdb.types.SortDirectionType;
+
+/**
+ * An equi-join of two children that are sorted, ascending, on the join
+ * keys. The executor reads both children once, in step, and only reads a
+ * run of inner rows again for consecutive outer rows with the same key.
+ * The i-th outer merge expression is equal to the i-th inner merge
+ * expression in every joined row; the join predicate still holds all of
+ * the join conditions, equalities included. The output is in the order of
+ * the outer child.
+ */
+public class MergeJoinPlanNode extends AbstractJoinPlanNode {
+
+    public enum Members {
+        OUTER_MERGE_EXPRESSIONS,
+        INNER_MERGE_EXPRESSIONS;
+    }
+
+    protected final List<AbstractExpression> m_outerMergeExpressions = new ArrayList<AbstractExpression>();
+    protected final List<AbstractExpression> m_innerMergeExpressions = new ArrayList<AbstractExpression>();
+
+    public MergeJoinPlanNode() {
+        super();
+    }
+
+    @Override
+    public PlanNodeType getPlanNodeType() {
+        return PlanNodeType.MERGEJOIN;
+    }
+
+    @Override
+    public void validate() throws Exception {
+        super.validate();
+
+        if (m_outerMergeExpressions.isEmpty() ||
+            m_outerMergeExpressions.size() != m_innerMergeExpressions.size()) {
+            throw new Exception("ERROR: Merge join needs one inner merge expression per outer merge expression");
+        }
+        for (AbstractExpression expr : m_outerMergeExpressions) {
+            expr.validate();
+        }
+        for (AbstractExpression expr : m_innerMergeExpressions) {
+            expr.validate();
+        }
+    }
+
+    /**
+     * Add a pair of join keys.
+     * @param outerExpr expression over the outer child's columns
+     * @param innerExpr expression over the inner child's columns
+     */
+    public void addMergeExpressions(AbstractExpression outerExpr, AbstractExpression innerExpr) {
+        m_outerMergeExpressions.add((AbstractExpression) outerExpr.clone());
+        m_innerMergeExpressions.add((AbstractExpression) innerExpr.clone());
+    }
+
+    public List<AbstractExpression> getOuterMergeExpressions() {
+        return m_outerMergeExpressions;
+    }
+
+    public List<AbstractExpression> getInnerMergeExpressions() {
+        return m_innerMergeExpressions;
+    }
+
+    @Override
+    public void resolveColumnIndexes()
+    {
+        super.resolveColumnIndexes();
+        NodeSchema outer_schema = m_children.get(0).getOutputSchema();
+        NodeSchema inner_schema = m_children.get(1).getOutputSchema();
+        for (AbstractExpression expr : m_outerMergeExpressions) {
+            resolvePredicate(expr, outer_schema, inner_schema);
+        }
+        for (AbstractExpression expr : m_innerMergeExpressions) {
+            resolvePredicate(expr, outer_schema, inner_schema);
+        }
+    }
+
+    @Override
+    public void computeCostEstimates(long childOutputTupleCountEstimate,
+                                     Cluster cluster,
+                                     Database db,
+                                     DatabaseEstimates estimates,
+                                     ScalarValueHints[] paramHints)
+    {
+        // Each child is read once, and nothing is kept but the current
+        // outer row's keys.
+        m_estimatedOutputTupleCount = childOutputTupleCountEstimate;
+        m_estimatedProcessedTupleCount = childOutputTupleCountEstimate;
+    }
+
+    @Override
+    public void toJSONString(JSONStringer stringer) throws JSONException
+    {
+        super.toJSONString(stringer);
+        stringer.key(Members.OUTER_MERGE_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_outerMergeExpressions) {
+            stringer.value(ae);
+        }
+        stringer.endArray();
+        stringer.key(Members.INNER_MERGE_EXPRESSIONS.name()).array();
+        for (AbstractExpression ae : m_innerMergeExpressions) {
+            stringer.value(ae);
+        }
+        stringer.endArray();
+    }
+
+    @Override
+    public void loadFromJSONObject( JSONObject jobj, Database db ) throws JSONException
+    {
+        super.loadFromJSONObject(jobj, db);
+        AbstractExpression.loadFromJSONArrayChild(m_outerMergeExpressions, jobj,
+                Members.OUTER_MERGE_EXPRESSIONS.name(), null);
+        AbstractExpression.loadFromJSONArrayChild(m_innerMergeExpressions, jobj,
+                Members.INNER_MERGE_EXPRESSIONS.name(), null);
+    }
+
+    @Override
+    protected String explainPlanForNode(String indent) {
+        return "MERGE " + this.m_joinType.toString() + " JOIN" +
+                (m_sortDirection == SortDirectionType.INVALID ? "" : " (" + m_sortDirection + ")") +
+                explainFilters(indent);
+    }
+
+}
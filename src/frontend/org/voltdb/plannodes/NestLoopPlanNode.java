@@ -42,13 +42,13 @@ public class NestLoopPlanNode extends AbstractJoinPlanNode {
                                      DatabaseEstimates estimates,
                                      ScalarValueHints[] paramHints)
     {
-        // This method doesn't do anything besides what the parent method does,
-        // but it is a nice place to put a comment.
-        // Since both children's' cost get included in the costing, this
-        // already mirrors the kind of estimating we do in a nestloopjoin.
+        // Both children's cost get included in the costing, but the inner
+        // table is then rescanned once per outer tuple.
+        long outerTupleCount = m_children.get(0).getEstimatedOutputTupleCount();
+        long innerTupleCount = m_children.get(1).getEstimatedOutputTupleCount();
 
         m_estimatedOutputTupleCount = childOutputTupleCountEstimate;
-        m_estimatedProcessedTupleCount = childOutputTupleCountEstimate;
+        m_estimatedProcessedTupleCount = outerTupleCount + outerTupleCount * innerTupleCount;
     }
 
     @Override
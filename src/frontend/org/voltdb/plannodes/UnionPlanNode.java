@@ -30,11 +30,15 @@ import org.voltdb.types.PlanNodeType;
 public class UnionPlanNode extends AbstractPlanNode {
 
     public enum Members {
-        UNION_TYPE
+        UNION_TYPE,
+        SORTED_INPUTS
     }
 
     // Union Type
     private final ParsedUnionStmt.UnionType m_unionType;
+    // Whether each child's rows are expected to be sorted on all columns,
+    // which lets the executor merge the children rather than hash them.
+    private boolean m_sortedInputs = false;
 
     public UnionPlanNode() {
         super();
@@ -66,6 +70,14 @@ public class UnionPlanNode extends AbstractPlanNode {
         return m_unionType;
     }
 
+    public void setSortedInputs(boolean sortedInputs) {
+        m_sortedInputs = sortedInputs;
+    }
+
+    public boolean hasSortedInputs() {
+        return m_sortedInputs;
+    }
+
     @Override
     public void generateOutputSchema(Database db)
     {
@@ -101,6 +113,9 @@ public class UnionPlanNode extends AbstractPlanNode {
     public void toJSONString(JSONStringer stringer) throws JSONException {
         super.toJSONString(stringer);
         stringer.key(Members.UNION_TYPE.name()).value(m_unionType.name());
+        if (m_sortedInputs) {
+            stringer.key(Members.SORTED_INPUTS.name()).value(true);
+        }
     }
 
     @Override
@@ -111,5 +126,6 @@ public class UnionPlanNode extends AbstractPlanNode {
     @Override
     public void loadFromJSONObject( JSONObject jobj, Database db ) throws JSONException {
         helpLoadFromJSONObject(jobj, db);
+        m_sortedInputs = jobj.optBoolean(Members.SORTED_INPUTS.name());
     }
 }
@@ -26,12 +26,14 @@ import org.voltdb.plannodes.AggregatePlanNode;
 import org.voltdb.plannodes.DeletePlanNode;
 import org.voltdb.plannodes.DistinctPlanNode;
 import org.voltdb.plannodes.HashAggregatePlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.IndexCountPlanNode;
 import org.voltdb.plannodes.IndexScanPlanNode;
 import org.voltdb.plannodes.InsertPlanNode;
 import org.voltdb.plannodes.LimitPlanNode;
 import org.voltdb.plannodes.MaterializePlanNode;
 import org.voltdb.plannodes.MaterializedScanPlanNode;
+import org.voltdb.plannodes.MergeJoinPlanNode;
 import org.voltdb.plannodes.NestLoopIndexPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
 import org.voltdb.plannodes.OrderByPlanNode;
@@ -63,6 +65,8 @@ public enum PlanNodeType {
     //
     NESTLOOP        (20, NestLoopPlanNode.class),
     NESTLOOPINDEX   (21, NestLoopIndexPlanNode.class),
+    HASHJOIN        (22, HashJoinPlanNode.class),
+    MERGEJOIN       (23, MergeJoinPlanNode.class),
 
     //
     // Operator Nodes
@@ -0,0 +1,148 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <string>
+#include "harness.h"
+#include "common/LikePattern.h"
+#include "common/NValue.hpp"
+#include "common/ThreadLocalPool.h"
+#include "common/ValueFactory.hpp"
+
+using namespace std;
+using namespace voltdb;
+
+class LikePatternTest : public Test {
+    ThreadLocalPool m_pool;
+public:
+    LikePatternTest() {}
+
+    static bool matches(const char *pattern, const char *value) {
+        LikePattern compiled(pattern, static_cast<int32_t>(strlen(pattern)));
+        return compiled.matches(value, static_cast<int32_t>(strlen(value)));
+    }
+
+    static LikePattern::Shape shapeOf(const char *pattern) {
+        return LikePattern(pattern, static_cast<int32_t>(strlen(pattern))).shape();
+    }
+
+    // offset of the first occurrence in the first length bytes, or -1
+    static int offsetOf(const string &haystack, int32_t length, const string &needle) {
+        const char *found = LikePattern::find(haystack.data(), length,
+                                              needle.data(), static_cast<int32_t>(needle.size()));
+        return found == NULL ? -1 : static_cast<int>(found - haystack.data());
+    }
+
+    static int naiveOffsetOf(const string &haystack, int32_t length, const string &needle) {
+        string::size_type at = haystack.substr(0, length).find(needle);
+        return at == string::npos ? -1 : static_cast<int>(at);
+    }
+};
+
+TEST_F(LikePatternTest, ClassifiesShapes) {
+    EXPECT_EQ(LikePattern::LIKE_EXACT, shapeOf(""));
+    EXPECT_EQ(LikePattern::LIKE_EXACT, shapeOf("abc"));
+    EXPECT_EQ(LikePattern::LIKE_PREFIX, shapeOf("abc%"));
+    EXPECT_EQ(LikePattern::LIKE_PREFIX, shapeOf("abc%%"));
+    EXPECT_EQ(LikePattern::LIKE_SUFFIX, shapeOf("%abc"));
+    EXPECT_EQ(LikePattern::LIKE_SUFFIX, shapeOf("%"));
+    EXPECT_EQ(LikePattern::LIKE_CONTAINS, shapeOf("%abc%"));
+    EXPECT_EQ(LikePattern::LIKE_GENERAL, shapeOf("a_c"));
+    EXPECT_EQ(LikePattern::LIKE_GENERAL, shapeOf("a%c"));
+    EXPECT_EQ(LikePattern::LIKE_GENERAL, shapeOf("%_"));
+
+    LikePattern prefix("ab%", 3);
+    EXPECT_EQ(2, prefix.literalLength());
+    EXPECT_EQ(0, strncmp("ab", prefix.literal(), 2));
+}
+
+TEST_F(LikePatternTest, MatchesSimpleShapes) {
+    EXPECT_TRUE(matches("", ""));
+    EXPECT_FALSE(matches("", "a"));
+    EXPECT_TRUE(matches("abc", "abc"));
+    EXPECT_FALSE(matches("abc", "abcd"));
+    EXPECT_TRUE(matches("abc%", "abc"));
+    EXPECT_TRUE(matches("abc%", "abcdef"));
+    EXPECT_FALSE(matches("abc%", "ab"));
+    EXPECT_TRUE(matches("%def", "abcdef"));
+    EXPECT_FALSE(matches("%def", "defa"));
+    EXPECT_TRUE(matches("%", ""));
+    EXPECT_TRUE(matches("%%", "anything"));
+    EXPECT_TRUE(matches("%cd%", "abcdef"));
+    EXPECT_FALSE(matches("%cd%", "acbdef"));
+    EXPECT_TRUE(matches("%âx%", "aaâxx"));
+}
+
+TEST_F(LikePatternTest, MatchesGeneralPatterns) {
+    EXPECT_TRUE(matches("ab_d_fg", "abcdefg"));
+    EXPECT_TRUE(matches("X%_", "XY"));
+    EXPECT_TRUE(matches("%_a%", "aaaaaaa"));
+    EXPECT_FALSE(matches("a%c", "abcd"));
+    // '_' takes a whole character, however many bytes it is
+    EXPECT_TRUE(matches("â_x一xxéyyԱ", "â🀲x一xxéyyԱ"));
+    EXPECT_FALSE(matches("â__x一xxéyyԱ", "â🀲x一xxéyyԱ"));
+}
+
+TEST_F(LikePatternTest, FindsAcrossBlocks) {
+    // Needles at every offset of haystacks a few 16 byte blocks long,
+    // including ones whose first byte recurs just before them.
+    string haystack(70, 'a');
+    const char *needles[] = { "b", "ab", "bb", "bab", "abcdefghijklmnopq" };
+    for (int nn = 0; nn < 5; nn++) {
+        const string needle(needles[nn]);
+        for (size_t at = 0; at + needle.size() <= haystack.size(); at++) {
+            string text(haystack);
+            text.replace(at, needle.size(), needle);
+            const int32_t length = static_cast<int32_t>(text.size());
+            EXPECT_EQ(naiveOffsetOf(text, length, needle), offsetOf(text, length, needle));
+            // and in a haystack that ends just before the needle does
+            const int32_t shorter = static_cast<int32_t>(at + needle.size() - 1);
+            EXPECT_EQ(naiveOffsetOf(text, shorter, needle), offsetOf(text, shorter, needle));
+        }
+        EXPECT_EQ(-1, offsetOf(haystack, static_cast<int32_t>(haystack.size()), needle));
+    }
+}
+
+TEST_F(LikePatternTest, AgreesWithNValueLike) {
+    const char *values[] = { "", "aaaaaaa", "abcccc%", "abcdefg", "âxxxéyy", "â🀲x一xxéyyԱ" };
+    const char *patterns[] = { "", "%", "aaa%", "abc%", "AbC%", "aaaaaaa", "%defg", "%de%",
+                               "%%g", "%_a%", "a_%c%", "â_x一xxéyyԱ", "%éy%", "%Ա" };
+    for (int pp = 0; pp < 14; pp++) {
+        NValue pattern = ValueFactory::getStringValue(patterns[pp]);
+        LikePattern compiled(patterns[pp], static_cast<int32_t>(strlen(patterns[pp])));
+        for (int vv = 0; vv < 6; vv++) {
+            NValue value = ValueFactory::getStringValue(values[vv]);
+            const bool expected = matches(patterns[pp], values[vv]);
+            EXPECT_EQ(expected, value.like(pattern).isTrue());
+            EXPECT_EQ(expected, value.like(compiled).isTrue());
+            value.free();
+        }
+        pattern.free();
+    }
+    EXPECT_FALSE(ValueFactory::getNullStringValue().like(LikePattern("%", 1)).isTrue());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -2547,6 +2547,80 @@ TEST_F(NValueTest, TestInList)
     delete testPool;
 }
 
+TEST_F(NValueTest, TestInListSortedLookup)
+{
+    assert(ExecutorContext::getExecutorContext() == NULL);
+    Pool* testPool = new Pool();
+    UndoQuantum* wantNoQuantum = NULL;
+    Topend* topless = NULL;
+    ExecutorContext* poolHolder =
+        new ExecutorContext(0, 0, wantNoQuantum, topless, testPool, false, "", 0);
+
+    // multiples of 21 in descending order, plus a null
+    const int length = 100;
+    NValue bigint_NV_set[length];
+    for (int ii = 0; ii < length - 1; ++ii) {
+        bigint_NV_set[ii] = ValueFactory::getBigIntValue((length - ii) * 21);
+    }
+    bigint_NV_set[length - 1] = NValue::getNullValue(VALUE_TYPE_BIGINT);
+
+    // a deserialized list is sorted as it arrives
+    NValue streamed_list =
+        streamNValueArrayintoInList(VALUE_TYPE_BIGINT, bigint_NV_set, length, testPool);
+
+    // a built list is sorted on request, and scanned until then
+    vector<NValue> elements(bigint_NV_set, bigint_NV_set + length);
+    NValue built_list = ValueFactory::getArrayValueFromSizeAndType(length, VALUE_TYPE_BIGINT);
+    built_list.setArrayElements(elements);
+    EXPECT_TRUE(ValueFactory::getBigIntValue(42).inList(built_list));
+    built_list.prepareInListLookup();
+
+    for (int value = -10; value <= (length + 1) * 21; ++value) {
+        // the list holds 21 * 2 through 21 * length
+        bool expected = (value > 0) && (value % 21 == 0) &&
+            (value / 21 >= 2) && (value / 21 <= length);
+        // probes of every integer width take the int64 path
+        EXPECT_EQ(expected, ValueFactory::getBigIntValue(value).inList(streamed_list));
+        EXPECT_EQ(expected, ValueFactory::getIntegerValue(value).inList(streamed_list));
+        EXPECT_EQ(expected, ValueFactory::getBigIntValue(value).inList(built_list));
+        if (value >= -128 && value <= 127) {
+            EXPECT_EQ(expected, ValueFactory::getTinyIntValue(static_cast<int8_t>(value)).inList(built_list));
+        }
+    }
+    // a null never matches, not even the null in the list
+    EXPECT_FALSE(NValue::getNullValue(VALUE_TYPE_BIGINT).inList(built_list));
+    EXPECT_FALSE(NValue::getNullValue(VALUE_TYPE_BIGINT).inList(streamed_list));
+
+    // non-integer probes compare as NValues
+    EXPECT_TRUE(ValueFactory::getDoubleValue(42.0).inList(streamed_list));
+    EXPECT_FALSE(ValueFactory::getDoubleValue(42.5).inList(streamed_list));
+
+    // changing the elements drops back to the linear scan
+    elements[0] = ValueFactory::getBigIntValue(5);
+    built_list.setArrayElements(elements);
+    EXPECT_TRUE(ValueFactory::getBigIntValue(5).inList(built_list));
+    EXPECT_FALSE(ValueFactory::getBigIntValue(length * 21).inList(built_list));
+
+    // string lists binary search the sorted copy
+    const char* string_set[] = { "pear", "apple", "fig", "quince", "banana" };
+    const int string_length = SIZE_OF_ARRAY(string_set);
+    NValue string_NV_set[string_length];
+    initNValueArray(string_NV_set, string_set, string_length);
+    NValue string_list =
+        streamNValueArrayintoInList(VALUE_TYPE_VARCHAR, string_NV_set, string_length, testPool);
+    for (int ii = 0; ii < string_length; ++ii) {
+        EXPECT_TRUE(string_NV_set[ii].inList(string_list));
+    }
+    NValue grape = ValueFactory::getStringValue("grape");
+    EXPECT_FALSE(grape.inList(string_list));
+    grape.free();
+    freeNValueArray(string_NV_set, string_length);
+
+    built_list.free();
+    delete poolHolder;
+    delete testPool;
+}
+
 bool checkValueVector(vector<NValue> &values) {
     // check the array by verifying all values are larger than the previous value
     // this checks order and the lack of duplicates
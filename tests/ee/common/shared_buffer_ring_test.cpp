@@ -0,0 +1,144 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "harness.h"
+#include "common/SharedBufferRing.h"
+#include "common/serializeio.h"
+
+using namespace std;
+using namespace voltdb;
+
+static const size_t CAPACITY = FallbackSerializeOutput::MAX_ALLOCATION_SIZE;
+
+class SharedBufferRingTest : public Test {
+public:
+    SharedBufferRingTest() {}
+
+    static string ringPath() {
+        char path[64];
+        snprintf(path, sizeof(path), "%s/shared_buffer_ring_test-%d",
+                 access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp", static_cast<int>(getpid()));
+        return string(path);
+    }
+};
+
+TEST_F(SharedBufferRingTest, TakesBuffersInTurn) {
+    SharedBufferRing ring(2, CAPACITY);
+    EXPECT_EQ(2, ring.count());
+    EXPECT_EQ(CAPACITY, ring.capacity());
+    EXPECT_EQ(-1, ring.current());
+
+    char *first = ring.advance(0);
+    EXPECT_EQ(ring.buffer(0), first);
+    EXPECT_EQ(0, ring.current());
+    EXPECT_EQ(ring.buffer(1), ring.advance(0));
+    EXPECT_EQ(first, ring.advance(0));
+    EXPECT_TRUE(ring.buffer(0) != ring.buffer(1));
+}
+
+TEST_F(SharedBufferRingTest, GrowsInPlaceToCapacity) {
+    SharedBufferRing ring(1, CAPACITY);
+    char *buffer = ring.advance(0);
+    // the whole capacity is usable without the buffer moving
+    buffer[0] = 'a';
+    buffer[CAPACITY / 2] = 'b';
+    buffer[CAPACITY - 1] = 'c';
+    EXPECT_EQ(buffer, ring.buffer(0));
+    EXPECT_EQ('a', buffer[0]);
+    EXPECT_EQ('b', buffer[CAPACITY / 2]);
+    EXPECT_EQ('c', buffer[CAPACITY - 1]);
+}
+
+TEST_F(SharedBufferRingTest, TrimsBeyondRetainedBytesWhenReused) {
+    SharedBufferRing ring(2, CAPACITY);
+    char *buffer = ring.advance(0);
+    const size_t written = SharedBufferRing::RETAINED_BYTES * 2;
+    ::memset(buffer, 'x', written);
+    ring.advance(written);
+
+    // nothing is trimmed until the ring comes back around
+    EXPECT_EQ('x', buffer[written - 1]);
+    EXPECT_EQ(buffer, ring.advance(0));
+    EXPECT_EQ('x', buffer[0]);
+    EXPECT_EQ('x', buffer[SharedBufferRing::RETAINED_BYTES - 1]);
+    EXPECT_EQ(0, buffer[SharedBufferRing::RETAINED_BYTES]);
+    EXPECT_EQ(0, buffer[written - 1]);
+}
+
+TEST_F(SharedBufferRingTest, DetachKeepsContents) {
+    SharedBufferRing ring(2, CAPACITY);
+    char *buffer = ring.advance(0);
+    ::strcpy(buffer, "results");
+
+    char *detached = ring.detach(0);
+    EXPECT_EQ(buffer, detached);
+    EXPECT_TRUE(ring.buffer(0) != detached);
+    EXPECT_EQ(0, ::strcmp("results", detached));
+    EXPECT_EQ(0, ring.buffer(0)[0]);
+
+    // the replacement is taken in turn like the original
+    ring.advance(0);
+    EXPECT_EQ(ring.buffer(0), ring.advance(0));
+    SharedBufferRing::unmap(detached, CAPACITY);
+}
+
+TEST_F(SharedBufferRingTest, SharedFileIsVisibleToOtherMappings) {
+    const string path = ringPath();
+    {
+        SharedBufferRing ring(2, CAPACITY, path);
+        EXPECT_EQ(path, ring.path());
+        EXPECT_EQ(0, ring.stride() % 4096);
+        EXPECT_EQ(ring.buffer(0) + ring.stride(), ring.buffer(1));
+
+        // map the file the way a reading process would
+        int fd = ::open(path.c_str(), O_RDONLY);
+        ASSERT_TRUE(fd >= 0);
+        const size_t size = ring.stride() * 2;
+        void *mapped = ::mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        ASSERT_TRUE(mapped != MAP_FAILED);
+        const char *reader = static_cast<const char*>(mapped);
+
+        ring.advance(0);
+        char *buffer = ring.advance(0);
+        ::strcpy(buffer, "results");
+        buffer[CAPACITY - 1] = 'z';
+        EXPECT_EQ(1, ring.current());
+        EXPECT_EQ(0, ::strcmp("results", reader + ring.stride()));
+        EXPECT_EQ('z', reader[ring.stride() + CAPACITY - 1]);
+        EXPECT_EQ(0, reader[0]);
+        ::munmap(mapped, size);
+    }
+    // the ring removes the file
+    EXPECT_NE(0, ::access(path.c_str(), F_OK));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
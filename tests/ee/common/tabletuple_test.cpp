@@ -23,7 +23,9 @@
 
 #include "harness.h"
 #include "common/tabletuple.h"
+#include "common/serializeio.h"
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 #include "common/ThreadLocalPool.h"
 
 using namespace voltdb;
@@ -88,6 +90,84 @@ TEST_F(TableTupleTest, ComputeNonInlinedMemory)
     TupleSchema::freeTupleSchema(non_inline_schema);
 }
 
+static bool isShortStringSlot(const TableTuple &tuple, int column)
+{
+    const char *slot = tuple.address() + TUPLE_HEADER_SIZE + tuple.getSchema()->columnOffset(column);
+    return StringRef::isShortString(*reinterpret_cast<StringRef* const*>(slot));
+}
+
+TEST_F(TableTupleTest, ShortStringSlots)
+{
+    vector<bool> column_allow_null(3, true);
+    vector<ValueType> types(3, VALUE_TYPE_VARCHAR);
+    types[0] = VALUE_TYPE_BIGINT;
+    vector<int32_t> lengths(3, UNINLINEABLE_OBJECT_LENGTH + 100);
+    lengths[0] = NValue::getTupleStorageSize(VALUE_TYPE_BIGINT);
+    TupleSchema* schema = TupleSchema::createTupleSchema(types, lengths, column_allow_null, true);
+
+    // Values of up to 6 bytes are kept in the slot, longer ones out of line.
+    TableTuple tuple(schema);
+    tuple.move(new char[tuple.tupleLength()]);
+    NValue shortString = ValueFactory::getStringValue("123456");
+    NValue longString = ValueFactory::getStringValue("1234567");
+    tuple.setNValue(0, ValueFactory::getBigIntValue(1));
+    tuple.setNValueAllocateForObjectCopies(1, shortString, NULL);
+    tuple.setNValueAllocateForObjectCopies(2, longString, NULL);
+    EXPECT_TRUE(isShortStringSlot(tuple, 1));
+    EXPECT_FALSE(isShortStringSlot(tuple, 2));
+    EXPECT_EQ("123456", ValuePeeker::peekStringCopy(tuple.getNValue(1)));
+    EXPECT_EQ("1234567", ValuePeeker::peekStringCopy(tuple.getNValue(2)));
+    EXPECT_EQ(StringRef::computeStringMemoryUsed(7), tuple.getNonInlinedMemorySize());
+
+    // A short string compares and hashes the same as one held out of line.
+    TableTuple other(schema);
+    other.move(new char[other.tupleLength()]);
+    other.setNValue(0, ValueFactory::getBigIntValue(1));
+    other.setNValue(1, shortString);
+    other.setNValue(2, longString);
+    EXPECT_FALSE(isShortStringSlot(other, 1));
+    EXPECT_TRUE(tuple.equals(other));
+    EXPECT_EQ(0, tuple.compare(other));
+    EXPECT_EQ(other.hashCode(), tuple.hashCode());
+    EXPECT_EQ(0, tuple.getNValue(1).compare(shortString));
+    NValue empty = ValueFactory::getStringValue("");
+    other.setNValue(1, empty);
+    EXPECT_TRUE(tuple.compare(other) > 0);
+
+    // Copying a short string from one tuple's slot to another's keeps it there.
+    other.setNValue(1, tuple.getNValue(1));
+    EXPECT_TRUE(isShortStringSlot(other, 1));
+    EXPECT_TRUE(tuple.equals(other));
+    other.setNValue(1, empty);
+
+    // Deserialized short strings go into the slot, and round trip unchanged.
+    char buffer[1024];
+    ReferenceSerializeOutput output(buffer, sizeof(buffer));
+    tuple.serializeTo(output);
+    TableTuple copy(schema);
+    copy.move(new char[copy.tupleLength()]);
+    ReferenceSerializeInput input(buffer, output.position());
+    copy.deserializeFrom(input, NULL);
+    EXPECT_TRUE(isShortStringSlot(copy, 1));
+    EXPECT_FALSE(isShortStringSlot(copy, 2));
+    EXPECT_TRUE(tuple.equals(copy));
+
+    // Setting NULL or freeing the columns leaves no short string behind to free.
+    copy.setNValueAllocateForObjectCopies(1, ValueFactory::getNullStringValue(), NULL);
+    EXPECT_TRUE(copy.getNValue(1).isNull());
+    copy.freeObjectColumns();
+    tuple.freeObjectColumns();
+    tuple.getNValue(1).free();
+
+    delete[] tuple.address();
+    delete[] other.address();
+    delete[] copy.address();
+    shortString.free();
+    longString.free();
+    empty.free();
+    TupleSchema::freeTupleSchema(schema);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,297 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Tests of the slab pools handed out by the ThreadLocalPool, and timings
+ * of them against the boost::pools they replaced, allocating and freeing
+ * the way inserts and deletes of string columns do: each malloc and free
+ * first looks up the pool for its size. The timings of 4M allocations are
+ * part of the test suite; pass "large" on the command line to time 40M.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "boost/pool/pool.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/unordered_map.hpp"
+#include "common/SlabPool.h"
+#include "common/ThreadLocalPool.h"
+#include "common/ValuePeeker.hpp"
+#include "execution/VoltDBEngine.h"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+using namespace std;
+
+static bool s_large = false;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/*
+ * The pools the ThreadLocalPool used to hand out: boost::pools shared by
+ * allocation size from a hash map.
+ */
+class BoostPools {
+public:
+    typedef boost::shared_ptr<boost::pool<> > PoolPtr;
+
+    PoolPtr get(size_t size) {
+        const size_t allocSize = ThreadLocalPool::getAllocationSizeForObject(size);
+        boost::unordered_map<size_t, PoolPtr>::iterator iter = m_pools.find(allocSize);
+        if (iter == m_pools.end()) {
+            PoolPtr pool(new boost::pool<>(allocSize));
+            m_pools.insert(make_pair(allocSize, pool));
+            return pool;
+        }
+        return iter->second;
+    }
+
+    boost::unordered_map<size_t, PoolPtr> m_pools;
+};
+
+class SlabPools {
+public:
+    SlabPool *get(size_t size) {
+        return ThreadLocalPool::get(size);
+    }
+};
+
+class ThreadLocalPoolTest : public Test {
+public:
+    /*
+     * Allocate count chunks of from minSize to twice that many bytes,
+     * freeing a random earlier one after every other allocation, then free
+     * the rest. Returns the sum of the first bytes written, so the work
+     * can't be optimized away.
+     */
+    template <typename Pools>
+    int64_t churn(Pools &pools, size_t minSize, int64_t count) {
+        uint64_t random = 1;
+        vector<pair<char*, size_t> > live;
+        live.reserve(count);
+        int64_t sum = 0;
+        for (int64_t i = 0; i < count; i++) {
+            const size_t size = minSize + static_cast<size_t>(i) % (minSize + 1);
+            char *chunk = static_cast<char*>(pools.get(size)->malloc());
+            chunk[0] = static_cast<char>(i);
+            chunk[size - 1] = static_cast<char>(i);
+            live.push_back(make_pair(chunk, size));
+            if (i % 2 == 1) {
+                random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+                size_t victim = static_cast<size_t>(random >> 33) % live.size();
+                sum += live[victim].first[0];
+                pools.get(live[victim].second)->free(live[victim].first);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+        for (size_t i = 0; i < live.size(); i++) {
+            sum += live[i].first[0];
+            pools.get(live[i].second)->free(live[i].first);
+        }
+        return sum;
+    }
+
+    void compare(size_t minSize, int64_t count) {
+        int64_t start = nowMicros();
+        int64_t expected;
+        {
+            BoostPools pools;
+            expected = churn(pools, minSize, count);
+        }
+        int64_t boostMicros = nowMicros() - start;
+        start = nowMicros();
+        SlabPools pools;
+        ASSERT_EQ(expected, churn(pools, minSize, count));
+        ASSERT_EQ(0, ThreadLocalPool::get(minSize)->getStats().chunksInUse);
+        printf("  %4d to %4d bytes: boost::pool %5lld ms, SlabPool %5lld ms\n",
+               (int)minSize, (int)minSize * 2, (long long)boostMicros / 1000,
+               (long long)(nowMicros() - start) / 1000);
+    }
+};
+
+TEST_F(ThreadLocalPoolTest, SlabPool) {
+    SlabPool pool(12);
+    const SlabPoolStats &stats = pool.getStats();
+    ASSERT_EQ(12, stats.requestedSize);
+    ASSERT_EQ(16, stats.chunkSize);
+    ASSERT_EQ(0, stats.bytesAllocated);
+
+    // chunks are distinct, aligned and don't overlap
+    set<char*> chunks;
+    const size_t perSlab = SlabPool::SLAB_SIZE / 16;
+    for (size_t i = 0; i < perSlab + 1; i++) {
+        char *chunk = static_cast<char*>(pool.malloc());
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(chunk) % sizeof(void*));
+        memset(chunk, 0xff, 12);
+        ASSERT_TRUE(chunks.insert(chunk).second);
+    }
+    ASSERT_EQ(2, stats.slabs);
+    ASSERT_EQ(2 * SlabPool::SLAB_SIZE, stats.bytesAllocated);
+    ASSERT_EQ(perSlab + 1, stats.chunksInUse);
+    for (set<char*>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+        set<char*>::iterator next = iter;
+        if (++next != chunks.end()) {
+            ASSERT_TRUE(*next - *iter >= 16);
+        }
+    }
+
+    // freed chunks are reused before any more slabs are mapped
+    char *freed = *chunks.begin();
+    pool.free(freed);
+    ASSERT_EQ(freed, pool.malloc());
+    for (set<char*>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+        pool.free(*iter);
+    }
+    ASSERT_EQ(0, stats.chunksInUse);
+    for (size_t i = 0; i < perSlab + 1; i++) {
+        ASSERT_TRUE(chunks.count(static_cast<char*>(pool.malloc())) == 1);
+    }
+    ASSERT_EQ(2, stats.slabs);
+    ASSERT_EQ(2 * (perSlab + 1) + 1, stats.allocations);
+}
+
+TEST_F(ThreadLocalPoolTest, LargeChunks) {
+    // too big for two to fit in a 2 megabyte slab
+    const size_t size = 1024 * 1024 + 12;
+    SlabPool pool(size);
+    char *first = static_cast<char*>(pool.malloc());
+    char *second = static_cast<char*>(pool.malloc());
+    memset(first, 1, size);
+    memset(second, 2, size);
+    ASSERT_EQ(1, pool.getStats().slabs);
+    ASSERT_TRUE(pool.getStats().bytesAllocated >= 2 * size);
+    ASSERT_TRUE(pool.getStats().bytesAllocated < 2 * size + 4096);
+    pool.malloc();
+    ASSERT_EQ(2, pool.getStats().slabs);
+    ASSERT_EQ(1, first[size - 1]);
+}
+
+TEST_F(ThreadLocalPoolTest, ThreadLocalPools) {
+    ThreadLocalPool threadPool;
+    // approximate sizes round up, and share the pool of their size class
+    SlabPool *pool = ThreadLocalPool::get(20);
+    ASSERT_EQ(24, pool->getRequestedSize());
+    ASSERT_EQ(pool, ThreadLocalPool::get(17));
+    ASSERT_EQ(pool, ThreadLocalPool::getExact(24));
+    ASSERT_TRUE(pool != ThreadLocalPool::get(16));
+    ASSERT_TRUE(pool != ThreadLocalPool::getExact(20));
+    ASSERT_EQ(1024 * 1024 + 4 + sizeof(void*),
+              ThreadLocalPool::get(1024 * 1024)->getRequestedSize());
+
+    const size_t before = ThreadLocalPool::getPoolAllocationSize();
+    void *chunk = ThreadLocalPool::get(100)->malloc();
+    ASSERT_EQ(before + SlabPool::SLAB_SIZE, ThreadLocalPool::getPoolAllocationSize());
+
+    vector<SlabPoolStats> stats;
+    ThreadLocalPool::getPoolStats(stats);
+    size_t total = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        if (i > 0) {
+            ASSERT_TRUE(stats[i - 1].requestedSize < stats[i].requestedSize);
+        }
+        if (stats[i].requestedSize == 128) {
+            ASSERT_EQ(1, stats[i].chunksInUse);
+        }
+        total += stats[i].bytesAllocated;
+    }
+    ASSERT_TRUE(total <= ThreadLocalPool::getPoolAllocationSize());
+    ThreadLocalPool::get(100)->free(chunk);
+}
+
+/*
+ * The engine reports a row of MEMORY stats for each of the thread's pools.
+ */
+TEST_F(ThreadLocalPoolTest, PoolStats) {
+    VoltDBEngine engine;
+    vector<char> resultBuffer(1024 * 1024);
+    char exceptionBuffer[4096];
+    engine.setBuffers(NULL, 0, &resultBuffer[0], resultBuffer.size(), exceptionBuffer, sizeof(exceptionBuffer));
+    engine.resetReusedResultOutputBuffer();
+    engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+
+    SlabPool *pool = ThreadLocalPool::get(100);
+    void *first = pool->malloc();
+    ASSERT_EQ(1, engine.getStats(STATISTICS_SELECTOR_TYPE_MEMORY, NULL, 0, true, 1));
+    // the first stats table may have taken memory from pools of new sizes
+    engine.resetReusedResultOutputBuffer();
+    ASSERT_EQ(1, engine.getStats(STATISTICS_SELECTOR_TYPE_MEMORY, NULL, 0, true, 1));
+
+    vector<const SlabPool*> pools;
+    ThreadLocalPool::getPools(pools);
+    vector<CatalogId> locators;
+    for (size_t i = 0; i < pools.size(); i++) {
+        locators.push_back(static_cast<CatalogId>(pools[i]->getRequestedSize()));
+    }
+    // allocations are counted since the last interval
+    void *second = pool->malloc();
+    void *third = pool->malloc();
+    Table *stats = engine.getStatsManager().getStats(STATISTICS_SELECTOR_TYPE_MEMORY, locators, true, 2);
+    ASSERT_EQ(pools.size(), stats->activeTupleCount());
+
+    size_t found = 0;
+    TableTuple row(stats->schema());
+    TableIterator &iter = stats->iterator();
+    while (iter.next(row)) {
+        if (ValuePeeker::peekAsInteger(row.getNValue(stats->columnIndex("REQUESTED_SIZE"))) != 128) {
+            continue;
+        }
+        found++;
+        ASSERT_EQ(128, ValuePeeker::peekAsInteger(row.getNValue(stats->columnIndex("CHUNK_SIZE"))));
+        ASSERT_EQ(1, ValuePeeker::peekAsInteger(row.getNValue(stats->columnIndex("SLABS"))));
+        ASSERT_EQ(SlabPool::SLAB_SIZE,
+                  ValuePeeker::peekAsBigInt(row.getNValue(stats->columnIndex("BYTES_ALLOCATED"))));
+        ASSERT_EQ(3, ValuePeeker::peekAsBigInt(row.getNValue(stats->columnIndex("CHUNKS_IN_USE"))));
+        ASSERT_EQ(2, ValuePeeker::peekAsBigInt(row.getNValue(stats->columnIndex("ALLOCATIONS"))));
+    }
+    ASSERT_EQ(1, found);
+    pool->free(first);
+    pool->free(second);
+    pool->free(third);
+}
+
+TEST_F(ThreadLocalPoolTest, Benchmark) {
+    ThreadLocalPool threadPool;
+    const int64_t count = s_large ? 40000000 : 4000000;
+    printf("%lld allocations\n", (long long)count);
+    // StringRefs, short strings and longer ones
+    compare(16, count);
+    compare(48, count);
+    compare(384, count / 4);
+}
+
+int main(int argc, char **argv) {
+    s_large = (argc > 1 && strcmp(argv[1], "large") == 0);
+    return TestSuite::globalInstance()->runAll();
+}
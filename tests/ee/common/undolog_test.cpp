@@ -57,6 +57,35 @@ private:
     MockUndoActionHistory *m_history;
 };
 
+/*
+ * Handles undo records whose tuples are really histories, checking that
+ * it is handed runs of the type they were logged as.
+ */
+class MockUndoRecordHandler : public voltdb::UndoRecordHandler {
+public:
+    MockUndoRecordHandler() : m_typesMatched(true) {}
+
+    void undoRecords(voltdb::UndoRecordType type, const voltdb::UndoRecord *records, std::size_t count) {
+        for (std::size_t ii = count; ii > 0; ii--) {
+            m_typesMatched = m_typesMatched && static_cast<uint32_t>(type) == records[ii - 1].m_type;
+            MockUndoActionHistory *history = reinterpret_cast<MockUndoActionHistory*>(records[ii - 1].m_data);
+            history->m_undone = true;
+            history->m_undoneIndex = staticUndoneIndex++;
+        }
+    }
+
+    void releaseRecords(voltdb::UndoRecordType type, const voltdb::UndoRecord *records, std::size_t count) {
+        for (std::size_t ii = count; ii > 0; ii--) {
+            m_typesMatched = m_typesMatched && static_cast<uint32_t>(type) == records[ii - 1].m_type;
+            MockUndoActionHistory *history = reinterpret_cast<MockUndoActionHistory*>(records[ii - 1].m_data);
+            history->m_released = true;
+            history->m_releasedIndex = staticReleaseIndex++;
+        }
+    }
+
+    bool m_typesMatched;
+};
+
 class UndoLogTest : public Test {
 public:
 
@@ -83,6 +112,34 @@ public:
         return undoTokens;
     }
 
+    /*
+     * One quantum logging the given sequence of changes, where 'a' is an
+     * UndoAction and 'i' and 'd' are insert and delete records of one of
+     * two handlers, alternating between them at each '|'.
+     */
+    int64_t generateQuantumOfRecords(const char *changes) {
+        const int64_t undoToken = INT64_MIN + 1;
+        voltdb::UndoQuantum *quantum = m_undoLog->generateUndoQuantum(undoToken);
+        std::vector<MockUndoActionHistory*> histories;
+        int handler = 0;
+        for (const char *change = changes; *change != '\0'; change++) {
+            if (*change == '|') {
+                handler = 1 - handler;
+                continue;
+            }
+            MockUndoActionHistory *history = new MockUndoActionHistory();
+            histories.push_back(history);
+            if (*change == 'a') {
+                quantum->registerUndoAction(new (*quantum) MockUndoAction(history));
+            } else {
+                quantum->registerUndoRecord(*change == 'i' ? voltdb::UNDO_RECORD_INSERT : voltdb::UNDO_RECORD_DELETE,
+                                            reinterpret_cast<char*>(history), &m_handlers[handler]);
+            }
+        }
+        m_undoActionHistoryByQuantum.push_back(histories);
+        return undoToken;
+    }
+
     ~UndoLogTest() {
         delete m_undoLog;
         for(std::vector<std::vector<MockUndoActionHistory*> >::iterator i = m_undoActionHistoryByQuantum.begin();
@@ -126,6 +183,7 @@ public:
 
     voltdb::UndoLog *m_undoLog;
     std::vector<std::vector<MockUndoActionHistory*> > m_undoActionHistoryByQuantum;
+    MockUndoRecordHandler m_handlers[2];
 };
 
 /*
@@ -288,6 +346,28 @@ TEST_F(UndoLogTest, TestTwoQuantumTwoActionUndoOneReleaseOne) {
     confirmReleaseActionHistoryOrder(m_undoActionHistoryByQuantum[0], startingIndex);
 }
 
+/*
+ * Check that undo records and actions logged in between them are undone,
+ * or released, strictly in reverse order.
+ */
+TEST_F(UndoLogTest, TestRecordsAndActionsUndoOrdering) {
+    int64_t undoToken = generateQuantumOfRecords("aiiadd|ii|ddaia");
+    m_undoLog->undo(undoToken);
+    int startingIndex = 0;
+    confirmUndoneActionHistoryOrder(m_undoActionHistoryByQuantum[0], startingIndex);
+    ASSERT_EQ(13, startingIndex);
+    ASSERT_TRUE(m_handlers[0].m_typesMatched && m_handlers[1].m_typesMatched);
+}
+
+TEST_F(UndoLogTest, TestRecordsAndActionsReleaseOrdering) {
+    int64_t undoToken = generateQuantumOfRecords("aiiadd|ii|ddaia");
+    m_undoLog->release(undoToken);
+    int startingIndex = 0;
+    confirmReleaseActionHistoryOrder(m_undoActionHistoryByQuantum[0], startingIndex);
+    ASSERT_EQ(13, startingIndex);
+    ASSERT_TRUE(m_handlers[0].m_typesMatched && m_handlers[1].m_typesMatched);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
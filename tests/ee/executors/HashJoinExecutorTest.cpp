@@ -0,0 +1,203 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Inner and left hash joins of O to I, building on either side. O's key
+ * is a SMALLINT and I's a BIGINT, so the keys are of different widths,
+ * and both sides have NULL keys, which never match. Results are sorted
+ * by O.ID and I.ID, since a hash join's output order is that of the
+ * probe side.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+class HashJoinExecutorTest : public PlanTestingBaseClass {
+public:
+    HashJoinExecutorTest(int64_t tempTableMemory = voltdb::DEFAULT_TEMP_TABLE_MEMORY)
+        : PlanTestingBaseClass(tempTableMemory) {
+        addTable("O", "ID INTEGER, K SMALLINT, NAME STRING(8)");
+        addTable("I", "ID BIGINT, K BIGINT, V STRING(8)");
+        loadCatalog();
+        addRows("O", "1,10,a;"
+                     "2,20,b;"
+                     "3,NULL,c;"
+                     "4,30,d;"
+                     "5,20,e");
+        addRows("I", "100,20,b;"
+                     "101,20,y;"
+                     "102,40,a;"
+                     "103,NULL,c;"
+                     "104,10,v");
+    }
+
+    /* Make I the larger input, so that the join builds on O */
+    void growInner() {
+        addRows("I", "105,50,u;106,60,t;107,70,s");
+    }
+
+    /*
+     * SELECT * FROM O [LEFT] JOIN I ON O.<outerKey> = I.<innerKey> [AND more]
+     * ORDER BY O.ID, I.ID, with more fields (e.g. predicates) for the join.
+     */
+    std::string join(const std::string &joinType, int outerKey, int innerKey,
+                     const std::string &fields = "", const std::string &inlineLimit = "") {
+        std::vector<std::string> outer = columnsOf("O");
+        std::vector<std::string> inner = columnsOf("I", 1);
+        std::vector<std::string> columns = outer;
+        columns.insert(columns.end(), inner.begin(), inner.end());
+
+        std::string joinFields = "'OUTPUT_SCHEMA':" + outputSchema(columns) +
+            ",'JOIN_TYPE':'" + joinType + "'" +
+            ",'OUTER_HASH_EXPRESSIONS':[" + outer[outerKey] + "]" +
+            ",'INNER_HASH_EXPRESSIONS':[" + inner[innerKey] + "]";
+        if ( ! fields.empty()) {
+            joinFields += "," + fields;
+        }
+        std::vector<std::string> nodes;
+        nodes.push_back(node(1, "SEND", "[2]", ""));
+        nodes.push_back(node(2, "ORDERBY", "[3]",
+                             "'SORT_COLUMNS':[{'SORT_EXPRESSION':" + tupleValue(0, "INTEGER") +
+                             ",'SORT_DIRECTION':'ASC'},{'SORT_EXPRESSION':" + tupleValue(3, "BIGINT") +
+                             ",'SORT_DIRECTION':'ASC'}]"));
+        nodes.push_back(node(3, "HASHJOIN", "[4,5]", joinFields,
+                             inlineLimit.empty() ? "[]" : "[" + inlineLimit + "]"));
+        nodes.push_back(seqScan(4, "O"));
+        nodes.push_back(seqScan(5, "I"));
+        return execute(fragment(nodes, "[4,5,3,2,1]"));
+    }
+
+    static std::string limit(int limit, int offset) {
+        return node(0, "LIMIT", "[]", "'LIMIT':" + toString(limit) + ",'OFFSET':" + toString(offset));
+    }
+
+    static int rowCount(const std::string &rows) {
+        if (rows.empty()) {
+            return 0;
+        }
+        return static_cast<int>(std::count(rows.begin(), rows.end(), ';')) + 1;
+    }
+
+    void checkJoins() {
+        // equal keys of different widths match, NULL keys never do
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;2,20,b,101,20,y;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join("INNER", 1, 1));
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;2,20,b,101,20,y;"
+                  "3,NULL,c,NULL,NULL,NULL;"
+                  "4,30,d,NULL,NULL,NULL;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join("LEFT", 1, 1));
+
+        // string keys
+        EXPECT_EQ("1,10,a,102,40,a;2,20,b,100,20,b;3,NULL,c,103,NULL,c",
+                  join("INNER", 2, 2));
+
+        // the rest of the join predicate still applies to each match
+        const std::string predicate = "'JOIN_PREDICATE':" +
+            binary("CONJUNCTION_AND",
+                   binary("COMPARE_EQUAL", tupleValue(1, "SMALLINT"), tupleValue(1, "BIGINT", 0, 1)),
+                   binary("COMPARE_NOTEQUAL", tupleValue(0, "BIGINT", 0, 1), constant(101, "BIGINT")));
+        EXPECT_EQ("1,10,a,104,10,v;2,20,b,100,20,b;5,20,e,100,20,b",
+                  join("INNER", 1, 1, predicate));
+
+        // outer tuples failing the pre-join predicate are padded, not matched
+        const std::string preJoin = "'PRE_JOIN_PREDICATE':" +
+            binary("COMPARE_NOTEQUAL", tupleValue(0, "INTEGER"), constant(2));
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,NULL,NULL,NULL;"
+                  "3,NULL,c,NULL,NULL,NULL;"
+                  "4,30,d,NULL,NULL,NULL;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join("LEFT", 1, 1, preJoin));
+    }
+
+    void checkLimits() {
+        EXPECT_EQ(0, rowCount(join("INNER", 1, 1, "", limit(0, 0))));
+        EXPECT_EQ(3, rowCount(join("INNER", 1, 1, "", limit(3, 0))));
+        EXPECT_EQ(2, rowCount(join("INNER", 1, 1, "", limit(-1, 3))));
+        EXPECT_EQ(3, rowCount(join("LEFT", 1, 1, "", limit(3, 4))));
+        EXPECT_EQ(0, rowCount(join("LEFT", 1, 1, "", limit(10, 7))));
+        // the limit with no offset is as much as there is
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;2,20,b,101,20,y;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join("INNER", 1, 1, "", limit(100, 0)));
+    }
+};
+
+TEST_F(HashJoinExecutorTest, BuildOnInner) {
+    checkJoins();
+}
+
+TEST_F(HashJoinExecutorTest, BuildOnOuter) {
+    growInner();
+    checkJoins();
+}
+
+TEST_F(HashJoinExecutorTest, LimitAndOffsetBuildingOnInner) {
+    checkLimits();
+}
+
+TEST_F(HashJoinExecutorTest, LimitAndOffsetBuildingOnOuter) {
+    growInner();
+    checkLimits();
+}
+
+/*
+ * A fragment whose temp tables leave room for the join's inputs but not
+ * for a hash table on either of them.
+ */
+class HashJoinMemoryLimitTest : public HashJoinExecutorTest {
+public:
+    HashJoinMemoryLimitTest() : HashJoinExecutorTest(2 * 1024 * 1024) {}
+
+    /* count rows of the given table's columns, with keys from firstKey on */
+    void addManyRows(const std::string &table, int count, int firstKey) {
+        std::ostringstream rows;
+        for (int ii = 0; ii < count; ii++) {
+            rows << (ii == 0 ? "" : ";") << ii << "," << (firstKey + ii) << ",x";
+        }
+        addRows(table, rows.str());
+    }
+};
+
+TEST_F(HashJoinMemoryLimitTest, HashTableCountsAgainstTempTableMemory) {
+    // no key matches, so the output stays empty
+    addManyRows("O", 20000, 0);
+    addManyRows("I", 20000, 100000);
+    const std::string error = "<error> More than 2 MB of temp table memory";
+    EXPECT_EQ(error, join("INNER", 1, 1).substr(0, error.size()));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
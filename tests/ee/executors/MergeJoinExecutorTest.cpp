@@ -0,0 +1,187 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Inner and left merge joins of O to I. O and I hold their rows in K
+ * order, NULLs first, as index scans would return them; ON and IN hold
+ * the same rows in NAME and V order. Results are sorted by the outer and
+ * inner IDs.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+class MergeJoinExecutorTest : public PlanTestingBaseClass {
+public:
+    MergeJoinExecutorTest() {
+        addTable("O", "ID INTEGER, K SMALLINT, NAME STRING(8)");
+        addTable("ON", "ID INTEGER, K SMALLINT, NAME STRING(8)");
+        addTable("I", "ID BIGINT, K BIGINT, V STRING(8)");
+        addTable("IN", "ID BIGINT, K BIGINT, V STRING(8)");
+        loadCatalog();
+        addRows("O", "3,NULL,c;"
+                     "1,10,a;"
+                     "2,20,b;"
+                     "5,20,e;"
+                     "4,30,d");
+        addRows("ON", "1,10,a;"
+                      "2,20,b;"
+                      "3,NULL,c;"
+                      "4,30,d;"
+                      "5,20,e");
+        addRows("I", "103,NULL,c;"
+                     "104,10,v;"
+                     "100,20,b;"
+                     "101,20,y;"
+                     "102,40,a");
+        addRows("IN", "102,40,a;"
+                      "100,20,b;"
+                      "103,NULL,c;"
+                      "104,10,v;"
+                      "101,20,y");
+    }
+
+    /*
+     * SELECT * FROM <outer> [LEFT] JOIN <inner> ON <outer keys> = <inner keys>
+     * [AND more] ORDER BY <outer>.ID, <inner>.ID, with more fields (e.g.
+     * predicates) for the join.
+     */
+    std::string join(const std::string &outerTable, const std::string &innerTable,
+                     const std::string &joinType, const std::vector<int> &keys,
+                     const std::string &fields = "", const std::string &inlineLimit = "") {
+        std::vector<std::string> outer = columnsOf(outerTable);
+        std::vector<std::string> inner = columnsOf(innerTable, 1);
+        std::vector<std::string> columns = outer;
+        columns.insert(columns.end(), inner.begin(), inner.end());
+
+        std::string outerKeys;
+        std::string innerKeys;
+        for (int ii = 0; ii < keys.size(); ii++) {
+            outerKeys += (ii == 0 ? "" : ",") + outer[keys[ii]];
+            innerKeys += (ii == 0 ? "" : ",") + inner[keys[ii]];
+        }
+        std::string joinFields = "'OUTPUT_SCHEMA':" + outputSchema(columns) +
+            ",'JOIN_TYPE':'" + joinType + "'" +
+            ",'OUTER_MERGE_EXPRESSIONS':[" + outerKeys + "]" +
+            ",'INNER_MERGE_EXPRESSIONS':[" + innerKeys + "]";
+        if ( ! fields.empty()) {
+            joinFields += "," + fields;
+        }
+        std::vector<std::string> nodes;
+        nodes.push_back(node(1, "SEND", "[2]", ""));
+        nodes.push_back(node(2, "ORDERBY", "[3]",
+                             "'SORT_COLUMNS':[{'SORT_EXPRESSION':" + tupleValue(0, "INTEGER") +
+                             ",'SORT_DIRECTION':'ASC'},{'SORT_EXPRESSION':" + tupleValue(3, "BIGINT") +
+                             ",'SORT_DIRECTION':'ASC'}]"));
+        nodes.push_back(node(3, "MERGEJOIN", "[4,5]", joinFields,
+                             inlineLimit.empty() ? "[]" : "[" + inlineLimit + "]"));
+        nodes.push_back(seqScan(4, outerTable));
+        nodes.push_back(seqScan(5, innerTable));
+        return execute(fragment(nodes, "[4,5,3,2,1]"));
+    }
+
+    std::string join(const std::string &outerTable, const std::string &innerTable,
+                     const std::string &joinType, int key,
+                     const std::string &fields = "", const std::string &inlineLimit = "") {
+        return join(outerTable, innerTable, joinType, std::vector<int>(1, key), fields, inlineLimit);
+    }
+
+    static std::string limit(int limit, int offset) {
+        return node(0, "LIMIT", "[]", "'LIMIT':" + toString(limit) + ",'OFFSET':" + toString(offset));
+    }
+
+    static int rowCount(const std::string &rows) {
+        if (rows.empty()) {
+            return 0;
+        }
+        return static_cast<int>(std::count(rows.begin(), rows.end(), ';')) + 1;
+    }
+
+    void checkJoins(const std::string &outerTable, const std::string &innerTable) {
+        // runs of equal keys on both sides, keys of different widths, and
+        // NULL keys, which never match
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;2,20,b,101,20,y;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join(outerTable, innerTable, "INNER", 1));
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;2,20,b,101,20,y;"
+                  "3,NULL,c,NULL,NULL,NULL;"
+                  "4,30,d,NULL,NULL,NULL;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join(outerTable, innerTable, "LEFT", 1));
+
+        // two keys
+        std::vector<int> keys;
+        keys.push_back(1);
+        keys.push_back(2);
+        EXPECT_EQ("2,20,b,100,20,b", join(outerTable, innerTable, "INNER", keys));
+
+        // the rest of the join predicate still applies to each match
+        const std::string predicate = "'JOIN_PREDICATE':" +
+            binary("COMPARE_NOTEQUAL", tupleValue(0, "BIGINT", 0, 1), constant(101, "BIGINT"));
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,100,20,b;"
+                  "3,NULL,c,NULL,NULL,NULL;"
+                  "4,30,d,NULL,NULL,NULL;"
+                  "5,20,e,100,20,b",
+                  join(outerTable, innerTable, "LEFT", 1, predicate));
+
+        // outer tuples failing the pre-join predicate are padded, not matched
+        const std::string preJoin = "'PRE_JOIN_PREDICATE':" +
+            binary("COMPARE_NOTEQUAL", tupleValue(0, "INTEGER"), constant(2));
+        EXPECT_EQ("1,10,a,104,10,v;"
+                  "2,20,b,NULL,NULL,NULL;"
+                  "3,NULL,c,NULL,NULL,NULL;"
+                  "4,30,d,NULL,NULL,NULL;"
+                  "5,20,e,100,20,b;5,20,e,101,20,y",
+                  join(outerTable, innerTable, "LEFT", 1, preJoin));
+
+        EXPECT_EQ(0, rowCount(join(outerTable, innerTable, "INNER", 1, "", limit(0, 0))));
+        EXPECT_EQ(3, rowCount(join(outerTable, innerTable, "INNER", 1, "", limit(3, 0))));
+        EXPECT_EQ(2, rowCount(join(outerTable, innerTable, "INNER", 1, "", limit(-1, 3))));
+        EXPECT_EQ(3, rowCount(join(outerTable, innerTable, "LEFT", 1, "", limit(3, 4))));
+        EXPECT_EQ(0, rowCount(join(outerTable, innerTable, "LEFT", 1, "", limit(10, 7))));
+    }
+};
+
+TEST_F(MergeJoinExecutorTest, IntegerKeys) {
+    checkJoins("O", "I");
+}
+
+TEST_F(MergeJoinExecutorTest, StringKeys) {
+    EXPECT_EQ("1,10,a,102,40,a;2,20,b,100,20,b;3,NULL,c,103,NULL,c",
+              join("ON", "IN", "INNER", 2));
+    EXPECT_EQ("1,10,a,102,40,a;2,20,b,100,20,b;3,NULL,c,103,NULL,c;"
+              "4,30,d,NULL,NULL,NULL;5,20,e,NULL,NULL,NULL",
+              join("ON", "IN", "LEFT", 2));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
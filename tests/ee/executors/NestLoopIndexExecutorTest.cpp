@@ -0,0 +1,239 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Inner and left nested loop index joins of O to I on O.K = I.K, through
+ * tree, B+tree and hash indexes on I.K. Without an inline LIMIT the
+ * executor probes the index a batch of outer tuples at a time; with one it
+ * probes once per outer tuple. O has enough rows for several batches, so
+ * each join is run both ways, and must give the same rows in the same
+ * order, the rows a reference join computes here.
+ *
+ * I.K is a SMALLINT and O.K a BIGINT, some of whose values overflow or
+ * underflow I.K and so match nothing. Both sides have NULL keys, which
+ * the index (as opposed to the planner's predicates) matches to each
+ * other. I has three rows for each key, unless its index is unique.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+static const int OUTER_ROWS = 2500;
+static const int INNER_KEYS = 40;
+// in place of a NULL key or flag
+static const int NULL_VALUE = -1000000;
+
+struct Row {
+    int id;
+    int key;
+    int flag;
+};
+
+class NestLoopIndexExecutorTest : public PlanTestingBaseClass {
+public:
+    /* Declare and fill the tables, with an index of the given type on I.K */
+    void build(TableIndexType type, bool unique) {
+        addTable("O", "ID INTEGER, K BIGINT, F INTEGER");
+        addTable("I", "ID INTEGER, K SMALLINT, G INTEGER");
+        addIndex("I", "IK", type, unique, "K");
+        loadCatalog();
+
+        for (int id = 1; id <= OUTER_ROWS; id++) {
+            Row row;
+            row.id = id;
+            if (id % 7 == 0) {
+                row.key = NULL_VALUE;
+            } else if (id % 11 == 0) {
+                row.key = 40000 + id;
+            } else if (id % 13 == 0) {
+                row.key = -40000 - id;
+            } else {
+                // keys 0 to 59, only 0 to 39 of which are in I
+                row.key = id * 37 % 60;
+            }
+            row.flag = (id % 5 == 0) ? 0 : 1;
+            m_outer.push_back(row);
+        }
+        const int copies = unique ? 1 : 3;
+        for (int ii = 0; ii < INNER_KEYS * copies; ii++) {
+            Row row;
+            row.id = 1000 + ii;
+            row.key = ii % INNER_KEYS;
+            row.flag = (ii % 4 == 0) ? 0 : 1;
+            m_inner.push_back(row);
+        }
+        Row nullKey = { 2000, NULL_VALUE, 1 };
+        m_inner.push_back(nullKey);
+        addRows("O", rowsText(m_outer));
+        addRows("I", rowsText(m_inner));
+    }
+
+    static std::string valueText(int value) {
+        return value == NULL_VALUE ? "NULL" : toString(value);
+    }
+
+    static std::string rowText(const Row &row) {
+        return valueText(row.id) + "," + valueText(row.key) + "," + valueText(row.flag);
+    }
+
+    static std::string rowsText(const std::vector<Row> &rows) {
+        std::string text;
+        for (int ii = 0; ii < rows.size(); ii++) {
+            text += (ii == 0 ? "" : ";") + rowText(rows[ii]);
+        }
+        return text;
+    }
+
+    /*
+     * SELECT * FROM O [LEFT] JOIN I ON O.K = I.K [AND O.F = 1] [AND I.G = 1],
+     * the first condition being the pre-join predicate and the second the
+     * inner scan's predicate. An inline LIMIT, which matches every row,
+     * makes the executor probe once per outer tuple.
+     */
+    std::string join(const std::string &joinType, bool preJoin, bool post, bool perTuple) {
+        std::vector<std::string> columns = columnsOf("O");
+        std::vector<std::string> inner = columnsOf("I", 1);
+        columns.insert(columns.end(), inner.begin(), inner.end());
+
+        std::string joinFields = "'OUTPUT_SCHEMA':" + outputSchema(columns) +
+            ",'JOIN_TYPE':'" + joinType + "'";
+        if (preJoin) {
+            joinFields += ",'PRE_JOIN_PREDICATE':" +
+                binary("COMPARE_EQUAL", tupleValue(2, "INTEGER"), constant(1));
+        }
+        std::string scanFields = "'TARGET_TABLE_NAME':'I','TARGET_INDEX_NAME':'IK'"
+            ",'LOOKUP_TYPE':'EQ','SORT_DIRECTION':'INVALID'"
+            ",'OUTPUT_SCHEMA':" + outputSchema(columnsOf("I")) +
+            ",'SEARCHKEY_EXPRESSIONS':[" + tupleValue(1, "BIGINT") + "]";
+        if (post) {
+            scanFields += ",'PREDICATE':" +
+                binary("COMPARE_EQUAL", tupleValue(2, "INTEGER", 0, 1), constant(1));
+        }
+        std::string inlineNodes = "[" + node(0, "INDEXSCAN", "[]", scanFields);
+        if (perTuple) {
+            inlineNodes += "," + node(0, "LIMIT", "[]", "'LIMIT':1000000,'OFFSET':0");
+        }
+        inlineNodes += "]";
+
+        std::vector<std::string> nodes;
+        nodes.push_back(node(1, "SEND", "[2]", ""));
+        nodes.push_back(node(2, "NESTLOOPINDEX", "[3]", joinFields, inlineNodes));
+        nodes.push_back(seqScan(3, "O"));
+        return execute(fragment(nodes, "[3,2,1]"));
+    }
+
+    /* The rows of the same join, sorted, since the order of equal inner keys is the index's */
+    std::vector<std::string> expected(bool left, bool preJoin, bool post) {
+        std::vector<std::string> rows;
+        for (int ii = 0; ii < m_outer.size(); ii++) {
+            const Row &outer = m_outer[ii];
+            bool match = false;
+            if ( ! preJoin || outer.flag == 1) {
+                for (int jj = 0; jj < m_inner.size(); jj++) {
+                    const Row &inner = m_inner[jj];
+                    if (inner.key == outer.key && ( ! post || inner.flag == 1)) {
+                        rows.push_back(rowText(outer) + "," + rowText(inner));
+                        match = true;
+                    }
+                }
+            }
+            if (left && ! match) {
+                rows.push_back(rowText(outer) + ",NULL,NULL,NULL");
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    static std::vector<std::string> sortedRows(const std::string &text) {
+        std::vector<std::string> rows;
+        std::string::size_type start = 0;
+        while ( ! text.empty()) {
+            std::string::size_type end = text.find(';', start);
+            rows.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            if (end == std::string::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    void checkJoins() {
+        for (int variant = 0; variant < 8; variant++) {
+            const bool left = (variant & 1) != 0;
+            const bool preJoin = (variant & 2) != 0;
+            const bool post = (variant & 4) != 0;
+            const std::string joinType = left ? "LEFT" : "INNER";
+            const std::string batched = join(joinType, preJoin, post, false);
+            EXPECT_EQ(join(joinType, preJoin, post, true), batched);
+            std::vector<std::string> rows = sortedRows(batched);
+            std::vector<std::string> reference = expected(left, preJoin, post);
+            EXPECT_EQ(reference.size(), rows.size());
+            EXPECT_TRUE(rows == reference);
+        }
+    }
+
+    std::vector<Row> m_outer;
+    std::vector<Row> m_inner;
+};
+
+TEST_F(NestLoopIndexExecutorTest, TreeIndex) {
+    build(BALANCED_TREE_INDEX, false);
+    checkJoins();
+}
+
+TEST_F(NestLoopIndexExecutorTest, BTreeIndex) {
+    build(BTREE_INDEX, false);
+    checkJoins();
+}
+
+TEST_F(NestLoopIndexExecutorTest, HashIndex) {
+    build(HASH_TABLE_INDEX, false);
+    checkJoins();
+}
+
+TEST_F(NestLoopIndexExecutorTest, UniqueTreeIndex) {
+    build(BALANCED_TREE_INDEX, true);
+    checkJoins();
+}
+
+TEST_F(NestLoopIndexExecutorTest, UniqueBTreeIndex) {
+    build(BTREE_INDEX, true);
+    checkJoins();
+}
+
+TEST_F(NestLoopIndexExecutorTest, UniqueHashIndex) {
+    build(HASH_TABLE_INDEX, true);
+    checkJoins();
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
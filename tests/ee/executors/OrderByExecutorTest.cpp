@@ -0,0 +1,240 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * ORDER BY with an inlined LIMIT and OFFSET, which keeps only the first
+ * LIMIT + OFFSET tuples in a heap when that is fewer than the input, and
+ * sorts the whole input otherwise. Results are checked against a stable
+ * sort of the same rows. T has 41 rows: A takes five values, eight rows
+ * each, plus one NULL, which sorts first; C is distinct in every row.
+ */
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+static const int ROWS = 41;
+static const int ID = 0;
+static const int A = 1;
+static const int C = 2;
+// A of the row with a NULL A, which sorts before every other value
+static const int NULL_A = -1;
+
+struct SortKey {
+    SortKey(int column, bool ascending) : column(column), ascending(ascending) {}
+    int column;
+    bool ascending;
+};
+
+class ReferenceOrder {
+public:
+    ReferenceOrder(const std::vector<SortKey> &keys) : m_keys(keys) {}
+    bool operator()(const std::vector<int> &ra, const std::vector<int> &rb) const {
+        for (int ii = 0; ii < m_keys.size(); ii++) {
+            const int va = ra[m_keys[ii].column];
+            const int vb = rb[m_keys[ii].column];
+            if (va != vb) {
+                return m_keys[ii].ascending ? va < vb : va > vb;
+            }
+        }
+        return false;
+    }
+private:
+    std::vector<SortKey> m_keys;
+};
+
+class OrderByExecutorTest : public PlanTestingBaseClass {
+public:
+    OrderByExecutorTest() {
+        addTable("T", "ID INTEGER, A INTEGER, C INTEGER");
+        loadCatalog();
+        std::string rows;
+        for (int id = 1; id < ROWS; id++) {
+            std::vector<int> row;
+            row.push_back(id);
+            row.push_back(id * 7 % 5);
+            row.push_back(id * 13 % ROWS);
+            m_rows.push_back(row);
+        }
+        std::vector<int> nullRow;
+        nullRow.push_back(ROWS);
+        nullRow.push_back(NULL_A);
+        nullRow.push_back(0);
+        m_rows.push_back(nullRow);
+        for (int ii = 0; ii < m_rows.size(); ii++) {
+            rows += (ii == 0 ? "" : ";") + rowText(m_rows[ii]);
+        }
+        addRows("T", rows);
+    }
+
+    static std::string rowText(const std::vector<int> &row) {
+        std::ostringstream text;
+        text << row[ID] << ",";
+        if (row[A] == NULL_A) {
+            text << "NULL";
+        } else {
+            text << row[A];
+        }
+        text << "," << row[C];
+        return text.str();
+    }
+
+    /* SELECT * FROM T ORDER BY keys LIMIT limit OFFSET offset, with no limit if limit is -1 */
+    std::string orderBy(const std::vector<SortKey> &keys, int limit, int offset) {
+        std::string sortColumns;
+        for (int ii = 0; ii < keys.size(); ii++) {
+            sortColumns += (ii == 0 ? "" : ",");
+            sortColumns += "{'SORT_EXPRESSION':" + tupleValue(keys[ii].column, "INTEGER") +
+                ",'SORT_DIRECTION':'" + (keys[ii].ascending ? "ASC" : "DESC") + "'}";
+        }
+        std::string inlineLimit = "[]";
+        if (limit != -1) {
+            inlineLimit = "[" + node(0, "LIMIT", "[]", "'LIMIT':" + toString(limit) +
+                                     ",'OFFSET':" + toString(offset)) + "]";
+        }
+        std::vector<std::string> nodes;
+        nodes.push_back(node(1, "SEND", "[2]", ""));
+        nodes.push_back(node(2, "ORDERBY", "[3]", "'SORT_COLUMNS':[" + sortColumns + "]", inlineLimit));
+        nodes.push_back(seqScan(3, "T"));
+        return execute(fragment(nodes, "[3,2,1]"));
+    }
+
+    /* The rows the query should return, in a stable order */
+    std::vector<std::vector<int> > expected(const std::vector<SortKey> &keys, int limit, int offset) {
+        std::vector<std::vector<int> > sorted = m_rows;
+        std::stable_sort(sorted.begin(), sorted.end(), ReferenceOrder(keys));
+        const int begin = std::min(std::max(offset, 0), ROWS);
+        const int end = (limit == -1) ? ROWS : std::min(begin + limit, ROWS);
+        return std::vector<std::vector<int> >(sorted.begin() + begin, sorted.begin() + end);
+    }
+
+    std::string expectedText(const std::vector<SortKey> &keys, int limit, int offset) {
+        std::vector<std::vector<int> > rows = expected(keys, limit, offset);
+        std::string text;
+        for (int ii = 0; ii < rows.size(); ii++) {
+            text += (ii == 0 ? "" : ";") + rowText(rows[ii]);
+        }
+        return text;
+    }
+
+    /* The limits and offsets to try: heaps of none, one, some and all but one row, and more than all */
+    static std::vector<std::pair<int, int> > limitsAndOffsets() {
+        const int pairs[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 5, 0 }, { 5, 3 },
+                                 { 3, 20 }, { 40, 0 }, { 39, 1 }, { 41, 0 }, { 100, 0 },
+                                 { 10, 35 }, { 5, 41 }, { 5, 100 }, { -1, 0 } };
+        std::vector<std::pair<int, int> > result;
+        for (int ii = 0; ii < sizeof(pairs) / sizeof(pairs[0]); ii++) {
+            result.push_back(std::make_pair(pairs[ii][0], pairs[ii][1]));
+        }
+        return result;
+    }
+
+    std::vector<std::vector<int> > m_rows;
+};
+
+TEST_F(OrderByExecutorTest, HeapSizes) {
+    std::vector<SortKey> keys(1, SortKey(C, true));
+    EXPECT_EQ("", orderBy(keys, 0, 0));
+    EXPECT_EQ("", orderBy(keys, 0, 1));
+    EXPECT_EQ("41,NULL,0", orderBy(keys, 1, 0));
+    EXPECT_EQ("19,3,1", orderBy(keys, 1, 1));
+    EXPECT_EQ("", orderBy(keys, 5, ROWS));
+    EXPECT_EQ(expectedText(keys, 100, 0), orderBy(keys, 100, 0));
+    EXPECT_EQ(expectedText(keys, 10, 35), orderBy(keys, 10, 35));
+}
+
+TEST_F(OrderByExecutorTest, AscendingAndDescending) {
+    std::vector<std::pair<int, int> > cases = limitsAndOffsets();
+    for (int direction = 0; direction < 2; direction++) {
+        std::vector<SortKey> keys(1, SortKey(C, direction == 0));
+        for (int ii = 0; ii < cases.size(); ii++) {
+            EXPECT_EQ(expectedText(keys, cases[ii].first, cases[ii].second),
+                      orderBy(keys, cases[ii].first, cases[ii].second));
+        }
+    }
+}
+
+TEST_F(OrderByExecutorTest, MultipleKeys) {
+    // A has ties and a NULL, which the second key orders
+    std::vector<std::vector<SortKey> > orderings(4);
+    orderings[0].push_back(SortKey(A, true));
+    orderings[0].push_back(SortKey(C, true));
+    orderings[1].push_back(SortKey(A, true));
+    orderings[1].push_back(SortKey(C, false));
+    orderings[2].push_back(SortKey(A, false));
+    orderings[2].push_back(SortKey(ID, true));
+    orderings[3].push_back(SortKey(A, false));
+    orderings[3].push_back(SortKey(C, false));
+    orderings[3].push_back(SortKey(ID, true));
+    std::vector<std::pair<int, int> > cases = limitsAndOffsets();
+    for (int jj = 0; jj < orderings.size(); jj++) {
+        for (int ii = 0; ii < cases.size(); ii++) {
+            EXPECT_EQ(expectedText(orderings[jj], cases[ii].first, cases[ii].second),
+                      orderBy(orderings[jj], cases[ii].first, cases[ii].second));
+        }
+    }
+}
+
+TEST_F(OrderByExecutorTest, Ties) {
+    // Ordered by A alone, rows with equal A may come in any order, and a
+    // limit that ends inside a run of equal A may take any of its rows.
+    std::vector<std::pair<int, int> > cases = limitsAndOffsets();
+    for (int direction = 0; direction < 2; direction++) {
+        std::vector<SortKey> keys(1, SortKey(A, direction == 0));
+        for (int ii = 0; ii < cases.size(); ii++) {
+            const int limit = cases[ii].first;
+            const int offset = cases[ii].second;
+            std::vector<std::vector<int> > rows = expected(keys, limit, offset);
+            std::istringstream result(orderBy(keys, limit, offset));
+            std::set<int> ids;
+            std::string text;
+            int count = 0;
+            while (std::getline(result, text, ';')) {
+                std::vector<int> row;
+                std::istringstream values(text);
+                std::string value;
+                while (std::getline(values, value, ',')) {
+                    row.push_back(value == "NULL" ? NULL_A : atoi(value.c_str()));
+                }
+                ASSERT_EQ(3, row.size());
+                ASSERT_TRUE(count < rows.size());
+                // a real row of T, in the place of a row with the same A
+                ASSERT_EQ(rowText(m_rows[row[ID] - 1]), text);
+                EXPECT_EQ(rows[count][A], row[A]);
+                EXPECT_TRUE(ids.insert(row[ID]).second);
+                count++;
+            }
+            EXPECT_EQ(rows.size(), count);
+        }
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
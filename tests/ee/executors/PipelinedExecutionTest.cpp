@@ -0,0 +1,216 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Scan, projection, limit and aggregate chains, which the engine runs
+ * pipelined, each producer handing its tuples one at a time to its
+ * parent. Producers reuse one tuple for all their rows, so values taken
+ * from it (MIN, MAX, DISTINCT) must outlive it; NAME is an inlined
+ * string column and NOTE a non-inlined one holding short strings, which
+ * both read in place from the tuple.
+ */
+
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+class PipelinedExecutionTest : public PlanTestingBaseClass {
+public:
+    PipelinedExecutionTest() {
+        addTable("T", "ID INTEGER, G INTEGER, NAME STRING(12), NOTE STRING(100)");
+        loadCatalog();
+        addRows("T", "1,1,pear,fig;"
+                     "2,2,apple,plum;"
+                     "3,1,zebra,date;"
+                     "4,2,kiwi,lime;"
+                     "5,1,mango,kiwi;"
+                     "6,2,banana,pear;"
+                     "7,1,pear,fig");
+    }
+
+    /* A scan of T, projecting all its columns */
+    static std::string scan(int id) {
+        std::vector<std::string> columns;
+        columns.push_back(tupleValue(0, "INTEGER"));
+        columns.push_back(tupleValue(1, "INTEGER"));
+        columns.push_back(tupleValue(2, "STRING", 12));
+        columns.push_back(tupleValue(3, "STRING", 100));
+        return node(id, "SEQSCAN", "[]", "'TARGET_TABLE_NAME':'T'",
+                    "[" + node(0, "PROJECTION", "[]", "'OUTPUT_SCHEMA':" + outputSchema(columns)) + "]");
+    }
+
+    /* A projection of (NAME, NOTE, G) */
+    static std::string projection(int id, int child) {
+        std::vector<std::string> columns;
+        columns.push_back(tupleValue(2, "STRING", 12));
+        columns.push_back(tupleValue(3, "STRING", 100));
+        columns.push_back(tupleValue(1, "INTEGER"));
+        return node(id, "PROJECTION", "[" + toString(child) + "]",
+                    "'OUTPUT_SCHEMA':" + outputSchema(columns));
+    }
+
+    static std::string limit(int id, int child, int limit, int offset) {
+        return node(id, "LIMIT", "[" + toString(child) + "]",
+                    "'LIMIT':" + toString(limit) + ",'OFFSET':" + toString(offset));
+    }
+
+    static std::string aggregateColumn(const std::string &type, int distinct, int output,
+                                       const std::string &expression) {
+        return "{'AGGREGATE_TYPE':'" + type + "','AGGREGATE_DISTINCT':" + toString(distinct) +
+            ",'AGGREGATE_OUTPUT_COLUMN':" + toString(output) +
+            ",'AGGREGATE_EXPRESSION':" + expression + "}";
+    }
+
+    /*
+     * MIN and MAX of NAME and NOTE, and COUNT(DISTINCT NAME), over the
+     * (NAME, NOTE, G) projection, after G when grouped by it.
+     */
+    static std::string aggregate(int id, int child, bool grouped) {
+        const int first = grouped ? 1 : 0;
+        const std::string name = tupleValue(0, "STRING", 12);
+        const std::string note = tupleValue(1, "STRING", 100);
+        std::vector<std::string> columns;
+        if (grouped) {
+            columns.push_back(tupleValue(2, "INTEGER"));
+        }
+        columns.push_back(tupleValue(first, "STRING", 12));
+        columns.push_back(tupleValue(first + 1, "STRING", 12));
+        columns.push_back(tupleValue(first + 2, "STRING", 100));
+        columns.push_back(tupleValue(first + 3, "STRING", 100));
+        columns.push_back(tupleValue(first + 4, "BIGINT"));
+        std::string fields = "'OUTPUT_SCHEMA':" + outputSchema(columns) + ",'AGGREGATE_COLUMNS':[" +
+            aggregateColumn("AGGREGATE_MIN", 0, first, name) + "," +
+            aggregateColumn("AGGREGATE_MAX", 0, first + 1, name) + "," +
+            aggregateColumn("AGGREGATE_MIN", 0, first + 2, note) + "," +
+            aggregateColumn("AGGREGATE_MAX", 0, first + 3, note) + "," +
+            aggregateColumn("AGGREGATE_COUNT", 1, first + 4, name) + "]";
+        if (grouped) {
+            fields += ",'GROUPBY_EXPRESSIONS':[" + tupleValue(2, "INTEGER") + "]";
+        }
+        return node(id, grouped ? "HASHAGGREGATE" : "AGGREGATE", "[" + toString(child) + "]", fields);
+    }
+
+    static std::string orderByFirstColumn(int id, int child) {
+        return node(id, "ORDERBY", "[" + toString(child) + "]",
+                    "'SORT_COLUMNS':[{'SORT_EXPRESSION':" + tupleValue(0, "INTEGER") +
+                    ",'SORT_DIRECTION':'ASC'}]");
+    }
+
+    static std::string send(int child) {
+        return node(1, "SEND", "[" + toString(child) + "]", "");
+    }
+};
+
+TEST_F(PipelinedExecutionTest, ScanProjectionAggregate) {
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(aggregate(2, 3, false));
+    nodes.push_back(projection(3, 4));
+    nodes.push_back(scan(4));
+    EXPECT_EQ("apple,zebra,date,plum,6", execute(fragment(nodes, "[4,3,2,1]")));
+}
+
+TEST_F(PipelinedExecutionTest, ScanProjectionHashAggregate) {
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(orderByFirstColumn(2, 3));
+    nodes.push_back(aggregate(3, 4, true));
+    nodes.push_back(projection(4, 5));
+    nodes.push_back(scan(5));
+    EXPECT_EQ("1,mango,zebra,date,kiwi,3;2,apple,kiwi,lime,plum,3",
+              execute(fragment(nodes, "[5,4,3,2,1]")));
+}
+
+TEST_F(PipelinedExecutionTest, ScanLimit) {
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(limit(2, 3, 3, 2));
+    nodes.push_back(scan(3));
+    EXPECT_EQ("3,1,zebra,date;4,2,kiwi,lime;5,1,mango,kiwi",
+              execute(fragment(nodes, "[3,2,1]")));
+
+    // a limit past the end of the input
+    nodes[1] = limit(2, 3, 10, 5);
+    EXPECT_EQ("6,2,banana,pear;7,1,pear,fig", execute(fragment(nodes, "[3,2,1]")));
+
+    nodes[1] = limit(2, 3, 0, 0);
+    EXPECT_EQ("", execute(fragment(nodes, "[3,2,1]")));
+}
+
+TEST_F(PipelinedExecutionTest, ScanLimitStopsPredicate) {
+    // 12 / (ID - 4) > -100 divides by zero on the fourth row, which a
+    // limit of two never reaches, however the scan filters its rows
+    const std::string predicate =
+        binary("COMPARE_GREATERTHAN",
+               binary("OPERATOR_DIVIDE", constant(12),
+                      binary("OPERATOR_MINUS", tupleValue(0, "INTEGER"), constant(4))),
+               constant(-100));
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(limit(2, 3, 2, 0));
+    nodes.push_back(seqScan(3, "T", predicate));
+    EXPECT_EQ("1,1,pear,fig;2,2,apple,plum", execute(fragment(nodes, "[3,2,1]")));
+
+    // also with a projection between the scan and the limit
+    nodes[1] = limit(2, 3, 1, 1);
+    nodes[2] = projection(3, 4);
+    nodes.push_back(seqScan(4, "T", predicate));
+    EXPECT_EQ("apple,plum,2", execute(fragment(nodes, "[4,3,2,1]")));
+
+    // without the limit, the fourth row is reached
+    nodes.clear();
+    nodes.push_back(send(2));
+    nodes.push_back(seqScan(2, "T", predicate));
+    EXPECT_EQ(0, execute(fragment(nodes, "[2,1]")).find("<error>"));
+}
+
+TEST_F(PipelinedExecutionTest, ScanProjectionLimitAggregate) {
+    // MIN and MAX of rows 2 to 5
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(aggregate(2, 3, false));
+    nodes.push_back(limit(3, 4, 4, 1));
+    nodes.push_back(projection(4, 5));
+    nodes.push_back(scan(5));
+    EXPECT_EQ("apple,zebra,date,plum,4", execute(fragment(nodes, "[5,4,3,2,1]")));
+}
+
+TEST_F(PipelinedExecutionTest, RepeatedExecution) {
+    // the cached fragment gives the same answer on every execution
+    std::vector<std::string> nodes;
+    nodes.push_back(send(2));
+    nodes.push_back(aggregate(2, 3, false));
+    nodes.push_back(projection(3, 4));
+    nodes.push_back(scan(4));
+    const std::string plan = fragment(nodes, "[4,3,2,1]");
+    for (int ii = 0; ii < 3; ii++) {
+        EXPECT_EQ("apple,zebra,date,plum,6", execute(plan));
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,125 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Set operations over inputs sorted on all their columns, which the
+ * engine merges, and over the same rows out of order, which it notices
+ * part way through and redoes by hashing. A merge's output is sorted;
+ * a hashed operation's is put in order to compare it.
+ */
+
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "test_utils/plan_testing_baseclass.h"
+
+using namespace voltdb;
+
+class UnionExecutorTest : public PlanTestingBaseClass {
+public:
+    UnionExecutorTest() {
+        addTable("A", "ID INTEGER, NAME STRING(8)");
+        addTable("B", "ID INTEGER, NAME STRING(8)");
+        addTable("BU", "ID INTEGER, NAME STRING(8)");
+        addTable("C", "ID INTEGER, NAME STRING(8)");
+        loadCatalog();
+        addRows("A", "1,a;1,a;2,b;3,c;3,c;3,c;5,e");
+        addRows("B", "1,a;3,c;3,c;4,d;5,e;5,e");
+        addRows("BU", "5,e;3,c;1,a;5,e;4,d;3,c");
+        addRows("C", "3,c;5,e");
+    }
+
+    /* The set operation over the tables, optionally sorting its output */
+    std::string setOperation(const std::string &unionType, const std::vector<std::string> &tables,
+                             bool sorted = false) {
+        std::vector<std::string> nodes;
+        std::string children;
+        std::string executeList;
+        for (int ii = 0; ii < tables.size(); ii++) {
+            const int id = 4 + ii;
+            nodes.push_back(seqScan(id, tables[ii]));
+            children += (ii == 0 ? "" : ",") + toString(id);
+            executeList += toString(id) + ",";
+        }
+        nodes.push_back(node(3, "UNION", "[" + children + "]",
+                             "'UNION_TYPE':'" + unionType + "','SORTED_INPUTS':true"));
+        if (sorted) {
+            nodes.push_back(node(2, "ORDERBY", "[3]",
+                                 "'SORT_COLUMNS':[{'SORT_EXPRESSION':" + tupleValue(0, "INTEGER") +
+                                 ",'SORT_DIRECTION':'ASC'},{'SORT_EXPRESSION':" + tupleValue(1, "STRING", 8) +
+                                 ",'SORT_DIRECTION':'ASC'}]"));
+            nodes.push_back(node(1, "SEND", "[2]", ""));
+            return execute(fragment(nodes, "[" + executeList + "3,2,1]"));
+        }
+        nodes.push_back(node(1, "SEND", "[3]", ""));
+        return execute(fragment(nodes, "[" + executeList + "3,1]"));
+    }
+
+    std::string setOperation(const std::string &unionType, const std::string &first,
+                             const std::string &second, bool sorted = false) {
+        std::vector<std::string> tables;
+        tables.push_back(first);
+        tables.push_back(second);
+        return setOperation(unionType, tables, sorted);
+    }
+
+    void checkSetOperations(const std::string &second, bool sorted) {
+        EXPECT_EQ("1,a;2,b;3,c;4,d;5,e", setOperation("UNION", "A", second, sorted));
+        EXPECT_EQ("1,a;3,c;5,e", setOperation("INTERSECT", "A", second, sorted));
+        EXPECT_EQ("1,a;3,c;3,c;5,e", setOperation("INTERSECT_ALL", "A", second, sorted));
+        EXPECT_EQ("2,b", setOperation("EXCEPT", "A", second, sorted));
+        EXPECT_EQ("1,a;2,b;3,c", setOperation("EXCEPT_ALL", "A", second, sorted));
+        EXPECT_EQ("4,d", setOperation("EXCEPT", second, "A", sorted));
+        EXPECT_EQ("4,d;5,e", setOperation("EXCEPT_ALL", second, "A", sorted));
+    }
+};
+
+TEST_F(UnionExecutorTest, SortedInputs) {
+    checkSetOperations("B", false);
+}
+
+TEST_F(UnionExecutorTest, SortedInputsOfThreeTables) {
+    std::vector<std::string> tables;
+    tables.push_back("A");
+    tables.push_back("B");
+    tables.push_back("C");
+    EXPECT_EQ("1,a;2,b;3,c;4,d;5,e", setOperation("UNION", tables));
+    EXPECT_EQ("3,c;5,e", setOperation("INTERSECT", tables));
+    EXPECT_EQ("3,c;5,e", setOperation("INTERSECT_ALL", tables));
+    EXPECT_EQ("2,b", setOperation("EXCEPT", tables));
+    EXPECT_EQ("1,a;2,b", setOperation("EXCEPT_ALL", tables));
+}
+
+TEST_F(UnionExecutorTest, UnsortedInputFallsBack) {
+    checkSetOperations("BU", true);
+}
+
+TEST_F(UnionExecutorTest, UnionAllOfSortedInputs) {
+    // appended, not merged
+    EXPECT_EQ("1,a;1,a;2,b;3,c;3,c;3,c;5,e;1,a;3,c;3,c;4,d;5,e;5,e",
+              setOperation("UNION_ALL", "A", "B"));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
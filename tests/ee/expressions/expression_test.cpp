@@ -55,15 +55,20 @@
 #include <time.h>
 #include <queue>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "harness.h"
 #include "jsoncpp/jsoncpp.h"
 
 #include "expressions/abstractexpression.h"
 #include "expressions/expressions.h"
+#include "expressions/expressionutil.h"
 #include "common/types.h"
 #include "common/ValuePeeker.hpp"
 #include "common/PlannerDomValue.h"
+#include "common/SQLException.h"
+#include "common/ValueFactory.hpp"
+#include "execution/VoltDBEngine.h"
 
 
 using namespace std;
@@ -308,7 +313,33 @@ AbstractExpression * convertToExpression(queue<AE*> &e) {
 class ExpressionTest : public Test {
     public:
         ExpressionTest() {
+            m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
         }
+
+        /*
+         * FIELD(doc, name) of constants, as text, "<null>", or "<error>"
+         * if evaluating it raised an error.
+         */
+        std::string field(const std::string &doc, const std::string &name) {
+            std::vector<AbstractExpression*> *arguments = new std::vector<AbstractExpression*>();
+            arguments->push_back(new ConstantValueExpression(ValueFactory::getStringValue(doc)));
+            arguments->push_back(new ConstantValueExpression(ValueFactory::getStringValue(name)));
+            boost::scoped_ptr<AbstractExpression>
+                expression(ExpressionUtil::functionFactory(FUNC_VOLT_FIELD, arguments));
+            try {
+                NValue result = expression->eval(NULL, NULL);
+                if (result.isNull()) {
+                    return "<null>";
+                }
+                return std::string(reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(result)),
+                                   ValuePeeker::peekObjectLength(result));
+            } catch (const SQLException &e) {
+                return "<error>";
+            }
+        }
+
+    private:
+        VoltDBEngine m_engine;
 };
 
 /*
@@ -456,6 +487,38 @@ TEST_F(ExpressionTest, Timestamp) {
 
 }
 
+TEST_F(ExpressionTest, JsonField) {
+    // plain values, and absent or non-object documents
+    EXPECT_EQ("order", field("{\"type\": \"order\", \"id\": 12}", "type"));
+    EXPECT_EQ("12", field("{\"type\": \"order\", \"id\": 12}", "id"));
+    EXPECT_EQ("true", field("{\"a\":true}", "a"));
+    EXPECT_EQ("<null>", field("{\"a\":null}", "a"));
+    EXPECT_EQ("<null>", field("{\"a\":1}", "b"));
+    EXPECT_EQ("<null>", field("{}", "a"));
+    EXPECT_EQ("<null>", field("[1, 2]", "a"));
+
+    // nested values come back as JSON
+    EXPECT_EQ("{\"c\":[1,2]}", field("{\"a\": 0, \"b\": {\"c\": [1, 2]}}", "b"));
+    EXPECT_EQ("[\"x\",{\"y\":null}]", field("{\"b\": [\"x\", {\"y\": null}]}", "b"));
+    EXPECT_EQ("<null>", field("{\"b\": {\"a\": 1}}", "a"));
+
+    // escapes, in values and in names
+    EXPECT_EQ("say \"hi\"", field("{\"a\": \"say \\\"hi\\\"\"}", "a"));
+    EXPECT_EQ("1", field("{\"a\\\"b\": 1}", "a\"b"));
+    EXPECT_EQ("2", field("{\"\\u0061\": 2}", "a"));
+
+    // a document malformed after the field is still an error
+    EXPECT_EQ("<error>", field("{\"a\":1,\"b\":}", "a"));
+    EXPECT_EQ("<error>", field("{\"a\":1,\"b\":[1,}", "a"));
+    EXPECT_EQ("<error>", field("{\"a\":1 \"b\":2}", "a"));
+    EXPECT_EQ("<error>", field("{\"a\":1,", "a"));
+    EXPECT_EQ("<error>", field("{\"a\":", "a"));
+
+    // the last of a repeated member, as in a full parse
+    EXPECT_EQ("3", field("{\"a\":1,\"b\":2,\"a\":3}", "a"));
+    EXPECT_EQ("x", field("{\"a\":{\"n\":1},\"a\":\"x\"}", "a"));
+}
+
 int main() {
      return TestSuite::globalInstance()->runAll();
 }
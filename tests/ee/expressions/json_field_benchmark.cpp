@@ -0,0 +1,302 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Checks that FIELD of a document scanned for a compiled field matches
+ * FIELD of the document parsed in full, and timings of the two, for
+ * documents of a few members and of a few hundred members, looking up a
+ * member near the start, one near the end and one that is absent.
+ *
+ * The 100K row runs are part of the test suite; pass "large" on the
+ * command line to add 2M row runs.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "common/executorcontext.hpp"
+#include "common/JsonField.h"
+#include "common/NValue.hpp"
+#include "common/SQLException.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "execution/VoltDBEngine.h"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/expressionutil.h"
+#include "expressions/functionexpression.h"
+
+using namespace voltdb;
+
+static bool s_large = false;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/*
+ * FIELD as it was evaluated before fields were compiled: the whole
+ * document parsed into a tree, then the member looked up in it.
+ */
+static NValue fullParseField(const NValue &doc, const NValue &field) {
+    const char *docChars = reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(doc));
+    Json::Value root;
+    parseJsonDocument(docChars, ValuePeeker::peekObjectLength(doc), root);
+    const std::string name(reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(field)),
+                           ValuePeeker::peekObjectLength(field));
+    if ( ! root.isObject() || ! root.isMember(name)) {
+        return ValueFactory::getNullStringValue();
+    }
+    return jsonElementValue(root[name]);
+}
+
+/* A FIELD result as text, or the error evaluating it raised. */
+template <typename F>
+static std::string outcome(F evaluate) {
+    try {
+        NValue result = evaluate();
+        if (result.isNull()) {
+            return "<null>";
+        }
+        return std::string(reinterpret_cast<const char*>(ValuePeeker::peekObjectValue(result)),
+                           ValuePeeker::peekObjectLength(result));
+    } catch (const SQLException &e) {
+        return "<error> " + e.message();
+    }
+}
+
+struct FullParse {
+    FullParse(const NValue &doc, const NValue &field) : m_doc(doc), m_field(field) {}
+    NValue operator()() const { return fullParseField(m_doc, m_field); }
+    const NValue &m_doc;
+    const NValue &m_field;
+};
+
+struct Compiled {
+    Compiled(const NValue &doc, const JsonField &field) : m_doc(doc), m_field(field) {}
+    NValue operator()() const { return m_doc.jsonField(m_field); }
+    const NValue &m_doc;
+    const JsonField &m_field;
+};
+
+struct Evaluate {
+    Evaluate(const AbstractExpression *expression) : m_expression(expression) {}
+    NValue operator()() const { return m_expression->eval(NULL, NULL); }
+    const AbstractExpression *m_expression;
+};
+
+class JsonFieldBenchmark : public Test {
+public:
+    JsonFieldBenchmark() {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    std::string fieldOf(const std::string &doc, const std::string &name) {
+        NValue docValue = ValueFactory::getTempStringValue(doc.c_str(), doc.length());
+        NValue nameValue = ValueFactory::getTempStringValue(name.c_str(), name.length());
+        JsonField field(name.c_str(), static_cast<int32_t>(name.length()));
+        std::string expected = outcome(FullParse(docValue, nameValue));
+        std::string actual = outcome(Compiled(docValue, field));
+        if (expected != actual) {
+            printf("FIELD(%s, '%s'): scanned %s, parsed %s\n",
+                   doc.c_str(), name.c_str(), actual.c_str(), expected.c_str());
+        }
+        return actual == expected ? actual : "<mismatch>";
+    }
+
+    /*
+     * A document of members m0 to m<count - 1> holding a mix of strings,
+     * numbers, literals, arrays and objects, with "type" first.
+     */
+    static std::string makeDocument(int count) {
+        std::ostringstream doc;
+        doc << "{\"type\": \"order\"";
+        for (int ii = 0; ii < count; ii++) {
+            doc << ", \"m" << ii << "\": ";
+            switch (ii % 5) {
+            case 0: doc << "\"value " << ii << " with \\\"quotes\\\"\""; break;
+            case 1: doc << ii * 7919; break;
+            case 2: doc << (ii % 2 == 0 ? "true" : "null"); break;
+            case 3: doc << "[1, 2.5, \"three\", {\"four\": 4}]"; break;
+            default: doc << "{\"id\": " << ii << ", \"tags\": [\"a\", \"b\"]}"; break;
+            }
+        }
+        doc << "}";
+        return doc.str();
+    }
+
+    void time(const char *label, const std::string &doc, const std::string &name, int rows) {
+        // not temp strings, which purging the temp string pool would free
+        NValue docValue = ValueFactory::getStringValue(doc);
+        NValue nameValue = ValueFactory::getStringValue(name);
+        JsonField field(name.c_str(), static_cast<int32_t>(name.length()));
+        Pool *pool = ExecutorContext::getTempStringPool();
+
+        int64_t parsedBytes = 0;
+        int64_t start = nowMicros();
+        for (int ii = 0; ii < rows; ii++) {
+            NValue result = fullParseField(docValue, nameValue);
+            parsedBytes += result.isNull() ? 0 : ValuePeeker::peekObjectLength(result);
+            if (ii % 1024 == 0) {
+                pool->purge();
+            }
+        }
+        const int64_t parsed = nowMicros() - start;
+
+        int64_t scannedBytes = 0;
+        start = nowMicros();
+        for (int ii = 0; ii < rows; ii++) {
+            NValue result = docValue.jsonField(field);
+            scannedBytes += result.isNull() ? 0 : ValuePeeker::peekObjectLength(result);
+            if (ii % 1024 == 0) {
+                pool->purge();
+            }
+        }
+        const int64_t scanned = nowMicros() - start;
+        pool->purge();
+        docValue.free();
+        nameValue.free();
+
+        printf("  %-6s %6d byte documents, %-8s parsed %6lld ms, scanned %6lld ms\n",
+               label, (int)doc.length(), name.c_str(),
+               (long long)parsed / 1000, (long long)scanned / 1000);
+        EXPECT_EQ(parsedBytes, scannedBytes);
+    }
+
+    void compare(int rows) {
+        const std::string small = makeDocument(8);
+        const std::string large = makeDocument(400);
+        printf("%d rows\n", rows);
+        time("small", small, "type", rows);
+        time("small", small, "m7", rows);
+        time("small", small, "missing", rows);
+        // large documents take longer to parse, so fewer of them
+        time("large", large, "type", rows / 40);
+        time("large", large, "m399", rows / 40);
+        time("large", large, "missing", rows / 40);
+    }
+
+    VoltDBEngine m_engine;
+};
+
+TEST_F(JsonFieldBenchmark, MatchesFullParse) {
+    // values of every kind
+    EXPECT_EQ("b", fieldOf("{\"a\":\"b\"}", "a"));
+    EXPECT_EQ("", fieldOf("{\"a\":\"\"}", "a"));
+    EXPECT_EQ("12", fieldOf("{\"a\":12}", "a"));
+    EXPECT_EQ("-12", fieldOf("{\"a\": -12 }", "a"));
+    EXPECT_EQ("7", fieldOf("{\"a\":007}", "a"));
+    EXPECT_EQ("0", fieldOf("{\"a\":-0}", "a"));
+    EXPECT_NE("<mismatch>", fieldOf("{\"a\":1.50}", "a"));
+    EXPECT_NE("<mismatch>", fieldOf("{\"a\":1e2}", "a"));
+    EXPECT_NE("<mismatch>", fieldOf("{\"a\":123456789012345678901}", "a"));
+    EXPECT_EQ("true", fieldOf("{\"a\":true}", "a"));
+    EXPECT_EQ("false", fieldOf("{\"a\":false}", "a"));
+    EXPECT_EQ("<null>", fieldOf("{\"a\":null}", "a"));
+    EXPECT_EQ("[1,\"x\"]", fieldOf("{\"a\": [ 1, \"x\" ] }", "a"));
+    EXPECT_EQ("{\"x\":1,\"y\":2}", fieldOf("{\"a\":{\"y\":2, \"x\":1}}", "a"));
+    EXPECT_EQ("q\"u\\o/t\xc3\xa9", fieldOf("{\"a\":\"q\\\"u\\\\o\\/t\\u00e9\"}", "a"));
+    EXPECT_EQ("\xf0\x9f\x98\x80", fieldOf("{\"a\":\"\\ud83d\\ude00\"}", "a"));
+
+    // finding the member
+    EXPECT_EQ("2", fieldOf("{\"a\":{\"b\":1},\"b\":2}", "b"));
+    EXPECT_EQ("3", fieldOf(" \n{ \"x\" : [ {}, [], [[{\"b\":1}]] ] ,\t\"b\" : 3 } ", "b"));
+    EXPECT_EQ("<null>", fieldOf("{\"a\":1}", "b"));
+    EXPECT_EQ("<null>", fieldOf("{}", "b"));
+    EXPECT_EQ("<null>", fieldOf("{\"ab\":1}", "a"));
+    EXPECT_EQ("1", fieldOf("{\"\":1}", ""));
+    EXPECT_EQ("2", fieldOf("{\"a\\u0062\":1, \"b\":2}", "b"));
+    EXPECT_EQ("1", fieldOf("{\"a\\u0062\":1, \"b\":2}", "ab"));
+
+    // documents left to a full parse
+    EXPECT_EQ("<null>", fieldOf("[{\"a\":1}]", "a"));
+    EXPECT_EQ("<null>", fieldOf("\"a\"", "a"));
+    EXPECT_EQ("1", fieldOf("{/* note */ \"a\":1}", "a"));
+    EXPECT_EQ("<null>", fieldOf("{\"\":1,}", "a"));
+    EXPECT_EQ("2", fieldOf("{\"x\":-, \"a\":2}", "a"));
+    EXPECT_EQ("<null>", fieldOf("{\"a\":1} trailing", "b"));
+
+    // malformed documents
+    std::string error = fieldOf("", "a");
+    EXPECT_EQ(0, error.find("<error>"));
+    error = fieldOf("{\"a\":1", "b");
+    EXPECT_EQ(0, error.find("<error>"));
+    error = fieldOf("{\"x\":[1,}, \"a\":1}", "a");
+    EXPECT_EQ(0, error.find("<error>"));
+    error = fieldOf("{\"x\":\"\\q\", \"a\":1}", "a");
+    EXPECT_EQ(0, error.find("<error>"));
+    error = fieldOf("{\"a\":tru}", "a");
+    EXPECT_EQ(0, error.find("<error>"));
+    error = fieldOf("{\"a\":1 \"b\":2}", "a");
+    EXPECT_EQ(0, error.find("<error>"));
+
+    const std::string doc = makeDocument(50);
+    for (int ii = 0; ii < 50; ii++) {
+        std::ostringstream name;
+        name << "m" << ii;
+        EXPECT_NE("<mismatch>", fieldOf(doc, name.str()));
+    }
+}
+
+TEST_F(JsonFieldBenchmark, CompiledByExpression) {
+    const std::string doc = "{\"type\": \"order\", \"id\": 12}";
+    std::vector<AbstractExpression*> *arguments = new std::vector<AbstractExpression*>();
+    arguments->push_back(new ConstantValueExpression(ValueFactory::getStringValue(doc)));
+    arguments->push_back(new ConstantValueExpression(ValueFactory::getStringValue("id")));
+    AbstractExpression *field = ExpressionUtil::functionFactory(FUNC_VOLT_FIELD, arguments);
+    ASSERT_TRUE(field != NULL);
+    EXPECT_EQ("12", outcome(Evaluate(field)));
+    delete field;
+
+    // a null name is null for every document
+    arguments = new std::vector<AbstractExpression*>();
+    arguments->push_back(new ConstantValueExpression(ValueFactory::getStringValue(doc)));
+    arguments->push_back(new ConstantValueExpression(ValueFactory::getNullStringValue()));
+    field = ExpressionUtil::functionFactory(FUNC_VOLT_FIELD, arguments);
+    ASSERT_TRUE(field != NULL);
+    EXPECT_EQ("<null>", outcome(Evaluate(field)));
+    delete field;
+}
+
+TEST_F(JsonFieldBenchmark, Rows100K) {
+    compare(100000);
+}
+
+TEST_F(JsonFieldBenchmark, Rows2M) {
+    if (!s_large) {
+        printf("skipped; run with \"large\" to include it\n");
+        return;
+    }
+    compare(2000000);
+}
+
+int main(int argc, char **argv) {
+    s_large = (argc > 1 && strcmp(argv[1], "large") == 0);
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,328 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Timings of building an index over a table that is already full, the
+ * way adding an index in a catalog update and migrating a table on a
+ * schema change do: one tuple at a time, and all at once with the keys
+ * sorted on several threads. Both ways must build the same index.
+ *
+ * The 200K row runs are part of the test suite; pass "large" on the
+ * command line to add the 4M row runs.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "common/common.h"
+#include "common/NValue.hpp"
+#include "common/ParallelSort.h"
+#include "common/ValueFactory.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "execution/VoltDBEngine.h"
+#include "storage/ConstraintFailureException.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+
+using namespace voltdb;
+
+static bool s_large = false;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int64_t randomValue() {
+    return ((int64_t)rand() << 31) ^ rand();
+}
+
+class IndexBuildBenchmark : public Test {
+public:
+    IndexBuildBenchmark() {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    ~IndexBuildBenchmark() {
+        for (size_t i = 0; i < m_tables.size(); i++) {
+            delete m_tables[i];
+        }
+    }
+
+    /*
+     * A table of (ID, GRP, NAME) rows with ids 0 to rows - 1 in random
+     * order, GRP being ID / 4 and NAME an out of line string made from ID.
+     */
+    PersistentTable *makeTable() {
+        std::vector<ValueType> columnTypes;
+        std::vector<int32_t> columnLengths;
+        columnTypes.push_back(VALUE_TYPE_BIGINT);
+        columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        columnTypes.push_back(VALUE_TYPE_BIGINT);
+        columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        columnTypes.push_back(VALUE_TYPE_VARCHAR);
+        columnLengths.push_back(100);
+        std::vector<bool> columnAllowNull(3, false);
+        TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                                             columnAllowNull, true);
+        std::vector<std::string> columnNames;
+        columnNames.push_back("ID");
+        columnNames.push_back("GRP");
+        columnNames.push_back("NAME");
+        PersistentTable *table = dynamic_cast<PersistentTable*>(
+            TableFactory::getPersistentTable(0, "BUILT", schema, columnNames));
+        m_tables.push_back(table);
+        return table;
+    }
+
+    void fill(PersistentTable *table, int64_t rows) {
+        std::vector<int64_t> ids(rows);
+        for (int64_t i = 0; i < rows; i++) {
+            ids[i] = i;
+        }
+        srand(0);
+        for (int64_t i = rows - 1; i > 0; i--) {
+            std::swap(ids[i], ids[randomValue() % (i + 1)]);
+        }
+        TableTuple &tuple = table->tempTuple();
+        for (int64_t i = 0; i < rows; i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(ids[i]));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(ids[i] / 4));
+            char name[32];
+            snprintf(name, sizeof(name), "name %lld", (long long)(ids[i] * 7919 % rows));
+            NValue value = ValueFactory::getStringValue(name);
+            tuple.setNValue(2, value);
+            table->insertTuple(tuple);
+            value.free();
+        }
+    }
+
+    TableIndexScheme scheme(const char *name, TableIndexType type, int column, bool unique,
+                            const TupleSchema *schema) {
+        std::vector<int> columns(1, column);
+        return TableIndexScheme(name, type, columns, TableIndex::simplyIndexColumns(),
+                                unique, false, schema);
+    }
+
+    // the tuple addresses of the index's entries in index order
+    std::vector<const void*> entries(TableIndex *index) {
+        std::vector<const void*> addresses;
+        IndexCursor indexCursor(index->getTupleSchema());
+        index->moveToEnd(true, indexCursor);
+        TableTuple tuple;
+        while ( ! (tuple = index->nextValue(indexCursor)).isNullTuple()) {
+            addresses.push_back(tuple.address());
+        }
+        return addresses;
+    }
+
+    /*
+     * Build the index one tuple at a time and with Table::addIndex, which
+     * builds it all at once, and check that both hold the same entries (in
+     * the same order, for a tree).
+     */
+    void build(PersistentTable *table, const TableIndexScheme &indexScheme) {
+        TableIndex *reference = TableIndexFactory::getInstance(indexScheme);
+        int64_t start = nowMicros();
+        TableTuple tuple(table->schema());
+        TableIterator iter = table->iterator();
+        while (iter.next(tuple)) {
+            reference->addEntry(&tuple);
+        }
+        printf("  %-10s %-24s %6lld ms\n", indexScheme.name.c_str(), "one at a time",
+               (long long)(nowMicros() - start) / 1000);
+
+        TableIndex *index = TableIndexFactory::getInstance(indexScheme);
+        start = nowMicros();
+        table->addIndex(index);
+        printf("  %-10s %-24s %6lld ms\n", indexScheme.name.c_str(), "all at once",
+               (long long)(nowMicros() - start) / 1000);
+
+        ASSERT_EQ(reference->getSize(), index->getSize());
+        ASSERT_EQ((int64_t)table->activeTupleCount(), index->getSize());
+        if (indexScheme.type == BALANCED_TREE_INDEX) {
+            ASSERT_TRUE(entries(reference) == entries(index));
+        }
+        iter = table->iterator();
+        while (iter.next(tuple)) {
+            ASSERT_TRUE(index->exists(&tuple));
+        }
+        delete reference;
+    }
+
+    void compare(int64_t rows) {
+        PersistentTable *table = makeTable();
+        fill(table, rows);
+        printf("%lld rows, sorts on %d threads\n", (long long)rows, ParallelSort::threadsFor(rows));
+        build(table, scheme("TREE_ID", BALANCED_TREE_INDEX, 0, true, table->schema()));
+        build(table, scheme("TREE_GRP", BALANCED_TREE_INDEX, 1, false, table->schema()));
+        build(table, scheme("TREE_NAME", BALANCED_TREE_INDEX, 2, false, table->schema()));
+        build(table, scheme("HASH_ID", HASH_TABLE_INDEX, 0, true, table->schema()));
+    }
+
+    // the indexes a migrated table has
+    void addIndexes(PersistentTable *table) {
+        const TupleSchema *schema = table->schema();
+        table->addIndex(TableIndexFactory::getInstance(
+                            scheme("TREE_ID", BALANCED_TREE_INDEX, 0, true, schema)));
+        table->addIndex(TableIndexFactory::getInstance(
+                            scheme("TREE_GRP", BALANCED_TREE_INDEX, 1, false, schema)));
+        table->addIndex(TableIndexFactory::getInstance(
+                            scheme("HASH_ID", HASH_TABLE_INDEX, 0, true, schema)));
+    }
+
+    /*
+     * Migrate the tuples of source into a new table with the same indexes
+     * the way a schema change does.
+     */
+    PersistentTable *migrate(PersistentTable *source) {
+        PersistentTable *target = makeTable();
+        addIndexes(target);
+
+        int64_t start = nowMicros();
+        TableTuple tuple(source->schema());
+        TableIterator iter = source->iterator();
+        while (iter.next(tuple)) {
+            target->insertMigratedTuple(tuple);
+        }
+        target->indexMigratedTuples();
+        printf("  migrated %lld rows with %d indexes in %lld ms\n",
+               (long long)target->activeTupleCount(), (int)target->indexCount(),
+               (long long)(nowMicros() - start) / 1000);
+        return target;
+    }
+
+    void compareMigration(int64_t rows) {
+        PersistentTable *source = makeTable();
+        addIndexes(source);
+        fill(source, rows);
+
+        PersistentTable *target = migrate(source);
+        ASSERT_EQ(source->activeTupleCount(), target->activeTupleCount());
+        const std::vector<TableIndex*> &indexes = target->allIndexes();
+        for (size_t i = 0; i < indexes.size(); i++) {
+            ASSERT_EQ((int64_t)rows, indexes[i]->getSize());
+        }
+        TableTuple tuple(target->schema());
+        TableIterator iter = target->iterator();
+        while (iter.next(tuple)) {
+            for (size_t i = 0; i < indexes.size(); i++) {
+                ASSERT_TRUE(indexes[i]->exists(&tuple));
+            }
+        }
+    }
+
+    VoltDBEngine m_engine;
+    std::vector<PersistentTable*> m_tables;
+};
+
+TEST_F(IndexBuildBenchmark, ParallelSort) {
+    for (int threads = 1; threads <= 5; threads++) {
+        for (int size = 0; size < 200; size++) {
+            std::vector<int64_t> values(size);
+            for (int i = 0; i < size; i++) {
+                values[i] = rand() % 50;
+            }
+            std::vector<int64_t> expected(values);
+            std::sort(expected.begin(), expected.end());
+            ParallelSort::sort(values, std::less<int64_t>(), threads);
+            ASSERT_TRUE(values == expected);
+        }
+    }
+
+    std::vector<int64_t> values(s_large ? 40000000 : 2000000);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = randomValue();
+    }
+    std::vector<int64_t> expected(values);
+    int64_t start = nowMicros();
+    std::sort(expected.begin(), expected.end());
+    printf("  %lld values, std::sort %lld ms", (long long)values.size(),
+           (long long)(nowMicros() - start) / 1000);
+    // as many threads as a sort may use, even on a machine with fewer cores
+    const int threads = ParallelSort::MAX_THREADS;
+    start = nowMicros();
+    ParallelSort::sort(values, std::less<int64_t>(), threads);
+    printf(", on %d threads %lld ms\n", threads, (long long)(nowMicros() - start) / 1000);
+    ASSERT_TRUE(values == expected);
+}
+
+TEST_F(IndexBuildBenchmark, Rows200K) {
+    compare(200000);
+}
+
+TEST_F(IndexBuildBenchmark, Migrate200K) {
+    compareMigration(200000);
+}
+
+TEST_F(IndexBuildBenchmark, MigrateDuplicateKey) {
+    PersistentTable *source = makeTable();
+    fill(source, 1000);
+    TableTuple &tuple = source->tempTuple();
+    tuple.setNValue(0, ValueFactory::getBigIntValue(500));
+    tuple.setNValue(1, ValueFactory::getBigIntValue(0));
+    NValue value = ValueFactory::getStringValue("duplicate");
+    tuple.setNValue(2, value);
+    source->insertTuple(tuple);
+    value.free();
+
+    PersistentTable *target = makeTable();
+    target->addIndex(TableIndexFactory::getInstance(
+                         scheme("TREE_ID", BALANCED_TREE_INDEX, 0, true, target->schema())));
+    TableTuple scanned(source->schema());
+    TableIterator iter = source->iterator();
+    while (iter.next(scanned)) {
+        target->insertMigratedTuple(scanned);
+    }
+    bool failed = false;
+    try {
+        target->indexMigratedTuples();
+    } catch (ConstraintFailureException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+}
+
+TEST_F(IndexBuildBenchmark, Rows4M) {
+    if (!s_large) {
+        printf("skipped; run with \"large\" to include it\n");
+        return;
+    }
+    compare(4000000);
+    compareMigration(4000000);
+}
+
+int main(int argc, char **argv) {
+    s_large = (argc > 1 && strcmp(argv[1], "large") == 0);
+    return TestSuite::globalInstance()->runAll();
+}
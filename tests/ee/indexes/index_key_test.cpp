@@ -399,6 +399,61 @@ TEST_F(IndexKeyTest, SingleVarChar30) {
     voltdb::TupleSchema::freeTupleSchema(keySchema);
 }
 
+TEST_F(IndexKeyTest, ShortAndLongVarCharKeys) {
+    // A table tuple holding a short string in its slot and a long one out of line.
+    std::vector<voltdb::ValueType> columnTypes(2, voltdb::VALUE_TYPE_VARCHAR);
+    std::vector<int32_t> columnLengths(2, 100);
+    std::vector<bool> columnAllowNull(2, true);
+    voltdb::TupleSchema *tupleSchema =
+        voltdb::TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    voltdb::TableTuple tuple(tupleSchema);
+    tuple.move(new char[tuple.tupleLength()]);
+    voltdb::NValue shortValue = ValueFactory::getStringValue("abc");
+    voltdb::NValue longValue = ValueFactory::getStringValue("abcdefghij");
+    tuple.setNValueAllocateForObjectCopies(0, shortValue, NULL);
+    tuple.setNValueAllocateForObjectCopies(1, longValue, NULL);
+
+    std::vector<voltdb::ValueType> keyTypes(1, voltdb::VALUE_TYPE_VARCHAR);
+    std::vector<int32_t> keyLengths(1, 100);
+    std::vector<bool> keyAllowNull(1, true);
+    voltdb::TupleSchema *keySchema =
+        voltdb::TupleSchema::createTupleSchema(keyTypes, keyLengths, keyAllowNull, true);
+    voltdb::GenericKey<16>::KeyComparator comparator(keySchema);
+    voltdb::GenericKey<16>::KeyHasher hasher(keySchema);
+    voltdb::GenericKey<16>::KeyEqualityChecker equality(keySchema);
+    std::vector<voltdb::AbstractExpression*> noExpressions;
+
+    // Keys made from the tuple's columns, as an index maintains them ...
+    std::vector<int> shortColumn(1, 0);
+    std::vector<int> longColumn(1, 1);
+    voltdb::GenericKey<16> shortKey(&tuple, shortColumn, noExpressions, keySchema);
+    voltdb::GenericKey<16> longKey(&tuple, longColumn, noExpressions, keySchema);
+
+    // ... match search keys holding the same values out of line.
+    voltdb::TableTuple searchTuple(keySchema);
+    searchTuple.move(new char[searchTuple.tupleLength()]);
+    searchTuple.setNValue(0, shortValue);
+    voltdb::GenericKey<16> shortSearchKey(&searchTuple);
+    searchTuple.setNValue(0, longValue);
+    voltdb::GenericKey<16> longSearchKey(&searchTuple);
+
+    EXPECT_TRUE(equality(shortKey, shortSearchKey));
+    EXPECT_EQ(hasher(shortKey), hasher(shortSearchKey));
+    EXPECT_EQ(0, comparator(shortKey, shortSearchKey));
+    EXPECT_TRUE(equality(longKey, longSearchKey));
+    EXPECT_FALSE(equality(shortKey, longSearchKey));
+    EXPECT_TRUE(comparator(shortKey, longSearchKey) < 0);
+    EXPECT_TRUE(comparator(longSearchKey, shortKey) > 0);
+
+    delete [] searchTuple.address();
+    tuple.freeObjectColumns();
+    delete [] tuple.address();
+    shortValue.free();
+    longValue.free();
+    voltdb::TupleSchema::freeTupleSchema(keySchema);
+    voltdb::TupleSchema::freeTupleSchema(tupleSchema);
+}
+
 TEST_F(IndexKeyTest, Int64Packing2Int32sWithSecondNull) {
     std::vector<voltdb::ValueType> columnTypes;
     std::vector<int32_t> columnLengths;
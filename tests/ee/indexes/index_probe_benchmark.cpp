@@ -0,0 +1,211 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Timings of runs of equality probes against the indexes of a persistent
+ * table, made the way the nested loop index join makes them: one key at a
+ * time in outer order, and a batch at a time with the keys sorted when
+ * the index prefers it and each probe prefetching a few keys ahead. Every
+ * way of probing must find the same tuples.
+ *
+ * The 200K row run is part of the test suite; pass "large" on the command
+ * line to add the 4M row run.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "common/common.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "execution/VoltDBEngine.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
+
+using namespace voltdb;
+
+static const int BATCH_SIZE = 1024;
+static const int PREFETCH_DISTANCE = 8;
+static bool s_large = false;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+class IndexProbeBenchmark : public Test {
+public:
+    IndexProbeBenchmark() : m_table(NULL) {
+        m_engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+    }
+
+    ~IndexProbeBenchmark() {
+        delete m_table;
+    }
+
+    /*
+     * A table of (ID, GRP) rows with ids 0 to rows - 1 inserted in random
+     * order, GRP being ID / 4, and unique tree and hash indexes on ID and a
+     * non-unique tree index on GRP.
+     */
+    void makeTable(int64_t rows) {
+        std::vector<ValueType> columnTypes(2, VALUE_TYPE_BIGINT);
+        std::vector<int32_t> columnLengths(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        std::vector<bool> columnAllowNull(2, false);
+        TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths,
+                                                             columnAllowNull, true);
+        std::vector<std::string> columnNames;
+        columnNames.push_back("ID");
+        columnNames.push_back("GRP");
+        m_table = dynamic_cast<PersistentTable*>(
+            TableFactory::getPersistentTable(0, "PROBED", schema, columnNames));
+
+        addIndex("TREE_ID", BALANCED_TREE_INDEX, 0, true);
+        addIndex("HASH_ID", HASH_TABLE_INDEX, 0, true);
+        addIndex("TREE_GRP", BALANCED_TREE_INDEX, 1, false);
+
+        std::vector<int64_t> ids(rows);
+        for (int64_t i = 0; i < rows; i++) {
+            ids[i] = i;
+        }
+        shuffle(ids);
+        TableTuple &tuple = m_table->tempTuple();
+        for (int64_t i = 0; i < rows; i++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(ids[i]));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(ids[i] / 4));
+            m_table->insertTuple(tuple);
+        }
+    }
+
+    void addIndex(const char *name, TableIndexType type, int column, bool unique) {
+        std::vector<int> columns(1, column);
+        TableIndexScheme scheme(name, type, columns, TableIndex::simplyIndexColumns(),
+                                unique, false, m_table->schema());
+        m_table->addIndex(TableIndexFactory::getInstance(scheme));
+    }
+
+    void shuffle(std::vector<int64_t> &values) {
+        srand(0);
+        for (int64_t i = (int64_t)values.size() - 1; i > 0; i--) {
+            std::swap(values[i], values[(((int64_t)rand() << 16) ^ rand()) % (i + 1)]);
+        }
+    }
+
+    /*
+     * Probe index for every key, in batches. With ordered, each batch is
+     * probed in key order; with prefetch, each probe prefetches the key
+     * PREFETCH_DISTANCE probes ahead. Returns the sum of the ids found.
+     */
+    int64_t probe(const char *name, TableIndex *index, const std::vector<int64_t> &searchValues,
+                  bool ordered, bool prefetch) {
+        const TupleSchema *keySchema = index->getKeySchema();
+        IndexCursor indexCursor(index->getTupleSchema());
+        TableTuple key(keySchema);
+        const int keyLength = key.tupleLength();
+        std::vector<char> keys(BATCH_SIZE * keyLength);
+        std::vector<std::pair<int64_t, int> > order;
+
+        int64_t sum = 0;
+        int64_t start = nowMicros();
+        for (size_t base = 0; base < searchValues.size(); base += BATCH_SIZE) {
+            const int count = (int)std::min(searchValues.size() - base, (size_t)BATCH_SIZE);
+            order.clear();
+            for (int i = 0; i < count; i++) {
+                key.move(&keys[i * keyLength]);
+                key.setNValue(0, ValueFactory::getBigIntValue(searchValues[base + i]));
+                order.push_back(std::make_pair(searchValues[base + i], i));
+            }
+            if (ordered) {
+                std::sort(order.begin(), order.end());
+            }
+            for (int i = 0; i < count; i++) {
+                if (prefetch && i + PREFETCH_DISTANCE < count) {
+                    key.move(&keys[order[i + PREFETCH_DISTANCE].second * keyLength]);
+                    index->prefetchKey(&key);
+                }
+                key.move(&keys[order[i].second * keyLength]);
+                index->moveToKey(&key, indexCursor);
+                TableTuple match(m_table->schema());
+                while ( ! (match = index->nextValueAtKey(indexCursor)).isNullTuple()) {
+                    sum += ValuePeeker::peekAsBigInt(match.getNValue(0));
+                }
+            }
+        }
+        printf("  %-10s %-28s %6lld ms\n", index->getName().c_str(), name,
+               (long long)(nowMicros() - start) / 1000);
+        return sum;
+    }
+
+    void compare(int64_t rows) {
+        makeTable(rows);
+        // one probe per row, one in eight of them for a missing key
+        std::vector<int64_t> searchValues(rows);
+        for (int64_t i = 0; i < rows; i++) {
+            searchValues[i] = (i % 8 == 0) ? rows + i : i;
+        }
+        shuffle(searchValues);
+        printf("%lld rows, %lld probes\n", (long long)rows, (long long)searchValues.size());
+
+        const char *names[] = { "TREE_ID", "HASH_ID", "TREE_GRP" };
+        for (int i = 0; i < 3; i++) {
+            TableIndex *index = m_table->index(names[i]);
+            ASSERT_TRUE(index != NULL);
+            int64_t expected = probe("one at a time", index, searchValues, false, false);
+            ASSERT_EQ(expected, probe("batched, key order", index, searchValues, true, false));
+            ASSERT_EQ(expected, probe("batched, prefetched", index, searchValues, false, true));
+            ASSERT_EQ(expected, probe("batched, key order, prefetched", index, searchValues,
+                                      true, true));
+        }
+    }
+
+    VoltDBEngine m_engine;
+    PersistentTable *m_table;
+};
+
+TEST_F(IndexProbeBenchmark, Rows200K) {
+    compare(200000);
+}
+
+TEST_F(IndexProbeBenchmark, Rows4M) {
+    if (!s_large) {
+        printf("skipped; run with \"large\" to include it\n");
+        return;
+    }
+    compare(4000000);
+}
+
+int main(int argc, char **argv) {
+    s_large = (argc > 1 && strcmp(argv[1], "large") == 0);
+    return TestSuite::globalInstance()->runAll();
+}
@@ -111,12 +111,13 @@ bool commandLS(voltdb::TableTuple &key)
 {
     //cout << "running ls" << endl;
     //cout << " candidate key : " << key.tupleLength() << " - " << key.debug("") << endl;
-    bool result = currentIndex->moveToKey(&key);
+    voltdb::IndexCursor indexCursor(currentIndex->getTupleSchema());
+    bool result = currentIndex->moveToKey(&key, indexCursor);
     if (!result) {
         cout << "ls FAIL(moveToKey()) key length: " << key.tupleLength() << endl << key.debug("") << endl;
         return false;
     }
-    voltdb::TableTuple value = currentIndex->nextValueAtKey();
+    voltdb::TableTuple value = currentIndex->nextValueAtKey(indexCursor);
     if (value.isNullTuple()) {
         cout << "ls FAIL(isNullTuple()) key length: " << key.tupleLength() << endl << key.debug("") << endl;
         return false;
@@ -136,7 +137,8 @@ bool commandLF(voltdb::TableTuple &key)
 
     // Don't just call !commandLS(key) here. That does an equality check.
     // Here, the valid test is for existence, not equality.
-    return !(currentIndex->moveToKey(&key));
+    voltdb::IndexCursor indexCursor(currentIndex->getTupleSchema());
+    return !(currentIndex->moveToKey(&key, indexCursor));
 }
 
 bool commandDS(voltdb::TableTuple &key)
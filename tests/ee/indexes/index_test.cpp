@@ -443,6 +443,7 @@ TEST_F(IndexTest, IntsUnique) {
 
     TableIndex* index = table->index("ixu");
     EXPECT_EQ(true, index != NULL);
+    IndexCursor indexCursor(index->getTupleSchema());
 
     //EXPECT_EQ( 62520, index->getMemoryEstimate());
 
@@ -460,9 +461,9 @@ TEST_F(IndexTest, IntsUnique) {
     searchkey.move(new char[searchkey.tupleLength()]);
     searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(550)));
     searchkey.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(2)));
-    EXPECT_TRUE(index->moveToKey(&searchkey));
+    EXPECT_TRUE(index->moveToKey(&searchkey, indexCursor));
 
-    tuple = index->nextValueAtKey();
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_FALSE(tuple.isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50).op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 % 2).op_equals(tuple.getNValue(1)).isTrue());
@@ -470,13 +471,13 @@ TEST_F(IndexTest, IntsUnique) {
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 + 20).op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 * 11).op_equals(tuple.getNValue(4)).isTrue());
 
-    tuple = index->nextValueAtKey();
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(550)));
     searchkey.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
-    EXPECT_FALSE(index->moveToKey(&searchkey));
-    tuple = index->nextValueAtKey();
+    EXPECT_FALSE(index->moveToKey(&searchkey, indexCursor));
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     // partial index search test
@@ -484,8 +485,8 @@ TEST_F(IndexTest, IntsUnique) {
         setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(440)));
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(-10000000)));
-    index->moveToKeyOrGreater(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToKeyOrGreater(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40 % 2).
@@ -496,7 +497,7 @@ TEST_F(IndexTest, IntsUnique) {
                 op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40 * 11).
                 op_equals(tuple.getNValue(4)).isTrue());
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 % 2).
@@ -512,8 +513,8 @@ TEST_F(IndexTest, IntsUnique) {
         setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(440)));
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(10000000)));
-    index->moveToKeyOrGreater(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToKeyOrGreater(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 % 2).
@@ -524,7 +525,7 @@ TEST_F(IndexTest, IntsUnique) {
                 op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 * 11).
                 op_equals(tuple.getNValue(4)).isTrue());
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(42).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(42 % 2).
@@ -541,8 +542,8 @@ TEST_F(IndexTest, IntsUnique) {
         setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(330)));
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(30%3)));
-    index->moveToGreaterThanKey(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToGreaterThanKey(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(31).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(31 % 2).
@@ -605,6 +606,7 @@ TEST_F(IndexTest, IntsMulti) {
 
     TableIndex* index = table->index("ixm2");
     EXPECT_EQ(true, index != NULL);
+    IndexCursor indexCursor(index->getTupleSchema());
 
     //EXPECT_EQ( 52000, index->getMemoryEstimate());
 
@@ -622,9 +624,9 @@ TEST_F(IndexTest, IntsMulti) {
     searchkey.move(new char[searchkey.tupleLength()]);
     searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(550)));
     searchkey.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(2)));
-    EXPECT_TRUE(index->moveToKey(&searchkey));
+    EXPECT_TRUE(index->moveToKey(&searchkey, indexCursor));
 
-    tuple = index->nextValueAtKey();
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_FALSE(tuple.isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50).op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 % 2).op_equals(tuple.getNValue(1)).isTrue());
@@ -632,13 +634,13 @@ TEST_F(IndexTest, IntsMulti) {
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 + 20).op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(50 * 11).op_equals(tuple.getNValue(4)).isTrue());
 
-    tuple = index->nextValueAtKey();
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(550)));
     searchkey.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
-    EXPECT_FALSE(index->moveToKey(&searchkey));
-    tuple = index->nextValueAtKey();
+    EXPECT_FALSE(index->moveToKey(&searchkey, indexCursor));
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     // partial index search test
@@ -647,8 +649,8 @@ TEST_F(IndexTest, IntsMulti) {
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(-10000000)));
 
-    index->moveToKeyOrGreater(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToKeyOrGreater(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40 % 2).
@@ -659,7 +661,7 @@ TEST_F(IndexTest, IntsMulti) {
                 op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(40 * 11).
                 op_equals(tuple.getNValue(4)).isTrue());
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 % 2).
@@ -675,8 +677,8 @@ TEST_F(IndexTest, IntsMulti) {
         setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(440)));
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(10000000)));
-    index->moveToKeyOrGreater(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToKeyOrGreater(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 % 2).
@@ -687,7 +689,7 @@ TEST_F(IndexTest, IntsMulti) {
                 op_equals(tuple.getNValue(3)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(41 * 11).
                 op_equals(tuple.getNValue(4)).isTrue());
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(42).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(42 % 2).
@@ -705,8 +707,8 @@ TEST_F(IndexTest, IntsMulti) {
     searchkey.
         setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(30%3)));
 
-    index->moveToGreaterThanKey(&searchkey);
-    EXPECT_FALSE((tuple = index->nextValue()).isNullTuple());
+    index->moveToGreaterThanKey(&searchkey, indexCursor);
+    EXPECT_FALSE((tuple = index->nextValue(indexCursor)).isNullTuple());
     EXPECT_TRUE(ValueFactory::getBigIntValue(31).
                 op_equals(tuple.getNValue(0)).isTrue());
     EXPECT_TRUE(ValueFactory::getBigIntValue(31 % 2).
@@ -761,6 +763,7 @@ TEST_F(IndexTest, TupleKeyUnique) {
     initWideTable("ixu_wide");
     TableIndex* index = table->index("ixu_wide");
     EXPECT_EQ(true, index != NULL);
+    IndexCursor indexCursor(index->getTupleSchema());
 
     //EXPECT_EQ( 280, index->getMemoryEstimate());
 
@@ -782,24 +785,24 @@ TEST_F(IndexTest, TupleKeyUnique) {
     // TEST moveToKey and nextValueAtKey
     int64_t row = 2;
     setWideIndexToRow(searchkey, row);
-    EXPECT_TRUE(index->moveToKey(&searchkey));
-    tuple = index->nextValueAtKey();
+    EXPECT_TRUE(index->moveToKey(&searchkey, indexCursor));
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_FALSE(tuple.isNullTuple());
     verifyWideRow(tuple, row);
-    tuple = index->nextValueAtKey();
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     // TEST remove tuple
     // remove the tuple found above from the table (which updates the index)
     setWideIndexToRow(searchkey, 2);  // DELETE row 2.
-    EXPECT_TRUE(index->moveToKey(&searchkey));
-    tuple = index->nextValueAtKey();
+    EXPECT_TRUE(index->moveToKey(&searchkey, indexCursor));
+    tuple = index->nextValueAtKey(indexCursor);
     bool deleted = table->deleteTuple(tuple, true);
     EXPECT_TRUE(deleted);
 
     // and now that tuple is gone
-    EXPECT_FALSE(index->moveToKey(&searchkey));
-    tuple = index->nextValueAtKey();
+    EXPECT_FALSE(index->moveToKey(&searchkey, indexCursor));
+    tuple = index->nextValueAtKey(indexCursor);
     EXPECT_TRUE(tuple.isNullTuple());
 
     tuple.move(tuplestorage);
@@ -818,6 +821,184 @@ TEST_F(IndexTest, TupleKeyUnique) {
     delete[] searchkey.address();
 }
 
+/*
+ * Scans of the same index through different cursors must not disturb each
+ * other, however their calls are interleaved.
+ */
+TEST_F(IndexTest, IndependentCursors) {
+    vector<int> ixm_column_indices;
+    vector<ValueType> ixm_column_types;
+    ixm_column_indices.push_back(1);
+    ixm_column_types.push_back(VALUE_TYPE_BIGINT);
+    init("ixm_parity",
+         BALANCED_TREE_INDEX,
+         ixm_column_indices,
+         ixm_column_types,
+         false);
+
+    TableIndex* index = table->index("ixm_parity");
+    EXPECT_EQ(true, index != NULL);
+    IndexCursor evenCursor(index->getTupleSchema());
+    IndexCursor oddCursor(index->getTupleSchema());
+    IndexCursor scanCursor(index->getTupleSchema());
+
+    TupleSchema* keySchema = TupleSchema::createTupleSchema(vector<ValueType>(1, VALUE_TYPE_BIGINT),
+        vector<int32_t>(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)), vector<bool>(1, true), true);
+    TableTuple evenKey(keySchema);
+    evenKey.move(new char[evenKey.tupleLength()]);
+    evenKey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(0)));
+    TableTuple oddKey(keySchema);
+    oddKey.move(new char[oddKey.tupleLength()]);
+    oddKey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
+
+    EXPECT_TRUE(index->moveToKey(&evenKey, evenCursor));
+    EXPECT_TRUE(index->moveToKey(&oddKey, oddCursor));
+    index->moveToEnd(true, scanCursor);
+
+    int evens = 0, odds = 0, scanned = 0;
+    bool evenDone = false, oddDone = false, scanDone = false;
+    TableTuple tuple(table->schema());
+    while (!evenDone || !oddDone || !scanDone) {
+        if (!evenDone) {
+            evenDone = (tuple = index->nextValueAtKey(evenCursor)).isNullTuple();
+            if (!evenDone) {
+                EXPECT_TRUE(ValueFactory::getBigIntValue(0).op_equals(tuple.getNValue(1)).isTrue());
+                ++evens;
+            }
+        }
+        // the odd cursor takes two steps for every step of the others
+        for (int i = 0; i < 2 && !oddDone; i++) {
+            oddDone = (tuple = index->nextValueAtKey(oddCursor)).isNullTuple();
+            if (!oddDone) {
+                EXPECT_TRUE(ValueFactory::getBigIntValue(1).op_equals(tuple.getNValue(1)).isTrue());
+                ++odds;
+            }
+        }
+        if (!scanDone) {
+            scanDone = (tuple = index->nextValue(scanCursor)).isNullTuple();
+            if (!scanDone) {
+                ++scanned;
+            }
+        }
+    }
+    EXPECT_EQ(NUM_OF_TUPLES / 2, evens);
+    EXPECT_EQ(NUM_OF_TUPLES / 2, odds);
+    EXPECT_EQ(NUM_OF_TUPLES, scanned);
+
+    // copies of a cursor carry on from where it was, each on its own
+    EXPECT_TRUE(index->moveToKey(&evenKey, evenCursor));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_FALSE(index->nextValueAtKey(evenCursor).isNullTuple());
+    }
+    IndexCursor copiedCursor(evenCursor);
+    scanCursor = evenCursor;
+    IndexCursor *cursors[3] = { &evenCursor, &copiedCursor, &scanCursor };
+    for (int i = 0; i < 3; i++) {
+        evens = 0;
+        while (!(tuple = index->nextValueAtKey(*cursors[i])).isNullTuple()) {
+            EXPECT_TRUE(ValueFactory::getBigIntValue(0).op_equals(tuple.getNValue(1)).isTrue());
+            ++evens;
+        }
+        EXPECT_EQ(NUM_OF_TUPLES / 2 - 10, evens);
+    }
+
+    // a cursor positioned before a change to the index still probes correctly
+    EXPECT_TRUE(index->moveToKey(&evenKey, evenCursor));
+    TableTuple &newTuple = table->tempTuple();
+    newTuple.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(NUM_OF_TUPLES + 1)));
+    newTuple.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(2)));
+    newTuple.setNValue(2, ValueFactory::getBigIntValue(static_cast<int64_t>(0)));
+    newTuple.setNValue(3, ValueFactory::getBigIntValue(static_cast<int64_t>(0)));
+    newTuple.setNValue(4, ValueFactory::getBigIntValue(static_cast<int64_t>(0)));
+    EXPECT_EQ(true, table->insertTuple(newTuple));
+    EXPECT_TRUE(index->moveToKey(&oddKey, evenCursor));
+    odds = 0;
+    while (!(tuple = index->nextValueAtKey(evenCursor)).isNullTuple()) {
+        EXPECT_TRUE(ValueFactory::getBigIntValue(1).op_equals(tuple.getNValue(1)).isTrue());
+        ++odds;
+    }
+    EXPECT_EQ(NUM_OF_TUPLES / 2, odds);
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] evenKey.address();
+    delete[] oddKey.address();
+}
+
+/*
+ * A B+tree index starts each probe from where the cursor's last one
+ * landed. Inserts that split leaves and deletes that empty them must not
+ * leave a cursor probing from a stale position.
+ */
+TEST_F(IndexTest, BTreeProbeHintsAcrossChanges) {
+    vector<int> ixm_column_indices;
+    vector<ValueType> ixm_column_types;
+    ixm_column_indices.push_back(2);
+    ixm_column_types.push_back(VALUE_TYPE_BIGINT);
+    init("ixm_mod3",
+         BTREE_INDEX,
+         ixm_column_indices,
+         ixm_column_types,
+         false);
+
+    TableIndex* index = table->index("ixm_mod3");
+    EXPECT_EQ(true, index != NULL);
+    IndexCursor cursor(index->getTupleSchema());
+
+    TupleSchema* keySchema = TupleSchema::createTupleSchema(vector<ValueType>(1, VALUE_TYPE_BIGINT),
+        vector<int32_t>(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)), vector<bool>(1, true), true);
+    TableTuple searchKey(keySchema);
+    searchKey.move(new char[searchKey.tupleLength()]);
+    TableTuple tuple(table->schema());
+    // tuples with column02 = 0, 1 and 2 from init, then from the changes below
+    int64_t expected[3] = { NUM_OF_TUPLES / 3, NUM_OF_TUPLES / 3 + 1, NUM_OF_TUPLES / 3 };
+
+    for (int round = 0; round < 3; round++) {
+        if (round == 1) {
+            // split the leaves of key 1, between probes of keys 1 and 2
+            for (int64_t i = NUM_OF_TUPLES + 1; i <= NUM_OF_TUPLES + 500; ++i) {
+                TableTuple &newTuple = table->tempTuple();
+                newTuple.setNValue(0, ValueFactory::getBigIntValue(i));
+                newTuple.setNValue(1, ValueFactory::getBigIntValue(i % 2));
+                newTuple.setNValue(2, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
+                newTuple.setNValue(3, ValueFactory::getBigIntValue(i + 20));
+                newTuple.setNValue(4, ValueFactory::getBigIntValue(i * 11));
+                EXPECT_EQ(true, table->insertTuple(newTuple));
+            }
+            expected[1] += 500;
+        }
+        else if (round == 2) {
+            // empty the leaves of key 0
+            searchKey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(0)));
+            vector<void*> doomed;
+            index->moveToKey(&searchKey, cursor);
+            while (!(tuple = index->nextValueAtKey(cursor)).isNullTuple()) {
+                doomed.push_back(tuple.address());
+            }
+            // ...leaving the cursor's last probe on key 2
+            searchKey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(2)));
+            EXPECT_TRUE(index->moveToKey(&searchKey, cursor));
+            for (int i = 0; i < doomed.size(); i++) {
+                tuple.move(doomed[i]);
+                EXPECT_TRUE(table->deleteTuple(tuple, true));
+            }
+            expected[0] = 0;
+        }
+        for (int64_t key = 0; key < 3; key++) {
+            searchKey.setNValue(0, ValueFactory::getBigIntValue(key));
+            EXPECT_EQ(expected[key] > 0, index->moveToKey(&searchKey, cursor));
+            int64_t found = 0;
+            while (!(tuple = index->nextValueAtKey(cursor)).isNullTuple()) {
+                EXPECT_TRUE(ValueFactory::getBigIntValue(key).op_equals(tuple.getNValue(2)).isTrue());
+                ++found;
+            }
+            EXPECT_EQ(expected[key], found);
+        }
+    }
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] searchKey.address();
+}
+
 int main()
 {
     return TestSuite::globalInstance()->runAll();
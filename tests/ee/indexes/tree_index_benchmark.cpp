@@ -0,0 +1,186 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Side by side timings of the red-black CompactingMap and the B+tree
+ * CompactingBTree over the key types the tree indexes actually use.
+ * Both containers get the same keys in the same order and must agree
+ * on every lookup and scan.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "indexes/indexkey.h"
+#include "structures/CompactingMap.h"
+#include "structures/CompactingBTree.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "common/ThreadLocalPool.h"
+
+using namespace voltdb;
+
+static const int ENTRIES = 200000;
+static const int SCAN_LENGTH = 100;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+class TreeIndexBenchmark : public Test {
+public:
+    TreeIndexBenchmark() : m_keySchema(NULL) {}
+
+    ~TreeIndexBenchmark() {
+        if (m_keySchema) {
+            TupleSchema::freeTupleSchema(m_keySchema);
+        }
+    }
+
+    /*
+     * Build ENTRIES distinct keys of the given number of BIGINT columns,
+     * in random order.
+     */
+    template<typename KeyType>
+    void makeKeys(int columns, std::vector<KeyType> &keys) {
+        std::vector<ValueType> columnTypes(columns, VALUE_TYPE_BIGINT);
+        std::vector<int32_t> columnLengths(columns, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        std::vector<bool> columnAllowNull(columns, false);
+        m_keySchema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+
+        TableTuple keyTuple(m_keySchema);
+        char *storage = new char[keyTuple.tupleLength()];
+        keyTuple.move(storage);
+
+        std::vector<int64_t> order;
+        for (int i = 0; i < ENTRIES; i++) {
+            order.push_back(i);
+        }
+        srand(0);
+        for (int i = ENTRIES - 1; i > 0; i--) {
+            std::swap(order[i], order[rand() % (i + 1)]);
+        }
+        for (int i = 0; i < ENTRIES; i++) {
+            // leading columns are low cardinality, the last one makes the key unique
+            for (int col = 0; col < columns - 1; col++) {
+                keyTuple.setNValue(col, ValueFactory::getBigIntValue(order[i] % (col + 3)));
+            }
+            keyTuple.setNValue(columns - 1, ValueFactory::getBigIntValue(order[i]));
+            keys.push_back(KeyType(&keyTuple));
+        }
+        delete [] storage;
+    }
+
+    /*
+     * Time inserts, point lookups and short forward scans on one container.
+     * Returns a checksum of the values seen so the two containers can be
+     * compared.
+     */
+    template<typename MapType, typename KeyType>
+    int64_t run(const char *name, MapType &map, const std::vector<KeyType> &keys) {
+        int64_t start = nowMicros();
+        for (int i = 0; i < ENTRIES; i++) {
+            map.insert(keys[i], (const void *)(intptr_t)(i + 1));
+        }
+        int64_t inserted = nowMicros();
+
+        int64_t checksum = 0;
+        for (int i = 0; i < ENTRIES; i++) {
+            typename MapType::iterator iter = map.find(keys[(i * 7) % ENTRIES]);
+            checksum += (intptr_t)iter.value();
+        }
+        int64_t found = nowMicros();
+
+        for (int i = 0; i < ENTRIES; i += SCAN_LENGTH) {
+            typename MapType::iterator iter = map.lowerBound(keys[i]);
+            for (int j = 0; j < SCAN_LENGTH && !iter.isEnd(); j++, iter.moveNext()) {
+                checksum += (intptr_t)iter.value();
+            }
+        }
+        int64_t scanned = nowMicros();
+
+        printf("  %-16s insert %6lld ms  lookup %6lld ms  scan %6lld ms  %10lld bytes\n",
+               name,
+               (long long)(inserted - start) / 1000,
+               (long long)(found - inserted) / 1000,
+               (long long)(scanned - found) / 1000,
+               (long long)map.bytesAllocated());
+        return checksum;
+    }
+
+    template<typename KeyType>
+    void compare(const char *keyName, int columns) {
+        typedef typename KeyType::KeyComparator KeyComparator;
+        std::vector<KeyType> keys;
+        makeKeys(columns, keys);
+        printf("%s, %d entries\n", keyName, ENTRIES);
+
+        int64_t rbChecksum, btChecksum;
+        {
+            CompactingMap<KeyType, const void*, KeyComparator> rb(true, KeyComparator(m_keySchema));
+            rbChecksum = run("CompactingMap", rb, keys);
+        }
+        {
+            CompactingBTree<KeyType, const void*, KeyComparator> bt(true, KeyComparator(m_keySchema));
+            btChecksum = run("CompactingBTree", bt, keys);
+            ASSERT_TRUE(bt.verify());
+        }
+        ASSERT_EQ(rbChecksum, btChecksum);
+
+        TupleSchema::freeTupleSchema(m_keySchema);
+        m_keySchema = NULL;
+    }
+
+    ThreadLocalPool m_pool;
+    TupleSchema *m_keySchema;
+};
+
+TEST_F(TreeIndexBenchmark, IntsKey1) {
+    compare<IntsKey<1> >("IntsKey<1>", 1);
+}
+
+TEST_F(TreeIndexBenchmark, IntsKey2) {
+    compare<IntsKey<2> >("IntsKey<2>", 2);
+}
+
+TEST_F(TreeIndexBenchmark, IntsKey3) {
+    compare<IntsKey<3> >("IntsKey<3>", 3);
+}
+
+TEST_F(TreeIndexBenchmark, IntsKey4) {
+    compare<IntsKey<4> >("IntsKey<4>", 4);
+}
+
+TEST_F(TreeIndexBenchmark, GenericKey) {
+    compare<GenericKey<32> >("GenericKey<32>", 4);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -39,6 +39,7 @@
 #include "common/DefaultTupleSerializer.h"
 #include "stx/btree_set.h"
 
+#include <map>
 #include <vector>
 #include <string>
 #include <stdint.h>
@@ -257,6 +258,32 @@ public:
         }
     }
 
+    /**
+     * Check that the table holds exactly the expected keys and values, and
+     * that every index finds each tuple where the table holds it.
+     */
+    void checkTableContents(const std::map<int32_t, int32_t> &expected) {
+        ASSERT_EQ(expected.size(), m_table->activeTupleCount());
+        TableTuple key(m_table->primaryKeyIndex()->getKeySchema());
+        boost::scoped_array<char> backingStore(new char[key.getSchema()->tupleLength()]);
+        key.moveNoHeader(backingStore.get());
+        std::map<int32_t, int32_t> found;
+        TableIterator& iter = m_table->iterator();
+        TableTuple tuple(m_table->schema());
+        while (iter.next(tuple)) {
+            int32_t pkey = ValuePeeker::peekAsInteger(tuple.getNValue(0));
+            found[pkey] = ValuePeeker::peekAsInteger(tuple.getNValue(1));
+            key.setNValue(0, ValueFactory::getIntegerValue(pkey));
+            BOOST_FOREACH(TableIndex *index, m_table->allIndexes()) {
+                IndexCursor indexCursor(index->getTupleSchema());
+                ASSERT_TRUE(index->moveToKey(&key, indexCursor));
+                TableTuple indexTuple = index->nextValueAtKey(indexCursor);
+                ASSERT_EQ(indexTuple.address(), tuple.address());
+            }
+        }
+        ASSERT_TRUE(found == expected);
+    }
+
     voltdb::VoltDBEngine *m_engine;
     voltdb::TupleSchema *m_tableSchema;
     voltdb::PersistentTable *m_table;
@@ -309,8 +336,9 @@ TEST_F(CompactionTest, BasicCompaction) {
     key.moveNoHeader(backingStore.get());
     for (std::vector<int32_t>::iterator ii = pkeysToDelete.begin(); ii != pkeysToDelete.end(); ii++) {
         key.setNValue(0, ValueFactory::getIntegerValue(*ii));
-        ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-        TableTuple tuple = pkeyIndex->nextValueAtKey();
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
         m_table->deleteTuple(tuple, true);
     }
 
@@ -323,8 +351,9 @@ TEST_F(CompactionTest, BasicCompaction) {
         int32_t pkey = ValuePeeker::peekAsInteger(tuple.getNValue(0));
         key.setNValue(0, ValueFactory::getIntegerValue(pkey));
         for (int ii = 0; ii < 4; ii++) {
-            ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key));
-            TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey();
+            IndexCursor indexCursor(m_table->m_indexes[ii]->getTupleSchema());
+            ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key, indexCursor));
+            TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey(indexCursor);
             ASSERT_EQ(indexTuple.address(), tuple.address());
         }
         pkeysFoundAfterDelete.insert(pkey);
@@ -355,8 +384,9 @@ TEST_F(CompactionTest, BasicCompaction) {
 
     for (stx::btree_set<int32_t>::iterator ii = pkeysNotDeleted.begin(); ii != pkeysNotDeleted.end(); ii++) {
         key.setNValue(0, ValueFactory::getIntegerValue(*ii));
-        ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-        TableTuple tuple = pkeyIndex->nextValueAtKey();
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
         m_table->deleteTuple(tuple, true);
     }
     m_table->doForcedCompaction();
@@ -364,6 +394,152 @@ TEST_F(CompactionTest, BasicCompaction) {
     ASSERT_EQ( m_table->activeTupleCount(), 0);
 }
 
+/*
+ * Compaction in bounded slices never moves more tuples than it was allowed,
+ * picks up where the previous slice stopped, and ends with the table as
+ * compact, and as intact, as a forced compaction leaves it.
+ */
+TEST_F(CompactionTest, IncrementalCompaction) {
+    initTable(true);
+#ifdef MEMCHECK
+    int tupleCount = 1000;
+#else
+    int tupleCount = 645260;
+#endif
+    addRandomUniqueTuples( m_table, tupleCount);
+
+    voltdb::TableIndex *pkeyIndex = m_table->primaryKeyIndex();
+    TableTuple key(pkeyIndex->getKeySchema());
+    boost::scoped_array<char> backingStore(new char[pkeyIndex->getKeySchema()->tupleLength()]);
+    key.moveNoHeader(backingStore.get());
+    for (int ii = 0; ii < tupleCount; ii += 2) {
+        key.setNValue(0, ValueFactory::getIntegerValue(ii));
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
+        m_table->deleteTuple(tuple, true);
+    }
+
+    const int64_t sliceTuples = 1000;
+    int64_t slices = 0;
+    int64_t totalMoved = 0;
+    while (true) {
+        int64_t moved = m_table->doIncrementalCompaction(sliceTuples, INT64_MAX);
+        ASSERT_TRUE(moved <= sliceTuples);
+        if (moved == 0) {
+            break;
+        }
+        totalMoved += moved;
+        slices++;
+    }
+    ASSERT_TRUE(slices > 1);
+    ASSERT_EQ(totalMoved, m_table->compactionTuplesMoved());
+    ASSERT_TRUE(m_table->compactionBlocksMerged() > 0);
+#ifdef MEMCHECK
+    ASSERT_EQ( m_table->allocatedBlockCount(), 500);
+#else
+    ASSERT_EQ( m_table->allocatedBlockCount(), 13);
+#endif
+
+    int found = 0;
+    TableIterator& iter = m_table->iterator();
+    TableTuple tuple(m_table->schema());
+    while (iter.next(tuple)) {
+        int32_t pkey = ValuePeeker::peekAsInteger(tuple.getNValue(0));
+        ASSERT_EQ(1, pkey % 2);
+        key.setNValue(0, ValueFactory::getIntegerValue(pkey));
+        for (int ii = 0; ii < 4; ii++) {
+            IndexCursor indexCursor(m_table->m_indexes[ii]->getTupleSchema());
+            ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key, indexCursor));
+            TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey(indexCursor);
+            ASSERT_EQ(indexTuple.address(), tuple.address());
+        }
+        found++;
+    }
+    ASSERT_EQ(tupleCount / 2, found);
+}
+
+/*
+ * The compaction done by tick() may run while an undo quantum is still open.
+ * Undoing the quantum afterwards must still find the tuples it inserted and
+ * updated wherever compaction moved them, and put the table and its indexes
+ * back as they were.
+ */
+TEST_F(CompactionTest, CompactionUnderOpenUndoQuantum) {
+    initTable(true);
+#ifdef MEMCHECK
+    int tupleCount = 1000;
+#else
+    int tupleCount = 200000;
+#endif
+    addRandomUniqueTuples( m_table, tupleCount);
+
+    voltdb::TableIndex *pkeyIndex = m_table->primaryKeyIndex();
+    TableTuple key(pkeyIndex->getKeySchema());
+    boost::scoped_array<char> backingStore(new char[pkeyIndex->getKeySchema()->tupleLength()]);
+    key.moveNoHeader(backingStore.get());
+    for (int ii = 0; ii < tupleCount; ii += 2) {
+        key.setNValue(0, ValueFactory::getIntegerValue(ii));
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
+        m_table->deleteTuple(tuple, false);
+    }
+
+    std::map<int32_t, int32_t> expected;
+    TableTuple tuple(m_table->schema());
+    TableIterator& iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        expected[ValuePeeker::peekAsInteger(tuple.getNValue(0))] = ValuePeeker::peekAsInteger(tuple.getNValue(1));
+    }
+
+    m_engine->setUndoToken(++m_undoToken);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0, 0);
+
+    // Inserts and updates keep copies of the tuples for undo, so compaction
+    // may move the tuples they touched.
+    const int32_t firstInsertedKey = m_primaryKeyIndex;
+    addRandomUniqueTuples(m_table, tupleCount / 10);
+    for (int ii = 1; ii < tupleCount; ii += 10) {
+        key.setNValue(0, ValueFactory::getIntegerValue(ii));
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple target = pkeyIndex->nextValueAtKey(indexCursor);
+        TableTuple tempTuple = m_table->tempTuple();
+        tempTuple.copy(target);
+        tempTuple.setNValue(1, ValueFactory::getIntegerValue(-ii));
+        m_table->updateTuple(target, tempTuple);
+    }
+    const int64_t sliceTuples = tupleCount / 100;
+    ASSERT_TRUE(m_table->doIncrementalCompaction(sliceTuples, TICK_COMPACTION_MICROS) > 0);
+    ASSERT_TRUE(m_table->compactionPredicate());
+
+    // Deleted tuples stay in place until the quantum is released, so
+    // compaction holds off while there are any.
+    for (int ii = 3; ii < tupleCount; ii += 10) {
+        key.setNValue(0, ValueFactory::getIntegerValue(ii));
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple target = pkeyIndex->nextValueAtKey(indexCursor);
+        m_table->deleteTuple(target, true);
+    }
+    ASSERT_EQ(0, m_table->doIncrementalCompaction(sliceTuples, TICK_COMPACTION_MICROS));
+
+    m_engine->undoUndoToken(m_undoToken);
+    checkTableContents(expected);
+    key.setNValue(0, ValueFactory::getIntegerValue(firstInsertedKey));
+    for (int ii = 0; ii < 4; ii++) {
+        IndexCursor indexCursor(m_table->m_indexes[ii]->getTupleSchema());
+        ASSERT_FALSE(m_table->m_indexes[ii]->moveToKey(&key, indexCursor));
+    }
+
+    // With the quantum gone, compaction can finish.
+    while (m_table->doIncrementalCompaction(TICK_COMPACTION_TUPLES, TICK_COMPACTION_MICROS) > 0) {
+    }
+    ASSERT_FALSE(m_table->compactionPredicate());
+    checkTableContents(expected);
+}
+
 TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
     initTable(true);
 #ifdef MEMCHECK
@@ -448,8 +624,9 @@ TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
         key.moveNoHeader(backingStore.get());
         for (std::vector<int32_t>::iterator ii = pkeysToDelete[qq].begin(); ii != pkeysToDelete[qq].end(); ii++) {
             key.setNValue(0, ValueFactory::getIntegerValue(*ii));
-            ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-            TableTuple tuple = pkeyIndex->nextValueAtKey();
+            IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+            ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+            TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
             m_table->deleteTuple(tuple, true);
         }
 
@@ -466,8 +643,9 @@ TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
             int32_t pkey = ValuePeeker::peekAsInteger(tuple.getNValue(0));
             key.setNValue(0, ValueFactory::getIntegerValue(pkey));
             for (int ii = 0; ii < 4; ii++) {
-                ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key));
-                TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey();
+                IndexCursor indexCursor(m_table->m_indexes[ii]->getTupleSchema());
+                ASSERT_TRUE(m_table->m_indexes[ii]->moveToKey(&key, indexCursor));
+                TableTuple indexTuple = m_table->m_indexes[ii]->nextValueAtKey(indexCursor);
                 ASSERT_EQ(indexTuple.address(), tuple.address());
             }
             pkeysFoundAfterDelete.insert(pkey);
@@ -494,8 +672,8 @@ TEST_F(CompactionTest, CompactionWithCopyOnWrite) {
         //
         //        for (stx::btree_set<int32_t>::iterator ii = pkeysNotDeleted.begin(); ii != pkeysNotDeleted.end(); ii++) {
         //            key.setNValue(0, ValueFactory::getIntegerValue(*ii));
-        //            ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-        //            TableTuple tuple = pkeyIndex->nextValueAtKey();
+        //            ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        //            TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
         //            m_table->deleteTuple(tuple, true);
         //        }
 
@@ -527,8 +705,9 @@ TEST_F(CompactionTest, TestENG897) {
     for (int ii = 0; ii < 32263 * 5; ii++) {
         if (ii % 2 == 0) {
             key.setNValue(0, ValueFactory::getIntegerValue(ii));
-            ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-            TableTuple tuple = pkeyIndex->nextValueAtKey();
+            IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+            ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+            TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
             m_table->deleteTuple(tuple, true);
         }
     }
@@ -548,8 +727,9 @@ TEST_F(CompactionTest, TestENG897) {
             continue;
         }
         key.setNValue(0, ValueFactory::getIntegerValue(ii));
-        ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-        TableTuple tuple = pkeyIndex->nextValueAtKey();
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
         m_table->deleteTuple(tuple, true);
     }
 
@@ -575,8 +755,9 @@ TEST_F(CompactionTest, TestENG897) {
             continue;
         }
         key.setNValue(0, ValueFactory::getIntegerValue(ii));
-        ASSERT_TRUE(pkeyIndex->moveToKey(&key));
-        TableTuple tuple = pkeyIndex->nextValueAtKey();
+        IndexCursor indexCursor(pkeyIndex->getTupleSchema());
+        ASSERT_TRUE(pkeyIndex->moveToKey(&key, indexCursor));
+        TableTuple tuple = pkeyIndex->nextValueAtKey(indexCursor);
         m_table->deleteTuple(tuple, true);
     }
 
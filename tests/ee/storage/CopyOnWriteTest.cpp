@@ -47,10 +47,13 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <stdint.h>
 #include <stdarg.h>
 #include <boost/foreach.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <murmur3/MurmurHash3.h>
 
@@ -909,6 +912,55 @@ public:
         ASSERT_TRUE(predicates.parseStrings(predicateStrings, errmsg, deleteFlags));
     }
 
+    /**
+     * Write every tuple of the table to one output stream per predicate and
+     * check that each stream gets exactly the tuples its own predicate
+     * accepts, and that deletion is requested exactly when a stream whose
+     * predicate deletes accepts the tuple. Returns whether the streams were
+     * routed by hash.
+     */
+    bool checkStreamRouting(const std::vector<std::string> &predicateStrings) {
+        StreamPredicateList predicates;
+        std::ostringstream errmsg;
+        std::vector<bool> deleteFlags;
+        EXPECT_TRUE(predicates.parseStrings(predicateStrings, errmsg, deleteFlags));
+        EXPECT_EQ(predicateStrings.size(), predicates.size());
+        deleteFlags.assign(predicates.size(), false);
+        for (size_t ipred = 0; ipred < deleteFlags.size(); ipred += 3) {
+            deleteFlags[ipred] = true;
+        }
+
+        const size_t bufferSize = 12 + ((m_tupleWidth + sizeof(int32_t)) * m_table->activeTupleCount());
+        boost::scoped_array<char> buffers(new char[bufferSize * predicates.size()]);
+        TupleOutputStreamProcessor outputStreams;
+        for (size_t ipred = 0; ipred < predicates.size(); ipred++) {
+            outputStreams.add(buffers.get() + bufferSize * ipred, bufferSize);
+        }
+        outputStreams.open(*m_table, m_serializer.getMaxSerializedTupleSize(m_table->schema()),
+                           0, predicates, deleteFlags);
+        const bool hashRouted = outputStreams.m_hashRouted;
+
+        std::vector<size_t> positions(predicates.size());
+        TableTuple tuple(m_table->schema());
+        voltdb::TableIterator& iterator = m_table->iterator();
+        while (iterator.next(tuple)) {
+            for (size_t ipred = 0; ipred < predicates.size(); ipred++) {
+                positions[ipred] = outputStreams[ipred].position();
+            }
+            bool deleteRow = false;
+            outputStreams.writeRow(m_serializer, tuple, &deleteRow);
+            bool expectDelete = false;
+            for (size_t ipred = 0; ipred < predicates.size(); ipred++) {
+                const bool expected = predicates.is_null(ipred) || predicates[ipred].eval(&tuple).isTrue();
+                EXPECT_EQ(expected, outputStreams[ipred].position() > positions[ipred]);
+                expectDelete = expectDelete || (expected && deleteFlags[ipred]);
+            }
+            EXPECT_EQ(expectDelete, deleteRow);
+        }
+        outputStreams.close();
+        return hashRouted;
+    }
+
     boost::shared_ptr<ReferenceSerializeInput> getPredicateSerializeInput(const std::vector<std::string> &predicateStrings) {
         ReferenceSerializeOutput predicateOutput(m_predicateBuffer, 1024 * 256);
         predicateOutput.writeInt(1);
@@ -1521,6 +1573,57 @@ TEST_F(CopyOnWriteTest, MultiStream) {
     }
 }
 
+/*
+ * Hash routing of output streams must accept the same tuples as evaluating
+ * each stream's predicate, and fall back to doing so when it can not route.
+ */
+TEST_F(CopyOnWriteTest, HashRoutedStreams) {
+    initTable(true, 1, 0);
+    addRandomUniqueTuples(m_table, 1000);
+    const int32_t minHash = std::numeric_limits<int32_t>::min();
+    const int32_t maxHash = std::numeric_limits<int32_t>::max();
+
+    // Overlapping ranges, with several ranges per predicate.
+    std::vector<std::string> predicateStrings;
+    predicateStrings.push_back(generateHashRangePredicate(T_HashRange(minHash, 0)));
+    predicateStrings.push_back(generateHashRangePredicate(T_HashRange(-1000000000, 1000000000)));
+    predicateStrings.push_back(generateHashRangePredicate(T_HashRange(500, maxHash)));
+    T_HashRangeVector ranges;
+    ranges.push_back(T_HashRange(minHash, -2000000000));
+    ranges.push_back(T_HashRange(-500000000, -100000000));
+    ranges.push_back(T_HashRange(0, 0));
+    ranges.push_back(T_HashRange(1000000000, maxHash));
+    predicateStrings.push_back(generateHashRangePredicate(ranges));
+    ASSERT_TRUE(checkStreamRouting(predicateStrings));
+
+    // Streams without a predicate take every tuple.
+    predicateStrings.clear();
+    predicateStrings.push_back("");
+    predicateStrings.push_back(generateHashRangePredicate(T_HashRange(-1000000000, 1000000000)));
+    predicateStrings.push_back("");
+    ASSERT_TRUE(checkStreamRouting(predicateStrings));
+
+    // A predicate that is not a hash range turns routing off.
+    predicateStrings.clear();
+    predicateStrings.push_back(generateHashRangePredicate(T_HashRange(minHash, 0)));
+    predicateStrings.push_back(generatePredicateString(0, false));
+    ASSERT_FALSE(checkStreamRouting(predicateStrings));
+
+    // So do more streams than fit in the routing bit masks.
+    predicateStrings.clear();
+    const int64_t nstreams = 70;
+    const int64_t width = ((int64_t)maxHash - minHash + 1) / nstreams;
+    for (int64_t istream = 0; istream < nstreams; istream++) {
+        const int64_t first = minHash + istream * width;
+        const int64_t last = istream == nstreams - 1 ? maxHash : first + width - 1;
+        predicateStrings.push_back(generateHashRangePredicate(
+                T_HashRange(static_cast<int32_t>(first), static_cast<int32_t>(last))));
+    }
+    ASSERT_FALSE(checkStreamRouting(predicateStrings));
+    predicateStrings.resize(64);
+    ASSERT_TRUE(checkStreamRouting(predicateStrings));
+}
+
 /*
  * Test for the ENG-4524 edge condition where serializeMore() yields on
  * precisely the last tuple which had caused the loop to skip the last call to
@@ -33,6 +33,7 @@
 #include "common/ValueFactory.hpp"
 #include "execution/VoltDBEngine.h"
 #include "storage/persistenttable.h"
+#include "storage/ColumnPageIterator.h"
 #include "storage/tablefactory.h"
 #include "storage/tableutil.h"
 #include "indexes/tableindex.h"
@@ -40,6 +41,19 @@
 using namespace std;
 using namespace voltdb;
 
+/*
+ * Memory a persistent table uses for a string column's value, none if it
+ * is short enough to be kept in the tuple.
+ */
+static size_t stringMemoryUsed(const NValue &value)
+{
+    const int32_t length = ValuePeeker::peekObjectLength(value);
+    if (length <= StringRef::SHORT_STRING_MAX_LENGTH) {
+        return 0;
+    }
+    return StringRef::computeStringMemoryUsed(length);
+}
+
 class PersistentTableMemStatsTest : public Test {
 public:
     PersistentTableMemStatsTest() {
@@ -127,8 +141,8 @@ TEST_F(PersistentTableMemStatsTest, InsertTest) {
     tableutil::setRandomTupleValues(m_table, &tuple);
     //cout << "Created random tuple " << endl << tuple.debugNoHeader() << endl;
     size_t added_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(2)));
+        stringMemoryUsed(tuple.getNValue(1)) +
+        stringMemoryUsed(tuple.getNValue(2));
     //cout << "Allocating string mem for bytes: " << ValuePeeker::peekObjectLength(tuple.getNValue(1)) + sizeof(int32_t) << endl;
     //cout << "Adding bytes to table: " << added_bytes << endl;
 
@@ -158,8 +172,8 @@ TEST_F(PersistentTableMemStatsTest, InsertThenUndoInsertTest) {
     tableutil::setRandomTupleValues(m_table, &tuple);
     //cout << "Created random tuple " << endl << tuple.debugNoHeader() << endl;
     size_t added_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(2)));
+        stringMemoryUsed(tuple.getNValue(1)) +
+        stringMemoryUsed(tuple.getNValue(2));
     //cout << "Adding bytes to table: " << added_bytes << endl;
 
     m_engine->setUndoToken(INT64_MIN + 2);
@@ -192,8 +206,8 @@ TEST_F(PersistentTableMemStatsTest, UpdateTest) {
     //cout << "Retrieved random tuple " << endl << tuple.debugNoHeader() << endl;
 
     size_t removed_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(2)));
+        stringMemoryUsed(tuple.getNValue(1)) +
+        stringMemoryUsed(tuple.getNValue(2));
     //cout << "Removing bytes from table: " << removed_bytes << endl;
 
     /*
@@ -207,8 +221,8 @@ TEST_F(PersistentTableMemStatsTest, UpdateTest) {
     tempTuple.setNValue(1, new_string);
     //cout << "Created updated tuple " << endl << tempTuple.debugNoHeader() << endl;
     size_t added_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tempTuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tempTuple.getNValue(2)));
+        stringMemoryUsed(tempTuple.getNValue(1)) +
+        stringMemoryUsed(tempTuple.getNValue(2));
     //cout << "Adding bytes to table: " << added_bytes << endl;
 
     m_engine->setUndoToken(INT64_MIN + 2);
@@ -241,8 +255,8 @@ TEST_F(PersistentTableMemStatsTest, UpdateAndUndoTest) {
     //cout << "Retrieved random tuple " << endl << tuple.debugNoHeader() << endl;
 
     size_t removed_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(2)));
+        stringMemoryUsed(tuple.getNValue(1)) +
+        stringMemoryUsed(tuple.getNValue(2));
     //cout << "Removing bytes from table: " << removed_bytes << endl;
 
     /*
@@ -256,8 +270,8 @@ TEST_F(PersistentTableMemStatsTest, UpdateAndUndoTest) {
     tempTuple.setNValue(1, new_string);
     //cout << "Created random tuple " << endl << tempTuple.debugNoHeader() << endl;
     size_t added_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tempTuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tempTuple.getNValue(2)));
+        stringMemoryUsed(tempTuple.getNValue(1)) +
+        stringMemoryUsed(tempTuple.getNValue(2));
     //cout << "Adding bytes to table: " << added_bytes << endl;
 
     m_engine->setUndoToken(INT64_MIN + 2);
@@ -291,8 +305,8 @@ TEST_F(PersistentTableMemStatsTest, DeleteTest) {
     //cout << "Retrieved random tuple " << endl << tuple.debugNoHeader() << endl;
 
     size_t removed_bytes =
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(1))) +
-        StringRef::computeStringMemoryUsed(ValuePeeker::peekObjectLength(tuple.getNValue(2)));
+        stringMemoryUsed(tuple.getNValue(1)) +
+        stringMemoryUsed(tuple.getNValue(2));
     //cout << "Removing bytes from table: " << removed_bytes << endl;
 
     m_engine->setUndoToken(INT64_MIN + 2);
@@ -340,6 +354,42 @@ TEST_F(PersistentTableMemStatsTest, DeleteAndUndoTest) {
     //delete [] tuple.address();
 }
 
+TEST_F(PersistentTableMemStatsTest, ColumnPagesTest) {
+    initTable(true);
+    m_table->enableColumnPages();
+    tableutil::addRandomTuples(m_table, 1000);
+    const int64_t blocks = m_table->allocatedBlockCount();
+    const int64_t blockBytes = blocks * m_table->getTableAllocationSize();
+    ASSERT_TRUE(blocks > 0);
+    // no block has column pages until a scan reads them
+    ASSERT_EQ(blockBytes, m_table->allocatedTupleMemory());
+
+    ColumnPageIterator pages(m_table);
+    TableTuple tuples[64];
+    int selection[64];
+    const char *columns[3];
+    int count = 0;
+    int visible = 0;
+    while (pages.next(tuples, selection, count, columns, 64)) {
+        visible += count;
+    }
+    ASSERT_EQ(1000, visible);
+
+    // the visibility bitmap and the TINYINT column's page, in every block
+    const int64_t tuplesPerBlock = m_table->allocatedTupleCount() / blocks;
+    const int64_t pageBytes = ((tuplesPerBlock + 63) / 64) * sizeof(uint64_t) +
+        ((tuplesPerBlock + 7) & ~static_cast<int64_t>(7));
+    ASSERT_EQ(blockBytes + blocks * pageBytes, m_table->allocatedTupleMemory());
+
+    // and the pages go with their blocks
+    m_engine->setUndoToken(INT64_MIN + 2);
+    m_engine->getExecutorContext();
+    m_table->deleteAllTuples(true);
+    m_engine->releaseUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(0, m_table->allocatedBlockCount());
+    ASSERT_EQ(0, m_table->allocatedTupleMemory());
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
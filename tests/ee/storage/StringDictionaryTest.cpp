@@ -0,0 +1,428 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Tests of dictionary encoded string columns: that tuples share their
+ * column's entries, that undo and release keep the entries' reference
+ * counts right, that table stats report the savings, and that the
+ * comparison kernels on codes select what the comparisons would.
+ */
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "harness.h"
+#include "common/StringDictionary.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "execution/VoltDBEngine.h"
+#include "expressions/expressions.h"
+#include "expressions/expressionutil.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+#include "storage/TableStats.h"
+#include "storage/temptable.h"
+
+using namespace std;
+using namespace voltdb;
+
+#define TUPLES 1000
+
+static const char *STATUSES[] = {
+    "SUSPENDED",
+    "CLOSED BY CUSTOMER",
+    "DORMANT",
+    // long enough to take a four byte length prefix
+    "AWAITING REVIEW BY THE ACCOUNTS DEPARTMENT BEFORE IT IS REOPENED OR CLOSED",
+    // short enough to be kept in the tuple slot rather than the dictionary
+    "OPEN"
+};
+static const int STATUS_COUNT = 5;
+static const int SHORT_STATUS = 4;
+
+class StringDictionaryTest : public Test {
+public:
+    StringDictionaryTest() : m_undoToken(INT64_MIN) {
+        m_engine = new VoltDBEngine();
+        int partitionCount = 1;
+        m_engine->initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+        m_engine->updateHashinator(HASHINATOR_LEGACY, (char*)&partitionCount, NULL, 0);
+
+        // ID, STATUS (encoded), NOTE, and CODE (encoded, but inlined)
+        m_columnNames.push_back("ID");
+        m_columnNames.push_back("STATUS");
+        m_columnNames.push_back("NOTE");
+        m_columnNames.push_back("CODE");
+        vector<ValueType> types;
+        vector<int32_t> lengths;
+        vector<bool> allowNull;
+        types.push_back(VALUE_TYPE_INTEGER);
+        lengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        allowNull.push_back(false);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(100);
+        allowNull.push_back(true);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(100);
+        allowNull.push_back(true);
+        types.push_back(VALUE_TYPE_VARCHAR);
+        lengths.push_back(8);
+        allowNull.push_back(true);
+        TupleSchema *schema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+
+        m_table = static_cast<PersistentTable*>(
+            TableFactory::getPersistentTable(0, "ACCOUNTS", schema, m_columnNames, -1));
+        m_table->enableStringDictionary(1);
+        m_table->enableStringDictionary(3);
+        m_dictionary = m_table->stringDictionary(1);
+    }
+
+    ~StringDictionaryTest() {
+        delete m_table;
+        delete m_engine;
+    }
+
+    void beginUndo() {
+        m_engine->setUndoToken(++m_undoToken);
+        // this next line is a testing hack until engine data is
+        // de-duplicated with executorcontext data
+        m_engine->getExecutorContext();
+    }
+
+    void release() {
+        m_engine->releaseUndoToken(m_undoToken);
+    }
+
+    void undo() {
+        m_engine->undoUndoToken(m_undoToken);
+    }
+
+    static NValue stringOrNull(const char *value) {
+        return value == NULL ? ValueFactory::getNullStringValue() : ValueFactory::getStringValue(value);
+    }
+
+    void insert(int id, const char *status, const char *note) {
+        TableTuple &tuple = m_table->tempTuple();
+        NValue statusValue = stringOrNull(status);
+        NValue noteValue = stringOrNull(note);
+        NValue codeValue = ValueFactory::getStringValue("C");
+        tuple.setNValue(0, ValueFactory::getIntegerValue(id));
+        tuple.setNValue(1, statusValue);
+        tuple.setNValue(2, noteValue);
+        tuple.setNValue(3, codeValue);
+        m_table->insertTuple(tuple);
+        statusValue.free();
+        noteValue.free();
+        codeValue.free();
+    }
+
+    // Status i % STATUS_COUNT, or NULL for every 50th tuple, and a note
+    // with the same value in a column that is not encoded.
+    void insertTuples(int count) {
+        beginUndo();
+        for (int i = 0; i < count; i++) {
+            const char *status = i % 50 == 0 ? NULL : STATUSES[i % STATUS_COUNT];
+            insert(i, status, status);
+        }
+        release();
+    }
+
+    TableTuple findTuple(int id) {
+        TableIterator iter = m_table->iterator();
+        TableTuple tuple(m_table->schema());
+        while (iter.next(tuple)) {
+            if (ValuePeeker::peekAsInteger(tuple.getNValue(0)) == id) {
+                return tuple;
+            }
+        }
+        return TableTuple();
+    }
+
+    void updateColumn(TableTuple &tuple, int column, const char *value) {
+        TableTuple &newTuple = m_table->tempTuple();
+        newTuple.copy(tuple);
+        NValue newValue = stringOrNull(value);
+        newTuple.setNValue(column, newValue);
+        m_table->updateTuple(tuple, newTuple);
+        newValue.free();
+    }
+
+    static const char *stringData(const TableTuple &tuple, int column) {
+        return static_cast<const char*>(ValuePeeker::peekObjectValue(tuple.getNValue(column)));
+    }
+
+    /*
+     * Check that evaluating the predicate a batch at a time selects
+     * exactly the tuples eval() does.
+     */
+    void checkBatches(const vector<TableTuple> &tuples, AbstractExpression *predicate) {
+        int selection[AbstractExpression::BATCH_SIZE];
+        for (size_t start = 0; start < tuples.size(); start += AbstractExpression::BATCH_SIZE) {
+            const int count = static_cast<int>(min(tuples.size() - start,
+                                                   (size_t)AbstractExpression::BATCH_SIZE));
+            for (int ii = 0; ii < count; ii++) {
+                selection[ii] = ii;
+            }
+            const TableTuple *batch = &tuples[start];
+            const int selected = predicate->evalPredicateBatch(batch, selection, count);
+            int next = 0;
+            for (int ii = 0; ii < count; ii++) {
+                if (predicate->eval(&batch[ii], NULL).isTrue()) {
+                    ASSERT_TRUE(next < selected);
+                    ASSERT_EQ(ii, selection[next++]);
+                }
+            }
+            ASSERT_EQ(next, selected);
+        }
+    }
+
+    static AbstractExpression *equals(int column, const char *value) {
+        return new ComparisonExpression<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                               new TupleValueExpression(0, column),
+                                               new ConstantValueExpression(stringOrNull(value)));
+    }
+
+    static AbstractExpression *notEquals(const char *value, int column) {
+        return new ComparisonExpression<CmpNe>(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                               new ConstantValueExpression(stringOrNull(value)),
+                                               new TupleValueExpression(0, column));
+    }
+
+    static AbstractExpression *in(int column, const char *first, const char *second, const char *third) {
+        vector<AbstractExpression*> *list = new vector<AbstractExpression*>();
+        list->push_back(new ConstantValueExpression(stringOrNull(first)));
+        list->push_back(new ConstantValueExpression(stringOrNull(second)));
+        list->push_back(new ConstantValueExpression(stringOrNull(third)));
+        return new ComparisonExpression<CmpIn>(EXPRESSION_TYPE_COMPARE_IN,
+                                               new TupleValueExpression(0, column),
+                                               ExpressionUtil::vectorFactory(VALUE_TYPE_VARCHAR, list));
+    }
+
+    VoltDBEngine *m_engine;
+    PersistentTable *m_table;
+    const StringDictionary *m_dictionary;
+    vector<string> m_columnNames;
+    int64_t m_undoToken;
+};
+
+TEST_F(StringDictionaryTest, SharedEntries) {
+    // only out of line string columns are encoded
+    ASSERT_TRUE(m_dictionary != NULL);
+    ASSERT_TRUE(m_table->stringDictionary(0) == NULL);
+    ASSERT_TRUE(m_table->stringDictionary(2) == NULL);
+    ASSERT_TRUE(m_table->stringDictionary(3) == NULL);
+
+    insertTuples(TUPLES);
+    ASSERT_EQ(STATUS_COUNT - 1, m_dictionary->entryCount());
+
+    // tuples with the same status share its string, but not their notes
+    vector<const char*> statusData(STATUS_COUNT, (const char*)NULL);
+    vector<const char*> noteData(STATUS_COUNT, (const char*)NULL);
+    int64_t references = 0;
+    int64_t separateBytes = 0;
+    int64_t nonInlinedBytes = 0;
+    TableIterator iter = m_table->iterator();
+    TableTuple tuple(m_table->schema());
+    while (iter.next(tuple)) {
+        const int id = ValuePeeker::peekAsInteger(tuple.getNValue(0));
+        if (id % 50 == 0) {
+            ASSERT_TRUE(tuple.getNValue(1).isNull());
+            continue;
+        }
+        const int status = id % STATUS_COUNT;
+        ASSERT_EQ(string(STATUSES[status]), ValuePeeker::peekStringCopy(tuple.getNValue(1)));
+        ASSERT_EQ(string(STATUSES[status]), ValuePeeker::peekStringCopy(tuple.getNValue(2)));
+        if (status == SHORT_STATUS) {
+            continue;
+        }
+        if (statusData[status] == NULL) {
+            statusData[status] = stringData(tuple, 1);
+            noteData[status] = stringData(tuple, 2);
+        } else {
+            ASSERT_TRUE(statusData[status] == stringData(tuple, 1));
+            ASSERT_TRUE(noteData[status] != stringData(tuple, 2));
+        }
+        ++references;
+        separateBytes += StringRef::computeStringMemoryUsed(strlen(STATUSES[status]));
+        nonInlinedBytes += 2 * StringRef::computeStringMemoryUsed(strlen(STATUSES[status]));
+    }
+
+    ASSERT_EQ(references, m_dictionary->referenceCount());
+
+    // the table still counts every string, and the dictionary what sharing saves
+    ASSERT_EQ(nonInlinedBytes, m_table->nonInlinedMemorySize());
+    ASSERT_TRUE(m_dictionary->bytesSaved() > separateBytes * 9 / 10);
+    ASSERT_TRUE(m_dictionary->bytesSaved() < separateBytes);
+    ASSERT_EQ(m_dictionary->bytesSaved(), m_table->stringDictionaryBytesSaved());
+
+    StatsSource *stats = static_cast<Table*>(m_table)->getTableStats();
+    TableTuple *row = stats->getStatsTuple(false, 0);
+    const Table *statsTable = stats->getStatsTable(false, 0);
+    ASSERT_EQ(m_dictionary->bytesSaved() / 1024,
+              ValuePeeker::peekAsInteger(row->getNValue(statsTable->columnIndex("STRING_DICTIONARY_SAVINGS"))));
+    ASSERT_EQ((nonInlinedBytes - m_dictionary->bytesSaved()) / 1024,
+              ValuePeeker::peekAsInteger(row->getNValue(statsTable->columnIndex("STRING_DATA_MEMORY"))));
+}
+
+TEST_F(StringDictionaryTest, UndoAndRelease) {
+    beginUndo();
+    for (int i = 0; i < 10; i++) {
+        insert(i, STATUSES[0], NULL);
+    }
+    release();
+    ASSERT_EQ(1, m_dictionary->entryCount());
+    ASSERT_EQ(10, m_dictionary->referenceCount());
+
+    // an undone insert drops its reference, and with it a new entry
+    beginUndo();
+    insert(10, STATUSES[1], NULL);
+    ASSERT_EQ(2, m_dictionary->entryCount());
+    ASSERT_EQ(11, m_dictionary->referenceCount());
+    undo();
+    ASSERT_EQ(1, m_dictionary->entryCount());
+    ASSERT_EQ(10, m_dictionary->referenceCount());
+
+    // a delete keeps its reference until it is released
+    beginUndo();
+    TableTuple tuple = findTuple(0);
+    m_table->deleteTuple(tuple, true);
+    ASSERT_EQ(10, m_dictionary->referenceCount());
+    undo();
+    ASSERT_EQ(10, m_dictionary->referenceCount());
+    ASSERT_EQ(string(STATUSES[0]), ValuePeeker::peekStringCopy(findTuple(0).getNValue(1)));
+    beginUndo();
+    tuple = findTuple(0);
+    m_table->deleteTuple(tuple, true);
+    release();
+    ASSERT_EQ(9, m_dictionary->referenceCount());
+
+    // so does the value an update replaces, while the new value is shared
+    beginUndo();
+    tuple = findTuple(1);
+    updateColumn(tuple, 1, STATUSES[2]);
+    ASSERT_EQ(2, m_dictionary->entryCount());
+    ASSERT_EQ(10, m_dictionary->referenceCount());
+    undo();
+    ASSERT_EQ(1, m_dictionary->entryCount());
+    ASSERT_EQ(9, m_dictionary->referenceCount());
+    tuple = findTuple(1);
+    ASSERT_TRUE(stringData(tuple, 1) == stringData(findTuple(2), 1));
+
+    beginUndo();
+    updateColumn(tuple, 1, STATUSES[2]);
+    tuple = findTuple(2);
+    updateColumn(tuple, 1, STATUSES[2]);
+    release();
+    ASSERT_EQ(2, m_dictionary->entryCount());
+    ASSERT_EQ(9, m_dictionary->referenceCount());
+    ASSERT_TRUE(stringData(findTuple(1), 1) == stringData(findTuple(2), 1));
+    ASSERT_EQ(string(STATUSES[2]), ValuePeeker::peekStringCopy(findTuple(1).getNValue(1)));
+
+    // updating another column leaves the reference alone, as does setting NULL
+    beginUndo();
+    tuple = findTuple(3);
+    updateColumn(tuple, 2, "a note");
+    release();
+    ASSERT_EQ(9, m_dictionary->referenceCount());
+    beginUndo();
+    updateColumn(tuple, 1, NULL);
+    ASSERT_EQ(9, m_dictionary->referenceCount());
+    release();
+    ASSERT_EQ(8, m_dictionary->referenceCount());
+
+    // the last release of an entry frees it
+    beginUndo();
+    TableIterator iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        m_table->deleteTuple(tuple, true);
+    }
+    ASSERT_EQ(2, m_dictionary->entryCount());
+    release();
+    ASSERT_EQ(0, m_dictionary->entryCount());
+    ASSERT_EQ(0, m_dictionary->referenceCount());
+    ASSERT_EQ(0, m_dictionary->bytesSaved());
+}
+
+TEST_F(StringDictionaryTest, TruncateAndReload) {
+    insertTuples(100);
+    const int64_t references = m_dictionary->referenceCount();
+
+    // a truncate holds its tuples' references until it is released
+    beginUndo();
+    m_table->truncateTable(m_engine);
+    ASSERT_EQ(references, m_dictionary->referenceCount());
+    undo();
+    ASSERT_EQ(references, m_dictionary->referenceCount());
+    beginUndo();
+    m_table->truncateTable(m_engine);
+    release();
+    ASSERT_EQ(0, m_dictionary->referenceCount());
+    ASSERT_EQ(0, m_dictionary->entryCount());
+}
+
+TEST_F(StringDictionaryTest, PredicatesOnCodes) {
+    insertTuples(TUPLES);
+
+    // mix in tuples with strings of their own, as a temp table holds them
+    TempTable *copies = TableFactory::getCopiedTempTable(0, "COPIES", m_table, NULL);
+    vector<TableTuple> tuples;
+    TableIterator iter = m_table->iterator();
+    TableTuple tuple(m_table->schema());
+    while (iter.next(tuple)) {
+        tuples.push_back(tuple);
+        if (tuples.size() % 3 == 0) {
+            copies->insertTuple(tuple);
+        }
+    }
+    TableIterator copyIter = copies->iterator();
+    TableTuple copy(copies->schema());
+    for (size_t ii = 1; copyIter.next(copy); ii += 3) {
+        tuples.insert(tuples.begin() + ii, copy);
+    }
+
+    vector<AbstractExpression*> predicates;
+    predicates.push_back(equals(1, STATUSES[2]));
+    predicates.push_back(equals(1, STATUSES[SHORT_STATUS]));
+    predicates.push_back(equals(1, STATUSES[3]));
+    predicates.push_back(equals(1, "UNKNOWN"));
+    predicates.push_back(equals(2, STATUSES[2]));
+    predicates.push_back(notEquals(STATUSES[0], 1));
+    predicates.push_back(notEquals("UNKNOWN", 1));
+    predicates.push_back(in(1, STATUSES[1], "UNKNOWN", STATUSES[3]));
+    predicates.push_back(in(1, STATUSES[SHORT_STATUS], STATUSES[0], "SHORT"));
+    predicates.push_back(in(1, NULL, STATUSES[0], STATUSES[0]));
+    predicates.push_back(in(2, STATUSES[1], STATUSES[2], NULL));
+    for (size_t ii = 0; ii < predicates.size(); ii++) {
+        checkBatches(tuples, predicates[ii]);
+        delete predicates[ii];
+    }
+    delete copies;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
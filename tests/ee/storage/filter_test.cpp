@@ -55,12 +55,15 @@
 #include "common/valuevector.h"
 #include "common/ValueFactory.hpp"
 #include "common/tabletuple.h"
+#include "execution/VoltDBEngine.h"
 #include "expressions/expressions.h"
 #include "expressions/expressionutil.h"
 #include "expressions/functionexpression.h"
 #include "storage/temptable.h"
+#include "storage/persistenttable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
+#include "storage/ColumnPageIterator.h"
 
 #define TUPLES 1000
 
@@ -111,6 +114,46 @@ public:
         delete table_static;
     };
 
+    /*
+     * Count the tuples the predicate selects when evaluated from the column
+     * pages, checking each batch against eval() on the tuples themselves.
+     */
+    int countFromColumnPages(PersistentTable *pagedTable, AbstractExpression *predicate) {
+        int selectedCount = 0;
+        TableTuple batch[AbstractExpression::BATCH_SIZE];
+        int selection[AbstractExpression::BATCH_SIZE];
+        int visible[AbstractExpression::BATCH_SIZE];
+        std::vector<const char*> columns(pagedTable->columnCount());
+        ColumnPageIterator pages(pagedTable);
+        int count = 0;
+        while (pages.next(batch, selection, count, &columns[0], AbstractExpression::BATCH_SIZE)) {
+            std::copy(selection, selection + count, visible);
+            int selected = predicate->evalPredicateBatch(batch, selection, count, &columns[0]);
+            int next = 0;
+            for (int ii = 0; ii < count; ii++) {
+                if (predicate->eval(&batch[visible[ii]], NULL).isTrue()) {
+                    EXPECT_TRUE(next < selected);
+                    EXPECT_EQ(visible[ii], selection[next++]);
+                }
+            }
+            EXPECT_EQ(next, selected);
+            selectedCount += selected;
+        }
+        return selectedCount;
+    }
+
+    int countFromTuples(Table *source, AbstractExpression *predicate) {
+        int count = 0;
+        TableIterator iter = source->iterator();
+        TableTuple match(source->schema());
+        while (iter.next(match)) {
+            if (predicate->eval(&match, NULL).isTrue()) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
     static Table* table_static;
     Table* table;
 };
@@ -388,6 +431,191 @@ TEST_F(FilterTest, SubstituteFilter) {
     delete predicate;
 }
 
+TEST_F(FilterTest, BatchFilter) {
+
+    // WHERE (id <= 500 AND val1=0) OR 3 < val4 OR id * 2 > 1990
+
+    AbstractExpression *comp1 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                                   new TupleValueExpression(0, 0),
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(500)));
+    AbstractExpression *comp2 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                   new TupleValueExpression(0, 1),
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(0)));
+    AbstractExpression *comp3 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                                   new ConstantValueExpression(ValueFactory::getIntegerValue(3)),
+                                                   new TupleValueExpression(0, 4));
+    AbstractExpression *times = new OperatorExpression<OpMultiply>(EXPRESSION_TYPE_OPERATOR_MULTIPLY,
+                                                   new TupleValueExpression(0, 0),
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(2)));
+    AbstractExpression *comp4 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                                   times,
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(1990)));
+
+    AbstractExpression *and1 = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND, comp1, comp2);
+    AbstractExpression *or1 = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR, and1, comp3);
+    AbstractExpression *predicate = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR, or1, comp4);
+
+    // the batch evaluation must select exactly the tuples eval() accepts
+    int evalCount = 0;
+    int batchCount = 0;
+    TableIterator iter = table->iterator();
+    TableTuple match(table->schema());
+    TableTuple batch[AbstractExpression::BATCH_SIZE];
+    int selection[AbstractExpression::BATCH_SIZE];
+    bool hasNext = true;
+    while (hasNext) {
+        int count = 0;
+        while (count < AbstractExpression::BATCH_SIZE && (hasNext = iter.next(match))) {
+            selection[count] = count;
+            batch[count++] = match;
+        }
+        int selected = predicate->evalPredicateBatch(batch, selection, count);
+        int next = 0;
+        for (int ii = 0; ii < count; ii++) {
+            if (predicate->eval(&batch[ii], NULL).isTrue()) {
+                ++evalCount;
+                ASSERT_TRUE(next < selected);
+                ASSERT_EQ(ii, selection[next++]);
+            }
+        }
+        ASSERT_EQ(next, selected);
+        batchCount += selected;
+    }
+    ASSERT_EQ(evalCount, batchCount);
+    ASSERT_EQ(574, batchCount);
+
+    delete predicate;
+}
+
+TEST_F(FilterTest, ColumnPageFilter) {
+    VoltDBEngine engine;
+    engine.initialize(1, 1, 0, 0, "", DEFAULT_TEMP_TABLE_MEMORY);
+
+    std::vector<std::string> columnNames;
+    std::vector<voltdb::ValueType> columnTypes;
+    columnNames.push_back("id");
+    columnTypes.push_back(VALUE_TYPE_BIGINT);
+    columnNames.push_back("name");
+    columnTypes.push_back(VALUE_TYPE_VARCHAR);
+    columnNames.push_back("small");
+    columnTypes.push_back(VALUE_TYPE_TINYINT);
+    columnNames.push_back("ratio");
+    columnTypes.push_back(VALUE_TYPE_DOUBLE);
+    columnNames.push_back("mid");
+    columnTypes.push_back(VALUE_TYPE_INTEGER);
+    std::vector<int32_t> columnLengths;
+    for (int ctr = 0; ctr < columnTypes.size(); ctr++) {
+        columnLengths.push_back(columnTypes[ctr] == VALUE_TYPE_VARCHAR ?
+                                10 : NValue::getTupleStorageSize(columnTypes[ctr]));
+    }
+    std::vector<bool> columnAllowNull(columnTypes.size(), true);
+    TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+
+    // small blocks, so the table spans several of them
+    PersistentTable *paged = dynamic_cast<PersistentTable*>(
+        TableFactory::getPersistentTable(1000, "paged_table", schema, columnNames,
+                                         -1, false, false, 4096, true));
+    ASSERT_TRUE(paged != NULL);
+    ASSERT_TRUE(paged->hasColumnPages());
+    ASSERT_EQ(-1, paged->columnPageOffset(1));
+
+    TableTuple &tuple = paged->tempTuple();
+    for (int64_t i = 1; i <= TUPLES; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(i));
+        tuple.setNValue(1, ValueFactory::getNullStringValue());
+        tuple.setNValue(2, i % 11 == 0 ? NValue::getNullValue(VALUE_TYPE_TINYINT) :
+                        ValueFactory::getTinyIntValue(static_cast<int8_t>(i % 7)));
+        tuple.setNValue(3, ValueFactory::getDoubleValue(static_cast<double>(i % 13) / 13));
+        tuple.setNValue(4, ValueFactory::getIntegerValue(static_cast<int32_t>(i % 2)));
+        paged->insertPersistentTuple(tuple, false);
+    }
+
+    // WHERE (id <= 500 AND mid = 0) OR 3 < small OR ratio * 2 > 1.5
+    AbstractExpression *comp1 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                                   new TupleValueExpression(0, 0),
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(500)));
+    AbstractExpression *comp2 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                   new TupleValueExpression(0, 4),
+                                                   new ConstantValueExpression(ValueFactory::getBigIntValue(0)));
+    AbstractExpression *comp3 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                                   new ConstantValueExpression(ValueFactory::getIntegerValue(3)),
+                                                   new TupleValueExpression(0, 2));
+    AbstractExpression *times = new OperatorExpression<OpMultiply>(EXPRESSION_TYPE_OPERATOR_MULTIPLY,
+                                                   new TupleValueExpression(0, 3),
+                                                   new ConstantValueExpression(ValueFactory::getDoubleValue(2)));
+    AbstractExpression *comp4 = ExpressionUtil::comparisonFactory(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                                   times,
+                                                   new ConstantValueExpression(ValueFactory::getDoubleValue(1.5)));
+    AbstractExpression *and1 = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_AND, comp1, comp2);
+    AbstractExpression *or1 = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR, and1, comp3);
+    AbstractExpression *predicate = ExpressionUtil::conjunctionFactory(EXPRESSION_TYPE_CONJUNCTION_OR, or1, comp4);
+
+    int expected = countFromTuples(paged, predicate);
+    ASSERT_TRUE(expected > 0);
+    ASSERT_EQ(expected, countFromColumnPages(paged, predicate));
+
+    // Deletes and updates after a scan must leave no stale column pages behind.
+    TableIterator iter = paged->iterator();
+    TableTuple target(paged->schema());
+    std::vector<TableTuple> deletes;
+    std::vector<TableTuple> updates;
+    int64_t row = 0;
+    while (iter.next(target)) {
+        if (++row % 3 == 0) {
+            deletes.push_back(target);
+        } else if (row % 5 == 0) {
+            updates.push_back(target);
+        }
+    }
+    for (size_t i = 0; i < deletes.size(); i++) {
+        paged->deleteTuple(deletes[i], false);
+    }
+    std::vector<TableIndex*> noIndexes;
+    for (size_t i = 0; i < updates.size(); i++) {
+        TableTuple &source = paged->tempTuple();
+        source.copy(updates[i]);
+        source.setNValue(2, ValueFactory::getTinyIntValue(6));
+        paged->updateTupleWithSpecificIndexes(updates[i], source, noIndexes, false);
+    }
+    int afterChanges = countFromTuples(paged, predicate);
+    ASSERT_TRUE(afterChanges != expected);
+    ASSERT_EQ(afterChanges, countFromColumnPages(paged, predicate));
+
+    // New tuples land in the freed slots.
+    for (int64_t i = 1; i <= TUPLES / 10; ++i) {
+        tuple.setNValue(0, ValueFactory::getBigIntValue(-i));
+        tuple.setNValue(1, ValueFactory::getNullStringValue());
+        tuple.setNValue(2, ValueFactory::getTinyIntValue(5));
+        tuple.setNValue(3, ValueFactory::getDoubleValue(0));
+        tuple.setNValue(4, ValueFactory::getIntegerValue(1));
+        paged->insertPersistentTuple(tuple, false);
+    }
+    ASSERT_EQ(afterChanges + TUPLES / 10, countFromTuples(paged, predicate));
+    ASSERT_EQ(afterChanges + TUPLES / 10, countFromColumnPages(paged, predicate));
+    const int afterInserts = afterChanges + TUPLES / 10;
+
+    // Deletes hide the tuples until they are undone.
+    engine.setUndoToken(1);
+    engine.getExecutorContext()->setupForPlanFragments(engine.getCurrentUndoQuantum(), 0, 0, 0);
+    deletes.clear();
+    TableIterator undoIter = paged->iterator();
+    while (undoIter.next(target)) {
+        deletes.push_back(target);
+    }
+    for (size_t i = 0; i < deletes.size(); i += 2) {
+        paged->deleteTuple(deletes[i], true);
+    }
+    int afterUndoableDeletes = countFromTuples(paged, predicate);
+    ASSERT_TRUE(afterUndoableDeletes < afterInserts);
+    ASSERT_EQ(afterUndoableDeletes, countFromColumnPages(paged, predicate));
+    engine.undoUndoToken(1);
+    ASSERT_EQ(afterInserts, countFromTuples(paged, predicate));
+    ASSERT_EQ(afterInserts, countFromColumnPages(paged, predicate));
+
+    delete predicate;
+    delete paged;
+}
+
 int main() {
     int ret = TestSuite::globalInstance()->runAll();
     FilterTest::releaseAll();// will be eventually done as its smart pointer, but safer is better.
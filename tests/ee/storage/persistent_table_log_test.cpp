@@ -30,8 +30,12 @@
 #include "execution/VoltDBEngine.h"
 #include "storage/persistenttable.h"
 #include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
 #include "storage/tableutil.h"
+#include "storage/temptable.h"
+#include "storage/ConstraintFailureException.h"
 #include "indexes/tableindex.h"
+#include "indexes/tableindexfactory.h"
 #include <vector>
 #include <string>
 #include <stdint.h>
@@ -252,6 +256,196 @@ TEST_F(PersistentTableLogTest, LoadTableThenReleaseTest) {
     ASSERT_TRUE(m_table->activeTupleCount() == (int64_t)1000);
 }
 
+/*
+ * Loading tuples that break a constraint rejects the tuples inserting them
+ * one at a time in order would: the later of two tuples with the same
+ * unique key, whether the table held the key before the load or not, and
+ * a tuple with a NULL in a NOT NULL column.
+ */
+TEST_F(PersistentTableLogTest, LoadTableWithViolationsTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+
+    // the 1000 tuples, the first 100 of them again, and then one with a NULL key
+    TempTable *source = TableFactory::getCopiedTempTable(0, "Source", m_table, NULL);
+    voltdb::TableTuple tuple(m_tableSchema);
+    TableIterator iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        source->insertTuple(tuple);
+    }
+    iter = m_table->iterator();
+    for (int i = 0; i < 100 && iter.next(tuple); i++) {
+        source->insertTuple(tuple);
+    }
+    TableTuple &nullKey = source->tempTuple();
+    nullKey.copy(tuple);
+    nullKey.setNValue(0, NValue::getNullValue(VALUE_TYPE_BIGINT));
+    source->insertTuple(nullKey);
+    CopySerializeOutput serialize_out;
+    source->serializeTo(serialize_out);
+    CopySerializeOutput clean_out;
+    m_table->serializeTo(clean_out);
+
+    // the source shares the original table's strings, and the original
+    // must not be deleted with its inserts still in the undo log
+    m_engine->releaseUndoToken(INT64_MIN + 1);
+    PersistentTable *original = m_table;
+    initTable(true);
+    // a second unique index and a non-unique one
+    std::vector<int> columns(1, 1);
+    m_table->addIndex(TableIndexFactory::getInstance(
+        TableIndexScheme("hashKeyIndex", HASH_TABLE_INDEX, m_primaryKeyIndexColumns,
+                         TableIndex::simplyIndexColumns(), true, false, m_tableSchema)));
+    m_table->addIndex(TableIndexFactory::getInstance(
+        TableIndexScheme("treeIndex", BALANCED_TREE_INDEX, columns,
+                         TableIndex::simplyIndexColumns(), false, false, m_tableSchema)));
+
+    std::vector<char> violationBuffer(1024 * 1024);
+    ReferenceSerializeOutput none(&violationBuffer[0], violationBuffer.size());
+    m_engine->setUndoToken(INT64_MIN + 2);
+    m_engine->getExecutorContext();
+    ReferenceSerializeInput clean_in(clean_out.data() + sizeof(int32_t),
+                                     clean_out.size() - sizeof(int32_t));
+    m_table->loadTuplesFrom(clean_in, NULL, &none);
+    ASSERT_EQ(sizeof(int32_t), none.position());
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    ASSERT_EQ(1000, m_table->index("hashKeyIndex")->getSize());
+    ASSERT_EQ(1000, m_table->index("treeIndex")->getSize());
+    iter = source->iterator();
+    for (int i = 0; i < 1000 && iter.next(tuple); i++) {
+        ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
+        ASSERT_TRUE(m_table->index("hashKeyIndex")->exists(&tuple));
+    }
+    m_engine->undoUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+
+    TempTable *rejected = TableFactory::getCopiedTempTable(0, "Rejected", m_table, NULL);
+    for (int load = 0; load < 2; load++) {
+        m_engine->setUndoToken(INT64_MIN + 3 + load);
+        m_engine->getExecutorContext();
+        ReferenceSerializeInput serialize_in(serialize_out.data() + sizeof(int32_t),
+                                             serialize_out.size() - sizeof(int32_t));
+        ReferenceSerializeOutput violations(&violationBuffer[0], violationBuffer.size());
+        m_table->loadTuplesFrom(serialize_in, NULL, &violations);
+
+        ASSERT_EQ(1000, m_table->activeTupleCount());
+        ASSERT_EQ(1000, m_table->primaryKeyIndex()->getSize());
+        ASSERT_EQ(1000, m_table->index("hashKeyIndex")->getSize());
+        ASSERT_EQ(1000, m_table->index("treeIndex")->getSize());
+
+        // the first load turns down the last 101 tuples, the second all of them
+        ReferenceSerializeInput violations_in(&violationBuffer[0] + sizeof(int32_t),
+                                              violations.position() - sizeof(int32_t));
+        rejected->deleteAllTuples(true);
+        rejected->loadTuplesFrom(violations_in);
+        ASSERT_EQ(load == 0 ? 101 : 1101, rejected->activeTupleCount());
+
+        TableIterator sourceIter = source->iterator();
+        TableIterator rejectedIter = rejected->iterator();
+        voltdb::TableTuple rejectedTuple(m_tableSchema);
+        for (int i = 0; sourceIter.next(tuple); i++) {
+            if (load == 0 && i < 1000) {
+                ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
+                continue;
+            }
+            ASSERT_TRUE(rejectedIter.next(rejectedTuple));
+            ASSERT_TRUE(tuple.equals(rejectedTuple));
+        }
+    }
+
+    m_engine->undoUndoToken(INT64_MIN + 4);
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    m_engine->undoUndoToken(INT64_MIN + 3);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->primaryKeyIndex()->getSize());
+    ASSERT_EQ(0, m_table->index("hashKeyIndex")->getSize());
+    ASSERT_EQ(0, m_table->index("treeIndex")->getSize());
+
+    // without an output for them the first violation fails the load
+    m_engine->setUndoToken(INT64_MIN + 5);
+    m_engine->getExecutorContext();
+    ReferenceSerializeInput serialize_in(serialize_out.data() + sizeof(int32_t),
+                                         serialize_out.size() - sizeof(int32_t));
+    bool failed = false;
+    try {
+        m_table->loadTuplesFrom(serialize_in, NULL, NULL);
+    } catch (ConstraintFailureException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_EQ(1000, m_table->primaryKeyIndex()->getSize());
+    ASSERT_EQ(1000, m_table->index("hashKeyIndex")->getSize());
+    m_engine->undoUndoToken(INT64_MIN + 5);
+    ASSERT_EQ(0, m_table->primaryKeyIndex()->getSize());
+
+    delete rejected;
+    delete source;
+    delete original;
+}
+
+/*
+ * A load that fails part way through a block, on a string too long for
+ * its column, leaves the table as it was: the tuples read before it and
+ * the one being read are all freed.
+ */
+TEST_F(PersistentTableLogTest, LoadTableFailsPartWayTest) {
+    initTable(true);
+    tableutil::addRandomTuples(m_table, 1000);
+    CopySerializeOutput valid_out;
+    m_table->serializeTo(valid_out);
+
+    // the same tuples, in a table whose ninth column takes longer strings
+    std::vector<int32_t> sizes = m_tableSchemaColumnSizes;
+    sizes[8] = 1000;
+    TupleSchema *wideSchema = TupleSchema::createTupleSchema(m_tableSchemaTypes, sizes,
+                                                             m_tableSchemaAllowNull, true);
+    TempTable *source = TableFactory::getTempTable(0, "Source", wideSchema, m_columnNames, NULL);
+    voltdb::TableTuple tuple(m_tableSchema);
+    TableIterator iter = m_table->iterator();
+    NValue tooLong = ValueFactory::getStringValue(std::string(600, 'x'));
+    for (int i = 0; iter.next(tuple); i++) {
+        TableTuple &copy = source->tempTuple();
+        for (int column = 0; column < 10; column++) {
+            copy.setNValue(column, tuple.getNValue(column));
+        }
+        if (i == 500) {
+            copy.setNValue(8, tooLong);
+        }
+        source->insertTuple(copy);
+    }
+    CopySerializeOutput serialize_out;
+    source->serializeTo(serialize_out);
+    tooLong.free();
+    delete source;
+    m_engine->undoUndoToken(INT64_MIN + 1);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    m_engine->getExecutorContext();
+    ReferenceSerializeInput serialize_in(serialize_out.data() + sizeof(int32_t),
+                                         serialize_out.size() - sizeof(int32_t));
+    bool failed = false;
+    try {
+        m_table->loadTuplesFrom(serialize_in, NULL, NULL);
+    } catch (SQLException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->nonInlinedMemorySize());
+    ASSERT_EQ(0, m_table->primaryKeyIndex()->getSize());
+
+    // and the freed slots take the next load
+    ReferenceSerializeInput valid_in(valid_out.data() + sizeof(int32_t),
+                                     valid_out.size() - sizeof(int32_t));
+    m_table->loadTuplesFrom(valid_in, NULL, NULL);
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    ASSERT_EQ(1, m_table->allocatedBlockCount());
+    m_engine->undoUndoToken(INT64_MIN + 2);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->nonInlinedMemorySize());
+}
+
 TEST_F(PersistentTableLogTest, InsertUpdateThenUndoOneTest) {
     initTable(true);
     tableutil::addRandomTuples(m_table, 1);
@@ -315,6 +509,127 @@ TEST_F(PersistentTableLogTest, InsertThenUndoInsertsOneTest) {
     ASSERT_EQ( m_table->activeTupleCount(), 0);
 }
 
+TEST_F(PersistentTableLogTest, TruncateThenUndoTest) {
+    initTable(false);
+    tableutil::addRandomTuples(m_table, 1000);
+    voltdb::TableTuple tuple(m_tableSchema);
+    tableutil::getRandomTuple(m_table, tuple);
+
+    voltdb::TableTuple tupleBackup(m_tableSchema);
+    tupleBackup.move(new char[tupleBackup.tupleLength()]);
+    tupleBackup.copyForPersistentInsert(tuple);
+    StackCleaner cleaner(tupleBackup);
+    int64_t stringMemory = m_table->nonInlinedMemorySize();
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->truncateTable(true);
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->nonInlinedMemorySize());
+    ASSERT_TRUE(m_table->lookupTuple(tupleBackup).isNullTuple());
+
+    // rows inserted after the truncate go away with it
+    tableutil::addRandomTuples(m_table, 10);
+    ASSERT_EQ(10, m_table->activeTupleCount());
+
+    m_engine->undoUndoToken(INT64_MIN + 2);
+
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    ASSERT_EQ(stringMemory, m_table->nonInlinedMemorySize());
+    ASSERT_FALSE(m_table->lookupTuple(tupleBackup).isNullTuple());
+    ASSERT_EQ(1000, m_table->primaryKeyIndex()->getSize());
+}
+
+TEST_F(PersistentTableLogTest, TruncateWithIndexesThenUndoTest) {
+    initTable(false);
+    // a unique and a non-unique hash index, and a non-unique tree index
+    std::vector<int> columns(1, 1);
+    m_table->addIndex(TableIndexFactory::getInstance(
+        TableIndexScheme("hashKeyIndex", HASH_TABLE_INDEX, m_primaryKeyIndexColumns,
+                         TableIndex::simplyIndexColumns(), true, false, m_tableSchema)));
+    m_table->addIndex(TableIndexFactory::getInstance(
+        TableIndexScheme("hashIndex", HASH_TABLE_INDEX, columns,
+                         TableIndex::simplyIndexColumns(), false, false, m_tableSchema)));
+    m_table->addIndex(TableIndexFactory::getInstance(
+        TableIndexScheme("treeIndex", BALANCED_TREE_INDEX, columns,
+                         TableIndex::simplyIndexColumns(), false, false, m_tableSchema)));
+    tableutil::addRandomTuples(m_table, 1000);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    m_engine->getExecutorContext();
+
+    m_table->truncateTable(true);
+    const std::vector<TableIndex*> &indexes = m_table->allIndexes();
+    for (int i = 0; i < indexes.size(); i++) {
+        ASSERT_EQ(0, indexes[i]->getSize());
+    }
+
+    // index entries added after the truncate go away with it
+    tableutil::addRandomTuples(m_table, 10);
+    voltdb::TableTuple tuple(m_tableSchema);
+    tableutil::getRandomTuple(m_table, tuple);
+    voltdb::TableTuple tupleBackup(m_tableSchema);
+    tupleBackup.move(new char[tupleBackup.tupleLength()]);
+    tupleBackup.copyForPersistentInsert(tuple);
+    StackCleaner cleaner(tupleBackup);
+    for (int i = 0; i < indexes.size(); i++) {
+        ASSERT_EQ(10, indexes[i]->getSize());
+    }
+
+    m_engine->undoUndoToken(INT64_MIN + 2);
+
+    ASSERT_EQ(1000, m_table->activeTupleCount());
+    for (int i = 0; i < indexes.size(); i++) {
+        ASSERT_EQ(1000, indexes[i]->getSize());
+    }
+    ASSERT_FALSE(m_table->index("hashKeyIndex")->exists(&tupleBackup));
+    TableIterator iter = m_table->iterator();
+    while (iter.next(tuple)) {
+        ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
+        ASSERT_TRUE(m_table->index("hashKeyIndex")->exists(&tuple));
+        ASSERT_TRUE(m_table->index("hashIndex")->exists(&tuple));
+        ASSERT_TRUE(m_table->index("treeIndex")->exists(&tuple));
+    }
+
+    // and the restored indexes keep working
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    tableutil::getRandomTuple(m_table, tuple);
+    ASSERT_TRUE(m_table->deleteTuple(tuple, true));
+    for (int i = 0; i < indexes.size(); i++) {
+        ASSERT_EQ(999, indexes[i]->getSize());
+    }
+}
+
+TEST_F(PersistentTableLogTest, TruncateThenReleaseTest) {
+    initTable(false);
+    tableutil::addRandomTuples(m_table, 1000);
+
+    m_engine->setUndoToken(INT64_MIN + 2);
+    // this next line is a testing hack until engine data is
+    // de-duplicated with executorcontext data
+    m_engine->getExecutorContext();
+
+    m_table->truncateTable(true);
+    m_engine->releaseUndoToken(INT64_MIN + 2);
+
+    ASSERT_EQ(0, m_table->activeTupleCount());
+    ASSERT_EQ(0, m_table->primaryKeyIndex()->getSize());
+    ASSERT_EQ(0, m_table->allocatedBlockCount());
+
+    // the table and its index are still usable afterwards
+    m_engine->setUndoToken(INT64_MIN + 3);
+    m_engine->getExecutorContext();
+    tableutil::addRandomTuples(m_table, 100);
+    voltdb::TableTuple tuple(m_tableSchema);
+    tableutil::getRandomTuple(m_table, tuple);
+    ASSERT_FALSE(m_table->lookupTuple(tuple).isNullTuple());
+    ASSERT_EQ(100, m_table->primaryKeyIndex()->getSize());
+}
+
 TEST_F(PersistentTableLogTest, FindBlockTest) {
     initTable(true);
     const int blockSize = m_table->getTableAllocationSize();
@@ -0,0 +1,470 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.h"
+#include "structures/CompactingBTree.h"
+
+using namespace voltdb;
+using namespace std;
+
+class StringComparator {
+public:
+    inline int operator()(const std::string &lhs, const std::string &rhs) const {
+        return lhs.compare(rhs);
+    }
+};
+
+class IntComparator {
+public:
+    inline int operator()(const int &lhs, const int &rhs) const {
+        if (lhs > rhs) return 1;
+        else if (lhs < rhs) return -1;
+        else return 0;
+    }
+};
+
+class CompactingBTreeTest : public Test {
+public:
+    std::string keyFromInt(int i) {
+        char buf[256];
+        snprintf(buf, 256, "%010d", i);
+        std::string val = buf;
+        return val;
+    }
+
+    /*
+     * Walk the tree and the std::multimap side by side. Values of equal
+     * keys must come back in insertion order in both.
+     */
+    template<typename Tree>
+    bool sameContents(Tree &volt, std::multimap<int, int> &stl) {
+        typename Tree::iterator volti = volt.begin();
+        std::multimap<int, int>::iterator stli = stl.begin();
+        for (; stli != stl.end(); stli++, volti.moveNext()) {
+            if (volti.isEnd()) return false;
+            if (volti.key() != stli->first || volti.value() != stli->second) return false;
+        }
+        return volti.isEnd() && volt.size() == (int64_t)stl.size();
+    }
+
+    /* Whether the tree iterator is at the same entry as the multimap's */
+    template<typename Iterator>
+    bool sameEntry(const Iterator &volti, std::multimap<int, int>::iterator stli,
+                   std::multimap<int, int> &stl) {
+        if (stli == stl.end()) return volti.isEnd();
+        return !volti.isEnd() && volti.key() == stli->first && volti.value() == stli->second;
+    }
+
+    /* Check the hinted lookups of every key in [first, last] against the multimap */
+    template<typename Tree>
+    bool hintedLookupsMatch(Tree &volt, std::multimap<int, int> &stl,
+                            const typename Tree::iterator &hint, int first, int last) {
+        for (int key = first; key <= last; key++) {
+            if (!sameEntry(volt.lowerBound(key, hint), stl.lower_bound(key), stl)) return false;
+            if (!sameEntry(volt.upperBound(key, hint), stl.upper_bound(key), stl)) return false;
+            std::pair<typename Tree::iterator, typename Tree::iterator> range = volt.equalRange(key, hint);
+            if (!sameEntry(range.first, stl.lower_bound(key), stl)) return false;
+            if (!sameEntry(range.second, stl.upper_bound(key), stl)) return false;
+        }
+        return true;
+    }
+};
+
+TEST_F(CompactingBTreeTest, Trivial) {
+    voltdb::CompactingBTree<int, int, IntComparator> m(true, IntComparator());
+    ASSERT_TRUE(m.verify());
+    ASSERT_TRUE(m.begin().isEnd());
+    ASSERT_TRUE(m.rbegin().isEnd());
+
+    ASSERT_TRUE(m.insert(std::pair<int,int>(2,2)));
+    ASSERT_TRUE(m.insert(std::pair<int,int>(1,1)));
+    ASSERT_TRUE(m.insert(std::pair<int,int>(3,3)));
+    ASSERT_FALSE(m.insert(std::pair<int,int>(3,4)));
+    ASSERT_TRUE(m.verify());
+    ASSERT_EQ(3, m.size());
+    ASSERT_EQ(1, m.begin().key());
+    ASSERT_EQ(3, m.rbegin().key());
+
+    ASSERT_TRUE(m.erase(2));
+    ASSERT_FALSE(m.erase(2));
+    ASSERT_TRUE(m.erase(1));
+    ASSERT_TRUE(m.erase(3));
+    ASSERT_EQ(0, m.size());
+    ASSERT_EQ(0, m.bytesAllocated());
+    ASSERT_TRUE(m.verify());
+}
+
+TEST_F(CompactingBTreeTest, Bounds) {
+    voltdb::CompactingBTree<int, int, IntComparator> volt(true, IntComparator());
+
+    ASSERT_TRUE(volt.lowerBound(1).isEnd());
+    ASSERT_TRUE(volt.upperBound(1).isEnd());
+
+    for (int i = 1; i <= 999; i += 2)
+        volt.insert(std::pair<int,int>(i,i));
+    ASSERT_TRUE(volt.verify());
+
+    ASSERT_TRUE(volt.lowerBound(999).key() == 999);
+    ASSERT_TRUE(volt.upperBound(999).isEnd());
+    ASSERT_TRUE(volt.lowerBound(1000).isEnd());
+    ASSERT_TRUE(volt.upperBound(0).key() == 1);
+
+    for (int i = 0; i <= 998; i += 2) {
+        ASSERT_TRUE(volt.upperBound(i).key() == i + 1);
+        ASSERT_TRUE(volt.lowerBound(i).key() == i + 1);
+    }
+    for (int i = 1; i <= 997; i += 2) {
+        ASSERT_TRUE(volt.upperBound(i).key() == i + 2);
+        ASSERT_TRUE(volt.lowerBound(i).key() == i);
+    }
+
+    // duplicate runs spanning several leaves
+    voltdb::CompactingBTree<int, int, IntComparator> volt2(false, IntComparator());
+    for (int i = 0; i < 200; i++) {
+        volt2.insert(std::pair<int,int>(1, i));
+        volt2.insert(std::pair<int,int>(3, i));
+    }
+    volt2.insert(std::pair<int,int>(2, 2));
+    ASSERT_TRUE(volt2.verify());
+
+    std::pair<voltdb::CompactingBTree<int, int, IntComparator>::iterator,
+              voltdb::CompactingBTree<int, int, IntComparator>::iterator> p;
+    p = volt2.equalRange(1);
+    int n = 0;
+    for (; !p.first.equals(p.second); p.first.moveNext(), n++) {
+        ASSERT_EQ(n, p.first.value());
+    }
+    ASSERT_EQ(200, n);
+    ASSERT_EQ(2, p.second.value());
+
+    p = volt2.equalRange(3);
+    ASSERT_EQ(0, p.first.value());
+    ASSERT_TRUE(p.second.isEnd());
+
+    // walk backwards across leaves
+    voltdb::CompactingBTree<int, int, IntComparator>::iterator iter = volt2.rbegin();
+    for (n = 199; n >= 0; n--, iter.movePrev()) {
+        ASSERT_EQ(3, iter.key());
+        ASSERT_EQ(n, iter.value());
+    }
+    ASSERT_EQ(2, iter.key());
+}
+
+TEST_F(CompactingBTreeTest, Strings) {
+    const int ITERATIONS = 5000;
+    voltdb::CompactingBTree<std::string, std::string, StringComparator> volt(true, StringComparator());
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        volt.insert(std::pair<std::string,std::string>(keyFromInt(i), keyFromInt(i)));
+        voltdb::CompactingBTree<std::string, std::string, StringComparator>::iterator iter = volt.find(keyFromInt(i / 2));
+        ASSERT_TRUE(!iter.isEnd());
+        ASSERT_TRUE(iter.value().compare(keyFromInt(i / 2)) == 0);
+    }
+    ASSERT_TRUE(volt.verify());
+
+    for (int i = 0; i < ITERATIONS; i += 2) {
+        ASSERT_TRUE(volt.erase(keyFromInt(i)));
+        ASSERT_TRUE(volt.find(keyFromInt(i)).isEnd());
+    }
+    ASSERT_TRUE(volt.verify());
+
+    voltdb::CompactingBTree<std::string, std::string, StringComparator>::iterator iter = volt.begin();
+    for (int i = 1; i < ITERATIONS; i += 2, iter.moveNext()) {
+        ASSERT_TRUE(!iter.isEnd());
+        ASSERT_TRUE(iter.value().compare(keyFromInt(i)) == 0);
+    }
+    ASSERT_TRUE(iter.isEnd());
+}
+
+TEST_F(CompactingBTreeTest, RandomMulti) {
+    const int ITERATIONS = 20000;
+    const int BIGGEST_VAL = 500;
+
+    std::multimap<int,int> stl;
+    voltdb::CompactingBTree<int, int, IntComparator, true> volt(false, IntComparator());
+
+    srand(0);
+    for (int i = 0; i < ITERATIONS; i++) {
+        // grow for a while, then shrink, so both splits and merges happen
+        int insertPct = (i < ITERATIONS / 2) ? 70 : 30;
+        int val = rand() % BIGGEST_VAL;
+        if (rand() % 100 < insertPct) {
+            stl.insert(std::pair<int,int>(val, i));
+            volt.insert(std::pair<int,int>(val, i));
+        }
+        else {
+            std::multimap<int,int>::iterator stli = stl.find(val);
+            voltdb::CompactingBTree<int, int, IntComparator, true>::iterator volti = volt.find(val);
+            ASSERT_EQ(stli == stl.end(), volti.isEnd());
+            if (stli != stl.end()) {
+                // both erase the first of the equal keys
+                ASSERT_EQ(stli->second, volti.value());
+                stl.erase(stli);
+                volt.erase(volti);
+            }
+        }
+        if (i % 1000 == 0) {
+            ASSERT_TRUE(volt.verify());
+            ASSERT_TRUE(volt.verifyRank());
+            ASSERT_TRUE(sameContents(volt, stl));
+        }
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+    ASSERT_TRUE(sameContents(volt, stl));
+
+    while (!stl.empty()) {
+        int val = stl.begin()->first;
+        stl.erase(stl.begin());
+        ASSERT_TRUE(volt.erase(val));
+    }
+    ASSERT_EQ(0, volt.size());
+    ASSERT_TRUE(volt.verify());
+}
+
+TEST_F(CompactingBTreeTest, RankUnique) {
+    const int ITERATIONS = 10000;
+    voltdb::CompactingBTree<int, int, IntComparator, true> volt(true, IntComparator());
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        volt.insert(std::pair<int,int>(i * 2, i));
+    }
+    ASSERT_TRUE(volt.verifyRank());
+    for (int i = 0; i < ITERATIONS; i++) {
+        ASSERT_EQ(i + 1, volt.rankAsc(i * 2));
+        ASSERT_EQ(i + 1, volt.rankUpper(i * 2));
+        ASSERT_EQ(-1, volt.rankAsc(i * 2 + 1));
+        ASSERT_EQ(i * 2, volt.findRank(i + 1).key());
+    }
+    ASSERT_TRUE(volt.findRank(0).isEnd());
+    ASSERT_TRUE(volt.findRank(ITERATIONS + 1).isEnd());
+
+    // deleting from the front shifts every rank
+    for (int i = 0; i < ITERATIONS / 2; i++) {
+        ASSERT_TRUE(volt.erase(i * 2));
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.verifyRank());
+    ASSERT_EQ(1, volt.rankAsc(ITERATIONS));
+}
+
+TEST_F(CompactingBTreeTest, Compaction) {
+    const int ITERATIONS = 100000;
+    voltdb::CompactingBTree<int, int, IntComparator> volt(true, IntComparator());
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        volt.insert(std::pair<int,int>(i, i));
+    }
+    size_t full = volt.bytesAllocated();
+
+    // delete 9 out of every 10 keys, merges must hand the memory back
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (i % 10 != 0) {
+            ASSERT_TRUE(volt.erase(i));
+        }
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(volt.bytesAllocated() < full / 2);
+
+    voltdb::CompactingBTree<int, int, IntComparator>::iterator iter = volt.begin();
+    for (int i = 0; i < ITERATIONS; i += 10, iter.moveNext()) {
+        ASSERT_EQ(i, iter.key());
+    }
+    ASSERT_TRUE(iter.isEnd());
+}
+
+TEST_F(CompactingBTreeTest, BulkLoad) {
+    // sizes around one leaf, one level of inner nodes and several levels
+    const int sizes[] = { 0, 1, 2, 31, 32, 33, 1000, 100000 };
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const int count = sizes[s];
+        std::vector<std::pair<int, int> > entries;
+        std::multimap<int, int> stl;
+        for (int i = 0; i < count; i++) {
+            // each key three times in a row
+            entries.push_back(std::pair<int, int>(i / 3, i));
+            stl.insert(entries.back());
+        }
+        voltdb::CompactingBTree<int, int, IntComparator, true> volt(false, IntComparator());
+        volt.bulkLoad(count == 0 ? NULL : &entries[0], count);
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+        ASSERT_TRUE(sameContents(volt, stl));
+
+        // the loaded tree takes ordinary inserts and deletes
+        srand(s);
+        for (int i = 0; i < count; i++) {
+            int val = rand() % (count / 3 + 1);
+            if (rand() % 2) {
+                stl.insert(std::pair<int, int>(val, count + i));
+                volt.insert(std::pair<int, int>(val, count + i));
+            }
+            else if (stl.find(val) != stl.end()) {
+                stl.erase(stl.find(val));
+                voltdb::CompactingBTree<int, int, IntComparator, true>::iterator volti = volt.find(val);
+                volt.erase(volti);
+            }
+        }
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+        ASSERT_TRUE(sameContents(volt, stl));
+    }
+
+    const int ITERATIONS = 10000;
+    std::vector<std::pair<int, int> > entries;
+    for (int i = 0; i < ITERATIONS; i++) {
+        entries.push_back(std::pair<int, int>(i * 2, i));
+    }
+    voltdb::CompactingBTree<int, int, IntComparator> volt(true, IntComparator());
+    volt.bulkLoad(&entries[0], ITERATIONS);
+    ASSERT_TRUE(volt.verify());
+    ASSERT_FALSE(volt.insert(std::pair<int, int>(10, 0)));
+    ASSERT_TRUE(volt.insert(std::pair<int, int>(11, 0)));
+    for (int i = 0; i < ITERATIONS; i++) {
+        ASSERT_EQ(i, volt.find(i * 2).value());
+    }
+    ASSERT_TRUE(volt.verify());
+}
+
+TEST_F(CompactingBTreeTest, Swap) {
+    voltdb::CompactingBTree<int, int, IntComparator, true> full(false, IntComparator());
+    voltdb::CompactingBTree<int, int, IntComparator, true> empty(false, IntComparator());
+    for (int i = 0; i < 1000; i++) {
+        full.insert(std::pair<int, int>(i / 2, i));
+    }
+    full.swap(empty);
+    ASSERT_EQ(0, full.size());
+    ASSERT_TRUE(full.begin().isEnd());
+    ASSERT_TRUE(full.find(0).isEnd());
+    ASSERT_EQ(1000, empty.size());
+    ASSERT_TRUE(empty.verify());
+    ASSERT_TRUE(empty.verifyRank());
+
+    // both keep working on their own, and the entries swap back unchanged
+    full.insert(std::pair<int, int>(1000, 0));
+    ASSERT_TRUE(empty.erase(0));
+    full.swap(empty);
+    ASSERT_EQ(999, full.size());
+    ASSERT_EQ(1, empty.size());
+    ASSERT_FALSE(full.find(0).isEnd());
+    ASSERT_TRUE(full.find(500).isEnd());
+    ASSERT_EQ(0, empty.find(1000).value());
+    ASSERT_TRUE(full.verify());
+    ASSERT_TRUE(full.verifyRank());
+    ASSERT_TRUE(empty.verify());
+}
+
+TEST_F(CompactingBTreeTest, HintedBounds) {
+    typedef voltdb::CompactingBTree<int, int, IntComparator> Tree;
+    const int BIGGEST_KEY = 600;
+    std::multimap<int, int> stl;
+    Tree volt(false, IntComparator());
+
+    ASSERT_TRUE(volt.lowerBound(1, Tree::iterator()).isEnd());
+    ASSERT_TRUE(volt.equalRange(1, Tree::iterator()).second.isEnd());
+
+    // even keys only, every seventh repeated often enough to span leaves
+    int n = 0;
+    for (int key = 0; key <= BIGGEST_KEY; key += 2) {
+        int copies = (key % 14 == 0) ? 150 : 1 + key % 3;
+        for (int i = 0; i < copies; i++, n++) {
+            stl.insert(std::pair<int, int>(key, n));
+            volt.insert(std::pair<int, int>(key, n));
+        }
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(sameContents(volt, stl));
+
+    // hints anywhere (in the middle of a leaf, at either end of one, and
+    // inside runs of equal keys) give the same answers as no hint, for
+    // keys in the hint's leaf, the next one, and anywhere else
+    ASSERT_TRUE(hintedLookupsMatch(volt, stl, Tree::iterator(), -1, BIGGEST_KEY + 1));
+    ASSERT_TRUE(hintedLookupsMatch(volt, stl, volt.begin(), -1, BIGGEST_KEY + 1));
+    ASSERT_TRUE(hintedLookupsMatch(volt, stl, volt.rbegin(), -1, BIGGEST_KEY + 1));
+    for (int key = -1; key <= BIGGEST_KEY + 1; key++) {
+        ASSERT_TRUE(hintedLookupsMatch(volt, stl, volt.lowerBound(key), -1, BIGGEST_KEY + 1));
+        ASSERT_TRUE(hintedLookupsMatch(volt, stl, volt.upperBound(key), -1, BIGGEST_KEY + 1));
+    }
+    // every entry of a long run of equal keys, each in its own position of a leaf
+    Tree::iterator hint = volt.lowerBound(14);
+    for (int i = 0; i < 150; i++, hint.moveNext()) {
+        ASSERT_TRUE(hintedLookupsMatch(volt, stl, hint, 12, 18));
+    }
+}
+
+TEST_F(CompactingBTreeTest, HintedBoundsAcrossChanges) {
+    typedef voltdb::CompactingBTree<int, int, IntComparator> Tree;
+    const int ITERATIONS = 20000;
+    const int BIGGEST_VAL = 500;
+    std::multimap<int, int> stl;
+    Tree volt(false, IntComparator());
+
+    // Probes mostly in key order, each hinted by the one before, between
+    // inserts and deletes that split and merge leaves. A change invalidates
+    // the hint, so a probe after one starts again from an end iterator, as
+    // a tree index's cursor does.
+    srand(0);
+    Tree::iterator hint;
+    int key = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        int insertPct = (i < ITERATIONS / 2) ? 70 : 30;
+        int val = rand() % BIGGEST_VAL;
+        if (rand() % 3 == 0) {
+            if (rand() % 100 < insertPct) {
+                stl.insert(std::pair<int, int>(val, i));
+                volt.insert(std::pair<int, int>(val, i));
+            }
+            else {
+                std::multimap<int, int>::iterator stli = stl.find(val);
+                Tree::iterator volti = volt.find(val);
+                ASSERT_EQ(stli == stl.end(), volti.isEnd());
+                if (stli != stl.end()) {
+                    stl.erase(stli);
+                    volt.erase(volti);
+                }
+            }
+            hint = Tree::iterator();
+        }
+        else {
+            // mostly short steps forward, sometimes a jump anywhere
+            key = (rand() % 8 == 0) ? rand() % BIGGEST_VAL : (key + rand() % 3) % BIGGEST_VAL;
+            std::pair<Tree::iterator, Tree::iterator> range = volt.equalRange(key, hint);
+            ASSERT_TRUE(sameEntry(range.first, stl.lower_bound(key), stl));
+            ASSERT_TRUE(sameEntry(range.second, stl.upper_bound(key), stl));
+            ASSERT_TRUE(sameEntry(volt.lowerBound(key + 1, range.first), stl.lower_bound(key + 1), stl));
+            hint = range.first.isEnd() ? Tree::iterator() : range.first;
+        }
+    }
+    ASSERT_TRUE(volt.verify());
+    ASSERT_TRUE(sameContents(volt, stl));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
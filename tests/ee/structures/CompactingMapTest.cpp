@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
 #include <algorithm>
 #include <cstdlib>
 #include <cstdio>
@@ -755,6 +756,91 @@ TEST_F(CompactingMapTest, RandomMulti) {
     // std::cout << "UpperBounds: " << upperBounds << " ub greatest chain: " << ub_greatestChain << std::endl;
 }
 
+TEST_F(CompactingMapTest, BulkLoad) {
+    const int sizes[] = { 0, 1, 2, 3, 4, 7, 8, 1000, 100000 };
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const int count = sizes[s];
+        std::vector<std::pair<int, int> > entries;
+        std::multimap<int, int> stl;
+        for (int i = 0; i < count; i++) {
+            // each key three times in a row
+            entries.push_back(std::pair<int, int>(i / 3, i));
+            stl.insert(entries.back());
+        }
+        voltdb::CompactingMap<int, int, IntComparator, true> volt(false, IntComparator());
+        volt.bulkLoad(count == 0 ? NULL : &entries[0], count);
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+        ASSERT_EQ(count, volt.size());
+
+        // the loaded tree takes ordinary inserts and deletes
+        srand(s);
+        for (int i = 0; i < count; i++) {
+            int val = rand() % (count / 3 + 1);
+            if (rand() % 2) {
+                stl.insert(std::pair<int, int>(val, count + i));
+                volt.insert(std::pair<int, int>(val, count + i));
+            }
+            else if (stl.find(val) != stl.end()) {
+                stl.erase(stl.find(val));
+                ASSERT_TRUE(volt.erase(val));
+            }
+        }
+        ASSERT_TRUE(volt.verify());
+        ASSERT_TRUE(volt.verifyRank());
+        voltdb::CompactingMap<int, int, IntComparator, true>::iterator volti = volt.begin();
+        for (std::multimap<int, int>::iterator stli = stl.begin(); stli != stl.end();
+             stli++, volti.moveNext()) {
+            ASSERT_FALSE(volti.isEnd());
+            ASSERT_EQ(stli->first, volti.key());
+        }
+        ASSERT_TRUE(volti.isEnd());
+    }
+
+    const int ITERATIONS = 10000;
+    std::vector<std::pair<int, int> > entries;
+    for (int i = 0; i < ITERATIONS; i++) {
+        entries.push_back(std::pair<int, int>(i * 2, i));
+    }
+    voltdb::CompactingMap<int, int, IntComparator> volt(true, IntComparator());
+    volt.bulkLoad(&entries[0], ITERATIONS);
+    ASSERT_TRUE(volt.verify());
+    ASSERT_FALSE(volt.insert(std::pair<int, int>(10, 0)));
+    ASSERT_TRUE(volt.insert(std::pair<int, int>(11, 0)));
+    for (int i = 0; i < ITERATIONS; i++) {
+        ASSERT_EQ(i, volt.find(i * 2).value());
+    }
+    ASSERT_TRUE(volt.verify());
+}
+
+TEST_F(CompactingMapTest, Swap) {
+    voltdb::CompactingMap<int, int, IntComparator, true> full(false, IntComparator());
+    voltdb::CompactingMap<int, int, IntComparator, true> empty(false, IntComparator());
+    for (int i = 0; i < 1000; i++) {
+        full.insert(std::pair<int, int>(i / 2, i));
+    }
+    full.swap(empty);
+    ASSERT_EQ(0, full.size());
+    ASSERT_TRUE(full.begin().isEnd());
+    ASSERT_TRUE(full.find(0).isEnd());
+    ASSERT_EQ(1000, empty.size());
+    ASSERT_TRUE(empty.verify());
+    ASSERT_TRUE(empty.verifyRank());
+
+    // both keep working on their own, and the entries swap back unchanged
+    full.insert(std::pair<int, int>(1000, 0));
+    ASSERT_TRUE(empty.erase(0));
+    full.swap(empty);
+    ASSERT_EQ(999, full.size());
+    ASSERT_EQ(1, empty.size());
+    ASSERT_FALSE(full.find(0).isEnd());
+    ASSERT_TRUE(full.find(500).isEnd());
+    ASSERT_EQ(0, empty.find(1000).value());
+    ASSERT_TRUE(full.verify());
+    ASSERT_TRUE(full.verifyRank());
+    ASSERT_TRUE(empty.verify());
+}
+
 // ENG-1057
 //
 // I have commented this out intentionally.  It demonstrates that the
@@ -0,0 +1,223 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Timings of hash aggregation group lookups with the boost::unordered_map
+ * the hash aggregate executor used to use and with FlatHashMap, keyed by
+ * pool-backed group key tuples as well as by plain integers. Every variant
+ * counts the rows of each group, and all must agree.
+ *
+ * The 1K and 100K group runs are part of the test suite; pass "large" on
+ * the command line to add the 10M group run.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/time.h>
+#include "harness.h"
+#include "boost/unordered_map.hpp"
+#include "structures/FlatHashMap.h"
+#include "common/NValue.hpp"
+#include "common/Pool.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/TupleSchema.h"
+#include "common/tabletuple.h"
+#include "common/ThreadLocalPool.h"
+
+using namespace voltdb;
+
+static const int64_t MIN_ROWS = 1000000;
+static bool s_large = false;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+class FlatHashMapBenchmark : public Test {
+public:
+    FlatHashMapBenchmark() {
+        std::vector<ValueType> columnTypes(1, VALUE_TYPE_BIGINT);
+        std::vector<int32_t> columnLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        std::vector<bool> columnAllowNull(1, true);
+        m_keySchema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    }
+
+    ~FlatHashMapBenchmark() {
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+
+    /*
+     * Fill rows with group by values drawn from groups distinct values in
+     * random order, each of which appears at least once.
+     */
+    void makeRows(int64_t groups, std::vector<int64_t> &rows) {
+        int64_t count = groups * 2 > MIN_ROWS ? groups * 2 : MIN_ROWS;
+        rows.resize(count);
+        srand(0);
+        for (int64_t i = 0; i < count; i++) {
+            // spread the group ids out over the BIGINT range
+            int64_t group = i < groups ? i : (((int64_t)rand() << 16) ^ rand()) % groups;
+            rows[i] = group * 2654435761LL - groups;
+        }
+        for (int64_t i = count - 1; i > 0; i--) {
+            std::swap(rows[i], rows[(((int64_t)rand() << 16) ^ rand()) % (i + 1)]);
+        }
+    }
+
+    void report(const char *name, int64_t start, int64_t groups) {
+        printf("  %-28s %6lld ms  %10lld groups\n",
+               name, (long long)(nowMicros() - start) / 1000, (long long)groups);
+    }
+
+    /*
+     * Count the rows of each group with tuple keys, the way the hash
+     * aggregate executor does: the candidate key is built in pool storage
+     * and handed over to the map when it starts a new group.
+     */
+    template<typename MapType>
+    uint64_t countWithTupleKeys(const char *name, const std::vector<int64_t> &rows) {
+        Pool pool;
+        MapType map;
+        TableTuple key(m_keySchema);
+        int64_t start = nowMicros();
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (key.isNullTuple()) {
+                key.move(pool.allocate(key.tupleLength()));
+            }
+            key.setNValue(0, ValueFactory::getBigIntValue(rows[i]));
+            if (addRow(map, key)) {
+                key.move(NULL);
+            }
+        }
+        report(name, start, map.size());
+        return checksum(map);
+    }
+
+    bool addRow(boost::unordered_map<TableTuple, int64_t,
+                                     TableTupleHasher, TableTupleEqualityChecker> &map,
+                const TableTuple &key) {
+        typedef boost::unordered_map<TableTuple, int64_t,
+                                     TableTupleHasher, TableTupleEqualityChecker> MapType;
+        MapType::iterator iter = map.find(key);
+        if (iter == map.end()) {
+            map.insert(MapType::value_type(key, 1));
+            return true;
+        }
+        ++iter->second;
+        return false;
+    }
+
+    template<typename Key, typename Hasher, typename KeyEqChecker>
+    bool addRow(FlatHashMap<Key, int64_t, Hasher, KeyEqChecker> &map, const Key &key) {
+        bool inserted;
+        ++map.findOrInsert(key, 0, inserted);
+        return inserted;
+    }
+
+    uint64_t checksum(boost::unordered_map<TableTuple, int64_t,
+                                          TableTupleHasher, TableTupleEqualityChecker> &map) {
+        uint64_t sum = 0;
+        for (boost::unordered_map<TableTuple, int64_t,
+                                  TableTupleHasher, TableTupleEqualityChecker>::iterator iter = map.begin();
+             iter != map.end(); ++iter) {
+            sum += (uint64_t)iter->second * (uint64_t)ValuePeeker::peekAsBigInt(iter->first.getNValue(0));
+        }
+        return sum;
+    }
+
+    uint64_t checksum(FlatHashMap<TableTuple, int64_t,
+                                 TableTupleHasher, TableTupleEqualityChecker> &map) {
+        uint64_t sum = 0;
+        for (FlatHashMap<TableTuple, int64_t, TableTupleHasher,
+                         TableTupleEqualityChecker>::iterator iter = map.begin();
+             !iter.isEnd(); iter.moveNext()) {
+            sum += (uint64_t)iter.value() * (uint64_t)ValuePeeker::peekAsBigInt(iter.key().getNValue(0));
+        }
+        return sum;
+    }
+
+    uint64_t countWithIntKeys(const char *name, const std::vector<int64_t> &rows) {
+        FlatHashMap<int64_t, int64_t, Int64Hasher, std::equal_to<int64_t> > map;
+        int64_t start = nowMicros();
+        for (size_t i = 0; i < rows.size(); i++) {
+            addRow(map, rows[i]);
+        }
+        report(name, start, map.size());
+
+        uint64_t sum = 0;
+        for (FlatHashMap<int64_t, int64_t, Int64Hasher, std::equal_to<int64_t> >::iterator iter = map.begin();
+             !iter.isEnd(); iter.moveNext()) {
+            sum += (uint64_t)iter.value() * (uint64_t)iter.key();
+        }
+        return sum;
+    }
+
+    void compare(int64_t groups) {
+        std::vector<int64_t> rows;
+        makeRows(groups, rows);
+        printf("%lld groups, %lld rows\n", (long long)groups, (long long)rows.size());
+
+        // sums wrap around identically whichever map counted the groups
+        uint64_t expected = 0;
+        for (size_t i = 0; i < rows.size(); i++) {
+            expected += (uint64_t)rows[i];
+        }
+
+        typedef boost::unordered_map<TableTuple, int64_t,
+                                     TableTupleHasher, TableTupleEqualityChecker> UnorderedMapType;
+        typedef FlatHashMap<TableTuple, int64_t,
+                            TableTupleHasher, TableTupleEqualityChecker> FlatMapType;
+        ASSERT_EQ(expected, countWithTupleKeys<UnorderedMapType>("unordered_map, tuple keys", rows));
+        ASSERT_EQ(expected, countWithTupleKeys<FlatMapType>("FlatHashMap, tuple keys", rows));
+        ASSERT_EQ(expected, countWithIntKeys("FlatHashMap, integer keys", rows));
+    }
+
+    ThreadLocalPool m_pool;
+    TupleSchema *m_keySchema;
+};
+
+TEST_F(FlatHashMapBenchmark, Groups1K) {
+    compare(1000);
+}
+
+TEST_F(FlatHashMapBenchmark, Groups100K) {
+    compare(100000);
+}
+
+TEST_F(FlatHashMapBenchmark, Groups10M) {
+    if (!s_large) {
+        printf("skipped; run with \"large\" to include it\n");
+        return;
+    }
+    compare(10000000);
+}
+
+int main(int argc, char **argv) {
+    s_large = (argc > 1 && strcmp(argv[1], "large") == 0);
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,205 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <functional>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include "harness.h"
+#include "structures/FlatHashMap.h"
+
+using namespace voltdb;
+using namespace std;
+
+typedef FlatHashMap<int64_t, int64_t, Int64Hasher, equal_to<int64_t> > IntMap;
+
+// every key in a few buckets, so that runs of colliding keys wrap around
+// the end of the slots and overlap one another
+struct CollidingHasher {
+    uint64_t operator()(int64_t key) const { return (key % 3) * 2 + 13; }
+};
+
+typedef FlatHashMap<int64_t, int64_t, CollidingHasher, equal_to<int64_t> > CollidingMap;
+
+class FlatHashMapTest : public Test {
+public:
+    // every entry of the map is expected, and every expected key is in the map
+    template<typename MapType>
+    bool sameContents(MapType &map, const std::map<int64_t, int64_t> &expected) {
+        if (map.size() != expected.size()) {
+            return false;
+        }
+        uint64_t count = 0;
+        for (typename MapType::iterator iter = map.begin(); !iter.isEnd(); iter.moveNext()) {
+            std::map<int64_t, int64_t>::const_iterator found = expected.find(iter.key());
+            if (found == expected.end() || found->second != iter.value()) {
+                return false;
+            }
+            count++;
+        }
+        for (std::map<int64_t, int64_t>::const_iterator iter = expected.begin();
+             iter != expected.end(); ++iter) {
+            const int64_t *value = map.find(iter->first);
+            if (value == NULL || *value != iter->second) {
+                return false;
+            }
+        }
+        return count == expected.size();
+    }
+};
+
+TEST_F(FlatHashMapTest, Trivial) {
+    IntMap map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.begin().isEnd());
+    ASSERT_TRUE(map.find(1) == NULL);
+    ASSERT_FALSE(map.erase(1));
+
+    bool inserted;
+    ASSERT_EQ(10, map.findOrInsert(1, 10, inserted));
+    ASSERT_TRUE(inserted);
+    map.findOrInsert(1, 11, inserted) = 12;
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(12, *map.find(1));
+    ASSERT_EQ(1, map.size());
+    ASSERT_EQ(IntMap::MIN_CAPACITY, map.capacity());
+
+    ASSERT_TRUE(map.erase(1));
+    ASSERT_FALSE(map.erase(1));
+    ASSERT_TRUE(map.find(1) == NULL);
+    ASSERT_TRUE(map.begin().isEnd());
+    ASSERT_EQ(0, map.size());
+}
+
+TEST_F(FlatHashMapTest, Grow) {
+    IntMap map;
+    std::map<int64_t, int64_t> expected;
+    bool inserted;
+    uint64_t capacity = 0;
+    for (int64_t i = 0; i < 100000; i++) {
+        map.findOrInsert(i * 7919, i, inserted);
+        ASSERT_TRUE(inserted);
+        expected[i * 7919] = i;
+        // the table doubles and never fills past the load factor
+        if (map.capacity() != capacity) {
+            ASSERT_TRUE(capacity == 0 || map.capacity() == capacity * 2);
+            capacity = map.capacity();
+        }
+        ASSERT_TRUE(map.size() * 100 < map.capacity() * IntMap::MAX_LOAD_FACTOR);
+    }
+    ASSERT_TRUE(sameContents(map, expected));
+
+    // a reserved table takes that many entries without growing
+    IntMap reserved;
+    reserved.reserve(100000);
+    capacity = reserved.capacity();
+    for (int64_t i = 0; i < 100000; i++) {
+        reserved.findOrInsert(i, i, inserted);
+    }
+    ASSERT_EQ(capacity, reserved.capacity());
+}
+
+TEST_F(FlatHashMapTest, Erase) {
+    IntMap map;
+    std::map<int64_t, int64_t> expected;
+    bool inserted;
+    srand(0);
+    for (int i = 0; i < 200000; i++) {
+        const int64_t key = rand() % 5000;
+        if (rand() % 3 != 0) {
+            map.findOrInsert(key, key * 3, inserted);
+            ASSERT_EQ(expected.count(key) == 0, inserted);
+            expected[key] = key * 3;
+        } else {
+            ASSERT_EQ(expected.erase(key) == 1, map.erase(key));
+        }
+    }
+    ASSERT_TRUE(sameContents(map, expected));
+
+    for (std::map<int64_t, int64_t>::iterator iter = expected.begin(); iter != expected.end(); ++iter) {
+        ASSERT_TRUE(map.erase(iter->first));
+    }
+    ASSERT_TRUE(map.empty());
+    ASSERT_TRUE(map.begin().isEnd());
+}
+
+TEST_F(FlatHashMapTest, CollidingHashes) {
+    CollidingMap map;
+    std::map<int64_t, int64_t> expected;
+    bool inserted;
+    for (int64_t i = 0; i < 11; i++) {
+        map.findOrInsert(i, i, inserted);
+        expected[i] = i;
+    }
+    ASSERT_EQ(CollidingMap::MIN_CAPACITY, map.capacity());
+    ASSERT_TRUE(sameContents(map, expected));
+
+    // erasing from the middle and the ends of the runs leaves every other
+    // key where its probe finds it
+    for (int64_t i = 0; i < 11; i += 2) {
+        ASSERT_TRUE(map.erase(i));
+        expected.erase(i);
+        ASSERT_TRUE(sameContents(map, expected));
+        ASSERT_FALSE(map.erase(i));
+    }
+    for (int64_t i = 100; i < 110; i++) {
+        map.findOrInsert(i, i, inserted);
+        ASSERT_TRUE(inserted);
+        expected[i] = i;
+        ASSERT_TRUE(sameContents(map, expected));
+    }
+}
+
+TEST_F(FlatHashMapTest, Reset) {
+    IntMap map;
+    bool inserted;
+    for (int64_t i = 0; i < 1000; i++) {
+        map.findOrInsert(i, i, inserted);
+    }
+    const uint64_t capacity = map.capacity();
+
+    // small enough to keep: the slots are reused, empty
+    map.reset(capacity);
+    ASSERT_EQ(0, map.size());
+    ASSERT_EQ(capacity, map.capacity());
+    ASSERT_TRUE(map.begin().isEnd());
+    ASSERT_TRUE(map.find(5) == NULL);
+    for (int64_t i = 0; i < 100; i++) {
+        map.findOrInsert(i * 2, i, inserted);
+        ASSERT_TRUE(inserted);
+    }
+    ASSERT_EQ(100, map.size());
+    ASSERT_EQ(capacity, map.capacity());
+    ASSERT_EQ(7, *map.find(14));
+
+    // too large to keep: the slots are released
+    map.reset(capacity / 2);
+    ASSERT_EQ(0, map.size());
+    ASSERT_EQ(0, map.capacity());
+    map.findOrInsert(3, 3, inserted);
+    ASSERT_EQ(1, map.size());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,230 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <sys/time.h>
+#include "harness.h"
+#include "structures/CompactingHashTable.h"
+#include "structures/ProbingHashTable.h"
+
+using namespace voltdb;
+using namespace std;
+
+static int64_t nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// a poor hash, to make sure the table mixes it before using it
+struct IdentityHasher {
+    size_t operator()(int64_t key) const { return static_cast<size_t>(key); }
+};
+
+typedef ProbingHashTable<int64_t, int64_t, IdentityHasher> IntTable;
+
+class ProbingHashTableTest : public Test {
+public:
+    int64_t randomKey(int64_t range) {
+        return (((int64_t)rand() << 16) ^ rand()) % range;
+    }
+};
+
+TEST_F(ProbingHashTableTest, Trivial) {
+    IntTable table;
+    ASSERT_TRUE(table.find(1).isEnd());
+    ASSERT_FALSE(table.erase(1));
+    ASSERT_TRUE(table.insert(1, 10));
+    ASSERT_FALSE(table.insert(1, 11));
+    IntTable::iterator iter = table.find(1);
+    ASSERT_FALSE(iter.isEnd());
+    ASSERT_EQ(10, iter.value());
+    iter.setValue(12);
+    ASSERT_EQ(12, table.find(1).value());
+    ASSERT_EQ(1, table.size());
+    ASSERT_TRUE(table.erase(iter));
+    ASSERT_TRUE(table.find(1).isEnd());
+    ASSERT_EQ(0, table.size());
+    ASSERT_TRUE(table.verify());
+}
+
+TEST_F(ProbingHashTableTest, Strings) {
+    ProbingHashTable<string, int> table;
+    char buf[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "key %010d", i);
+        ASSERT_TRUE(table.insert(buf, i));
+    }
+    for (int i = 0; i < 5000; i += 2) {
+        snprintf(buf, sizeof(buf), "key %010d", i);
+        ASSERT_TRUE(table.erase(buf));
+    }
+    ASSERT_TRUE(table.verify());
+    for (int i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "key %010d", i);
+        ProbingHashTable<string, int>::iterator iter = table.find(buf);
+        ASSERT_EQ(i % 2 == 0, iter.isEnd());
+        if (i % 2 != 0) {
+            ASSERT_EQ(i, iter.value());
+        }
+    }
+}
+
+TEST_F(ProbingHashTableTest, Fuzz) {
+    IntTable table;
+    map<int64_t, int64_t> expected;
+    srand(0);
+    for (int round = 0; round < 6; round++) {
+        // alternately fill up and empty out, so the table grows and shrinks
+        const bool growing = round % 2 == 0;
+        for (int i = 0; i < 100000; i++) {
+            const int64_t key = randomKey(200000);
+            if (rand() % 100 < (growing ? 80 : 20)) {
+                const bool inserted = table.insert(key, key * 3);
+                ASSERT_EQ(expected.count(key) == 0, inserted);
+                expected.insert(make_pair(key, key * 3));
+            } else {
+                ASSERT_EQ(expected.erase(key) == 1, table.erase(key));
+            }
+            if (i % 10007 == 0) {
+                ASSERT_TRUE(table.verify());
+            }
+        }
+        ASSERT_EQ(expected.size(), table.size());
+        ASSERT_TRUE(table.verify());
+        for (map<int64_t, int64_t>::iterator iter = expected.begin(); iter != expected.end(); ++iter) {
+            IntTable::iterator found = table.find(iter->first);
+            ASSERT_FALSE(found.isEnd());
+            ASSERT_EQ(iter->second, found.value());
+        }
+    }
+
+    // delete everything, which shrinks the table back down
+    for (map<int64_t, int64_t>::iterator iter = expected.begin(); iter != expected.end(); ++iter) {
+        ASSERT_TRUE(table.erase(iter->first));
+    }
+    ASSERT_EQ(0, table.size());
+    ASSERT_TRUE(table.verify());
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(table.insert(i, i));
+    }
+    ASSERT_TRUE(table.bytesAllocated() < 64 * 1024);
+    table.clear();
+    ASSERT_EQ(0, table.size());
+    ASSERT_EQ(0, table.bytesAllocated());
+    ASSERT_TRUE(table.find(5).isEnd());
+}
+
+/*
+ * A resize is spread over many inserts, and every key can be found and
+ * deleted while it is going on.
+ */
+TEST_F(ProbingHashTableTest, IncrementalResize) {
+    IntTable table;
+    int64_t key = 0;
+    while (!table.isResizing() || table.size() < 10000) {
+        ASSERT_TRUE(table.insert(key, key));
+        key++;
+    }
+    int inserts = 0;
+    while (table.isResizing()) {
+        ASSERT_TRUE(table.insert(key, key));
+        key++;
+        inserts++;
+        if (inserts % 97 == 0) {
+            ASSERT_TRUE(table.erase(key / 2));
+            ASSERT_TRUE(table.insert(key / 2, key / 2));
+            ASSERT_TRUE(table.verify());
+        }
+    }
+    ASSERT_TRUE(inserts > 100);
+    ASSERT_TRUE(table.verify());
+    for (int64_t ii = 0; ii < key; ii++) {
+        ASSERT_FALSE(table.find(ii).isEnd());
+    }
+}
+
+TEST_F(ProbingHashTableTest, Reserve) {
+    IntTable table;
+    table.reserve(100000);
+    const size_t bytes = table.bytesAllocated();
+    for (int64_t i = 0; i < 100000; i++) {
+        ASSERT_TRUE(table.insert(i, i));
+        ASSERT_FALSE(table.isResizing());
+    }
+    ASSERT_EQ(bytes, table.bytesAllocated());
+    ASSERT_TRUE(table.verify());
+}
+
+/*
+ * The slowest single insert into each kind of table, which for
+ * CompactingHashTable is the one that rehashes the whole table.
+ */
+TEST_F(ProbingHashTableTest, BenchmarkWorstInsert) {
+    const int64_t count = 4000000;
+    vector<int64_t> keys(count);
+    for (int64_t i = 0; i < count; i++) {
+        keys[i] = i * 7919;
+    }
+
+    {
+        CompactingHashTable<int64_t, int64_t> table(true);
+        int64_t worst = 0;
+        int64_t start = nowMicros();
+        for (int64_t i = 0; i < count; i++) {
+            int64_t before = nowMicros();
+            table.insert(keys[i], i);
+            worst = max(worst, nowMicros() - before);
+        }
+        printf("  CompactingHashTable: %lld ms, worst insert %lld us\n",
+               (long long)(nowMicros() - start) / 1000, (long long)worst);
+    }
+    {
+        ProbingHashTable<int64_t, int64_t> table;
+        int64_t worst = 0;
+        int64_t start = nowMicros();
+        for (int64_t i = 0; i < count; i++) {
+            int64_t before = nowMicros();
+            table.insert(keys[i], i);
+            worst = max(worst, nowMicros() - before);
+        }
+        printf("  ProbingHashTable:    %lld ms, worst insert %lld us\n",
+               (long long)(nowMicros() - start) / 1000, (long long)worst);
+        int64_t found = 0;
+        start = nowMicros();
+        for (int64_t i = 0; i < count; i++) {
+            found += table.find(keys[i]).isEnd() ? 0 : 1;
+        }
+        printf("  ProbingHashTable:    %lld ms for %lld finds\n",
+               (long long)(nowMicros() - start) / 1000, (long long)found);
+        ASSERT_EQ(count, found);
+    }
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
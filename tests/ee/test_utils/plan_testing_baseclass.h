@@ -0,0 +1,421 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2014 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * A base for executor tests that run hand-written plan fragments through
+ * a VoltDBEngine: a test declares its tables, loads the catalog, fills
+ * the tables and executes JSON plans, getting their result rows back as
+ * text, "1,abc;2,NULL" for two rows of two columns.
+ *
+ * Plans may use single quotes for JSON strings, so that they read easily
+ * as C++ literals; they are swapped for double quotes when a plan is run.
+ */
+
+#ifndef PLAN_TESTING_BASECLASS_H
+#define PLAN_TESTING_BASECLASS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "harness.h"
+#include "common/Pool.hpp"
+#include "common/serializeio.h"
+#include "common/Topend.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "execution/VoltDBEngine.h"
+#include "logging/StdoutLogProxy.h"
+#include "storage/table.h"
+
+class PlanTestingTopend : public voltdb::Topend {
+public:
+    int loadNextDependency(int32_t dependencyId, voltdb::Pool *pool, voltdb::Table* destination) {
+        return 0;
+    }
+    bool fragmentProgressUpdate(int32_t batchIndex, std::string planNodeName,
+            std::string targetTableName, int64_t targetTableSize, int64_t tuplesProcessed) {
+        return false;
+    }
+    std::string planForFragmentId(int64_t fragmentId) {
+        return m_plans[fragmentId];
+    }
+    void crashVoltDB(voltdb::FatalException e) {
+        printf("crashVoltDB: %s\n", e.m_reason.c_str());
+        abort();
+    }
+    int64_t getQueuedExportBytes(int32_t partitionId, std::string signature) {
+        return 0;
+    }
+    void pushExportBuffer(int64_t exportGeneration, int32_t partitionId, std::string signature,
+            voltdb::StreamBlock *block, bool sync, bool endOfStream) {
+    }
+    void fallbackToEEAllocatedBuffer(char *buffer, size_t length) {
+    }
+
+    std::map<int64_t, std::string> m_plans;
+};
+
+class PlanTestingBaseClass : public Test {
+public:
+    PlanTestingBaseClass(int64_t tempTableMemory = voltdb::DEFAULT_TEMP_TABLE_MEMORY)
+        : m_engine(&m_topend, new voltdb::StdoutLogProxy()),
+          m_nextFragmentId(1),
+          m_nextTxnId(1),
+          m_parameterBuffer(new char[BUFFER_SIZE]),
+          m_resultBuffer(new char[BUFFER_SIZE]),
+          m_exceptionBuffer(new char[BUFFER_SIZE])
+    {
+        m_engine.initialize(1, 1, 0, 0, "", tempTableMemory);
+        int partitionCount = 1;
+        m_engine.updateHashinator(voltdb::HASHINATOR_LEGACY, (char*)&partitionCount, NULL, 0);
+        m_engine.setBuffers(m_parameterBuffer, BUFFER_SIZE,
+                            m_resultBuffer, BUFFER_SIZE,
+                            m_exceptionBuffer, BUFFER_SIZE);
+        m_catalog = "add / clusters cluster"
+            "\nadd /clusters[cluster] databases database"
+            "\nadd /clusters[cluster]/databases[database] programs program";
+    }
+
+    ~PlanTestingBaseClass() {
+        delete [] m_parameterBuffer;
+        delete [] m_resultBuffer;
+        delete [] m_exceptionBuffer;
+    }
+
+    /*
+     * Declare a replicated table by its columns, e.g. "ID INTEGER, NAME STRING(16)",
+     * with the types of plan JSON. String sizes are in bytes.
+     */
+    void addTable(const std::string &table, const std::string &columns) {
+        const std::string path = "/clusters[cluster]/databases[database]/tables[" + table + "]";
+        std::ostringstream commands;
+        commands << "\nadd /clusters[cluster]/databases[database] tables " << table
+                 << "\nset " << path << " isreplicated true"
+                 << "\nset " << path << " partitioncolumn null"
+                 << "\nset " << path << " estimatedtuplecount 0";
+        std::vector<std::string> specs = split(columns, ',');
+        for (int ii = 0; ii < specs.size(); ii++) {
+            std::istringstream spec(specs[ii]);
+            std::string name, type;
+            spec >> name >> type;
+            int size = 0;
+            std::string::size_type paren = type.find('(');
+            if (paren != std::string::npos) {
+                size = atoi(type.c_str() + paren + 1);
+                type = type.substr(0, paren);
+            }
+            m_columnTypes[table].push_back(std::make_pair(type, size));
+            const std::string columnPath = path + "/columns[" + name + "]";
+            commands << "\nadd " << path << " columns " << name
+                     << "\nset " << columnPath << " index " << ii
+                     << "\nset " << columnPath << " type " << static_cast<int>(voltdb::stringToValue(type))
+                     << "\nset " << columnPath << " size " << size
+                     << "\nset " << columnPath << " nullable true"
+                     << "\nset " << columnPath << " name \"" << name << "\"";
+        }
+        m_catalog += commands.str();
+    }
+
+    /* Declare an index of a table, on a comma-separated list of its columns */
+    void addIndex(const std::string &table, const std::string &index, voltdb::TableIndexType type,
+                  bool unique, const std::string &columns) {
+        const std::string tablePath = "/clusters[cluster]/databases[database]/tables[" + table + "]";
+        const std::string path = tablePath + "/indexes[" + index + "]";
+        std::ostringstream commands;
+        commands << "\nadd " << tablePath << " indexes " << index
+                 << "\nset " << path << " unique " << (unique ? "true" : "false")
+                 << "\nset " << path << " type " << static_cast<int>(type);
+        std::vector<std::string> names = split(columns, ',');
+        for (int ii = 0; ii < names.size(); ii++) {
+            std::string name = trim(names[ii]);
+            commands << "\nadd " << path << " columns " << name
+                     << "\nset " << path << "/columns[" << name << "] index " << ii
+                     << "\nset " << path << "/columns[" << name << "] column "
+                     << tablePath << "/columns[" << name << "]";
+        }
+        m_catalog += commands.str();
+    }
+
+    void loadCatalog() {
+        ASSERT_TRUE(m_engine.loadCatalog(-2, m_catalog));
+    }
+
+    /*
+     * Insert rows given as text, rows separated by ';' and values by ',',
+     * with NULL for a null value.
+     */
+    void addRows(const std::string &table, const std::string &rows) {
+        voltdb::Table* target = m_engine.getTable(table);
+        ASSERT_TRUE(target != NULL);
+        std::vector<std::string> lines = split(rows, ';');
+        for (int ii = 0; ii < lines.size(); ii++) {
+            std::vector<std::string> values = split(lines[ii], ',');
+            ASSERT_EQ(target->columnCount(), values.size());
+            voltdb::TableTuple &tuple = target->tempTuple();
+            std::vector<voltdb::NValue> allocated;
+            for (int jj = 0; jj < values.size(); jj++) {
+                voltdb::NValue value = parseValue(trim(values[jj]), tuple.getType(jj));
+                tuple.setNValue(jj, value);
+                allocated.push_back(value);
+            }
+            target->insertTuple(tuple);
+            for (int jj = 0; jj < allocated.size(); jj++) {
+                allocated[jj].free();
+            }
+        }
+    }
+
+    /*
+     * Run a plan, returning its result rows as text, or "<error> " and the
+     * message of the exception it raised.
+     */
+    std::string execute(const std::string &plan) {
+        std::string json = plan;
+        std::replace(json.begin(), json.end(), '\'', '"');
+        // the same plan runs as the same, cached, fragment
+        int64_t &fragmentId = m_fragmentIds[json];
+        if (fragmentId == 0) {
+            fragmentId = m_nextFragmentId++;
+            m_topend.m_plans[fragmentId] = json;
+        }
+        m_engine.resetReusedResultOutputBuffer();
+        const int64_t txnId = m_nextTxnId++;
+        const int status = m_engine.executePlanFragment(fragmentId, -1, m_engine.getParameterContainer(),
+                                                        txnId, txnId - 1, txnId, true, true);
+        if (status != ENGINE_ERRORCODE_SUCCESS) {
+            voltdb::ReferenceSerializeInput exception(m_exceptionBuffer, BUFFER_SIZE);
+            exception.readInt();
+            exception.readByte();
+            return "<error> " + exception.readTextString();
+        }
+        return resultRows();
+    }
+
+    voltdb::NValueArray& params() { return m_engine.getParameterContainer(); }
+
+    /* Every column of a table, as read from the outer (or, with tableIdx 1, the inner) input */
+    std::vector<std::string> columnsOf(const std::string &table, int tableIdx = 0) {
+        std::vector<std::string> columns;
+        const std::vector<std::pair<std::string, int> > &types = m_columnTypes[table];
+        for (int ii = 0; ii < types.size(); ii++) {
+            columns.push_back(tupleValue(ii, types[ii].first, types[ii].second, tableIdx));
+        }
+        return columns;
+    }
+
+    /* A sequential scan projecting every column of a table, with an optional predicate */
+    std::string seqScan(int id, const std::string &table, const std::string &predicate = "") {
+        std::string fields = "'TARGET_TABLE_NAME':'" + table + "'";
+        if ( ! predicate.empty()) {
+            fields += ",'PREDICATE':" + predicate;
+        }
+        return node(id, "SEQSCAN", "[]", fields,
+                    "[" + node(0, "PROJECTION", "[]", "'OUTPUT_SCHEMA':" + outputSchema(columnsOf(table))) + "]");
+    }
+
+    /* A column of the input (or, with tableIdx 1, the inner input) tuple */
+    static std::string tupleValue(int column, const std::string &type, int size = 0, int tableIdx = 0) {
+        std::ostringstream json;
+        json << "{'TYPE':'VALUE_TUPLE','VALUE_TYPE':'" << type << "','VALUE_SIZE':"
+             << valueSize(type, size) << ",'COLUMN_IDX':" << column;
+        if (tableIdx != 0) {
+            json << ",'TABLE_IDX':" << tableIdx;
+        }
+        json << "}";
+        return json.str();
+    }
+
+    static std::string constant(int64_t value, const std::string &type = "INTEGER") {
+        std::ostringstream json;
+        json << "{'TYPE':'VALUE_CONSTANT','VALUE_TYPE':'" << type << "','VALUE_SIZE':"
+             << valueSize(type, 0) << ",'ISNULL':false,'VALUE':" << value << "}";
+        return json.str();
+    }
+
+    static std::string parameter(int index, const std::string &type) {
+        std::ostringstream json;
+        json << "{'TYPE':'VALUE_PARAMETER','VALUE_TYPE':'" << type << "','VALUE_SIZE':"
+             << valueSize(type, 0) << ",'PARAM_IDX':" << index << "}";
+        return json.str();
+    }
+
+    /* An operator or comparison, e.g. binary("COMPARE_EQUAL", left, right) */
+    static std::string binary(const std::string &type, const std::string &left, const std::string &right,
+                              const std::string &valueType = "BIGINT") {
+        return "{'TYPE':'" + type + "','VALUE_TYPE':'" + valueType + "','VALUE_SIZE':" +
+            toString(valueSize(valueType, 0)) + ",'LEFT':" + left + ",'RIGHT':" + right + "}";
+    }
+
+    /* An output schema of the given expressions, as columns C0, C1, ... */
+    static std::string outputSchema(const std::vector<std::string> &expressions) {
+        std::string json = "[";
+        for (int ii = 0; ii < expressions.size(); ii++) {
+            json += (ii == 0 ? "" : ",");
+            json += "{'COLUMN_NAME':'C" + toString(ii) + "','EXPRESSION':" + expressions[ii] + "}";
+        }
+        return json + "]";
+    }
+
+    /*
+     * A plan node. children is a JSON array of child ids, and fields are
+     * the node's own JSON members, without braces.
+     */
+    static std::string node(int id, const std::string &type, const std::string &children,
+                            const std::string &fields, const std::string &inlineNodes = "[]") {
+        std::string json = "{'ID':" + toString(id) + ",'PLAN_NODE_TYPE':'" + type +
+            "','INLINE_NODES':" + inlineNodes + ",'CHILDREN_IDS':" + children + ",'PARENT_IDS':[]";
+        if ( ! fields.empty()) {
+            json += "," + fields;
+        }
+        return json + "}";
+    }
+
+    /* A fragment of the given nodes, executed in the order listed */
+    static std::string fragment(const std::vector<std::string> &nodes, const std::string &executeList) {
+        std::string json = "{'PLAN_NODES':[";
+        for (int ii = 0; ii < nodes.size(); ii++) {
+            json += (ii == 0 ? "" : ",") + nodes[ii];
+        }
+        return json + "],'EXECUTE_LIST':" + executeList + ",'PARAMETERS':[]}";
+    }
+
+    static std::string toString(int64_t value) {
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+
+protected:
+    // declared first, as the engine refers to it
+    PlanTestingTopend m_topend;
+    voltdb::VoltDBEngine m_engine;
+
+private:
+    static const int BUFFER_SIZE = 4 * 1024 * 1024;
+
+    static int valueSize(const std::string &type, int size) {
+        if (size != 0) {
+            return size;
+        }
+        voltdb::ValueType valueType = voltdb::stringToValue(type);
+        if (valueType == voltdb::VALUE_TYPE_VARCHAR || valueType == voltdb::VALUE_TYPE_VARBINARY) {
+            return 64;
+        }
+        return voltdb::NValue::getTupleStorageSize(valueType);
+    }
+
+    static std::vector<std::string> split(const std::string &text, char separator) {
+        std::vector<std::string> parts;
+        std::string::size_type start = 0;
+        for (;;) {
+            std::string::size_type end = text.find(separator, start);
+            parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            if (end == std::string::npos) {
+                return parts;
+            }
+            start = end + 1;
+        }
+    }
+
+    static std::string trim(const std::string &text) {
+        std::string::size_type start = text.find_first_not_of(' ');
+        if (start == std::string::npos) {
+            return "";
+        }
+        return text.substr(start, text.find_last_not_of(' ') - start + 1);
+    }
+
+    static voltdb::NValue parseValue(const std::string &text, voltdb::ValueType type) {
+        if (text == "NULL") {
+            return voltdb::NValue::getNullValue(type);
+        }
+        switch (type) {
+        case voltdb::VALUE_TYPE_VARCHAR:
+            return voltdb::ValueFactory::getStringValue(text);
+        case voltdb::VALUE_TYPE_DOUBLE:
+            return voltdb::ValueFactory::getDoubleValue(atof(text.c_str()));
+        default:
+            return voltdb::ValueFactory::getBigIntValue(atoll(text.c_str())).castAs(type);
+        }
+    }
+
+    /* The rows of the one table the fragment sent */
+    std::string resultRows() {
+        voltdb::ReferenceSerializeInput result(m_resultBuffer, m_engine.getResultsSize());
+        result.readInt();  // size of the results
+        result.readByte(); // dirty
+        result.readInt();  // dependency count
+        result.readInt();  // dependency id placeholder
+        result.readInt();  // table size
+        result.readInt();  // header size
+        result.readByte(); // status
+        const int16_t columnCount = result.readShort();
+        std::vector<voltdb::ValueType> types;
+        for (int ii = 0; ii < columnCount; ii++) {
+            types.push_back(static_cast<voltdb::ValueType>(result.readByte()));
+        }
+        for (int ii = 0; ii < columnCount; ii++) {
+            result.readTextString();
+        }
+        const int32_t rowCount = result.readInt();
+        voltdb::Pool pool;
+        std::string rows;
+        for (int ii = 0; ii < rowCount; ii++) {
+            result.readInt(); // row size
+            rows += (ii == 0 ? "" : ";");
+            for (int jj = 0; jj < columnCount; jj++) {
+                voltdb::NValue value;
+                value.deserializeFromAllocateForStorage(types[jj], result, &pool);
+                rows += (jj == 0 ? "" : ",");
+                if (value.isNull()) {
+                    rows += "NULL";
+                    continue;
+                }
+                voltdb::NValue text = (types[jj] == voltdb::VALUE_TYPE_VARCHAR) ?
+                    value : value.castAs(voltdb::VALUE_TYPE_VARCHAR);
+                rows += std::string(reinterpret_cast<const char*>(voltdb::ValuePeeker::peekObjectValue(text)),
+                                    voltdb::ValuePeeker::peekObjectLength(text));
+            }
+        }
+        return rows;
+    }
+
+    std::map<std::string, int64_t> m_fragmentIds;
+    int64_t m_nextFragmentId;
+    int64_t m_nextTxnId;
+    char *m_parameterBuffer;
+    char *m_resultBuffer;
+    char *m_exceptionBuffer;
+    std::string m_catalog;
+    // the plan JSON type and size of each table's columns
+    std::map<std::string, std::vector<std::pair<std::string, int> > > m_columnTypes;
+};
+
+#endif // PLAN_TESTING_BASECLASS_H
@@ -25,7 +25,9 @@ package org.voltdb.planner;
 
 import java.util.List;
 
+import org.voltdb.plannodes.AbstractJoinPlanNode;
 import org.voltdb.plannodes.AbstractPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.IndexScanPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
 import org.voltdb.plannodes.SeqScanPlanNode;
@@ -110,14 +112,19 @@ public class TestJoinOrder extends PlannerTestCase {
         AbstractPlanNode n = pn.getChild(0).getChild(0);
         String joinOrder[] = {"T2", "T1", "T3", "T4", "T5", "T7", "T6"};
         for (int i = 6; i > 0; i--) {
-            assertTrue(n instanceof NestLoopPlanNode);
+            // T4 and T5 are joined on T3.C, the rest are cross joins
+            if (i == 3 || i == 4) {
+                assertTrue(n instanceof HashJoinPlanNode);
+            } else {
+                assertTrue(n instanceof NestLoopPlanNode);
+            }
             assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
             SeqScanPlanNode s = (SeqScanPlanNode) n.getChild(1);
             if (i == 1) {
                 assertTrue(n.getChild(0) instanceof SeqScanPlanNode);
                 assertTrue(joinOrder[i-1].equals(((SeqScanPlanNode) n.getChild(0)).getTargetTableName()));
             } else {
-                assertTrue(n.getChild(0) instanceof NestLoopPlanNode);
+                assertTrue(n.getChild(0) instanceof AbstractJoinPlanNode);
                 n = n.getChild(0);
             }
             assertTrue(joinOrder[i].equals(s.getTargetTableName()));
@@ -26,7 +26,9 @@ package org.voltdb.planner;
 import java.util.List;
 
 import org.voltdb.expressions.AbstractExpression;
+import org.voltdb.expressions.TupleValueExpression;
 import org.voltdb.plannodes.AbstractPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.IndexScanPlanNode;
 import org.voltdb.plannodes.NestLoopIndexPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
@@ -40,85 +42,88 @@ public class TestMultipleOuterJoinPlans  extends PlannerTestCase {
     public void testInnerOuterJoin() {
         AbstractPlanNode pn = compile("select * FROM R1 INNER JOIN R2 ON R1.A = R2.A LEFT JOIN R3 ON R3.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         pn = compile("select * FROM R1, R2 LEFT JOIN R3 ON R3.C = R2.C WHERE R1.A = R2.A");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
     }
 
     public void testOuterOuterJoin() {
         AbstractPlanNode pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.A = R2.A LEFT JOIN R3 ON R3.C = R1.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.A = R2.A RIGHT JOIN R3 ON R3.C = R1.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(1);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        // the inner side of the hash join is the R1, R2 join
+        assertEquals("R3", ((TupleValueExpression) hj.getOuterHashExpressions().get(0)).getTableAlias());
+        assertEquals("R1", ((TupleValueExpression) hj.getInnerHashExpressions().get(0)).getTableAlias());
+        n = hj.getChild(1);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.A = R2.A RIGHT JOIN R3 ON R3.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(1);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(1);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.A = R2.A LEFT JOIN R3 ON R3.C = R1.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
 
         pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.A = R2.A LEFT JOIN R3 ON R3.C = R1.C WHERE R1.A > 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
     }
 
     public void testMultiTableJoinExpressions() {
@@ -136,70 +141,70 @@ public class TestMultipleOuterJoinPlans  extends PlannerTestCase {
         // R3.A > 0 gets pushed down all the way to the R3 scan node and used as an index
         AbstractPlanNode pn = compile("select * FROM R3, R2 LEFT JOIN R1 ON R1.C = R2.C WHERE R3.C = R2.C AND R3.A > 0");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
         assertTrue(n instanceof IndexScanPlanNode);
 
         // R3.A > 0 is now outer join expresion and must stay at the LEF join
         pn = compile("select * FROM R3, R2 LEFT JOIN R1 ON R1.C = R2.C  AND R3.A > 0 WHERE R3.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
         assertTrue(n instanceof SeqScanPlanNode);
 
         pn = compile("select * FROM R3 JOIN R2 ON R3.C = R2.C RIGHT JOIN R1 ON R1.C = R2.C  AND R3.A > 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(1);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(1);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
         assertTrue(n instanceof SeqScanPlanNode);
 
         // R3.A > 0 gets pushed down all the way to the R3 scan node and used as an index
         pn = compile("select * FROM R2, R3 LEFT JOIN R1 ON R1.C = R2.C WHERE R3.C = R2.C AND R3.A > 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(1);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(1);
         assertTrue(n instanceof IndexScanPlanNode);
 
         // R3.A = R2.C gets pushed down to the R2, R3 join node scan node and used as an index
         pn = compile("select * FROM R2, R3 LEFT JOIN R1 ON R1.C = R2.C WHERE R3.A = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
         assertTrue(n instanceof NestLoopIndexPlanNode);
         NestLoopIndexPlanNode nlij = (NestLoopIndexPlanNode) n;
         assertTrue(JoinType.INNER == nlij.getJoinType());
@@ -211,41 +216,41 @@ public class TestMultipleOuterJoinPlans  extends PlannerTestCase {
 
         AbstractPlanNode pn = compile("select * FROM R1, R3 RIGHT JOIN R2 ON R1.A = R2.A WHERE R3.C = R1.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         // The second R3.C = R2.C join condition is NULL-rejecting for the first LEFT join
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.A = R2.A LEFT JOIN R3 ON R3.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
 
         // The second R3.C = R2.C join condition is NULL-rejecting for the first LEFT join
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.A = R2.A RIGHT JOIN R3 ON R3.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
-        n = nlj.getChild(1);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) n;
-        assertTrue(JoinType.INNER == nlj.getJoinType());
-        assertTrue(nlj.getJoinPredicate() != null);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
+        n = hj.getChild(1);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertTrue(JoinType.INNER == hj.getJoinType());
+        assertTrue(hj.getJoinPredicate() != null);
     }
 
     public void testMultitableDistributedJoin() {
@@ -32,6 +32,7 @@ import org.voltdb.plannodes.AbstractPlanNode;
 import org.voltdb.plannodes.AbstractScanPlanNode;
 import org.voltdb.plannodes.AggregatePlanNode;
 import org.voltdb.plannodes.DistinctPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.IndexScanPlanNode;
 import org.voltdb.plannodes.NestLoopIndexPlanNode;
 import org.voltdb.plannodes.NestLoopPlanNode;
@@ -56,7 +57,7 @@ public class TestPlansJoin extends PlannerTestCase {
         // select * with ON clause should return all columns from all tables
         AbstractPlanNode pn = compile("select * FROM R1 JOIN R2 ON R1.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         //assertEquals(JoinType.INNER, nlj.getJoinType());
         for (int ii = 0; ii < 2; ii++) {
             assertTrue(n.getChild(ii) instanceof SeqScanPlanNode);
@@ -65,22 +66,22 @@ public class TestPlansJoin extends PlannerTestCase {
 
         // select * with USING clause should contain only one column for each column from the USING expression
         pn = compile("select * FROM R1 JOIN R2 USING(C)");
-        assertTrue(pn.getChild(0).getChild(0) instanceof NestLoopPlanNode);
+        assertTrue(pn.getChild(0).getChild(0) instanceof HashJoinPlanNode);
         assertEquals(4, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select A,C,D FROM R1 JOIN R2 ON R1.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(3, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select A,C,D FROM R1 JOIN R2 USING(C)");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(3, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select R1.A, R2.C, R1.D FROM R1 JOIN R2 ON R1.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(3, pn.getOutputSchema().getColumns().size());
         assertTrue("R1".equalsIgnoreCase(pn.getOutputSchema().getColumns().get(0).getTableName()));
         assertTrue("R2".equalsIgnoreCase(pn.getOutputSchema().getColumns().get(1).getTableName()));
@@ -89,7 +90,7 @@ public class TestPlansJoin extends PlannerTestCase {
         pn = compile("select R1.A, C, R1.D FROM R1 JOIN R2 USING(C)");
         n = pn.getChild(0).getChild(0);
         String table = pn.getOutputSchema().getColumns().get(1).getTableName();
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(3, pn.getOutputSchema().getColumns().size());
         assertTrue(pn.getOutputSchema().getColumns().get(0).getTableName().equalsIgnoreCase("R1"));
         assertTrue("R2".equalsIgnoreCase(table) || "R1".equalsIgnoreCase(table));
@@ -108,27 +109,27 @@ public class TestPlansJoin extends PlannerTestCase {
     public void testBasicThreeTableInnerJoin() {
         AbstractPlanNode pn = compile("select * FROM R1 JOIN R2 ON R1.C = R2.C JOIN R3 ON R3.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        assertTrue(n.getChild(0) instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
+        assertTrue(n.getChild(0) instanceof HashJoinPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
         assertEquals(7, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select R1.C, R2.C R3.C FROM R1 INNER JOIN R2 ON R1.C = R2.C INNER JOIN R3 ON R3.C = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        assertTrue(n.getChild(0) instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
+        assertTrue(n.getChild(0) instanceof HashJoinPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
 
         pn = compile("select C FROM R1 INNER JOIN R2 USING (C) INNER JOIN R3 USING(C)");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        assertTrue(n.getChild(0) instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
+        assertTrue(n.getChild(0) instanceof HashJoinPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
         assertEquals(1, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select C FROM R1 INNER JOIN R2 USING (C), R3 WHERE R1.A = R3.A");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertTrue(n.getChild(0) instanceof NestLoopIndexPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
         assertEquals(1, pn.getOutputSchema().getColumns().size());
@@ -240,13 +241,13 @@ public class TestPlansJoin extends PlannerTestCase {
 
         pn = compile("select * FROM R1 JOIN R2 ON R1.A = R2.A JOIN R3 ON R1.C = R3.C WHERE R1.A > 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        p = ((NestLoopPlanNode) n).getJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        p = ((HashJoinPlanNode) n).getJoinPredicate();
         assertEquals(ExpressionType.COMPARE_EQUAL, p.getExpressionType());
         n = n.getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertEquals(ExpressionType.COMPARE_EQUAL, nlj.getJoinPredicate().getExpressionType());
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertEquals(ExpressionType.COMPARE_EQUAL, hj.getJoinPredicate().getExpressionType());
         n = n.getChild(0);
         assertTrue(n instanceof AbstractScanPlanNode);
         assertTrue(((AbstractScanPlanNode) n).getTargetTableName().equalsIgnoreCase("R1"));
@@ -309,14 +310,14 @@ public class TestPlansJoin extends PlannerTestCase {
         List<AbstractPlanNode> apl;
         AbstractPlanNode node;
         SeqScanPlanNode seqScan;
-        NestLoopPlanNode nlj;
+        HashJoinPlanNode hj;
 
         apl = compileToFragments("select * FROM P1 LABEL JOIN R2 USING(A) WHERE A > 0 and R2.C >= 5");
         pn = apl.get(1);
         node = pn.getChild(0);
-        assertTrue(node instanceof NestLoopPlanNode);
+        assertTrue(node instanceof HashJoinPlanNode);
         assertEquals(ExpressionType.COMPARE_EQUAL,
-                     ((NestLoopPlanNode)node).getJoinPredicate().getExpressionType());
+                     ((HashJoinPlanNode)node).getJoinPredicate().getExpressionType());
         assertTrue(node.getChild(0) instanceof SeqScanPlanNode);
         seqScan = (SeqScanPlanNode)node.getChild(0);
         assertTrue(seqScan.getPredicate() == null);
@@ -328,10 +329,10 @@ public class TestPlansJoin extends PlannerTestCase {
         apl = compileToFragments("select * FROM P1 LABEL LEFT JOIN R2 USING(A) WHERE A > 0");
         pn = apl.get(1);
         node = pn.getChild(0);
-        assertTrue(node instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) node;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertEquals(ExpressionType.COMPARE_EQUAL, nlj.getJoinPredicate().getExpressionType());
+        assertTrue(node instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) node;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertEquals(ExpressionType.COMPARE_EQUAL, hj.getJoinPredicate().getExpressionType());
         seqScan = (SeqScanPlanNode)node.getChild(0);
         assertTrue(seqScan.getPredicate() != null);
         assertEquals(ExpressionType.COMPARE_GREATERTHAN, seqScan.getPredicate().getExpressionType());
@@ -345,10 +346,10 @@ public class TestPlansJoin extends PlannerTestCase {
         assertEquals("P1", sc.getTableName());
         pn = apl.get(1);
         node = pn.getChild(0);
-        assertTrue(node instanceof NestLoopPlanNode);
-        nlj = (NestLoopPlanNode) node;
-        assertTrue(JoinType.LEFT == nlj.getJoinType());
-        assertEquals(ExpressionType.COMPARE_EQUAL, nlj.getJoinPredicate().getExpressionType());
+        assertTrue(node instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) node;
+        assertTrue(JoinType.LEFT == hj.getJoinType());
+        assertEquals(ExpressionType.COMPARE_EQUAL, hj.getJoinPredicate().getExpressionType());
         seqScan = (SeqScanPlanNode)node.getChild(0);
         assertTrue(seqScan.getPredicate() != null);
         assertEquals(ExpressionType.COMPARE_GREATERTHAN, seqScan.getPredicate().getExpressionType());
@@ -522,8 +523,8 @@ public class TestPlansJoin extends PlannerTestCase {
 
         pn = compile("select * FROM R3 JOIN R2 ON R3.A = R2.A JOIN R1 ON R2.A = R1.A WHERE R3.C > 0 and R2.C >= 5");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        p = ((NestLoopPlanNode) n).getJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        p = ((HashJoinPlanNode) n).getJoinPredicate();
         assertEquals(ExpressionType.COMPARE_EQUAL, p.getExpressionType());
         assertEquals(ExpressionType.VALUE_TUPLE, p.getLeft().getExpressionType());
         assertEquals(ExpressionType.VALUE_TUPLE, p.getRight().getExpressionType());
@@ -553,17 +554,20 @@ public class TestPlansJoin extends PlannerTestCase {
        // Test multi column condition on non index columns
        AbstractPlanNode pn = compile("select A, C FROM R2 JOIN R1 USING(A, C)");
        AbstractPlanNode n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-       AbstractExpression pred = nlj.getJoinPredicate();
+       assertTrue(n instanceof HashJoinPlanNode);
+       HashJoinPlanNode hj = (HashJoinPlanNode) n;
+       AbstractExpression pred = hj.getJoinPredicate();
        assertNotNull(pred);
        assertEquals(ExpressionType.CONJUNCTION_AND, pred.getExpressionType());
+       // both columns key the hash table
+       assertEquals(2, hj.getOuterHashExpressions().size());
+       assertEquals(2, hj.getInnerHashExpressions().size());
 
        pn = compile("select R1.A, R2.A FROM R2 JOIN R1 on R1.A = R2.A and R1.C = R2.C");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       nlj = (NestLoopPlanNode) n;
-       pred = nlj.getJoinPredicate();
+       assertTrue(n instanceof HashJoinPlanNode);
+       hj = (HashJoinPlanNode) n;
+       pred = hj.getJoinPredicate();
        assertNotNull(pred);
        assertEquals(ExpressionType.CONJUNCTION_AND, pred.getExpressionType());
 
@@ -618,27 +622,27 @@ public class TestPlansJoin extends PlannerTestCase {
         // select * with ON clause should return all columns from all tables
         AbstractPlanNode pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
-        assertEquals(2, nl.getChildCount());
-        AbstractPlanNode c0 = nl.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertEquals(2, hj.getChildCount());
+        AbstractPlanNode c0 = hj.getChild(0);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue("R1".equalsIgnoreCase(((SeqScanPlanNode) c0).getTargetTableName()));
-        AbstractPlanNode c1 = nl.getChild(1);
+        AbstractPlanNode c1 = hj.getChild(1);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue("R2".equalsIgnoreCase(((SeqScanPlanNode) c1).getTargetTableName()));
 
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C AND R1.A = 5");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
-        assertEquals(2, nl.getChildCount());
-        c0 = nl.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertEquals(2, hj.getChildCount());
+        c0 = hj.getChild(0);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue("R1".equalsIgnoreCase(((SeqScanPlanNode) c0).getTargetTableName()));
-        c1 = nl.getChild(1);
+        c1 = hj.getChild(1);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue("R2".equalsIgnoreCase(((SeqScanPlanNode) c1).getTargetTableName()));
     }
@@ -647,8 +651,8 @@ public class TestPlansJoin extends PlannerTestCase {
         // select * FROM R1 RIGHT JOIN R2 ON R1.C = R2.C => select * FROM R2 LEFT JOIN R1 ON R1.C = R2.C
         AbstractPlanNode pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nl = (NestLoopPlanNode) n;
+        assertTrue(n instanceof HashJoinPlanNode);
+        AbstractJoinPlanNode nl = (AbstractJoinPlanNode) n;
         assertEquals(JoinType.LEFT, nl.getJoinType());
         assertEquals(2, nl.getChildCount());
         AbstractPlanNode c0 = nl.getChild(0);
@@ -658,11 +662,12 @@ public class TestPlansJoin extends PlannerTestCase {
         assertTrue(c1 instanceof SeqScanPlanNode);
         assertTrue("R1".equalsIgnoreCase(((SeqScanPlanNode) c1).getTargetTableName()));
 
-        // Same but with distributed table
+        // Same but with distributed table, which the join must receive before it
+        // can null-pad the outer rows, so it can only be a nest loop join
         pn = compile("select * FROM P1 RIGHT JOIN R2 ON P1.C = R2.C");
         n = pn.getChild(0).getChild(0);
         assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
+        nl = (AbstractJoinPlanNode) n;
         assertEquals(JoinType.LEFT, nl.getJoinType());
         assertEquals(2, nl.getChildCount());
         c0 = nl.getChild(0);
@@ -674,88 +679,88 @@ public class TestPlansJoin extends PlannerTestCase {
     }
 
     public void testSeqScanOuterJoinCondition() {
-        // R1.C = R2.C Inner-Outer join Expr stays at the NLJ as Join predicate
+        // R1.C = R2.C Inner-Outer join Expr stays at the hash join as Join predicate
         AbstractPlanNode pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nl = (NestLoopPlanNode) n;
-        assertEquals(ExpressionType.COMPARE_EQUAL, nl.getJoinPredicate().getExpressionType());
-        assertNull(nl.getWherePredicate());
-        assertEquals(2, nl.getChildCount());
-        SeqScanPlanNode c0 = (SeqScanPlanNode) nl.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertEquals(ExpressionType.COMPARE_EQUAL, hj.getJoinPredicate().getExpressionType());
+        assertNull(hj.getWherePredicate());
+        assertEquals(2, hj.getChildCount());
+        SeqScanPlanNode c0 = (SeqScanPlanNode) hj.getChild(0);
         assertNull(c0.getPredicate());
-        SeqScanPlanNode c1 = (SeqScanPlanNode) nl.getChild(1);
+        SeqScanPlanNode c1 = (SeqScanPlanNode) hj.getChild(1);
         assertNull(c1.getPredicate());
 
-        // R1.C = R2.C Inner-Outer join Expr stays at the NLJ as Join predicate
-        // R1.A > 0 Outer Join Expr stays at the the NLJ as pre-join predicate
+        // R1.C = R2.C Inner-Outer join Expr stays at the hash join as Join predicate
+        // R1.A > 0 Outer Join Expr stays at the the hash join as pre-join predicate
         // R2.A < 0 Inner Join Expr is pushed down to the inner SeqScan node
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C AND R1.A > 0 AND R2.A < 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertNotNull(nl.getPreJoinPredicate());
-        AbstractExpression p = nl.getPreJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertNotNull(hj.getPreJoinPredicate());
+        AbstractExpression p = hj.getPreJoinPredicate();
         assertEquals(ExpressionType.COMPARE_GREATERTHAN, p.getExpressionType());
-        assertNotNull(nl.getJoinPredicate());
-        p = nl.getJoinPredicate();
+        assertNotNull(hj.getJoinPredicate());
+        p = hj.getJoinPredicate();
         assertEquals(ExpressionType.COMPARE_EQUAL, p.getExpressionType());
-        assertNull(nl.getWherePredicate());
-        assertEquals(2, nl.getChildCount());
-        c0 = (SeqScanPlanNode) nl.getChild(0);
+        assertNull(hj.getWherePredicate());
+        assertEquals(2, hj.getChildCount());
+        c0 = (SeqScanPlanNode) hj.getChild(0);
         assertNull(c0.getPredicate());
-        c1 = (SeqScanPlanNode) nl.getChild(1);
+        c1 = (SeqScanPlanNode) hj.getChild(1);
         assertNotNull(c1.getPredicate());
         p = c1.getPredicate();
         assertEquals(ExpressionType.COMPARE_LESSTHAN, p.getExpressionType());
 
-        // R1.C = R2.C Inner-Outer join Expr stays at the NLJ as Join predicate
-        // (R1.A > 0 OR R2.A < 0) Inner-Outer join Expr stays at the NLJ as Join predicate
+        // R1.C = R2.C Inner-Outer join Expr stays at the hash join as Join predicate
+        // (R1.A > 0 OR R2.A < 0) Inner-Outer join Expr stays at the hash join as Join predicate
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C AND (R1.A > 0 OR R2.A < 0)");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        p = nl.getJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        p = hj.getJoinPredicate();
         assertEquals(ExpressionType.CONJUNCTION_AND, p.getExpressionType());
         assertEquals(ExpressionType.CONJUNCTION_OR, p.getLeft().getExpressionType());
-        assertNull(nl.getWherePredicate());
-        assertEquals(2, nl.getChildCount());
-        c0 = (SeqScanPlanNode) nl.getChild(0);
+        assertNull(hj.getWherePredicate());
+        assertEquals(2, hj.getChildCount());
+        c0 = (SeqScanPlanNode) hj.getChild(0);
         assertNull(c0.getPredicate());
-        c1 = (SeqScanPlanNode) nl.getChild(1);
+        c1 = (SeqScanPlanNode) hj.getChild(1);
         assertNull(c1.getPredicate());
 
-        // R1.C = R2.C Inner-Outer join Expr stays at the NLJ as Join predicate
+        // R1.C = R2.C Inner-Outer join Expr stays at the hash join as Join predicate
         // R1.A > 0 Outer Where Expr is pushed down to the outer SeqScan node
-        // R2.A IS NULL Inner Where Expr stays at the the NLJ as post join (where) predicate
-        // (R1.C > R2.C OR R2.C IS NULL) Inner-Outer Where stays at the the NLJ as post join (where) predicate
+        // R2.A IS NULL Inner Where Expr stays at the the hash join as post join (where) predicate
+        // (R1.C > R2.C OR R2.C IS NULL) Inner-Outer Where stays at the the hash join as post join (where) predicate
         pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE R1.A > 0 AND R2.A IS NULL AND (R1.C > R2.C OR R2.C IS NULL)");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
-        assertNotNull(nl.getJoinPredicate());
-        p = nl.getJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertNotNull(hj.getJoinPredicate());
+        p = hj.getJoinPredicate();
         assertEquals(ExpressionType.COMPARE_EQUAL, p.getExpressionType());
-        AbstractExpression w = nl.getWherePredicate();
+        AbstractExpression w = hj.getWherePredicate();
         assertNotNull(w);
         assertEquals(ExpressionType.CONJUNCTION_AND, w.getExpressionType());
         assertEquals(ExpressionType.OPERATOR_IS_NULL, w.getRight().getExpressionType());
         assertEquals(ExpressionType.CONJUNCTION_OR, w.getLeft().getExpressionType());
-        assertEquals(2, nl.getChildCount());
-        c0 = (SeqScanPlanNode) nl.getChild(0);
+        assertEquals(2, hj.getChildCount());
+        c0 = (SeqScanPlanNode) hj.getChild(0);
         assertEquals(ExpressionType.COMPARE_GREATERTHAN, c0.getPredicate().getExpressionType());
-        c1 = (SeqScanPlanNode) nl.getChild(1);
+        c1 = (SeqScanPlanNode) hj.getChild(1);
         assertNull(c1.getPredicate());
 
-        // R3.A = R2.A Inner-Outer index join Expr. NLJ predicate.
+        // R3.A = R2.A Inner-Outer index join Expr. Hash join predicate.
         // R3.A > 3 Index Outer where expr pushed down to IndexScanPlanNode
         // R3.C < 0 non-index Outer where expr pushed down to IndexScanPlanNode as a predicate
         pn = compile("select * FROM R3 LEFT JOIN R2 ON R3.A = R2.A WHERE R3.A > 3 AND R3.C < 0");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
         AbstractPlanNode outerScan = n.getChild(0);
         assertTrue(outerScan instanceof IndexScanPlanNode);
         IndexScanPlanNode indexScan = (IndexScanPlanNode) outerScan;
@@ -763,14 +768,14 @@ public class TestPlansJoin extends PlannerTestCase {
         assertNotNull(indexScan.getPredicate());
         assertEquals(ExpressionType.COMPARE_LESSTHAN, indexScan.getPredicate().getExpressionType());
 
-        // R3.C = R2.C Inner-Outer non-index join Expr. NLJ predicate.
+        // R3.C = R2.C Inner-Outer non-index join Expr. Hash join predicate.
         // R3.A > 3 Index null rejecting inner where expr pushed down to IndexScanPlanNode
-        // NLJ is simplified to be INNER
+        // The join is simplified to be INNER
         pn = compile("select * FROM R2 LEFT JOIN R3 ON R3.C = R2.C WHERE R3.A > 3");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.INNER, nl.getJoinType());
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.INNER, hj.getJoinType());
         outerScan = n.getChild(1);
         assertTrue(outerScan instanceof IndexScanPlanNode);
         indexScan = (IndexScanPlanNode) outerScan;
@@ -792,7 +797,7 @@ public class TestPlansJoin extends PlannerTestCase {
         lpn = compileToFragments("select * FROM P1 LEFT JOIN R2 ON P1.C = R2.C");
         assertEquals(2, lpn.size());
         n = lpn.get(1).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(2, n.getChildCount());
         assertTrue(n.getChild(0) instanceof SeqScanPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
@@ -810,7 +815,7 @@ public class TestPlansJoin extends PlannerTestCase {
         lpn = compileToFragments("select * FROM P1 LEFT JOIN P4 ON P1.A = P4.A");
         assertEquals(2, lpn.size());
         n = lpn.get(1).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(2, n.getChildCount());
         assertTrue(n.getChild(0) instanceof SeqScanPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
@@ -821,32 +826,32 @@ public class TestPlansJoin extends PlannerTestCase {
     }
 
     public void testBasicIndexOuterJoin() {
-        // R3 is indexed but it's the outer table and the join expression must stay at the NLJ
+        // R3 is indexed but it's the outer table and the join expression must stay at the hash join
         // so index can't be used
         AbstractPlanNode pn = compile("select * FROM R3 LEFT JOIN R2 ON R3.A = R2.C");
         AbstractPlanNode n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
-        assertEquals(2, nl.getChildCount());
-        AbstractPlanNode c0 = nl.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertEquals(2, hj.getChildCount());
+        AbstractPlanNode c0 = hj.getChild(0);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue(((SeqScanPlanNode) c0).getTargetTableName().equalsIgnoreCase("R3"));
-        AbstractPlanNode c1 = nl.getChild(1);
+        AbstractPlanNode c1 = hj.getChild(1);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue(((SeqScanPlanNode) c1).getTargetTableName().equalsIgnoreCase("R2"));
 
         // R3 is indexed but it's the outer table so index can't be used
         pn = compile("select * FROM R2 RIGHT JOIN R3 ON R3.A = R2.C");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        nl = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nl.getJoinType());
-        assertEquals(2, nl.getChildCount());
-        c0 = nl.getChild(0);
+        assertTrue(n instanceof HashJoinPlanNode);
+        hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertEquals(2, hj.getChildCount());
+        c0 = hj.getChild(0);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue(((SeqScanPlanNode) c0).getTargetTableName().equalsIgnoreCase("R3"));
-        c1 = nl.getChild(1);
+        c1 = hj.getChild(1);
         assertTrue(c0 instanceof SeqScanPlanNode);
         assertTrue(((SeqScanPlanNode) c1).getTargetTableName().equalsIgnoreCase("R2"));
 
@@ -886,21 +891,21 @@ public class TestPlansJoin extends PlannerTestCase {
         assertTrue(c1 instanceof SeqScanPlanNode);
         assertNull(((SeqScanPlanNode)c1).getPredicate());
 
-        // R1.C = R3.A Inner-Outer non-index join Expr. NLJ/IndexScan
+        // R1.C = R3.A Inner-Outer non-index join Expr. Hash join/IndexScan
         // R3.A > 0 Inner index Join Expr is pushed down to the inner IndexScan node as an index
         // R3.C != 0 Non-index Inner Join Expression is pushed down to the inner IndexScan node as a predicate
-        // R2.A < 6 Outer Join Expr is a pre-join predicate for NLJ
+        // R2.A < 6 Outer Join Expr is a pre-join predicate for the hash join
         pn = compile("select * FROM R2 LEFT JOIN R3 ON R3.C = R2.A AND R3.A > 0 AND R3.C != 0 AND R2.A < 6");
         n = pn.getChild(0).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
-        NestLoopPlanNode nlj = (NestLoopPlanNode) n;
-        assertEquals(JoinType.LEFT, nlj.getJoinType());
-        assertNotNull(nlj.getPreJoinPredicate());
-        p = nlj.getPreJoinPredicate();
+        assertTrue(n instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) n;
+        assertEquals(JoinType.LEFT, hj.getJoinType());
+        assertNotNull(hj.getPreJoinPredicate());
+        p = hj.getPreJoinPredicate();
         assertEquals(ExpressionType.COMPARE_LESSTHAN, p.getExpressionType());
-        assertNotNull(nlj.getJoinPredicate());
-        assertEquals(ExpressionType.COMPARE_EQUAL, nlj.getJoinPredicate().getExpressionType());
-        assertNull(nlj.getWherePredicate());
+        assertNotNull(hj.getJoinPredicate());
+        assertEquals(ExpressionType.COMPARE_EQUAL, hj.getJoinPredicate().getExpressionType());
+        assertNull(hj.getWherePredicate());
         c1 = n.getChild(0);
         assertTrue(c1 instanceof SeqScanPlanNode);
         assertNull(((SeqScanPlanNode)c1).getPredicate());
@@ -943,7 +948,7 @@ public class TestPlansJoin extends PlannerTestCase {
         lpn = compileToFragments("select * FROM P1 LEFT JOIN R2 ON P1.C = R2.C");
         assertEquals(2, lpn.size());
         n = lpn.get(1).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(2, n.getChildCount());
         assertTrue(n.getChild(0) instanceof SeqScanPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
@@ -961,7 +966,7 @@ public class TestPlansJoin extends PlannerTestCase {
         lpn = compileToFragments("select * FROM P1 LEFT JOIN P4 ON P1.A = P4.A");
         assertEquals(2, lpn.size());
         n = lpn.get(1).getChild(0);
-        assertTrue(n instanceof NestLoopPlanNode);
+        assertTrue(n instanceof HashJoinPlanNode);
         assertEquals(2, n.getChildCount());
         assertTrue(n.getChild(0) instanceof SeqScanPlanNode);
         assertTrue(n.getChild(1) instanceof SeqScanPlanNode);
@@ -1052,23 +1057,23 @@ public class TestPlansJoin extends PlannerTestCase {
    public void testOuterJoinSimplification() {
        AbstractPlanNode pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE R2.C IS NOT NULL");
        AbstractPlanNode n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE R2.C > 0");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.C = R2.C WHERE R1.C > 0");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 LEFT JOIN R3 ON R1.C = R3.C WHERE R3.A > 0");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 LEFT JOIN R3 ON R1.C = R3.A WHERE R3.A > 0");
        n = pn.getChild(0).getChild(0);
@@ -1077,24 +1082,25 @@ public class TestPlansJoin extends PlannerTestCase {
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R2.C) <  10");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.C = R2.C WHERE ABS(R1.C) <  10");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R1.C) <  10");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.LEFT);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.LEFT);
 
        pn = compile("select * FROM R1 RIGHT JOIN R2 ON R1.C = R2.C WHERE ABS(R2.C) <  10");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.LEFT);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.LEFT);
 
+       // R1.C = 3 turns R1.C = R2.C into R2.C = 3, leaving no join key to hash
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R2.C) <  10 AND R1.C = 3");
        n = pn.getChild(0).getChild(0);
        assertTrue(n instanceof NestLoopPlanNode);
@@ -1102,18 +1108,18 @@ public class TestPlansJoin extends PlannerTestCase {
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R2.C) <  10 OR R2.C IS NOT NULL");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.INNER);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.INNER);
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R1.C) <  10 AND R1.C > 3");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.LEFT);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.LEFT);
 
        pn = compile("select * FROM R1 LEFT JOIN R2 ON R1.C = R2.C WHERE ABS(R1.C) <  10 OR R2.C IS NOT NULL");
        n = pn.getChild(0).getChild(0);
-       assertTrue(n instanceof NestLoopPlanNode);
-       assertEquals(((NestLoopPlanNode) n).getJoinType(), JoinType.LEFT);
+       assertTrue(n instanceof HashJoinPlanNode);
+       assertEquals(((HashJoinPlanNode) n).getJoinType(), JoinType.LEFT);
    }
 
     @Override
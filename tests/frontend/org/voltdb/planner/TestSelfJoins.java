@@ -26,20 +26,28 @@ package org.voltdb.planner;
 import org.voltdb.expressions.AbstractExpression;
 import org.voltdb.expressions.TupleValueExpression;
 import org.voltdb.plannodes.AbstractPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
+import org.voltdb.plannodes.IndexScanPlanNode;
+import org.voltdb.plannodes.MergeJoinPlanNode;
 import org.voltdb.plannodes.NodeSchema;
 import org.voltdb.plannodes.ProjectionPlanNode;
 import org.voltdb.plannodes.SchemaColumn;
 import org.voltdb.plannodes.SendPlanNode;
-import org.voltdb.plannodes.NestLoopPlanNode;
 import org.voltdb.plannodes.SeqScanPlanNode;
 import org.voltdb.types.ExpressionType;
+import org.voltdb.types.JoinType;
 
 public class TestSelfJoins  extends PlannerTestCase {
 
     public void testSelfJoin() {
         AbstractPlanNode pn = compile("select * FROM R1 A JOIN R1 B ON A.C = B.C WHERE B.A > 0 AND A.C < 3");
         pn = pn.getChild(0).getChild(0);
-        assertTrue(pn instanceof NestLoopPlanNode);
+        // neither side has an index on C, so the equality keys a hash join
+        assertTrue(pn instanceof HashJoinPlanNode);
+        HashJoinPlanNode hj = (HashJoinPlanNode) pn;
+        assertEquals(1, hj.getOuterHashExpressions().size());
+        assertEquals("A", ((TupleValueExpression) hj.getOuterHashExpressions().get(0)).getTableAlias());
+        assertEquals("B", ((TupleValueExpression) hj.getInnerHashExpressions().get(0)).getTableAlias());
         assertEquals(4, pn.getOutputSchema().getColumns().size());
         assertEquals(2, pn.getChildCount());
         AbstractPlanNode c = pn.getChild(0);
@@ -57,7 +65,7 @@ public class TestSelfJoins  extends PlannerTestCase {
 
         pn = compile("select * FROM R1 JOIN R1 B ON R1.C = B.C");
         pn = pn.getChild(0).getChild(0);
-        assertTrue(pn instanceof NestLoopPlanNode);
+        assertTrue(pn instanceof HashJoinPlanNode);
         assertEquals(4, pn.getOutputSchema().getColumns().size());
         assertEquals(2, pn.getChildCount());
         c = pn.getChild(0);
@@ -73,7 +81,7 @@ public class TestSelfJoins  extends PlannerTestCase {
 
         pn = compile("select A.A, A.C, B.A, B.C FROM R1 A JOIN R1 B ON A.C = B.C");
         pn = pn.getChild(0).getChild(0);
-        assertTrue(pn instanceof NestLoopPlanNode);
+        assertTrue(pn instanceof HashJoinPlanNode);
         assertEquals(4, pn.getOutputSchema().getColumns().size());
 
         pn = compile("select A,C  FROM R1 A JOIN R2 B USING(A)");
@@ -89,13 +97,13 @@ public class TestSelfJoins  extends PlannerTestCase {
     }
 
     public void testOuterSelfJoin() {
-        // A.C = B.C Inner-Outer join Expr stays at the NLJ as Join predicate
-        // A.A > 1 Outer Join Expr stays at the the NLJ as pre-join predicate
+        // A.C = B.C Inner-Outer join Expr keys the hash join and stays at it as Join predicate
+        // A.A > 1 Outer Join Expr stays at the the hash join as pre-join predicate
         // B.A < 0 Inner Join Expr is pushed down to the inner SeqScan node
         AbstractPlanNode pn = compile("select * FROM R1 A LEFT JOIN R1 B ON A.C = B.C AND A.A > 1 AND B.A < 0");
         pn = pn.getChild(0).getChild(0);
-        assertTrue(pn instanceof NestLoopPlanNode);
-        NestLoopPlanNode nl = (NestLoopPlanNode) pn;
+        assertTrue(pn instanceof HashJoinPlanNode);
+        HashJoinPlanNode nl = (HashJoinPlanNode) pn;
         assertNotNull(nl.getPreJoinPredicate());
         AbstractExpression p = nl.getPreJoinPredicate();
         assertEquals(ExpressionType.COMPARE_GREATERTHAN, p.getExpressionType());
@@ -112,6 +120,43 @@ public class TestSelfJoins  extends PlannerTestCase {
         assertEquals(ExpressionType.COMPARE_LESSTHAN, p.getExpressionType());
     }
 
+    public void testMergeSelfJoin() {
+        // A self join can not look up the inner index with the outer row, so
+        // two ascending scans of the index on the joined column are merged
+        AbstractPlanNode pn = compile("select * FROM R3 A JOIN R3 B ON A.A = B.A WHERE A.A > 0 AND B.A > 0");
+        pn = pn.getChild(0).getChild(0);
+        assertTrue(pn instanceof MergeJoinPlanNode);
+        MergeJoinPlanNode mj = (MergeJoinPlanNode) pn;
+        assertEquals(JoinType.INNER, mj.getJoinType());
+        assertEquals(1, mj.getOuterMergeExpressions().size());
+        TupleValueExpression outer = (TupleValueExpression) mj.getOuterMergeExpressions().get(0);
+        TupleValueExpression inner = (TupleValueExpression) mj.getInnerMergeExpressions().get(0);
+        assertEquals("A", outer.getColumnName());
+        assertEquals("A", inner.getColumnName());
+        assertEquals(((IndexScanPlanNode) pn.getChild(0)).getTargetTableAlias(), outer.getTableAlias());
+        assertEquals(((IndexScanPlanNode) pn.getChild(1)).getTargetTableAlias(), inner.getTableAlias());
+        assertFalse(outer.getTableAlias().equals(inner.getTableAlias()));
+
+        pn = compile("select * FROM R3 A LEFT JOIN R3 B ON A.A = B.A AND B.A > 0 WHERE A.A > 0");
+        pn = pn.getChild(0).getChild(0);
+        assertTrue(pn instanceof MergeJoinPlanNode);
+        assertEquals(JoinType.LEFT, ((MergeJoinPlanNode) pn).getJoinType());
+        assertEquals("A", ((IndexScanPlanNode) pn.getChild(0)).getTargetTableAlias());
+        assertEquals("B", ((IndexScanPlanNode) pn.getChild(1)).getTargetTableAlias());
+
+        // an unsorted side is hashed instead
+        pn = compile("select * FROM R3 A JOIN R3 B ON A.A = B.A WHERE A.A > 0");
+        pn = pn.getChild(0).getChild(0);
+        assertTrue(pn instanceof HashJoinPlanNode);
+
+        // the scans are not sorted on a column other than the index's
+        pn = compile("select * FROM R3 A JOIN R3 B ON A.C = B.C WHERE A.A > 0 AND B.A > 0");
+        pn = pn.getChild(0).getChild(0);
+        assertTrue(pn instanceof HashJoinPlanNode);
+        assertTrue(pn.getChild(0) instanceof IndexScanPlanNode);
+        assertTrue(pn.getChild(1) instanceof IndexScanPlanNode);
+    }
+
     public void testPartitionedSelfJoin() {
         // SELF JOIN of the partitioned table on the partitioned column
         AbstractPlanNode pn = compile("select * FROM P1 A JOIN P1 B ON A.A = B.A");
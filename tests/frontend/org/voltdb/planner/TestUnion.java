@@ -24,7 +24,7 @@
 package org.voltdb.planner;
 
 import org.voltdb.plannodes.AbstractPlanNode;
-import org.voltdb.plannodes.NestLoopPlanNode;
+import org.voltdb.plannodes.HashJoinPlanNode;
 import org.voltdb.plannodes.ProjectionPlanNode;
 import org.voltdb.plannodes.SeqScanPlanNode;
 import org.voltdb.plannodes.UnionPlanNode;
@@ -208,7 +208,7 @@ public class TestUnion extends PlannerTestCase {
         pn = pn.getChild(0);
         assertTrue(pn.getChildCount() == 2);
         assertTrue(pn.getChild(0) instanceof ProjectionPlanNode);
-        assertTrue(pn.getChild(0).getChild(0) instanceof NestLoopPlanNode);
+        assertTrue(pn.getChild(0).getChild(0) instanceof HashJoinPlanNode);
         assertTrue(pn.getChild(1) instanceof SeqScanPlanNode);
 
         // BOTH sides are single-partitioned  for the same partition
@@ -24,4 +24,9 @@ CREATE TABLE R2 (
 	A INTEGER NOT NULL,
 	C INTEGER NOT NULL
 );
+CREATE TABLE R3 (
+	A INTEGER NOT NULL,
+	C INTEGER NOT NULL
+);
+CREATE INDEX R3_IND1 ON R3 (A);
 
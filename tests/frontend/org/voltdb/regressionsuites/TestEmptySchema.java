@@ -64,7 +64,7 @@ public class TestEmptySchema extends RegressionSuite
 
         // Even running should be an improvement (ENG-4645), but do something just to be sure
         // Also, check to be sure we get a full schema for the table and index stats
-        ColumnInfo[] expectedSchema = new ColumnInfo[11];
+        ColumnInfo[] expectedSchema = new ColumnInfo[15];
         expectedSchema[0] = new ColumnInfo("TIMESTAMP", VoltType.BIGINT);
         expectedSchema[1] = new ColumnInfo("HOST_ID", VoltType.INTEGER);
         expectedSchema[2] = new ColumnInfo("HOSTNAME", VoltType.STRING);
@@ -76,12 +76,16 @@ public class TestEmptySchema extends RegressionSuite
         expectedSchema[8] = new ColumnInfo("TUPLE_ALLOCATED_MEMORY", VoltType.INTEGER);
         expectedSchema[9] = new ColumnInfo("TUPLE_DATA_MEMORY", VoltType.INTEGER);
         expectedSchema[10] = new ColumnInfo("STRING_DATA_MEMORY", VoltType.INTEGER);
+        expectedSchema[11] = new ColumnInfo("COMPACTION_BLOCKS_MERGED", VoltType.BIGINT);
+        expectedSchema[12] = new ColumnInfo("COMPACTION_TUPLES_MOVED", VoltType.BIGINT);
+        expectedSchema[13] = new ColumnInfo("COMPACTION_MICROS", VoltType.BIGINT);
+        expectedSchema[14] = new ColumnInfo("STRING_DICTIONARY_SAVINGS", VoltType.INTEGER);
         VoltTable expectedTable = new VoltTable(expectedSchema);
 
         VoltTable[] results = client.callProcedure("@Statistics", "TABLE", 0).getResults();
         System.out.println("TABLE RESULTS: " + results[0]);
         assertEquals(0, results[0].getRowCount());
-        assertEquals(11, results[0].getColumnCount());
+        assertEquals(15, results[0].getColumnCount());
         validateSchema(results[0], expectedTable);
 
         expectedSchema = new ColumnInfo[12];
@@ -303,7 +303,7 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         System.out.println("\n\nTESTING TABLE STATS\n\n\n");
         Client client  = getFullyConnectedClient();
 
-        ColumnInfo[] expectedSchema = new ColumnInfo[11];
+        ColumnInfo[] expectedSchema = new ColumnInfo[15];
         expectedSchema[0] = new ColumnInfo("TIMESTAMP", VoltType.BIGINT);
         expectedSchema[1] = new ColumnInfo("HOST_ID", VoltType.INTEGER);
         expectedSchema[2] = new ColumnInfo("HOSTNAME", VoltType.STRING);
@@ -315,6 +315,10 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         expectedSchema[8] = new ColumnInfo("TUPLE_ALLOCATED_MEMORY", VoltType.INTEGER);
         expectedSchema[9] = new ColumnInfo("TUPLE_DATA_MEMORY", VoltType.INTEGER);
         expectedSchema[10] = new ColumnInfo("STRING_DATA_MEMORY", VoltType.INTEGER);
+        expectedSchema[11] = new ColumnInfo("COMPACTION_BLOCKS_MERGED", VoltType.BIGINT);
+        expectedSchema[12] = new ColumnInfo("COMPACTION_TUPLES_MOVED", VoltType.BIGINT);
+        expectedSchema[13] = new ColumnInfo("COMPACTION_MICROS", VoltType.BIGINT);
+        expectedSchema[14] = new ColumnInfo("STRING_DICTIONARY_SAVINGS", VoltType.INTEGER);
         VoltTable expectedTable = new VoltTable(expectedSchema);
 
         VoltTable[] results = null;
@@ -644,7 +648,7 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         System.out.println("\n\nTESTING PLANNER STATS\n\n\n");
         Client client  = getClient();
 
-        ColumnInfo[] expectedSchema = new ColumnInfo[14];
+        ColumnInfo[] expectedSchema = new ColumnInfo[16];
         expectedSchema[0] = new ColumnInfo("TIMESTAMP", VoltType.BIGINT);
         expectedSchema[1] = new ColumnInfo("HOST_ID", VoltType.INTEGER);
         expectedSchema[2] = new ColumnInfo("HOSTNAME", VoltType.STRING);
@@ -659,6 +663,8 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         expectedSchema[11] = new ColumnInfo("PLAN_TIME_MAX", VoltType.BIGINT);
         expectedSchema[12] = new ColumnInfo("PLAN_TIME_AVG", VoltType.BIGINT);
         expectedSchema[13] = new ColumnInfo("FAILURES", VoltType.BIGINT);
+        expectedSchema[14] = new ColumnInfo("CACHE1_BYTES", VoltType.BIGINT);
+        expectedSchema[15] = new ColumnInfo("CACHE1_EVICTIONS", VoltType.BIGINT);
         VoltTable expectedTable = new VoltTable(expectedSchema);
 
         VoltTable[] results = null;
@@ -699,6 +705,7 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         long plan_time_max_max = Long.MIN_VALUE;
         long plan_time_avg_tot = 0;
         int failures = 0;
+        long cache1_evictions = 0;
         while (stats.advanceRow()) {
             cache1_level += (Integer)stats.get("CACHE1_LEVEL", VoltType.INTEGER);
             cache2_level += (Integer)stats.get("CACHE2_LEVEL", VoltType.INTEGER);
@@ -709,6 +716,7 @@ public class TestStatisticsSuite extends SaveRestoreBase {
             plan_time_max_max = Math.max(plan_time_max_max, (Long)stats.get("PLAN_TIME_MAX", VoltType.BIGINT));
             plan_time_avg_tot += (Long)stats.get("PLAN_TIME_AVG", VoltType.BIGINT);
             failures += (Integer)stats.get("FAILURES", VoltType.INTEGER);
+            cache1_evictions += (Long)stats.get("CACHE1_EVICTIONS", VoltType.BIGINT);
             siteIds.add((Long)stats.get("SITE_ID", VoltType.BIGINT));
         }
 
@@ -737,6 +745,7 @@ public class TestStatisticsSuite extends SaveRestoreBase {
         assertTrue("Failed total PLAN_TIME_MAX < 100,000,000,000, value was: " + plan_time_max_max, plan_time_max_max < 100000000000L);
         assertTrue("Failed total PLAN_TIME_AVG > 0, value was: " + plan_time_avg_tot, plan_time_avg_tot > 0);
         assertTrue("Failed total FAILURES == 0, value was: " + failures, failures == 0);
+        assertTrue("Failed total CACHE1_EVICTIONS == 0, value was: " + cache1_evictions, cache1_evictions == 0);
     }
 
     public void testDRNodeStatistics() throws Exception {
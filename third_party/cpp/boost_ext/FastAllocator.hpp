@@ -124,8 +124,7 @@ public:
     }
 
     pointer allocate() {
-        boost::shared_ptr<boost::pool<voltdb::voltdb_pool_allocator_new_delete> > pool = ThreadLocalPool::getExact(sizeof(T));
-        const pointer ret = pool->malloc();
+        const pointer ret = static_cast<pointer>(ThreadLocalPool::getExact(sizeof(T))->malloc());
         if (ret == 0) {
             boost::throw_exception(std::bad_alloc());
         }
@@ -147,8 +146,7 @@ public:
         if (ptr == NULL) {
             return;
         }
-        boost::shared_ptr<boost::pool<voltdb::voltdb_pool_allocator_new_delete> > pool = ThreadLocalPool::getExact(sizeof(T));
-        pool->free(ptr);
+        ThreadLocalPool::getExact(sizeof(T))->free(ptr);
     }
 };
 }